@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup abi_generic
+ * @{
+ */
+/** @file
+ */
+
+#ifndef ABI_PROF_H_
+#define ABI_PROF_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Maximum number of return addresses recorded per sample */
+#define PROF_STACK_DEPTH  8
+
+typedef enum {
+	/** Start sampling every given number of clock ticks */
+	PROF_START,
+	/** Stop sampling */
+	PROF_STOP,
+	/** Drain recorded samples */
+	PROF_READ,
+	/** Resolve a kernel address to a symbol name */
+	PROF_SYMBOL
+} prof_operation_t;
+
+/** Single profiler sample
+ *
+ * pc[0] is the interrupted program counter, the following entries
+ * are return addresses found by walking the frame pointer chain.
+ *
+ */
+typedef struct {
+	/** Task ID (zero if the CPU was idle) */
+	uint64_t task_id;
+	/** Thread ID (zero if the CPU was idle) */
+	uint64_t thread_id;
+	/** CPU the sample was taken on */
+	uint32_t cpu;
+	/** Number of valid entries in pc */
+	uint32_t depth;
+	/** True if the CPU was executing userspace code */
+	bool uspace;
+	uint64_t pc[PROF_STACK_DEPTH];
+} prof_sample_t;
+
+#endif
+
+/** @}
+ */
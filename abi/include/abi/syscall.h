@@ -103,6 +103,8 @@ typedef enum {
 
 	SYS_KLOG,
 
+	SYS_PROF,
+
 	SYSCALL_END
 } syscall_t;
 
@@ -136,6 +136,61 @@ typedef struct {
 /** Load fixed-point value */
 typedef uint32_t load_t;
 
+/** Size of a CPU slot in the statistics page */
+#define STATS_CPU_SLOT_SIZE  64
+
+/** Statistics of a single CPU in the statistics page
+ *
+ * Each slot is updated only by the CPU it describes and
+ * occupies a cache line of its own. The sequence number
+ * is odd while an update of the slot is in progress.
+ *
+ */
+typedef union {
+	struct {
+		uint32_t seq;     /**< Sequence number */
+		stats_cpu_t cpu;  /**< CPU statistics */
+	};
+	uint8_t padding[STATS_CPU_SLOT_SIZE];
+} stats_cpu_slot_t;
+
+/** Statistics page
+ *
+ * Published by the kernel and mapped read-only by user space
+ * tasks, which can read the counters without a system call.
+ * The page is updated by the kernel using sequence numbers
+ * (odd while an update is in progress).
+ *
+ */
+typedef struct {
+	uint32_t cpu_count;       /**< Number of CPU slots */
+	uint32_t load_seq;        /**< Sequence number of the load values */
+	load_t load[LOAD_STEPS];  /**< System load */
+	uint8_t padding[STATS_CPU_SLOT_SIZE - 2 * sizeof(uint32_t) -
+	    LOAD_STEPS * sizeof(load_t)];
+	stats_cpu_slot_t cpus[];  /**< CPU slots */
+} stats_page_t;
+
+/** Incremental statistics snapshot
+ *
+ * The header is followed by @c count statistics records
+ * (stats_task_t or stats_thread_t) of the objects that
+ * changed since the requested generation and @c gone
+ * IDs (task_id_t or thread_id_t) of the objects that
+ * have been destroyed since then.
+ *
+ * If @c full is true, the records describe all existing
+ * objects and any previously cached records should be
+ * discarded.
+ *
+ */
+typedef struct {
+	uint64_t generation;  /**< Generation to request next time */
+	uint64_t count;       /**< Number of statistics records */
+	uint64_t gone;        /**< Number of destroyed object IDs */
+	bool full;            /**< Snapshot is not incremental */
+} stats_delta_t;
+
 #endif
 
 /** @}
@@ -96,6 +96,11 @@ typedef struct cpu {
 
 	struct thread *fpu_owner;
 
+	/**
+	 * State interrupted by the exception being handled, if any.
+	 */
+	struct istate *istate;
+
 	/**
 	 * Stack used by scheduler when there is no running thread.
 	 */
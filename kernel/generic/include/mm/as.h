@@ -48,6 +48,7 @@
 #include <lib/elf.h>
 #include <arch.h>
 #include <lib/refcount.h>
+#include <atomic.h>
 
 #define AS                   CURRENT->as
 
@@ -120,6 +121,12 @@ typedef struct as {
 	 */
 	odict_t as_areas;
 
+	/** Number of pages in all address space areas. */
+	atomic_size_t pages;
+
+	/** Number of resident (used) pages in all address space areas. */
+	atomic_size_t resident;
+
 	/** Non-generic content. */
 	as_genarch_t genarch;
 
@@ -177,6 +184,8 @@ typedef struct used_space {
 	odict_t ivals;
 	/** Total number of used pages. */
 	size_t pages;
+	/** Containing address space. */
+	struct as *as;
 } used_space_t;
 
 /**
@@ -129,6 +129,11 @@ typedef struct task {
 	/** Accumulated accounting. */
 	uint64_t ucycles;
 	uint64_t kcycles;
+
+	/** Statistics generation of the last change. */
+	atomic_size_t stats_gen;
+	/** Link to the list of tasks ordered by statistics generation. */
+	link_t stats_link;
 } task_t;
 
 /** Synchronize access to @c tasks */
@@ -186,6 +186,10 @@ typedef struct thread {
 	uint64_t last_cycle;
 	/** Thread doesn't affect accumulated accounting. */
 	bool uncounted;
+	/** Statistics generation of the last change. */
+	atomic_size_t stats_gen;
+	/** Link to the list of threads ordered by statistics generation. */
+	link_t stats_link;
 
 	/** Thread's priority. Implemented as index to CPU->rq */
 	int priority;
@@ -35,9 +35,19 @@
 #ifndef KERN_STATS_H_
 #define KERN_STATS_H_
 
+#include <cpu.h>
+#include <proc/task.h>
+#include <proc/thread.h>
+
 extern void kload(void *arg);
 extern void stats_init(void);
 
+extern void stats_cpu_publish(cpu_t *);
+extern void stats_task_changed(task_t *);
+extern void stats_thread_changed(thread_t *);
+extern void stats_task_gone(task_t *);
+extern void stats_thread_gone(thread_t *);
+
 #endif
 
 /** @}
@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup kernel_generic_debug
+ * @{
+ */
+
+/**
+ * @file
+ * @brief Sampling profiler.
+ *
+ * When enabled, every N-th clock tick on each CPU records the interrupted
+ * program counter together with a few return addresses obtained by walking
+ * the frame pointer chain. Samples are stored in a per-CPU ring buffer.
+ * The clock interrupt handler is the only producer of each ring and
+ * sys_prof() is the only consumer, so the rings need no locking.
+ *
+ * Kernel stacks are walked only within the stack the CPU is currently
+ * using. Userspace stacks are walked only when the sample was taken in
+ * userspace (i.e. the kernel is not holding any locks of the address space)
+ * and only as long as the frames are backed by present pages, since
+ * the clock handler must not trigger a page fault.
+ */
+
+#include <prof.h>
+#include <abi/prof.h>
+#include <align.h>
+#include <arch.h>
+#include <atomic.h>
+#include <config.h>
+#include <cpu.h>
+#include <errno.h>
+#include <genarch/mm/page_pt.h>
+#include <genarch/mm/page_ht.h>
+#include <interrupt.h>
+#include <macros.h>
+#include <mm/as.h>
+#include <mm/page.h>
+#include <proc/task.h>
+#include <proc/thread.h>
+#include <security/perm.h>
+#include <stacktrace.h>
+#include <stdlib.h>
+#include <str.h>
+#include <symtab.h>
+#include <synch/mutex.h>
+#include <syscall/copy.h>
+
+/** Number of samples in each per-CPU ring */
+#define PROF_RING_SAMPLES  1024
+
+/** Stack window around a frame pointer that must be readable */
+#define PROF_FRAME_SPAN  (4 * sizeof(uintptr_t))
+
+typedef struct {
+	/** Index of the next sample to be written (producer) */
+	atomic_size_t head;
+	/** Index of the next sample to be read (consumer) */
+	atomic_size_t tail;
+	/** Samples lost since the last PROF_STOP because the ring was full */
+	atomic_size_t dropped;
+	/** Clock ticks to skip before the next sample (producer only) */
+	size_t countdown;
+	prof_sample_t samples[PROF_RING_SAMPLES];
+} prof_ring_t;
+
+/** Per-CPU rings, allocated when profiling is first started */
+static prof_ring_t *prof_rings;
+
+static atomic_bool prof_enabled = false;
+static atomic_size_t prof_interval = 1;
+
+/** Serializes the consumers and control operations */
+static mutex_t prof_lock;
+
+void prof_init(void)
+{
+	mutex_initialize(&prof_lock, MUTEX_PASSIVE);
+}
+
+/** Check that a userspace page is mapped and present.
+ *
+ * The page tables are not locked. The caller runs with interrupts
+ * disabled on behalf of a thread that was executing userspace code,
+ * which is the same context used by the architectures that search
+ * the page tables in their TLB miss handlers.
+ *
+ */
+static bool prof_uspace_present(uintptr_t addr)
+{
+	pte_t pte;
+
+	if (!page_mapping_find(AS, ALIGN_DOWN(addr, PAGE_SIZE), true, &pte))
+		return false;
+
+	return PTE_VALID(&pte) && PTE_PRESENT(&pte);
+}
+
+/** Check whether a kernel stack address lies within a stack. */
+static bool prof_kstack_contains(uint8_t *stack, uintptr_t addr)
+{
+	uintptr_t base = (uintptr_t) stack;
+
+	return (stack != NULL) && (addr >= base + PROF_FRAME_SPAN) &&
+	    (addr + PROF_FRAME_SPAN <= base + STACK_SIZE);
+}
+
+/** Check whether the frame around a frame pointer can be read safely. */
+static bool prof_frame_readable(bool uspace, uintptr_t fp)
+{
+	if (uspace) {
+		return prof_uspace_present(fp - PROF_FRAME_SPAN) &&
+		    prof_uspace_present(fp + PROF_FRAME_SPAN);
+	}
+
+	if ((THREAD) && (prof_kstack_contains(THREAD->kstack, fp)))
+		return true;
+
+	return prof_kstack_contains(CPU->stack, fp);
+}
+
+/** Fill the program counter and return addresses of a sample. */
+static void prof_unwind(prof_sample_t *sample, istate_t *istate)
+{
+	stack_trace_ops_t *ops = sample->uspace ? &ust_ops : &kst_ops;
+	stack_trace_context_t ctx = {
+		.fp = istate_get_fp(istate),
+		.pc = istate_get_pc(istate),
+		.istate = istate
+	};
+
+	sample->depth = 0;
+	sample->pc[sample->depth++] = ctx.pc;
+
+	while ((sample->depth < PROF_STACK_DEPTH) &&
+	    (ops->stack_trace_context_validate(&ctx)) &&
+	    (prof_frame_readable(sample->uspace, ctx.fp))) {
+		uintptr_t fp;
+		uintptr_t pc;
+
+		if (!ops->return_address_get(&ctx, &pc))
+			break;
+
+		if (!ops->frame_pointer_prev(&ctx, &fp))
+			break;
+
+		if (pc == 0)
+			break;
+
+		sample->pc[sample->depth++] = pc;
+
+		/* Stacks grow downwards, the caller's frame lies above */
+		if (fp <= ctx.fp)
+			break;
+
+		ctx.fp = fp;
+		ctx.pc = pc;
+	}
+}
+
+/** Take a sample on the current CPU.
+ *
+ * Called from clock() with interrupts disabled.
+ *
+ */
+void prof_clock(void)
+{
+	if (!atomic_load_explicit(&prof_enabled, memory_order_acquire))
+		return;
+
+	/* The interrupted state is unknown unless we came via exc_dispatch() */
+	istate_t *istate = CPU->istate;
+	if (!istate)
+		return;
+
+	prof_ring_t *ring = &prof_rings[CPU->id];
+
+	if (ring->countdown > 0) {
+		ring->countdown--;
+		return;
+	}
+
+	ring->countdown =
+	    atomic_load_explicit(&prof_interval, memory_order_relaxed) - 1;
+
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	if (head - tail >= PROF_RING_SAMPLES) {
+		atomic_fetch_add_explicit(&ring->dropped, 1,
+		    memory_order_relaxed);
+		return;
+	}
+
+	prof_sample_t *sample = &ring->samples[head % PROF_RING_SAMPLES];
+
+	sample->task_id = (THREAD) ? THREAD->task->taskid : 0;
+	sample->thread_id = (THREAD) ? THREAD->tid : 0;
+	sample->cpu = CPU->id;
+	sample->uspace = (THREAD) && (istate_from_uspace(istate));
+	prof_unwind(sample, istate);
+
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/** Start sampling.
+ *
+ * Samples left over from previous runs are discarded.
+ *
+ * @param interval Number of clock ticks between two samples on a CPU.
+ *
+ */
+static errno_t prof_start(sysarg_t interval)
+{
+	if (!prof_rings) {
+		prof_rings = malloc(config.cpu_count * sizeof(prof_ring_t));
+		if (!prof_rings)
+			return ENOMEM;
+
+		for (size_t i = 0; i < config.cpu_count; i++) {
+			atomic_store(&prof_rings[i].head, 0);
+			atomic_store(&prof_rings[i].tail, 0);
+			atomic_store(&prof_rings[i].dropped, 0);
+			prof_rings[i].countdown = 0;
+		}
+	}
+
+	for (size_t i = 0; i < config.cpu_count; i++) {
+		atomic_store(&prof_rings[i].tail,
+		    atomic_load(&prof_rings[i].head));
+		atomic_store(&prof_rings[i].dropped, 0);
+	}
+
+	atomic_store(&prof_interval, (interval > 0) ? interval : 1);
+	atomic_store_explicit(&prof_enabled, true, memory_order_release);
+
+	return EOK;
+}
+
+/** Stop sampling.
+ *
+ * @param uspace_dropped Where to store the number of samples lost
+ *                       because the rings were full.
+ *
+ */
+static errno_t prof_stop(size_t *uspace_dropped)
+{
+	size_t dropped = 0;
+
+	atomic_store(&prof_enabled, false);
+
+	if (prof_rings) {
+		for (size_t i = 0; i < config.cpu_count; i++)
+			dropped += atomic_load(&prof_rings[i].dropped);
+	}
+
+	return copy_to_uspace(uspace_dropped, &dropped, sizeof(dropped));
+}
+
+/** Drain recorded samples from all CPUs.
+ *
+ * @param buf          Userspace buffer.
+ * @param size         Size of the buffer.
+ * @param uspace_nread Where to store the number of bytes read.
+ *
+ */
+static errno_t prof_read(void *buf, size_t size, size_t *uspace_nread)
+{
+	size_t count = size / sizeof(prof_sample_t);
+	size_t copied = 0;
+	errno_t rc = EOK;
+
+	if (count == 0)
+		return EOVERFLOW;
+
+	for (size_t i = 0; (prof_rings) && (i < config.cpu_count); i++) {
+		prof_ring_t *ring = &prof_rings[i];
+
+		size_t tail = atomic_load_explicit(&ring->tail,
+		    memory_order_relaxed);
+		size_t head = atomic_load_explicit(&ring->head,
+		    memory_order_acquire);
+
+		while ((tail != head) && (copied < count)) {
+			prof_sample_t sample =
+			    ring->samples[tail % PROF_RING_SAMPLES];
+
+			/* Give the slot back before possibly faulting on buf */
+			atomic_store_explicit(&ring->tail, ++tail,
+			    memory_order_release);
+
+			rc = copy_to_uspace((prof_sample_t *) buf + copied,
+			    &sample, sizeof(sample));
+			if (rc != EOK)
+				return rc;
+
+			copied++;
+		}
+	}
+
+	size_t nread = copied * sizeof(prof_sample_t);
+	return copy_to_uspace(uspace_nread, &nread, sizeof(nread));
+}
+
+/** Resolve a kernel address to a symbol name.
+ *
+ * @param addr          Kernel address.
+ * @param buf           Userspace buffer for the NULL-terminated name.
+ * @param size          Size of the buffer.
+ * @param uspace_offset Where to store the offset of addr within the symbol.
+ *
+ */
+static errno_t prof_symbol(uintptr_t addr, void *buf, size_t size,
+    size_t *uspace_offset)
+{
+	const char *name;
+	uintptr_t offset;
+
+	if (size == 0)
+		return EOVERFLOW;
+
+	errno_t rc = symtab_name_lookup(addr, &name, &offset);
+	if (rc != EOK)
+		return rc;
+
+	size_t len = min(str_size(name), size - 1);
+
+	rc = copy_to_uspace(buf, name, len);
+	if (rc != EOK)
+		return rc;
+
+	rc = copy_to_uspace((char *) buf + len, "", 1);
+	if (rc != EOK)
+		return rc;
+
+	size_t off = offset;
+	return copy_to_uspace(uspace_offset, &off, sizeof(off));
+}
+
+/** Control the sampling profiler.
+ *
+ * @param operation One of prof_operation_t.
+ * @param arg       Sampling interval in ticks for PROF_START,
+ *                  address for PROF_SYMBOL.
+ * @param buf       Samples for PROF_READ, symbol name for PROF_SYMBOL.
+ * @param size      Size of buf.
+ * @param uspace_nread Bytes read for PROF_READ, samples dropped for
+ *                  PROF_STOP, symbol offset for PROF_SYMBOL.
+ *
+ * @return EPERM if the caller lacks the PERM_PROFILE permission.
+ *
+ */
+sys_errno_t sys_prof(sysarg_t operation, sysarg_t arg, void *buf,
+    size_t size, size_t *uspace_nread)
+{
+	errno_t rc;
+
+	/* Samples expose the code and stacks of all tasks and the kernel */
+	if (!(perm_get(TASK) & PERM_PROFILE))
+		return (sys_errno_t) EPERM;
+
+	mutex_lock(&prof_lock);
+
+	switch (operation) {
+	case PROF_START:
+		rc = prof_start(arg);
+		break;
+	case PROF_STOP:
+		rc = prof_stop(uspace_nread);
+		break;
+	case PROF_READ:
+		rc = prof_read(buf, size, uspace_nread);
+		break;
+	case PROF_SYMBOL:
+		rc = prof_symbol(arg, buf, size, uspace_nread);
+		break;
+	default:
+		rc = ENOTSUP;
+		break;
+	}
+
+	mutex_unlock(&prof_lock);
+	return (sys_errno_t) rc;
+}
+
+/** @}
+ */
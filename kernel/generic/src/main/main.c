@@ -63,6 +63,7 @@
 #include <console/kconsole.h>
 #include <console/console.h>
 #include <log.h>
+#include <prof.h>
 #include <cpu.h>
 #include <align.h>
 #include <interrupt.h>
@@ -293,6 +294,7 @@ void main_bsp_separated_stack(void)
 	kio_init();
 	log_init();
 	stats_init();
+	prof_init();
 
 	/*
 	 * Create kernel task.
@@ -118,7 +118,7 @@ as_t *AS_KERNEL = NULL;
 static void *as_areas_getkey(odlink_t *);
 static int as_areas_cmp(void *, void *);
 
-static void used_space_initialize(used_space_t *);
+static void used_space_initialize(used_space_t *, as_t *);
 static void used_space_finalize(used_space_t *);
 static void *used_space_getkey(odlink_t *);
 static int used_space_cmp(void *, void *);
@@ -175,6 +175,8 @@ as_t *as_create(unsigned int flags)
 	(void) as_create_arch(as, 0);
 
 	odict_initialize(&as->as_areas, as_areas_getkey, as_areas_cmp);
+	atomic_store_explicit(&as->pages, 0, memory_order_relaxed);
+	atomic_store_explicit(&as->resident, 0, memory_order_relaxed);
 
 	if (flags & FLAG_AS_KERNEL)
 		as->asid = ASID_KERNEL;
@@ -843,8 +845,9 @@ as_area_t *as_area_create(as_t *as, unsigned int flags, size_t size,
 		}
 	}
 
-	used_space_initialize(&area->used_space);
+	used_space_initialize(&area->used_space, as);
 	odict_insert(&area->las_areas, &as->as_areas, NULL);
+	atomic_fetch_add_explicit(&as->pages, pages, memory_order_relaxed);
 
 	mutex_unlock(&as->lock);
 
@@ -1071,6 +1074,8 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 		}
 	}
 
+	atomic_fetch_add_explicit(&as->pages, pages, memory_order_relaxed);
+	atomic_fetch_sub_explicit(&as->pages, area->pages, memory_order_relaxed);
 	area->pages = pages;
 
 	mutex_unlock(&area->lock);
@@ -1163,6 +1168,7 @@ errno_t as_area_destroy(as_t *as, uintptr_t address)
 	 * Remove the empty area from address space.
 	 */
 	odict_remove(&area->las_areas);
+	atomic_fetch_sub_explicit(&as->pages, area->pages, memory_order_relaxed);
 
 	free(area);
 
@@ -1846,11 +1852,13 @@ size_t as_area_get_size(uintptr_t base)
 /** Initialize used space map.
  *
  * @param used_space Used space map
+ * @param as Containing address space
  */
-static void used_space_initialize(used_space_t *used_space)
+static void used_space_initialize(used_space_t *used_space, as_t *as)
 {
 	odict_initialize(&used_space->ivals, used_space_getkey, used_space_cmp);
 	used_space->pages = 0;
+	used_space->as = as;
 }
 
 /** Finalize used space map.
@@ -1995,6 +2003,8 @@ static int used_space_cmp(void *a, void *b)
 static void used_space_remove_ival(used_space_ival_t *ival)
 {
 	ival->used_space->pages -= ival->count;
+	atomic_fetch_sub_explicit(&ival->used_space->as->resident, ival->count,
+	    memory_order_relaxed);
 	odict_remove(&ival->lused_space);
 	slab_free(used_space_ival_cache, ival);
 }
@@ -2010,6 +2020,8 @@ static void used_space_shorten_ival(used_space_ival_t *ival, size_t count)
 	assert(count < ival->count);
 
 	ival->used_space->pages -= ival->count - count;
+	atomic_fetch_sub_explicit(&ival->used_space->as->resident,
+	    ival->count - count, memory_order_relaxed);
 	ival->count = count;
 }
 
@@ -2062,6 +2074,11 @@ bool used_space_insert(used_space_t *used_space, uintptr_t page, size_t count)
 	if (adj_a && adj_b) {
 		/* Fuse into a single interval */
 		a->count += count + b->count;
+
+		/* Pages of B remain used as a part of A */
+		used_space->pages += b->count;
+		atomic_fetch_add_explicit(&used_space->as->resident, b->count,
+		    memory_order_relaxed);
 		used_space_remove_ival(b);
 	} else if (adj_a) {
 		/* Append to A */
@@ -2083,6 +2100,8 @@ bool used_space_insert(used_space_t *used_space, uintptr_t page, size_t count)
 	}
 
 	used_space->pages += count;
+	atomic_fetch_add_explicit(&used_space->as->resident, count,
+	    memory_order_relaxed);
 	return true;
 }
 
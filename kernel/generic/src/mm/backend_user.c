@@ -39,6 +39,9 @@
 #include <mm/as.h>
 #include <mm/page.h>
 #include <mm/frame.h>
+#include <mm/km.h>
+#include <mm/reserve.h>
+#include <mm/tlb.h>
 #include <abi/mm/as.h>
 #include <abi/ipc/methods.h>
 #include <ipc/sysipc.h>
@@ -49,6 +52,8 @@
 #include <errno.h>
 #include <log.h>
 #include <str.h>
+#include <mem.h>
+#include <barrier.h>
 
 static bool user_create(as_area_t *);
 static void user_destroy(as_area_t *);
@@ -95,7 +100,68 @@ bool user_is_shareable(as_area_t *area)
 	return false;
 }
 
+/** Drop a reference to a frame.
+ *
+ * Memory of the frames obtained from the pager is reserved by the pager,
+ * so only private copies give their reservation back.
+ *
+ * @param frame Frame to be released.
+ * @param copy  The frame is a private copy made by user_frame_copy().
+ */
+static void user_frame_release(uintptr_t frame, bool copy)
+{
+	pfn_t pfn = ADDR2PFN(frame);
+	if (find_zone(pfn, 1, 0) == (size_t) -1)
+		return;
+
+	if (copy)
+		frame_free(frame, 1);
+	else
+		frame_free_noreserve(frame, 1);
+}
+
+/** Make a private copy of a frame provided by the pager.
+ *
+ * The pager may hand out the same frame to many address spaces (e.g. pages
+ * of a cached file), so a writable area must never write to it directly.
+ *
+ * The copies are reserved one by one as they are made, in the same way as
+ * the late reserve of anonymous areas.
+ *
+ * @param area  Address space area the copy is made for.
+ * @param frame Frame to be copied.
+ * @param copyp Place to store the physical address of the private copy.
+ *
+ * @return True on success, false if the memory cannot be reserved.
+ */
+static bool user_frame_copy(as_area_t *area, uintptr_t frame,
+    uintptr_t *copyp)
+{
+	if (!reserve_try_alloc(1))
+		return false;
+
+	uintptr_t copy;
+	uintptr_t kpage = km_temporary_page_get(&copy, FRAME_NO_RESERVE);
+	uintptr_t src = km_map(frame, PAGE_SIZE, PAGE_SIZE,
+	    PAGE_READ | PAGE_CACHEABLE);
+
+	memcpy((void *) kpage, (void *) src, PAGE_SIZE);
+	if (area->flags & AS_AREA_EXEC)
+		smc_coherence((void *) kpage, PAGE_SIZE);
+
+	km_unmap(src, PAGE_SIZE);
+	km_temporary_page_put(kpage);
+
+	*copyp = copy;
+	return true;
+}
+
 /** Service a page fault in the user-paged address space area.
+ *
+ * Pages provided by the pager are treated as a private mapping. Writable
+ * areas map them read-only first and break the sharing with a private copy
+ * on the first write, so the pager can safely hand out the same frame to
+ * many address spaces.
  *
  * The address space area and page tables must be already locked.
  *
@@ -115,6 +181,35 @@ int user_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	if (!as_area_check_access(area, access))
 		return AS_PF_FAULT;
 
+	unsigned int page_flags = as_area_get_flags(area);
+
+	pte_t pte;
+	bool found = page_mapping_find(AS, upage, false, &pte);
+	if (found && PTE_PRESENT(&pte)) {
+		/*
+		 * The page is already mapped read-only and this is the first
+		 * write to it. Replace the shared frame with a private copy.
+		 */
+		assert(access == PF_ACCESS_WRITE);
+
+		uintptr_t shared = PTE_GET_FRAME(&pte);
+		uintptr_t frame;
+		if (!user_frame_copy(area, shared, &frame))
+			return AS_PF_FAULT;
+
+		ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES, AS->asid,
+		    upage, 1);
+		page_mapping_remove(AS, upage);
+		tlb_invalidate_pages(AS->asid, upage, 1);
+		as_invalidate_translation_cache(AS, upage, 1);
+		tlb_shootdown_finalize(ipl);
+
+		page_mapping_insert(AS, upage, frame, page_flags);
+		user_frame_release(shared, false);
+
+		return AS_PF_OK;
+	}
+
 	as_area_pager_info_t *pager_info = &area->backend_data.pager_info;
 
 	ipc_data_t data = { };
@@ -145,7 +240,20 @@ int user_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	 */
 
 	uintptr_t frame = IPC_GET_ARG1(data);
-	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+
+	if (area->flags & AS_AREA_WRITE) {
+		if (access == PF_ACCESS_WRITE) {
+			uintptr_t shared = frame;
+			bool copied = user_frame_copy(area, shared, &frame);
+			user_frame_release(shared, false);
+			if (!copied)
+				return AS_PF_FAULT;
+		} else {
+			page_flags &= ~PAGE_WRITE;
+		}
+	}
+
+	page_mapping_insert(AS, upage, frame, page_flags);
 	if (!used_space_insert(&area->used_space, upage, 1))
 		panic("Cannot insert used space.");
 
@@ -153,10 +261,13 @@ int user_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 }
 
 /** Free a frame that is backed by the user memory backend.
+ *
+ * Private copies are the only frames mapped writable; the frames of the
+ * pager are always mapped read-only in writable areas.
  *
  * The address space area and page tables must be already locked.
  *
- * @param area Ignored.
+ * @param area Pointer to the address space area.
  * @param page Virtual address of the page corresponding to the frame.
  * @param frame Frame to be released.
  */
@@ -165,13 +276,11 @@ void user_frame_free(as_area_t *area, uintptr_t page, uintptr_t frame)
 	assert(page_table_locked(area->as));
 	assert(mutex_locked(&area->lock));
 
-	pfn_t pfn = ADDR2PFN(frame);
-	if (find_zone(pfn, 1, 0) != (size_t) -1) {
-		frame_free(frame, 1);
-	} else {
-		/* Nothing to do */
-	}
+	pte_t pte;
+	bool found = page_mapping_find(area->as, page, false, &pte);
+	assert(found);
 
+	user_frame_release(frame, found && PTE_WRITABLE(&pte));
 }
 
 /** @}
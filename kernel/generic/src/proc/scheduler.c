@@ -64,6 +64,7 @@
 #include <stdio.h>
 #include <log.h>
 #include <stacktrace.h>
+#include <sysinfo/stats.h>
 
 static void scheduler_separated_stack(void);
 
@@ -317,6 +318,8 @@ void scheduler(void)
 
 		/* Update thread kernel accounting */
 		THREAD->kcycles += get_cycle() - THREAD->last_cycle;
+		stats_thread_changed(THREAD);
+		stats_task_changed(THREAD->task);
 
 #if (defined CONFIG_FPU) && (!defined CONFIG_FPU_LAZY)
 		fpu_context_save(THREAD->saved_fpu_context);
@@ -507,6 +510,7 @@ void scheduler_separated_stack(void)
 
 	irq_spinlock_lock(&THREAD->lock, false);
 	THREAD->state = Running;
+	stats_thread_changed(THREAD);
 
 #ifdef SCHEDULER_VERBOSE
 	log(LF_OTHER, LVL_DEBUG,
@@ -58,6 +58,7 @@
 #include <str.h>
 #include <syscall/copy.h>
 #include <macros.h>
+#include <sysinfo/stats.h>
 
 /** Spinlock protecting the @c tasks ordered dictionary. */
 IRQ_SPINLOCK_INITIALIZE(tasks_lock);
@@ -211,6 +212,9 @@ task_t *task_create(as_t *as, const char *name)
 	task->ucycles = 0;
 	task->kcycles = 0;
 
+	atomic_store(&task->stats_gen, 0);
+	link_initialize(&task->stats_link);
+
 	caps_task_init(task);
 
 	task->ipc_info.call_sent = 0;
@@ -254,6 +258,7 @@ task_t *task_create(as_t *as, const char *name)
 	task->taskid = ++task_counter;
 	odlink_initialize(&task->ltasks);
 	odict_insert(&task->ltasks, &tasks, NULL);
+	stats_task_changed(task);
 
 	irq_spinlock_unlock(&tasks_lock, true);
 
@@ -272,6 +277,7 @@ void task_destroy(task_t *task)
 	 */
 	irq_spinlock_lock(&tasks_lock, true);
 	odict_remove(&task->ltasks);
+	stats_task_gone(task);
 	irq_spinlock_unlock(&tasks_lock, true);
 
 	/*
@@ -388,6 +394,7 @@ sys_errno_t sys_task_set_name(const char *uspace_name, size_t name_len)
 
 	/* Set task name */
 	str_cpy(TASK->name, TASK_NAME_BUFLEN, namebuf);
+	stats_task_changed(TASK);
 
 	irq_spinlock_unlock(&threads_lock, false);
 	irq_spinlock_unlock(&TASK->lock, false);
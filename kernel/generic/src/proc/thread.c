@@ -68,6 +68,7 @@
 #include <syscall/copy.h>
 #include <errno.h>
 #include <debug.h>
+#include <sysinfo/stats.h>
 
 /** Thread states */
 const char *thread_states[] = {
@@ -305,6 +306,7 @@ void thread_ready(thread_t *thread)
 	}
 
 	thread->state = Ready;
+	stats_thread_changed(thread);
 
 	irq_spinlock_pass(&thread->lock, &(cpu->rq[i].lock));
 
@@ -404,6 +406,9 @@ thread_t *thread_create(void (*func)(void *), void *arg, task_t *task,
 
 	odlink_initialize(&thread->lthreads);
 
+	atomic_store(&thread->stats_gen, 0);
+	link_initialize(&thread->stats_link);
+
 #ifdef CONFIG_UDEBUG
 	/* Initialize debugging stuff */
 	thread->btrace = false;
@@ -440,6 +445,7 @@ void thread_destroy(thread_t *thread, bool irq_res)
 	irq_spinlock_pass(&thread->lock, &threads_lock);
 
 	odict_remove(&thread->lthreads);
+	stats_thread_gone(thread);
 
 	irq_spinlock_pass(&threads_lock, &thread->task->lock);
 
@@ -447,6 +453,7 @@ void thread_destroy(thread_t *thread, bool irq_res)
 	 * Detach from the containing task.
 	 */
 	list_remove(&thread->th_link);
+	stats_task_changed(thread->task);
 	irq_spinlock_unlock(&thread->task->lock, irq_res);
 
 	/*
@@ -480,6 +487,7 @@ void thread_attach(thread_t *thread, task_t *task)
 		atomic_inc(&task->lifecount);
 
 	list_append(&thread->th_link, &task->threads);
+	stats_task_changed(task);
 
 	irq_spinlock_pass(&task->lock, &threads_lock);
 
@@ -487,6 +495,7 @@ void thread_attach(thread_t *thread, task_t *task)
 	 * Register this thread in the system-wide dictionary.
 	 */
 	odict_insert(&thread->lthreads, &threads, NULL);
+	stats_thread_changed(thread);
 	irq_spinlock_unlock(&threads_lock, true);
 }
 
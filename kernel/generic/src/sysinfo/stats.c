@@ -52,6 +52,10 @@
 #include <cpu.h>
 #include <arch.h>
 #include <stdlib.h>
+#include <barrier.h>
+#include <macros.h>
+#include <mem.h>
+#include <ddi/ddi.h>
 
 /** Bits of fixed-point precision for load */
 #define LOAD_FIXED_SHIFT  11
@@ -83,119 +87,420 @@ static load_t avenrdy[LOAD_STEPS] = { 0, 0, 0 };
 /** Load calculation lock */
 static mutex_t load_lock;
 
-/** Get statistics of all CPUs
+/** Number of remembered destroyed tasks */
+#define STATS_GONE_TASKS  64
+
+/** Number of remembered destroyed threads */
+#define STATS_GONE_THREADS  256
+
+/** Destroyed task or thread */
+typedef struct {
+	/** Task or thread ID */
+	uint64_t id;
+	/** Generation of the destruction */
+	size_t gen;
+} stats_gone_t;
+
+/** Ring of recently destroyed tasks or threads */
+typedef struct {
+	/** Ring items */
+	stats_gone_t *items;
+	/** Number of ring items */
+	size_t size;
+	/** Index of the next item to be written */
+	size_t next;
+	/** Number of valid items */
+	size_t count;
+	/** Highest generation of an overwritten item */
+	size_t lost;
+} stats_gone_ring_t;
+
+/** Statistics page shared with user space */
+static stats_page_t *stats_page = NULL;
+
+/** Physical memory area of the statistics page */
+static parea_t stats_parea;
+
+/** Current statistics generation
  *
- * @param item    Sysinfo item (unused).
- * @param size    Size of the returned data.
- * @param dry_run Do not get the data, just calculate the size.
- * @param data    Unused.
+ * Tasks and threads are stamped with the current generation
+ * whenever their statistics change. Each incremental snapshot
+ * advances the generation, so that the next snapshot only needs
+ * to report objects with a recent stamp.
  *
- * @return Data containing several stats_cpu_t structures.
- *         If the return value is not NULL, it should be freed
- *         in the context of the sysinfo request.
  */
-static void *get_stats_cpus(struct sysinfo_item *item, size_t *size,
-    bool dry_run, void *data)
+static atomic_size_t stats_generation = 1;
+
+/** Synchronize access to the lists of changed objects
+ *
+ * Also serializes stamping with advancing the generation, so
+ * that the lists stay ordered by the generation stamps. This
+ * lock is always taken last.
+ *
+ */
+IRQ_SPINLOCK_STATIC_INITIALIZE(stats_changes_lock);
+
+/** Tasks ordered by the generation of their last change
+ *
+ * An incremental snapshot only walks the tail of the list
+ * which has been stamped since the previous snapshot, so its
+ * cost does not depend on the total number of tasks.
+ *
+ */
+static LIST_INITIALIZE(changed_tasks);
+
+/** Threads ordered by the generation of their last change */
+static LIST_INITIALIZE(changed_threads);
+
+/** Synchronize access to the rings of destroyed objects */
+IRQ_SPINLOCK_STATIC_INITIALIZE(stats_gone_lock);
+
+static stats_gone_t gone_tasks_items[STATS_GONE_TASKS];
+static stats_gone_t gone_threads_items[STATS_GONE_THREADS];
+
+/** Recently destroyed tasks */
+static stats_gone_ring_t gone_tasks = {
+	.items = gone_tasks_items,
+	.size = STATS_GONE_TASKS
+};
+
+/** Recently destroyed threads */
+static stats_gone_ring_t gone_threads = {
+	.items = gone_threads_items,
+	.size = STATS_GONE_THREADS
+};
+
+/** Publish CPU statistics in the statistics page
+ *
+ * Called periodically by each CPU for itself.
+ *
+ * @param cpu CPU (locked).
+ *
+ */
+void stats_cpu_publish(cpu_t *cpu)
 {
-	*size = sizeof(stats_cpu_t) * config.cpu_count;
-	if (dry_run)
-		return NULL;
+	assert(irq_spinlock_locked(&cpu->lock));
 
-	/* Assumption: config.cpu_count is constant */
-	stats_cpu_t *stats_cpus = (stats_cpu_t *) malloc(*size);
-	if (stats_cpus == NULL) {
-		*size = 0;
-		return NULL;
-	}
+	if (stats_page == NULL)
+		return;
 
-	size_t i;
-	for (i = 0; i < config.cpu_count; i++) {
-		irq_spinlock_lock(&cpus[i].lock, true);
+	stats_cpu_slot_t *slot = &stats_page->cpus[cpu->id];
 
-		stats_cpus[i].id = cpus[i].id;
-		stats_cpus[i].active = cpus[i].active;
-		stats_cpus[i].frequency_mhz = cpus[i].frequency_mhz;
-		stats_cpus[i].busy_cycles = cpus[i].busy_cycles;
-		stats_cpus[i].idle_cycles = cpus[i].idle_cycles;
+	slot->seq++;
+	write_barrier();
 
-		irq_spinlock_unlock(&cpus[i].lock, true);
+	slot->cpu.id = cpu->id;
+	slot->cpu.active = cpu->active;
+	slot->cpu.frequency_mhz = cpu->frequency_mhz;
+	slot->cpu.busy_cycles = cpu->busy_cycles;
+	slot->cpu.idle_cycles = cpu->idle_cycles;
+
+	write_barrier();
+	slot->seq++;
+}
+
+/** Stamp an object with the current generation
+ *
+ * @param stats_gen  Statistics generation of the object.
+ * @param stats_link Link of the object to the list of changes.
+ * @param changes    List of changed objects.
+ *
+ */
+static void stats_changed(atomic_size_t *stats_gen, link_t *stats_link,
+    list_t *changes)
+{
+	/* Already stamped with the current generation */
+	if (atomic_load_explicit(stats_gen, memory_order_relaxed) ==
+	    atomic_load_explicit(&stats_generation, memory_order_relaxed))
+		return;
+
+	irq_spinlock_lock(&stats_changes_lock, true);
+
+	size_t gen = atomic_load_explicit(&stats_generation,
+	    memory_order_relaxed);
+	if (atomic_load_explicit(stats_gen, memory_order_relaxed) != gen) {
+		atomic_store_explicit(stats_gen, gen, memory_order_relaxed);
+
+		if (link_in_use(stats_link))
+			list_remove(stats_link);
+		list_append(stats_link, changes);
 	}
 
-	return ((void *) stats_cpus);
+	irq_spinlock_unlock(&stats_changes_lock, true);
 }
 
-/** Get the size of a virtual address space
+/** Mark task statistics as changed
  *
- * @param as Address space.
+ * @param task Task.
  *
- * @return Size of the mapped virtual address space (bytes).
+ */
+void stats_task_changed(task_t *task)
+{
+	stats_changed(&task->stats_gen, &task->stats_link, &changed_tasks);
+}
+
+/** Mark thread statistics as changed
+ *
+ * @param thread Thread.
  *
  */
-static size_t get_task_virtmem(as_t *as)
+void stats_thread_changed(thread_t *thread)
 {
-	/*
-	 * We are holding spinlocks here and therefore are not allowed to
-	 * block. Only attempt to lock the address space and address space
-	 * area mutexes conditionally. If it is not possible to lock either
-	 * object, return inexact statistics by skipping the respective object.
-	 */
+	stats_changed(&thread->stats_gen, &thread->stats_link,
+	    &changed_threads);
+}
+
+/** Advance the statistics generation
+ *
+ * @return Generation before the advance.
+ *
+ */
+static size_t stats_generation_advance(void)
+{
+	irq_spinlock_lock(&stats_changes_lock, true);
+	size_t gen = atomic_fetch_add(&stats_generation, 1);
+	irq_spinlock_unlock(&stats_changes_lock, true);
+
+	return gen;
+}
+
+/** Collect tasks changed since a generation
+ *
+ * Walks the list of changed tasks from the most recent end and
+ * stops at the first task stamped before @a since. The caller
+ * holds tasks_lock, which keeps the collected tasks alive.
+ *
+ * @param since Generation of the previous snapshot.
+ * @param upto  Newest generation to collect.
+ * @param tasks Output array with room for @a max tasks
+ *              or NULL to only count the tasks.
+ * @param max   Maximum number of tasks to collect
+ *              (ignored when only counting).
+ *
+ * @return Number of tasks.
+ *
+ */
+static size_t stats_tasks_collect(size_t since, size_t upto, task_t **tasks,
+    size_t max)
+{
+	size_t cnt = 0;
+
+	irq_spinlock_lock(&stats_changes_lock, false);
 
-	if (mutex_trylock(&as->lock) != EOK)
-		return 0;
+	list_foreach_rev(changed_tasks, stats_link, task_t, task) {
+		if ((tasks != NULL) && (cnt == max))
+			break;
 
-	size_t pages = 0;
+		size_t gen = atomic_load_explicit(&task->stats_gen,
+		    memory_order_relaxed);
+		if (gen < since)
+			break;
 
-	/* Walk areas in the address space and count pages */
-	as_area_t *area = as_area_first(as);
-	while (area != NULL) {
-		if (mutex_trylock(&area->lock) != EOK)
+		/* Changed after the snapshot, reported by the next one */
+		if (gen > upto)
 			continue;
 
-		pages += area->pages;
-		mutex_unlock(&area->lock);
-		area = as_area_next(area);
+		if (tasks != NULL)
+			tasks[cnt] = task;
+		cnt++;
 	}
 
-	mutex_unlock(&as->lock);
+	irq_spinlock_unlock(&stats_changes_lock, false);
 
-	return (pages << PAGE_WIDTH);
+	return cnt;
 }
 
-/** Get the resident (used) size of a virtual address space
+/** Collect threads changed since a generation
+ *
+ * See stats_tasks_collect(). The caller holds threads_lock.
  *
- * @param as Address space.
+ * @param since   Generation of the previous snapshot.
+ * @param upto    Newest generation to collect.
+ * @param threads Output array with room for @a max threads
+ *                or NULL to only count the threads.
+ * @param max     Maximum number of threads to collect
+ *                (ignored when only counting).
  *
- * @return Size of the resident (used) virtual address space (bytes).
+ * @return Number of threads.
  *
  */
-static size_t get_task_resmem(as_t *as)
+static size_t stats_threads_collect(size_t since, size_t upto,
+    thread_t **threads, size_t max)
 {
-	/*
-	 * We are holding spinlocks here and therefore are not allowed to
-	 * block. Only attempt to lock the address space and address space
-	 * area mutexes conditionally. If it is not possible to lock either
-	 * object, return inexact statistics by skipping the respective object.
-	 */
+	size_t cnt = 0;
 
-	if (mutex_trylock(&as->lock) != EOK)
-		return 0;
+	irq_spinlock_lock(&stats_changes_lock, false);
 
-	size_t pages = 0;
+	list_foreach_rev(changed_threads, stats_link, thread_t, thread) {
+		if ((threads != NULL) && (cnt == max))
+			break;
 
-	/* Walk areas in the address space and count pages */
-	as_area_t *area = as_area_first(as);
-	while (area != NULL) {
-		if (mutex_trylock(&area->lock) != EOK)
+		size_t gen = atomic_load_explicit(&thread->stats_gen,
+		    memory_order_relaxed);
+		if (gen < since)
+			break;
+
+		/* Changed after the snapshot, reported by the next one */
+		if (gen > upto)
 			continue;
 
-		pages += area->used_space.pages;
-		mutex_unlock(&area->lock);
-		area = as_area_next(area);
+		if (threads != NULL)
+			threads[cnt] = thread;
+		cnt++;
+	}
+
+	irq_spinlock_unlock(&stats_changes_lock, false);
+
+	return cnt;
+}
+
+/** Remember a destroyed task or thread
+ *
+ * @param ring Ring of destroyed objects.
+ * @param id   Task or thread ID.
+ *
+ */
+static void stats_gone(stats_gone_ring_t *ring, uint64_t id)
+{
+	size_t gen = atomic_load_explicit(&stats_generation,
+	    memory_order_acquire);
+
+	irq_spinlock_lock(&stats_gone_lock, true);
+
+	stats_gone_t *item = &ring->items[ring->next];
+	if (ring->count == ring->size)
+		ring->lost = max(ring->lost, item->gen);
+	else
+		ring->count++;
+
+	item->id = id;
+	item->gen = gen;
+	ring->next = (ring->next + 1) % ring->size;
+
+	irq_spinlock_unlock(&stats_gone_lock, true);
+}
+
+/** Remember a destroyed task
+ *
+ * @param task Task being destroyed.
+ *
+ */
+void stats_task_gone(task_t *task)
+{
+	irq_spinlock_lock(&stats_changes_lock, true);
+	if (link_in_use(&task->stats_link))
+		list_remove(&task->stats_link);
+	irq_spinlock_unlock(&stats_changes_lock, true);
+
+	stats_gone(&gone_tasks, task->taskid);
+}
+
+/** Remember a destroyed thread
+ *
+ * @param thread Thread being destroyed.
+ *
+ */
+void stats_thread_gone(thread_t *thread)
+{
+	irq_spinlock_lock(&stats_changes_lock, true);
+	if (link_in_use(&thread->stats_link))
+		list_remove(&thread->stats_link);
+	irq_spinlock_unlock(&stats_changes_lock, true);
+
+	stats_gone(&gone_threads, thread->tid);
+}
+
+/** Check whether changes can be reported incrementally
+ *
+ * @param ring  Ring of destroyed objects.
+ * @param since Generation of the previous snapshot.
+ *
+ * @return True if a full snapshot is required.
+ *
+ */
+static bool stats_delta_full(stats_gone_ring_t *ring, size_t since)
+{
+	if ((since == 0) ||
+	    (since > atomic_load_explicit(&stats_generation, memory_order_acquire)))
+		return true;
+
+	irq_spinlock_lock(&stats_gone_lock, true);
+	bool full = (ring->lost >= since);
+	irq_spinlock_unlock(&stats_gone_lock, true);
+
+	return full;
+}
+
+/** Collect IDs of objects destroyed since a generation
+ *
+ * @param ring  Ring of destroyed objects.
+ * @param since Generation of the previous snapshot.
+ * @param ids   Output array with room for @c ring->size IDs
+ *              or NULL to only count the IDs.
+ *
+ * @return Number of IDs.
+ *
+ */
+static size_t stats_gone_collect(stats_gone_ring_t *ring, size_t since,
+    uint64_t *ids)
+{
+	size_t cnt = 0;
+
+	irq_spinlock_lock(&stats_gone_lock, true);
+
+	for (size_t i = 0; i < ring->count; i++) {
+		stats_gone_t *item = &ring->items[i];
+		if (item->gen >= since) {
+			if (ids != NULL)
+				ids[cnt] = item->id;
+			cnt++;
+		}
 	}
 
-	mutex_unlock(&as->lock);
+	irq_spinlock_unlock(&stats_gone_lock, true);
 
-	return (pages << PAGE_WIDTH);
+	return cnt;
+}
+
+/** Get statistics of all CPUs
+ *
+ * @param item    Sysinfo item (unused).
+ * @param size    Size of the returned data.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Data containing several stats_cpu_t structures.
+ *         If the return value is not NULL, it should be freed
+ *         in the context of the sysinfo request.
+ */
+static void *get_stats_cpus(struct sysinfo_item *item, size_t *size,
+    bool dry_run, void *data)
+{
+	*size = sizeof(stats_cpu_t) * config.cpu_count;
+	if (dry_run)
+		return NULL;
+
+	/* Assumption: config.cpu_count is constant */
+	stats_cpu_t *stats_cpus = (stats_cpu_t *) malloc(*size);
+	if (stats_cpus == NULL) {
+		*size = 0;
+		return NULL;
+	}
+
+	size_t i;
+	for (i = 0; i < config.cpu_count; i++) {
+		irq_spinlock_lock(&cpus[i].lock, true);
+
+		stats_cpus[i].id = cpus[i].id;
+		stats_cpus[i].active = cpus[i].active;
+		stats_cpus[i].frequency_mhz = cpus[i].frequency_mhz;
+		stats_cpus[i].busy_cycles = cpus[i].busy_cycles;
+		stats_cpus[i].idle_cycles = cpus[i].idle_cycles;
+
+		irq_spinlock_unlock(&cpus[i].lock, true);
+	}
+
+	return ((void *) stats_cpus);
 }
 
 /** Produce task statistics
@@ -213,8 +518,10 @@ static void produce_stats_task(task_t *task, stats_task_t *stats_task)
 
 	stats_task->task_id = task->taskid;
 	str_cpy(stats_task->name, TASK_NAME_BUFLEN, task->name);
-	stats_task->virtmem = get_task_virtmem(task->as);
-	stats_task->resmem = get_task_resmem(task->as);
+	stats_task->virtmem = atomic_load_explicit(&task->as->pages,
+	    memory_order_relaxed) << PAGE_WIDTH;
+	stats_task->resmem = atomic_load_explicit(&task->as->resident,
+	    memory_order_relaxed) << PAGE_WIDTH;
 	stats_task->threads = atomic_load(&task->refcount);
 	task_get_accounting(task, &(stats_task->ucycles),
 	    &(stats_task->kcycles));
@@ -514,6 +821,247 @@ static sysinfo_return_t get_stats_thread(const char *name, bool dry_run,
 	return ret;
 }
 
+/** Get incremental task statistics
+ *
+ * Get statistics of the tasks that changed since a given
+ * generation. The generation is passed as a string (current
+ * limitation of the sysinfo interface). Only the tasks on
+ * the list of changes are visited, so the cost depends on
+ * the number of changed tasks rather than on all tasks.
+ *
+ * @param name    Generation returned by the previous snapshot
+ *                (string-encoded number) or zero for a full
+ *                snapshot.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Sysinfo return holder. The type of the returned
+ *         data is either SYSINFO_VAL_UNDEFINED (invalid
+ *         generation or memory allocation error) or
+ *         SYSINFO_VAL_FUNCTION_DATA (stats_delta_t followed
+ *         by stats_task_t records and destroyed task IDs,
+ *         the generated data should be freed within the
+ *         sysinfo request context).
+ *
+ */
+static sysinfo_return_t get_stats_task_changes(const char *name,
+    bool dry_run, void *data)
+{
+	/* Initially no return value */
+	sysinfo_return_t ret;
+	ret.tag = SYSINFO_VAL_UNDEFINED;
+
+	/* Parse the generation */
+	uint64_t since;
+	if (str_uint64_t(name, NULL, 0, true, &since) != EOK)
+		return ret;
+
+	/*
+	 * Advance the generation before looking at the tasks. Tasks
+	 * changing from now on are stamped with a newer generation.
+	 * The stamps are compared inclusively, so tasks stamped
+	 * concurrently with this snapshot are reported again by
+	 * the next one.
+	 */
+	size_t gen = dry_run ? atomic_load(&stats_generation) :
+	    stats_generation_advance();
+
+	bool full = stats_delta_full(&gone_tasks, since);
+	if (full)
+		since = 0;
+
+	/* Messing with task structures, avoid deadlock */
+	irq_spinlock_lock(&tasks_lock, true);
+
+	/* Count the changed tasks */
+	size_t count = stats_tasks_collect(since, gen, NULL, 0);
+
+	if (dry_run) {
+		irq_spinlock_unlock(&tasks_lock, true);
+
+		size_t gone = full ? 0 :
+		    stats_gone_collect(&gone_tasks, since, NULL);
+
+		ret.tag = SYSINFO_VAL_FUNCTION_DATA;
+		ret.data.data = NULL;
+		ret.data.size = sizeof(stats_delta_t) +
+		    sizeof(stats_task_t) * count + sizeof(task_id_t) * gone;
+		return ret;
+	}
+
+	stats_delta_t *delta = (stats_delta_t *) malloc(sizeof(stats_delta_t) +
+	    sizeof(stats_task_t) * count + sizeof(task_id_t) * gone_tasks.size);
+	if (delta == NULL) {
+		/* No free space for allocation */
+		irq_spinlock_unlock(&tasks_lock, true);
+		return ret;
+	}
+
+	task_t **tasks = (task_t **) malloc(sizeof(task_t *) * max(count, 1));
+	if (tasks == NULL) {
+		/* No free space for allocation */
+		irq_spinlock_unlock(&tasks_lock, true);
+		free(delta);
+		return ret;
+	}
+
+	/*
+	 * Tasks might have been stamped with a newer generation in the
+	 * meantime, so there might be fewer of them now.
+	 */
+	count = stats_tasks_collect(since, gen, tasks, count);
+
+	/* Gather the statistics of the changed tasks */
+	stats_task_t *stats_tasks = (stats_task_t *) (delta + 1);
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		/* Interrupts are already disabled */
+		irq_spinlock_lock(&tasks[i]->lock, false);
+
+		/* Record the statistics */
+		produce_stats_task(tasks[i], &stats_tasks[i]);
+
+		irq_spinlock_unlock(&tasks[i]->lock, false);
+	}
+
+	irq_spinlock_unlock(&tasks_lock, true);
+	free(tasks);
+
+	task_id_t *gone_ids = (task_id_t *) (stats_tasks + i);
+
+	delta->generation = gen;
+	delta->count = i;
+	delta->gone = full ? 0 :
+	    stats_gone_collect(&gone_tasks, since, gone_ids);
+	delta->full = full;
+
+	ret.tag = SYSINFO_VAL_FUNCTION_DATA;
+	ret.data.data = (void *) delta;
+	ret.data.size = sizeof(stats_delta_t) + sizeof(stats_task_t) * i +
+	    sizeof(task_id_t) * delta->gone;
+
+	return ret;
+}
+
+/** Get incremental thread statistics
+ *
+ * Get statistics of the threads that changed since a given
+ * generation. The generation is passed as a string (current
+ * limitation of the sysinfo interface). Only the threads on
+ * the list of changes are visited, so the cost depends on
+ * the number of changed threads rather than on all threads.
+ *
+ * @param name    Generation returned by the previous snapshot
+ *                (string-encoded number) or zero for a full
+ *                snapshot.
+ * @param dry_run Do not get the data, just calculate the size.
+ * @param data    Unused.
+ *
+ * @return Sysinfo return holder. The type of the returned
+ *         data is either SYSINFO_VAL_UNDEFINED (invalid
+ *         generation or memory allocation error) or
+ *         SYSINFO_VAL_FUNCTION_DATA (stats_delta_t followed
+ *         by stats_thread_t records and destroyed thread IDs,
+ *         the generated data should be freed within the
+ *         sysinfo request context).
+ *
+ */
+static sysinfo_return_t get_stats_thread_changes(const char *name,
+    bool dry_run, void *data)
+{
+	/* Initially no return value */
+	sysinfo_return_t ret;
+	ret.tag = SYSINFO_VAL_UNDEFINED;
+
+	/* Parse the generation */
+	uint64_t since;
+	if (str_uint64_t(name, NULL, 0, true, &since) != EOK)
+		return ret;
+
+	/* See get_stats_task_changes() */
+	size_t gen = dry_run ? atomic_load(&stats_generation) :
+	    stats_generation_advance();
+
+	bool full = stats_delta_full(&gone_threads, since);
+	if (full)
+		since = 0;
+
+	/* Messing with threads structures, avoid deadlock */
+	irq_spinlock_lock(&threads_lock, true);
+
+	/* Count the changed threads */
+	size_t count = stats_threads_collect(since, gen, NULL, 0);
+
+	if (dry_run) {
+		irq_spinlock_unlock(&threads_lock, true);
+
+		size_t gone = full ? 0 :
+		    stats_gone_collect(&gone_threads, since, NULL);
+
+		ret.tag = SYSINFO_VAL_FUNCTION_DATA;
+		ret.data.data = NULL;
+		ret.data.size = sizeof(stats_delta_t) +
+		    sizeof(stats_thread_t) * count + sizeof(thread_id_t) * gone;
+		return ret;
+	}
+
+	stats_delta_t *delta = (stats_delta_t *) malloc(sizeof(stats_delta_t) +
+	    sizeof(stats_thread_t) * count +
+	    sizeof(thread_id_t) * gone_threads.size);
+	if (delta == NULL) {
+		/* No free space for allocation */
+		irq_spinlock_unlock(&threads_lock, true);
+		return ret;
+	}
+
+	thread_t **threads = (thread_t **) malloc(sizeof(thread_t *) * max(count, 1));
+	if (threads == NULL) {
+		/* No free space for allocation */
+		irq_spinlock_unlock(&threads_lock, true);
+		free(delta);
+		return ret;
+	}
+
+	/*
+	 * Threads might have been stamped with a newer generation in the
+	 * meantime, so there might be fewer of them now.
+	 */
+	count = stats_threads_collect(since, gen, threads, count);
+
+	/* Gather the statistics of the changed threads */
+	stats_thread_t *stats_threads = (stats_thread_t *) (delta + 1);
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		/* Interrupts are already disabled */
+		irq_spinlock_lock(&threads[i]->lock, false);
+
+		/* Record the statistics */
+		produce_stats_thread(threads[i], &stats_threads[i]);
+
+		irq_spinlock_unlock(&threads[i]->lock, false);
+	}
+
+	irq_spinlock_unlock(&threads_lock, true);
+	free(threads);
+
+	thread_id_t *gone_ids = (thread_id_t *) (stats_threads + i);
+
+	delta->generation = gen;
+	delta->count = i;
+	delta->gone = full ? 0 :
+	    stats_gone_collect(&gone_threads, since, gone_ids);
+	delta->full = full;
+
+	ret.tag = SYSINFO_VAL_FUNCTION_DATA;
+	ret.data.data = (void *) delta;
+	ret.data.size = sizeof(stats_delta_t) + sizeof(stats_thread_t) * i +
+	    sizeof(thread_id_t) * delta->gone;
+
+	return ret;
+}
+
 /** Get exceptions statistics
  *
  * @param item    Sysinfo item (unused).
@@ -735,12 +1283,66 @@ void kload(void *arg)
 		for (i = 0; i < LOAD_STEPS; i++)
 			avenrdy[i] = load_calc(avenrdy[i], load_exp[i], ready);
 
+		/* Publish the load in the statistics page */
+		if (stats_page != NULL) {
+			stats_page->load_seq++;
+			write_barrier();
+
+			for (i = 0; i < LOAD_STEPS; i++)
+				stats_page->load[i] = avenrdy[i] << LOAD_KERNEL_SHIFT;
+
+			write_barrier();
+			stats_page->load_seq++;
+		}
+
 		mutex_unlock(&load_lock);
 
 		thread_sleep(LOAD_INTERVAL);
 	}
 }
 
+/** Allocate the statistics page
+ *
+ * The page is mapped read-only by user space tasks, which
+ * can then read the per-CPU counters and the system load
+ * without a system call. If the page cannot be allocated,
+ * the statistics are still available through sysinfo.
+ *
+ */
+static void stats_page_init(void)
+{
+	size_t size = sizeof(stats_page_t) +
+	    sizeof(stats_cpu_slot_t) * config.cpu_count;
+	size_t frames = SIZE2FRAMES(size);
+
+	uintptr_t faddr = frame_alloc(frames, FRAME_LOWMEM | FRAME_ATOMIC, 0);
+	if (faddr == 0)
+		return;
+
+	stats_page_t *page = (stats_page_t *) PA2KA(faddr);
+	memsetb(page, FRAMES2SIZE(frames), 0);
+	page->cpu_count = config.cpu_count;
+
+	ddi_parea_init(&stats_parea);
+	stats_parea.pbase = faddr;
+	stats_parea.frames = frames;
+	stats_parea.unpriv = true;
+	stats_parea.mapped = false;
+	ddi_parea_register(&stats_parea);
+
+	/* Make the page visible to the CPUs only when initialized */
+	write_barrier();
+	stats_page = page;
+
+	/*
+	 * Prepare information for the userspace so that it can successfully
+	 * physmem_map() the stats_parea.
+	 *
+	 */
+	sysinfo_set_item_val("stats.faddr", NULL, (sysarg_t) faddr);
+	sysinfo_set_item_val("stats.frames", NULL, (sysarg_t) frames);
+}
+
 /** Register sysinfo statistical items
  *
  */
@@ -748,6 +1350,8 @@ void stats_init(void)
 {
 	mutex_initialize(&load_lock, MUTEX_PASSIVE);
 
+	stats_page_init();
+
 	sysinfo_set_item_gen_data("system.cpus", NULL, get_stats_cpus, NULL);
 	sysinfo_set_item_gen_data("system.physmem", NULL, get_stats_physmem, NULL);
 	sysinfo_set_item_gen_data("system.load", NULL, get_stats_load, NULL);
@@ -756,6 +1360,10 @@ void stats_init(void)
 	sysinfo_set_item_gen_data("system.exceptions", NULL, get_stats_exceptions, NULL);
 	sysinfo_set_subtree_fn("system.tasks", NULL, get_stats_task, NULL);
 	sysinfo_set_subtree_fn("system.threads", NULL, get_stats_thread, NULL);
+	sysinfo_set_subtree_fn("system.task_changes", NULL,
+	    get_stats_task_changes, NULL);
+	sysinfo_set_subtree_fn("system.thread_changes", NULL,
+	    get_stats_thread_changes, NULL);
 	sysinfo_set_subtree_fn("system.exceptions", NULL, get_stats_exception, NULL);
 }
 
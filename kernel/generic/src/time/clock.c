@@ -57,6 +57,8 @@
 #include <mm/frame.h>
 #include <ddi/ddi.h>
 #include <arch/cycle.h>
+#include <sysinfo/stats.h>
+#include <prof.h>
 
 /* Pointer to variable with uptime */
 uptime_t *uptime;
@@ -133,6 +135,7 @@ static void cpu_update_accounting(void)
 	uint64_t now = get_cycle();
 	CPU->busy_cycles += now - CPU->last_cycle;
 	CPU->last_cycle = now;
+	stats_cpu_publish(CPU);
 	irq_spinlock_unlock(&CPU->lock, false);
 }
 
@@ -150,6 +153,9 @@ void clock(void)
 	/* Account CPU usage */
 	cpu_update_accounting();
 
+	/* Sample the interrupted code if profiling */
+	prof_clock();
+
 	/*
 	 * To avoid lock ordering problems,
 	 * run all expired timeouts as you visit them.
@@ -210,6 +216,10 @@ void clock(void)
 			else
 				THREAD->ticks = 0;
 		}
+
+		/* The running thread keeps accumulating cycles */
+		stats_thread_changed(THREAD);
+		stats_task_changed(THREAD->task);
 		irq_spinlock_unlock(&THREAD->lock, false);
 
 		if (ticks == 0 && PREEMPTION_ENABLED) {
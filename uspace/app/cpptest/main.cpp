@@ -51,6 +51,8 @@
 #include <condition_variable>
 #include <deque>
 #include <exception>
+#include <execution>
+#include <flat_hash_map>
 #include <fstream>
 #include <functional>
 #include <initializer_list>
@@ -68,6 +70,7 @@
 #include <numeric>
 #include <ostream>
 #include <ratio>
+#include <regex>
 #include <sstream>
 #include <stack>
 #include <streambuf>
@@ -120,6 +123,10 @@ int main()
     ts.add<std::test::ratio_test>();
     ts.add<std::test::functional_test>();
     ts.add<std::test::algorithm_test>();
+    ts.add<std::test::regex_test>();
+    ts.add<std::test::execution_test>();
+    ts.add<std::test::iostream_test>();
+    ts.add<std::test::flat_hash_map_test>();
 
     return ts.run(true) ? 0 : 1;
 }
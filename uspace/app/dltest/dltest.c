@@ -36,11 +36,21 @@
  */
 
 #include <dlfcn.h>
+#include <errno.h>
 #include <libdltest.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
+#include <str_error.h>
+#include <task.h>
+#include <time.h>
+
+/** Number of program startups to time in the benchmark */
+#define BENCH_STARTUPS 20
+
+/** Number of symbol lookups to time in the benchmark */
+#define BENCH_LOOKUPS 10000
 
 /** libdltest library handle */
 static void *handle;
@@ -947,16 +957,127 @@ static int test_lnk(void)
 
 #endif /* DLTEST_LINKED */
 
+/** Time startup of a program.
+ *
+ * The program is started with the @c -q option, which makes it exit
+ * right away, so this measures loading and linking of the program.
+ *
+ * @param path Program path
+ * @param usec Place to store average startup time in microseconds
+ * @return EOK on success or an error code
+ */
+static errno_t bench_startup(const char *path, usec_t *usec)
+{
+	struct timespec t0, t1;
+	task_wait_t wait;
+	task_exit_t texit;
+	int retval;
+	errno_t rc;
+	int i;
+
+	getuptime(&t0);
+
+	for (i = 0; i < BENCH_STARTUPS; i++) {
+		rc = task_spawnl(NULL, &wait, path, path, "-q", NULL);
+		if (rc != EOK)
+			return rc;
+
+		rc = task_wait(&wait, &texit, &retval);
+		if (rc != EOK)
+			return rc;
+
+		if (texit != TASK_EXIT_NORMAL || retval != 0)
+			return EIO;
+	}
+
+	getuptime(&t1);
+
+	*usec = NSEC2USEC(ts_sub_diff(&t1, &t0)) / BENCH_STARTUPS;
+	return EOK;
+}
+
+/** Time symbol lookup via dlsym(). */
+static bool bench_lookup(void)
+{
+	struct timespec t0, t1;
+	void *sym;
+	int i;
+
+	printf("dlsym() x %d... ", BENCH_LOOKUPS);
+
+	getuptime(&t0);
+
+	for (i = 0; i < BENCH_LOOKUPS; i++) {
+		sym = dlsym(handle, "dl_get_private_fib_uvar");
+		if (sym == NULL) {
+			printf("FAILED\n");
+			return false;
+		}
+	}
+
+	getuptime(&t1);
+
+	printf("%lld ns per lookup\n",
+	    (long long) ts_sub_diff(&t1, &t0) / BENCH_LOOKUPS);
+	return true;
+}
+
+/** Run benchmarks.
+ *
+ * Compare startup time of the dynamically linked dltest with the
+ * statically linked dltests and time symbol lookup.
+ */
+static int bench(void)
+{
+	static const char *progs[] = {
+		"/app/dltest",
+		"/app/dltests"
+	};
+	usec_t usec;
+	errno_t rc;
+	size_t i;
+
+	for (i = 0; i < sizeof(progs) / sizeof(progs[0]); i++) {
+		printf("Startup of %s... ", progs[i]);
+		rc = bench_startup(progs[i], &usec);
+		if (rc != EOK) {
+			printf("FAILED (%s)\n", str_error(rc));
+			return 1;
+		}
+
+		printf("%lld us\n", (long long) usec);
+	}
+
+	handle = dlopen("libdltest.so.0", 0);
+	if (handle == NULL) {
+		printf("dlopen() FAILED\n");
+		return 1;
+	}
+
+	if (!bench_lookup())
+		return 1;
+
+	return 0;
+}
+
 static void print_syntax(void)
 {
-	fprintf(stderr, "syntax: dltest [-n]\n");
+	fprintf(stderr, "syntax: dltest [-n|-b|-q]\n");
 	fprintf(stderr, "\t-n Do not run dlfcn tests\n");
+	fprintf(stderr, "\t-b Run benchmarks\n");
+	fprintf(stderr, "\t-q Exit right after startup\n");
 }
 
 int main(int argc, char *argv[])
 {
+	if (argc == 2 && str_cmp(argv[1], "-q") == 0)
+		return 0;
+
 	printf("Dynamic linking test\n");
 
+	if (argc == 2 && str_cmp(argv[1], "-b") == 0)
+		return bench();
+
 	if (argc > 1) {
 		if (argc > 2) {
 			print_syntax();
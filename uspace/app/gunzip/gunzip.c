@@ -34,16 +34,21 @@
 
 #include <errno.h>
 #include <gzip.h>
+#include <mem.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+/** Size of the input and output buffers */
+#define BUFFER_SIZE  65536
+
 int main(int argc, char *argv[])
 {
 	errno_t rc;
-	void *data, *ddata;
-	size_t size, dsize;
+	gzip_stream_t *stream;
+	uint8_t *data, *ddata;
+	size_t size, used, dsize;
 	size_t nread, nwr;
-	long len;
 	FILE *f, *wf;
 
 	if (argc != 3) {
@@ -57,61 +62,70 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
-	if (fseek(f, 0, SEEK_END) < 0) {
-		printf("Error determining size of '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
-	}
-
-	len = ftell(f);
-	if (len < 0) {
-		printf("Error determining size of '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
-	}
-
-	if (fseek(f, 0, SEEK_SET) < 0) {
-		printf ("Error rewinding '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
-	}
-
-	data = malloc(len);
-	if (data == NULL) {
-		printf("Error allocating %ld bytes.\n", len);
-		fclose(f);
-		return 1;
-	}
-
-	nread = fread(data, 1, len, f);
-	if (nread != (size_t)len) {
-		printf("Error reading '%s'\n", argv[1]);
+	data = malloc(BUFFER_SIZE);
+	ddata = malloc(BUFFER_SIZE);
+	if ((data == NULL) || (ddata == NULL)) {
+		printf("Error allocating buffers.\n");
 		fclose(f);
 		return 1;
 	}
 
-	fclose(f);
-
-	size = (size_t) len;
-
-	rc = gzip_expand(data, size, &ddata, &dsize);
+	rc = gzip_stream_create(&stream);
 	if (rc != EOK) {
-		printf("Error decompressing data.\n");
+		printf("Error allocating decompressor.\n");
+		fclose(f);
 		return 1;
 	}
 
 	wf = fopen(argv[2], "wb");
 	if (wf == NULL) {
 		printf("Error creating file '%s'\n", argv[2]);
+		fclose(f);
 		return 1;
 	}
 
-	nwr = fwrite(ddata, 1, dsize, wf);
-	if (nwr != dsize) {
-		printf("Error writing '%s'\n", argv[2]);
-		fclose(wf);
-		return 1;
-	}
+	/* Bytes in the input buffer not consumed yet */
+	size = 0;
+
+	do {
+		nread = fread(data + size, 1, BUFFER_SIZE - size, f);
+		if (ferror(f)) {
+			printf("Error reading '%s'\n", argv[1]);
+			goto error;
+		}
+
+		size += nread;
+
+		/* Drain the decompressed data as long as there is progress */
+		do {
+			rc = gzip_stream_process(stream, data, size, &used, ddata,
+			    BUFFER_SIZE, &dsize);
+
+			nwr = fwrite(ddata, 1, dsize, wf);
+			if (nwr != dsize) {
+				printf("Error writing '%s'\n", argv[2]);
+				goto error;
+			}
+
+			memmove(data, data + used, size - used);
+			size -= used;
+		} while ((rc == EAGAIN) && (dsize == BUFFER_SIZE));
+
+		if ((rc != EOK) && (rc != EAGAIN)) {
+			printf("Error decompressing data.\n");
+			goto error;
+		}
+
+		if ((rc == EAGAIN) && (nread == 0)) {
+			printf("Error decompressing data (truncated input).\n");
+			goto error;
+		}
+	} while (rc != EOK);
+
+	gzip_stream_destroy(stream);
+	free(data);
+	free(ddata);
+	fclose(f);
 
 	if (fclose(wf) != 0) {
 		printf("Error writing '%s'\n", argv[2]);
@@ -119,6 +133,14 @@ int main(int argc, char *argv[])
 	}
 
 	return 0;
+
+error:
+	gzip_stream_destroy(stream);
+	free(data);
+	free(ddata);
+	fclose(f);
+	fclose(wf);
+	return 1;
 }
 
 /** @}
@@ -35,6 +35,7 @@
 #include <stdlib.h>
 #include <async.h>
 #include <errno.h>
+#include <str.h>
 #include <str_error.h>
 #include <io/logctl.h>
 
@@ -55,11 +56,40 @@ static void usage(const char *progname)
 	fprintf(stderr, "Usage:\n");
 	fprintf(stderr, "  %s <default-logging-level>\n", progname);
 	fprintf(stderr, "  %s <log-name> <logging-level>\n", progname);
+	fprintf(stderr, "  %s -r\n", progname);
+	fprintf(stderr, "    (print recent messages)\n");
+}
+
+/** Size of buffer for recent messages. */
+#define RECENT_BUF_SIZE 16384
+
+static int print_recent(void)
+{
+	char *buf = malloc(RECENT_BUF_SIZE);
+	if (buf == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		return 2;
+	}
+
+	size_t nread;
+	errno_t rc = logctl_get_recent(buf, RECENT_BUF_SIZE, &nread);
+	if (rc != EOK) {
+		fprintf(stderr, "Failed to read recent messages: %s.\n",
+		    str_error(rc));
+		free(buf);
+		return 2;
+	}
+
+	fwrite(buf, 1, nread, stdout);
+	free(buf);
+	return 0;
 }
 
 int main(int argc, char *argv[])
 {
-	if (argc == 2) {
+	if ((argc == 2) && (str_cmp(argv[1], "-r") == 0)) {
+		return print_recent();
+	} else if (argc == 2) {
 		log_level_t new_default_level = parse_log_level_or_die(argv[1]);
 		errno_t rc = logctl_set_default_level(new_default_level);
 
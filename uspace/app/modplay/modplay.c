@@ -132,7 +132,7 @@ int main(int argc, char *argv[])
 #else
 	format.sample_format = PCM_SAMPLE_SINT16_BE;
 #endif
-	buffer_size = 64 * 1024;
+	buffer_size = 16 * 1024;
 
 	buffer = malloc(buffer_size);
 	if (buffer == NULL) {
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <deflate.h>
+#include <inflate.h>
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+#include "../perf.h"
+
+/** Size of the benchmark data */
+#define DATA_SIZE  (4 * 1024 * 1024)
+
+/** Number of samples per compression level */
+#define NUM_SAMPLES  3
+
+/** Fill buffer with compressible data
+ *
+ * Mimics text with a skewed word distribution interleaved
+ * with runs of equal bytes and stretches of noise.
+ *
+ */
+static void bench_data_fill(uint8_t *buf, size_t len)
+{
+	static const char *words[] = {
+		"the ", "of ", "and ", "a ", "to ", "in ", "is ", "you ",
+		"that ", "it ", "kernel ", "task ", "thread ", "server ",
+		"location ", "service ", "driver ", "memory ", "\n", ", "
+	};
+
+	uint32_t seed = 1;
+	size_t pos = 0;
+
+	while (pos < len) {
+		seed = seed * 1103515245 + 12345;
+		unsigned int kind = (seed >> 16) % 32;
+		size_t cnt;
+
+		if (kind < 29) {
+			/* Smaller indices are more frequent */
+			unsigned int idx = (seed >> 21) % 20;
+			idx = (idx * idx) / 20;
+
+			const char *word = words[idx];
+			for (cnt = 0; (word[cnt] != 0) && (pos < len); cnt++)
+				buf[pos++] = word[cnt];
+		} else if (kind < 31) {
+			for (cnt = (seed >> 24); (cnt > 0) && (pos < len); cnt--)
+				buf[pos++] = ' ';
+		} else {
+			for (cnt = (seed >> 26); (cnt > 0) && (pos < len); cnt--) {
+				seed = seed * 1103515245 + 12345;
+				buf[pos++] = seed >> 24;
+			}
+		}
+	}
+}
+
+/** Compute throughput in MB/s
+ *
+ */
+static uint64_t deflate_throughput(size_t size, uint64_t duration)
+{
+	if (duration == 0)
+		return 0;
+
+	return size / duration;
+}
+
+const char *bench_deflate(void)
+{
+	const char *msg = NULL;
+	size_t bound = deflate_bound(DATA_SIZE);
+
+	uint8_t *data = malloc(DATA_SIZE);
+	uint8_t *comp = malloc(bound);
+	uint8_t *back = malloc(DATA_SIZE);
+
+	if ((data == NULL) || (comp == NULL) || (back == NULL)) {
+		msg = "Out of memory.";
+		goto out;
+	}
+
+	bench_data_fill(data, DATA_SIZE);
+
+	printf("Level  Ratio  Compress  Decompress\n");
+
+	unsigned int level;
+	for (level = 0; level <= DEFLATE_LEVEL_MAX; level++) {
+		uint64_t best_comp = UINT64_MAX;
+		uint64_t best_decomp = UINT64_MAX;
+		size_t size = 0;
+		int i;
+
+		for (i = 0; i < NUM_SAMPLES; i++) {
+			struct timespec start;
+			struct timespec now;
+
+			getuptime(&start);
+			errno_t rc = deflate_compress(data, DATA_SIZE, comp, bound,
+			    &size, level);
+			getuptime(&now);
+
+			if (rc != EOK) {
+				msg = "Compression failed.";
+				goto out;
+			}
+
+			uint64_t duration = ts_sub_diff(&now, &start) / 1000;
+			if (duration < best_comp)
+				best_comp = duration;
+
+			getuptime(&start);
+			rc = inflate(comp, size, back, DATA_SIZE);
+			getuptime(&now);
+
+			if ((rc != EOK) || (memcmp(data, back, DATA_SIZE) != 0)) {
+				msg = "Round trip failed.";
+				goto out;
+			}
+
+			duration = ts_sub_diff(&now, &start) / 1000;
+			if (duration < best_decomp)
+				best_decomp = duration;
+		}
+
+		printf("%5u  %4zu%%  %4" PRIu64 " MB/s  %5" PRIu64 " MB/s\n",
+		    level, size * 100 / DATA_SIZE,
+		    deflate_throughput(DATA_SIZE, best_comp),
+		    deflate_throughput(DATA_SIZE, best_decomp));
+	}
+
+out:
+	free(back);
+	free(comp);
+	free(data);
+
+	return msg;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup perf
+ * @{
+ */
+/**
+ * @file
+ * Compares the open addressing std::flat_hash_map against
+ * the node based std::unordered_map.
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <flat_hash_map>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    using bench_clock = std::chrono::steady_clock;
+
+    uint64_t usecs_since(bench_clock::time_point start)
+    {
+        auto dur = bench_clock::now() - start;
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(dur).count();
+    }
+
+    void report(const char* what, uint64_t node, uint64_t flat)
+    {
+        std::printf("%s: unordered_map %" PRIu64 " us, flat_hash_map %"
+                    PRIu64 " us\n", what, node, flat);
+    }
+
+    constexpr size_t element_count = 1 << 18;
+
+    /**
+     * Runs the same workload on both maps, returns nullptr
+     * if their results agree.
+     */
+    template<class Map>
+    struct workload
+    {
+        Map map{};
+        uint64_t insert_time{};
+        uint64_t hit_time{};
+        uint64_t miss_time{};
+        uint64_t erase_time{};
+        uint64_t checksum{};
+
+        void run(const std::vector<uint32_t>& keys)
+        {
+            auto start = bench_clock::now();
+            for (size_t i = 0; i < keys.size(); ++i)
+                map[keys[i]] = static_cast<uint32_t>(i);
+            insert_time = usecs_since(start);
+
+            start = bench_clock::now();
+            for (auto key: keys)
+            {
+                auto it = map.find(key);
+                if (it != map.end())
+                    checksum += it->second;
+            }
+            hit_time = usecs_since(start);
+
+            /**
+             * The keys are all even, so these are
+             * guaranteed misses.
+             */
+            start = bench_clock::now();
+            for (auto key: keys)
+                checksum += map.count(key + 1);
+            miss_time = usecs_since(start);
+
+            start = bench_clock::now();
+            for (size_t i = 0; i < keys.size(); i += 2)
+                map.erase(keys[i]);
+            erase_time = usecs_since(start);
+
+            checksum += map.size();
+        }
+    };
+}
+
+extern "C" const char* bench_hashmap(void)
+{
+    std::vector<uint32_t> keys(element_count);
+    uint32_t seed{12345};
+    for (auto& x: keys)
+    {
+        seed = seed * 1103515245U + 12345U;
+        x = (seed >> 2) & ~1U;
+    }
+
+    workload<std::unordered_map<uint32_t, uint32_t>> node{};
+    node.run(keys);
+
+    workload<std::flat_hash_map<uint32_t, uint32_t>> flat{};
+    flat.run(keys);
+
+    report("insert", node.insert_time, flat.insert_time);
+    report("lookup hit", node.hit_time, flat.hit_time);
+    report("lookup miss", node.miss_time, flat.miss_time);
+    report("erase", node.erase_time, flat.erase_time);
+
+    if (node.checksum != flat.checksum)
+        return "Map results differ.";
+
+    return nullptr;
+}
+
+/** @}
+ */
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup perf
+ * @{
+ */
+/**
+ * @file
+ * Compares the sequential algorithms against their parallel
+ * versions running on the work stealing pool.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <execution>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using bench_clock = std::chrono::steady_clock;
+
+    uint64_t usecs_since(bench_clock::time_point start)
+    {
+        auto dur = bench_clock::now() - start;
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(dur).count();
+    }
+
+    void report(const char* what, uint64_t seq, uint64_t par)
+    {
+        std::printf("%s: sequential %" PRIu64 " us, parallel %" PRIu64
+                    " us\n", what, seq, par);
+    }
+
+    void fill_random(std::vector<uint32_t>& data)
+    {
+        uint32_t seed{12345};
+        for (auto& x: data)
+        {
+            seed = seed * 1103515245U + 12345U;
+            x = seed >> 4;
+        }
+    }
+
+    constexpr size_t element_count = 1 << 20;
+}
+
+extern "C" const char* bench_parallel(void)
+{
+    std::printf("hardware concurrency: %u\n",
+                std::thread::hardware_concurrency());
+
+    std::vector<uint32_t> data(element_count);
+    fill_random(data);
+
+    /**
+     * Cheap per element work, mostly bound by
+     * memory bandwidth.
+     */
+    auto start = bench_clock::now();
+    auto seq_sum = std::transform_reduce(
+        data.begin(), data.end(), uint64_t{},
+        [](uint64_t x, uint64_t y){ return x + y; },
+        [](uint32_t x){ return uint64_t{x} * x % 1000; }
+    );
+    auto seq = usecs_since(start);
+
+    start = bench_clock::now();
+    auto par_sum = std::transform_reduce(
+        std::execution::par, data.begin(), data.end(), uint64_t{},
+        [](uint64_t x, uint64_t y){ return x + y; },
+        [](uint32_t x){ return uint64_t{x} * x % 1000; }
+    );
+    auto par = usecs_since(start);
+
+    report("transform_reduce", seq, par);
+    if (seq_sum != par_sum)
+        return "transform_reduce results differ.";
+
+    auto copy = data;
+
+    start = bench_clock::now();
+    std::sort(data.begin(), data.end());
+    seq = usecs_since(start);
+
+    start = bench_clock::now();
+    std::sort(std::execution::par, copy.begin(), copy.end());
+    par = usecs_since(start);
+
+    report("sort", seq, par);
+    if (!std::equal(data.begin(), data.end(), copy.begin()))
+        return "sort results differ.";
+
+    return nullptr;
+}
+
+/** @}
+ */
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup perf
+ * @{
+ */
+/**
+ * @file
+ * Compares the automaton based std::regex against a simple
+ * backtracking matcher on a log scanning workload and on
+ * a pattern that is exponential for backtracking.
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * Backtracking matcher in the style of the classic
+     * Kernighan & Pike one, supports literals, '.', '^',
+     * '$', '*' and '?'.
+     */
+    bool bt_match_here(const char* re, const char* text);
+
+    bool bt_match_star(char c, const char* re, const char* text)
+    {
+        do
+        {
+            if (bt_match_here(re, text))
+                return true;
+        } while (*text != '\0' && (*text++ == c || c == '.'));
+
+        return false;
+    }
+
+    bool bt_match_here(const char* re, const char* text)
+    {
+        if (re[0] == '\0')
+            return true;
+        if (re[1] == '*')
+            return bt_match_star(re[0], re + 2, text);
+        if (re[1] == '?')
+        {
+            if (*text != '\0' && (re[0] == '.' || re[0] == *text) &&
+                bt_match_here(re + 2, text + 1))
+                return true;
+
+            return bt_match_here(re + 2, text);
+        }
+        if (re[0] == '$' && re[1] == '\0')
+            return *text == '\0';
+        if (*text != '\0' && (re[0] == '.' || re[0] == *text))
+            return bt_match_here(re + 1, text + 1);
+
+        return false;
+    }
+
+    bool bt_search(const char* re, const char* text)
+    {
+        if (re[0] == '^')
+            return bt_match_here(re + 1, text);
+
+        do
+        {
+            if (bt_match_here(re, text))
+                return true;
+        } while (*text++ != '\0');
+
+        return false;
+    }
+
+    using bench_clock = std::chrono::steady_clock;
+
+    uint64_t usecs_since(bench_clock::time_point start)
+    {
+        auto dur = bench_clock::now() - start;
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(dur).count();
+    }
+
+    void report(const char* what, size_t count, uint64_t nfa, uint64_t bt)
+    {
+        std::printf("%s: %zu matches, std::regex %" PRIu64 " us, "
+                    "backtracking %" PRIu64 " us\n", what, count, nfa, bt);
+    }
+
+    constexpr size_t log_lines = 20000;
+    constexpr size_t pathological_n = 22;
+}
+
+extern "C" const char* bench_regex(void)
+{
+    /**
+     * Log scanning, most lines do not match, which is
+     * where the lazy DFA shines.
+     */
+    std::vector<std::string> lines{};
+    for (size_t i = 0; i < log_lines; ++i)
+    {
+        char buf[96];
+        std::snprintf(
+            buf, sizeof(buf), "%zu kernel: %s device %zu state changed",
+            i, (i % 97 == 0) ? "error:" : "info:", i % 13
+        );
+        lines.emplace_back(buf);
+    }
+
+    const char* log_re = "error:.*device 1.* state";
+    std::regex log_regex{log_re};
+
+    auto start = bench_clock::now();
+
+    size_t count{};
+    for (const auto& line: lines)
+    {
+        if (std::regex_search(line, log_regex))
+            ++count;
+    }
+    auto nfa = usecs_since(start);
+
+    start = bench_clock::now();
+    size_t bt_count{};
+    for (const auto& line: lines)
+    {
+        if (bt_search(log_re, line.c_str()))
+            ++bt_count;
+    }
+    auto bt = usecs_since(start);
+
+    report("log scan", count, nfa, bt);
+    if (count != bt_count)
+        return "Log scan results differ.";
+
+    /**
+     * The pattern a?^n a^n against a^n, requires 2^n steps
+     * for a backtracking matcher.
+     */
+    std::string path_re{"^"};
+    for (size_t i = 0; i < pathological_n; ++i)
+        path_re += "a?";
+    path_re.append(pathological_n, 'a');
+    path_re += "$";
+    std::string text(pathological_n, 'a');
+
+    std::regex path_regex{path_re};
+
+    start = bench_clock::now();
+    count = std::regex_match(text, path_regex) ? 1 : 0;
+    nfa = usecs_since(start);
+
+    std::smatch m{};
+    start = bench_clock::now();
+    std::regex_match(text, m, path_regex);
+    auto pike = usecs_since(start);
+
+    start = bench_clock::now();
+    bt_count = bt_search(path_re.c_str(), text.c_str()) ? 1 : 0;
+    bt = usecs_since(start);
+
+    report("pathological", count, nfa, bt);
+    std::printf("pathological with submatches: %" PRIu64 " us\n", pike);
+    if (count != bt_count || !m.ready() || m.length() != static_cast<std::ptrdiff_t>(pathological_n))
+        return "Pathological results differ.";
+
+    return nullptr;
+}
+
+/** @}
+ */
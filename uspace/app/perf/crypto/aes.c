@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <crypto.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../perf.h"
+
+/** Size of the benchmark buffer */
+#define DATA_SIZE  (1024 * 1024)
+
+/** Number of passes over the buffer per sample */
+#define NUM_PASSES  8
+
+/** Number of samples per mode */
+#define NUM_SAMPLES  3
+
+typedef enum {
+	AES_BENCH_CTR,
+	AES_BENCH_CBC_ENC,
+	AES_BENCH_CBC_DEC,
+	AES_BENCH_CCM,
+	AES_BENCH_GCM
+} aes_bench_mode_t;
+
+static const char *mode_names[] = {
+	"CTR",
+	"CBC encrypt",
+	"CBC decrypt",
+	"CCM",
+	"GCM"
+};
+
+#define MODE_COUNT  (sizeof(mode_names) / sizeof(mode_names[0]))
+
+/** Run one pass of a mode over the whole buffer */
+static errno_t aes_bench_pass(aes_context_t *ctx, aes_bench_mode_t mode,
+    uint8_t *buf)
+{
+	uint8_t iv[AES_BLOCK_LENGTH] = { 0 };
+	uint8_t tag[AES_BLOCK_LENGTH];
+
+	switch (mode) {
+	case AES_BENCH_CTR:
+		aes_ctr_crypt(ctx, iv, buf, buf, DATA_SIZE);
+		return EOK;
+	case AES_BENCH_CBC_ENC:
+		return aes_cbc_encrypt(ctx, iv, buf, buf, DATA_SIZE);
+	case AES_BENCH_CBC_DEC:
+		return aes_cbc_decrypt(ctx, iv, buf, buf, DATA_SIZE);
+	case AES_BENCH_CCM:
+		return aes_ccm_encrypt(ctx, iv, 13, NULL, 0, buf, buf,
+		    DATA_SIZE, tag, sizeof(tag));
+	case AES_BENCH_GCM:
+		return aes_gcm_encrypt(ctx, iv, 12, NULL, 0, buf, buf,
+		    DATA_SIZE, tag, sizeof(tag));
+	}
+
+	return EINVAL;
+}
+
+/** Measure best throughput of a mode in MB/s */
+static errno_t aes_bench_mode(aes_context_t *ctx, aes_bench_mode_t mode,
+    uint8_t *buf, uint64_t *rate)
+{
+	uint64_t best = UINT64_MAX;
+
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		struct timespec start;
+		struct timespec now;
+
+		getuptime(&start);
+		for (int j = 0; j < NUM_PASSES; j++) {
+			errno_t rc = aes_bench_pass(ctx, mode, buf);
+			if (rc != EOK)
+				return rc;
+		}
+		getuptime(&now);
+
+		uint64_t duration = ts_sub_diff(&now, &start) / 1000;
+		if (duration < best)
+			best = duration;
+	}
+
+	*rate = (best == 0) ? 0 : (uint64_t) DATA_SIZE * NUM_PASSES / best;
+	return EOK;
+}
+
+const char *bench_aes(void)
+{
+	static const uint8_t key[AES_KEY_128] = {
+		0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+		0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+	};
+
+	aes_context_t generic;
+	aes_context_t accel;
+
+	if (aes_init_generic(&generic, key, sizeof(key)) != EOK ||
+	    aes_init(&accel, key, sizeof(key)) != EOK)
+		return "Key expansion failed.";
+
+	uint8_t *buf = calloc(1, DATA_SIZE);
+	if (buf == NULL)
+		return "Out of memory.";
+
+	const char *msg = NULL;
+
+	printf("Mode         Generic  %s\n",
+	    accel.accel ? "AES-NI" : "(no acceleration)");
+
+	for (size_t mode = 0; mode < MODE_COUNT; mode++) {
+		uint64_t rate_generic;
+		uint64_t rate_accel = 0;
+
+		if (aes_bench_mode(&generic, mode, buf, &rate_generic) != EOK) {
+			msg = "Encryption failed.";
+			goto out;
+		}
+
+		if (accel.accel &&
+		    aes_bench_mode(&accel, mode, buf, &rate_accel) != EOK) {
+			msg = "Encryption failed.";
+			goto out;
+		}
+
+		printf("%-11s  %4" PRIu64 " MB/s", mode_names[mode],
+		    rate_generic);
+		if (accel.accel)
+			printf("  %4" PRIu64 " MB/s", rate_accel);
+		printf("\n");
+	}
+
+out:
+	free(buf);
+	return msg;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <crypto.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../perf.h"
+
+/** Size of the benchmark buffer */
+#define DATA_SIZE  (4 * 1024 * 1024)
+
+/** Number of samples per hash function */
+#define NUM_SAMPLES  3
+
+/** Number of PBKDF2 derivations */
+#define PBKDF2_COUNT  16
+
+static const hash_func_t funcs[] = {
+	HASH_MD5,
+	HASH_SHA1,
+	HASH_SHA256,
+	HASH_SHA512
+};
+
+static const char *func_names[] = {
+	"MD5",
+	"SHA-1",
+	"SHA-256",
+	"SHA-512"
+};
+
+#define FUNC_COUNT  (sizeof(funcs) / sizeof(funcs[0]))
+
+/** Measure best hashing throughput in MB/s */
+static uint64_t hash_bench_func(hash_func_t func, bool generic,
+    const uint8_t *buf, bool *accel)
+{
+	uint64_t best = UINT64_MAX;
+	uint8_t out[HASH_MAX_LENGTH];
+
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		struct timespec start;
+		struct timespec now;
+		hash_ctx_t ctx;
+
+		getuptime(&start);
+		if (generic)
+			(void) hash_init_generic(&ctx, func);
+		else
+			(void) hash_init(&ctx, func);
+		hash_update(&ctx, buf, DATA_SIZE);
+		hash_final(&ctx, out);
+		getuptime(&now);
+
+		*accel = ctx.accel;
+
+		uint64_t duration = ts_sub_diff(&now, &start) / 1000;
+		if (duration < best)
+			best = duration;
+	}
+
+	return (best == 0) ? 0 : DATA_SIZE / best;
+}
+
+const char *bench_hash(void)
+{
+	uint8_t *buf = calloc(1, DATA_SIZE);
+	if (buf == NULL)
+		return "Out of memory.";
+
+	printf("Function  Generic    Default\n");
+
+	for (size_t f = 0; f < FUNC_COUNT; f++) {
+		bool accel;
+
+		uint64_t rate_generic = hash_bench_func(funcs[f], true, buf,
+		    &accel);
+		uint64_t rate = hash_bench_func(funcs[f], false, buf, &accel);
+
+		printf("%-8s  %4" PRIu64 " MB/s  %4" PRIu64 " MB/s%s\n",
+		    func_names[f], rate_generic, rate,
+		    accel ? " (SHA-NI)" : "");
+	}
+
+	free(buf);
+
+	struct timespec start;
+	struct timespec now;
+	uint8_t key[PBKDF2_KEY_LENGTH];
+
+	getuptime(&start);
+	for (int i = 0; i < PBKDF2_COUNT; i++) {
+		if (pbkdf2((uint8_t *) "password", 8, (uint8_t *) "IEEE", 4,
+		    key) != EOK)
+			return "PBKDF2 failed.";
+	}
+	getuptime(&now);
+
+	uint64_t duration = ts_sub_diff(&now, &start) / 1000;
+	printf("PBKDF2-SHA1 (4096 iterations): %" PRIu64 " us per key\n",
+	    duration / PBKDF2_COUNT);
+
+	return NULL;
+}
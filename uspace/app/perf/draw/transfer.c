@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <drawctx.h>
+#include <errno.h>
+#include <filter.h>
+#include <source.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <surface.h>
+#include <time.h>
+#include <transform.h>
+#include "../perf.h"
+
+/** Size of the destination surface (typical viewport) */
+#define DST_WIDTH  1024
+#define DST_HEIGHT  768
+
+/** Size of the transferred window */
+#define SRC_WIDTH  640
+#define SRC_HEIGHT  480
+
+/** Number of transfers per case */
+#define NUM_FRAMES  20
+
+typedef enum {
+	CASE_TRANSLATE,
+	CASE_SCALE,
+	CASE_ROTATE
+} transfer_case_t;
+
+static const struct {
+	const char *name;
+	transfer_case_t type;
+	filter_t filter;
+	bool opaque;
+	uint8_t opacity;
+} cases[] = {
+	{ "translate, opaque", CASE_TRANSLATE, filter_nearest, true, 255 },
+	{ "translate, alpha", CASE_TRANSLATE, filter_nearest, false, 255 },
+	{ "translate, opacity", CASE_TRANSLATE, filter_nearest, true, 192 },
+	{ "scale, nearest", CASE_SCALE, filter_nearest, true, 255 },
+	{ "scale, bilinear", CASE_SCALE, filter_bilinear, true, 255 },
+	{ "rotate, bilinear", CASE_ROTATE, filter_bilinear, true, 255 }
+};
+
+#define CASE_COUNT  (sizeof(cases) / sizeof(cases[0]))
+
+static void texture_fill(surface_t *texture, bool opaque)
+{
+	pixelmap_t *pixmap = surface_pixmap_access(texture);
+
+	for (sysarg_t y = 0; y < pixmap->height; y++) {
+		for (sysarg_t x = 0; x < pixmap->width; x++) {
+			uint8_t alpha = opaque ? 255 : (x + y) & 0xff;
+			pixmap->data[y * pixmap->width + x] =
+			    PIXEL(alpha, x, y, x ^ y);
+		}
+	}
+}
+
+/** Measure transfers of a window to the destination surface
+ *
+ * @return Throughput in pixels per microsecond
+ */
+static uint64_t transfer_bench_case(size_t c, surface_t *dst,
+    surface_t *texture)
+{
+	transform_t transform;
+	source_t source;
+	drawctx_t context;
+
+	texture_fill(texture, cases[c].opaque);
+
+	transform_identity(&transform);
+	switch (cases[c].type) {
+	case CASE_TRANSLATE:
+		break;
+	case CASE_SCALE:
+		transform_scale(&transform, 1.5, 1.5);
+		break;
+	case CASE_ROTATE:
+		transform_rotate(&transform, 0.3);
+		break;
+	}
+	transform_translate(&transform, 100, 50);
+
+	source_init(&source);
+	source_set_filter(&source, cases[c].filter);
+	source_set_transform(&source, transform);
+	source_set_texture(&source, texture,
+	    PIXELMAP_EXTEND_TRANSPARENT_SIDES);
+	source_set_alpha(&source, PIXEL(cases[c].opacity, 0, 0, 0));
+
+	drawctx_init(&context, dst);
+	drawctx_set_compose(&context, compose_over);
+	drawctx_set_source(&context, &source);
+
+	struct timespec start;
+	struct timespec now;
+
+	getuptime(&start);
+	for (int i = 0; i < NUM_FRAMES; i++)
+		drawctx_transfer(&context, 0, 0, DST_WIDTH, DST_HEIGHT);
+	getuptime(&now);
+
+	uint64_t duration = ts_sub_diff(&now, &start) / 1000;
+	uint64_t pixels = (uint64_t) DST_WIDTH * DST_HEIGHT * NUM_FRAMES;
+
+	return (duration == 0) ? 0 : pixels / duration;
+}
+
+const char *bench_transfer(void)
+{
+	surface_t *dst = surface_create(DST_WIDTH, DST_HEIGHT, NULL,
+	    SURFACE_FLAG_NONE);
+	surface_t *texture = surface_create(SRC_WIDTH, SRC_HEIGHT, NULL,
+	    SURFACE_FLAG_NONE);
+
+	if (dst == NULL || texture == NULL) {
+		if (dst != NULL)
+			surface_destroy(dst);
+		if (texture != NULL)
+			surface_destroy(texture);
+		return "Out of memory.";
+	}
+
+	printf("Transfer of %ux%u area (Mpx/s, full frames/s)\n", DST_WIDTH,
+	    DST_HEIGHT);
+
+	for (size_t c = 0; c < CASE_COUNT; c++) {
+		uint64_t rate = transfer_bench_case(c, dst, texture);
+
+		printf("%-20s %5" PRIu64 " Mpx/s %5" PRIu64 " fps\n",
+		    cases[c].name, rate,
+		    rate * 1000000 / (DST_WIDTH * DST_HEIGHT));
+	}
+
+	surface_destroy(texture);
+	surface_destroy(dst);
+	return NULL;
+}
@@ -40,6 +40,13 @@
 #include "perf.h"
 
 benchmark_t benchmarks[] = {
+#include "compress/deflate.def"
+#include "cpp/hashmap.def"
+#include "cpp/parallel.def"
+#include "cpp/regex.def"
+#include "crypto/aes.def"
+#include "crypto/hash.def"
+#include "draw/transfer.def"
 #include "ipc/ns_ping.def"
 #include "ipc/ping_pong.def"
 #include "malloc/malloc1.def"
@@ -125,11 +132,19 @@ int main(int argc, char *argv[])
 {
 	if (argc < 2) {
 		printf("Usage:\n\n");
-		printf("%s <benchmark>\n\n", argv[0]);
+		printf("%s <benchmark>\n", argv[0]);
+		printf("%s record [-i <ticks>] <seconds> [<file>]\n", argv[0]);
+		printf("%s report [<file>]\n\n", argv[0]);
 		list_benchmarks();
 		return 0;
 	}
 
+	if (str_cmp(argv[1], "record") == 0)
+		return perf_record(argc - 2, argv + 2);
+
+	if (str_cmp(argv[1], "report") == 0)
+		return perf_report(argc - 2, argv + 2);
+
 	if (str_cmp(argv[1], "*") == 0) {
 		return run_benchmarks();
 	}
@@ -45,13 +45,23 @@ typedef struct {
 	benchmark_entry_t entry;
 } benchmark_t;
 
+extern const char *bench_aes(void);
+extern const char *bench_deflate(void);
+extern const char *bench_hash(void);
+extern const char *bench_hashmap(void);
 extern const char *bench_malloc1(void);
 extern const char *bench_malloc2(void);
 extern const char *bench_ns_ping(void);
+extern const char *bench_parallel(void);
 extern const char *bench_ping_pong(void);
+extern const char *bench_regex(void);
+extern const char *bench_transfer(void);
 
 extern benchmark_t benchmarks[];
 
+extern int perf_record(int, char *[]);
+extern int perf_report(int, char *[]);
+
 #endif
 
 /** @}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup perf
+ * @{
+ */
+/** @file
+ */
+
+#ifndef PROF_PROFILE_H_
+#define PROF_PROFILE_H_
+
+#include <abi/sysinfo.h>
+#include <stdint.h>
+
+/** File written by perf record when none is given */
+#define PROFILE_DEFAULT_FILE  "/tmp/perf.data"
+
+#define PROFILE_MAGIC  "HPRF"
+
+/** Profile file header
+ *
+ * The header is followed by task_count profile_task_t records
+ * and sample_count prof_sample_t records.
+ *
+ */
+typedef struct {
+	char magic[4];
+	uint32_t task_count;
+	uint64_t sample_count;
+	/** Samples lost in the kernel */
+	uint64_t dropped;
+	/** Clock ticks between two samples */
+	uint64_t interval;
+} profile_header_t;
+
+typedef struct {
+	uint64_t task_id;
+	char name[TASK_NAME_BUFLEN];
+} profile_task_t;
+
+#endif
+
+/** @}
+ */
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup perf
+ * @{
+ */
+/**
+ * @file
+ * @brief Record samples from the kernel sampling profiler.
+ */
+
+#include <errno.h>
+#include <fibril.h>
+#include <macros.h>
+#include <mem.h>
+#include <prof.h>
+#include <stats.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include <time.h>
+#include "../perf.h"
+#include "profile.h"
+
+/** How often the kernel buffers are drained */
+#define RECORD_POLL_USEC  MSEC2USEC(100)
+
+/** Number of samples requested from the kernel at once */
+#define RECORD_READ_SAMPLES  256
+
+typedef struct {
+	prof_sample_t *samples;
+	size_t count;
+	size_t size;
+	profile_task_t *tasks;
+	size_t task_count;
+} record_t;
+
+/** Read all samples currently buffered in the kernel. */
+static errno_t record_drain(record_t *rec)
+{
+	while (true) {
+		if (rec->count + RECORD_READ_SAMPLES > rec->size) {
+			size_t size = max(2 * rec->size, RECORD_READ_SAMPLES);
+			prof_sample_t *samples = realloc(rec->samples,
+			    size * sizeof(prof_sample_t));
+			if (samples == NULL)
+				return ENOMEM;
+
+			rec->samples = samples;
+			rec->size = size;
+		}
+
+		size_t nread;
+		errno_t rc = prof_read(rec->samples + rec->count,
+		    RECORD_READ_SAMPLES, &nread);
+		if (rc != EOK)
+			return rc;
+
+		rec->count += nread;
+		if (nread < RECORD_READ_SAMPLES)
+			return EOK;
+	}
+}
+
+/** Remember names of the running tasks.
+ *
+ * Called both at the start and at the end of the recording so that
+ * tasks which were started or terminated in between are covered too.
+ *
+ */
+static errno_t record_tasks(record_t *rec)
+{
+	size_t count;
+	stats_task_t *stats = stats_get_tasks(&count);
+	if (stats == NULL)
+		return ENOMEM;
+
+	for (size_t i = 0; i < count; i++) {
+		size_t j;
+		for (j = 0; j < rec->task_count; j++) {
+			if (rec->tasks[j].task_id == stats[i].task_id)
+				break;
+		}
+
+		if (j < rec->task_count)
+			continue;
+
+		profile_task_t *tasks = realloc(rec->tasks,
+		    (rec->task_count + 1) * sizeof(profile_task_t));
+		if (tasks == NULL) {
+			free(stats);
+			return ENOMEM;
+		}
+
+		rec->tasks = tasks;
+		rec->tasks[rec->task_count].task_id = stats[i].task_id;
+		str_cpy(rec->tasks[rec->task_count].name, TASK_NAME_BUFLEN,
+		    stats[i].name);
+		rec->task_count++;
+	}
+
+	free(stats);
+	return EOK;
+}
+
+static errno_t record_write(record_t *rec, const char *fname,
+    uint64_t dropped, uint64_t interval)
+{
+	profile_header_t hdr;
+
+	memcpy(hdr.magic, PROFILE_MAGIC, sizeof(hdr.magic));
+	hdr.task_count = rec->task_count;
+	hdr.sample_count = rec->count;
+	hdr.dropped = dropped;
+	hdr.interval = interval;
+
+	FILE *f = fopen(fname, "wb");
+	if (f == NULL)
+		return EIO;
+
+	errno_t rc = EOK;
+
+	if ((fwrite(&hdr, sizeof(hdr), 1, f) != 1) ||
+	    (fwrite(rec->tasks, sizeof(profile_task_t), rec->task_count, f) !=
+	    rec->task_count) ||
+	    (fwrite(rec->samples, sizeof(prof_sample_t), rec->count, f) !=
+	    rec->count))
+		rc = EIO;
+
+	if (fclose(f) != 0)
+		rc = EIO;
+
+	return rc;
+}
+
+static void record_usage(void)
+{
+	printf("Usage: perf record [-i <ticks>] <seconds> [<file>]\n");
+}
+
+/** Sample all CPUs for the given time and store the samples in a file.
+ *
+ * @param argc Number of arguments following "record".
+ * @param argv Arguments following "record".
+ *
+ * @return Zero on success.
+ *
+ */
+int perf_record(int argc, char *argv[])
+{
+	unsigned long interval = 1;
+	unsigned long seconds;
+	const char *fname = PROFILE_DEFAULT_FILE;
+	char *end;
+	int i = 0;
+
+	if ((argc >= 2) && (str_cmp(argv[0], "-i") == 0)) {
+		interval = strtoul(argv[1], &end, 10);
+		if ((*end != '\0') || (interval == 0)) {
+			record_usage();
+			return -1;
+		}
+
+		i += 2;
+	}
+
+	if ((argc - i < 1) || (argc - i > 2)) {
+		record_usage();
+		return -1;
+	}
+
+	seconds = strtoul(argv[i], &end, 10);
+	if (*end != '\0') {
+		record_usage();
+		return -1;
+	}
+
+	if (argc - i == 2)
+		fname = argv[i + 1];
+
+	record_t rec;
+	memset(&rec, 0, sizeof(rec));
+
+	errno_t rc = record_tasks(&rec);
+	if (rc != EOK)
+		goto error;
+
+	rc = prof_start(interval);
+	if (rc != EOK)
+		goto error;
+
+	printf("Recording for %lu s...\n", seconds);
+
+	struct timespec start;
+	struct timespec now;
+	getuptime(&start);
+
+	do {
+		fibril_usleep(RECORD_POLL_USEC);
+
+		rc = record_drain(&rec);
+		if (rc != EOK)
+			break;
+
+		getuptime(&now);
+	} while (NSEC2SEC(ts_sub_diff(&now, &start)) < (nsec_t) seconds);
+
+	size_t dropped = 0;
+	errno_t rc2 = prof_stop(&dropped);
+	if (rc == EOK)
+		rc = rc2;
+
+	if (rc == EOK)
+		rc = record_drain(&rec);
+
+	if (rc == EOK)
+		rc = record_tasks(&rec);
+
+	if (rc == EOK)
+		rc = record_write(&rec, fname, dropped, interval);
+
+	if (rc != EOK)
+		goto error;
+
+	printf("Recorded %zu samples (%zu dropped) to %s\n", rec.count,
+	    dropped, fname);
+
+	free(rec.samples);
+	free(rec.tasks);
+	return 0;
+
+error:
+	printf("Recording failed: %s\n", str_error(rc));
+	free(rec.samples);
+	free(rec.tasks);
+	return -1;
+}
+
+/** @}
+ */
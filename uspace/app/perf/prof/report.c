@@ -0,0 +1,561 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup perf
+ * @{
+ */
+/**
+ * @file
+ * @brief Symbolized per-task report of recorded profiler samples.
+ *
+ * Kernel addresses are resolved by the running kernel, userspace
+ * addresses using the symbol table of the task's executable (only
+ * if the task name is the path to the executable). Symbols of shared
+ * libraries are not resolved.
+ */
+
+#include <elf/elf_symtab.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <mem.h>
+#include <prof.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include "../perf.h"
+#include "profile.h"
+
+/** Number of symbols listed for each task */
+#define REPORT_TOP_SYMBOLS  10
+
+/** Maximum length of a kernel symbol name */
+#define REPORT_SYMBOL_BUFLEN  128
+
+typedef struct {
+	uint64_t task_id;
+	char *name;
+	symtab_t *symtab;
+	bool symtab_loaded;
+	size_t samples;
+} report_task_t;
+
+/** Unique sampled address */
+typedef struct {
+	uint64_t task_id;
+	bool uspace;
+	uint64_t pc;
+	char *name;
+	size_t sym;
+} report_addr_t;
+
+/** Symbol the sampled addresses resolve to */
+typedef struct {
+	uint64_t task_id;
+	bool uspace;
+	const char *name;
+	/** Samples taken directly in the symbol */
+	size_t self;
+	/** Samples with the symbol anywhere on the recorded stack */
+	size_t total;
+	/** Last sample (plus one) counted in total */
+	size_t seen;
+} report_sym_t;
+
+typedef struct {
+	profile_header_t hdr;
+	prof_sample_t *samples;
+	report_task_t *tasks;
+	size_t task_count;
+	report_addr_t *addrs;
+	size_t addr_count;
+	report_sym_t *syms;
+	size_t sym_count;
+} report_t;
+
+static int report_task_cmp(const void *a, const void *b)
+{
+	const report_task_t *ta = a;
+	const report_task_t *tb = b;
+
+	if (ta->task_id != tb->task_id)
+		return (ta->task_id < tb->task_id) ? -1 : 1;
+
+	return 0;
+}
+
+static int report_task_samples_cmp(const void *a, const void *b)
+{
+	const report_task_t *ta = a;
+	const report_task_t *tb = b;
+
+	if (ta->samples != tb->samples)
+		return (ta->samples > tb->samples) ? -1 : 1;
+
+	return report_task_cmp(a, b);
+}
+
+static int report_addr_cmp(const void *a, const void *b)
+{
+	const report_addr_t *aa = a;
+	const report_addr_t *ab = b;
+
+	if (aa->task_id != ab->task_id)
+		return (aa->task_id < ab->task_id) ? -1 : 1;
+
+	if (aa->uspace != ab->uspace)
+		return aa->uspace ? 1 : -1;
+
+	if (aa->pc != ab->pc)
+		return (aa->pc < ab->pc) ? -1 : 1;
+
+	return 0;
+}
+
+static int report_sym_cmp(const void *a, const void *b)
+{
+	const report_sym_t *sa = a;
+	const report_sym_t *sb = b;
+
+	if (sa->task_id != sb->task_id)
+		return (sa->task_id < sb->task_id) ? -1 : 1;
+
+	if (sa->uspace != sb->uspace)
+		return sa->uspace ? 1 : -1;
+
+	return str_cmp(sa->name, sb->name);
+}
+
+static int report_sym_self_cmp(const void *a, const void *b)
+{
+	const report_sym_t *sa = a;
+	const report_sym_t *sb = b;
+
+	if (sa->task_id != sb->task_id)
+		return (sa->task_id < sb->task_id) ? -1 : 1;
+
+	if (sa->self != sb->self)
+		return (sa->self > sb->self) ? -1 : 1;
+
+	if (sa->total != sb->total)
+		return (sa->total > sb->total) ? -1 : 1;
+
+	return str_cmp(sa->name, sb->name);
+}
+
+static report_task_t *report_task_find(report_t *rep, uint64_t task_id)
+{
+	report_task_t key = { .task_id = task_id };
+
+	return bsearch(&key, rep->tasks, rep->task_count,
+	    sizeof(report_task_t), report_task_cmp);
+}
+
+static report_addr_t *report_addr_find(report_t *rep, uint64_t task_id,
+    bool uspace, uint64_t pc)
+{
+	report_addr_t key = {
+		.task_id = task_id,
+		.uspace = uspace,
+		.pc = pc
+	};
+
+	return bsearch(&key, rep->addrs, rep->addr_count,
+	    sizeof(report_addr_t), report_addr_cmp);
+}
+
+static errno_t report_load(report_t *rep, const char *fname)
+{
+	profile_task_t ptask;
+	errno_t rc = EOK;
+
+	FILE *f = fopen(fname, "rb");
+	if (f == NULL)
+		return ENOENT;
+
+	if ((fread(&rep->hdr, sizeof(rep->hdr), 1, f) != 1) ||
+	    (memcmp(rep->hdr.magic, PROFILE_MAGIC,
+	    sizeof(rep->hdr.magic)) != 0)) {
+		rc = EINVAL;
+		goto out;
+	}
+
+	rep->tasks = calloc(rep->hdr.task_count, sizeof(report_task_t));
+	rep->samples = calloc(rep->hdr.sample_count, sizeof(prof_sample_t));
+	if (((rep->tasks == NULL) && (rep->hdr.task_count > 0)) ||
+	    ((rep->samples == NULL) && (rep->hdr.sample_count > 0))) {
+		rc = ENOMEM;
+		goto out;
+	}
+
+	for (size_t i = 0; i < rep->hdr.task_count; i++) {
+		if (fread(&ptask, sizeof(ptask), 1, f) != 1) {
+			rc = EIO;
+			goto out;
+		}
+
+		ptask.name[TASK_NAME_BUFLEN - 1] = '\0';
+		rep->tasks[i].task_id = ptask.task_id;
+		rep->tasks[i].name = str_dup(ptask.name);
+		if (rep->tasks[i].name == NULL) {
+			rc = ENOMEM;
+			goto out;
+		}
+
+		rep->task_count++;
+	}
+
+	if (fread(rep->samples, sizeof(prof_sample_t), rep->hdr.sample_count,
+	    f) != rep->hdr.sample_count) {
+		rc = EIO;
+		goto out;
+	}
+
+	for (size_t i = 0; i < rep->hdr.sample_count; i++) {
+		if (rep->samples[i].depth > PROF_STACK_DEPTH)
+			rep->samples[i].depth = PROF_STACK_DEPTH;
+	}
+
+	qsort(rep->tasks, rep->task_count, sizeof(report_task_t),
+	    report_task_cmp);
+
+out:
+	fclose(f);
+	return rc;
+}
+
+/** Add tasks that terminated before their names could be recorded. */
+static errno_t report_add_unknown_tasks(report_t *rep)
+{
+	for (size_t i = 0; i < rep->hdr.sample_count; i++) {
+		uint64_t task_id = rep->samples[i].task_id;
+
+		if (report_task_find(rep, task_id) != NULL)
+			continue;
+
+		report_task_t *tasks = realloc(rep->tasks,
+		    (rep->task_count + 1) * sizeof(report_task_t));
+		if (tasks == NULL)
+			return ENOMEM;
+
+		rep->tasks = tasks;
+		memset(&rep->tasks[rep->task_count], 0, sizeof(report_task_t));
+		rep->tasks[rep->task_count].task_id = task_id;
+		rep->task_count++;
+
+		qsort(rep->tasks, rep->task_count, sizeof(report_task_t),
+		    report_task_cmp);
+	}
+
+	return EOK;
+}
+
+/** Collect the distinct addresses found in the samples. */
+static errno_t report_collect_addrs(report_t *rep)
+{
+	size_t count = 0;
+
+	for (size_t i = 0; i < rep->hdr.sample_count; i++)
+		count += rep->samples[i].depth;
+
+	rep->addrs = calloc(count, sizeof(report_addr_t));
+	if ((rep->addrs == NULL) && (count > 0))
+		return ENOMEM;
+
+	for (size_t i = 0; i < rep->hdr.sample_count; i++) {
+		prof_sample_t *sample = &rep->samples[i];
+
+		for (uint32_t j = 0; j < sample->depth; j++) {
+			report_addr_t *addr = &rep->addrs[rep->addr_count++];
+
+			addr->task_id = sample->task_id;
+			addr->uspace = sample->uspace;
+			addr->pc = sample->pc[j];
+		}
+	}
+
+	qsort(rep->addrs, rep->addr_count, sizeof(report_addr_t),
+	    report_addr_cmp);
+
+	/* Remove duplicates */
+	size_t n = 0;
+	for (size_t i = 0; i < rep->addr_count; i++) {
+		if ((n > 0) && (report_addr_cmp(&rep->addrs[n - 1],
+		    &rep->addrs[i]) == 0))
+			continue;
+
+		rep->addrs[n++] = rep->addrs[i];
+	}
+
+	rep->addr_count = n;
+	return EOK;
+}
+
+static char *report_resolve_kernel(uint64_t pc)
+{
+	char name[REPORT_SYMBOL_BUFLEN];
+	size_t offset;
+
+	if (prof_symbol(pc, name, sizeof(name), &offset) != EOK)
+		return NULL;
+
+	return str_dup(name);
+}
+
+static char *report_resolve_uspace(report_task_t *task, uint64_t pc)
+{
+	char *name;
+	size_t offset;
+
+	if ((task == NULL) || (task->name == NULL))
+		return NULL;
+
+	if (!task->symtab_loaded) {
+		task->symtab_loaded = true;
+
+		/* Symbols can only be found if the task name is a path */
+		if ((task->name[0] != '/') ||
+		    (symtab_load(task->name, &task->symtab) != EOK))
+			task->symtab = NULL;
+	}
+
+	if (task->symtab == NULL)
+		return NULL;
+
+	if (symtab_addr_to_name(task->symtab, pc, &name, &offset) != EOK)
+		return NULL;
+
+	return str_dup(name);
+}
+
+/** Resolve addresses to symbols and merge addresses of the same symbol. */
+static errno_t report_resolve(report_t *rep)
+{
+	for (size_t i = 0; i < rep->addr_count; i++) {
+		report_addr_t *addr = &rep->addrs[i];
+
+		if (addr->uspace) {
+			addr->name = report_resolve_uspace(
+			    report_task_find(rep, addr->task_id), addr->pc);
+		} else {
+			addr->name = report_resolve_kernel(addr->pc);
+		}
+
+		if ((addr->name == NULL) &&
+		    (asprintf(&addr->name, "%#" PRIx64, addr->pc) < 0)) {
+			addr->name = NULL;
+			return ENOMEM;
+		}
+	}
+
+	rep->syms = calloc(rep->addr_count, sizeof(report_sym_t));
+	if ((rep->syms == NULL) && (rep->addr_count > 0))
+		return ENOMEM;
+
+	for (size_t i = 0; i < rep->addr_count; i++) {
+		rep->syms[i].task_id = rep->addrs[i].task_id;
+		rep->syms[i].uspace = rep->addrs[i].uspace;
+		rep->syms[i].name = rep->addrs[i].name;
+	}
+
+	qsort(rep->syms, rep->addr_count, sizeof(report_sym_t),
+	    report_sym_cmp);
+
+	/* Remove duplicates */
+	size_t n = 0;
+	for (size_t i = 0; i < rep->addr_count; i++) {
+		if ((n > 0) && (report_sym_cmp(&rep->syms[n - 1],
+		    &rep->syms[i]) == 0))
+			continue;
+
+		rep->syms[n++] = rep->syms[i];
+	}
+
+	rep->sym_count = n;
+
+	for (size_t i = 0; i < rep->addr_count; i++) {
+		report_sym_t key = {
+			.task_id = rep->addrs[i].task_id,
+			.uspace = rep->addrs[i].uspace,
+			.name = rep->addrs[i].name
+		};
+
+		report_sym_t *sym = bsearch(&key, rep->syms, rep->sym_count,
+		    sizeof(report_sym_t), report_sym_cmp);
+		rep->addrs[i].sym = sym - rep->syms;
+	}
+
+	return EOK;
+}
+
+/** Attribute the samples to tasks and symbols. */
+static void report_count(report_t *rep)
+{
+	for (size_t i = 0; i < rep->hdr.sample_count; i++) {
+		prof_sample_t *sample = &rep->samples[i];
+
+		report_task_t *task = report_task_find(rep, sample->task_id);
+		task->samples++;
+
+		for (uint32_t j = 0; j < sample->depth; j++) {
+			report_addr_t *addr = report_addr_find(rep,
+			    sample->task_id, sample->uspace, sample->pc[j]);
+			report_sym_t *sym = &rep->syms[addr->sym];
+
+			if (j == 0)
+				sym->self++;
+
+			/* Recursion must not count the sample twice */
+			if (sym->seen != i + 1) {
+				sym->seen = i + 1;
+				sym->total++;
+			}
+		}
+	}
+}
+
+static void report_print_percent(size_t part, size_t whole)
+{
+	size_t permille = (whole > 0) ? part * 1000 / whole : 0;
+
+	printf("%3zu.%zu%%", permille / 10, permille % 10);
+}
+
+static void report_print(report_t *rep)
+{
+	size_t samples = rep->hdr.sample_count;
+
+	printf("%zu samples, %" PRIu64 " dropped, interval %" PRIu64
+	    " ticks\n", samples, rep->hdr.dropped, rep->hdr.interval);
+
+	qsort(rep->tasks, rep->task_count, sizeof(report_task_t),
+	    report_task_samples_cmp);
+	qsort(rep->syms, rep->sym_count, sizeof(report_sym_t),
+	    report_sym_self_cmp);
+
+	for (size_t i = 0; i < rep->task_count; i++) {
+		report_task_t *task = &rep->tasks[i];
+
+		if (task->samples == 0)
+			continue;
+
+		printf("\n");
+		report_print_percent(task->samples, samples);
+
+		if (task->task_id == 0)
+			printf(" [idle]");
+		else if (task->name != NULL)
+			printf(" %s (%" PRIu64 ")", task->name, task->task_id);
+		else
+			printf(" task %" PRIu64, task->task_id);
+
+		printf(", %zu samples\n", task->samples);
+		printf("     Self    Total  Symbol\n");
+
+		size_t listed = 0;
+		for (size_t j = 0; j < rep->sym_count; j++) {
+			report_sym_t *sym = &rep->syms[j];
+
+			if (sym->task_id != task->task_id)
+				continue;
+
+			if (listed++ == REPORT_TOP_SYMBOLS)
+				break;
+
+			printf("  ");
+			report_print_percent(sym->self, task->samples);
+			printf("  ");
+			report_print_percent(sym->total, task->samples);
+			printf("  %s%s\n", sym->uspace ? "" : "[k] ",
+			    sym->name);
+		}
+	}
+}
+
+static void report_fini(report_t *rep)
+{
+	for (size_t i = 0; i < rep->task_count; i++) {
+		free(rep->tasks[i].name);
+		if (rep->tasks[i].symtab != NULL)
+			symtab_delete(rep->tasks[i].symtab);
+	}
+
+	for (size_t i = 0; i < rep->addr_count; i++)
+		free(rep->addrs[i].name);
+
+	free(rep->tasks);
+	free(rep->samples);
+	free(rep->addrs);
+	free(rep->syms);
+}
+
+/** Print recorded samples grouped by task and symbol.
+ *
+ * @param argc Number of arguments following "report".
+ * @param argv Arguments following "report".
+ *
+ * @return Zero on success.
+ *
+ */
+int perf_report(int argc, char *argv[])
+{
+	const char *fname = PROFILE_DEFAULT_FILE;
+	report_t rep;
+	errno_t rc;
+
+	if (argc > 1) {
+		printf("Usage: perf report [<file>]\n");
+		return -1;
+	}
+
+	if (argc == 1)
+		fname = argv[0];
+
+	memset(&rep, 0, sizeof(rep));
+
+	rc = report_load(&rep, fname);
+	if (rc == EOK)
+		rc = report_add_unknown_tasks(&rep);
+	if (rc == EOK)
+		rc = report_collect_addrs(&rep);
+	if (rc == EOK)
+		rc = report_resolve(&rep);
+
+	if (rc != EOK) {
+		printf("Cannot read profile %s: %s\n", fname, str_error(rc));
+		report_fini(&rep);
+		return -1;
+	}
+
+	report_count(&rep);
+	report_print(&rep);
+	report_fini(&rep);
+	return 0;
+}
+
+/** @}
+ */
@@ -34,13 +34,13 @@
 
 #include <adt/list.h>
 #include <context.h>
+#include <elf/elf_symtab.h>
 #include <errno.h>
 #include <fibril.h>
 #include <fibrildump.h>
 #include <stacktrace.h>
 #include <stdio.h>
 #include <stdbool.h>
-#include <symtab.h>
 #include <taskdump.h>
 #include <udebug.h>
 
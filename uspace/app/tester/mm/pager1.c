@@ -60,6 +60,13 @@ static void *create_paged_area(size_t size)
 		return NULL;
 	}
 
+	sysarg_t pager_handle;
+	rc = vfs_pager_handle(fd, &pager_handle);
+	if (rc != EOK) {
+		vfs_put(fd);
+		return NULL;
+	}
+
 	async_sess_t *vfs_pager_sess;
 
 	TPRINTF("Connecting to VFS pager...\n");
@@ -74,7 +81,7 @@ static void *create_paged_area(size_t size)
 	TPRINTF("Creating AS area...\n");
 
 	void *result = async_as_area_create(AS_AREA_ANY, size,
-	    AS_AREA_READ | AS_AREA_CACHEABLE, vfs_pager_sess, fd, 0, 0);
+	    AS_AREA_READ | AS_AREA_CACHEABLE, vfs_pager_sess, pager_handle, 0, 0);
 	if (result == AS_MAP_FAILED) {
 		vfs_put(fd);
 		return NULL;
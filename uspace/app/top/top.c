@@ -130,6 +130,10 @@ static size_t sort_column = TASK_COL_PERCENT_USER;
 static int sort_reverse = -1;
 static bool excs_all = false;
 
+/** Incrementally updated task and thread statistics */
+static stats_snapshot_t tasks_snap;
+static stats_snapshot_t threads_snap;
+
 static const char *read_data(data_t *target)
 {
 	/* Initialize data */
@@ -185,7 +189,8 @@ static const char *read_data(data_t *target)
 		return "Not enough memory for CPU utilization";
 
 	/* Get tasks */
-	target->tasks = stats_get_tasks(&(target->tasks_count));
+	target->tasks = stats_get_tasks_snapshot(&tasks_snap,
+	    &(target->tasks_count));
 	if (target->tasks == NULL)
 		return "Cannot get tasks";
 
@@ -195,7 +200,8 @@ static const char *read_data(data_t *target)
 		return "Not enough memory for task utilization";
 
 	/* Get threads */
-	target->threads = stats_get_threads(&(target->threads_count));
+	target->threads = stats_get_threads_snapshot(&threads_snap,
+	    &(target->threads_count));
 	if (target->threads == NULL)
 		return "Cannot get threads";
 
@@ -583,6 +589,9 @@ int main(int argc, char *argv[])
 	data_t data_prev;
 	const char *ret = NULL;
 
+	stats_snapshot_init_tasks(&tasks_snap);
+	stats_snapshot_init_threads(&threads_snap);
+
 	screen_init();
 	printf("Reading initial data...\n");
 
@@ -676,6 +685,8 @@ int main(int argc, char *argv[])
 out:
 	screen_done();
 	free_data(&data);
+	stats_snapshot_fini(&tasks_snap);
+	stats_snapshot_fini(&threads_snap);
 
 	if (ret != NULL) {
 		fprintf(stderr, "%s: %s\n", NAME, ret);
@@ -48,8 +48,8 @@
 #include "drec.h"
 #include "wave.h"
 
-#define READ_SIZE   (32 * 1024)
-#define STREAM_BUFFER_SIZE   (64 * 1024)
+#define READ_SIZE   (4 * 1024)
+#define STREAM_BUFFER_SIZE   (16 * 1024)
 
 /**
  * Play audio file using a new stream on provided context.
@@ -95,7 +95,8 @@ static errno_t hplay_ctx(hound_context_t *ctx, const char *filename)
 		return ENOMEM;
 	}
 	hound_stream_t *stream = hound_stream_create(ctx,
-	    HOUND_STREAM_DRAIN_ON_EXIT, format, STREAM_BUFFER_SIZE);
+	    HOUND_STREAM_DRAIN_ON_EXIT | HOUND_STREAM_SHARED, format,
+	    STREAM_BUFFER_SIZE);
 
 	/* Read and play */
 	while ((read = fread(buffer, sizeof(char), READ_SIZE, source)) > 0) {
@@ -107,6 +108,11 @@ static errno_t hplay_ctx(hound_context_t *ctx, const char *filename)
 		}
 	}
 
+	hound_stream_stats_t stats;
+	if (hound_stream_get_stats(stream, &stats) == EOK && stats.xruns > 0)
+		printf("Stream `%s' underran %zu times.\n", filename,
+		    stats.xruns);
+
 	/* Cleanup */
 	free(buffer);
 	fclose(source);
@@ -0,0 +1,4 @@
+/** @addtogroup webbench webbench
+ * @brief HTTP load generator
+ * @ingroup apps
+ */
@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup webbench
+ * @{
+ */
+
+/** @file
+ * HTTP load generator
+ *
+ * Several client fibrils repeatedly fetch the same URL from a web server
+ * and the request rate and latency distribution are reported at the end.
+ */
+
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <inttypes.h>
+#include <macros.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include <time.h>
+
+#include <http/http.h>
+#include <uri.h>
+
+#define NAME "webbench"
+
+#define DEFAULT_CLIENTS  4
+#define DEFAULT_REQUESTS  1000
+
+/** Size of buffer for discarding response body */
+#define BODY_BUF_SIZE  4096
+
+typedef struct {
+	/** Number of requests to perform */
+	size_t count;
+	/** Place to store latency of each request in microseconds */
+	uint64_t *latency;
+	/** Number of successful requests */
+	size_t done;
+	/** Number of bytes of response body received */
+	uint64_t bytes;
+	/** Error that stopped the client */
+	errno_t rc;
+} client_t;
+
+static const char *host;
+static uint16_t port = 80;
+static char *path;
+static bool new_conn = false;
+
+static FIBRIL_MUTEX_INITIALIZE(done_lock);
+static FIBRIL_CONDVAR_INITIALIZE(done_cv);
+static size_t clients_running;
+
+static void syntax_print(void)
+{
+	fprintf(stderr, "Usage: " NAME " [-c <clients>] [-n <requests>] [-1] "
+	    "<url>\n");
+	fprintf(stderr, "  -c  Number of concurrent clients (default "
+	    STRING(DEFAULT_CLIENTS) ")\n");
+	fprintf(stderr, "  -n  Total number of requests (default "
+	    STRING(DEFAULT_REQUESTS) ")\n");
+	fprintf(stderr, "  -1  Open a new connection for each request\n");
+}
+
+/** Receive and discard response body. */
+static errno_t body_receive(http_t *http, http_response_t *resp,
+    uint64_t *rbytes)
+{
+	char buf[BODY_BUF_SIZE];
+	char *value;
+	uint64_t length;
+	errno_t rc;
+
+	rc = http_headers_get(&resp->headers, "Content-Length", &value);
+	if (rc != EOK)
+		return rc;
+
+	rc = str_uint64_t(value, NULL, 10, true, &length);
+	free(value);
+	if (rc != EOK)
+		return rc;
+
+	*rbytes = length;
+
+	while (length > 0) {
+		size_t nrecv;
+
+		rc = recv_buffer(&http->recv_buffer, buf,
+		    min(length, sizeof(buf)), &nrecv);
+		if (rc != EOK)
+			return rc;
+		if (nrecv == 0)
+			return EIO;
+
+		length -= nrecv;
+	}
+
+	return EOK;
+}
+
+static errno_t client_run(client_t *client)
+{
+	http_request_t *req = NULL;
+	http_response_t *resp;
+	http_t *http;
+	uint64_t bytes;
+	errno_t rc;
+
+	http = http_create(host, port);
+	if (http == NULL)
+		return ENOMEM;
+
+	req = http_request_create("GET", path);
+	if (req == NULL) {
+		rc = ENOMEM;
+		goto out;
+	}
+
+	rc = http_headers_append(&req->headers, "Host", host);
+	if (rc != EOK)
+		goto out;
+
+	if (new_conn) {
+		rc = http_headers_append(&req->headers, "Connection", "close");
+		if (rc != EOK)
+			goto out;
+	}
+
+	for (client->done = 0; client->done < client->count; client->done++) {
+		struct timespec start, now;
+
+		getuptime(&start);
+
+		if (http->conn == NULL) {
+			rc = http_connect(http);
+			if (rc != EOK)
+				goto out;
+		}
+
+		rc = http_send_request(http, req);
+		if (rc != EOK)
+			goto out;
+
+		rc = http_receive_response(&http->recv_buffer, &resp,
+		    16 * 1024, 100);
+		if (rc != EOK)
+			goto out;
+
+		if (resp->status != 200) {
+			fprintf(stderr, "Server returned status %d %s\n",
+			    resp->status, resp->message);
+			http_response_destroy(resp);
+			rc = EIO;
+			goto out;
+		}
+
+		rc = body_receive(http, resp, &bytes);
+		http_response_destroy(resp);
+		if (rc != EOK)
+			goto out;
+
+		if (new_conn)
+			(void) http_close(http);
+
+		getuptime(&now);
+		client->latency[client->done] = ts_sub_diff(&now, &start) / 1000;
+		client->bytes += bytes;
+	}
+
+out:
+	if (req != NULL)
+		http_request_destroy(req);
+	http_destroy(http);
+	return rc;
+}
+
+static errno_t client_fibril(void *arg)
+{
+	client_t *client = (client_t *) arg;
+
+	client->rc = client_run(client);
+
+	fibril_mutex_lock(&done_lock);
+	clients_running--;
+	fibril_condvar_broadcast(&done_cv);
+	fibril_mutex_unlock(&done_lock);
+
+	return EOK;
+}
+
+static int latency_cmp(const void *a, const void *b)
+{
+	uint64_t la = *(const uint64_t *) a;
+	uint64_t lb = *(const uint64_t *) b;
+
+	if (la < lb)
+		return -1;
+	return (la > lb) ? 1 : 0;
+}
+
+/** Get latency percentile from sorted array. */
+static uint64_t percentile(uint64_t *latency, size_t count, unsigned pct)
+{
+	size_t idx = (count * pct + 99) / 100;
+
+	return latency[(idx > 0) ? idx - 1 : 0];
+}
+
+static void results_print(client_t *clients, size_t nclients,
+    uint64_t *latency, uint64_t elapsed_usec)
+{
+	size_t done = 0;
+	uint64_t bytes = 0;
+
+	/* Compact latencies of all clients to the start of the array */
+	for (size_t i = 0; i < nclients; i++) {
+		if (clients[i].rc != EOK) {
+			fprintf(stderr, "Client %zu failed after %zu requests "
+			    "(%s)\n", i, clients[i].done,
+			    str_error(clients[i].rc));
+		}
+
+		memmove(latency + done, clients[i].latency,
+		    clients[i].done * sizeof(uint64_t));
+		done += clients[i].done;
+		bytes += clients[i].bytes;
+	}
+
+	if (done == 0) {
+		printf("No requests completed.\n");
+		return;
+	}
+
+	qsort(latency, done, sizeof(uint64_t), latency_cmp);
+
+	if (elapsed_usec == 0)
+		elapsed_usec = 1;
+
+	printf("%zu requests in %" PRIu64 " ms, %" PRIu64 " bytes\n", done,
+	    elapsed_usec / 1000, bytes);
+	printf("%" PRIu64 " requests/s, %" PRIu64 " KiB/s\n",
+	    (uint64_t) done * 1000000 / elapsed_usec,
+	    bytes * 1000000 / 1024 / elapsed_usec);
+	printf("Latency (us): p50 %" PRIu64 ", p90 %" PRIu64 ", p99 %" PRIu64
+	    ", max %" PRIu64 "\n", percentile(latency, done, 50),
+	    percentile(latency, done, 90), percentile(latency, done, 99),
+	    latency[done - 1]);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t nclients = DEFAULT_CLIENTS;
+	size_t nrequests = DEFAULT_REQUESTS;
+	client_t *clients = NULL;
+	uint64_t *latency = NULL;
+	uri_t *uri = NULL;
+	errno_t rc;
+	int i;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (str_cmp(argv[i], "-1") == 0) {
+			new_conn = true;
+		} else if (str_cmp(argv[i], "-c") == 0 && i + 1 < argc) {
+			rc = str_size_t(argv[++i], NULL, 10, true, &nclients);
+			if (rc != EOK || nclients == 0) {
+				syntax_print();
+				return EINVAL;
+			}
+		} else if (str_cmp(argv[i], "-n") == 0 && i + 1 < argc) {
+			rc = str_size_t(argv[++i], NULL, 10, true, &nrequests);
+			if (rc != EOK) {
+				syntax_print();
+				return EINVAL;
+			}
+		} else {
+			syntax_print();
+			return EINVAL;
+		}
+	}
+
+	if (argc != i + 1) {
+		syntax_print();
+		return EINVAL;
+	}
+
+	uri = uri_parse(argv[i]);
+	if (uri == NULL || !uri_validate(uri) || uri->host == NULL ||
+	    str_cmp(uri->scheme, "http") != 0) {
+		fprintf(stderr, "Invalid URL '%s'\n", argv[i]);
+		rc = EINVAL;
+		goto out;
+	}
+
+	host = uri->host;
+	if (uri->port != NULL) {
+		rc = str_uint16_t(uri->port, NULL, 10, true, &port);
+		if (rc != EOK) {
+			fprintf(stderr, "Invalid port number: %s\n", uri->port);
+			goto out;
+		}
+	}
+
+	path = str_dup((uri->path != NULL && *uri->path != '\0') ?
+	    uri->path : "/");
+	if (path == NULL) {
+		rc = ENOMEM;
+		goto out;
+	}
+
+	if (nclients > nrequests)
+		nclients = max(nrequests, 1);
+
+	clients = calloc(nclients, sizeof(client_t));
+	latency = calloc(max(nrequests, 1), sizeof(uint64_t));
+	if (clients == NULL || latency == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		rc = ENOMEM;
+		goto out;
+	}
+
+	/* Distribute requests among clients */
+	size_t first = 0;
+	for (size_t c = 0; c < nclients; c++) {
+		clients[c].count = nrequests / nclients +
+		    ((c < nrequests % nclients) ? 1 : 0);
+		clients[c].latency = latency + first;
+		first += clients[c].count;
+	}
+
+	printf("%s: %zu requests, %zu clients, %s connections\n", NAME,
+	    nrequests, nclients, new_conn ? "new" : "persistent");
+
+	struct timespec start, now;
+	getuptime(&start);
+
+	fibril_mutex_lock(&done_lock);
+
+	for (size_t c = 0; c < nclients; c++) {
+		fid_t fid = fibril_create(client_fibril, &clients[c]);
+		if (fid == 0) {
+			clients[c].rc = ENOMEM;
+			continue;
+		}
+
+		clients_running++;
+		fibril_add_ready(fid);
+	}
+
+	while (clients_running > 0)
+		fibril_condvar_wait(&done_cv, &done_lock);
+
+	fibril_mutex_unlock(&done_lock);
+
+	getuptime(&now);
+	uint64_t elapsed = ts_sub_diff(&now, &start) / 1000;
+
+	results_print(clients, nclients, latency, elapsed);
+	rc = EOK;
+out:
+	free(latency);
+	free(clients);
+	free(path);
+	if (uri != NULL)
+		uri_destroy(uri);
+	return rc;
+}
+
+/** @}
+ */
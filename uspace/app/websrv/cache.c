@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup websrv
+ * @{
+ */
+/**
+ * @file Cache of static files with precomputed response headers.
+ *
+ * Small files are kept in memory together with their response header
+ * so that a hit is answered with a single send. The least recently
+ * used entries are evicted when the cache exceeds its capacity and
+ * entries expire after a while so that changes to the files are
+ * eventually picked up.
+ */
+
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <assert.h>
+#include <fibril_synch.h>
+#include <stdlib.h>
+#include <str.h>
+
+#include "cache.h"
+
+/** Lifetime of cache entry in seconds */
+#define CACHE_TTL  10
+
+/** Largest cached file as a fraction of cache capacity */
+#define CACHE_FILE_FRACTION  8
+
+static FIBRIL_MUTEX_INITIALIZE(cache_lock);
+static hash_table_t cache_ht;
+static LIST_INITIALIZE(cache_lru);
+static size_t cache_capacity;
+static size_t cache_used;
+
+static size_t cache_hash_uri(const char *uri)
+{
+	size_t hash = 0;
+
+	while (*uri != '\0')
+		hash = hash_combine(hash, (uint8_t) *uri++);
+
+	return hash;
+}
+
+static size_t cache_key_hash(void *key)
+{
+	return cache_hash_uri((const char *) key);
+}
+
+static size_t cache_hash(const ht_link_t *item)
+{
+	cache_entry_t *entry = hash_table_get_inst(item, cache_entry_t, htlink);
+	return cache_hash_uri(entry->uri);
+}
+
+static bool cache_key_equal(void *key, const ht_link_t *item)
+{
+	cache_entry_t *entry = hash_table_get_inst(item, cache_entry_t, htlink);
+	return str_cmp(entry->uri, (const char *) key) == 0;
+}
+
+static bool cache_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	cache_entry_t *entry = hash_table_get_inst(item2, cache_entry_t, htlink);
+	return cache_key_equal(entry->uri, item1);
+}
+
+static hash_table_ops_t cache_ht_ops = {
+	.hash = cache_hash,
+	.key_hash = cache_key_hash,
+	.key_equal = cache_key_equal,
+	.equal = cache_equal,
+	.remove_callback = NULL
+};
+
+static void cache_entry_destroy(cache_entry_t *entry)
+{
+	free(entry->uri);
+	free(entry->data);
+	free(entry);
+}
+
+/** Remove entry from cache.
+ *
+ * Cache lock must be held. The entry is destroyed once the last
+ * reference is dropped.
+ */
+static void cache_remove(cache_entry_t *entry)
+{
+	hash_table_remove_item(&cache_ht, &entry->htlink);
+	list_remove(&entry->llink);
+	cache_used -= entry->size;
+	entry->cached = false;
+
+	if (entry->refcnt == 0)
+		cache_entry_destroy(entry);
+}
+
+/** Initialize file cache.
+ *
+ * @param capacity Cache capacity in bytes (zero disables caching)
+ * @return EOK on success or ENOMEM
+ */
+errno_t cache_init(size_t capacity)
+{
+	if (!hash_table_create(&cache_ht, 0, 0, &cache_ht_ops))
+		return ENOMEM;
+
+	cache_capacity = capacity;
+	cache_used = 0;
+	return EOK;
+}
+
+/** Size of the largest file that is worth caching. */
+size_t cache_file_max(void)
+{
+	return cache_capacity / CACHE_FILE_FRACTION;
+}
+
+/** Look up cached response.
+ *
+ * @param uri Request URI
+ * @return Referenced cache entry or @c NULL if not cached
+ */
+cache_entry_t *cache_lookup(const char *uri)
+{
+	struct timespec now;
+	cache_entry_t *entry = NULL;
+
+	getuptime(&now);
+
+	fibril_mutex_lock(&cache_lock);
+
+	ht_link_t *link = hash_table_find(&cache_ht, (void *) uri);
+	if (link != NULL) {
+		entry = hash_table_get_inst(link, cache_entry_t, htlink);
+
+		if (ts_gteq(&now, &entry->expires)) {
+			cache_remove(entry);
+			entry = NULL;
+		} else {
+			/* Move to the most recently used end */
+			list_remove(&entry->llink);
+			list_append(&entry->llink, &cache_lru);
+			entry->refcnt++;
+		}
+	}
+
+	fibril_mutex_unlock(&cache_lock);
+	return entry;
+}
+
+/** Insert response into cache.
+ *
+ * The cache takes ownership of @a data. If the response is too large
+ * to be cached, a referenced entry is returned nevertheless and it is
+ * destroyed when the reference is dropped.
+ *
+ * @param uri      Request URI
+ * @param data     Response header followed by file data
+ * @param hdr_size Size of response header
+ * @param size     Size of header and file data
+ * @return Referenced entry or @c NULL if out of memory (in which case
+ *         @a data is freed)
+ */
+cache_entry_t *cache_insert(const char *uri, char *data, size_t hdr_size,
+    size_t size)
+{
+	cache_entry_t *entry = calloc(1, sizeof(cache_entry_t));
+	if (entry == NULL) {
+		free(data);
+		return NULL;
+	}
+
+	entry->uri = str_dup(uri);
+	if (entry->uri == NULL) {
+		free(data);
+		free(entry);
+		return NULL;
+	}
+
+	entry->data = data;
+	entry->hdr_size = hdr_size;
+	entry->size = size;
+	entry->refcnt = 1;
+	link_initialize(&entry->llink);
+
+	getuptime(&entry->expires);
+	entry->expires.tv_sec += CACHE_TTL;
+
+	if (size > cache_file_max())
+		return entry;
+
+	fibril_mutex_lock(&cache_lock);
+
+	/* Another fibril might have loaded the same file meanwhile */
+	ht_link_t *link = hash_table_find(&cache_ht, (void *) uri);
+	if (link != NULL)
+		cache_remove(hash_table_get_inst(link, cache_entry_t, htlink));
+
+	while (cache_used + size > cache_capacity) {
+		cache_entry_t *lru = list_get_instance(list_first(&cache_lru),
+		    cache_entry_t, llink);
+		cache_remove(lru);
+	}
+
+	hash_table_insert(&cache_ht, &entry->htlink);
+	list_append(&entry->llink, &cache_lru);
+	cache_used += size;
+	entry->cached = true;
+
+	fibril_mutex_unlock(&cache_lock);
+	return entry;
+}
+
+/** Drop reference to cache entry.
+ *
+ * @param entry Cache entry
+ */
+void cache_entry_put(cache_entry_t *entry)
+{
+	fibril_mutex_lock(&cache_lock);
+
+	assert(entry->refcnt > 0);
+	entry->refcnt--;
+	if ((entry->refcnt == 0) && !entry->cached)
+		cache_entry_destroy(entry);
+
+	fibril_mutex_unlock(&cache_lock);
+}
+
+/** @}
+ */
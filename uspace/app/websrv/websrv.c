@@ -48,19 +48,41 @@
 #include <inet/endpoint.h>
 #include <inet/tcp.h>
 
+#include <http/receive-buffer.h>
+
 #include <arg_parse.h>
 #include <macros.h>
 #include <str.h>
 #include <str_error.h>
 
+#include "cache.h"
+
 #define NAME  "websrv"
 
 #define DEFAULT_PORT  8080
 
 #define WEB_ROOT  "/data/web"
 
-/** Buffer for receiving the request. */
-#define BUFFER_SIZE  1024
+/** Buffer for receiving requests. */
+#define BUFFER_SIZE  4096
+
+/** Longest request or header line. */
+#define LINE_SIZE  1024
+
+/** Longest response header. */
+#define HEADER_SIZE  256
+
+/** Largest block of data sent at once. */
+#define SEND_CHUNK_SIZE  (64 * 1024)
+
+/** Largest block of file data sent directly from the file system. */
+#define SEND_FILE_CHUNK_SIZE  (16 * 1024 * 1024)
+
+/** Default size of file cache in KiB. */
+#define DEFAULT_CACHE_SIZE  4096
+
+/** Maximum number of requests served over one connection. */
+#define MAX_KEEPALIVE_REQUESTS  1000
 
 static void websrv_new_conn(tcp_listener_t *, tcp_conn_t *);
 
@@ -73,29 +95,30 @@ static tcp_cb_t conn_cb = {
 };
 
 static uint16_t port = DEFAULT_PORT;
+static size_t cache_size = DEFAULT_CACHE_SIZE;
 
 typedef struct {
 	tcp_conn_t *conn;
-
-	char rbuf[BUFFER_SIZE];
-	size_t rbuf_out;
-	size_t rbuf_in;
-
-	char lbuf[BUFFER_SIZE + 1];
-	size_t lbuf_used;
+	receive_buffer_t rb;
+	char lbuf[LINE_SIZE];
 } recv_t;
 
+/** Parsed request */
+typedef struct {
+	/** Request URI */
+	char *uri;
+	/** HEAD request (no response body) */
+	bool head;
+	/** Connection stays open after the response */
+	bool keep_alive;
+} request_t;
+
 static bool verbose = false;
 
 /** Responses to send to client. */
 
-static const char *msg_ok =
-    "HTTP/1.0 200 OK\r\n"
-    "\r\n";
-
+static const char *status_bad_request = "400 Bad Request";
 static const char *msg_bad_request =
-    "HTTP/1.0 400 Bad Request\r\n"
-    "\r\n"
     "<!DOCTYPE HTML PUBLIC \"-//IETF//DTD HTML 2.0//EN\">\r\n"
     "<html><head>\r\n"
     "<title>400 Bad Request</title>\r\n"
@@ -106,9 +129,8 @@ static const char *msg_bad_request =
     "</body>\r\n"
     "</html>\r\n";
 
+static const char *status_not_found = "404 Not Found";
 static const char *msg_not_found =
-    "HTTP/1.0 404 Not Found\r\n"
-    "\r\n"
     "<!DOCTYPE HTML PUBLIC \"-//IETF//DTD HTML 2.0//EN\">\r\n"
     "<html><head>\r\n"
     "<title>404 Not Found</title>\r\n"
@@ -119,9 +141,8 @@ static const char *msg_not_found =
     "</body>\r\n"
     "</html>\r\n";
 
+static const char *status_not_implemented = "501 Not Implemented";
 static const char *msg_not_implemented =
-    "HTTP/1.0 501 Not Implemented\r\n"
-    "\r\n"
     "<!DOCTYPE HTML PUBLIC \"-//IETF//DTD HTML 2.0//EN\">\r\n"
     "<html><head>\r\n"
     "<title>501 Not Implemented</title>\r\n"
@@ -132,6 +153,28 @@ static const char *msg_not_implemented =
     "</body>\r\n"
     "</html>\r\n";
 
+/** Content types by file name extension. */
+static const struct {
+	const char *ext;
+	const char *type;
+} content_types[] = {
+	{ ".html", "text/html" },
+	{ ".htm", "text/html" },
+	{ ".txt", "text/plain" },
+	{ ".css", "text/css" },
+	{ ".js", "application/javascript" },
+	{ ".png", "image/png" },
+	{ ".jpg", "image/jpeg" },
+	{ ".gif", "image/gif" }
+};
+
+static errno_t websrv_recv(void *arg, void *buf, size_t size, size_t *nrecv)
+{
+	recv_t *recv = (recv_t *) arg;
+
+	return tcp_conn_recv_wait(recv->conn, buf, size, nrecv);
+}
+
 static errno_t recv_create(tcp_conn_t *conn, recv_t **rrecv)
 {
 	recv_t *recv;
@@ -141,9 +184,13 @@ static errno_t recv_create(tcp_conn_t *conn, recv_t **rrecv)
 		return ENOMEM;
 
 	recv->conn = conn;
-	recv->rbuf_out = 0;
-	recv->rbuf_in = 0;
-	recv->lbuf_used = 0;
+
+	errno_t rc = recv_buffer_init(&recv->rb, BUFFER_SIZE, websrv_recv,
+	    recv);
+	if (rc != EOK) {
+		free(recv);
+		return rc;
+	}
 
 	*rrecv = recv;
 	return EOK;
@@ -151,112 +198,247 @@ static errno_t recv_create(tcp_conn_t *conn, recv_t **rrecv)
 
 static void recv_destroy(recv_t *recv)
 {
+	if (recv == NULL)
+		return;
+
+	recv_buffer_fini(&recv->rb);
 	free(recv);
 }
 
-/** Receive one character (with buffering) */
-static errno_t recv_char(recv_t *recv, char *c)
+/** Receive one line with length limit */
+static errno_t recv_req_line(recv_t *recv, char **rbuf)
 {
 	size_t nrecv;
-	errno_t rc;
 
-	if (recv->rbuf_out == recv->rbuf_in) {
-		recv->rbuf_out = 0;
-		recv->rbuf_in = 0;
+	errno_t rc = recv_line(&recv->rb, recv->lbuf, LINE_SIZE, &nrecv);
+	if (rc != EOK)
+		return rc;
+
+	*rbuf = recv->lbuf;
+	return EOK;
+}
+
+static bool uri_is_valid(char *uri)
+{
+	if (uri[0] != '/')
+		return false;
+
+	if (uri[1] == '.')
+		return false;
+
+	char *cp = uri + 1;
+
+	while (*cp != '\0') {
+		char c = *cp++;
+		if (c == '/')
+			return false;
+	}
+
+	return true;
+}
+
+static const char *uri_content_type(const char *uri)
+{
+	const char *ext = str_rchr(uri, '.');
+
+	if (ext != NULL) {
+		for (size_t i = 0; i < sizeof(content_types) /
+		    sizeof(content_types[0]); i++) {
+			if (str_casecmp(ext, content_types[i].ext) == 0)
+				return content_types[i].type;
+		}
+	}
+
+	return "application/octet-stream";
+}
+
+/** Format response header.
+ *
+ * @param buf        Buffer of size HEADER_SIZE
+ * @param status     Status code and reason phrase
+ * @param type       Content type
+ * @param length     Content length
+ * @param keep_alive Connection stays open after the response
+ *
+ * @return Size of header
+ */
+static size_t response_header(char *buf, const char *status, const char *type,
+    aoff64_t length, bool keep_alive)
+{
+	int rc = snprintf(buf, HEADER_SIZE,
+	    "HTTP/1.1 %s\r\n"
+	    "Content-Type: %s\r\n"
+	    "Content-Length: %" PRIu64 "\r\n"
+	    "Connection: %s\r\n"
+	    "\r\n", status, type, length, keep_alive ? "keep-alive" : "close");
+
+	assert(rc > 0 && rc < HEADER_SIZE);
+	return rc;
+}
 
-		rc = tcp_conn_recv_wait(recv->conn, recv->rbuf, BUFFER_SIZE, &nrecv);
+static errno_t send_data(tcp_conn_t *conn, const void *data, size_t size)
+{
+	const char *bp = data;
+
+	while (size > 0) {
+		size_t now = min(size, SEND_CHUNK_SIZE);
+
+		errno_t rc = tcp_conn_send(conn, bp, now);
 		if (rc != EOK) {
-			fprintf(stderr, "tcp_conn_recv() failed: %s\n", str_error(rc));
+			fprintf(stderr, "tcp_conn_send() failed\n");
 			return rc;
 		}
 
-		recv->rbuf_in = nrecv;
+		bp += now;
+		size -= now;
 	}
 
-	*c = recv->rbuf[recv->rbuf_out++];
 	return EOK;
 }
 
-/** Receive one line with length limit */
-static errno_t recv_line(recv_t *recv, char **rbuf)
+static errno_t send_response(tcp_conn_t *conn, const char *status,
+    const char *msg, request_t *req)
 {
-	char *bp = recv->lbuf;
-	char c = '\0';
+	char hdr[HEADER_SIZE];
+	size_t msg_size = str_size(msg);
+
+	if (verbose)
+		fprintf(stderr, "Sending response\n");
 
-	while (bp < recv->lbuf + BUFFER_SIZE) {
-		char prev = c;
-		errno_t rc = recv_char(recv, &c);
+	size_t hdr_size = response_header(hdr, status, "text/html", msg_size,
+	    req->keep_alive);
 
-		if (rc != EOK)
-			return rc;
+	errno_t rc = send_data(conn, hdr, hdr_size);
+	if (rc != EOK || req->head)
+		return rc;
 
-		*bp++ = c;
-		if ((prev == '\r') && (c == '\n'))
-			break;
+	return send_data(conn, msg, msg_size);
+}
+
+/** Send cached response.
+ *
+ * The cached header announces a persistent connection. If the connection
+ * is to be closed, a different header is sent in front of the data.
+ */
+static errno_t send_entry(tcp_conn_t *conn, cache_entry_t *entry,
+    request_t *req)
+{
+	if (req->keep_alive) {
+		return send_data(conn, entry->data,
+		    req->head ? entry->hdr_size : entry->size);
 	}
 
-	recv->lbuf_used = bp - recv->lbuf;
-	*bp = '\0';
+	char hdr[HEADER_SIZE];
+	size_t hdr_size = response_header(hdr, "200 OK",
+	    uri_content_type(entry->uri), entry->size - entry->hdr_size,
+	    false);
 
-	if (bp == recv->lbuf + BUFFER_SIZE)
-		return ELIMIT;
+	errno_t rc = send_data(conn, hdr, hdr_size);
+	if (rc != EOK || req->head)
+		return rc;
 
-	*rbuf = recv->lbuf;
-	return EOK;
+	return send_data(conn, entry->data + entry->hdr_size,
+	    entry->size - entry->hdr_size);
 }
 
-static bool uri_is_valid(char *uri)
+/** Load file into a cache entry.
+ *
+ * @param uri   Request URI
+ * @param fd    Open file
+ * @param fsize File size
+ * @param rentry Place to store referenced entry
+ */
+static errno_t uri_load(const char *uri, int fd, size_t fsize,
+    cache_entry_t **rentry)
 {
-	if (uri[0] != '/')
-		return false;
+	char hdr[HEADER_SIZE];
+	size_t hdr_size = response_header(hdr, "200 OK", uri_content_type(uri),
+	    fsize, true);
 
-	if (uri[1] == '.')
-		return false;
+	char *data = malloc(hdr_size + fsize);
+	if (data == NULL)
+		return ENOMEM;
 
-	char *cp = uri + 1;
+	memcpy(data, hdr, hdr_size);
 
-	while (*cp != '\0') {
-		char c = *cp++;
-		if (c == '/')
-			return false;
+	aoff64_t pos = 0;
+	size_t total = 0;
+	while (total < fsize) {
+		size_t nr;
+
+		errno_t rc = vfs_read(fd, &pos, data + hdr_size + total,
+		    fsize - total, &nr);
+		if (rc != EOK || nr == 0) {
+			free(data);
+			return (rc != EOK) ? rc : EIO;
+		}
+
+		total += nr;
 	}
 
-	return true;
+	cache_entry_t *entry = cache_insert(uri, data, hdr_size,
+	    hdr_size + fsize);
+	if (entry == NULL)
+		return ENOMEM;
+
+	*rentry = entry;
+	return EOK;
 }
 
-static errno_t send_response(tcp_conn_t *conn, const char *msg)
+/** Send large file directly from the file system. */
+static errno_t uri_send_file(tcp_conn_t *conn, const char *uri, int fd,
+    aoff64_t fsize, request_t *req)
 {
-	size_t response_size = str_size(msg);
-
-	if (verbose)
-		fprintf(stderr, "Sending response\n");
+	char hdr[HEADER_SIZE];
+	size_t hdr_size = response_header(hdr, "200 OK", uri_content_type(uri),
+	    fsize, req->keep_alive);
 
-	errno_t rc = tcp_conn_send(conn, (void *) msg, response_size);
-	if (rc != EOK) {
-		fprintf(stderr, "tcp_conn_send() failed\n");
+	errno_t rc = send_data(conn, hdr, hdr_size);
+	if (rc != EOK || req->head)
 		return rc;
+
+	aoff64_t pos = 0;
+	while (pos < fsize) {
+		size_t nsent;
+
+		rc = tcp_conn_send_file(conn, fd, pos,
+		    min(fsize - pos, SEND_FILE_CHUNK_SIZE), &nsent);
+		if (rc != EOK) {
+			fprintf(stderr, "tcp_conn_send_file() failed\n");
+			return rc;
+		}
+
+		/* File was truncated, the promised length cannot be met */
+		if (nsent == 0)
+			return EIO;
+
+		pos += nsent;
 	}
 
 	return EOK;
 }
 
-static errno_t uri_get(const char *uri, tcp_conn_t *conn)
+static errno_t uri_get(request_t *req, tcp_conn_t *conn)
 {
-	char *fbuf = NULL;
+	const char *uri = req->uri;
 	char *fname = NULL;
+	cache_entry_t *entry;
+	vfs_stat_t st;
 	errno_t rc;
-	size_t nr;
 	int fd = -1;
 
-	fbuf = calloc(BUFFER_SIZE, 1);
-	if (fbuf == NULL) {
-		rc = ENOMEM;
-		goto out;
-	}
-
 	if (str_cmp(uri, "/") == 0)
 		uri = "/index.html";
 
+	entry = cache_lookup(uri);
+	if (entry != NULL) {
+		if (verbose)
+			fprintf(stderr, "Cache hit\n");
+		rc = send_entry(conn, entry, req);
+		cache_entry_put(entry);
+		return rc;
+	}
+
 	if (asprintf(&fname, "%s%s", WEB_ROOT, uri) < 0) {
 		rc = ENOMEM;
 		goto out;
@@ -264,77 +446,141 @@ static errno_t uri_get(const char *uri, tcp_conn_t *conn)
 
 	rc = vfs_lookup_open(fname, WALK_REGULAR, MODE_READ, &fd);
 	if (rc != EOK) {
-		rc = send_response(conn, msg_not_found);
+		rc = send_response(conn, status_not_found, msg_not_found, req);
 		goto out;
 	}
 
 	free(fname);
 	fname = NULL;
 
-	rc = send_response(conn, msg_ok);
+	rc = vfs_stat(fd, &st);
 	if (rc != EOK)
 		goto out;
 
-	aoff64_t pos = 0;
-	while (true) {
-		rc = vfs_read(fd, &pos, fbuf, BUFFER_SIZE, &nr);
+	if (st.size <= cache_file_max()) {
+		rc = uri_load(uri, fd, st.size, &entry);
 		if (rc != EOK)
 			goto out;
 
-		if (nr == 0)
-			break;
-
-		rc = tcp_conn_send(conn, fbuf, nr);
-		if (rc != EOK) {
-			fprintf(stderr, "tcp_conn_send() failed\n");
-			goto out;
-		}
+		rc = send_entry(conn, entry, req);
+		cache_entry_put(entry);
+	} else {
+		rc = uri_send_file(conn, uri, fd, st.size, req);
 	}
 
-	rc = EOK;
 out:
 	if (fd >= 0)
 		vfs_put(fd);
 	free(fname);
-	free(fbuf);
 	return rc;
 }
 
-static errno_t req_process(tcp_conn_t *conn, recv_t *recv)
+/** Receive request headers.
+ *
+ * Only the Connection header is interpreted.
+ */
+static errno_t req_headers(recv_t *recv, request_t *req)
 {
-	char *reqline = NULL;
+	char *line;
 
-	errno_t rc = recv_line(recv, &reqline);
-	if (rc != EOK) {
-		fprintf(stderr, "recv_line() failed\n");
-		return rc;
+	while (true) {
+		errno_t rc = recv_req_line(recv, &line);
+		if (rc != EOK)
+			return rc;
+
+		if (line[0] == '\0')
+			break;
+
+		if (str_lcasecmp(line, "Connection:", 11) != 0)
+			continue;
+
+		char *value = line + 11;
+		while (*value == ' ' || *value == '\t')
+			value++;
+
+		if (str_lcasecmp(value, "close", 5) == 0)
+			req->keep_alive = false;
+		else if (str_lcasecmp(value, "keep-alive", 10) == 0)
+			req->keep_alive = true;
 	}
 
-	if (verbose)
-		fprintf(stderr, "Request: %s", reqline);
+	return EOK;
+}
 
-	if (str_lcmp(reqline, "GET ", 4) != 0) {
-		rc = send_response(conn, msg_not_implemented);
-		return rc;
+static errno_t req_process(recv_t *recv, bool *keep_alive)
+{
+	tcp_conn_t *conn = recv->conn;
+	request_t req;
+	char *reqline = NULL;
+	errno_t rc;
+
+	/* Tolerate empty lines in front of the request */
+	do {
+		rc = recv_req_line(recv, &reqline);
+		if (rc != EOK) {
+			fprintf(stderr, "recv_line() failed\n");
+			return rc;
+		}
+	} while (reqline[0] == '\0');
+
+	if (verbose)
+		fprintf(stderr, "Request: %s\n", reqline);
+
+	req.head = false;
+	req.keep_alive = false;
+
+	char *uri;
+	bool implemented = true;
+
+	if (str_lcmp(reqline, "GET ", 4) == 0) {
+		uri = reqline + 4;
+	} else if (str_lcmp(reqline, "HEAD ", 5) == 0) {
+		uri = reqline + 5;
+		req.head = true;
+	} else {
+		uri = reqline;
+		implemented = false;
 	}
 
-	char *uri = reqline + 4;
-	char *end_uri = str_chr(uri, ' ');
-	if (end_uri == NULL) {
-		end_uri = reqline + str_size(reqline) - 2;
-		assert(*end_uri == '\r');
+	char *version = str_chr(uri, ' ');
+	if (version != NULL) {
+		*version++ = '\0';
+		/* HTTP/1.1 connections are persistent by default */
+		if (str_cmp(version, "HTTP/1.1") == 0)
+			req.keep_alive = true;
 	}
 
-	*end_uri = '\0';
+	/* Copy URI, the line buffer is reused for headers */
+	req.uri = str_dup(uri);
+	if (req.uri == NULL)
+		return ENOMEM;
+
+	rc = req_headers(recv, &req);
+	if (rc != EOK)
+		goto out;
+
 	if (verbose)
-		fprintf(stderr, "Requested URI: %s\n", uri);
+		fprintf(stderr, "Requested URI: %s\n", req.uri);
 
-	if (!uri_is_valid(uri)) {
-		rc = send_response(conn, msg_bad_request);
-		return rc;
+	if (!implemented) {
+		req.keep_alive = false;
+		rc = send_response(conn, status_not_implemented,
+		    msg_not_implemented, &req);
+		goto out;
 	}
 
-	return uri_get(uri, conn);
+	if (!uri_is_valid(req.uri)) {
+		req.keep_alive = false;
+		rc = send_response(conn, status_bad_request, msg_bad_request,
+		    &req);
+		goto out;
+	}
+
+	rc = uri_get(&req, conn);
+out:
+	*keep_alive = req.keep_alive;
+	free(req.uri);
+	return rc;
 }
 
 static void usage(void)
@@ -347,6 +593,10 @@ static void usage(void)
 	    "-p port_number | --port=port_number\n"
 	    "\tListening port (default " STRING(DEFAULT_PORT) ").\n"
 	    "\n"
+	    "-c size | --cache=size\n"
+	    "\tFile cache size in KiB, 0 disables caching (default "
+	    STRING(DEFAULT_CACHE_SIZE) ").\n"
+	    "\n"
 	    "-h | --help\n"
 	    "\tShow this application help.\n"
 	    "-v | --verbose\n"
@@ -370,6 +620,13 @@ static errno_t parse_option(int argc, char *argv[], int *index)
 
 		port = (uint16_t) value;
 		break;
+	case 'c':
+		rc = arg_parse_int(argc, argv, index, &value, 0);
+		if (rc != EOK)
+			return rc;
+
+		cache_size = (size_t) value;
+		break;
 	case 'v':
 		verbose = true;
 		break;
@@ -384,6 +641,12 @@ static errno_t parse_option(int argc, char *argv[], int *index)
 				return rc;
 
 			port = (uint16_t) value;
+		} else if (str_lcmp(argv[*index] + 2, "cache=", 6) == 0) {
+			rc = arg_parse_int(argc, argv, index, &value, 8);
+			if (rc != EOK)
+				return rc;
+
+			cache_size = (size_t) value;
 		} else if (str_cmp(argv[*index] + 2, "verbose") == 0) {
 			verbose = true;
 		} else {
@@ -403,6 +666,7 @@ static void websrv_new_conn(tcp_listener_t *lst, tcp_conn_t *conn)
 {
 	errno_t rc;
 	recv_t *recv = NULL;
+	bool keep_alive = true;
 
 	if (verbose)
 		fprintf(stderr, "New connection, waiting for request\n");
@@ -413,11 +677,27 @@ static void websrv_new_conn(tcp_listener_t *lst, tcp_conn_t *conn)
 		goto error;
 	}
 
-	rc = req_process(conn, recv);
-	if (rc != EOK) {
-		fprintf(stderr, "Error processing request (%s)\n",
-		    str_error(rc));
-		goto error;
+	/*
+	 * Serve requests until the client asks to close the connection.
+	 * Pipelined requests are already waiting in the receive buffer.
+	 */
+	for (int nreq = 0; keep_alive && nreq < MAX_KEEPALIVE_REQUESTS;
+	    nreq++) {
+		if (nreq > 0) {
+			char c;
+
+			/* The client may close an idle connection */
+			rc = recv_char(&recv->rb, &c, false);
+			if (rc != EOK)
+				break;
+		}
+
+		rc = req_process(recv, &keep_alive);
+		if (rc != EOK) {
+			fprintf(stderr, "Error processing request (%s)\n",
+			    str_error(rc));
+			goto error;
+		}
 	}
 
 	rc = tcp_conn_send_fin(conn);
@@ -457,6 +737,12 @@ int main(int argc, char *argv[])
 
 	printf("%s: HelenOS web server\n", NAME);
 
+	rc = cache_init(cache_size * 1024);
+	if (rc != EOK) {
+		fprintf(stderr, "Error initializing file cache.\n");
+		return 1;
+	}
+
 	if (verbose)
 		fprintf(stderr, "Creating listener\n");
 
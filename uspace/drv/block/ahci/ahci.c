@@ -31,7 +31,11 @@
  */
 
 #include <as.h>
+#include <assert.h>
+#include <barrier.h>
 #include <errno.h>
+#include <fibril.h>
+#include <macros.h>
 #include <stdio.h>
 #include <ddf/interrupt.h>
 #include <ddf/log.h>
@@ -116,8 +120,7 @@ static errno_t write_blocks(ddf_fun_t *, uint64_t, size_t, void *);
 
 static errno_t ahci_identify_device(sata_dev_t *);
 static errno_t ahci_set_highest_ultra_dma_mode(sata_dev_t *);
-static errno_t ahci_rb_fpdma(sata_dev_t *, uintptr_t, uint64_t);
-static errno_t ahci_wb_fpdma(sata_dev_t *, uintptr_t, uint64_t);
+static errno_t ahci_rw_fpdma(sata_dev_t *, bool, uint64_t, size_t, void *);
 
 static void ahci_sata_devices_create(ahci_dev_t *, ddf_dev_t *);
 static ahci_dev_t *ahci_ahci_create(ddf_dev_t *);
@@ -228,33 +231,7 @@ static errno_t read_blocks(ddf_fun_t *fun, uint64_t blocknum,
     size_t count, void *buf)
 {
 	sata_dev_t *sata = fun_sata_dev(fun);
-
-	uintptr_t phys;
-	void *ibuf = AS_AREA_ANY;
-	errno_t rc = dmamem_map_anonymous(sata->block_size, DMAMEM_4GiB,
-	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &ibuf);
-	if (rc != EOK) {
-		ddf_msg(LVL_ERROR, "Cannot allocate read buffer.");
-		return rc;
-	}
-
-	memset(buf, 0, sata->block_size);
-
-	fibril_mutex_lock(&sata->lock);
-
-	for (size_t cur = 0; cur < count; cur++) {
-		rc = ahci_rb_fpdma(sata, phys, blocknum + cur);
-		if (rc != EOK)
-			break;
-
-		memcpy((void *) (((uint8_t *) buf) + (sata->block_size * cur)),
-		    ibuf, sata->block_size);
-	}
-
-	fibril_mutex_unlock(&sata->lock);
-	dmamem_unmap_anonymous(ibuf);
-
-	return rc;
+	return ahci_rw_fpdma(sata, false, blocknum, count, buf);
 }
 
 /** Write data blocks into SATA device.
@@ -271,30 +248,7 @@ static errno_t write_blocks(ddf_fun_t *fun, uint64_t blocknum,
     size_t count, void *buf)
 {
 	sata_dev_t *sata = fun_sata_dev(fun);
-
-	uintptr_t phys;
-	void *ibuf = AS_AREA_ANY;
-	errno_t rc = dmamem_map_anonymous(sata->block_size, DMAMEM_4GiB,
-	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &ibuf);
-	if (rc != EOK) {
-		ddf_msg(LVL_ERROR, "Cannot allocate write buffer.");
-		return rc;
-	}
-
-	fibril_mutex_lock(&sata->lock);
-
-	for (size_t cur = 0; cur < count; cur++) {
-		memcpy(ibuf, (void *) (((uint8_t *) buf) + (sata->block_size * cur)),
-		    sata->block_size);
-		rc = ahci_wb_fpdma(sata, phys, blocknum + cur);
-		if (rc != EOK)
-			break;
-	}
-
-	fibril_mutex_unlock(&sata->lock);
-	dmamem_unmap_anonymous(ibuf);
-
-	return rc;
+	return ahci_rw_fpdma(sata, true, blocknum, count, buf);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -478,6 +432,9 @@ static errno_t ahci_identify_device(sata_dev_t *sata)
 		goto error;
 	}
 
+	/* Bits 4:0 of queue depth hold maximum queue depth minus one. */
+	sata->slot_count = (idata->queue_depth & 0x1f) + 1;
+
 	uint16_t logsec = idata->physical_logic_sector_size;
 	if ((logsec & 0xc000) == 0x4000) {
 		/* Length of sector may be larger than 512 B */
@@ -668,23 +625,64 @@ error:
 	return EINTR;
 }
 
-/** Set AHCI registers for reading one sector from the SATA device using FPDMA.
+/** Fill PRDT of a command slot.
+ *
+ * @param slot  Command slot.
+ * @param phys  Physical address of data buffer.
+ * @param bytes Number of bytes to transfer.
+ *
+ * @return Number of PRDT entries used.
+ *
+ */
+static uint16_t ahci_fill_prdt(ahci_slot_t *slot, uintptr_t phys, size_t bytes)
+{
+	uint16_t prdtl = 0;
+
+	while ((bytes > 0) && (prdtl < AHCI_SLOT_PRDT_COUNT)) {
+		size_t len = min(bytes, (size_t) AHCI_PRDT_MAX_BYTES);
+
+		volatile ahci_cmd_prdt_t *prdt =
+		    (ahci_cmd_prdt_t *) (&slot->table[0x20 + 4 * prdtl]);
+
+		prdt->data_address_low = LO(phys);
+		prdt->data_address_upper = HI(phys);
+		prdt->reserved1 = 0;
+		prdt->dbc = len - 1;
+		prdt->reserved2 = 0;
+		prdt->ioc = 0;
+
+		phys += len;
+		bytes -= len;
+		prdtl++;
+	}
+
+	assert(bytes == 0);
+	return prdtl;
+}
+
+/** Set AHCI registers for a FPDMA transfer and issue the command.
+ *
+ * The data are transferred from/to the DMA buffer of the slot.
  *
  * @param sata     SATA device structure.
- * @param phys     Physical address of buffer for sector data.
- * @param blocknum Block number to read.
+ * @param tag      Command slot (NCQ tag).
+ * @param write    Write (true) or read (false) the blocks.
+ * @param blocknum Number of first block.
+ * @param count    Number of blocks.
  *
  */
-static void ahci_rb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
-    uint64_t blocknum)
+static void ahci_fpdma_cmd(sata_dev_t *sata, unsigned int tag, bool write,
+    uint64_t blocknum, size_t count)
 {
+	ahci_slot_t *slot = &sata->slots[tag];
 	volatile sata_ncq_command_frame_t *cmd =
-	    (sata_ncq_command_frame_t *) sata->cmd_table;
+	    (sata_ncq_command_frame_t *) slot->table;
 
 	cmd->fis_type = SATA_CMD_FIS_TYPE;
 	cmd->c = SATA_CMD_FIS_COMMAND_INDICATOR;
-	cmd->command = 0x60;
-	cmd->tag = 0;
+	cmd->command = write ? 0x61 : 0x60;
+	/* Tag lives in bits 7:3 of the count field. */
+	cmd->tag = tag << 3;
 	cmd->control = 0;
 
 	cmd->reserved1 = 0;
@@ -694,8 +692,8 @@ static void ahci_rb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
 	cmd->reserved5 = 0;
 	cmd->reserved6 = 0;
 
-	cmd->sector_count_low = 1;
-	cmd->sector_count_high = 0;
+	cmd->sector_count_low = count & 0xff;
+	cmd->sector_count_high = (count >> 8) & 0xff;
 
 	cmd->lba0 = blocknum & 0xff;
 	cmd->lba1 = (blocknum >> 8) & 0xff;
@@ -704,141 +702,147 @@ static void ahci_rb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
 	cmd->lba4 = (blocknum >> 32) & 0xff;
 	cmd->lba5 = (blocknum >> 40) & 0xff;
 
-	volatile ahci_cmd_prdt_t *prdt =
-	    (ahci_cmd_prdt_t *) (&sata->cmd_table[0x20]);
+	volatile ahci_cmdhdr_t *hdr = &sata->cmd_header[tag];
 
-	prdt->data_address_low = LO(phys);
-	prdt->data_address_upper = HI(phys);
-	prdt->reserved1 = 0;
-	prdt->dbc = sata->block_size - 1;
-	prdt->reserved2 = 0;
-	prdt->ioc = 0;
-
-	sata->cmd_header->prdtl = 1;
-	sata->cmd_header->flags =
+	hdr->prdtl = ahci_fill_prdt(slot, slot->buf_phys,
+	    count * sata->block_size);
+	hdr->flags =
 	    AHCI_CMDHDR_FLAGS_CLEAR_BUSY_UPON_OK |
+	    (write ? AHCI_CMDHDR_FLAGS_WRITE : 0) |
 	    AHCI_CMDHDR_FLAGS_5DWCMD;
-	sata->cmd_header->bytesprocessed = 0;
+	hdr->bytesprocessed = 0;
 
-	sata->port->pxsact |= 1;
-	sata->port->pxci |= 1;
+	/* Data and command table must be in memory before the HBA looks. */
+	memory_barrier();
+
+	sata->port->pxsact = 1U << tag;
+	sata->port->pxci = 1U << tag;
 }
 
-/** Read one sector from the SATA device using FPDMA.
+/** Collect completed commands of a request.
  *
- * @param sata     SATA device structure.
- * @param phys     Physical address of buffer for sector data.
- * @param blocknum Block number to read.
+ * Copy data of completed reads to the caller and release the slots.
  *
- * @return EOK if succeed, error code otherwise
+ * Precondition: sata->slot_lock is locked.
+ *
+ * @param sata SATA device structure.
+ * @param mine Mask of slots owned by the request, updated.
+ * @param rc   Result of the request, updated on error.
+ *
+ * @return True if any slot was released.
  *
  */
-static errno_t ahci_rb_fpdma(sata_dev_t *sata, uintptr_t phys, uint64_t blocknum)
+static bool ahci_reap_slots(sata_dev_t *sata, uint32_t *mine, errno_t *rc)
 {
-	if (sata->is_invalid_device) {
-		ddf_msg(LVL_ERROR,
-		    "%s: FPDMA read from invalid device", sata->model);
-		return EINTR;
-	}
+	bool reaped = false;
 
-	ahci_rb_fpdma_cmd(sata, phys, blocknum);
-	ahci_port_is_t pxis = ahci_wait_event(sata);
+	for (unsigned int tag = 0; tag < sata->slot_count; tag++) {
+		uint32_t mask = 1U << tag;
+		ahci_slot_t *slot = &sata->slots[tag];
 
-	if ((sata->is_invalid_device) || (ahci_port_is_error(pxis))) {
-		ddf_msg(LVL_ERROR,
-		    "%s: Unrecoverable error during FPDMA read", sata->model);
-		return EINTR;
+		if (((*mine & mask) == 0) || (!slot->done))
+			continue;
+
+		if (slot->rc != EOK)
+			*rc = slot->rc;
+		else if (slot->dst != NULL)
+			memcpy(slot->dst, slot->buf, slot->bytes);
+
+		*mine &= ~mask;
+		sata->slots_free |= mask;
+		reaped = true;
 	}
 
-	return EOK;
+	if (reaped)
+		fibril_condvar_broadcast(&sata->slot_cv);
+
+	return reaped;
 }
 
-/** Set AHCI registers for writing one sector to the SATA device, use FPDMA.
+/** Transfer blocks using FPDMA.
+ *
+ * The request is split into commands that fit the slot DMA buffers. All
+ * of them are issued at once (as far as free slots go) and the device is
+ * free to complete them in any order.
  *
  * @param sata     SATA device structure.
- * @param phys     Physical address of buffer with sector data.
- * @param blocknum Block number to write.
+ * @param write    Write (true) or read (false) the blocks.
+ * @param blocknum Number of first block.
+ * @param count    Number of blocks.
+ * @param buf      Buffer with/for data.
  *
  * @return EOK if succeed, error code otherwise
  *
  */
-static void ahci_wb_fpdma_cmd(sata_dev_t *sata, uintptr_t phys,
-    uint64_t blocknum)
+static errno_t ahci_rw_fpdma(sata_dev_t *sata, bool write, uint64_t blocknum,
+    size_t count, void *buf)
 {
-	volatile sata_ncq_command_frame_t *cmd =
-	    (sata_ncq_command_frame_t *) sata->cmd_table;
-
-	cmd->fis_type = SATA_CMD_FIS_TYPE;
-	cmd->c = SATA_CMD_FIS_COMMAND_INDICATOR;
-	cmd->command = 0x61;
-	cmd->tag = 0;
-	cmd->control = 0;
+	size_t per_slot = AHCI_SLOT_BUF_SIZE / sata->block_size;
+	uint32_t mine = 0;
+	errno_t rc = EOK;
+
+	fibril_mutex_lock(&sata->slot_lock);
+
+	size_t cur = 0;
+	while ((cur < count) && (rc == EOK)) {
+		if (sata->is_invalid_device) {
+			ddf_msg(LVL_ERROR, "%s: FPDMA %s invalid device",
+			    sata->model, write ? "write to" : "read from");
+			rc = EINTR;
+			break;
+		}
 
-	cmd->reserved1 = 0;
-	cmd->reserved2 = 0;
-	cmd->reserved3 = 0;
-	cmd->reserved4 = 0;
-	cmd->reserved5 = 0;
-	cmd->reserved6 = 0;
+		/*
+		 * Our own completed commands must be collected here too,
+		 * otherwise concurrent requests could starve each other.
+		 */
+		if (sata->slots_free == 0) {
+			if (!ahci_reap_slots(sata, &mine, &rc))
+				fibril_condvar_wait(&sata->slot_cv,
+				    &sata->slot_lock);
+			continue;
+		}
 
-	cmd->sector_count_low = 1;
-	cmd->sector_count_high = 0;
+		unsigned int tag = 0;
+		while ((sata->slots_free & (1U << tag)) == 0)
+			tag++;
 
-	cmd->lba0 = blocknum & 0xff;
-	cmd->lba1 = (blocknum >> 8) & 0xff;
-	cmd->lba2 = (blocknum >> 16) & 0xff;
-	cmd->lba3 = (blocknum >> 24) & 0xff;
-	cmd->lba4 = (blocknum >> 32) & 0xff;
-	cmd->lba5 = (blocknum >> 40) & 0xff;
+		size_t n = min(count - cur, per_slot);
+		uint8_t *data = (uint8_t *) buf + cur * sata->block_size;
+		ahci_slot_t *slot = &sata->slots[tag];
 
-	volatile ahci_cmd_prdt_t *prdt =
-	    (ahci_cmd_prdt_t *) (&sata->cmd_table[0x20]);
-
-	prdt->data_address_low = LO(phys);
-	prdt->data_address_upper = HI(phys);
-	prdt->reserved1 = 0;
-	prdt->dbc = sata->block_size - 1;
-	prdt->reserved2 = 0;
-	prdt->ioc = 0;
+		slot->bytes = n * sata->block_size;
+		slot->done = false;
+		slot->rc = EOK;
+		if (write) {
+			memcpy(slot->buf, data, slot->bytes);
+			slot->dst = NULL;
+		} else {
+			slot->dst = data;
+		}
 
-	sata->cmd_header->prdtl = 1;
-	sata->cmd_header->flags =
-	    AHCI_CMDHDR_FLAGS_CLEAR_BUSY_UPON_OK |
-	    AHCI_CMDHDR_FLAGS_WRITE |
-	    AHCI_CMDHDR_FLAGS_5DWCMD;
-	sata->cmd_header->bytesprocessed = 0;
+		sata->slots_free &= ~(1U << tag);
+		sata->slots_active |= 1U << tag;
+		mine |= 1U << tag;
 
-	sata->port->pxsact |= 1;
-	sata->port->pxci |= 1;
-}
+		ahci_fpdma_cmd(sata, tag, write, blocknum + cur, n);
+		cur += n;
+	}
 
-/** Write one sector into the SATA device, use FPDMA.
- *
- * @param sata     SATA device structure.
- * @param phys     Physical address of buffer with sector data.
- * @param blocknum Block number to write.
- *
- * @return EOK if succeed, error code otherwise
- *
- */
-static errno_t ahci_wb_fpdma(sata_dev_t *sata, uintptr_t phys, uint64_t blocknum)
-{
-	if (sata->is_invalid_device) {
-		ddf_msg(LVL_ERROR,
-		    "%s: FPDMA write to invalid device", sata->model);
-		return EINTR;
+	/* Wait for all issued commands. */
+	while (mine != 0) {
+		if (!ahci_reap_slots(sata, &mine, &rc))
+			fibril_condvar_wait(&sata->slot_cv, &sata->slot_lock);
 	}
 
-	ahci_wb_fpdma_cmd(sata, phys, blocknum);
-	ahci_port_is_t pxis = ahci_wait_event(sata);
+	fibril_mutex_unlock(&sata->slot_lock);
 
-	if ((sata->is_invalid_device) || (ahci_port_is_error(pxis))) {
-		ddf_msg(LVL_ERROR,
-		    "%s: Unrecoverable error during FPDMA write", sata->model);
-		return EINTR;
+	if (rc != EOK) {
+		ddf_msg(LVL_ERROR, "%s: Unrecoverable error during FPDMA %s",
+		    sata->model, write ? "write" : "read");
 	}
 
-	return EOK;
+	return rc;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -887,6 +891,88 @@ static irq_cmd_t ahci_cmds[] = {
 	AHCI_PORT_CMDS(31)
 };
 
+/** Restart command processing of a port after an error.
+ *
+ * Stopping the port clears PxCI and PxSACT, all outstanding commands
+ * are lost.
+ *
+ * @param sata SATA device structure.
+ *
+ */
+static void ahci_port_restart(sata_dev_t *sata)
+{
+	ahci_port_cmd_t pxcmd;
+
+	pxcmd.u32 = sata->port->pxcmd;
+	pxcmd.st = 0;
+	sata->port->pxcmd = pxcmd.u32;
+
+	/* The HBA has 500 ms to stop the command list engine. */
+	for (unsigned int i = 0; i < 500; i++) {
+		pxcmd.u32 = sata->port->pxcmd;
+		if (pxcmd.cr == 0)
+			break;
+		fibril_usleep(1000);
+	}
+
+	sata->port->pxserr = 0xffffffff;
+	sata->port->pxis = 0xffffffff;
+
+	pxcmd.u32 = sata->port->pxcmd;
+	pxcmd.st = 1;
+	sata->port->pxcmd = pxcmd.u32;
+}
+
+/** Complete FPDMA commands.
+ *
+ * Commands whose bits are no longer set in PxSACT and PxCI have
+ * completed. On error, all outstanding commands fail.
+ *
+ * @param sata SATA device structure.
+ * @param pxis Value of port interrupt status register.
+ *
+ */
+static void ahci_complete_slots(sata_dev_t *sata, ahci_port_is_t pxis)
+{
+	fibril_mutex_lock(&sata->slot_lock);
+
+	if (sata->slots_active == 0) {
+		fibril_mutex_unlock(&sata->slot_lock);
+		return;
+	}
+
+	uint32_t done;
+	errno_t rc = EOK;
+
+	if (ahci_port_is_error(pxis)) {
+		done = sata->slots_active;
+		rc = EIO;
+
+		if (ahci_port_is_permanent_error(pxis))
+			sata->is_invalid_device = true;
+		else
+			ahci_port_restart(sata);
+	} else {
+		uint32_t busy = sata->port->pxsact | sata->port->pxci;
+		done = sata->slots_active & ~busy;
+	}
+
+	for (unsigned int tag = 0; tag < sata->slot_count; tag++) {
+		if ((done & (1U << tag)) == 0)
+			continue;
+
+		sata->slots[tag].done = true;
+		sata->slots[tag].rc = rc;
+	}
+
+	sata->slots_active &= ~done;
+
+	if (done != 0)
+		fibril_condvar_broadcast(&sata->slot_cv);
+
+	fibril_mutex_unlock(&sata->slot_lock);
+}
+
 /** AHCI interrupt handler.
  *
  * @param icall The IPC call structure.
@@ -915,6 +1001,8 @@ static void ahci_interrupt(ipc_call_t *icall, ddf_dev_t *dev)
 		fibril_condvar_signal(&sata->event_condvar);
 
 		fibril_mutex_unlock(&sata->event_lock);
+
+		ahci_complete_slots(sata, pxis);
 	}
 }
 
@@ -968,16 +1056,24 @@ static sata_dev_t *ahci_sata_allocate(ahci_dev_t *ahci, volatile ahci_port_t *po
 	sata->port->pxclb = LO(phys);
 	sata->cmd_header = (ahci_cmdhdr_t *) virt_cmd;
 
-	/* Allocate and init command table structure. */
-	rc = dmamem_map_anonymous(size, DMAMEM_4GiB,
+	/* Allocate and init command tables of all slots. */
+	size_t table_size = AHCI_MAX_SLOTS * AHCI_CMD_TABLE_SIZE;
+	rc = dmamem_map_anonymous(table_size, DMAMEM_4GiB,
 	    AS_AREA_READ | AS_AREA_WRITE, 0, &phys, &virt_table);
 	if (rc != EOK)
 		goto error_table;
 
-	memset(virt_table, 0, size);
-	sata->cmd_header->cmdtableu = HI(phys);
-	sata->cmd_header->cmdtable = LO(phys);
-	sata->cmd_table = (uint32_t *) virt_table;
+	memset(virt_table, 0, table_size);
+	for (unsigned int tag = 0; tag < AHCI_MAX_SLOTS; tag++) {
+		uintptr_t table_phys = phys + tag * AHCI_CMD_TABLE_SIZE;
+
+		sata->cmd_header[tag].cmdtableu = HI(table_phys);
+		sata->cmd_header[tag].cmdtable = LO(table_phys);
+		sata->slots[tag].table = (uint32_t *)
+		    ((uint8_t *) virt_table + tag * AHCI_CMD_TABLE_SIZE);
+	}
+
+	sata->cmd_table = sata->slots[0].table;
 
 	return sata;
 
@@ -990,6 +1086,55 @@ error_retfis:
 	return NULL;
 }
 
+/** Allocate DMA buffers of command slots.
+ *
+ * The buffers stay mapped for the lifetime of the device so that no
+ * DMA memory needs to be allocated for transfers.
+ *
+ * @param sata SATA device structure.
+ *
+ * @return EOK if succeed, error code otherwise.
+ *
+ */
+static errno_t ahci_sata_slots_init(sata_dev_t *sata)
+{
+	ahci_ghc_cap_t cap;
+	cap.u32 = sata->ahci->memregs->ghc.cap;
+
+	/* Device queue depth is already in slot_count. */
+	sata->slot_count = min(sata->slot_count, cap.ncs + 1U);
+	sata->slots_free = 0;
+	sata->slots_active = 0;
+
+	for (unsigned int tag = 0; tag < sata->slot_count; tag++) {
+		ahci_slot_t *slot = &sata->slots[tag];
+
+		slot->buf = AS_AREA_ANY;
+		errno_t rc = dmamem_map_anonymous(AHCI_SLOT_BUF_SIZE,
+		    DMAMEM_4GiB, AS_AREA_READ | AS_AREA_WRITE, 0,
+		    &slot->buf_phys, &slot->buf);
+		if (rc != EOK) {
+			if (tag == 0) {
+				ddf_msg(LVL_ERROR,
+				    "%s: Cannot allocate slot buffers.",
+				    sata->model);
+				return rc;
+			}
+
+			/* Go on with fewer slots. */
+			sata->slot_count = tag;
+			break;
+		}
+
+		sata->slots_free |= 1U << tag;
+	}
+
+	ddf_msg(LVL_NOTE, "%s: Using %u command slots.", sata->model,
+	    sata->slot_count);
+
+	return EOK;
+}
+
 /** Initialize and start SATA hardware device.
  *
  * @param sata SATA device structure.
@@ -1056,6 +1201,8 @@ static errno_t ahci_sata_create(ahci_dev_t *ahci, ddf_dev_t *dev,
 	fibril_mutex_initialize(&sata->lock);
 	fibril_mutex_initialize(&sata->event_lock);
 	fibril_condvar_initialize(&sata->event_condvar);
+	fibril_mutex_initialize(&sata->slot_lock);
+	fibril_condvar_initialize(&sata->slot_cv);
 
 	ahci_sata_hw_start(sata);
 
@@ -1067,6 +1214,10 @@ static errno_t ahci_sata_create(ahci_dev_t *ahci, ddf_dev_t *dev,
 	if (ahci_set_highest_ultra_dma_mode(sata) != EOK)
 		goto error;
 
+	/* Prepare command slots for NCQ */
+	if (ahci_sata_slots_init(sata) != EOK)
+		goto error;
+
 	/* Add device to the system */
 	char sata_dev_name[16];
 	snprintf(sata_dev_name, 16, "ahci_%u", sata_devices_count);
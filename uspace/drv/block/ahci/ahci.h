@@ -35,11 +35,53 @@
 
 #include <async.h>
 #include <ddf/interrupt.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stddef.h>
 #include <stdint.h>
 #include "ahci_hw.h"
 
+/** Maximum number of command slots of a port. */
+#define AHCI_MAX_SLOTS  32
+
+/** Number of PRDT entries in a command table. */
+#define AHCI_SLOT_PRDT_COUNT  8
+
+/** Size of a command table (header, ATAPI command and PRDT). */
+#define AHCI_CMD_TABLE_SIZE  (0x80 + AHCI_SLOT_PRDT_COUNT * 16)
+
+/** Size of DMA buffer of each command slot. */
+#define AHCI_SLOT_BUF_SIZE  (64 * 1024)
+
+/** Maximum byte count of a single PRDT entry. */
+#define AHCI_PRDT_MAX_BYTES  (4 * 1024 * 1024)
+
+/** Command slot. */
+typedef struct {
+	/** Pointer to command table. */
+	volatile uint32_t *table;
+
+	/** DMA buffer for transferred data. */
+	void *buf;
+
+	/** Physical address of DMA buffer. */
+	uintptr_t buf_phys;
+
+	/** Caller buffer to copy read data to (NULL for write). */
+	void *dst;
+
+	/** Number of bytes transferred. */
+	size_t bytes;
+
+	/** Command has completed. */
+	bool done;
+
+	/** Result of the command. */
+	errno_t rc;
+} ahci_slot_t;
+
 /** AHCI Device. */
 typedef struct {
 	/** Pointer to ddf device. */
@@ -72,12 +114,30 @@ typedef struct {
 	/** Pointer to SATA port. */
 	volatile ahci_port_t *port;
 
-	/** Pointer to command header. */
+	/** Pointer to command list (command header of slot 0). */
 	volatile ahci_cmdhdr_t *cmd_header;
 
-	/** Pointer to command table. */
+	/** Pointer to command table of slot 0. */
 	volatile uint32_t *cmd_table;
 
+	/** Command slots. */
+	ahci_slot_t slots[AHCI_MAX_SLOTS];
+
+	/** Number of command slots used for NCQ. */
+	unsigned int slot_count;
+
+	/** Mask of free command slots. */
+	uint32_t slots_free;
+
+	/** Mask of issued command slots. */
+	uint32_t slots_active;
+
+	/** Mutex protecting command slots. */
+	fibril_mutex_t slot_lock;
+
+	/** Signals completed commands and freed slots. */
+	fibril_condvar_t slot_cv;
+
 	/** Mutex for single operation on device. */
 	fibril_mutex_t lock;
 
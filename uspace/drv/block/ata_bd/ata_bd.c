@@ -35,22 +35,27 @@
  * @brief ATA disk driver
  *
  * This driver supports CHS, 28-bit and 48-bit LBA addressing, as well as
- * PACKET devices. It only uses PIO transfers. There is no support DMA
- * or any other fancy features such as S.M.A.R.T, removable devices, etc.
+ * PACKET devices. Register devices on a channel with a bus master block
+ * transfer data using multi-sector DMA commands completed by an interrupt,
+ * everything else uses PIO transfers. There is no support for any other
+ * fancy features such as S.M.A.R.T, removable devices, etc.
  *
  * This driver is based on the ATA-1, ATA-2, ATA-3 and ATA/ATAPI-4 through 7
  * standards, as published by the ANSI, NCITS and INCITS standards bodies,
  * which are freely available. This driver contains no vendor-specific
  * code at this moment.
  *
- * The driver services a single controller which can have up to two disks
- * attached.
+ * The driver services a single controller which can have one (ISA) or two
+ * (PCI IDE) channels, each with up to two disks attached.
  */
 
 #include <ddi.h>
+#include <ddf/interrupt.h>
 #include <ddf/log.h>
+#include <device/hw_res.h>
 #include <async.h>
 #include <as.h>
+#include <barrier.h>
 #include <bd_srv.h>
 #include <fibril_synch.h>
 #include <scsi/mmc.h>
@@ -83,6 +88,8 @@ static const size_t identify_data_size = 512;
 
 static errno_t ata_bd_init_io(ata_ctrl_t *ctrl);
 static void ata_bd_fini_io(ata_ctrl_t *ctrl);
+static errno_t ata_bd_init_dma(ata_ctrl_t *ctrl);
+static void ata_bd_fini_dma(ata_ctrl_t *ctrl);
 
 static errno_t ata_bd_open(bd_srvs_t *, bd_srv_t *);
 static errno_t ata_bd_close(bd_srv_t *);
@@ -100,6 +107,10 @@ static errno_t ata_rcmd_read(disk_t *disk, uint64_t ba, size_t cnt,
 static errno_t ata_rcmd_write(disk_t *disk, uint64_t ba, size_t cnt,
     const void *buf);
 static errno_t ata_rcmd_flush_cache(disk_t *disk);
+static errno_t ata_rcmd_set_xfer_mode(disk_t *disk, uint8_t mode);
+static errno_t ata_chan_reset(ata_ctrl_t *ctrl);
+static errno_t ata_dma_xfer(disk_t *disk, uint8_t cmd, bool read,
+    size_t size);
 static errno_t disk_init(ata_ctrl_t *ctrl, disk_t *d, int disk_id);
 static errno_t ata_identify_dev(disk_t *disk, void *buf);
 static errno_t ata_identify_pkt_dev(disk_t *disk, void *buf);
@@ -141,8 +152,13 @@ static int disk_dev_idx(disk_t *disk)
 	return (disk->disk_id & 1);
 }
 
-/** Initialize ATA controller. */
-errno_t ata_ctrl_init(ata_ctrl_t *ctrl, ata_base_t *res)
+/** Initialize ATA controller.
+ *
+ * @param ctrl	Controller
+ * @param chan	Channel number within the device
+ * @param res	Resources of the channel
+ */
+errno_t ata_ctrl_init(ata_ctrl_t *ctrl, unsigned chan, ata_base_t *res)
 {
 	int i;
 	errno_t rc;
@@ -151,8 +167,12 @@ errno_t ata_ctrl_init(ata_ctrl_t *ctrl, ata_base_t *res)
 	ddf_msg(LVL_DEBUG, "ata_ctrl_init()");
 
 	fibril_mutex_initialize(&ctrl->lock);
+	fibril_condvar_initialize(&ctrl->irq_cv);
+	ctrl->chan = chan;
 	ctrl->cmd_physical = res->cmd;
 	ctrl->ctl_physical = res->ctl;
+	ctrl->bmi_physical = res->bmi;
+	ctrl->irq = res->irq;
 
 	ddf_msg(LVL_NOTE, "I/O address %p/%p", (void *) ctrl->cmd_physical,
 	    (void *) ctrl->ctl_physical);
@@ -161,10 +181,21 @@ errno_t ata_ctrl_init(ata_ctrl_t *ctrl, ata_base_t *res)
 	if (rc != EOK)
 		return rc;
 
+	if (ctrl->bmi_physical != 0) {
+		rc = ata_bd_init_dma(ctrl);
+		if (rc == EOK) {
+			ddf_msg(LVL_NOTE, "Bus master DMA at %p, IRQ %d",
+			    (void *) ctrl->bmi_physical, ctrl->irq);
+		} else {
+			ddf_msg(LVL_WARN, "Bus master DMA not available, "
+			    "using PIO.");
+		}
+	}
+
 	for (i = 0; i < MAX_DISKS; i++) {
 		ddf_msg(LVL_NOTE, "Identify drive %d...", i);
 
-		rc = disk_init(ctrl, &ctrl->disk[i], i);
+		rc = disk_init(ctrl, &ctrl->disk[i], ctrl->chan * MAX_DISKS + i);
 
 		if (rc == EOK) {
 			disk_print_summary(&ctrl->disk[i]);
@@ -320,13 +351,19 @@ static errno_t ata_bd_init_io(ata_ctrl_t *ctrl)
 
 	ctrl->cmd = vaddr;
 
-	rc = pio_enable((void *) ctrl->ctl_physical, sizeof(ata_ctl_t), &vaddr);
+	/*
+	 * Only the last two registers of the control block are used. In PCI
+	 * native mode these are all the channel has.
+	 */
+	rc = pio_enable((void *) (ctrl->ctl_physical +
+	    offsetof(ata_ctl_t, alt_status)),
+	    sizeof(ata_ctl_t) - offsetof(ata_ctl_t, alt_status), &vaddr);
 	if (rc != EOK) {
 		ddf_msg(LVL_ERROR, "Cannot initialize device I/O space.");
 		return rc;
 	}
 
-	ctrl->ctl = vaddr;
+	ctrl->ctl = vaddr - offsetof(ata_ctl_t, alt_status);
 
 	return EOK;
 }
@@ -334,10 +371,226 @@ static errno_t ata_bd_init_io(ata_ctrl_t *ctrl)
 /** Clean up device I/O. */
 static void ata_bd_fini_io(ata_ctrl_t *ctrl)
 {
-	(void) ctrl;
+	ata_bd_fini_dma(ctrl);
 	/* XXX TODO */
 }
 
+/** Interrupt handler.
+ *
+ * The interrupt pseudocode has already acknowledged the interrupt and
+ * passes the device status in ARG1 and the channel number in ARG4.
+ */
+static void ata_irq_handler(ipc_call_t *call, ddf_dev_t *dev)
+{
+	ata_dev_t *adev = (ata_dev_t *) ddf_dev_data_get(dev);
+	unsigned chan = IPC_GET_ARG4(*call);
+	ata_ctrl_t *ctrl;
+
+	if (chan >= adev->channels)
+		return;
+
+	ctrl = &adev->ctrl[chan];
+
+	fibril_mutex_lock(&ctrl->lock);
+	ctrl->irq_status = IPC_GET_ARG1(*call);
+	ctrl->irq_fired = true;
+	fibril_condvar_broadcast(&ctrl->irq_cv);
+	fibril_mutex_unlock(&ctrl->lock);
+}
+
+/** Set up bus master DMA.
+ *
+ * Allocates the descriptor table and the DMA buffer and registers the
+ * interrupt which signals command completion.
+ */
+static errno_t ata_bd_init_dma(ata_ctrl_t *ctrl)
+{
+	uintptr_t bmi_status = ctrl->bmi_physical +
+	    offsetof(ata_bmi_t, status);
+	uintptr_t ata_status = ctrl->cmd_physical +
+	    offsetof(ata_cmd_t, status);
+	void *vaddr;
+	errno_t rc;
+
+	if (ctrl->irq < 0)
+		return ENOTSUP;
+
+	rc = pio_enable((void *) ctrl->bmi_physical, sizeof(ata_bmi_t),
+	    &vaddr);
+	if (rc != EOK)
+		return rc;
+
+	ctrl->bmi = vaddr;
+
+	ctrl->prdt = AS_AREA_ANY;
+	rc = dmamem_map_anonymous(ATA_PRDT_ENTRIES * sizeof(ata_prd_t),
+	    DMAMEM_4GiB, AS_AREA_READ | AS_AREA_WRITE, 0, &ctrl->prdt_phys,
+	    (void **) &ctrl->prdt);
+	if (rc != EOK) {
+		ctrl->prdt = NULL;
+		goto error;
+	}
+
+	ctrl->dma_buf = AS_AREA_ANY;
+	rc = dmamem_map_anonymous(ATA_DMA_BUF_SIZE, DMAMEM_4GiB,
+	    AS_AREA_READ | AS_AREA_WRITE, 0, &ctrl->dma_buf_phys,
+	    &ctrl->dma_buf);
+	if (rc != EOK) {
+		ctrl->dma_buf = NULL;
+		goto error;
+	}
+
+	/* Stop the bus master and clear stale interrupt and error bits */
+	pio_write_8(&ctrl->bmi->command, 0);
+	pio_write_8(&ctrl->bmi->status, pio_read_8(&ctrl->bmi->status) |
+	    BMS_IRQ | BMS_ERROR);
+
+	irq_pio_range_t irq_ranges[] = {
+		{
+			.base = ctrl->bmi_physical,
+			.size = sizeof(ata_bmi_t)
+		},
+		{
+			.base = ctrl->cmd_physical,
+			.size = sizeof(ata_cmd_t)
+		}
+	};
+
+	irq_cmd_t irq_cmds[] = {
+		{
+			.cmd = CMD_PIO_READ_8,
+			.addr = (void *) bmi_status,
+			.dstarg = 2
+		},
+		{
+			.cmd = CMD_AND,
+			.value = BMS_IRQ,
+			.srcarg = 2,
+			.dstarg = 3
+		},
+		{
+			.cmd = CMD_PREDICATE,
+			.value = 4,
+			.srcarg = 3
+		},
+		{
+			/* Writing back the interrupt bit clears it */
+			.cmd = CMD_PIO_WRITE_A_8,
+			.addr = (void *) bmi_status,
+			.srcarg = 2
+		},
+		{
+			/* Reading the status deasserts the interrupt */
+			.cmd = CMD_PIO_READ_8,
+			.addr = (void *) ata_status,
+			.dstarg = 1
+		},
+		{
+			.cmd = CMD_LOAD,
+			.value = ctrl->chan,
+			.dstarg = 4
+		},
+		{
+			.cmd = CMD_ACCEPT
+		}
+	};
+
+	irq_code_t irq_code = {
+		.rangecount = sizeof(irq_ranges) / sizeof(irq_pio_range_t),
+		.ranges = irq_ranges,
+		.cmdcount = sizeof(irq_cmds) / sizeof(irq_cmd_t),
+		.cmds = irq_cmds
+	};
+
+	rc = register_interrupt_handler(ctrl->dev, ctrl->irq, ata_irq_handler,
+	    &irq_code, &ctrl->irq_handle);
+	if (rc != EOK)
+		goto error;
+
+	ctrl->irq_registered = true;
+
+	rc = hw_res_enable_interrupt(ddf_dev_parent_sess_get(ctrl->dev),
+	    ctrl->irq);
+	if (rc != EOK)
+		goto error;
+
+	return EOK;
+error:
+	ata_bd_fini_dma(ctrl);
+	return rc;
+}
+
+/** Release bus master DMA resources. */
+static void ata_bd_fini_dma(ata_ctrl_t *ctrl)
+{
+	if (ctrl->irq_registered) {
+		unregister_interrupt_handler(ctrl->dev, ctrl->irq_handle);
+		ctrl->irq_registered = false;
+	}
+
+	if (ctrl->dma_buf != NULL) {
+		dmamem_unmap_anonymous(ctrl->dma_buf);
+		ctrl->dma_buf = NULL;
+	}
+
+	if (ctrl->prdt != NULL) {
+		dmamem_unmap_anonymous(ctrl->prdt);
+		ctrl->prdt = NULL;
+	}
+
+	ctrl->bmi = NULL;
+}
+
+/** Return number of the highest bit set in @a bits (which is nonzero). */
+static unsigned highest_bit(unsigned bits)
+{
+	unsigned n = 0;
+
+	while ((bits >> (n + 1)) != 0)
+		++n;
+
+	return n;
+}
+
+/** Set up DMA transfers for a register device.
+ *
+ * The transfer mode selected by the firmware is kept. If there is none,
+ * the fastest mode supported by the device is selected.
+ */
+static void disk_init_dma(disk_t *d, identify_data_t *idata)
+{
+	ata_ctrl_t *ctrl = d->ctrl;
+	uint8_t mode;
+	uint8_t bm_status;
+
+	if (ctrl->bmi == NULL || (idata->caps & rd_cap_dma) == 0)
+		return;
+
+	if ((idata->validity & val_udma) != 0 && (idata->udma & 0x7f) != 0) {
+		mode = ((idata->udma >> 8) & 0x7f) != 0 ? 0 :
+		    xm_udma | highest_bit(idata->udma & 0x7f);
+	} else if ((idata->mw_dma & 0x07) != 0) {
+		mode = ((idata->mw_dma >> 8) & 0x07) != 0 ? 0 :
+		    xm_mwdma | highest_bit(idata->mw_dma & 0x07);
+	} else {
+		return;
+	}
+
+	if (mode != 0 && ata_rcmd_set_xfer_mode(d, mode) != EOK) {
+		ddf_msg(LVL_WARN, "Cannot set DMA transfer mode, using PIO.");
+		return;
+	}
+
+	/* Record that the device is set up for DMA */
+	fibril_mutex_lock(&ctrl->lock);
+	bm_status = pio_read_8(&ctrl->bmi->status) & ~(BMS_IRQ | BMS_ERROR);
+	bm_status |= (disk_dev_idx(d) != 0) ? BMS_DRV1_DMA : BMS_DRV0_DMA;
+	pio_write_8(&ctrl->bmi->status, bm_status);
+	fibril_mutex_unlock(&ctrl->lock);
+
+	d->dma = true;
+}
+
 /** Initialize a disk.
  *
  * Probes for a disk, determines its parameters and initializes
@@ -361,6 +614,7 @@ static errno_t disk_init(ata_ctrl_t *ctrl, disk_t *d, int disk_id)
 	d->ctrl = ctrl;
 	d->disk_id = disk_id;
 	d->present = false;
+	d->dma = false;
 	d->afun = NULL;
 
 	/* Try identify command. */
@@ -492,6 +746,8 @@ static errno_t disk_init(ata_ctrl_t *ctrl, disk_t *d, int disk_id)
 	} else {
 		/* Assume register Read always uses 512-byte blocks. */
 		d->block_size = 512;
+
+		disk_init_dma(d, &idata);
 	}
 
 	d->present = true;
@@ -513,25 +769,32 @@ static errno_t ata_bd_read_blocks(bd_srv_t *bd, uint64_t ba, size_t cnt,
     void *buf, size_t size)
 {
 	disk_t *disk = bd_srv_disk(bd);
+	size_t n;
 	errno_t rc;
 
 	if (size < cnt * disk->block_size)
 		return EINVAL;
 
 	while (cnt > 0) {
+		n = disk->dma ? min(cnt, ATA_DMA_MAX_BLOCKS) : 1;
+
 		if (disk->dev_type == ata_reg_dev) {
-			rc = ata_rcmd_read(disk, ba, 1, buf);
+			rc = ata_rcmd_read(disk, ba, n, buf);
 		} else {
 			rc = ata_pcmd_read_12(disk, ba, 1, buf,
 			    disk->block_size);
 		}
 
+		/* DMA has been turned off, transfer the blocks again using PIO */
+		if (rc == EAGAIN)
+			continue;
+
 		if (rc != EOK)
 			return rc;
 
-		++ba;
-		--cnt;
-		buf += disk->block_size;
+		ba += n;
+		cnt -= n;
+		buf += n * disk->block_size;
 	}
 
 	return EOK;
@@ -550,6 +813,7 @@ static errno_t ata_bd_write_blocks(bd_srv_t *bd, uint64_t ba, size_t cnt,
     const void *buf, size_t size)
 {
 	disk_t *disk = bd_srv_disk(bd);
+	size_t n;
 	errno_t rc;
 
 	if (disk->dev_type != ata_reg_dev)
@@ -559,13 +823,20 @@ static errno_t ata_bd_write_blocks(bd_srv_t *bd, uint64_t ba, size_t cnt,
 		return EINVAL;
 
 	while (cnt > 0) {
-		rc = ata_rcmd_write(disk, ba, 1, buf);
+		n = disk->dma ? min(cnt, ATA_DMA_MAX_BLOCKS) : 1;
+
+		rc = ata_rcmd_write(disk, ba, n, buf);
+
+		/* DMA has been turned off, transfer the blocks again using PIO */
+		if (rc == EAGAIN)
+			continue;
+
 		if (rc != EOK)
 			return rc;
 
-		++ba;
-		--cnt;
-		buf += disk->block_size;
+		ba += n;
+		cnt -= n;
+		buf += n * disk->block_size;
 	}
 
 	return EOK;
@@ -999,7 +1270,8 @@ static errno_t ata_pcmd_read_toc(disk_t *disk, uint8_t session, void *obuf,
  * @param cnt		Number of blocks to transfer.
  * @param buf		Buffer for holding the data.
  *
- * @return EOK on success, EIO on error.
+ * @return EOK on success, EIO on error, EAGAIN if DMA has been
+ *         turned off and the transfer must be repeated using PIO.
  */
 static errno_t ata_rcmd_read(disk_t *disk, uint64_t ba, size_t blk_cnt,
     void *buf)
@@ -1039,13 +1311,21 @@ static errno_t ata_rcmd_read(disk_t *disk, uint64_t ba, size_t blk_cnt,
 	}
 
 	/* Program block coordinates into the device. */
-	coord_sc_program(ctrl, &bc, 1);
-
-	pio_write_8(&ctrl->cmd->command, disk->amode == am_lba48 ?
-	    CMD_READ_SECTORS_EXT : CMD_READ_SECTORS);
+	coord_sc_program(ctrl, &bc, blk_cnt);
+
+	if (disk->dma) {
+		rc = ata_dma_xfer(disk, disk->amode == am_lba48 ?
+		    CMD_READ_DMA_EXT : CMD_READ_DMA, true,
+		    blk_cnt * disk->block_size);
+		if (rc == EOK)
+			memcpy(buf, ctrl->dma_buf, blk_cnt * disk->block_size);
+	} else {
+		pio_write_8(&ctrl->cmd->command, disk->amode == am_lba48 ?
+		    CMD_READ_SECTORS_EXT : CMD_READ_SECTORS);
 
-	rc = ata_pio_data_in(disk, buf, blk_cnt * disk->block_size,
-	    disk->block_size, blk_cnt);
+		rc = ata_pio_data_in(disk, buf, blk_cnt * disk->block_size,
+		    disk->block_size, blk_cnt);
+	}
 
 	fibril_mutex_unlock(&ctrl->lock);
 
@@ -1059,7 +1339,8 @@ static errno_t ata_rcmd_read(disk_t *disk, uint64_t ba, size_t blk_cnt,
  * @param cnt		Number of blocks to transfer.
  * @param buf		Buffer holding the data to write.
  *
- * @return EOK on success, EIO on error.
+ * @return EOK on success, EIO on error, EAGAIN if DMA has been
+ *         turned off and the transfer must be repeated using PIO.
  */
 static errno_t ata_rcmd_write(disk_t *disk, uint64_t ba, size_t cnt,
     const void *buf)
@@ -1099,13 +1380,20 @@ static errno_t ata_rcmd_write(disk_t *disk, uint64_t ba, size_t cnt,
 	}
 
 	/* Program block coordinates into the device. */
-	coord_sc_program(ctrl, &bc, 1);
+	coord_sc_program(ctrl, &bc, cnt);
 
-	pio_write_8(&ctrl->cmd->command, disk->amode == am_lba48 ?
-	    CMD_WRITE_SECTORS_EXT : CMD_WRITE_SECTORS);
+	if (disk->dma) {
+		memcpy(ctrl->dma_buf, buf, cnt * disk->block_size);
+		rc = ata_dma_xfer(disk, disk->amode == am_lba48 ?
+		    CMD_WRITE_DMA_EXT : CMD_WRITE_DMA, false,
+		    cnt * disk->block_size);
+	} else {
+		pio_write_8(&ctrl->cmd->command, disk->amode == am_lba48 ?
+		    CMD_WRITE_SECTORS_EXT : CMD_WRITE_SECTORS);
 
-	rc = ata_pio_data_out(disk, buf, cnt * disk->block_size,
-	    disk->block_size, cnt);
+		rc = ata_pio_data_out(disk, buf, cnt * disk->block_size,
+		    disk->block_size, cnt);
+	}
 
 	fibril_mutex_unlock(&ctrl->lock);
 	return rc;
@@ -1151,6 +1439,166 @@ static errno_t ata_rcmd_flush_cache(disk_t *disk)
 	return rc;
 }
 
+/** Set transfer mode.
+ *
+ * @param disk		Disk
+ * @param mode		Transfer mode (see enum ata_xfer_mode)
+ *
+ * @return EOK on success, EIO on error.
+ */
+static errno_t ata_rcmd_set_xfer_mode(disk_t *disk, uint8_t mode)
+{
+	ata_ctrl_t *ctrl = disk->ctrl;
+	uint8_t drv_head;
+	errno_t rc;
+
+	/* New value for Drive/Head register */
+	drv_head =
+	    (disk_dev_idx(disk) != 0) ? DHR_DRV : 0;
+
+	fibril_mutex_lock(&ctrl->lock);
+
+	/* Program a Set Features operation. */
+
+	if (wait_status(ctrl, 0, ~SR_BSY, NULL, TIMEOUT_BSY) != EOK) {
+		fibril_mutex_unlock(&ctrl->lock);
+		return EIO;
+	}
+
+	pio_write_8(&ctrl->cmd->drive_head, drv_head);
+
+	if (wait_status(ctrl, SR_DRDY, ~SR_BSY, NULL, TIMEOUT_DRDY) != EOK) {
+		fibril_mutex_unlock(&ctrl->lock);
+		return EIO;
+	}
+
+	pio_write_8(&ctrl->cmd->features, sf_xfer_mode);
+	pio_write_8(&ctrl->cmd->sector_count, mode);
+	pio_write_8(&ctrl->cmd->command, CMD_SET_FEATURES);
+
+	rc = ata_pio_nondata(disk);
+
+	fibril_mutex_unlock(&ctrl->lock);
+	return rc;
+}
+
+/** Fill in the descriptor table for a transfer from the DMA buffer. */
+static void ata_dma_prdt_setup(ata_ctrl_t *ctrl, size_t size)
+{
+	uintptr_t addr = ctrl->dma_buf_phys;
+	size_t chunk;
+	unsigned i = 0;
+
+	while (size > 0) {
+		chunk = min(size, PRD_BOUNDARY - addr % PRD_BOUNDARY);
+		assert(i < ATA_PRDT_ENTRIES);
+
+		ctrl->prdt[i].base = host2uint32_t_le(addr);
+		ctrl->prdt[i].size = host2uint16_t_le(chunk & 0xffff);
+		ctrl->prdt[i].flags = 0;
+
+		addr += chunk;
+		size -= chunk;
+		++i;
+	}
+
+	ctrl->prdt[i - 1].flags = host2uint16_t_le(PRD_EOT);
+}
+
+/** Bus master DMA data transfer.
+ *
+ * The device registers have been programmed except for the command
+ * register. Issues the command, runs the bus master and waits for the
+ * completion interrupt. Must be called with the controller locked.
+ *
+ * @param disk		Disk
+ * @param cmd		DMA command
+ * @param read		True if transferring from the device to memory
+ * @param size		Number of bytes to transfer using the DMA buffer
+ *
+ * On timeout or bus master error, the channel is reset and DMA is turned
+ * off for the disk, so that the caller can repeat the transfer using PIO.
+ *
+ * @return EOK on success, EIO on device error, EAGAIN if DMA has been
+ *         turned off.
+ */
+static errno_t ata_dma_xfer(disk_t *disk, uint8_t cmd, bool read, size_t size)
+{
+	ata_ctrl_t *ctrl = disk->ctrl;
+	uint8_t bm_cmd = read ? BMC_READ : 0;
+	uint8_t bm_status;
+	errno_t rc;
+
+	assert(size <= ATA_DMA_BUF_SIZE);
+
+	ata_dma_prdt_setup(ctrl, size);
+	write_barrier();
+
+	pio_write_32(&ctrl->bmi->prdt, ctrl->prdt_phys);
+	pio_write_8(&ctrl->bmi->command, bm_cmd);
+	pio_write_8(&ctrl->bmi->status, pio_read_8(&ctrl->bmi->status) |
+	    BMS_IRQ | BMS_ERROR);
+
+	ctrl->irq_fired = false;
+	pio_write_8(&ctrl->cmd->command, cmd);
+	pio_write_8(&ctrl->bmi->command, bm_cmd | BMC_START);
+
+	rc = EOK;
+	while (!ctrl->irq_fired && rc == EOK) {
+		rc = fibril_condvar_wait_timeout(&ctrl->irq_cv, &ctrl->lock,
+		    ATA_DMA_TIMEOUT);
+	}
+
+	/* Stop the bus master, also if the command has timed out */
+	pio_write_8(&ctrl->bmi->command, bm_cmd);
+	bm_status = pio_read_8(&ctrl->bmi->status);
+	pio_write_8(&ctrl->bmi->status, bm_status | BMS_IRQ | BMS_ERROR);
+
+	if (rc != EOK || (bm_status & BMS_ERROR) != 0) {
+		ddf_msg(LVL_WARN, "DMA command %s, falling back to PIO.",
+		    rc != EOK ? "timed out" : "failed");
+
+		/* Abort the command the device may still be executing */
+		(void) ata_chan_reset(ctrl);
+
+		bm_status = pio_read_8(&ctrl->bmi->status) &
+		    ~(BMS_IRQ | BMS_ERROR);
+		bm_status &= (disk_dev_idx(disk) != 0) ? ~BMS_DRV1_DMA :
+		    ~BMS_DRV0_DMA;
+		pio_write_8(&ctrl->bmi->status, bm_status);
+
+		disk->dma = false;
+		return EAGAIN;
+	}
+
+	if ((ctrl->irq_status & (SR_ERR | SR_DWF)) != 0)
+		return EIO;
+
+	read_barrier();
+	return EOK;
+}
+
+/** Soft reset of a channel.
+ *
+ * Resets both devices on the channel, which aborts any command in
+ * progress. Must be called with the controller locked.
+ *
+ * @param ctrl		Controller
+ *
+ * @return EOK on success, EIO if the devices stay busy.
+ */
+static errno_t ata_chan_reset(ata_ctrl_t *ctrl)
+{
+	pio_write_8(&ctrl->ctl->device_control, DCR_SRST);
+	/* SRST must be asserted for at least 5 us */
+	fibril_usleep(10);
+	pio_write_8(&ctrl->ctl->device_control, 0);
+	/* BSY is set within 2 ms after SRST is cleared */
+	fibril_usleep(2000);
+
+	return wait_status(ctrl, 0, ~SR_BSY, NULL, TIMEOUT_DRDY);
+}
+
 /** Calculate block coordinates.
  *
  * Calculates block coordinates in the best coordinate system supported
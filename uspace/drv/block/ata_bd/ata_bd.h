@@ -35,6 +35,8 @@
 #ifndef __ATA_BD_H__
 #define __ATA_BD_H__
 
+#include <abi/cap.h>
+#include <adt/list.h>
 #include <async.h>
 #include <bd_srv.h>
 #include <ddf/driver.h>
@@ -50,8 +52,19 @@
 typedef struct {
 	uintptr_t cmd;	/**< Command block base address. */
 	uintptr_t ctl;	/**< Control block base address. */
+	uintptr_t bmi;	/**< Bus master block base address or 0. */
+	int irq;	/**< Interrupt or -1. */
 } ata_base_t;
 
+/** Maximum number of blocks transferred by one DMA command. */
+#define ATA_DMA_MAX_BLOCKS	256
+/** Size of the DMA buffer of a channel. */
+#define ATA_DMA_BUF_SIZE	(ATA_DMA_MAX_BLOCKS * 512)
+/** Number of entries in the physical region descriptor table. */
+#define ATA_PRDT_ENTRIES	(ATA_DMA_BUF_SIZE / PRD_BOUNDARY + 1)
+/** DMA command timeout in microseconds. */
+#define ATA_DMA_TIMEOUT		(10 * 1000 * 1000)
+
 /** Timeout definitions. Unit is 10 ms. */
 enum ata_timeout {
 	TIMEOUT_PROBE	=  100, /*  1 s */
@@ -121,6 +134,9 @@ typedef struct {
 	uint64_t blocks;
 	size_t block_size;
 
+	/** Transfer data using bus master DMA */
+	bool dma;
+
 	char model[STR_BOUNDS(40) + 1];
 
 	int disk_id;
@@ -130,6 +146,8 @@ typedef struct {
 typedef struct ata_ctrl {
 	/** DDF device */
 	ddf_dev_t *dev;
+	/** Link to the list of channels driven by the driver */
+	link_t chans;
 	/** I/O base address of the command registers */
 	uintptr_t cmd_physical;
 	/** I/O base address of the control registers */
@@ -143,16 +161,49 @@ typedef struct ata_ctrl {
 	/** Per-disk state. */
 	disk_t disk[MAX_DISKS];
 
+	/** Channel number within the device */
+	unsigned chan;
+
+	/** I/O base address of the bus master registers or 0 */
+	uintptr_t bmi_physical;
+	/** Bus master registers */
+	ata_bmi_t *bmi;
+	/** Interrupt number or -1 */
+	int irq;
+	cap_irq_handle_t irq_handle;
+	/** Interrupt handler has been registered */
+	bool irq_registered;
+
+	/** Physical region descriptor table */
+	ata_prd_t *prdt;
+	uintptr_t prdt_phys;
+	/** DMA buffer */
+	void *dma_buf;
+	uintptr_t dma_buf_phys;
+
+	/** Interrupt arrived since the last command was issued */
+	bool irq_fired;
+	/** Device status read by the interrupt handler */
+	uint8_t irq_status;
+	/** Signalled by the interrupt handler */
+	fibril_condvar_t irq_cv;
+
 	fibril_mutex_t lock;
 } ata_ctrl_t;
 
+/** ATA device with one (ISA) or two (PCI IDE) channels */
+typedef struct {
+	size_t channels;
+	ata_ctrl_t ctrl[MAX_CHANNELS];
+} ata_dev_t;
+
 typedef struct ata_fun {
 	ddf_fun_t *fun;
 	disk_t *disk;
 	bd_srvs_t bds;
 } ata_fun_t;
 
-extern errno_t ata_ctrl_init(ata_ctrl_t *, ata_base_t *);
+extern errno_t ata_ctrl_init(ata_ctrl_t *, unsigned, ata_base_t *);
 extern errno_t ata_ctrl_remove(ata_ctrl_t *);
 extern errno_t ata_ctrl_gone(ata_ctrl_t *);
 
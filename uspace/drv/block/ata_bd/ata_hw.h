@@ -47,7 +47,8 @@ enum {
 };
 
 enum {
-	MAX_DISKS	= 2
+	MAX_DISKS	= 2,
+	MAX_CHANNELS	= 2
 };
 
 /** ATA Command Register Block. */
@@ -96,6 +97,45 @@ typedef union {
 	};
 } ata_ctl_t;
 
+/** Bus master IDE registers of one channel. */
+typedef struct {
+	uint8_t command;
+	uint8_t pad0;
+	uint8_t status;
+	uint8_t pad1;
+	uint32_t prdt;
+} ata_bmi_t;
+
+enum bmi_command_bits {
+	BMC_READ	= 0x08, /**< Transfer from the device to memory */
+	BMC_START	= 0x01  /**< Start bus master operation */
+};
+
+enum bmi_status_bits {
+	BMS_SIMPLEX	= 0x80, /**< Only one channel can do DMA at a time */
+	BMS_DRV1_DMA	= 0x40, /**< Device 1 is DMA capable */
+	BMS_DRV0_DMA	= 0x20, /**< Device 0 is DMA capable */
+	BMS_IRQ		= 0x04, /**< Device asserted interrupt */
+	BMS_ERROR	= 0x02, /**< Bus master error */
+	BMS_ACTIVE	= 0x01  /**< Bus master operation in progress */
+};
+
+/** Physical region descriptor. */
+typedef struct {
+	/** Physical address of the region */
+	uint32_t base;
+	/** Size of the region in bytes, 0 means 64 KiB */
+	uint16_t size;
+	uint16_t flags;
+} ata_prd_t;
+
+enum prd_flags {
+	PRD_EOT		= 0x8000 /**< Last descriptor in the table */
+};
+
+/** A region must not cross a 64 KiB boundary. */
+#define PRD_BOUNDARY	0x10000
+
 enum devctl_bits {
 	DCR_SRST	= 0x04, /**< Software Reset */
 	DCR_nIEN	= 0x02  /**< Interrupt Enable (negated) */
@@ -131,12 +171,17 @@ enum error_bits {
 enum ata_command {
 	CMD_READ_SECTORS	= 0x20,
 	CMD_READ_SECTORS_EXT	= 0x24,
+	CMD_READ_DMA_EXT	= 0x25,
 	CMD_WRITE_SECTORS	= 0x30,
 	CMD_WRITE_SECTORS_EXT	= 0x34,
+	CMD_WRITE_DMA_EXT	= 0x35,
 	CMD_PACKET		= 0xA0,
 	CMD_IDENTIFY_PKT_DEV	= 0xA1,
+	CMD_READ_DMA		= 0xC8,
+	CMD_WRITE_DMA		= 0xCA,
 	CMD_IDENTIFY_DRIVE	= 0xEC,
-	CMD_FLUSH_CACHE		= 0xE7
+	CMD_FLUSH_CACHE		= 0xE7,
+	CMD_SET_FEATURES	= 0xEF
 };
 
 /** Data returned from identify device and identify packet device command. */
@@ -236,6 +281,22 @@ enum ata_pktdev_caps {
 	pd_cap_dma		= 0x0100
 };
 
+/** Bits of @c identify_data_t.validity */
+enum ata_validity {
+	val_udma		= 0x0004	/**< Word 88 is valid */
+};
+
+/** Set Features subcommands */
+enum ata_set_features {
+	sf_xfer_mode		= 0x03	/**< Set transfer mode */
+};
+
+/** Transfer mode values for sf_xfer_mode */
+enum ata_xfer_mode {
+	xm_mwdma		= 0x20,	/**< Multiword DMA mode (low 3 bits) */
+	xm_udma			= 0x40	/**< Ultra DMA mode (low 3 bits) */
+};
+
 /** Bits of @c identify_data_t.cmd_set1 */
 enum ata_cs1 {
 	cs1_addr48	= 0x0400	/**< 48-bit address feature set */
@@ -40,6 +40,8 @@
 #include <ddf/driver.h>
 #include <ddf/log.h>
 #include <device/hw_res_parsed.h>
+#include <macros.h>
+#include <stddef.h>
 
 #include "ata_bd.h"
 #include "main.h"
@@ -65,10 +67,97 @@ static driver_t ata_driver = {
 	.driver_ops = &driver_ops
 };
 
-static errno_t ata_get_res(ddf_dev_t *dev, ata_base_t *ata_res)
+/** Serializes adding and removing channels of all devices. */
+static FIBRIL_MUTEX_INITIALIZE(ata_chans_lock);
+/** Channels driven by the driver. */
+static LIST_INITIALIZE(ata_chans);
+
+/** Claim a channel for a device.
+ *
+ * A channel in compatibility mode is reported both by the PCI IDE function
+ * and by the legacy ISA entry of the same ports. The PCI IDE function is
+ * preferred as it can use bus master DMA, so it takes the channel over from
+ * the ISA device if that has been added first.
+ *
+ * @param ctrl	Controller of the channel
+ * @param res	Resources of the channel
+ *
+ * @return True if the channel can be initialized, false if it is
+ *         driven by another device.
+ */
+static bool ata_chan_claim(ata_ctrl_t *ctrl, ata_base_t *res)
+{
+	assert(fibril_mutex_is_locked(&ata_chans_lock));
+
+	list_foreach(ata_chans, chans, ata_ctrl_t, owner) {
+		if (owner->cmd_physical != res->cmd)
+			continue;
+
+		if (res->bmi == 0 || owner->bmi_physical != 0) {
+			ddf_msg(LVL_NOTE, "Channel at %p is driven by another "
+			    "device.", (void *) res->cmd);
+			return false;
+		}
+
+		ddf_msg(LVL_NOTE, "Taking over channel at %p from legacy "
+		    "device.", (void *) res->cmd);
+		if (ata_ctrl_remove(owner) != EOK)
+			return false;
+
+		list_remove(&owner->chans);
+		break;
+	}
+
+	ctrl->cmd_physical = res->cmd;
+	ctrl->bmi_physical = res->bmi;
+	list_append(&ctrl->chans, &ata_chans);
+	return true;
+}
+
+/** Get the command and control block of a channel.
+ *
+ * A control block of a channel in PCI native mode is only four bytes
+ * long, with the alternate status register at offset two.
+ */
+static errno_t ata_get_chan_res(addr_range_t *cmd_rng, addr_range_t *ctl_rng,
+    ata_base_t *ata_res)
+{
+	if (RNGSZ(*cmd_rng) < sizeof(ata_cmd_t))
+		return EINVAL;
+
+	ata_res->cmd = RNGABS(*cmd_rng);
+
+	if (RNGSZ(*ctl_rng) >= sizeof(ata_ctl_t)) {
+		ata_res->ctl = RNGABS(*ctl_rng);
+	} else if (RNGSZ(*ctl_rng) == 4) {
+		ata_res->ctl = RNGABS(*ctl_rng) + 2 -
+		    offsetof(ata_ctl_t, alt_status);
+	} else {
+		return EINVAL;
+	}
+
+	ata_res->bmi = 0;
+	ata_res->irq = -1;
+	return EOK;
+}
+
+/** Get HW resources of the device.
+ *
+ * An ISA device has the command and control block of one channel. A PCI
+ * IDE controller has the command and control blocks of two channels
+ * followed by the bus master block and one interrupt per channel or one
+ * shared by both.
+ *
+ * @param dev		Device
+ * @param ata_res	Array of MAX_CHANNELS entries to fill in
+ * @param channels	Place to store number of channels
+ */
+static errno_t ata_get_res(ddf_dev_t *dev, ata_base_t *ata_res,
+    size_t *channels)
 {
 	async_sess_t *parent_sess;
 	hw_res_list_parsed_t hw_res;
+	size_t i;
 	errno_t rc;
 
 	parent_sess = ddf_dev_parent_sess_get(dev);
@@ -80,26 +169,40 @@ static errno_t ata_get_res(ddf_dev_t *dev, ata_base_t *ata_res)
 	if (rc != EOK)
 		return rc;
 
-	if (hw_res.io_ranges.count != 2) {
+	if (hw_res.io_ranges.count == 2) {
+		*channels = 1;
+	} else if (hw_res.io_ranges.count == 2 * MAX_CHANNELS + 1) {
+		*channels = MAX_CHANNELS;
+	} else {
 		rc = EINVAL;
 		goto error;
 	}
 
-	addr_range_t *cmd_rng = &hw_res.io_ranges.ranges[0];
-	addr_range_t *ctl_rng = &hw_res.io_ranges.ranges[1];
-	ata_res->cmd = RNGABS(*cmd_rng);
-	ata_res->ctl = RNGABS(*ctl_rng);
+	for (i = 0; i < *channels; i++) {
+		rc = ata_get_chan_res(&hw_res.io_ranges.ranges[2 * i],
+		    &hw_res.io_ranges.ranges[2 * i + 1], &ata_res[i]);
+		if (rc != EOK)
+			goto error;
 
-	if (RNGSZ(*ctl_rng) < sizeof(ata_ctl_t)) {
-		rc = EINVAL;
-		goto error;
+		if (hw_res.irqs.count > 0) {
+			ata_res[i].irq = hw_res.irqs.irqs[
+			    min(i, hw_res.irqs.count - 1)];
+		}
 	}
 
-	if (RNGSZ(*cmd_rng) < sizeof(ata_cmd_t)) {
-		rc = EINVAL;
-		goto error;
+	if (*channels == MAX_CHANNELS) {
+		/* Bus master block, eight bytes per channel */
+		addr_range_t *bmi_rng = &hw_res.io_ranges.ranges[4];
+		if (RNGSZ(*bmi_rng) >= MAX_CHANNELS * sizeof(ata_bmi_t) &&
+		    RNGABS(*bmi_rng) != 0) {
+			for (i = 0; i < MAX_CHANNELS; i++) {
+				ata_res[i].bmi = RNGABS(*bmi_rng) +
+				    i * sizeof(ata_bmi_t);
+			}
+		}
 	}
 
+	hw_res_list_parsed_clean(&hw_res);
 	return EOK;
 error:
 	hw_res_list_parsed_clean(&hw_res);
@@ -113,27 +216,47 @@ error:
  */
 static errno_t ata_dev_add(ddf_dev_t *dev)
 {
-	ata_ctrl_t *ctrl;
-	ata_base_t res;
+	ata_dev_t *adev;
+	ata_base_t res[MAX_CHANNELS];
+	size_t channels;
+	size_t i;
+	size_t n_ctrls;
 	errno_t rc;
 
-	rc = ata_get_res(dev, &res);
+	rc = ata_get_res(dev, res, &channels);
 	if (rc != EOK) {
 		ddf_msg(LVL_ERROR, "Invalid HW resource configuration.");
 		return EINVAL;
 	}
 
-	ctrl = ddf_dev_data_alloc(dev, sizeof(ata_ctrl_t));
-	if (ctrl == NULL) {
+	adev = ddf_dev_data_alloc(dev, sizeof(ata_dev_t));
+	if (adev == NULL) {
 		ddf_msg(LVL_ERROR, "Failed allocating soft state.");
 		rc = ENOMEM;
 		goto error;
 	}
 
-	ctrl->dev = dev;
+	adev->channels = channels;
+	n_ctrls = 0;
 
-	rc = ata_ctrl_init(ctrl, &res);
-	if (rc != EOK) {
+	fibril_mutex_lock(&ata_chans_lock);
+
+	for (i = 0; i < channels; i++) {
+		adev->ctrl[i].dev = dev;
+
+		if (!ata_chan_claim(&adev->ctrl[i], &res[i]))
+			continue;
+
+		rc = ata_ctrl_init(&adev->ctrl[i], i, &res[i]);
+		if (rc == EOK)
+			++n_ctrls;
+		else
+			list_remove(&adev->ctrl[i].chans);
+	}
+
+	fibril_mutex_unlock(&ata_chans_lock);
+
+	if (n_ctrls == 0) {
 		ddf_msg(LVL_ERROR, "Failed initializing ATA controller.");
 		rc = EIO;
 		goto error;
@@ -144,11 +267,26 @@ error:
 	return rc;
 }
 
+/** Get function name of a disk.
+ *
+ * Disks of an ISA controller are children of the channel device. The
+ * channels of a PCI IDE controller are not devices of their own so the
+ * channel is part of the function name.
+ */
 static char *ata_fun_name(disk_t *disk)
 {
+	ata_dev_t *adev = (ata_dev_t *) ddf_dev_data_get(disk->ctrl->dev);
 	char *fun_name;
+	int rc;
+
+	if (adev->channels > 1) {
+		rc = asprintf(&fun_name, "ata-c%u-d%u", disk->ctrl->chan + 1,
+		    disk->disk_id % MAX_DISKS);
+	} else {
+		rc = asprintf(&fun_name, "d%u", disk->disk_id);
+	}
 
-	if (asprintf(&fun_name, "d%u", disk->disk_id) < 0)
+	if (rc < 0)
 		return NULL;
 
 	return fun_name;
@@ -191,6 +329,7 @@ errno_t ata_fun_create(disk_t *disk)
 	bd_srvs_init(&afun->bds);
 	afun->bds.ops = &ata_bd_ops;
 	afun->bds.sarg = disk;
+	afun->bds.queue_workers = BD_QUEUE_WORKERS_MAX;
 
 	/* Set up a connection handler. */
 	ddf_fun_set_conn_handler(fun, ata_bd_connection);
@@ -297,20 +436,58 @@ error:
 
 static errno_t ata_dev_remove(ddf_dev_t *dev)
 {
-	ata_ctrl_t *ctrl = (ata_ctrl_t *)ddf_dev_data_get(dev);
+	ata_dev_t *adev = (ata_dev_t *)ddf_dev_data_get(dev);
+	size_t i;
+	errno_t rc;
 
 	ddf_msg(LVL_DEBUG, "ata_dev_remove(%p)", dev);
 
-	return ata_ctrl_remove(ctrl);
+	fibril_mutex_lock(&ata_chans_lock);
+
+	for (i = 0; i < adev->channels; i++) {
+		/* Skip channels driven by another device */
+		if (!link_in_use(&adev->ctrl[i].chans))
+			continue;
+
+		rc = ata_ctrl_remove(&adev->ctrl[i]);
+		if (rc != EOK) {
+			fibril_mutex_unlock(&ata_chans_lock);
+			return rc;
+		}
+
+		list_remove(&adev->ctrl[i].chans);
+	}
+
+	fibril_mutex_unlock(&ata_chans_lock);
+	return EOK;
 }
 
 static errno_t ata_dev_gone(ddf_dev_t *dev)
 {
-	ata_ctrl_t *ctrl = (ata_ctrl_t *)ddf_dev_data_get(dev);
+	ata_dev_t *adev = (ata_dev_t *)ddf_dev_data_get(dev);
+	size_t i;
+	errno_t rc;
 
 	ddf_msg(LVL_DEBUG, "ata_dev_gone(%p)", dev);
 
-	return ata_ctrl_gone(ctrl);
+	fibril_mutex_lock(&ata_chans_lock);
+
+	for (i = 0; i < adev->channels; i++) {
+		/* Skip channels driven by another device */
+		if (!link_in_use(&adev->ctrl[i].chans))
+			continue;
+
+		rc = ata_ctrl_gone(&adev->ctrl[i]);
+		if (rc != EOK) {
+			fibril_mutex_unlock(&ata_chans_lock);
+			return rc;
+		}
+
+		list_remove(&adev->ctrl[i].chans);
+	}
+
+	fibril_mutex_unlock(&ata_chans_lock);
+	return EOK;
 }
 
 static errno_t ata_fun_online(ddf_fun_t *fun)
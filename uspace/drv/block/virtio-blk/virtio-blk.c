@@ -0,0 +1,862 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @file VIRTIO block device driver
+ */
+
+#include "virtio-blk.h"
+
+#include <as.h>
+#include <assert.h>
+#include <ddf/driver.h>
+#include <ddf/interrupt.h>
+#include <ddf/log.h>
+#include <device/hw_res_parsed.h>
+#include <errno.h>
+#include <fibril.h>
+#include <macros.h>
+#include <mem.h>
+#include <stats.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str_error.h>
+
+#include <virtio-pci.h>
+
+#define NAME	"virtio-blk"
+
+#define VIRTIO_BLK_FUN_NAME	"a"
+
+static errno_t virtio_blk_dev_add(ddf_dev_t *dev);
+
+static driver_ops_t virtio_blk_driver_ops = {
+	.dev_add = virtio_blk_dev_add
+};
+
+static driver_t virtio_blk_driver = {
+	.name = NAME,
+	.driver_ops = &virtio_blk_driver_ops
+};
+
+static errno_t virtio_blk_bd_open(bd_srvs_t *, bd_srv_t *);
+static errno_t virtio_blk_bd_close(bd_srv_t *);
+static errno_t virtio_blk_bd_read_blocks(bd_srv_t *, aoff64_t, size_t, void *,
+    size_t);
+static errno_t virtio_blk_bd_write_blocks(bd_srv_t *, aoff64_t, size_t,
+    const void *, size_t);
+static errno_t virtio_blk_bd_sync_cache(bd_srv_t *, aoff64_t, size_t);
+static errno_t virtio_blk_bd_discard_blocks(bd_srv_t *, aoff64_t, size_t);
+static errno_t virtio_blk_bd_get_block_size(bd_srv_t *, size_t *);
+static errno_t virtio_blk_bd_get_num_blocks(bd_srv_t *, aoff64_t *);
+
+static bd_ops_t virtio_blk_bd_ops = {
+	.open = virtio_blk_bd_open,
+	.close = virtio_blk_bd_close,
+	.read_blocks = virtio_blk_bd_read_blocks,
+	.write_blocks = virtio_blk_bd_write_blocks,
+	.sync_cache = virtio_blk_bd_sync_cache,
+	.discard_blocks = virtio_blk_bd_discard_blocks,
+	.get_block_size = virtio_blk_bd_get_block_size,
+	.get_num_blocks = virtio_blk_bd_get_num_blocks
+};
+
+static virtio_blk_t *bd_srv_virtio_blk(bd_srv_t *bd)
+{
+	return (virtio_blk_t *) bd->srvs->sarg;
+}
+
+static void virtio_blk_irq_handler(ipc_call_t *icall, ddf_dev_t *dev)
+{
+	virtio_blk_t *vblk = ddf_dev_data_get(dev);
+	virtio_dev_t *vdev = &vblk->virtio_dev;
+
+	for (unsigned i = 0; i < vblk->nqueues; i++) {
+		virtio_blk_queue_t *q = &vblk->queues[i];
+		bool completed = false;
+		uint16_t descno;
+		uint32_t len;
+
+		fibril_mutex_lock(&q->lock);
+		while (virtio_virtq_consume_used(vdev, q->num, &descno,
+		    &len)) {
+			unsigned slot = vblk->indirect ? descno :
+			    descno / vblk->desc_per_slot;
+			if (slot >= q->slots || !q->busy[slot]) {
+				ddf_msg(LVL_WARN, "Spurious completion of "
+				    "descriptor %u", descno);
+				continue;
+			}
+			q->done[slot] = true;
+			completed = true;
+		}
+		if (completed)
+			fibril_condvar_broadcast(&q->cv);
+		fibril_mutex_unlock(&q->lock);
+	}
+}
+
+/** Pick a request queue.
+ *
+ * Requests are spread over the queues so that the device can work on them
+ * in parallel.
+ */
+static virtio_blk_queue_t *virtio_blk_queue_get(virtio_blk_t *vblk)
+{
+	unsigned i = atomic_fetch_add_explicit(&vblk->next_queue, 1,
+	    memory_order_relaxed);
+	return &vblk->queues[i % vblk->nqueues];
+}
+
+/** Allocate a request slot.
+ *
+ * @return Slot number or -1 if all slots are busy.
+ */
+static int virtio_blk_slot_alloc(virtio_blk_queue_t *q)
+{
+	assert(fibril_mutex_is_locked(&q->lock));
+
+	for (unsigned i = 0; i < q->slots; i++) {
+		if (!q->busy[i]) {
+			q->busy[i] = true;
+			q->done[i] = false;
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void virtio_blk_slot_free(virtio_blk_queue_t *q, unsigned slot)
+{
+	assert(fibril_mutex_is_locked(&q->lock));
+
+	q->busy[slot] = false;
+	fibril_condvar_broadcast(&q->cv);
+}
+
+/** Set one descriptor of a request slot.
+ *
+ * With indirect descriptors the slot's descriptors live in the table at the
+ * beginning of the slot, otherwise they are a fixed part of the virtqueue.
+ */
+static void virtio_blk_desc_set(virtio_blk_t *vblk, virtio_blk_queue_t *q,
+    unsigned slot, unsigned i, uint64_t addr, uint32_t len, uint16_t flags,
+    bool last)
+{
+	if (!last)
+		flags |= VIRTQ_DESC_F_NEXT;
+
+	if (vblk->indirect) {
+		virtq_desc_t *d = &((virtq_desc_t *) q->buf[slot])[i];
+		pio_write_le64(&d->addr, addr);
+		pio_write_le32(&d->len, len);
+		pio_write_le16(&d->flags, flags);
+		pio_write_le16(&d->next, last ? 0 : i + 1);
+	} else {
+		uint16_t descno = slot * vblk->desc_per_slot + i;
+		virtio_virtq_desc_set(&vblk->virtio_dev, q->num, descno, addr,
+		    len, flags, last ? 0 : descno + 1);
+	}
+}
+
+/** Make a request available to the device.
+ *
+ * The device is not notified, this is left to virtio_blk_kick() so that
+ * several requests can share one notification.
+ *
+ * @param vblk     virtio-blk device
+ * @param q        Request queue
+ * @param slot     Slot holding the request
+ * @param type     Request type
+ * @param sector   First sector
+ * @param offset   Offset of the payload in the slot
+ * @param size     Size of the payload
+ * @param data_in  The device writes the payload
+ */
+static void virtio_blk_submit(virtio_blk_t *vblk, virtio_blk_queue_t *q,
+    unsigned slot, uint32_t type, uint64_t sector, size_t offset, size_t size,
+    bool data_in)
+{
+	assert(fibril_mutex_is_locked(&q->lock));
+
+	void *buf = q->buf[slot];
+	uintptr_t buf_p = q->buf_p[slot];
+
+	virtio_blk_req_hdr_t *hdr = buf + VIRTIO_BLK_SLOT_HDR_OFFSET;
+	pio_write_le32(&hdr->type, type);
+	pio_write_le32(&hdr->reserved, 0);
+	pio_write_le64(&hdr->sector, sector);
+	pio_write_8(buf + VIRTIO_BLK_SLOT_STATUS_OFFSET, 0xff);
+
+	unsigned i = 0;
+	virtio_blk_desc_set(vblk, q, slot, i++,
+	    buf_p + VIRTIO_BLK_SLOT_HDR_OFFSET, sizeof(virtio_blk_req_hdr_t),
+	    0, false);
+
+	while (size > 0) {
+		size_t seg = min(size, vblk->seg_size);
+		virtio_blk_desc_set(vblk, q, slot, i++, buf_p + offset, seg,
+		    data_in ? VIRTQ_DESC_F_WRITE : 0, false);
+		offset += seg;
+		size -= seg;
+	}
+
+	virtio_blk_desc_set(vblk, q, slot, i++,
+	    buf_p + VIRTIO_BLK_SLOT_STATUS_OFFSET, 1, VIRTQ_DESC_F_WRITE, true);
+	assert(i <= VIRTIO_BLK_DESC_MAX);
+
+	uint16_t descno;
+	if (vblk->indirect) {
+		virtio_virtq_desc_set(&vblk->virtio_dev, q->num, slot, buf_p,
+		    i * sizeof(virtq_desc_t), VIRTQ_DESC_F_INDIRECT, 0);
+		descno = slot;
+	} else {
+		descno = slot * vblk->desc_per_slot;
+	}
+
+	virtio_virtq_enqueue_available(&vblk->virtio_dev, q->num, descno);
+	q->unkicked++;
+}
+
+/** Notify the device about the requests made available so far.
+ *
+ * Before notifying, other ready fibrils get a chance to add their requests
+ * so that a burst of requests costs one notification.
+ */
+static void virtio_blk_kick(virtio_blk_t *vblk, virtio_blk_queue_t *q)
+{
+	assert(fibril_mutex_is_locked(&q->lock));
+
+	if (q->unkicked == 0 || q->kicking)
+		return;
+
+	q->kicking = true;
+	fibril_mutex_unlock(&q->lock);
+	fibril_yield();
+	fibril_mutex_lock(&q->lock);
+	q->kicking = false;
+
+	if (q->unkicked > 0) {
+		q->unkicked = 0;
+		virtio_virtq_notify(&vblk->virtio_dev, q->num);
+	}
+}
+
+/** Wait for completion of a request and return its status. */
+static errno_t virtio_blk_wait(virtio_blk_t *vblk, virtio_blk_queue_t *q,
+    unsigned slot)
+{
+	assert(fibril_mutex_is_locked(&q->lock));
+
+	virtio_blk_kick(vblk, q);
+	while (!q->done[slot])
+		fibril_condvar_wait(&q->cv, &q->lock);
+
+	switch (pio_read_8(q->buf[slot] + VIRTIO_BLK_SLOT_STATUS_OFFSET)) {
+	case VIRTIO_BLK_S_OK:
+		return EOK;
+	case VIRTIO_BLK_S_UNSUPP:
+		return ENOTSUP;
+	default:
+		return EIO;
+	}
+}
+
+/** Allocate a slot, waiting until one is free. */
+static unsigned virtio_blk_slot_get(virtio_blk_t *vblk, virtio_blk_queue_t *q)
+{
+	int slot;
+
+	while ((slot = virtio_blk_slot_alloc(q)) < 0) {
+		virtio_blk_kick(vblk, q);
+		fibril_condvar_wait(&q->cv, &q->lock);
+	}
+
+	return slot;
+}
+
+/** Read or write blocks.
+ *
+ * The transfer is split into requests of at most xfer_max bytes which are
+ * all outstanding at the device at the same time, as far as free slots
+ * allow.
+ */
+static errno_t virtio_blk_rw(virtio_blk_t *vblk, bool read, aoff64_t ba,
+    size_t cnt, void *buf)
+{
+	virtio_blk_queue_t *q = virtio_blk_queue_get(vblk);
+	size_t maxblocks = vblk->xfer_max / vblk->block_size;
+	uint64_t spb = vblk->block_size / VIRTIO_BLK_SECTOR_SIZE;
+
+	/* Own outstanding requests in submission order */
+	unsigned flight[VIRTIO_BLK_SLOTS];
+	void *dst[VIRTIO_BLK_SLOTS];
+	size_t bytes[VIRTIO_BLK_SLOTS];
+	unsigned first = 0;
+	unsigned nflight = 0;
+	errno_t rc = EOK;
+
+	fibril_mutex_lock(&q->lock);
+
+	while (cnt > 0 || nflight > 0) {
+		if (cnt > 0 && rc == EOK) {
+			int slot = virtio_blk_slot_alloc(q);
+			if (slot < 0 && nflight == 0)
+				slot = virtio_blk_slot_get(vblk, q);
+
+			if (slot >= 0) {
+				size_t n = min(cnt, maxblocks);
+				size_t size = n * vblk->block_size;
+				void *data = q->buf[slot] +
+				    VIRTIO_BLK_SLOT_DATA_OFFSET;
+
+				if (!read)
+					memcpy(data, buf, size);
+
+				virtio_blk_submit(vblk, q, slot,
+				    read ? VIRTIO_BLK_T_IN : VIRTIO_BLK_T_OUT,
+				    ba * spb, VIRTIO_BLK_SLOT_DATA_OFFSET, size,
+				    read);
+
+				unsigned j = (first + nflight) % VIRTIO_BLK_SLOTS;
+				flight[j] = slot;
+				dst[j] = buf;
+				bytes[j] = size;
+				nflight++;
+
+				ba += n;
+				cnt -= n;
+				buf += size;
+				continue;
+			}
+		} else if (cnt > 0) {
+			/* Do not submit the rest after a failure */
+			cnt = 0;
+		}
+
+		/*
+		 * No slot is free or everything has been submitted. Reap the
+		 * oldest own request so that its slot can be reused.
+		 */
+		unsigned slot = flight[first];
+		errno_t src = virtio_blk_wait(vblk, q, slot);
+		if (src == EOK && read) {
+			memcpy(dst[first], q->buf[slot] +
+			    VIRTIO_BLK_SLOT_DATA_OFFSET, bytes[first]);
+		}
+		if (src != EOK && rc == EOK)
+			rc = src;
+
+		virtio_blk_slot_free(q, slot);
+		first = (first + 1) % VIRTIO_BLK_SLOTS;
+		nflight--;
+	}
+
+	fibril_mutex_unlock(&q->lock);
+	return rc;
+}
+
+/** Execute a request without data transfer from or to the caller. */
+static errno_t virtio_blk_cmd(virtio_blk_t *vblk, uint32_t type,
+    uint64_t sector, uint32_t nsectors)
+{
+	virtio_blk_queue_t *q = virtio_blk_queue_get(vblk);
+
+	fibril_mutex_lock(&q->lock);
+
+	unsigned slot = virtio_blk_slot_get(vblk, q);
+
+	if (type == VIRTIO_BLK_T_DISCARD) {
+		virtio_blk_discard_t *range = q->buf[slot] +
+		    VIRTIO_BLK_SLOT_RANGE_OFFSET;
+		pio_write_le64(&range->sector, sector);
+		pio_write_le32(&range->num_sectors, nsectors);
+		pio_write_le32(&range->flags, 0);
+		virtio_blk_submit(vblk, q, slot, type, 0,
+		    VIRTIO_BLK_SLOT_RANGE_OFFSET, sizeof(virtio_blk_discard_t),
+		    false);
+	} else {
+		virtio_blk_submit(vblk, q, slot, type, 0, 0, 0, false);
+	}
+
+	errno_t rc = virtio_blk_wait(vblk, q, slot);
+	virtio_blk_slot_free(q, slot);
+
+	fibril_mutex_unlock(&q->lock);
+	return rc;
+}
+
+static errno_t virtio_blk_bd_open(bd_srvs_t *bds, bd_srv_t *bd)
+{
+	return EOK;
+}
+
+static errno_t virtio_blk_bd_close(bd_srv_t *bd)
+{
+	return EOK;
+}
+
+static errno_t virtio_blk_check_range(virtio_blk_t *vblk, aoff64_t ba,
+    size_t cnt)
+{
+	if (ba > vblk->blocks || cnt > vblk->blocks - ba)
+		return ELIMIT;
+	return EOK;
+}
+
+static errno_t virtio_blk_bd_read_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
+    void *buf, size_t size)
+{
+	virtio_blk_t *vblk = bd_srv_virtio_blk(bd);
+
+	if (size < cnt * vblk->block_size)
+		return EINVAL;
+	if (virtio_blk_check_range(vblk, ba, cnt) != EOK)
+		return ELIMIT;
+
+	return virtio_blk_rw(vblk, true, ba, cnt, buf);
+}
+
+static errno_t virtio_blk_bd_write_blocks(bd_srv_t *bd, aoff64_t ba,
+    size_t cnt, const void *buf, size_t size)
+{
+	virtio_blk_t *vblk = bd_srv_virtio_blk(bd);
+
+	if (vblk->features & VIRTIO_BLK_F_RO)
+		return EROFS;
+	if (size < cnt * vblk->block_size)
+		return EINVAL;
+	if (virtio_blk_check_range(vblk, ba, cnt) != EOK)
+		return ELIMIT;
+
+	return virtio_blk_rw(vblk, false, ba, cnt, (void *) buf);
+}
+
+static errno_t virtio_blk_bd_sync_cache(bd_srv_t *bd, aoff64_t ba, size_t cnt)
+{
+	virtio_blk_t *vblk = bd_srv_virtio_blk(bd);
+
+	/* Without the flush command the device does not cache writes */
+	if (!(vblk->features & VIRTIO_BLK_F_FLUSH))
+		return EOK;
+
+	/* The whole cache is flushed regardless of the range */
+	return virtio_blk_cmd(vblk, VIRTIO_BLK_T_FLUSH, 0, 0);
+}
+
+static errno_t virtio_blk_bd_discard_blocks(bd_srv_t *bd, aoff64_t ba,
+    size_t cnt)
+{
+	virtio_blk_t *vblk = bd_srv_virtio_blk(bd);
+	uint64_t spb = vblk->block_size / VIRTIO_BLK_SECTOR_SIZE;
+
+	if (!(vblk->features & VIRTIO_BLK_F_DISCARD))
+		return ENOTSUP;
+	if (vblk->features & VIRTIO_BLK_F_RO)
+		return EROFS;
+	if (virtio_blk_check_range(vblk, ba, cnt) != EOK)
+		return ELIMIT;
+
+	uint64_t sector = ba * spb;
+	uint64_t nsectors = cnt * spb;
+
+	while (nsectors > 0) {
+		uint32_t n = min(nsectors, vblk->discard_max);
+		errno_t rc = virtio_blk_cmd(vblk, VIRTIO_BLK_T_DISCARD, sector,
+		    n);
+		if (rc != EOK)
+			return rc;
+		sector += n;
+		nsectors -= n;
+	}
+
+	return EOK;
+}
+
+static errno_t virtio_blk_bd_get_block_size(bd_srv_t *bd, size_t *rbsize)
+{
+	*rbsize = bd_srv_virtio_blk(bd)->block_size;
+	return EOK;
+}
+
+static errno_t virtio_blk_bd_get_num_blocks(bd_srv_t *bd, aoff64_t *rnb)
+{
+	*rnb = bd_srv_virtio_blk(bd)->blocks;
+	return EOK;
+}
+
+static errno_t virtio_blk_register_interrupt(ddf_dev_t *dev)
+{
+	virtio_blk_t *vblk = ddf_dev_data_get(dev);
+	virtio_dev_t *vdev = &vblk->virtio_dev;
+
+	hw_res_list_parsed_t res;
+	hw_res_list_parsed_init(&res);
+
+	errno_t rc = hw_res_get_list_parsed(ddf_dev_parent_sess_get(dev), &res,
+	    0);
+	if (rc != EOK)
+		return rc;
+
+	if (res.irqs.count < 1) {
+		hw_res_list_parsed_clean(&res);
+		return EINVAL;
+	}
+
+	vblk->irq = res.irqs.irqs[0];
+	hw_res_list_parsed_clean(&res);
+
+	irq_pio_range_t pio_ranges[] = {
+		{
+			.base = vdev->isr_phys,
+			.size = sizeof(vdev->isr_phys),
+		}
+	};
+
+	irq_cmd_t irq_commands[] = {
+		{
+			.cmd = CMD_PIO_READ_8,
+			.addr = (void *) vdev->isr_phys,
+			.dstarg = 2
+		},
+		{
+			.cmd = CMD_PREDICATE,
+			.value = 1,
+			.srcarg = 2
+		},
+		{
+			.cmd = CMD_ACCEPT
+		}
+	};
+
+	irq_code_t irq_code = {
+		.rangecount = sizeof(pio_ranges) / sizeof(irq_pio_range_t),
+		.ranges = pio_ranges,
+		.cmdcount = sizeof(irq_commands) / sizeof(irq_cmd_t),
+		.cmds = irq_commands
+	};
+
+	return register_interrupt_handler(dev, vblk->irq,
+	    virtio_blk_irq_handler, &irq_code, &vblk->irq_handle);
+}
+
+/** Determine the number of request queues.
+ *
+ * One queue per CPU is used if the device offers that many.
+ */
+static unsigned virtio_blk_queue_count(virtio_blk_t *vblk)
+{
+	virtio_blk_cfg_t *blkcfg = vblk->virtio_dev.device_cfg;
+
+	if (!(vblk->features & VIRTIO_BLK_F_MQ))
+		return 1;
+
+	unsigned offered = pio_read_le16(&blkcfg->num_queues);
+	unsigned common = pio_read_le16(
+	    &vblk->virtio_dev.common_cfg->num_queues);
+	offered = min(offered, common);
+
+	size_t cpus = 1;
+	stats_cpu_t *stats_cpus = stats_get_cpus(&cpus);
+	if (stats_cpus != NULL)
+		free(stats_cpus);
+	else
+		cpus = 1;
+
+	unsigned count = min(offered, min(cpus, VIRTIO_BLK_QUEUES_MAX));
+	return max(count, 1);
+}
+
+/** Read the disk geometry and transfer limits from the device. */
+static errno_t virtio_blk_read_config(virtio_blk_t *vblk)
+{
+	virtio_blk_cfg_t *blkcfg = vblk->virtio_dev.device_cfg;
+
+	vblk->block_size = VIRTIO_BLK_SECTOR_SIZE;
+	if (vblk->features & VIRTIO_BLK_F_BLK_SIZE)
+		vblk->block_size = pio_read_le32(&blkcfg->blk_size);
+	if (vblk->block_size < VIRTIO_BLK_SECTOR_SIZE ||
+	    vblk->block_size > VIRTIO_BLK_XFER_MAX ||
+	    vblk->block_size % VIRTIO_BLK_SECTOR_SIZE != 0) {
+		ddf_msg(LVL_ERROR, "Unsupported block size %zu",
+		    vblk->block_size);
+		return ENOTSUP;
+	}
+
+	uint64_t capacity = pio_read_le64(&blkcfg->capacity);
+	vblk->blocks = capacity / (vblk->block_size / VIRTIO_BLK_SECTOR_SIZE);
+
+	vblk->seg_size = VIRTIO_BLK_XFER_MAX;
+	if (vblk->features & VIRTIO_BLK_F_SIZE_MAX) {
+		uint32_t size_max = pio_read_le32(&blkcfg->size_max);
+		if (size_max > 0)
+			vblk->seg_size = min(vblk->seg_size, size_max);
+	}
+
+	unsigned segs = VIRTIO_BLK_SEGS_MAX;
+	if (vblk->features & VIRTIO_BLK_F_SEG_MAX) {
+		uint32_t seg_max = pio_read_le32(&blkcfg->seg_max);
+		if (seg_max > 0)
+			segs = min(segs, seg_max);
+	}
+
+	vblk->xfer_max = min(VIRTIO_BLK_XFER_MAX, vblk->seg_size * segs);
+	vblk->xfer_max -= vblk->xfer_max % vblk->block_size;
+	if (vblk->xfer_max == 0) {
+		ddf_msg(LVL_ERROR, "Transfer limits smaller than a block");
+		return ENOTSUP;
+	}
+
+	/* Slots hold the whole chain unless indirect tables are used */
+	vblk->desc_per_slot = 2 + (vblk->xfer_max + vblk->seg_size - 1) /
+	    vblk->seg_size;
+
+	if (vblk->features & VIRTIO_BLK_F_DISCARD) {
+		vblk->discard_max = pio_read_le32(&blkcfg->max_discard_sectors);
+		if (vblk->discard_max == 0 ||
+		    pio_read_le32(&blkcfg->max_discard_seg) == 0)
+			vblk->features &= ~VIRTIO_BLK_F_DISCARD;
+	}
+
+	ddf_msg(LVL_NOTE, "%" PRIuOFF64 " blocks of %zu bytes, %zu bytes per "
+	    "request%s%s%s", vblk->blocks, vblk->block_size, vblk->xfer_max,
+	    (vblk->features & VIRTIO_BLK_F_FLUSH) ? ", flush" : "",
+	    (vblk->features & VIRTIO_BLK_F_DISCARD) ? ", discard" : "",
+	    (vblk->features & VIRTIO_BLK_F_RO) ? ", read-only" : "");
+
+	return EOK;
+}
+
+/** Set up the virtqueues and request slots. */
+static errno_t virtio_blk_queues_setup(virtio_blk_t *vblk)
+{
+	virtio_dev_t *vdev = &vblk->virtio_dev;
+	errno_t rc;
+
+	vblk->nqueues = virtio_blk_queue_count(vblk);
+
+	vdev->queues = calloc(vblk->nqueues, sizeof(virtq_t));
+	if (!vdev->queues)
+		return ENOMEM;
+
+	vblk->queues = calloc(vblk->nqueues, sizeof(virtio_blk_queue_t));
+	if (!vblk->queues)
+		return ENOMEM;
+
+	unsigned slots = min(VIRTIO_BLK_SLOTS,
+	    max(VIRTIO_BLK_SLOTS_TOTAL / vblk->nqueues, 4));
+
+	for (unsigned i = 0; i < vblk->nqueues; i++) {
+		virtio_blk_queue_t *q = &vblk->queues[i];
+
+		fibril_mutex_initialize(&q->lock);
+		fibril_condvar_initialize(&q->cv);
+		q->num = i;
+
+		uint16_t size = min(virtio_virtq_max_size(vdev, i),
+		    VIRTIO_BLK_QUEUE_SIZE);
+		unsigned desc = vblk->indirect ? 1 : vblk->desc_per_slot;
+
+		q->slots = min(slots, size / desc);
+		if (q->slots == 0) {
+			ddf_msg(LVL_ERROR, "Virtq %u too small", i);
+			return ENOMEM;
+		}
+
+		rc = virtio_virtq_setup(vdev, i, size);
+		if (rc != EOK)
+			return rc;
+
+		rc = virtio_setup_dma_bufs(q->slots, VIRTIO_BLK_SLOT_SIZE, true,
+		    q->buf, q->buf_p);
+		if (rc != EOK)
+			return rc;
+	}
+
+	ddf_msg(LVL_NOTE, "%u request queues with %u slots, %s descriptors",
+	    vblk->nqueues, vblk->queues[0].slots,
+	    vblk->indirect ? "indirect" : "direct");
+
+	return EOK;
+}
+
+static void virtio_blk_queues_teardown(virtio_blk_t *vblk)
+{
+	if (vblk->queues == NULL)
+		return;
+
+	for (unsigned i = 0; i < vblk->nqueues; i++) {
+		virtio_teardown_dma_bufs(vblk->queues[i].buf);
+		if (vblk->virtio_dev.queues != NULL)
+			virtio_virtq_teardown(&vblk->virtio_dev, i);
+	}
+
+	free(vblk->queues);
+	vblk->queues = NULL;
+}
+
+static errno_t virtio_blk_initialize(ddf_dev_t *dev)
+{
+	virtio_blk_t *vblk = ddf_dev_data_alloc(dev, sizeof(virtio_blk_t));
+	if (!vblk)
+		return ENOMEM;
+
+	errno_t rc = virtio_pci_dev_initialize(dev, &vblk->virtio_dev);
+	if (rc != EOK)
+		return rc;
+
+	virtio_dev_t *vdev = &vblk->virtio_dev;
+
+	/*
+	 * Register IRQ
+	 */
+	rc = virtio_blk_register_interrupt(dev);
+	if (rc != EOK)
+		goto fail;
+
+	/* Reset the device and negotiate the feature bits */
+	rc = virtio_device_setup_negotiate(vdev, 0,
+	    VIRTIO_BLK_F_SIZE_MAX | VIRTIO_BLK_F_SEG_MAX | VIRTIO_BLK_F_RO |
+	    VIRTIO_BLK_F_BLK_SIZE | VIRTIO_BLK_F_FLUSH | VIRTIO_BLK_F_MQ |
+	    VIRTIO_BLK_F_DISCARD | VIRTIO_F_INDIRECT_DESC, &vblk->features);
+	if (rc != EOK)
+		goto fail;
+
+	vblk->indirect = (vblk->features & VIRTIO_F_INDIRECT_DESC) != 0;
+
+	/* Perform device-specific setup */
+	rc = virtio_blk_read_config(vblk);
+	if (rc != EOK)
+		goto fail;
+
+	/*
+	 * Discover and configure the virtqueues
+	 */
+	rc = virtio_blk_queues_setup(vblk);
+	if (rc != EOK)
+		goto fail;
+
+	/*
+	 * Enable IRQ
+	 */
+	rc = hw_res_enable_interrupt(ddf_dev_parent_sess_get(dev), vblk->irq);
+	if (rc != EOK) {
+		ddf_msg(LVL_NOTE, "Failed to enable interrupt");
+		goto fail;
+	}
+
+	ddf_msg(LVL_NOTE, "Registered IRQ %d", vblk->irq);
+
+	/* Go live */
+	virtio_device_setup_finalize(vdev);
+
+	return EOK;
+
+fail:
+	virtio_blk_queues_teardown(vblk);
+	virtio_device_setup_fail(vdev);
+	virtio_pci_dev_cleanup(vdev);
+	return rc;
+}
+
+static void virtio_blk_uninitialize(ddf_dev_t *dev)
+{
+	virtio_blk_t *vblk = ddf_dev_data_get(dev);
+
+	virtio_device_setup_fail(&vblk->virtio_dev);
+	virtio_blk_queues_teardown(vblk);
+	virtio_pci_dev_cleanup(&vblk->virtio_dev);
+}
+
+/** Block device connection handler */
+static void virtio_blk_bd_connection(ipc_call_t *icall, void *arg)
+{
+	ddf_fun_t *fun = (ddf_fun_t *) arg;
+	virtio_blk_t *vblk = ddf_dev_data_get(ddf_fun_get_dev(fun));
+
+	bd_conn(icall, &vblk->bds);
+}
+
+static errno_t virtio_blk_dev_add(ddf_dev_t *dev)
+{
+	ddf_msg(LVL_NOTE, "%s %s (handle = %zu)", __func__,
+	    ddf_dev_get_name(dev), ddf_dev_get_handle(dev));
+
+	errno_t rc = virtio_blk_initialize(dev);
+	if (rc != EOK)
+		return rc;
+
+	virtio_blk_t *vblk = ddf_dev_data_get(dev);
+
+	bd_srvs_init(&vblk->bds);
+	vblk->bds.ops = &virtio_blk_bd_ops;
+	vblk->bds.sarg = vblk;
+	vblk->bds.queue_workers = BD_QUEUE_WORKERS_MAX;
+
+	ddf_fun_t *fun = ddf_fun_create(dev, fun_exposed, VIRTIO_BLK_FUN_NAME);
+	if (fun == NULL) {
+		rc = ENOMEM;
+		goto uninitialize;
+	}
+
+	ddf_fun_set_conn_handler(fun, virtio_blk_bd_connection);
+
+	rc = ddf_fun_bind(fun);
+	if (rc != EOK) {
+		ddf_msg(LVL_ERROR, "Failed binding device function: %s",
+		    str_error(rc));
+		goto destroy;
+	}
+
+	rc = ddf_fun_add_to_category(fun, "disk");
+	if (rc != EOK) {
+		ddf_msg(LVL_ERROR, "Failed adding function to category");
+		goto unbind;
+	}
+
+	vblk->fun = fun;
+
+	ddf_msg(LVL_NOTE, "The %s device has been successfully initialized.",
+	    ddf_dev_get_name(dev));
+
+	return EOK;
+
+unbind:
+	ddf_fun_unbind(fun);
+destroy:
+	ddf_fun_destroy(fun);
+uninitialize:
+	virtio_blk_uninitialize(dev);
+	return rc;
+}
+
+int main(void)
+{
+	printf("%s: HelenOS virtio-blk driver\n", NAME);
+	(void) ddf_log_init(NAME);
+	return ddf_driver_main(&virtio_blk_driver);
+}
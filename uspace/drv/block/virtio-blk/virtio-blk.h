@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @file VIRTIO block device driver definitions
+ */
+
+#ifndef _VIRTIO_BLK_H_
+#define _VIRTIO_BLK_H_
+
+#include <virtio-pci.h>
+#include <abi/cap.h>
+#include <bd_srv.h>
+#include <fibril_synch.h>
+#include <offset.h>
+#include <stdatomic.h>
+
+/** Maximum number of request queues */
+#define VIRTIO_BLK_QUEUES_MAX	16
+/** Number of descriptors requested per virtqueue */
+#define VIRTIO_BLK_QUEUE_SIZE	256
+/** Maximum number of request slots per queue */
+#define VIRTIO_BLK_SLOTS	32
+/** Number of request slots shared by all queues */
+#define VIRTIO_BLK_SLOTS_TOTAL	64
+/** Maximum number of data segments per request */
+#define VIRTIO_BLK_SEGS_MAX	16
+/** Descriptors needed for the header, data segments and status */
+#define VIRTIO_BLK_DESC_MAX	(VIRTIO_BLK_SEGS_MAX + 2)
+
+/*
+ * Each request slot is one DMA buffer holding the indirect descriptor
+ * table, the request header, the discard range and the status byte in the
+ * first page, followed by the data.
+ */
+#define VIRTIO_BLK_SLOT_HDR_OFFSET	512
+#define VIRTIO_BLK_SLOT_RANGE_OFFSET	528
+#define VIRTIO_BLK_SLOT_STATUS_OFFSET	544
+#define VIRTIO_BLK_SLOT_DATA_OFFSET	4096
+/** Maximum data transferred by one request */
+#define VIRTIO_BLK_XFER_MAX		65536
+#define VIRTIO_BLK_SLOT_SIZE	(VIRTIO_BLK_SLOT_DATA_OFFSET + VIRTIO_BLK_XFER_MAX)
+
+/** Maximum size of any single segment is in size_max */
+#define VIRTIO_BLK_F_SIZE_MAX		(1U << 1)
+/** Maximum number of segments in a request is in seg_max */
+#define VIRTIO_BLK_F_SEG_MAX		(1U << 2)
+/** Device is read-only */
+#define VIRTIO_BLK_F_RO			(1U << 5)
+/** Block size of disk is in blk_size */
+#define VIRTIO_BLK_F_BLK_SIZE		(1U << 6)
+/** Cache flush command support */
+#define VIRTIO_BLK_F_FLUSH		(1U << 9)
+/** Device supports multiqueue */
+#define VIRTIO_BLK_F_MQ			(1U << 12)
+/** Device can support discard command */
+#define VIRTIO_BLK_F_DISCARD		(1U << 13)
+
+/** Request types */
+#define VIRTIO_BLK_T_IN		0
+#define VIRTIO_BLK_T_OUT	1
+#define VIRTIO_BLK_T_FLUSH	4
+#define VIRTIO_BLK_T_DISCARD	11
+
+/** Request status */
+#define VIRTIO_BLK_S_OK		0
+#define VIRTIO_BLK_S_IOERR	1
+#define VIRTIO_BLK_S_UNSUPP	2
+
+/** virtio-blk always addresses the disk in 512-byte sectors */
+#define VIRTIO_BLK_SECTOR_SIZE	512
+
+/** Request header */
+typedef struct {
+	ioport32_t type;
+	ioport32_t reserved;
+	ioport64_t sector;
+} virtio_blk_req_hdr_t;
+
+/** Discard range */
+typedef struct {
+	ioport64_t sector;
+	ioport32_t num_sectors;
+	ioport32_t flags;
+} virtio_blk_discard_t;
+
+/** Device configuration layout */
+typedef struct {
+	ioport64_t capacity;
+	ioport32_t size_max;
+	ioport32_t seg_max;
+	struct {
+		ioport16_t cylinders;
+		ioport8_t heads;
+		ioport8_t sectors;
+	} geometry;
+	ioport32_t blk_size;
+	struct {
+		ioport8_t physical_block_exp;
+		ioport8_t alignment_offset;
+		ioport16_t min_io_size;
+		ioport32_t opt_io_size;
+	} topology;
+	ioport8_t writeback;
+	ioport8_t unused0;
+	ioport16_t num_queues;
+	ioport32_t max_discard_sectors;
+	ioport32_t max_discard_seg;
+	ioport32_t discard_sector_alignment;
+} virtio_blk_cfg_t;
+
+/** Request queue, one per virtqueue */
+typedef struct {
+	/** Protects the slots */
+	fibril_mutex_t lock;
+	/** Signalled when a request completes or a slot is freed */
+	fibril_condvar_t cv;
+
+	/** Index of the virtqueue */
+	uint16_t num;
+	/** Number of request slots */
+	unsigned slots;
+	void *buf[VIRTIO_BLK_SLOTS];
+	uintptr_t buf_p[VIRTIO_BLK_SLOTS];
+	bool busy[VIRTIO_BLK_SLOTS];
+	bool done[VIRTIO_BLK_SLOTS];
+
+	/** Requests made available but not yet notified to the device */
+	unsigned unkicked;
+	/** A fibril is about to notify the device */
+	bool kicking;
+} virtio_blk_queue_t;
+
+typedef struct {
+	virtio_dev_t virtio_dev;
+	ddf_fun_t *fun;
+	bd_srvs_t bds;
+
+	/** Accepted feature bits */
+	uint32_t features;
+	/** Use indirect descriptor tables */
+	bool indirect;
+	/** Descriptors occupied by one slot in the virtqueue */
+	unsigned desc_per_slot;
+	/** Maximum size of one data segment */
+	size_t seg_size;
+	/** Maximum data transferred by one request */
+	size_t xfer_max;
+	/** Maximum number of sectors in one discard request */
+	uint32_t discard_max;
+
+	size_t block_size;
+	aoff64_t blocks;
+
+	unsigned nqueues;
+	virtio_blk_queue_t *queues;
+	/** Queue for the next request */
+	atomic_uint next_queue;
+
+	int irq;
+	cap_irq_handle_t irq_handle;
+} virtio_blk_t;
+
+#endif
@@ -688,8 +688,13 @@ errno_t pci_bus_scan(pci_bus_t *bus, int bus_num)
 			}
 
 			pci_alloc_resource_list(fun);
-			pci_read_bars(fun);
-			pci_read_interrupt(fun);
+			if (fun->class_code == PCI_CLASS_STORAGE &&
+			    fun->subclass_code == PCI_SUBCLASS_IDE) {
+				pci_read_ide_resources(fun);
+			} else {
+				pci_read_bars(fun);
+				pci_read_interrupt(fun);
+			}
 
 			/* Propagate the PIO window to the function. */
 			fun->pio_window = bus->pio_win;
@@ -972,6 +977,53 @@ void pci_read_bars(pci_fun_t *fun)
 		addr = pci_read_bar(fun, addr);
 }
 
+/** Legacy resources of the IDE channels in compatibility mode. */
+static const struct {
+	uint64_t cmd;
+	uint64_t ctl;
+	int irq;
+} pci_ide_legacy[] = {
+	{ 0x1f0, 0x3f0, 14 },
+	{ 0x170, 0x370, 15 }
+};
+
+/** Add the resources of an IDE controller to its HW resource list.
+ *
+ * A channel in compatibility mode decodes the legacy ISA ports and uses the
+ * legacy IRQ instead of its BARs and the PCI interrupt line. The resources
+ * are added in a fixed order: command and control block of each channel,
+ * the bus master block, then the interrupt of each channel (a single one if
+ * both channels are in native mode).
+ *
+ * @param fun	PCI function
+ */
+void pci_read_ide_resources(pci_fun_t *fun)
+{
+	bool native_irq = false;
+
+	for (int chan = 0; chan < 2; chan++) {
+		if ((fun->prog_if & (PCI_IDE_PROG_IF_NATIVE << (2 * chan))) != 0) {
+			pci_read_bar(fun, PCI_BASE_ADDR_0 + 8 * chan);
+			pci_read_bar(fun, PCI_BASE_ADDR_0 + 8 * chan + 4);
+		} else {
+			pci_add_range(fun, pci_ide_legacy[chan].cmd, 8, true);
+			pci_add_range(fun, pci_ide_legacy[chan].ctl, 8, true);
+		}
+	}
+
+	pci_read_bar(fun, PCI_BASE_ADDR_4);
+
+	for (int chan = 0; chan < 2; chan++) {
+		if ((fun->prog_if & (PCI_IDE_PROG_IF_NATIVE << (2 * chan))) != 0) {
+			if (!native_irq)
+				pci_read_interrupt(fun);
+			native_irq = true;
+		} else {
+			pci_add_interrupt(fun, pci_ide_legacy[chan].irq);
+		}
+	}
+}
+
 size_t pci_bar_mask_to_size(uint32_t mask)
 {
 	size_t size = mask & ~(mask - 1);
@@ -107,6 +107,13 @@
 #define PCI_COMMAND_FAST_BACK     0x200
 #define PCI_COMMAND_INTX_DISABLE  0x400
 
+/* Class codes */
+#define PCI_CLASS_STORAGE	0x01
+#define PCI_SUBCLASS_IDE	0x01
+
+/* IDE programming interface flags (primary channel, secondary is << 2) */
+#define PCI_IDE_PROG_IF_NATIVE	0x01
+
 #endif
 
 /**
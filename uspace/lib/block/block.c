@@ -58,6 +58,9 @@
 
 #define MAX_WRITE_RETRIES 10
 
+/** Depth of the request queue to the block device. */
+#define BLOCK_QUEUE_DEPTH 16
+
 /** Lock protecting the device connection list */
 static FIBRIL_MUTEX_INITIALIZE(dcl_lock);
 /** Device connection list head. */
@@ -160,6 +163,9 @@ errno_t block_init(service_id_t service_id, size_t comm_size)
 		return rc;
 	}
 
+	/* Without the request queue, requests are sent one by one. */
+	(void) bd_queue_init(bd, BLOCK_QUEUE_DEPTH);
+
 	size_t bsize;
 	rc = bd_get_block_size(bd, &bsize);
 	if (rc != EOK) {
@@ -805,6 +811,24 @@ errno_t block_sync_cache(service_id_t service_id, aoff64_t ba, size_t cnt)
 	return bd_sync_cache(devcon->bd, ba, cnt);
 }
 
+/** Discard blocks.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param ba		Address of first block (physical).
+ * @param cnt		Number of blocks.
+ *
+ * @return		EOK on success or an error code on failure.
+ */
+errno_t block_discard(service_id_t service_id, aoff64_t ba, size_t cnt)
+{
+	devcon_t *devcon;
+
+	devcon = devcon_search(service_id);
+	assert(devcon);
+
+	return bd_discard_blocks(devcon->bd, ba, cnt);
+}
+
 /** Get device block size.
  *
  * @param service_id	Service ID of the block device.
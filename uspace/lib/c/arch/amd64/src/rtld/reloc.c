@@ -44,11 +44,84 @@
 #include <rtld/rtld_debug.h>
 #include <rtld/rtld_arch.h>
 
+extern void rtld_plt_bind(void);
+extern uintptr_t rtld_plt_resolve(module_t *, size_t);
+
 void module_process_pre_arch(module_t *m)
 {
 	/* Unused */
 }
 
+/** Prepare PLT of a module for lazy binding.
+ *
+ * The GOT slots of the PLT initially point back to the PLT entries, which
+ * push the relocation index and jump to PLT0. PLT0 pushes GOT[1] and jumps
+ * to GOT[2]. Set these up so that the first call through each PLT entry
+ * ends up in rtld_plt_bind(), which binds the symbol.
+ *
+ * @param m Module
+ * @return @c true if lazy binding has been set up, @c false if the PLT
+ *         relocations need to be processed eagerly.
+ */
+bool module_plt_lazy_arch(module_t *m)
+{
+	elf_rela_t *rt = m->dyn.jmp_rel;
+	uintptr_t *got = m->dyn.plt_got;
+	size_t rt_entries;
+	size_t i;
+
+	if (got == NULL || m->dyn.plt_rel != DT_RELA)
+		return false;
+
+	rt_entries = m->dyn.plt_rel_sz / sizeof(elf_rela_t);
+	for (i = 0; i < rt_entries; ++i) {
+		if (ELF64_R_TYPE(rt[i].r_info) != R_X86_64_JUMP_SLOT)
+			return false;
+	}
+
+	for (i = 0; i < rt_entries; ++i)
+		*(uintptr_t *)(rt[i].r_offset + m->bias) += m->bias;
+
+	got[1] = (uintptr_t) m;
+	got[2] = (uintptr_t) rtld_plt_bind;
+	return true;
+}
+
+/** Bind a lazily resolved PLT entry.
+ *
+ * Called from rtld_plt_bind() on the first call through a PLT entry.
+ * This can run concurrently in several threads of the program, so it
+ * only reads the module graph and bypasses the symbol cache.
+ *
+ * @param m Module containing the PLT
+ * @param idx Index of the relocation in the PLT relocation table
+ * @return Address of the symbol
+ */
+uintptr_t rtld_plt_resolve(module_t *m, size_t idx)
+{
+	elf_rela_t *rela = &((elf_rela_t *) m->dyn.jmp_rel)[idx];
+	elf_symbol_t *sym;
+	elf_symbol_t *sym_def;
+	module_t *dest;
+	uintptr_t sym_addr;
+
+	sym = &((elf_symbol_t *) m->dyn.sym_tab)[ELF64_R_SYM(rela->r_info)];
+
+	DPRINTF("bind '%s'\n", m->dyn.str_tab + sym->st_name);
+
+	sym_def = symbol_def_find(m->dyn.str_tab + sym->st_name, m,
+	    ssf_nocache, &dest);
+	if (sym_def == NULL) {
+		printf("Definition of '%s' not found.\n",
+		    m->dyn.str_tab + sym->st_name);
+		exit(1);
+	}
+
+	sym_addr = (uintptr_t) symbol_get_addr(sym_def, dest, NULL);
+	*(uintptr_t *)(rela->r_offset + m->bias) = sym_addr;
+	return sym_addr;
+}
+
 /**
  * Process (fixup) all relocations in a relocation table with implicit addends.
  */
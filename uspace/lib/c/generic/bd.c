@@ -34,17 +34,49 @@
  * @brief Block device client interface
  */
 
+#include <abi/ipc/methods.h>
+#include <as.h>
 #include <async.h>
 #include <assert.h>
 #include <bd.h>
 #include <errno.h>
+#include <fibril_synch.h>
 #include <ipc/bd.h>
 #include <ipc/services.h>
 #include <loc.h>
 #include <macros.h>
+#include <mem.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <offset.h>
 
+/** Size of data buffer of each request queue entry. */
+#define BD_QUEUE_SLOT_SIZE  (64 * 1024)
+
+/** Client side of a request queue. */
+typedef struct bd_queue {
+	/** Shared area */
+	bd_queue_shm_t *shm;
+	/** Data area, BD_QUEUE_SLOT_SIZE bytes for each tag */
+	uint8_t *data;
+	/** Number of queue entries (power of two) */
+	unsigned depth;
+	/** Protects the client side of the queues */
+	fibril_mutex_t lock;
+	/** Signalled on completions and freed tags */
+	fibril_condvar_t cv;
+	/** Mask of free tags */
+	uint64_t tags_free;
+	/** Mask of completed tags */
+	uint64_t tags_done;
+	/** Result of each tag */
+	errno_t rc[BD_QUEUE_DEPTH_MAX];
+	/** Caller buffer to copy read data to (NULL for write) */
+	void *dst[BD_QUEUE_DEPTH_MAX];
+	/** Number of bytes transferred for each tag */
+	size_t bytes[BD_QUEUE_DEPTH_MAX];
+} bd_queue_t;
+
 static void bd_cb_conn(ipc_call_t *icall, void *arg);
 
 errno_t bd_open(async_sess_t *sess, bd_t **rbd)
@@ -79,11 +111,250 @@ error:
 void bd_close(bd_t *bd)
 {
 	/* XXX Synchronize with bd_cb_conn */
+	if (bd->queue != NULL) {
+		as_area_destroy(bd->queue->shm);
+		free(bd->queue);
+	}
+
 	free(bd);
 }
 
+/** Set up request queue.
+ *
+ * Once the queue is set up, bd_read_blocks() and bd_write_blocks()
+ * submit requests through memory shared with the server. Requests of
+ * concurrent fibrils, as well as parts of large requests, are then
+ * outstanding at the server at the same time.
+ *
+ * @param bd Block device
+ * @param depth Queue depth (power of two up to BD_QUEUE_DEPTH_MAX)
+ * @return EOK on success or an error code
+ */
+errno_t bd_queue_init(bd_t *bd, size_t depth)
+{
+	if ((depth == 0) || (depth > BD_QUEUE_DEPTH_MAX) ||
+	    ((depth & (depth - 1)) != 0))
+		return EINVAL;
+
+	if (bd->queue != NULL)
+		return EEXIST;
+
+	bd_queue_t *queue = calloc(1, sizeof(bd_queue_t));
+	if (queue == NULL)
+		return ENOMEM;
+
+	size_t size = BD_QUEUE_DATA_OFFSET + depth * BD_QUEUE_SLOT_SIZE;
+	bd_queue_shm_t *shm = as_area_create(AS_AREA_ANY, size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (shm == AS_MAP_FAILED) {
+		free(queue);
+		return ENOMEM;
+	}
+
+	shm->depth = depth;
+	atomic_init(&shm->sq_head, 0);
+	atomic_init(&shm->sq_tail, 0);
+	atomic_init(&shm->cq_head, 0);
+	atomic_init(&shm->cq_tail, 0);
+	atomic_init(&shm->sq_idle, true);
+	atomic_init(&shm->cq_wait, false);
+
+	queue->shm = shm;
+	queue->data = (uint8_t *) shm + BD_QUEUE_DATA_OFFSET;
+	queue->depth = depth;
+	queue->tags_free = (depth == 64) ? UINT64_MAX :
+	    ((uint64_t) 1 << depth) - 1;
+	fibril_mutex_initialize(&queue->lock);
+	fibril_condvar_initialize(&queue->cv);
+
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+	aid_t req = async_send_1(exch, BD_QUEUE_SETUP, depth, NULL);
+	errno_t rc = async_share_out_start(exch, shm,
+	    AS_AREA_READ | AS_AREA_WRITE);
+	async_exchange_end(exch);
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+
+	if (rc == EOK)
+		rc = retval;
+	if (rc != EOK) {
+		as_area_destroy(shm);
+		free(queue);
+		return rc;
+	}
+
+	bd->queue = queue;
+	return EOK;
+}
+
+/** Collect completions.
+ *
+ * Mark completed requests done, then copy data of completed reads
+ * owned by the caller and free their tags.
+ *
+ * @param queue Request queue (locked)
+ * @param mine Mask of tags owned by the caller, updated
+ * @param rc Result of the caller's request, updated on error
+ * @return @c true if any progress was made
+ */
+static bool bd_queue_reap(bd_queue_t *queue, uint64_t *mine, errno_t *rc)
+{
+	bd_queue_shm_t *shm = queue->shm;
+	bool progress = false;
+
+	unsigned head = atomic_load_explicit(&shm->cq_head,
+	    memory_order_relaxed);
+	unsigned tail = atomic_load(&shm->cq_tail);
+
+	while (head != tail) {
+		bd_queue_cqe_t *cqe = &shm->cq[head & (queue->depth - 1)];
+		if (cqe->tag < queue->depth) {
+			queue->rc[cqe->tag] = cqe->rc;
+			queue->tags_done |= (uint64_t) 1 << cqe->tag;
+		}
+
+		head++;
+		progress = true;
+	}
+
+	atomic_store_explicit(&shm->cq_head, head, memory_order_release);
+
+	uint64_t done = *mine & queue->tags_done;
+	for (unsigned tag = 0; done != 0; tag++) {
+		uint64_t bit = (uint64_t) 1 << tag;
+		if ((done & bit) == 0)
+			continue;
+
+		if (queue->rc[tag] != EOK)
+			*rc = queue->rc[tag];
+		else if (queue->dst[tag] != NULL)
+			memcpy(queue->dst[tag],
+			    queue->data + tag * BD_QUEUE_SLOT_SIZE,
+			    queue->bytes[tag]);
+
+		queue->tags_done &= ~bit;
+		queue->tags_free |= bit;
+		*mine &= ~bit;
+		done &= ~bit;
+	}
+
+	if (progress)
+		fibril_condvar_broadcast(&queue->cv);
+
+	return progress;
+}
+
+/** Wait for completions.
+ *
+ * @param queue Request queue (locked)
+ */
+static void bd_queue_wait(bd_queue_t *queue)
+{
+	bd_queue_shm_t *shm = queue->shm;
+
+	atomic_store(&shm->cq_wait, true);
+
+	/* Server might have missed the wait flag. */
+	if (atomic_load(&shm->cq_tail) != atomic_load_explicit(&shm->cq_head,
+	    memory_order_relaxed)) {
+		atomic_store(&shm->cq_wait, false);
+		return;
+	}
+
+	fibril_condvar_wait(&queue->cv, &queue->lock);
+}
+
+/** Read or write blocks through the request queue.
+ *
+ * The request is split into parts that fit the data buffers of queue
+ * entries. All parts are submitted before waiting for any of them.
+ */
+static errno_t bd_queue_rw(bd_t *bd, bd_queue_op_t op, aoff64_t ba,
+    size_t cnt, void *buf, size_t size)
+{
+	bd_queue_t *queue = bd->queue;
+	bd_queue_shm_t *shm = queue->shm;
+	size_t bsize = size / cnt;
+	size_t per_tag = BD_QUEUE_SLOT_SIZE / bsize;
+	uint64_t mine = 0;
+	errno_t rc = EOK;
+
+	fibril_mutex_lock(&queue->lock);
+
+	size_t cur = 0;
+	while ((cur < cnt) && (rc == EOK)) {
+		if (queue->tags_free == 0) {
+			/* Also collect our own completions to make room. */
+			if (!bd_queue_reap(queue, &mine, &rc))
+				bd_queue_wait(queue);
+			continue;
+		}
+
+		unsigned tag = 0;
+		while ((queue->tags_free & ((uint64_t) 1 << tag)) == 0)
+			tag++;
+
+		size_t n = min(cnt - cur, per_tag);
+		uint8_t *data = (uint8_t *) buf + cur * bsize;
+
+		queue->bytes[tag] = n * bsize;
+		if (op == BD_QOP_WRITE) {
+			memcpy(queue->data + tag * BD_QUEUE_SLOT_SIZE, data,
+			    n * bsize);
+			queue->dst[tag] = NULL;
+		} else {
+			queue->dst[tag] = data;
+		}
+
+		queue->tags_free &= ~((uint64_t) 1 << tag);
+		mine |= (uint64_t) 1 << tag;
+
+		unsigned tail = atomic_load_explicit(&shm->sq_tail,
+		    memory_order_relaxed);
+		bd_queue_sqe_t *sqe = &shm->sq[tail & (queue->depth - 1)];
+		sqe->ba = ba + cur;
+		sqe->offset = tag * BD_QUEUE_SLOT_SIZE;
+		sqe->size = n * bsize;
+		sqe->cnt = n;
+		sqe->op = op;
+		sqe->tag = tag;
+		atomic_store(&shm->sq_tail, tail + 1);
+
+		if (atomic_exchange(&shm->sq_idle, false)) {
+			async_exch_t *exch = async_exchange_begin(bd->sess);
+			async_msg_0(exch, BD_QUEUE_KICK);
+			async_exchange_end(exch);
+		}
+
+		cur += n;
+	}
+
+	/* Wait for all submitted parts. */
+	while (mine != 0) {
+		if (!bd_queue_reap(queue, &mine, &rc))
+			bd_queue_wait(queue);
+	}
+
+	fibril_mutex_unlock(&queue->lock);
+	return rc;
+}
+
+/** Determine whether a request can go through the request queue. */
+static bool bd_queue_usable(bd_t *bd, size_t cnt, size_t size)
+{
+	if ((bd->queue == NULL) || (cnt == 0) || (size % cnt != 0))
+		return false;
+
+	size_t bsize = size / cnt;
+	return (bsize > 0) && (bsize <= BD_QUEUE_SLOT_SIZE);
+}
+
 errno_t bd_read_blocks(bd_t *bd, aoff64_t ba, size_t cnt, void *data, size_t size)
 {
+	if (bd_queue_usable(bd, cnt, size))
+		return bd_queue_rw(bd, BD_QOP_READ, ba, cnt, data, size);
+
 	async_exch_t *exch = async_exchange_begin(bd->sess);
 
 	ipc_call_t answer;
@@ -132,6 +403,10 @@ errno_t bd_read_toc(bd_t *bd, uint8_t session, void *buf, size_t size)
 errno_t bd_write_blocks(bd_t *bd, aoff64_t ba, size_t cnt, const void *data,
     size_t size)
 {
+	if (bd_queue_usable(bd, cnt, size))
+		return bd_queue_rw(bd, BD_QOP_WRITE, ba, cnt, (void *) data,
+		    size);
+
 	async_exch_t *exch = async_exchange_begin(bd->sess);
 
 	ipc_call_t answer;
@@ -164,6 +439,29 @@ errno_t bd_sync_cache(bd_t *bd, aoff64_t ba, size_t cnt)
 	return rc;
 }
 
+/** Discard blocks.
+ *
+ * Tell the device that the contents of the blocks are no longer needed.
+ * Reading discarded blocks afterwards returns unspecified data.
+ *
+ * @param bd  Block device
+ * @param ba  First block
+ * @param cnt Number of blocks
+ *
+ * @return EOK on success, ENOTSUP if the device cannot discard blocks,
+ *         or an error code
+ */
+errno_t bd_discard_blocks(bd_t *bd, aoff64_t ba, size_t cnt)
+{
+	async_exch_t *exch = async_exchange_begin(bd->sess);
+
+	errno_t rc = async_req_3_0(exch, BD_DISCARD_BLOCKS, LOWER32(ba),
+	    UPPER32(ba), cnt);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
 errno_t bd_get_block_size(bd_t *bd, size_t *rbsize)
 {
 	sysarg_t bsize;
@@ -199,8 +497,6 @@ static void bd_cb_conn(ipc_call_t *icall, void *arg)
 {
 	bd_t *bd = (bd_t *)arg;
 
-	(void)bd;
-
 	while (true) {
 		ipc_call_t call;
 		async_get_call(&call);
@@ -211,6 +507,14 @@ static void bd_cb_conn(ipc_call_t *icall, void *arg)
 		}
 
 		switch (IPC_GET_IMETHOD(call)) {
+		case BD_CB_QUEUE_COMPLETE:
+			if (bd->queue != NULL) {
+				fibril_mutex_lock(&bd->queue->lock);
+				fibril_condvar_broadcast(&bd->queue->cv);
+				fibril_mutex_unlock(&bd->queue->lock);
+			}
+			async_answer_0(&call, EOK);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 		}
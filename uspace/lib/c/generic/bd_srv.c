@@ -33,15 +33,46 @@
  * @file
  * @brief Block device server stub
  */
+#include <abi/ipc/methods.h>
+#include <as.h>
+#include <assert.h>
 #include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
 #include <ipc/bd.h>
 #include <macros.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #include <bd_srv.h>
 
+/** Server side of a request queue. */
+typedef struct bd_srv_queue {
+	bd_srv_t *srv;
+	/** Shared area */
+	bd_queue_shm_t *shm;
+	/** Data area */
+	uint8_t *data;
+	/** Size of data area */
+	size_t data_size;
+	/** Number of queue entries (power of two) */
+	unsigned depth;
+	/** Protects the server side of the queues */
+	fibril_mutex_t lock;
+	/** Signalled when there may be new submissions */
+	fibril_condvar_t sq_cv;
+	/** Signalled when a worker exits */
+	fibril_condvar_t worker_cv;
+	/** Number of running workers */
+	unsigned workers;
+	/** Workers should exit */
+	bool quit;
+} bd_srv_queue_t;
+
+static_assert(sizeof(bd_queue_shm_t) <= BD_QUEUE_DATA_OFFSET);
+
 static void bd_read_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
 {
 	aoff64_t ba;
@@ -148,6 +179,24 @@ static void bd_sync_cache_srv(bd_srv_t *srv, ipc_call_t *call)
 	async_answer_0(call, rc);
 }
 
+static void bd_discard_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	aoff64_t ba;
+	size_t cnt;
+	errno_t rc;
+
+	ba = MERGE_LOUP32(IPC_GET_ARG1(*call), IPC_GET_ARG2(*call));
+	cnt = IPC_GET_ARG3(*call);
+
+	if (srv->srvs->ops->discard_blocks == NULL) {
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	rc = srv->srvs->ops->discard_blocks(srv, ba, cnt);
+	async_answer_0(call, rc);
+}
+
 static void bd_write_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
 {
 	aoff64_t ba;
@@ -203,6 +252,225 @@ static void bd_get_num_blocks_srv(bd_srv_t *srv, ipc_call_t *call)
 	async_answer_2(call, rc, LOWER32(num_blocks), UPPER32(num_blocks));
 }
 
+/** Execute queued request.
+ *
+ * The data go directly from/to the area shared with the client.
+ */
+static errno_t bd_srv_queue_exec(bd_srv_queue_t *queue,
+    const bd_queue_sqe_t *sqe)
+{
+	bd_srv_t *srv = queue->srv;
+	bd_ops_t *ops = srv->srvs->ops;
+
+	if (sqe->op == BD_QOP_SYNC) {
+		if (ops->sync_cache == NULL)
+			return ENOTSUP;
+		return ops->sync_cache(srv, sqe->ba, sqe->cnt);
+	}
+
+	if ((sqe->offset > queue->data_size) ||
+	    (sqe->size > queue->data_size - sqe->offset))
+		return EINVAL;
+
+	void *buf = queue->data + sqe->offset;
+
+	switch (sqe->op) {
+	case BD_QOP_READ:
+		if (ops->read_blocks == NULL)
+			return ENOTSUP;
+		return ops->read_blocks(srv, sqe->ba, sqe->cnt, buf, sqe->size);
+	case BD_QOP_WRITE:
+		if (ops->write_blocks == NULL)
+			return ENOTSUP;
+		return ops->write_blocks(srv, sqe->ba, sqe->cnt, buf, sqe->size);
+	default:
+		return EINVAL;
+	}
+}
+
+/** Request queue worker.
+ *
+ * Several workers serve one queue so that several requests can be
+ * outstanding at the device at the same time.
+ */
+static errno_t bd_srv_queue_worker(void *arg)
+{
+	bd_srv_queue_t *queue = (bd_srv_queue_t *) arg;
+	bd_queue_shm_t *shm = queue->shm;
+	unsigned mask = queue->depth - 1;
+
+	fibril_mutex_lock(&queue->lock);
+
+	while (!queue->quit) {
+		unsigned head = atomic_load_explicit(&shm->sq_head,
+		    memory_order_relaxed);
+		unsigned tail = atomic_load(&shm->sq_tail);
+
+		if (tail - head > queue->depth) {
+			/* Client messed up the queue, drop it. */
+			atomic_store(&shm->sq_head, tail);
+			continue;
+		}
+
+		if (head == tail) {
+			atomic_store(&shm->sq_idle, true);
+
+			/* Client might have missed the idle flag. */
+			if (atomic_load(&shm->sq_tail) == head) {
+				fibril_condvar_wait(&queue->sq_cv,
+				    &queue->lock);
+			} else {
+				(void) atomic_exchange(&shm->sq_idle, false);
+			}
+			continue;
+		}
+
+		bd_queue_sqe_t sqe = shm->sq[head & mask];
+		atomic_store_explicit(&shm->sq_head, head + 1,
+		    memory_order_release);
+
+		/* Let another worker pick up the rest. */
+		if (head + 1 != tail)
+			fibril_condvar_signal(&queue->sq_cv);
+
+		fibril_mutex_unlock(&queue->lock);
+		errno_t rc = bd_srv_queue_exec(queue, &sqe);
+		fibril_mutex_lock(&queue->lock);
+
+		unsigned ctail = atomic_load_explicit(&shm->cq_tail,
+		    memory_order_relaxed);
+		shm->cq[ctail & mask].tag = sqe.tag;
+		shm->cq[ctail & mask].rc = rc;
+		atomic_store(&shm->cq_tail, ctail + 1);
+
+		if (atomic_exchange(&shm->cq_wait, false)) {
+			async_exch_t *exch =
+			    async_exchange_begin(queue->srv->client_sess);
+			async_msg_0(exch, BD_CB_QUEUE_COMPLETE);
+			async_exchange_end(exch);
+		}
+	}
+
+	queue->workers--;
+	fibril_condvar_broadcast(&queue->worker_cv);
+	fibril_mutex_unlock(&queue->lock);
+
+	return EOK;
+}
+
+static void bd_queue_setup_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	unsigned depth = IPC_GET_ARG1(*call);
+	ipc_call_t scall;
+	size_t size;
+	unsigned int flags;
+
+	if (!async_share_out_receive(&scall, &size, &flags)) {
+		async_answer_0(&scall, EINVAL);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	if ((srv->queue != NULL) || (depth == 0) ||
+	    (depth > BD_QUEUE_DEPTH_MAX) || ((depth & (depth - 1)) != 0) ||
+	    (size <= BD_QUEUE_DATA_OFFSET) ||
+	    ((flags & (AS_AREA_READ | AS_AREA_WRITE)) !=
+	    (AS_AREA_READ | AS_AREA_WRITE))) {
+		async_answer_0(&scall, EINVAL);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	bd_srv_queue_t *queue = calloc(1, sizeof(bd_srv_queue_t));
+	if (queue == NULL) {
+		async_answer_0(&scall, ENOMEM);
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	errno_t rc = async_share_out_finalize(&scall, (void **) &queue->shm);
+	if (rc != EOK) {
+		free(queue);
+		async_answer_0(call, rc);
+		return;
+	}
+
+	if (queue->shm->depth != depth) {
+		as_area_destroy(queue->shm);
+		free(queue);
+		async_answer_0(call, EINVAL);
+		return;
+	}
+
+	queue->srv = srv;
+	queue->data = (uint8_t *) queue->shm + BD_QUEUE_DATA_OFFSET;
+	queue->data_size = size - BD_QUEUE_DATA_OFFSET;
+	queue->depth = depth;
+	fibril_mutex_initialize(&queue->lock);
+	fibril_condvar_initialize(&queue->sq_cv);
+	fibril_condvar_initialize(&queue->worker_cv);
+
+	size_t nworkers = min(min((size_t) depth, srv->srvs->queue_workers),
+	    (size_t) BD_QUEUE_WORKERS_MAX);
+	if (nworkers == 0)
+		nworkers = 1;
+
+	for (size_t i = 0; i < nworkers; i++) {
+		fid_t fid = fibril_create(bd_srv_queue_worker, queue);
+		if (fid == 0)
+			break;
+
+		queue->workers++;
+		fibril_add_ready(fid);
+	}
+
+	if (queue->workers == 0) {
+		as_area_destroy(queue->shm);
+		free(queue);
+		async_answer_0(call, ENOMEM);
+		return;
+	}
+
+	srv->queue = queue;
+	async_answer_0(call, EOK);
+}
+
+static void bd_queue_kick_srv(bd_srv_t *srv, ipc_call_t *call)
+{
+	bd_srv_queue_t *queue = srv->queue;
+
+	if (queue == NULL) {
+		async_answer_0(call, ENOENT);
+		return;
+	}
+
+	fibril_mutex_lock(&queue->lock);
+	fibril_condvar_broadcast(&queue->sq_cv);
+	fibril_mutex_unlock(&queue->lock);
+
+	async_answer_0(call, EOK);
+}
+
+/** Stop queue workers and release the queue. */
+static void bd_queue_destroy_srv(bd_srv_t *srv)
+{
+	bd_srv_queue_t *queue = srv->queue;
+
+	fibril_mutex_lock(&queue->lock);
+
+	queue->quit = true;
+	fibril_condvar_broadcast(&queue->sq_cv);
+
+	while (queue->workers > 0)
+		fibril_condvar_wait(&queue->worker_cv, &queue->lock);
+
+	fibril_mutex_unlock(&queue->lock);
+
+	as_area_destroy(queue->shm);
+	free(queue);
+	srv->queue = NULL;
+}
+
 static bd_srv_t *bd_srv_create(bd_srvs_t *srvs)
 {
 	bd_srv_t *srv;
@@ -219,6 +487,7 @@ void bd_srvs_init(bd_srvs_t *srvs)
 {
 	srvs->ops = NULL;
 	srvs->sarg = NULL;
+	srvs->queue_workers = 1;
 }
 
 errno_t bd_conn(ipc_call_t *icall, bd_srvs_t *srvs)
@@ -273,11 +542,23 @@ errno_t bd_conn(ipc_call_t *icall, bd_srvs_t *srvs)
 		case BD_GET_NUM_BLOCKS:
 			bd_get_num_blocks_srv(srv, &call);
 			break;
+		case BD_QUEUE_SETUP:
+			bd_queue_setup_srv(srv, &call);
+			break;
+		case BD_QUEUE_KICK:
+			bd_queue_kick_srv(srv, &call);
+			break;
+		case BD_DISCARD_BLOCKS:
+			bd_discard_blocks_srv(srv, &call);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 		}
 	}
 
+	if (srv->queue != NULL)
+		bd_queue_destroy_srv(srv);
+
 	rc = srvs->ops->close(srv);
 	free(srv);
 
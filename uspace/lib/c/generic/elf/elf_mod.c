@@ -58,6 +58,8 @@
 #include <str_error.h>
 #include <stdlib.h>
 #include <macros.h>
+#include <async.h>
+#include <ns.h>
 
 #include <elf/elf_load.h>
 
@@ -108,6 +110,7 @@ int elf_load_file(int file, eld_flags_t flags, elf_finfo_t *info)
 	elf.fd = ofile;
 	elf.info = info;
 	elf.flags = flags;
+	elf.pager_handle = 0;
 
 	int ret = elf_load_module(&elf);
 
@@ -394,7 +397,66 @@ static int segment_header(elf_ld_t *elf, elf_segment_header_t *entry)
 	return EE_OK;
 }
 
+/** Get session to the VFS pager.
+ *
+ * @return Session or NULL if the pager is not available.
+ */
+static async_sess_t *elf_pager_sess(void)
+{
+	static async_sess_t *pager_sess = NULL;
+
+	if (pager_sess == NULL)
+		pager_sess = service_connect(SERVICE_VFS, INTERFACE_PAGER, 0);
+
+	return pager_sess;
+}
+
+/** Map part of a segment directly from the file.
+ *
+ * The pages are provided by the VFS pager on demand. Read-only pages are
+ * shared by all tasks mapping the same file; writable pages are private
+ * copies made by the kernel on the first write.
+ *
+ * @param elf    Loader state.
+ * @param vaddr  Page-aligned virtual address.
+ * @param offset Page-aligned offset within the file.
+ * @param size   Size of the mapping (multiple of page size).
+ * @param flags  Flags of the memory area.
+ *
+ * @return EE_OK on success, error code otherwise.
+ */
+static int map_file_pages(elf_ld_t *elf, uintptr_t vaddr, aoff64_t offset,
+    size_t size, int flags)
+{
+	async_sess_t *pager = elf_pager_sess();
+	if (pager == NULL)
+		return EE_MEMORY;
+
+	/*
+	 * The pager handle keeps the file referenced in VFS even after the
+	 * file handle is put.
+	 */
+	if (elf->pager_handle == 0 &&
+	    vfs_pager_handle(elf->fd, &elf->pager_handle) != EOK)
+		return EE_IO;
+
+	void *a = async_as_area_create((void *) vaddr, size, flags, pager,
+	    elf->pager_handle, offset, 0);
+	if (a == AS_MAP_FAILED) {
+		DPRINTF("pager mapping failed (%p, %zu)\n", (void *) vaddr,
+		    size);
+		return EE_MEMORY;
+	}
+
+	return EE_OK;
+}
+
 /** Load segment described by program header entry.
+ *
+ * Unless the caller wants to modify the segments (ELDF_RW), the part of
+ * the segment which is backed by whole pages of the file is mapped through
+ * the VFS pager. Only the rest (the page straddling the end of the file
+ * image and .bss) is anonymous memory read in by the loader.
  *
  * @param elf	Loader state.
  * @param entry Program header entry describing segment to be loaded.
@@ -410,6 +472,7 @@ int load_segment(elf_ld_t *elf, elf_segment_header_t *entry)
 	void *seg_ptr;
 	uintptr_t seg_addr;
 	size_t mem_sz;
+	size_t paged_sz;
 	aoff64_t pos;
 	errno_t rc;
 	size_t nr;
@@ -450,30 +513,73 @@ int load_segment(elf_ld_t *elf, elf_segment_header_t *entry)
 	    (void *) (entry->p_vaddr + bias +
 	    ALIGN_UP(entry->p_memsz, PAGE_SIZE)));
 
+	/*
+	 * Determine how much of the segment can be paged in directly from
+	 * the file. A read-only segment without .bss can be mapped including
+	 * its last partial page, a page that is to be partially zeroed must
+	 * be anonymous.
+	 */
+	paged_sz = 0;
+	if ((elf->flags & ELDF_RW) == 0 && entry->p_filesz > 0 &&
+	    (entry->p_offset % PAGE_SIZE) == (entry->p_vaddr % PAGE_SIZE)) {
+		if ((entry->p_flags & PF_W) == 0 &&
+		    entry->p_filesz == entry->p_memsz) {
+			paged_sz = ALIGN_UP(mem_sz, PAGE_SIZE);
+		} else {
+			paged_sz = ALIGN_DOWN(entry->p_filesz +
+			    (entry->p_vaddr - base), PAGE_SIZE);
+		}
+	}
+
+	if (paged_sz > 0) {
+		if (map_file_pages(elf, base + bias, entry->p_offset -
+		    (entry->p_vaddr - base), paged_sz, flags) != EE_OK) {
+			/* Fall back to reading the whole segment. */
+			paged_sz = 0;
+		}
+	}
+
+	if (paged_sz >= mem_sz)
+		return EE_OK;
+
 	/*
 	 * For the course of loading, the area needs to be readable
 	 * and writeable.
 	 */
-	a = as_area_create((uint8_t *) base + bias, mem_sz,
-	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+	a = as_area_create((uint8_t *) base + bias + paged_sz,
+	    mem_sz - paged_sz, AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
 	    AS_AREA_UNPAGED);
 	if (a == AS_MAP_FAILED) {
 		DPRINTF("memory mapping failed (%p, %zu)\n",
-		    (void *) (base + bias), mem_sz);
+		    (void *) (base + bias + paged_sz), mem_sz - paged_sz);
 		return EE_MEMORY;
 	}
 
 	DPRINTF("as_area_create(%p, %#zx, %d) -> %p\n",
-	    (void *) (base + bias), mem_sz, flags, (void *) a);
+	    (void *) (base + bias + paged_sz), mem_sz - paged_sz, flags,
+	    (void *) a);
 
 	/*
-	 * Load segment data
+	 * Load segment data not covered by the paged mapping
 	 */
-	pos = entry->p_offset;
-	rc = vfs_read(elf->fd, &pos, seg_ptr, entry->p_filesz, &nr);
-	if (rc != EOK || nr != entry->p_filesz) {
-		DPRINTF("read error\n");
-		return EE_IO;
+	if (paged_sz > 0) {
+		size_t skip = base + paged_sz - entry->p_vaddr;
+
+		seg_ptr = (void *) (seg_addr + skip);
+		pos = entry->p_offset + skip;
+		rc = vfs_read(elf->fd, &pos, seg_ptr, entry->p_filesz - skip,
+		    &nr);
+		if (rc != EOK || nr != entry->p_filesz - skip) {
+			DPRINTF("read error\n");
+			return EE_IO;
+		}
+	} else {
+		pos = entry->p_offset;
+		rc = vfs_read(elf->fd, &pos, seg_ptr, entry->p_filesz, &nr);
+		if (rc != EOK || nr != entry->p_filesz) {
+			DPRINTF("read error\n");
+			return EE_IO;
+		}
 	}
 
 	/*
@@ -483,7 +589,7 @@ int load_segment(elf_ld_t *elf, elf_segment_header_t *entry)
 	if ((elf->flags & ELDF_RW) != 0)
 		return EE_OK;
 
-	rc = as_area_change_flags(seg_ptr, flags);
+	rc = as_area_change_flags(a, flags);
 	if (rc != EOK) {
 		DPRINTF("Failed to set memory area flags.\n");
 		return EE_MEMORY;
@@ -491,7 +597,7 @@ int load_segment(elf_ld_t *elf, elf_segment_header_t *entry)
 
 	if (flags & AS_AREA_EXEC) {
 		/* Enforce SMC coherence for the segment */
-		if (smc_coherence(seg_ptr, entry->p_filesz))
+		if (smc_coherence(a, mem_sz - paged_sz))
 			return EE_MEMORY;
 	}
 
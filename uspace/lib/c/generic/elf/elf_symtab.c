@@ -26,7 +26,7 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-/** @addtogroup debug
+/** @addtogroup libc
  * @{
  */
 /** @file Handling of ELF symbol tables.
@@ -43,8 +43,7 @@
 #include <str.h>
 #include <str_error.h>
 #include <vfs/vfs.h>
-
-#include "include/symtab.h"
+#include <elf/elf_symtab.h>
 
 static errno_t elf_hdr_check(elf_header_t *hdr);
 static errno_t section_hdr_load(int fd, const elf_header_t *ehdr, int idx,
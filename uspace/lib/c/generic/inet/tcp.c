@@ -38,7 +38,9 @@
 #include <inet/tcp.h>
 #include <ipc/services.h>
 #include <ipc/tcp.h>
+#include <macros.h>
 #include <stdlib.h>
+#include <vfs/vfs.h>
 
 static void tcp_cb_conn(ipc_call_t *, void *);
 static errno_t tcp_conn_fibril(void *);
@@ -472,6 +474,51 @@ errno_t tcp_conn_send(tcp_conn_t *conn, const void *data, size_t bytes)
 	return rc;
 }
 
+/** Send file contents over TCP connection.
+ *
+ * The file handle is passed to the TCP service which reads the data
+ * from the file system directly, so the data does not need to be
+ * copied through the address space of the caller.
+ *
+ * @param conn  Connection
+ * @param file  File handle
+ * @param pos   Position in file to start at
+ * @param bytes Number of bytes to send
+ * @param nsent Place to store number of bytes actually sent (less than
+ *              @a bytes if the end of file was reached)
+ *
+ * @return EOK on success or an error code
+ */
+errno_t tcp_conn_send_file(tcp_conn_t *conn, int file, aoff64_t pos,
+    size_t bytes, size_t *nsent)
+{
+	async_exch_t *exch;
+	ipc_call_t answer;
+	errno_t rc;
+
+	exch = async_exchange_begin(conn->tcp->sess);
+	aid_t req = async_send_4(exch, TCP_CONN_SEND_FILE, conn->id,
+	    LOWER32(pos), UPPER32(pos), bytes, &answer);
+
+	async_exch_t *vfs_exch = vfs_exchange_begin();
+	rc = vfs_pass_handle(vfs_exch, file, exch);
+	vfs_exchange_end(vfs_exch);
+
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	async_wait_for(req, &rc);
+	if (rc != EOK)
+		return rc;
+
+	*nsent = IPC_GET_ARG1(answer);
+	return EOK;
+}
+
 /** Send FIN.
  *
  * Send FIN, indicating no more data will be send over the connection.
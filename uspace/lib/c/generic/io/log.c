@@ -31,10 +31,14 @@
  * @{
  */
 
+#include <align.h>
+#include <as.h>
 #include <assert.h>
 #include <errno.h>
 #include <fibril_synch.h>
+#include <mem.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <async.h>
@@ -63,9 +67,156 @@ static const char *log_level_names[] = {
 /** IPC session with the logger service. */
 static async_sess_t *logger_session;
 
+/** Memory area shared with the logger service (NULL if not available). */
+static logger_shm_t *logger_shm;
+
 /** Maximum length of a single log message (in bytes). */
 #define MESSAGE_BUFFER_SIZE 4096
 
+/** Guards message_buffer and the writer side of the shared ring. */
+static FIBRIL_MUTEX_INITIALIZE(message_lock);
+
+/** Buffer for formatting messages. */
+static char message_buffer[MESSAGE_BUFFER_SIZE];
+
+/** Share memory area with the logger service.
+ *
+ * @param session Initialized IPC session with the logger.
+ * @return Error code.
+ */
+static errno_t logger_shm_create(async_sess_t *session)
+{
+	logger_shm_t *shm = as_area_create(AS_AREA_ANY, LOGGER_SHM_SIZE,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (shm == AS_MAP_FAILED)
+		return ENOMEM;
+
+	for (size_t i = 0; i < LOGGER_CLIENT_LOGS_MAX; i++)
+		atomic_init(&shm->levels[i], LVL_LIMIT - 1);
+	atomic_init(&shm->idle, true);
+	atomic_init(&shm->write, 0);
+	atomic_init(&shm->read, 0);
+	shm->size = ALIGN_DOWN(LOGGER_SHM_SIZE - sizeof(logger_shm_t),
+	    LOGGER_SHM_ALIGN);
+
+	async_exch_t *exchange = async_exchange_begin(session);
+	if (exchange == NULL) {
+		as_area_destroy(shm);
+		return ENOMEM;
+	}
+
+	aid_t req = async_send_0(exchange, LOGGER_WRITER_SHARE, NULL);
+	errno_t rc = async_share_out_start(exchange, shm,
+	    AS_AREA_READ | AS_AREA_WRITE);
+	async_exchange_end(exchange);
+
+	errno_t req_rc;
+	async_wait_for(req, &req_rc);
+
+	if (rc == EOK)
+		rc = req_rc;
+	if (rc != EOK) {
+		as_area_destroy(shm);
+		return rc;
+	}
+
+	logger_shm = shm;
+	return EOK;
+}
+
+/** Ask the logger service to drain the shared ring.
+ *
+ * @param session Initialized IPC session with the logger.
+ * @param wait Wait until the ring is drained.
+ * @return Error code.
+ */
+static errno_t logger_flush(async_sess_t *session, bool wait)
+{
+	async_exch_t *exchange = async_exchange_begin(session);
+	if (exchange == NULL)
+		return ENOMEM;
+
+	errno_t rc = EOK;
+	if (wait)
+		rc = async_req_0_0(exchange, LOGGER_WRITER_FLUSH);
+	else
+		async_msg_0(exchange, LOGGER_WRITER_FLUSH);
+
+	async_exchange_end(exchange);
+	return rc;
+}
+
+/** Queue message in the ring shared with the logger service.
+ *
+ * Must be called with message_lock held.
+ *
+ * @param session Initialized IPC session with the logger.
+ * @param log Log to use.
+ * @param level Verbosity level of the message.
+ * @param message The actual message.
+ * @return Error code. ELIMIT if the message does not fit the ring.
+ */
+static errno_t logger_shm_message(async_sess_t *session, log_t log,
+    log_level_t level, const char *message)
+{
+	logger_shm_t *shm = logger_shm;
+	size_t len = str_size(message) + 1;
+	size_t rsize = ALIGN_UP(sizeof(logger_shm_record_t) + len,
+	    LOGGER_SHM_ALIGN);
+
+	if ((rsize > UINT16_MAX) || (rsize > shm->size / 2))
+		return ELIMIT;
+
+	size_t wr = atomic_load_explicit(&shm->write, memory_order_relaxed);
+
+	while (true) {
+		size_t rd = atomic_load_explicit(&shm->read,
+		    memory_order_acquire);
+		size_t pos = wr % shm->size;
+
+		/* Records never wrap around, pad the tail of the ring. */
+		size_t pad = 0;
+		if (pos + rsize > shm->size)
+			pad = shm->size - pos;
+
+		if (wr - rd + pad + rsize <= shm->size)
+			break;
+
+		/* Ring is full, let the logger catch up. */
+		errno_t rc = logger_flush(session, true);
+		if (rc != EOK)
+			return rc;
+	}
+
+	size_t pos = wr % shm->size;
+	if (pos + rsize > shm->size) {
+		logger_shm_record_t *pad =
+		    (logger_shm_record_t *) &shm->data[pos];
+		pad->size = shm->size - pos;
+		pad->level = 0;
+		pad->log = 0;
+		wr += shm->size - pos;
+		pos = 0;
+	}
+
+	logger_shm_record_t *rec = (logger_shm_record_t *) &shm->data[pos];
+	rec->size = rsize;
+	rec->level = level;
+	rec->log = log;
+	memcpy(rec + 1, message, len);
+
+	atomic_store_explicit(&shm->write, wr + rsize, memory_order_release);
+
+	/*
+	 * If the logger went idle, it will not look at the ring until
+	 * we tell it to.
+	 */
+	if (atomic_exchange(&shm->idle, false))
+		(void) logger_flush(session, false);
+
+	return EOK;
+}
+
 /** Send formatted message to the logger service.
  *
  * @param session Initialized IPC session with the logger.
@@ -80,11 +231,6 @@ static errno_t logger_message(async_sess_t *session, log_t log, log_level_t leve
 	if (exchange == NULL) {
 		return ENOMEM;
 	}
-	if (log == LOG_DEFAULT)
-		log = default_log_id;
-
-	// FIXME: remove when all USB drivers use libc logging explicitly
-	str_rtrim(message, '\n');
 
 	aid_t reg_msg = async_send_2(exchange, LOGGER_WRITER_MESSAGE,
 	    log, level, NULL);
@@ -172,6 +318,12 @@ errno_t log_init(const char *prog_name)
 		return ENOMEM;
 	}
 
+	/*
+	 * Without the shared area messages are sent one by one and
+	 * filtered by the logger.
+	 */
+	(void) logger_shm_create(logger_session);
+
 	default_log_id = log_create(prog_name, LOG_NO_PARENT);
 
 	return EOK;
@@ -213,7 +365,8 @@ log_t log_create(const char *name, log_t parent)
 /** Write an entry to the log.
  *
  * The message is printed only if the verbosity level is less than or
- * equal to currently set reporting level of the log.
+ * equal to currently set reporting level of the log. The level is
+ * checked locally, filtered messages are not even formatted.
  *
  * @param ctx Log to use (use LOG_DEFAULT if you have no idea what it means).
  * @param level Severity level of the message.
@@ -239,13 +392,31 @@ void log_msgv(log_t ctx, log_level_t level, const char *fmt, va_list args)
 {
 	assert(level < LVL_LIMIT);
 
-	char *message_buffer = malloc(MESSAGE_BUFFER_SIZE);
-	if (message_buffer == NULL)
+	if (ctx == LOG_DEFAULT)
+		ctx = default_log_id;
+
+	/* Levels are kept up to date by the logger. */
+	logger_shm_t *shm = logger_shm;
+	if ((shm != NULL) && (ctx > 0) && (ctx <= LOGGER_CLIENT_LOGS_MAX) &&
+	    (level > atomic_load_explicit(&shm->levels[ctx - 1],
+	    memory_order_relaxed)))
 		return;
 
+	fibril_mutex_lock(&message_lock);
+
 	vsnprintf(message_buffer, MESSAGE_BUFFER_SIZE, fmt, args);
-	logger_message(logger_session, ctx, level, message_buffer);
-	free(message_buffer);
+
+	// FIXME: remove when all USB drivers use libc logging explicitly
+	str_rtrim(message_buffer, '\n');
+
+	errno_t rc = ELIMIT;
+	if (shm != NULL)
+		rc = logger_shm_message(logger_session, ctx, level,
+		    message_buffer);
+	if (rc != EOK)
+		logger_message(logger_session, ctx, level, message_buffer);
+
+	fibril_mutex_unlock(&message_lock);
 }
 
 /** @}
@@ -147,5 +147,42 @@ errno_t logctl_set_root(void)
 	return (errno_t) reg_msg_rc;
 }
 
+/** Read recent log messages.
+ *
+ * The logger keeps the most recent messages of all logs in memory.
+ * Only whole lines are returned, the newest ones that fit the buffer.
+ * The messages are not NUL-terminated.
+ *
+ * @param buf Buffer for the messages.
+ * @param size Size of the buffer.
+ * @param nread Place to store number of bytes read.
+ * @return Error code or EOK on success.
+ */
+errno_t logctl_get_recent(char *buf, size_t size, size_t *nread)
+{
+	async_exch_t *exchange = NULL;
+	errno_t rc = start_logger_exchange(&exchange);
+	if (rc != EOK)
+		return rc;
+
+	ipc_call_t answer;
+	aid_t reg_msg = async_send_0(exchange, LOGGER_CONTROL_GET_RECENT,
+	    &answer);
+	rc = async_data_read_start(exchange, buf, size);
+	errno_t reg_msg_rc;
+	async_wait_for(reg_msg, &reg_msg_rc);
+
+	async_exchange_end(exchange);
+
+	if (rc != EOK)
+		return rc;
+
+	if (reg_msg_rc != EOK)
+		return (errno_t) reg_msg_rc;
+
+	*nread = IPC_GET_ARG1(answer);
+	return EOK;
+}
+
 /** @}
  */
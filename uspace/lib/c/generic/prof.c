@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup libc
+ * @{
+ */
+/**
+ * @file
+ * @brief Kernel sampling profiler interface.
+ *
+ * All functions require the PERM_PROFILE permission and return
+ * EPERM if the caller lacks it.
+ */
+
+#include <prof.h>
+#include <abi/prof.h>
+#include <libc.h>
+
+/** Start sampling on all CPUs.
+ *
+ * Samples not read since the previous run are discarded.
+ *
+ * @param interval Number of clock ticks between two samples on a CPU.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t prof_start(unsigned int interval)
+{
+	return (errno_t) __SYSCALL2(SYS_PROF, PROF_START, interval);
+}
+
+/** Stop sampling.
+ *
+ * @param dropped Place to store the number of samples lost because
+ *                the kernel buffers were full.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t prof_stop(size_t *dropped)
+{
+	return (errno_t) __SYSCALL5(SYS_PROF, PROF_STOP, 0, 0, 0,
+	    (sysarg_t) dropped);
+}
+
+/** Drain recorded samples.
+ *
+ * @param samples Buffer for the samples.
+ * @param count   Number of samples that fit in the buffer.
+ * @param nread   Place to store the number of samples read.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t prof_read(prof_sample_t *samples, size_t count, size_t *nread)
+{
+	size_t bytes;
+	errno_t rc = (errno_t) __SYSCALL5(SYS_PROF, PROF_READ, 0,
+	    (sysarg_t) samples, count * sizeof(prof_sample_t),
+	    (sysarg_t) &bytes);
+
+	if (rc == EOK)
+		*nread = bytes / sizeof(prof_sample_t);
+
+	return rc;
+}
+
+/** Resolve a kernel address to a symbol name.
+ *
+ * @param addr   Kernel address.
+ * @param name   Buffer for the symbol name.
+ * @param size   Size of the buffer.
+ * @param offset Place to store the offset of @a addr within the symbol.
+ *
+ * @return EOK on success, ENOENT if no symbol matches,
+ *         ENOTSUP if the kernel was built without a symbol table.
+ *
+ */
+errno_t prof_symbol(uintptr_t addr, char *name, size_t size, size_t *offset)
+{
+	return (errno_t) __SYSCALL5(SYS_PROF, PROF_SYMBOL, (sysarg_t) addr,
+	    (sysarg_t) name, size, (sysarg_t) offset);
+}
+
+/** @}
+ */
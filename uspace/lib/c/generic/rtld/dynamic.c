@@ -52,12 +52,14 @@ void dynamic_parse(elf_dyn_t *dyn_ptr, size_t bias, dyn_info_t *info)
 
 	elf_word soname_idx;
 	elf_word rpath_idx;
+	elf_word *gnu_hash;
 
 	DPRINTF("memset\n");
 	memset(info, 0, sizeof(dyn_info_t));
 
 	soname_idx = 0;
 	rpath_idx = 0;
+	gnu_hash = NULL;
 
 	DPRINTF("pass 1\n");
 	while (dp->d_tag != DT_NULL) {
@@ -134,6 +136,17 @@ void dynamic_parse(elf_dyn_t *dyn_ptr, size_t bias, dyn_info_t *info)
 		case DT_BIND_NOW:
 			info->bind_now = true;
 			break;
+		case DT_FLAGS:
+			if ((d_val & DF_SYMBOLIC) != 0)
+				info->symbolic = true;
+			if ((d_val & DF_TEXTREL) != 0)
+				info->text_rel = true;
+			if ((d_val & DF_BIND_NOW) != 0)
+				info->bind_now = true;
+			break;
+		case DT_GNU_HASH:
+			gnu_hash = d_ptr;
+			break;
 
 		default:
 			if (dp->d_tag >= DT_LOPROC && dp->d_tag <= DT_HIPROC)
@@ -144,6 +157,21 @@ void dynamic_parse(elf_dyn_t *dyn_ptr, size_t bias, dyn_info_t *info)
 		++dp;
 	}
 
+	/*
+	 * GNU hash section layout: nbuckets, symoffset, bloom_size,
+	 * bloom_shift, bloom[bloom_size], buckets[nbuckets], chain[].
+	 */
+	if (gnu_hash != NULL && gnu_hash[0] != 0) {
+		info->gnu_hash.nbuckets = gnu_hash[0];
+		info->gnu_hash.symoffset = gnu_hash[1];
+		info->gnu_hash.bloom_mask = gnu_hash[2] - 1;
+		info->gnu_hash.bloom_shift = gnu_hash[3];
+		info->gnu_hash.bloom = (size_t *) &gnu_hash[4];
+		info->gnu_hash.buckets = (elf_word *)
+		    &info->gnu_hash.bloom[gnu_hash[2]];
+		info->gnu_hash.chain = &info->gnu_hash.buckets[gnu_hash[0]];
+	}
+
 	info->soname = info->str_tab + soname_idx;
 	info->rpath = info->str_tab + rpath_idx;
 
@@ -83,8 +83,13 @@ errno_t rtld_prog_process(elf_finfo_t *p_info, rtld_t **rre)
 
 	env->next_id = 1;
 
+	/* The symbol cache is optional, do without it if out of memory. */
+	env->sym_cache = calloc(RTLD_SYM_CACHE_SIZE,
+	    sizeof(rtld_sym_cache_entry_t));
+
 	prog = calloc(1, sizeof(module_t));
 	if (prog == NULL) {
+		free(env->sym_cache);
 		free(env);
 		return ENOMEM;
 	}
@@ -34,6 +34,8 @@
  * @file
  */
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
@@ -44,6 +46,18 @@
 #include <rtld/rtld_debug.h>
 #include <rtld/symbol.h>
 
+/** Symbol being searched for, with its hash values. */
+typedef struct {
+	/** Symbol name */
+	const char *name;
+	/** GNU hash of the name */
+	uint32_t gnu_hash;
+	/** SysV hash of the name (computed on demand) */
+	elf_word sysv_hash;
+	/** @c true iff sysv_hash is valid */
+	bool sysv_valid;
+} symbol_key_t;
+
 /*
  * Hash tables are 32-bit (elf_word) even for 64-bit ELF files.
  */
@@ -62,38 +76,111 @@ static elf_word elf_hash(const unsigned char *name)
 	return h;
 }
 
-static elf_symbol_t *def_find_in_module(const char *name, module_t *m)
+/** GNU hash function (DJB hash, h * 33 + c). */
+static uint32_t elf_gnu_hash(const unsigned char *name)
+{
+	uint32_t h = 5381;
+
+	while (*name)
+		h = (h << 5) + h + *name++;
+
+	return h;
+}
+
+static void symbol_key_init(symbol_key_t *key, const char *name)
+{
+	key->name = name;
+	key->gnu_hash = elf_gnu_hash((const unsigned char *) name);
+	key->sysv_valid = false;
+}
+
+/** Look up symbol using the GNU hash table of a module.
+ *
+ * The Bloom filter rejects most symbols which are not defined in the module
+ * without touching the hash buckets or the string table.
+ */
+static elf_symbol_t *gnu_hash_find(symbol_key_t *key, module_t *m)
+{
+	const size_t word_bits = sizeof(size_t) * 8;
+	uint32_t h = key->gnu_hash;
+	elf_symbol_t *sym_table = m->dyn.sym_tab;
+	size_t word;
+	size_t mask;
+	elf_word i;
+	elf_word hv;
+
+	word = m->dyn.gnu_hash.bloom[(h / word_bits) &
+	    m->dyn.gnu_hash.bloom_mask];
+	mask = ((size_t) 1 << (h % word_bits)) |
+	    ((size_t) 1 << ((h >> m->dyn.gnu_hash.bloom_shift) % word_bits));
+	if ((word & mask) != mask)
+		return NULL;
+
+	i = m->dyn.gnu_hash.buckets[h % m->dyn.gnu_hash.nbuckets];
+	if (i < m->dyn.gnu_hash.symoffset)
+		return NULL;
+
+	do {
+		/* Lowest bit marks the end of the chain */
+		hv = m->dyn.gnu_hash.chain[i - m->dyn.gnu_hash.symoffset];
+		if ((hv | 1) == (h | 1) && str_cmp(key->name,
+		    m->dyn.str_tab + sym_table[i].st_name) == 0)
+			return &sym_table[i];
+		++i;
+	} while ((hv & 1) == 0);
+
+	return NULL;
+}
+
+/** Look up symbol using the SysV hash table of a module. */
+static elf_symbol_t *sysv_hash_find(symbol_key_t *key, module_t *m)
 {
 	elf_symbol_t *sym_table;
-	elf_symbol_t *s, *sym;
+	elf_symbol_t *s;
 	elf_word nbucket;
 	/*elf_word nchain;*/
 	elf_word i;
 	char *s_name;
 	elf_word bucket;
 
-	DPRINTF("def_find_in_module('%s', %s)\n", name, m->dyn.soname);
+	if (!key->sysv_valid) {
+		key->sysv_hash = elf_hash((const unsigned char *) key->name);
+		key->sysv_valid = true;
+	}
 
 	sym_table = m->dyn.sym_tab;
 	nbucket = m->dyn.hash[0];
 	/*nchain = m->dyn.hash[1]; XXX Use to check HT range*/
 
-	bucket = elf_hash((unsigned char *)name) % nbucket;
+	bucket = key->sysv_hash % nbucket;
 	i = m->dyn.hash[2 + bucket];
 
-	sym = NULL;
 	while (i != STN_UNDEF) {
 		s = &sym_table[i];
 		s_name = m->dyn.str_tab + s->st_name;
 
-		if (str_cmp(name, s_name) == 0) {
-			sym = s;
-			break;
-		}
+		if (str_cmp(key->name, s_name) == 0)
+			return s;
 
 		i = m->dyn.hash[2 + nbucket + i];
 	}
 
+	return NULL;
+}
+
+static elf_symbol_t *def_find_in_module(symbol_key_t *key, module_t *m)
+{
+	elf_symbol_t *sym;
+
+	DPRINTF("def_find_in_module('%s', %s)\n", key->name, m->dyn.soname);
+
+	if (m->dyn.gnu_hash.nbuckets != 0)
+		sym = gnu_hash_find(key, m);
+	else if (m->dyn.hash != NULL)
+		sym = sysv_hash_find(key, m);
+	else
+		sym = NULL;
+
 	if (!sym)
 		return NULL;	/* Not found */
 
@@ -121,9 +208,12 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 {
 	module_t *m, *dm;
 	elf_symbol_t *sym, *s;
+	symbol_key_t key;
 	list_t queue;
 	size_t i;
 
+	symbol_key_init(&key, name);
+
 	/*
 	 * Do a BFS using the queue_link and bfs_tag fields.
 	 * Vertices (modules) are tagged the moment they are inserted
@@ -149,7 +239,7 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 		list_remove(&m->queue_link);
 
 		/* If ssf_noroot is specified, do not look in start module */
-		s = def_find_in_module(name, m);
+		s = def_find_in_module(&key, m);
 		if (s != NULL) {
 			/* Symbol found */
 			sym = s;
@@ -182,6 +272,75 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 	return sym; /* Symbol found */
 }
 
+/** Look up symbol in the resolved symbol cache.
+ *
+ * @return Cache entry for the symbol (which may belong to a different
+ *         symbol if it does not match) or @c NULL if there is no cache.
+ */
+static rtld_sym_cache_entry_t *sym_cache_entry(rtld_t *rtld,
+    symbol_key_t *key, symbol_search_flags_t flags)
+{
+	if (rtld->sym_cache == NULL)
+		return NULL;
+
+	return &rtld->sym_cache[(key->gnu_hash ^ flags) &
+	    (RTLD_SYM_CACHE_SIZE - 1)];
+}
+
+static bool sym_cache_match(rtld_sym_cache_entry_t *e, symbol_key_t *key,
+    symbol_search_flags_t flags)
+{
+	return e->sym != NULL && e->hash == key->gnu_hash &&
+	    e->flags == flags && str_cmp(e->name, key->name) == 0;
+}
+
+/** Find the definition of a symbol in the global modules.
+ *
+ * Global modules are searched in the default order. The result does not
+ * depend on the module in which the reference originates. Modules are
+ * only ever appended to the list, so a definition once found remains
+ * the first one. This allows caching the result per process.
+ */
+static elf_symbol_t *global_def_find(symbol_key_t *key, rtld_t *rtld,
+    symbol_search_flags_t flags, module_t **mod)
+{
+	symbol_search_flags_t cflags = flags & ssf_noexec;
+	rtld_sym_cache_entry_t *e = NULL;
+	elf_symbol_t *s;
+
+	if ((flags & ssf_nocache) == 0) {
+		e = sym_cache_entry(rtld, key, cflags);
+		if (e != NULL && sym_cache_match(e, key, cflags)) {
+			*mod = e->mod;
+			return e->sym;
+		}
+	}
+
+	list_foreach(rtld->modules, modules_link, module_t, m) {
+		DPRINTF("module '%s' local?\n", m->dyn.soname);
+		if (!m->local && (!m->exec || (flags & ssf_noexec) == 0)) {
+			DPRINTF("!local->find '%s' in module '%s'\n", key->name,
+			    m->dyn.soname);
+			s = def_find_in_module(key, m);
+			if (s != NULL) {
+				/* Found */
+				if (e != NULL) {
+					e->name = key->name;
+					e->hash = key->gnu_hash;
+					e->flags = cflags;
+					e->sym = s;
+					e->mod = m;
+				}
+
+				*mod = m;
+				return s;
+			}
+		}
+	}
+
+	return NULL;
+}
+
 /** Find the definition of a symbol.
  *
  * By definition in System V ABI, if module origin has the flag DT_SYMBOLIC,
@@ -191,7 +350,8 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
  * @param name		Name of the symbol to search for.
  * @param origin	Module in which the dependency originates.
  * @param flags		@c ssf_none or @c ssf_noexec to not look for the symbol
- *			in the executable program.
+ *			in the executable program. @c ssf_nocache to bypass
+ *			the resolved symbol cache.
  * @param mod		(output) Will be filled with a pointer to the module
  *			that contains the symbol.
  */
@@ -199,6 +359,9 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
     symbol_search_flags_t flags, module_t **mod)
 {
 	elf_symbol_t *s;
+	symbol_key_t key;
+
+	symbol_key_init(&key, name);
 
 	DPRINTF("symbol_def_find('%s', origin='%s'\n",
 	    name, origin->dyn.soname);
@@ -208,7 +371,7 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 		 * Origin module has a DT_SYMBOLIC flag.
 		 * Try this module first
 		 */
-		s = def_find_in_module(name, origin);
+		s = def_find_in_module(&key, origin);
 		if (s != NULL) {
 			/* Found */
 			*mod = origin;
@@ -218,18 +381,9 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 
 	/* Not DT_SYMBOLIC or no match. Now try other locations. */
 
-	list_foreach(origin->rtld->modules, modules_link, module_t, m) {
-		DPRINTF("module '%s' local?\n", m->dyn.soname);
-		if (!m->local && (!m->exec || (flags & ssf_noexec) == 0)) {
-			DPRINTF("!local->find '%s' in module '%s'\n", name, m->dyn.soname);
-			s = def_find_in_module(name, m);
-			if (s != NULL) {
-				/* Found */
-				*mod = m;
-				return s;
-			}
-		}
-	}
+	s = global_def_find(&key, origin->rtld, flags, mod);
+	if (s != NULL)
+		return s;
 
 	/* Finally, try origin. */
 
@@ -237,7 +391,7 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 	    origin->dyn.soname);
 
 	if (!origin->exec || (flags & ssf_noexec) == 0) {
-		s = def_find_in_module(name, origin);
+		s = def_find_in_module(&key, origin);
 		if (s != NULL) {
 			/* Found */
 			*mod = origin;
@@ -39,9 +39,28 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <as.h>
+#include <ddi.h>
+#include <barrier.h>
+#include <mem.h>
+#include <assert.h>
 
 #define SYSINFO_STATS_MAX_PATH  64
 
+/** Number of attempts to get a consistent incremental snapshot */
+#define STATS_SNAPSHOT_ATTEMPTS  4
+
+/* Snapshot records are identified by their first member */
+static_assert(offsetof(stats_task_t, task_id) == 0);
+static_assert(offsetof(stats_thread_t, thread_id) == 0);
+
+/** Statistics page shared by the kernel (read-only) */
+static volatile stats_page_t *stats_page = NULL;
+
+/** Statistics page cannot be mapped */
+static bool stats_page_unavail = false;
+
 /** Thread states
  *
  */
@@ -55,7 +74,68 @@ static const char *thread_states[] = {
 	"Lingering"
 };
 
+/** Map the statistics page
+ *
+ * @return Statistics page or NULL if it is not available.
+ *
+ */
+static volatile stats_page_t *stats_page_get(void)
+{
+	if ((stats_page != NULL) || (stats_page_unavail))
+		return stats_page;
+
+	sysarg_t faddr;
+	sysarg_t frames;
+	if ((sysinfo_get_value("stats.faddr", &faddr) != EOK) ||
+	    (sysinfo_get_value("stats.frames", &frames) != EOK)) {
+		stats_page_unavail = true;
+		return NULL;
+	}
+
+	void *addr = AS_AREA_ANY;
+	errno_t rc = physmem_map(faddr, frames,
+	    AS_AREA_READ | AS_AREA_CACHEABLE, &addr);
+	if (rc != EOK) {
+		stats_page_unavail = true;
+		return NULL;
+	}
+
+	stats_page = addr;
+	return stats_page;
+}
+
+/** Read a CPU slot of the statistics page
+ *
+ * The slot is updated by the kernel concurrently. Retry
+ * until the sequence number shows a consistent copy.
+ *
+ * @param slot CPU slot.
+ * @param cpu  Place to store the CPU statistics.
+ *
+ */
+static void stats_page_read_cpu(volatile stats_cpu_slot_t *slot,
+    stats_cpu_t *cpu)
+{
+	while (true) {
+		uint32_t seq = slot->seq;
+		read_barrier();
+
+		cpu->id = slot->cpu.id;
+		cpu->active = slot->cpu.active;
+		cpu->frequency_mhz = slot->cpu.frequency_mhz;
+		cpu->idle_cycles = slot->cpu.idle_cycles;
+		cpu->busy_cycles = slot->cpu.busy_cycles;
+
+		read_barrier();
+		if (((seq & 1) == 0) && (slot->seq == seq))
+			break;
+	}
+}
+
 /** Get CPUs statistics
+ *
+ * The statistics are read from the statistics page
+ * if it is available.
  *
  * @param count Number of records returned.
  *
@@ -66,6 +146,23 @@ static const char *thread_states[] = {
  */
 stats_cpu_t *stats_get_cpus(size_t *count)
 {
+	volatile stats_page_t *page = stats_page_get();
+	if (page != NULL) {
+		size_t cpus = page->cpu_count;
+		stats_cpu_t *stats_cpus =
+		    (stats_cpu_t *) calloc(cpus, sizeof(stats_cpu_t));
+		if (stats_cpus == NULL) {
+			*count = 0;
+			return NULL;
+		}
+
+		for (size_t i = 0; i < cpus; i++)
+			stats_page_read_cpu(&page->cpus[i], &stats_cpus[i]);
+
+		*count = cpus;
+		return stats_cpus;
+	}
+
 	size_t size = 0;
 	stats_cpu_t *stats_cpus =
 	    (stats_cpu_t *) sysinfo_get_data("system.cpus", &size);
@@ -130,6 +227,240 @@ stats_task_t *stats_get_tasks(size_t *count)
 	return stats_tasks;
 }
 
+/** Compare IDs of two statistics records or IDs */
+static int stats_id_cmp(const void *a, const void *b)
+{
+	uint64_t ida = *(const uint64_t *) a;
+	uint64_t idb = *(const uint64_t *) b;
+
+	if (ida < idb)
+		return -1;
+	else if (ida > idb)
+		return 1;
+
+	return 0;
+}
+
+/** Initialize incremental snapshot of task statistics
+ *
+ * @param snap Snapshot.
+ *
+ */
+void stats_snapshot_init_tasks(stats_snapshot_t *snap)
+{
+	snap->path = "system.task_changes";
+	snap->rec_size = sizeof(stats_task_t);
+	snap->generation = 0;
+	snap->count = 0;
+	snap->recs = NULL;
+}
+
+/** Initialize incremental snapshot of thread statistics
+ *
+ * @param snap Snapshot.
+ *
+ */
+void stats_snapshot_init_threads(stats_snapshot_t *snap)
+{
+	snap->path = "system.thread_changes";
+	snap->rec_size = sizeof(stats_thread_t);
+	snap->generation = 0;
+	snap->count = 0;
+	snap->recs = NULL;
+}
+
+/** Finalize incremental snapshot
+ *
+ * @param snap Snapshot.
+ *
+ */
+void stats_snapshot_fini(stats_snapshot_t *snap)
+{
+	free(snap->recs);
+	snap->recs = NULL;
+	snap->count = 0;
+}
+
+/** Merge changes into a snapshot
+ *
+ * @param snap  Snapshot.
+ * @param delta Incremental statistics from the kernel.
+ *
+ * @return EOK on success, ENOMEM if out of memory.
+ *
+ */
+static errno_t stats_snapshot_merge(stats_snapshot_t *snap,
+    stats_delta_t *delta)
+{
+	size_t rec_size = snap->rec_size;
+	uint8_t *recs = (uint8_t *) (delta + 1);
+	uint64_t *gone = (uint64_t *) (recs + delta->count * rec_size);
+	size_t old_count = delta->full ? 0 : snap->count;
+
+	uint8_t *merged = malloc((old_count + delta->count + 1) * rec_size);
+	if (merged == NULL)
+		return ENOMEM;
+
+	/* Both the changes and the destroyed IDs are merged in ID order */
+	qsort(recs, delta->count, rec_size, stats_id_cmp);
+	qsort(gone, delta->gone, sizeof(uint64_t), stats_id_cmp);
+
+	uint8_t *old = snap->recs;
+	size_t i = 0;
+	size_t j = 0;
+	size_t k = 0;
+	size_t n = 0;
+
+	while ((i < old_count) || (j < delta->count)) {
+		uint8_t *rec;
+
+		if (j == delta->count) {
+			rec = old + i * rec_size;
+			i++;
+		} else if (i == old_count) {
+			rec = recs + j * rec_size;
+			j++;
+		} else {
+			int cmp = stats_id_cmp(old + i * rec_size,
+			    recs + j * rec_size);
+			if (cmp < 0) {
+				rec = old + i * rec_size;
+				i++;
+			} else {
+				/* New or updated record */
+				rec = recs + j * rec_size;
+				j++;
+				if (cmp == 0)
+					i++;
+			}
+		}
+
+		uint64_t id = *(uint64_t *) rec;
+		while ((k < delta->gone) && (gone[k] < id))
+			k++;
+
+		if ((k < delta->gone) && (gone[k] == id))
+			continue;
+
+		memcpy(merged + n * rec_size, rec, rec_size);
+		n++;
+	}
+
+	free(snap->recs);
+	snap->recs = merged;
+	snap->count = n;
+	snap->generation = delta->generation;
+
+	return EOK;
+}
+
+/** Update incremental snapshot
+ *
+ * Only the records of the objects which changed since the
+ * previous update are transferred from the kernel.
+ *
+ * @param snap Snapshot.
+ *
+ * @return EOK on success or an error code.
+ *
+ */
+errno_t stats_snapshot_update(stats_snapshot_t *snap)
+{
+	char name[SYSINFO_STATS_MAX_PATH];
+	snprintf(name, SYSINFO_STATS_MAX_PATH, "%s.%" PRIu64, snap->path,
+	    snap->generation);
+
+	for (unsigned int i = 0; i < STATS_SNAPSHOT_ATTEMPTS; i++) {
+		size_t size = 0;
+		stats_delta_t *delta =
+		    (stats_delta_t *) sysinfo_get_data(name, &size);
+		if (delta == NULL)
+			return ENOENT;
+
+		/*
+		 * The amount of data might have grown between the size
+		 * query and the transfer, in which case the data are
+		 * truncated. Try again.
+		 */
+		if ((size >= sizeof(stats_delta_t)) &&
+		    (size == sizeof(stats_delta_t) +
+		    delta->count * snap->rec_size +
+		    delta->gone * sizeof(uint64_t))) {
+			errno_t rc = stats_snapshot_merge(snap, delta);
+			free(delta);
+			return rc;
+		}
+
+		free(delta);
+	}
+
+	return EAGAIN;
+}
+
+/** Get task statistics using incremental snapshot
+ *
+ * Same as stats_get_tasks(), but only the tasks which
+ * changed since the previous call are transferred from
+ * the kernel.
+ *
+ * @param snap  Task snapshot.
+ * @param count Number of records returned.
+ *
+ * @return Array of stats_task_t structures.
+ *         If non-NULL then it should be eventually freed
+ *         by free().
+ *
+ */
+stats_task_t *stats_get_tasks_snapshot(stats_snapshot_t *snap, size_t *count)
+{
+	*count = 0;
+
+	if (stats_snapshot_update(snap) != EOK)
+		return NULL;
+
+	stats_task_t *stats_tasks =
+	    (stats_task_t *) calloc(snap->count + 1, sizeof(stats_task_t));
+	if (stats_tasks == NULL)
+		return NULL;
+
+	memcpy(stats_tasks, snap->recs, snap->count * sizeof(stats_task_t));
+	*count = snap->count;
+	return stats_tasks;
+}
+
+/** Get thread statistics using incremental snapshot
+ *
+ * Same as stats_get_threads(), but only the threads which
+ * changed since the previous call are transferred from
+ * the kernel.
+ *
+ * @param snap  Thread snapshot.
+ * @param count Number of records returned.
+ *
+ * @return Array of stats_thread_t structures.
+ *         If non-NULL then it should be eventually freed
+ *         by free().
+ *
+ */
+stats_thread_t *stats_get_threads_snapshot(stats_snapshot_t *snap,
+    size_t *count)
+{
+	*count = 0;
+
+	if (stats_snapshot_update(snap) != EOK)
+		return NULL;
+
+	stats_thread_t *stats_threads =
+	    (stats_thread_t *) calloc(snap->count + 1, sizeof(stats_thread_t));
+	if (stats_threads == NULL)
+		return NULL;
+
+	memcpy(stats_threads, snap->recs,
+	    snap->count * sizeof(stats_thread_t));
+	*count = snap->count;
+	return stats_threads;
+}
+
 /** Get single task statistics
  *
  * @param task_id Task ID we are interested in.
@@ -237,6 +568,9 @@ stats_exc_t *stats_get_exception(unsigned int excn)
 }
 
 /** Get system load
+ *
+ * The load is read from the statistics page
+ * if it is available.
  *
  * @param count Number of load records returned.
  *
@@ -247,6 +581,30 @@ stats_exc_t *stats_get_exception(unsigned int excn)
  */
 load_t *stats_get_load(size_t *count)
 {
+	volatile stats_page_t *page = stats_page_get();
+	if (page != NULL) {
+		load_t *load = (load_t *) calloc(LOAD_STEPS, sizeof(load_t));
+		if (load == NULL) {
+			*count = 0;
+			return NULL;
+		}
+
+		while (true) {
+			uint32_t seq = page->load_seq;
+			read_barrier();
+
+			for (unsigned int i = 0; i < LOAD_STEPS; i++)
+				load[i] = page->load[i];
+
+			read_barrier();
+			if (((seq & 1) == 0) && (page->load_seq == seq))
+				break;
+		}
+
+		*count = LOAD_STEPS;
+		return load;
+	}
+
 	size_t size = 0;
 	load_t *load =
 	    (load_t *) sysinfo_get_data("system.load", &size);
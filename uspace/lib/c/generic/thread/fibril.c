@@ -90,6 +90,10 @@ static futex_t fibril_futex;
 static futex_t ready_semaphore;
 static long ready_st_count;
 
+/* This futex serializes spawning of runners. */
+static futex_t runners_futex;
+static int runner_count;
+
 static LIST_INITIALIZE(ready_list);
 static LIST_INITIALIZE(fibril_list);
 static LIST_INITIALIZE(timeout_list);
@@ -781,15 +785,7 @@ static void _runner_fn(void *arg)
 	_helper_fibril_fn(arg);
 }
 
-/**
- * Spawn a given number of runners (i.e. OS threads) immediately, and
- * unconditionally. This is meant to be used for tests and debugging.
- * Regular programs should just use `fibril_enable_multithreaded()`.
- *
- * @param n  Number of runners to spawn.
- * @return   Number of runners successfully spawned.
- */
-int fibril_test_spawn_runners(int n)
+static int _spawn_runners(int n)
 {
 	assert(fibril_self()->rmutex_locks == 0);
 
@@ -805,14 +801,55 @@ int fibril_test_spawn_runners(int n)
 	for (int i = 0; i < n; i++) {
 		thread_id_t tid;
 		rc = thread_create(_runner_fn, NULL, "fibril runner", &tid);
-		if (rc != EOK)
+		if (rc != EOK) {
+			runner_count += i;
 			return i;
+		}
 		thread_detach(tid);
 	}
 
+	runner_count += n;
 	return n;
 }
 
+/**
+ * Spawn a given number of runners (i.e. OS threads) immediately, and
+ * unconditionally. This is meant to be used for tests and debugging.
+ * Regular programs should just use `fibril_enable_multithreaded()`.
+ *
+ * @param n  Number of runners to spawn.
+ * @return   Number of runners successfully spawned.
+ */
+int fibril_test_spawn_runners(int n)
+{
+	futex_lock(&runners_futex);
+	int rc = _spawn_runners(n);
+	futex_unlock(&runners_futex);
+
+	return rc;
+}
+
+/**
+ * Make sure there are at least a given number of runners (OS threads)
+ * besides the main thread. Unlike `fibril_test_spawn_runners()`, only
+ * the missing runners are spawned, so this can be called whenever the
+ * number of fibrils that are supposed to run in parallel grows. Runners
+ * are never destroyed, idle ones just wait for more fibrils to run.
+ *
+ * @param n  Number of runners requested.
+ * @return   Number of runners available.
+ */
+int fibril_ensure_runners(int n)
+{
+	futex_lock(&runners_futex);
+	if (runner_count < n)
+		(void) _spawn_runners(n - runner_count);
+	int count = runner_count;
+	futex_unlock(&runners_futex);
+
+	return count;
+}
+
 /**
  * Opt-in to have more than one runner thread.
  *
@@ -865,6 +902,8 @@ void __fibrils_init(void)
 		abort();
 	if (futex_initialize(&ipc_lists_futex, 1) != EOK)
 		abort();
+	if (futex_initialize(&runners_futex, 1) != EOK)
+		abort();
 
 	/*
 	 * We allow a fixed, small amount of parallelism for IPC reads, but
@@ -885,6 +924,7 @@ void __fibrils_fini(void)
 {
 	futex_destroy(&fibril_futex);
 	futex_destroy(&ipc_lists_futex);
+	futex_destroy(&runners_futex);
 }
 
 void fibril_usleep(usec_t timeout)
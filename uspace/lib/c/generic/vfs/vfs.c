@@ -760,6 +760,25 @@ errno_t vfs_open(int file, int mode)
 	return rc;
 }
 
+/** Get a pager handle for a file
+ *
+ * The pager handle identifies the file in memory areas backed by the VFS
+ * pager. It remains valid after @a file is put, until the task terminates.
+ *
+ * @param file          File handle open for reading
+ * @param[out] handle   Pager handle
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_pager_handle(int file, sysarg_t *handle)
+{
+	async_exch_t *exch = vfs_exchange_begin();
+	errno_t rc = async_req_1_1(exch, VFS_IN_PAGER_HANDLE, file, handle);
+	vfs_exchange_end(exch);
+
+	return rc;
+}
+
 /** Pass a file handle to another VFS client
  *
  * @param vfs_exch      Donor's VFS exchange
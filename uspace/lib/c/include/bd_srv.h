@@ -42,17 +42,26 @@
 #include <offset.h>
 
 typedef struct bd_ops bd_ops_t;
+struct bd_srv_queue;
 
 /** Service setup (per sevice) */
 typedef struct {
 	bd_ops_t *ops;
 	void *sarg;
+	/**
+	 * Maximum number of queued requests executed at the same time.
+	 * Operations must be safe to call from concurrent fibrils if
+	 * greater than one.
+	 */
+	size_t queue_workers;
 } bd_srvs_t;
 
 /** Server structure (per client session) */
 typedef struct {
 	bd_srvs_t *srvs;
 	async_sess_t *client_sess;
+	/** Request queue or NULL if not set up */
+	struct bd_srv_queue *queue;
 	void *carg;
 } bd_srv_t;
 
@@ -62,11 +71,15 @@ struct bd_ops {
 	errno_t (*read_blocks)(bd_srv_t *, aoff64_t, size_t, void *, size_t);
 	errno_t (*read_toc)(bd_srv_t *, uint8_t, void *, size_t);
 	errno_t (*sync_cache)(bd_srv_t *, aoff64_t, size_t);
+	errno_t (*discard_blocks)(bd_srv_t *, aoff64_t, size_t);
 	errno_t (*write_blocks)(bd_srv_t *, aoff64_t, size_t, const void *, size_t);
 	errno_t (*get_block_size)(bd_srv_t *, size_t *);
 	errno_t (*get_num_blocks)(bd_srv_t *, aoff64_t *);
 };
 
+/** Number of queue workers for servers with fibril-safe operations. */
+#define BD_QUEUE_WORKERS_MAX  16
+
 extern void bd_srvs_init(bd_srvs_t *);
 
 extern errno_t bd_conn(ipc_call_t *, bd_srvs_t *);
@@ -38,6 +38,7 @@
 #define ELF_MOD_H_
 
 #include <elf/elf.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <loader/pcb.h>
@@ -105,6 +106,9 @@ typedef struct {
 	/** Flags passed to the ELF loader. */
 	eld_flags_t flags;
 
+	/** VFS pager handle of the file or 0 if not obtained yet. */
+	sysarg_t pager_handle;
+
 	/** Store extracted info here */
 	elf_finfo_t *info;
 } elf_ld_t;
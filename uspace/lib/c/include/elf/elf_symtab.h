@@ -26,17 +26,19 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-/** @addtogroup debug
+/** @addtogroup libc
  * @{
  */
 /** @file
  */
 
-#ifndef SYMTAB_H_
-#define SYMTAB_H_
+#ifndef ELF_SYMTAB_H_
+#define ELF_SYMTAB_H_
 
 #include <elf/elf.h>
+#include <errno.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct {
 	/** Symbol section */
@@ -36,6 +36,8 @@
 #define LIBC_IPC_BD_H_
 
 #include <ipc/common.h>
+#include <stdatomic.h>
+#include <stdint.h>
 
 typedef enum {
 	BD_GET_BLOCK_SIZE = IPC_FIRST_USER_METHOD,
@@ -43,9 +45,81 @@ typedef enum {
 	BD_READ_BLOCKS,
 	BD_SYNC_CACHE,
 	BD_WRITE_BLOCKS,
-	BD_READ_TOC
+	BD_READ_TOC,
+	BD_QUEUE_SETUP,
+	BD_QUEUE_KICK,
+	BD_DISCARD_BLOCKS
 } bd_request_t;
 
+typedef enum {
+	BD_CB_QUEUE_COMPLETE = IPC_FIRST_USER_METHOD
+} bd_cb_request_t;
+
+/** Maximum number of entries in a request queue. */
+#define BD_QUEUE_DEPTH_MAX  64
+
+/** Offset of the data area in the request queue area. */
+#define BD_QUEUE_DATA_OFFSET  4096
+
+/** Queued request operation. */
+typedef enum {
+	BD_QOP_READ,
+	BD_QOP_WRITE,
+	BD_QOP_SYNC
+} bd_queue_op_t;
+
+/** Submission queue entry. */
+typedef struct {
+	/** First block */
+	uint64_t ba;
+	/** Offset of data in the data area */
+	uint64_t offset;
+	/** Size of data in bytes */
+	uint32_t size;
+	/** Number of blocks */
+	uint32_t cnt;
+	/** Operation (bd_queue_op_t) */
+	uint16_t op;
+	/** Tag echoed in the completion */
+	uint16_t tag;
+	uint32_t reserved;
+} bd_queue_sqe_t;
+
+/** Completion queue entry. */
+typedef struct {
+	/** Tag of the completed request */
+	uint16_t tag;
+	uint16_t reserved;
+	/** Result (errno_t) */
+	int32_t rc;
+} bd_queue_cqe_t;
+
+/** Request queue shared between a client and a block device server.
+ *
+ * The client produces submissions and consumes completions, the server
+ * does the opposite. All indices are free-running and taken modulo
+ * @c depth which is a power of two. The data area starts at
+ * BD_QUEUE_DATA_OFFSET and spans the rest of the shared area.
+ *
+ * The server sets @c sq_idle before it stops looking at the submission
+ * queue. The client that clears it sends BD_QUEUE_KICK. Likewise, the
+ * client sets @c cq_wait before it blocks and the server that clears it
+ * sends BD_CB_QUEUE_COMPLETE over the callback connection.
+ */
+typedef struct {
+	/** Number of entries in each queue */
+	uint32_t depth;
+	uint32_t reserved;
+	atomic_uint sq_head;
+	atomic_uint sq_tail;
+	atomic_uint cq_head;
+	atomic_uint cq_tail;
+	atomic_bool sq_idle;
+	atomic_bool cq_wait;
+	bd_queue_sqe_t sq[BD_QUEUE_DEPTH_MAX];
+	bd_queue_cqe_t cq[BD_QUEUE_DEPTH_MAX];
+} bd_queue_shm_t;
+
 #endif
 
 /** @}
@@ -34,6 +34,62 @@
 #define LIBC_IPC_LOGGER_H_
 
 #include <ipc/common.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/** Maximum number of logs a single writer client can create. */
+#define LOGGER_CLIENT_LOGS_MAX 100
+
+/** Size of the memory area shared by a writer client. */
+#define LOGGER_SHM_SIZE 16384
+
+/** Shared memory area of a writer client.
+ *
+ * The server keeps the effective level of every log of the client in
+ * @c levels so that the client can drop filtered messages without any
+ * communication.
+ *
+ * Accepted messages are queued in a ring of @c size bytes following the
+ * header. @c write and @c read are free-running byte counters. The client
+ * appends records and advances @c write, the server drains records and
+ * advances @c read. When the server finds the ring empty, it sets @c idle.
+ * The client that clears @c idle after queueing a record sends
+ * LOGGER_WRITER_FLUSH to make the server drain the ring again.
+ */
+typedef struct {
+	/** Effective level of each log, indexed by log ID minus one */
+	atomic_uchar levels[LOGGER_CLIENT_LOGS_MAX];
+	/** Server is not draining the ring */
+	atomic_bool idle;
+	/** Client position in the ring */
+	atomic_size_t write;
+	/** Server position in the ring */
+	atomic_size_t read;
+	/** Size of the ring in bytes (multiple of the record alignment) */
+	size_t size;
+	/** Ring data */
+	uint8_t data[];
+} logger_shm_t;
+
+/** Record in the shared memory ring.
+ *
+ * Records are aligned to LOGGER_SHM_ALIGN bytes and never wrap around the
+ * end of the ring. A record with @c log set to zero is padding.
+ */
+typedef struct {
+	/** Size of the record including this header (aligned) */
+	uint16_t size;
+	/** Message severity level (log_level_t) */
+	uint8_t level;
+	uint8_t reserved;
+	/** Log ID or 0 for padding */
+	uint32_t log;
+	/* Followed by NUL-terminated message. */
+} logger_shm_record_t;
+
+/** Alignment of records in the shared memory ring. */
+#define LOGGER_SHM_ALIGN sizeof(logger_shm_record_t)
 
 typedef enum {
 	/** Set (global) default displayed logging level.
@@ -54,7 +110,13 @@ typedef enum {
 	 * Returns: error code
 	 * Followed by: vfs_pass_handle() request.
 	 */
-	LOGGER_CONTROL_SET_ROOT
+	LOGGER_CONTROL_SET_ROOT,
+	/** Read recent messages.
+	 *
+	 * Returns: error code, number of bytes read
+	 * Followed by: data read of the messages (newline-separated).
+	 */
+	LOGGER_CONTROL_GET_RECENT
 } logger_control_request_t;
 
 typedef enum {
@@ -71,7 +133,18 @@ typedef enum {
 	 * Returns: error code
 	 * Followed by: string with the message.
 	 */
-	LOGGER_WRITER_MESSAGE
+	LOGGER_WRITER_MESSAGE,
+	/** Share memory area (logger_shm_t) with the logger.
+	 *
+	 * Returns: error code
+	 * Followed by: async_share_out_start() of LOGGER_SHM_SIZE bytes.
+	 */
+	LOGGER_WRITER_SHARE,
+	/** Drain the shared memory ring.
+	 *
+	 * Returns: error code (once the ring has been drained)
+	 */
+	LOGGER_WRITER_FLUSH
 } logger_writer_request_t;
 
 #endif
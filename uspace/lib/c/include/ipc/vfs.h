@@ -75,6 +75,7 @@ typedef enum {
 	VFS_IN_FSTYPES,
 	VFS_IN_MOUNT,
 	VFS_IN_OPEN,
+	VFS_IN_PAGER_HANDLE,
 	VFS_IN_PUT,
 	VFS_IN_READ,
 	VFS_IN_REGISTER,
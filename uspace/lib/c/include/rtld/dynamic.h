@@ -69,6 +69,24 @@ typedef struct dyn_info {
 	/** Hash table */
 	elf_word *hash;
 
+	/** GNU hash table (pointers into the DT_GNU_HASH section) */
+	struct {
+		/** Number of hash buckets */
+		elf_word nbuckets;
+		/** Index of the first symbol accessible via the table */
+		elf_word symoffset;
+		/** Number of Bloom filter words minus one */
+		elf_word bloom_mask;
+		/** Shift count for the second Bloom filter hash */
+		elf_word bloom_shift;
+		/** Bloom filter (elf_addr-sized words) */
+		size_t *bloom;
+		/** Buckets */
+		elf_word *buckets;
+		/** Hash values of symbols starting at symoffset */
+		elf_word *chain;
+	} gnu_hash;
+
 	/** String table */
 	char *str_tab;
 	size_t str_sz;
@@ -35,10 +35,12 @@
 #ifndef LIBC_RTLD_RTLD_ARCH_H_
 #define LIBC_RTLD_RTLD_ARCH_H_
 
+#include <stdbool.h>
 #include <rtld/rtld.h>
 #include <loader/pcb.h>
 
 void module_process_pre_arch(module_t *m);
+bool module_plt_lazy_arch(module_t *m);
 
 void rel_table_process(module_t *m, elf_rel_t *rt, size_t rt_size);
 void rela_table_process(module_t *m, elf_rela_t *rt, size_t rt_size);
@@ -40,9 +40,24 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <abi/sysinfo.h>
+#include <errno.h>
 
 #define LOAD_UNIT  65536
 
+/** Incrementally updated statistics snapshot */
+typedef struct {
+	/** Sysinfo path of the incremental statistics */
+	const char *path;
+	/** Size of a statistics record */
+	size_t rec_size;
+	/** Generation to request with the next update */
+	uint64_t generation;
+	/** Number of records */
+	size_t count;
+	/** Statistics records sorted by ID */
+	void *recs;
+} stats_snapshot_t;
+
 extern stats_cpu_t *stats_get_cpus(size_t *);
 extern stats_physmem_t *stats_get_physmem(void);
 extern load_t *stats_get_load(size_t *);
@@ -52,6 +67,14 @@ extern stats_task_t *stats_get_task(task_id_t);
 
 extern stats_thread_t *stats_get_threads(size_t *);
 
+extern void stats_snapshot_init_tasks(stats_snapshot_t *);
+extern void stats_snapshot_init_threads(stats_snapshot_t *);
+extern void stats_snapshot_fini(stats_snapshot_t *);
+extern errno_t stats_snapshot_update(stats_snapshot_t *);
+extern stats_task_t *stats_get_tasks_snapshot(stats_snapshot_t *, size_t *);
+extern stats_thread_t *stats_get_threads_snapshot(stats_snapshot_t *,
+    size_t *);
+
 extern stats_exc_t *stats_get_exceptions(size_t *);
 extern stats_exc_t *stats_get_exception(unsigned int);
 
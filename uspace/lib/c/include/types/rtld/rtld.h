@@ -42,6 +42,23 @@
 
 #include <types/rtld/module.h>
 
+/** Number of entries in the resolved symbol cache (power of two) */
+#define RTLD_SYM_CACHE_SIZE	1024
+
+/** Resolved symbol cache entry */
+typedef struct {
+	/** Symbol name */
+	const char *name;
+	/** GNU hash of the name */
+	uint32_t hash;
+	/** Search flags */
+	unsigned flags;
+	/** Symbol definition or @c NULL if the entry is empty */
+	elf_symbol_t *sym;
+	/** Module containing the definition */
+	module_t *mod;
+} rtld_sym_cache_entry_t;
+
 typedef struct rtld {
 	elf_dyn_t *rtld_dynamic;
 	module_t rtld;
@@ -60,6 +77,9 @@ typedef struct rtld {
 
 	/** List of initial modules */
 	list_t imodules;
+
+	/** Resolved symbol cache (direct-mapped) or @c NULL */
+	rtld_sym_cache_entry_t *sym_cache;
 } rtld_t;
 
 #endif
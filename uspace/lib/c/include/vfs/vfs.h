@@ -100,6 +100,7 @@ extern errno_t vfs_mount_path(const char *, const char *, const char *,
 extern errno_t vfs_mount(int, const char *, service_id_t, const char *, unsigned,
     unsigned, int *);
 extern errno_t vfs_open(int, int);
+extern errno_t vfs_pager_handle(int, sysarg_t *);
 extern errno_t vfs_pass_handle(async_exch_t *, int, async_exch_t *);
 extern errno_t vfs_put(int);
 extern errno_t vfs_read(int, aoff64_t *, void *, size_t, size_t *);
@@ -0,0 +1,1535 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ * @brief Implementation of deflate compression
+ *
+ * A streaming compressor producing `deflate' streams as described
+ * by RFC 1951. Matches are found using hash chains over a sliding
+ * window of 32 KiB. The lower levels emit the longest match found
+ * right away (greedy matching), the higher levels only emit a match
+ * if the match starting at the next byte is not longer (lazy matching)
+ * and follow longer hash chains.
+ *
+ * The literals and matches are collected into blocks which are encoded
+ * using the fixed codes, dynamic codes or stored verbatim, whichever
+ * is the shortest.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <mem.h>
+#include <byteorder.h>
+#include "deflate.h"
+
+/** Maximum bits in the Huffman code */
+#define MAX_HUFFMAN_BIT  15
+/** Maximum bits in the code length code */
+#define MAX_CODELEN_BIT  7
+
+/** Number of length codes */
+#define MAX_LEN           29
+/** Number of distance codes */
+#define MAX_DIST          30
+/** Number of order codes */
+#define MAX_ORDER         19
+/** Number of literal/length codes */
+#define MAX_LITLEN        286
+/** Number of fixed literal/length codes */
+#define MAX_FIXED_LITLEN  288
+
+/** Number of all codes */
+#define MAX_CODE  (MAX_LITLEN + MAX_DIST)
+
+/** End-of-block symbol */
+#define END_OF_BLOCK  256
+
+/** Minimal length of a match */
+#define MIN_MATCH  3
+/** Maximal length of a match */
+#define MAX_MATCH  258
+
+/** Size of the sliding window */
+#define WINDOW_SIZE  32768
+#define WINDOW_MASK  (WINDOW_SIZE - 1)
+
+/** Extra bytes after the window buffer allowing word-sized reads */
+#define WINDOW_PADDING  (MAX_MATCH + sizeof(uint64_t))
+
+/** Minimal lookahead, except at the end of the input */
+#define MIN_LOOKAHEAD  (MAX_MATCH + MIN_MATCH + 1)
+
+/** Maximal distance of a match (keeps MIN_LOOKAHEAD in the window) */
+#define MAX_DISTANCE  (WINDOW_SIZE - MIN_LOOKAHEAD)
+
+/** Lazy matching discards matches of minimal length further than this */
+#define TOO_FAR  4096
+
+/** Size of the hash table */
+#define HASH_BITS  15
+#define HASH_SIZE  (1 << HASH_BITS)
+
+/** Empty hash chain */
+#define NIL  0
+
+/** Number of symbols per block */
+#define SYMBOL_COUNT  16384
+
+/** Maximal size of a `stored' block */
+#define MAX_STORED  65535
+
+/*
+ * The output buffer holds a single block. The `fixed codes' encoding
+ * uses at most 32 bits per symbol and a block is never encoded in
+ * a longer form than that.
+ */
+
+/** Size of the output buffer */
+#define PENDING_SIZE  (4 * SYMBOL_COUNT + 512)
+
+/** Compression level parameters
+ *
+ */
+typedef struct {
+	/** Follow only a quarter of the chain if the match is this good */
+	uint16_t good_length;
+	/**
+	 * Lazy matching: Do not look for a better match after a match
+	 * of this length.
+	 * Greedy matching: Do not insert strings of longer matches into
+	 * the hash table.
+	 */
+	uint16_t max_lazy;
+	/** Stop searching when a match of this length is found */
+	uint16_t nice_length;
+	/** Maximal number of hash chain links followed */
+	uint16_t max_chain;
+	/** Use lazy matching */
+	bool lazy;
+} deflate_config_t;
+
+/** Compression level parameters (as used by zlib)
+ *
+ */
+static const deflate_config_t configs[DEFLATE_LEVEL_MAX + 1] = {
+	{ 0, 0, 0, 0, false },
+	{ 4, 4, 8, 4, false },
+	{ 4, 5, 16, 8, false },
+	{ 4, 6, 32, 32, false },
+	{ 4, 4, 16, 16, true },
+	{ 8, 16, 32, 32, true },
+	{ 8, 16, 128, 128, true },
+	{ 8, 32, 128, 256, true },
+	{ 32, 128, 258, 1024, true },
+	{ 32, 258, 258, 4096, true }
+};
+
+/** Result of a compression step
+ *
+ */
+typedef enum {
+	/** More input is needed */
+	DEFLATE_NEED_INPUT,
+	/** A block has been written to the output buffer */
+	DEFLATE_BLOCK_DONE,
+	/** All the input has been processed */
+	DEFLATE_INPUT_DONE
+} deflate_result_t;
+
+/** Deflate algorithm state
+ *
+ */
+struct deflate_stream {
+	unsigned int level;              /**< Compression level */
+	const deflate_config_t *config;  /**< Compression level parameters */
+
+	/** Sliding window (two windows worth of data) */
+	uint8_t window[2 * WINDOW_SIZE + WINDOW_PADDING];
+	size_t strstart;       /**< Position of the current string */
+	size_t lookahead;      /**< Number of valid bytes from strstart */
+	size_t match_start;    /**< Position of the last match found */
+	long block_start;      /**< Position of the current block */
+
+	size_t match_length;   /**< Length of the best match */
+	size_t prev_length;    /**< Length of the match at the previous byte */
+	size_t prev_match;     /**< Position of the match at the previous byte */
+	bool match_available;  /**< Literal at the previous byte is pending */
+
+	uint16_t head[HASH_SIZE];    /**< Heads of the hash chains */
+	uint16_t prev[WINDOW_SIZE];  /**< Links of the hash chains */
+
+	/** Distances of the symbols (0 for literals) */
+	uint16_t sym_dist[SYMBOL_COUNT];
+	/** Literals or lengths (minus MIN_MATCH) of the symbols */
+	uint16_t sym_litlen[SYMBOL_COUNT];
+	/** Number of symbols in the current block */
+	size_t sym_count;
+
+	uint32_t lit_freq[MAX_FIXED_LITLEN];  /**< Literal/length frequencies */
+	uint32_t dist_freq[MAX_DIST];         /**< Distance frequencies */
+
+	uint8_t length_code[MAX_MATCH - MIN_MATCH + 1];  /**< Length codes */
+	uint8_t dist_code[512];                /**< Distance codes */
+
+	uint16_t fixed_lit_code[MAX_FIXED_LITLEN];  /**< Fixed literal codes */
+	uint8_t fixed_lit_len[MAX_FIXED_LITLEN];    /**< Fixed literal lengths */
+	uint16_t fixed_dist_code[MAX_DIST];         /**< Fixed distance codes */
+	uint8_t fixed_dist_len[MAX_DIST];           /**< Fixed distance lengths */
+
+	uint8_t pending[PENDING_SIZE];  /**< Output buffer */
+	size_t pending_len;             /**< Bytes in the output buffer */
+	size_t pending_pos;             /**< Bytes drained from the output buffer */
+
+	uint64_t bitbuf;      /**< Bit buffer */
+	unsigned int bitlen;  /**< Number of bits in the bit buffer */
+
+	bool flushed;         /**< No input since the last flush */
+	bool finished;        /**< The final block has been written */
+};
+
+/** Huffman code construction node
+ *
+ */
+typedef struct {
+	uint32_t key;     /**< Frequency, later code length */
+	uint16_t symbol;  /**< Symbol */
+} huffman_node_t;
+
+/** Dynamic Huffman code
+ *
+ */
+typedef struct {
+	uint8_t len[MAX_FIXED_LITLEN];  /**< Code lengths */
+	uint16_t code[MAX_FIXED_LITLEN];  /**< Codes (bit reversed) */
+} huffman_code_t;
+
+/** Length codes
+ *
+ */
+static const uint16_t lens[MAX_LEN] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+/** Extended length codes
+ *
+ */
+static const uint16_t lens_ext[MAX_LEN] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+/** Distance codes
+ *
+ */
+static const uint16_t dists[MAX_DIST] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+	8193, 12289, 16385, 24577
+};
+
+/** Extended distance codes
+ *
+ */
+static const uint16_t dists_ext[MAX_DIST] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11,
+	12, 12, 13, 13
+};
+
+/** Order codes
+ *
+ */
+static const uint8_t order[MAX_ORDER] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/** Extra bits of the code length repeat codes
+ *
+ */
+static const uint8_t codelen_ext[MAX_ORDER] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 7
+};
+
+/** Reverse the bits of a code
+ *
+ * @param code Code.
+ * @param len  Length of the code.
+ *
+ * @return Code with the order of the bits reversed.
+ *
+ */
+static uint16_t bits_reverse(uint16_t code, unsigned int len)
+{
+	uint16_t rev = 0;
+
+	while (len > 0) {
+		rev = (rev << 1) | (code & 1);
+		code >>= 1;
+		len--;
+	}
+
+	return rev;
+}
+
+/** Write bits to the output buffer
+ *
+ * @param stream Deflate stream.
+ * @param value  Bits to write.
+ * @param cnt    Number of bits to write (at most 32).
+ *
+ */
+static inline void bits_put(deflate_stream_t *stream, uint32_t value,
+    unsigned int cnt)
+{
+	stream->bitbuf |= ((uint64_t) value) << stream->bitlen;
+	stream->bitlen += cnt;
+
+	if (stream->bitlen >= 32) {
+		uint32_t val = host2uint32_t_le((uint32_t) stream->bitbuf);
+
+		assert(stream->pending_len + sizeof(val) <= PENDING_SIZE);
+		memcpy(stream->pending + stream->pending_len, &val, sizeof(val));
+		stream->pending_len += sizeof(val);
+
+		stream->bitbuf >>= 32;
+		stream->bitlen -= 32;
+	}
+}
+
+/** Write the bits in the bit buffer up to the byte boundary
+ *
+ * @param stream Deflate stream.
+ *
+ */
+static void bits_align(deflate_stream_t *stream)
+{
+	while (stream->bitlen > 0) {
+		assert(stream->pending_len < PENDING_SIZE);
+		stream->pending[stream->pending_len] = (uint8_t) stream->bitbuf;
+		stream->pending_len++;
+
+		stream->bitbuf >>= 8;
+		stream->bitlen = (stream->bitlen > 8) ? stream->bitlen - 8 : 0;
+	}
+
+	stream->bitbuf = 0;
+}
+
+/** Compare nodes by frequency
+ *
+ * @param a First node.
+ * @param b Second node.
+ *
+ * @return Negative, zero or positive value if @a a is less frequent,
+ *         equal or more frequent than @a b.
+ *
+ */
+static int huffman_node_cmp(const void *a, const void *b)
+{
+	const huffman_node_t *na = (const huffman_node_t *) a;
+	const huffman_node_t *nb = (const huffman_node_t *) b;
+
+	if (na->key != nb->key)
+		return (na->key < nb->key) ? -1 : 1;
+
+	return (int) na->symbol - (int) nb->symbol;
+}
+
+/** Compute minimum redundancy code lengths
+ *
+ * In-place algorithm by A. Moffat and J. Katajainen. On input
+ * the keys are the frequencies in ascending order, on output they
+ * are the code lengths.
+ *
+ * @param nodes Nodes sorted by frequency.
+ * @param n     Number of nodes (at least 2).
+ *
+ */
+static void huffman_minimum_redundancy(huffman_node_t *nodes, size_t n)
+{
+	size_t root = 0;
+	size_t leaf = 2;
+	size_t next;
+
+	/* Build the tree, parent pointers replace the internal weights */
+	nodes[0].key += nodes[1].key;
+
+	for (next = 1; next < n - 1; next++) {
+		if ((leaf >= n) || (nodes[root].key < nodes[leaf].key)) {
+			nodes[next].key = nodes[root].key;
+			nodes[root].key = next;
+			root++;
+		} else {
+			nodes[next].key = nodes[leaf].key;
+			leaf++;
+		}
+
+		if ((leaf >= n) ||
+		    ((root < next) && (nodes[root].key < nodes[leaf].key))) {
+			nodes[next].key += nodes[root].key;
+			nodes[root].key = next;
+			root++;
+		} else {
+			nodes[next].key += nodes[leaf].key;
+			leaf++;
+		}
+	}
+
+	/* Compute the depths of the internal nodes */
+	nodes[n - 2].key = 0;
+	for (next = n - 2; next > 0; next--)
+		nodes[next - 1].key = nodes[nodes[next - 1].key].key + 1;
+
+	/* Compute the depths of the leaves */
+	size_t avail = 1;
+	size_t used = 0;
+	uint32_t depth = 0;
+	int iroot = n - 2;
+	int inext = n - 1;
+
+	while (avail > 0) {
+		while ((iroot >= 0) && (nodes[iroot].key == depth)) {
+			used++;
+			iroot--;
+		}
+
+		while (avail > used) {
+			nodes[inext].key = depth;
+			inext--;
+			avail--;
+		}
+
+		avail = 2 * used;
+		depth++;
+		used = 0;
+	}
+}
+
+/** Construct length-limited Huffman code
+ *
+ * @param freq     Symbol frequencies.
+ * @param n        Number of symbols.
+ * @param max_bits Maximal code length.
+ * @param code     Constructed code.
+ *
+ */
+static void huffman_construct(const uint32_t *freq, size_t n,
+    unsigned int max_bits, huffman_code_t *code)
+{
+	huffman_node_t nodes[MAX_FIXED_LITLEN];
+	size_t cnt = 0;
+	size_t symbol;
+
+	for (symbol = 0; symbol < n; symbol++) {
+		code->len[symbol] = 0;
+
+		if (freq[symbol] != 0) {
+			nodes[cnt].key = freq[symbol];
+			nodes[cnt].symbol = symbol;
+			cnt++;
+		}
+	}
+
+	/*
+	 * Make sure there are at least two codes, so that
+	 * the code is complete and all codes are at least
+	 * one bit long.
+	 */
+	for (symbol = 0; (cnt < 2) && (symbol < n); symbol++) {
+		if (freq[symbol] == 0) {
+			nodes[cnt].key = 1;
+			nodes[cnt].symbol = symbol;
+			cnt++;
+		}
+	}
+
+	qsort(nodes, cnt, sizeof(huffman_node_t), huffman_node_cmp);
+	huffman_minimum_redundancy(nodes, cnt);
+
+	/* Count the codes of each length, limit the lengths */
+	uint16_t count[MAX_HUFFMAN_BIT + 1];
+	unsigned int len;
+	size_t i;
+
+	for (len = 0; len <= max_bits; len++)
+		count[len] = 0;
+
+	for (i = 0; i < cnt; i++) {
+		len = (nodes[i].key > max_bits) ? max_bits : nodes[i].key;
+		count[len]++;
+	}
+
+	/* Fix the Kraft sum of the limited code */
+	uint32_t total = 0;
+	for (len = max_bits; len > 0; len--)
+		total += ((uint32_t) count[len]) << (max_bits - len);
+
+	while (total != (UINT32_C(1) << max_bits)) {
+		count[max_bits]--;
+
+		for (len = max_bits - 1; len > 0; len--) {
+			if (count[len] != 0) {
+				count[len]--;
+				count[len + 1] += 2;
+				break;
+			}
+		}
+
+		total--;
+	}
+
+	/* The most frequent symbols get the shortest codes */
+	i = cnt;
+	for (len = 1; len <= max_bits; len++) {
+		uint16_t j;
+		for (j = 0; j < count[len]; j++) {
+			i--;
+			code->len[nodes[i].symbol] = len;
+		}
+	}
+
+	/* Assign the canonical codes */
+	uint16_t next[MAX_HUFFMAN_BIT + 1];
+	uint16_t value = 0;
+
+	count[0] = 0;
+	for (len = 1; len <= max_bits; len++) {
+		value = (value + count[len - 1]) << 1;
+		next[len] = value;
+	}
+
+	for (symbol = 0; symbol < n; symbol++) {
+		len = code->len[symbol];
+		if (len != 0) {
+			code->code[symbol] = bits_reverse(next[len], len);
+			next[len]++;
+		}
+	}
+}
+
+/** Get the distance code
+ *
+ * @param stream Deflate stream.
+ * @param dist   Distance minus one.
+ *
+ * @return Distance code.
+ *
+ */
+static inline uint8_t dist_code(deflate_stream_t *stream, size_t dist)
+{
+	return (dist < 256) ? stream->dist_code[dist] :
+	    stream->dist_code[256 + (dist >> 7)];
+}
+
+/** Initialize the code mapping tables
+ *
+ * @param stream Deflate stream.
+ *
+ */
+static void deflate_tables(deflate_stream_t *stream)
+{
+	size_t length = 0;
+	size_t code;
+	size_t i;
+
+	for (code = 0; code < MAX_LEN - 1; code++) {
+		for (i = 0; i < (1U << lens_ext[code]); i++)
+			stream->length_code[length++] = code;
+	}
+
+	/* Length 258 has its own code */
+	stream->length_code[MAX_MATCH - MIN_MATCH] = MAX_LEN - 1;
+
+	size_t dist = 0;
+	for (code = 0; code < 16; code++) {
+		for (i = 0; i < (1U << dists_ext[code]); i++)
+			stream->dist_code[dist++] = code;
+	}
+
+	dist >>= 7;
+	for (; code < MAX_DIST; code++) {
+		for (i = 0; i < (1U << (dists_ext[code] - 7)); i++)
+			stream->dist_code[256 + dist++] = code;
+	}
+
+	uint16_t lit_code = 0x30;
+	for (i = 0; i < 144; i++) {
+		stream->fixed_lit_code[i] = bits_reverse(lit_code++, 8);
+		stream->fixed_lit_len[i] = 8;
+	}
+
+	lit_code = 0x190;
+	for (; i < 256; i++) {
+		stream->fixed_lit_code[i] = bits_reverse(lit_code++, 9);
+		stream->fixed_lit_len[i] = 9;
+	}
+
+	lit_code = 0;
+	for (; i < 280; i++) {
+		stream->fixed_lit_code[i] = bits_reverse(lit_code++, 7);
+		stream->fixed_lit_len[i] = 7;
+	}
+
+	lit_code = 0xc0;
+	for (; i < MAX_FIXED_LITLEN; i++) {
+		stream->fixed_lit_code[i] = bits_reverse(lit_code++, 8);
+		stream->fixed_lit_len[i] = 8;
+	}
+
+	for (i = 0; i < MAX_DIST; i++) {
+		stream->fixed_dist_code[i] = bits_reverse(i, 5);
+		stream->fixed_dist_len[i] = 5;
+	}
+}
+
+/** Insert a string into the hash table
+ *
+ * @param stream Deflate stream.
+ * @param pos    Position of the string (at least MIN_MATCH valid bytes).
+ *
+ * @return Previous head of the hash chain.
+ *
+ */
+static inline size_t insert_string(deflate_stream_t *stream, size_t pos)
+{
+	const uint8_t *str = stream->window + pos;
+	uint32_t val = str[0] | (str[1] << 8) | (str[2] << 16);
+	uint32_t hash = (val * UINT32_C(0x9e3779b1)) >> (32 - HASH_BITS);
+
+	size_t head = stream->head[hash];
+	stream->prev[pos & WINDOW_MASK] = head;
+	stream->head[hash] = pos;
+
+	return head;
+}
+
+/** Get the length of the common prefix
+ *
+ * The comparison is done a word at a time, which might read
+ * beyond @a limit (into the window padding).
+ *
+ * @param a     First string.
+ * @param b     Second string.
+ * @param limit Maximal length.
+ *
+ * @return Length of the common prefix (at most @a limit).
+ *
+ */
+static inline size_t match_length(const uint8_t *a, const uint8_t *b,
+    size_t limit)
+{
+	size_t len = 0;
+
+	while (len < limit) {
+		uint64_t wa;
+		uint64_t wb;
+
+		memcpy(&wa, a + len, sizeof(wa));
+		memcpy(&wb, b + len, sizeof(wb));
+
+		uint64_t diff = uint64_t_le2host(wa ^ wb);
+		if (diff != 0) {
+			len += __builtin_ctzll(diff) >> 3;
+			break;
+		}
+
+		len += sizeof(diff);
+	}
+
+	return (len < limit) ? len : limit;
+}
+
+/** Find the longest match
+ *
+ * @param stream    Deflate stream.
+ * @param cur_match Head of the hash chain.
+ * @param best_len  Only matches longer than this are accepted.
+ *
+ * @return Length of the longest match (its position is stored
+ *         in the stream) or @a best_len if there is no longer match.
+ *
+ */
+static size_t longest_match(deflate_stream_t *stream, size_t cur_match,
+    size_t best_len)
+{
+	const deflate_config_t *config = stream->config;
+	const uint8_t *scan = stream->window + stream->strstart;
+	size_t chain = config->max_chain;
+	size_t nice = config->nice_length;
+	size_t limit = (stream->strstart > MAX_DISTANCE) ?
+	    stream->strstart - MAX_DISTANCE : NIL;
+	size_t max_len = (stream->lookahead < MAX_MATCH) ?
+	    stream->lookahead : MAX_MATCH;
+
+	if (best_len >= config->good_length)
+		chain >>= 2;
+
+	if (nice > max_len)
+		nice = max_len;
+
+	if (best_len >= max_len)
+		return best_len;
+
+	do {
+		const uint8_t *match = stream->window + cur_match;
+
+		/* Quick rejection based on the end of the best match so far */
+		if ((match[best_len] != scan[best_len]) ||
+		    (match[0] != scan[0]) || (match[1] != scan[1]))
+			continue;
+
+		size_t len = match_length(scan, match, max_len);
+		if (len > best_len) {
+			stream->match_start = cur_match;
+			best_len = len;
+
+			if (len >= nice)
+				break;
+		}
+	} while (((cur_match = stream->prev[cur_match & WINDOW_MASK]) > limit) &&
+	    (--chain != 0));
+
+	return best_len;
+}
+
+/** Record a literal
+ *
+ * @param stream Deflate stream.
+ * @param lit    Literal.
+ *
+ * @return True if the block is full.
+ *
+ */
+static inline bool tally_literal(deflate_stream_t *stream, uint8_t lit)
+{
+	stream->sym_dist[stream->sym_count] = 0;
+	stream->sym_litlen[stream->sym_count] = lit;
+	stream->sym_count++;
+
+	stream->lit_freq[lit]++;
+
+	return (stream->sym_count == SYMBOL_COUNT - 1);
+}
+
+/** Record a match
+ *
+ * @param stream Deflate stream.
+ * @param dist   Distance of the match.
+ * @param len    Length of the match.
+ *
+ * @return True if the block is full.
+ *
+ */
+static inline bool tally_match(deflate_stream_t *stream, size_t dist,
+    size_t len)
+{
+	assert((dist > 0) && (dist <= WINDOW_SIZE));
+	assert((len >= MIN_MATCH) && (len <= MAX_MATCH));
+
+	stream->sym_dist[stream->sym_count] = dist;
+	stream->sym_litlen[stream->sym_count] = len - MIN_MATCH;
+	stream->sym_count++;
+
+	stream->lit_freq[END_OF_BLOCK + 1 +
+	    stream->length_code[len - MIN_MATCH]]++;
+	stream->dist_freq[dist_code(stream, dist - 1)]++;
+
+	return (stream->sym_count == SYMBOL_COUNT - 1);
+}
+
+/** Compute the size of the encoded symbols
+ *
+ * @param stream   Deflate stream.
+ * @param lit_len  Literal/length code lengths.
+ * @param dist_len Distance code lengths.
+ *
+ * @return Size of the encoded symbols in bits.
+ *
+ */
+static size_t symbols_cost(deflate_stream_t *stream, const uint8_t *lit_len,
+    const uint8_t *dist_len)
+{
+	size_t bits = 0;
+	size_t i;
+
+	for (i = 0; i <= END_OF_BLOCK; i++)
+		bits += stream->lit_freq[i] * lit_len[i];
+
+	for (i = 0; i < MAX_LEN; i++) {
+		bits += stream->lit_freq[END_OF_BLOCK + 1 + i] *
+		    (lit_len[END_OF_BLOCK + 1 + i] + lens_ext[i]);
+	}
+
+	for (i = 0; i < MAX_DIST; i++)
+		bits += stream->dist_freq[i] * (dist_len[i] + dists_ext[i]);
+
+	return bits;
+}
+
+/** Write the symbols of the current block
+ *
+ * @param stream    Deflate stream.
+ * @param lit_code  Literal/length codes.
+ * @param lit_len   Literal/length code lengths.
+ * @param dist_code Distance codes.
+ * @param dist_len  Distance code lengths.
+ *
+ */
+static void symbols_write(deflate_stream_t *stream, const uint16_t *lit_code,
+    const uint8_t *lit_len, const uint16_t *dist_codes,
+    const uint8_t *dist_len)
+{
+	size_t i;
+
+	for (i = 0; i < stream->sym_count; i++) {
+		size_t dist = stream->sym_dist[i];
+		size_t litlen = stream->sym_litlen[i];
+
+		if (dist == 0) {
+			bits_put(stream, lit_code[litlen], lit_len[litlen]);
+			continue;
+		}
+
+		size_t code = stream->length_code[litlen];
+		bits_put(stream, lit_code[END_OF_BLOCK + 1 + code],
+		    lit_len[END_OF_BLOCK + 1 + code]);
+		if (lens_ext[code] != 0) {
+			bits_put(stream, litlen + MIN_MATCH - lens[code],
+			    lens_ext[code]);
+		}
+
+		code = dist_code(stream, dist - 1);
+		bits_put(stream, dist_codes[code], dist_len[code]);
+		if (dists_ext[code] != 0)
+			bits_put(stream, dist - dists[code], dists_ext[code]);
+	}
+
+	bits_put(stream, lit_code[END_OF_BLOCK], lit_len[END_OF_BLOCK]);
+}
+
+/** Write `stored' blocks
+ *
+ * @param stream Deflate stream.
+ * @param data   Data to store.
+ * @param len    Length of the data.
+ * @param last   Last block of the stream.
+ *
+ */
+static void stored_write(deflate_stream_t *stream, const uint8_t *data,
+    size_t len, bool last)
+{
+	do {
+		size_t cnt = (len > MAX_STORED) ? MAX_STORED : len;
+		bool final = last && (cnt == len);
+
+		bits_put(stream, final ? 1 : 0, 3);
+		bits_align(stream);
+
+		uint16_t hdr[2] = {
+			host2uint16_t_le((uint16_t) cnt),
+			host2uint16_t_le((uint16_t) ~cnt)
+		};
+
+		assert(stream->pending_len + sizeof(hdr) + cnt <= PENDING_SIZE);
+		memcpy(stream->pending + stream->pending_len, hdr, sizeof(hdr));
+		stream->pending_len += sizeof(hdr);
+
+		if (cnt > 0) {
+			memcpy(stream->pending + stream->pending_len, data, cnt);
+			stream->pending_len += cnt;
+			data += cnt;
+		}
+
+		len -= cnt;
+	} while (len > 0);
+}
+
+/** Run-length encode the code lengths
+ *
+ * @param lengths   Code lengths.
+ * @param n         Number of code lengths.
+ * @param codes     Output code length symbols (extra bits in upper byte).
+ * @param freq      Code length symbol frequencies.
+ *
+ * @return Number of code length symbols.
+ *
+ */
+static size_t codelen_encode(const uint8_t *lengths, size_t n,
+    uint16_t *codes, uint32_t *freq)
+{
+	size_t cnt = 0;
+	size_t i = 0;
+
+	while (i < n) {
+		uint8_t len = lengths[i];
+		size_t run = 1;
+
+		while ((i + run < n) && (lengths[i + run] == len))
+			run++;
+
+		i += run;
+
+		if (len == 0) {
+			while (run >= 11) {
+				size_t rep = (run > 138) ? 138 : run;
+				codes[cnt++] = 18 | ((rep - 11) << 8);
+				freq[18]++;
+				run -= rep;
+			}
+
+			if (run >= 3) {
+				codes[cnt++] = 17 | ((run - 3) << 8);
+				freq[17]++;
+				run = 0;
+			}
+		} else {
+			codes[cnt++] = len;
+			freq[len]++;
+			run--;
+
+			while (run >= 3) {
+				size_t rep = (run > 6) ? 6 : run;
+				codes[cnt++] = 16 | ((rep - 3) << 8);
+				freq[16]++;
+				run -= rep;
+			}
+		}
+
+		while (run > 0) {
+			codes[cnt++] = len;
+			freq[len]++;
+			run--;
+		}
+	}
+
+	return cnt;
+}
+
+/** Write the current block
+ *
+ * The block is encoded using the shortest of the fixed codes,
+ * dynamic codes or as `stored' data (if still present in the
+ * window).
+ *
+ * @param stream Deflate stream.
+ * @param last   Last block of the stream.
+ *
+ */
+static void deflate_block(deflate_stream_t *stream, bool last)
+{
+	huffman_code_t lit;
+	huffman_code_t dist;
+	huffman_code_t codelen;
+
+	stream->lit_freq[END_OF_BLOCK] = 1;
+
+	huffman_construct(stream->lit_freq, MAX_LITLEN, MAX_HUFFMAN_BIT, &lit);
+	huffman_construct(stream->dist_freq, MAX_DIST, MAX_HUFFMAN_BIT, &dist);
+
+	/* Trailing zero lengths are not transmitted */
+	size_t hlit = MAX_LITLEN;
+	while (lit.len[hlit - 1] == 0)
+		hlit--;
+
+	size_t hdist = MAX_DIST;
+	while (dist.len[hdist - 1] == 0)
+		hdist--;
+
+	/* The literal/length and distance code lengths form a single sequence */
+	uint8_t lengths[MAX_CODE];
+	memcpy(lengths, lit.len, hlit);
+	memcpy(lengths + hlit, dist.len, hdist);
+
+	uint16_t codes[MAX_CODE];
+	uint32_t codelen_freq[MAX_ORDER];
+	memset(codelen_freq, 0, sizeof(codelen_freq));
+
+	size_t ncodes = codelen_encode(lengths, hlit + hdist, codes,
+	    codelen_freq);
+	huffman_construct(codelen_freq, MAX_ORDER, MAX_CODELEN_BIT, &codelen);
+
+	size_t hclen = MAX_ORDER;
+	while ((hclen > 4) && (codelen.len[order[hclen - 1]] == 0))
+		hclen--;
+
+	/* Compute the sizes of the encodings */
+	size_t dynamic_bits = 3 + 5 + 5 + 4 + 3 * hclen;
+	size_t i;
+
+	for (i = 0; i < MAX_ORDER; i++) {
+		dynamic_bits += codelen_freq[i] *
+		    (codelen.len[i] + codelen_ext[i]);
+	}
+
+	dynamic_bits += symbols_cost(stream, lit.len, dist.len);
+
+	size_t fixed_bits = 3 +
+	    symbols_cost(stream, stream->fixed_lit_len, stream->fixed_dist_len);
+
+	size_t stored_len = stream->strstart - stream->block_start;
+	size_t stored_bits = SIZE_MAX;
+
+	if (stream->block_start >= 0) {
+		size_t blocks = (stored_len + MAX_STORED - 1) / MAX_STORED;
+		if (blocks == 0)
+			blocks = 1;
+
+		stored_bits = (stored_len + 4 * blocks) * 8 + 3 * blocks + 7;
+	}
+
+	if ((stored_bits <= fixed_bits) && (stored_bits <= dynamic_bits)) {
+		stored_write(stream, stream->window + stream->block_start,
+		    stored_len, last);
+	} else if (fixed_bits <= dynamic_bits) {
+		bits_put(stream, (1 << 1) | (last ? 1 : 0), 3);
+		symbols_write(stream, stream->fixed_lit_code,
+		    stream->fixed_lit_len, stream->fixed_dist_code,
+		    stream->fixed_dist_len);
+	} else {
+		bits_put(stream, (2 << 1) | (last ? 1 : 0), 3);
+		bits_put(stream, hlit - 257, 5);
+		bits_put(stream, hdist - 1, 5);
+		bits_put(stream, hclen - 4, 4);
+
+		for (i = 0; i < hclen; i++)
+			bits_put(stream, codelen.len[order[i]], 3);
+
+		for (i = 0; i < ncodes; i++) {
+			uint8_t sym = codes[i] & 0xff;
+
+			bits_put(stream, codelen.code[sym], codelen.len[sym]);
+			if (codelen_ext[sym] != 0)
+				bits_put(stream, codes[i] >> 8, codelen_ext[sym]);
+		}
+
+		symbols_write(stream, lit.code, lit.len, dist.code, dist.len);
+	}
+
+	/* Start a new block */
+	memset(stream->lit_freq, 0, sizeof(stream->lit_freq));
+	memset(stream->dist_freq, 0, sizeof(stream->dist_freq));
+	stream->sym_count = 0;
+	stream->block_start = stream->strstart;
+}
+
+/** Fill the window with input data
+ *
+ * @param stream Deflate stream.
+ * @param src    Input data.
+ * @param srclen Length of the input data.
+ *
+ * @return Number of input bytes consumed.
+ *
+ */
+static size_t deflate_fill(deflate_stream_t *stream, const uint8_t *src,
+    size_t srclen)
+{
+	if (stream->strstart >= WINDOW_SIZE + MAX_DISTANCE) {
+		/* Slide the window down by a window size */
+		memcpy(stream->window, stream->window + WINDOW_SIZE, WINDOW_SIZE);
+		stream->match_start -= WINDOW_SIZE;
+		stream->prev_match -= WINDOW_SIZE;
+		stream->strstart -= WINDOW_SIZE;
+		stream->block_start -= WINDOW_SIZE;
+
+		size_t i;
+		for (i = 0; i < HASH_SIZE; i++) {
+			stream->head[i] = (stream->head[i] >= WINDOW_SIZE) ?
+			    stream->head[i] - WINDOW_SIZE : NIL;
+		}
+
+		for (i = 0; i < WINDOW_SIZE; i++) {
+			stream->prev[i] = (stream->prev[i] >= WINDOW_SIZE) ?
+			    stream->prev[i] - WINDOW_SIZE : NIL;
+		}
+	}
+
+	size_t end = stream->strstart + stream->lookahead;
+	size_t cnt = 2 * WINDOW_SIZE - end;
+	if (cnt > srclen)
+		cnt = srclen;
+
+	if (cnt > 0) {
+		memcpy(stream->window + end, src, cnt);
+		stream->lookahead += cnt;
+		stream->flushed = false;
+	}
+
+	return cnt;
+}
+
+/** Store the input without compression
+ *
+ * @param stream Deflate stream.
+ * @param flush  Flush mode.
+ *
+ * @return Result of the compression step.
+ *
+ */
+static deflate_result_t deflate_stored(deflate_stream_t *stream,
+    deflate_flush_t flush)
+{
+	size_t len = stream->lookahead;
+
+	/* Wait for a full window worth of data (or a full buffer) */
+	if ((len < WINDOW_SIZE) && (flush == DEFLATE_NO_FLUSH) &&
+	    (stream->strstart + len < 2 * WINDOW_SIZE))
+		return DEFLATE_NEED_INPUT;
+
+	if (len == 0)
+		return DEFLATE_INPUT_DONE;
+
+	if (len > WINDOW_SIZE)
+		len = WINDOW_SIZE;
+
+	stored_write(stream, stream->window + stream->strstart, len, false);
+	stream->strstart += len;
+	stream->lookahead -= len;
+	stream->block_start = stream->strstart;
+
+	return DEFLATE_BLOCK_DONE;
+}
+
+/** Compress the input using greedy matching
+ *
+ * @param stream Deflate stream.
+ * @param flush  Flush mode.
+ *
+ * @return Result of the compression step.
+ *
+ */
+static deflate_result_t deflate_greedy(deflate_stream_t *stream,
+    deflate_flush_t flush)
+{
+	while (true) {
+		if (stream->lookahead < MIN_LOOKAHEAD) {
+			if (flush == DEFLATE_NO_FLUSH)
+				return DEFLATE_NEED_INPUT;
+
+			if (stream->lookahead == 0)
+				return DEFLATE_INPUT_DONE;
+		}
+
+		size_t head = NIL;
+		if (stream->lookahead >= MIN_MATCH)
+			head = insert_string(stream, stream->strstart);
+
+		size_t len = MIN_MATCH - 1;
+		if ((head != NIL) && (stream->strstart - head <= MAX_DISTANCE))
+			len = longest_match(stream, head, MIN_MATCH - 1);
+
+		bool full;
+
+		if (len >= MIN_MATCH) {
+			full = tally_match(stream,
+			    stream->strstart - stream->match_start, len);
+			stream->lookahead -= len;
+
+			if ((len <= stream->config->max_lazy) &&
+			    (stream->lookahead >= MIN_MATCH)) {
+				/* The current string is already in the table */
+				while (--len != 0) {
+					stream->strstart++;
+					insert_string(stream, stream->strstart);
+				}
+
+				stream->strstart++;
+			} else
+				stream->strstart += len;
+		} else {
+			full = tally_literal(stream,
+			    stream->window[stream->strstart]);
+			stream->lookahead--;
+			stream->strstart++;
+		}
+
+		if (full) {
+			deflate_block(stream, false);
+			return DEFLATE_BLOCK_DONE;
+		}
+	}
+}
+
+/** Compress the input using lazy matching
+ *
+ * @param stream Deflate stream.
+ * @param flush  Flush mode.
+ *
+ * @return Result of the compression step.
+ *
+ */
+static deflate_result_t deflate_lazy(deflate_stream_t *stream,
+    deflate_flush_t flush)
+{
+	while (true) {
+		if (stream->lookahead < MIN_LOOKAHEAD) {
+			if (flush == DEFLATE_NO_FLUSH)
+				return DEFLATE_NEED_INPUT;
+
+			if (stream->lookahead == 0)
+				break;
+		}
+
+		size_t head = NIL;
+		if (stream->lookahead >= MIN_MATCH)
+			head = insert_string(stream, stream->strstart);
+
+		stream->prev_length = stream->match_length;
+		stream->prev_match = stream->match_start;
+		stream->match_length = MIN_MATCH - 1;
+
+		if ((head != NIL) &&
+		    (stream->prev_length < stream->config->max_lazy) &&
+		    (stream->strstart - head <= MAX_DISTANCE)) {
+			stream->match_length = longest_match(stream, head,
+			    stream->prev_length);
+
+			/* Short distant matches are not worth it */
+			if ((stream->match_length == MIN_MATCH) &&
+			    (stream->strstart - stream->match_start > TOO_FAR))
+				stream->match_length = MIN_MATCH - 1;
+
+			/* No better match than at the previous byte */
+			if (stream->match_length <= stream->prev_length)
+				stream->match_length = MIN_MATCH - 1;
+		}
+
+		if ((stream->prev_length >= MIN_MATCH) &&
+		    (stream->match_length <= stream->prev_length)) {
+			/* Emit the match found at the previous byte */
+			size_t max_insert = stream->strstart + stream->lookahead -
+			    MIN_MATCH;
+			size_t len = stream->prev_length;
+
+			bool full = tally_match(stream,
+			    stream->strstart - 1 - stream->prev_match, len);
+
+			stream->lookahead -= len - 1;
+
+			/* The current string is already in the table */
+			len -= 2;
+			while (len-- != 0) {
+				stream->strstart++;
+				if (stream->strstart <= max_insert)
+					insert_string(stream, stream->strstart);
+			}
+
+			stream->match_available = false;
+			stream->match_length = MIN_MATCH - 1;
+			stream->strstart++;
+
+			if (full) {
+				deflate_block(stream, false);
+				return DEFLATE_BLOCK_DONE;
+			}
+		} else if (stream->match_available) {
+			/* The previous byte is emitted as a literal */
+			bool full = tally_literal(stream,
+			    stream->window[stream->strstart - 1]);
+
+			if (full)
+				deflate_block(stream, false);
+
+			stream->strstart++;
+			stream->lookahead--;
+
+			if (full)
+				return DEFLATE_BLOCK_DONE;
+		} else {
+			/* Decide about the current byte at the next step */
+			stream->match_available = true;
+			stream->strstart++;
+			stream->lookahead--;
+		}
+	}
+
+	if (stream->match_available) {
+		tally_literal(stream, stream->window[stream->strstart - 1]);
+		stream->match_available = false;
+	}
+
+	return DEFLATE_INPUT_DONE;
+}
+
+/** Reset the stream to its initial state
+ *
+ * @param stream Deflate stream.
+ *
+ */
+static void deflate_init(deflate_stream_t *stream)
+{
+	memset(stream->head, 0, sizeof(stream->head));
+	memset(stream->prev, 0, sizeof(stream->prev));
+	memset(stream->lit_freq, 0, sizeof(stream->lit_freq));
+	memset(stream->dist_freq, 0, sizeof(stream->dist_freq));
+
+	/* Position 0 serves as NIL, the data start at position 1 */
+	stream->strstart = 1;
+	stream->lookahead = 0;
+	stream->match_start = 0;
+	stream->block_start = 1;
+
+	stream->match_length = MIN_MATCH - 1;
+	stream->prev_length = MIN_MATCH - 1;
+	stream->prev_match = 0;
+	stream->match_available = false;
+
+	stream->sym_count = 0;
+	stream->pending_len = 0;
+	stream->pending_pos = 0;
+	stream->bitbuf = 0;
+	stream->bitlen = 0;
+
+	stream->flushed = true;
+	stream->finished = false;
+}
+
+/** Create a deflate stream
+ *
+ * @param level  Compression level (0 to DEFLATE_LEVEL_MAX).
+ * @param stream Place to store the new stream.
+ *
+ * @return EOK on success.
+ * @return EINVAL if the compression level is not valid.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t deflate_stream_create(unsigned int level, deflate_stream_t **stream)
+{
+	if (level > DEFLATE_LEVEL_MAX)
+		return EINVAL;
+
+	deflate_stream_t *new_stream =
+	    (deflate_stream_t *) calloc(1, sizeof(deflate_stream_t));
+	if (new_stream == NULL)
+		return ENOMEM;
+
+	new_stream->level = level;
+	new_stream->config = &configs[level];
+
+	deflate_tables(new_stream);
+	deflate_init(new_stream);
+
+	*stream = new_stream;
+	return EOK;
+}
+
+/** Destroy a deflate stream
+ *
+ * @param stream Deflate stream.
+ *
+ */
+void deflate_stream_destroy(deflate_stream_t *stream)
+{
+	free(stream);
+}
+
+/** Reset a deflate stream to start a new compressed stream
+ *
+ * @param stream Deflate stream.
+ *
+ */
+void deflate_stream_reset(deflate_stream_t *stream)
+{
+	deflate_init(stream);
+}
+
+/** Run a compression step
+ *
+ * @param stream Deflate stream.
+ * @param flush  Flush mode.
+ *
+ * @return Result of the compression step.
+ *
+ */
+static deflate_result_t deflate_step(deflate_stream_t *stream,
+    deflate_flush_t flush)
+{
+	if (stream->level == 0)
+		return deflate_stored(stream, flush);
+
+	if (stream->config->lazy)
+		return deflate_lazy(stream, flush);
+
+	return deflate_greedy(stream, flush);
+}
+
+/** Compress data in a streaming fashion
+ *
+ * The input is consumed as long as there is space for the output.
+ * The compressed data might lag behind the input unless a flush is
+ * requested. DEFLATE_SYNC_FLUSH completes the current block and aligns
+ * the output to a byte boundary using an empty `stored' block, so that
+ * the receiver can decompress all the data so far. DEFLATE_FINISH
+ * writes the final block, no more data can be compressed afterwards
+ * (until the stream is reset).
+ *
+ * @param stream   Deflate stream.
+ * @param src      Input data.
+ * @param srclen   Input data size.
+ * @param srcused  Place to store the number of input bytes consumed.
+ * @param dest     Output buffer.
+ * @param destlen  Output buffer size.
+ * @param destused Place to store the number of bytes written.
+ * @param flush    Flush mode (applies once all the input is consumed).
+ *
+ * @return EOK if all the input has been consumed and the requested
+ *         flush is complete (the stream has been finished in case
+ *         of DEFLATE_FINISH).
+ * @return EAGAIN if more output space is needed.
+ *
+ */
+errno_t deflate_stream_process(deflate_stream_t *stream, const void *src,
+    size_t srclen, size_t *srcused, void *dest, size_t destlen,
+    size_t *destused, deflate_flush_t flush)
+{
+	const uint8_t *input = (const uint8_t *) src;
+	uint8_t *output = (uint8_t *) dest;
+	size_t incnt = 0;
+	size_t outcnt = 0;
+	errno_t rc;
+
+	while (true) {
+		/* Drain the output buffer */
+		size_t cnt = stream->pending_len - stream->pending_pos;
+		if (cnt > destlen - outcnt)
+			cnt = destlen - outcnt;
+
+		memcpy(output + outcnt, stream->pending + stream->pending_pos, cnt);
+		stream->pending_pos += cnt;
+		outcnt += cnt;
+
+		if (stream->pending_pos < stream->pending_len) {
+			rc = EAGAIN;
+			break;
+		}
+
+		stream->pending_len = 0;
+		stream->pending_pos = 0;
+
+		if (stream->finished) {
+			rc = EOK;
+			break;
+		}
+
+		incnt += deflate_fill(stream, input + incnt, srclen - incnt);
+
+		deflate_flush_t mode = (incnt == srclen) ? flush : DEFLATE_NO_FLUSH;
+		deflate_result_t res = deflate_step(stream, mode);
+
+		if (res == DEFLATE_BLOCK_DONE)
+			continue;
+
+		if (res == DEFLATE_NEED_INPUT) {
+			if (incnt == srclen) {
+				rc = EOK;
+				break;
+			}
+
+			continue;
+		}
+
+		/* All the input has been processed */
+		if (mode == DEFLATE_FINISH) {
+			deflate_block(stream, true);
+			bits_align(stream);
+			stream->finished = true;
+			continue;
+		}
+
+		if (stream->flushed) {
+			rc = EOK;
+			break;
+		}
+
+		if (stream->strstart != (size_t) stream->block_start)
+			deflate_block(stream, false);
+
+		/* Empty `stored' block */
+		stored_write(stream, NULL, 0, false);
+		stream->flushed = true;
+	}
+
+	*srcused = incnt;
+	*destused = outcnt;
+	return rc;
+}
+
+/** Get the upper bound of the compressed size
+ *
+ * The bound is valid for deflate_compress() and for data compressed
+ * by deflate_stream_process() with no intermediate flushes.
+ *
+ * @param srclen Input data size.
+ *
+ * @return Maximal size of the compressed data.
+ *
+ */
+size_t deflate_bound(size_t srclen)
+{
+	return srclen + (srclen >> 12) + (srclen >> 14) + 16;
+}
+
+/** Compress a buffer
+ *
+ * @param src      Input data.
+ * @param srclen   Input data size.
+ * @param dest     Output buffer.
+ * @param destlen  Output buffer size.
+ * @param destused Place to store the size of the compressed data.
+ * @param level    Compression level (0 to DEFLATE_LEVEL_MAX).
+ *
+ * @return EOK on success.
+ * @return ENOMEM if the output buffer is too small or out of memory.
+ * @return EINVAL if the compression level is not valid.
+ *
+ */
+errno_t deflate_compress(const void *src, size_t srclen, void *dest,
+    size_t destlen, size_t *destused, unsigned int level)
+{
+	deflate_stream_t *stream;
+	errno_t rc = deflate_stream_create(level, &stream);
+	if (rc != EOK)
+		return rc;
+
+	size_t srcused;
+	rc = deflate_stream_process(stream, src, srclen, &srcused, dest,
+	    destlen, destused, DEFLATE_FINISH);
+
+	deflate_stream_destroy(stream);
+
+	if (rc == EAGAIN)
+		return ENOMEM;
+
+	return rc;
+}
@@ -26,25 +26,33 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <adt/checksum.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include <errno.h>
 #include <mem.h>
 #include <byteorder.h>
 #include <stdlib.h>
 #include "gzip.h"
 #include "inflate.h"
+#include "deflate.h"
 
 #define GZIP_ID1  UINT8_C(0x1f)
 #define GZIP_ID2  UINT8_C(0x8b)
 
 #define GZIP_METHOD_DEFLATE  UINT8_C(0x08)
 
+#define GZIP_XFL_BEST  UINT8_C(0x02)
+#define GZIP_XFL_FAST  UINT8_C(0x04)
+
+#define GZIP_OS_UNKNOWN  UINT8_C(0xff)
+
 #define GZIP_FLAGS_MASK     UINT8_C(0x1f)
-#define GZIP_FLAG_FHCRC     UINT8_C(1 << 1)
-#define GZIP_FLAG_FEXTRA    UINT8_C(1 << 2)
-#define GZIP_FLAG_FNAME     UINT8_C(1 << 3)
-#define GZIP_FLAG_FCOMMENT  UINT8_C(1 << 4)
+#define GZIP_FLAG_FHCRC     (UINT8_C(1) << 1)
+#define GZIP_FLAG_FEXTRA    (UINT8_C(1) << 2)
+#define GZIP_FLAG_FNAME     (UINT8_C(1) << 3)
+#define GZIP_FLAG_FCOMMENT  (UINT8_C(1) << 4)
 
 typedef struct {
 	uint8_t id1;
@@ -61,6 +69,404 @@ typedef struct {
 	uint32_t size;
 } __attribute__((packed)) gzip_footer_t;
 
+/** Decoder state
+ *
+ */
+typedef enum {
+	/** Fixed part of the header */
+	GZIP_HEADER,
+	/** Length of the extra field */
+	GZIP_EXTRA_LEN,
+	/** Extra field */
+	GZIP_EXTRA,
+	/** Original file name */
+	GZIP_NAME,
+	/** File comment */
+	GZIP_COMMENT,
+	/** Header CRC */
+	GZIP_HCRC,
+	/** Compressed data */
+	GZIP_DATA,
+	/** Footer */
+	GZIP_FOOTER,
+	/** End of the stream was reached */
+	GZIP_DONE
+} gzip_state_t;
+
+/** GZIP decoder state
+ *
+ */
+struct gzip_stream {
+	gzip_state_t state;       /**< Decoder state */
+	uint8_t flags;            /**< Header fields yet to be processed */
+	size_t skip;              /**< Bytes of the extra field to skip */
+
+	uint8_t buf[sizeof(gzip_header_t)];  /**< Buffer of fixed fields */
+	size_t buffered;          /**< Number of bytes in the buffer */
+
+	inflate_stream_t *inflate;  /**< Inflate stream */
+	uint32_t crc32;           /**< CRC of the decompressed data */
+	uint32_t size;            /**< Size of the decompressed data */
+	errno_t error;            /**< Sticky decoding error */
+};
+
+/** GZIP encoder state
+ *
+ */
+struct gzip_compressor {
+	deflate_stream_t *deflate;  /**< Deflate stream */
+	unsigned int level;         /**< Compression level */
+
+	uint8_t buf[sizeof(gzip_header_t)];  /**< Header or footer to write */
+	size_t buffered;          /**< Number of bytes in the buffer */
+	size_t written;           /**< Number of bytes written from the buffer */
+	bool finished;            /**< The footer has been queued */
+
+	uint32_t crc32;           /**< CRC of the uncompressed data */
+	uint32_t size;            /**< Size of the uncompressed data */
+};
+
+/** Gather fixed size field from the input
+ *
+ * @param stream GZIP stream.
+ * @param src    Source data buffer.
+ * @param srclen Source buffer size (bytes).
+ * @param srccnt Position in the source buffer.
+ * @param size   Size of the field.
+ *
+ * @return True if the field is complete in the buffer.
+ *
+ */
+static bool gzip_gather(gzip_stream_t *stream, const uint8_t *src,
+    size_t srclen, size_t *srccnt, size_t size)
+{
+	size_t cnt = size - stream->buffered;
+	if (cnt > srclen - *srccnt)
+		cnt = srclen - *srccnt;
+
+	memcpy(stream->buf + stream->buffered, src + *srccnt, cnt);
+	stream->buffered += cnt;
+	*srccnt += cnt;
+
+	if (stream->buffered < size)
+		return false;
+
+	stream->buffered = 0;
+	return true;
+}
+
+/** Skip zero-terminated field in the input
+ *
+ * @param src    Source data buffer.
+ * @param srclen Source buffer size (bytes).
+ * @param srccnt Position in the source buffer.
+ *
+ * @return True if the end of the field has been reached.
+ *
+ */
+static bool gzip_skip_string(const uint8_t *src, size_t srclen,
+    size_t *srccnt)
+{
+	while (*srccnt < srclen) {
+		uint8_t c = src[*srccnt];
+		(*srccnt)++;
+
+		if (c == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/** Determine the next header field to process
+ *
+ * @param stream GZIP stream.
+ *
+ */
+static void gzip_next_field(gzip_stream_t *stream)
+{
+	if ((stream->flags & GZIP_FLAG_FEXTRA) != 0)
+		stream->state = GZIP_EXTRA_LEN;
+	else if ((stream->flags & GZIP_FLAG_FNAME) != 0)
+		stream->state = GZIP_NAME;
+	else if ((stream->flags & GZIP_FLAG_FCOMMENT) != 0)
+		stream->state = GZIP_COMMENT;
+	else if ((stream->flags & GZIP_FLAG_FHCRC) != 0)
+		stream->state = GZIP_HCRC;
+	else
+		stream->state = GZIP_DATA;
+}
+
+/** Check the fixed part of the header
+ *
+ * @param stream GZIP stream.
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid compression method or invalid stream.
+ *
+ */
+static errno_t gzip_header_check(gzip_stream_t *stream)
+{
+	gzip_header_t header;
+	memcpy(&header, stream->buf, sizeof(header));
+
+	if ((header.id1 != GZIP_ID1) ||
+	    (header.id2 != GZIP_ID2) ||
+	    (header.method != GZIP_METHOD_DEFLATE) ||
+	    ((header.flags & (~GZIP_FLAGS_MASK)) != 0))
+		return EINVAL;
+
+	stream->flags = header.flags;
+	gzip_next_field(stream);
+
+	return EOK;
+}
+
+/** Expand the compressed data
+ *
+ * @param stream  GZIP stream.
+ * @param src     Source data buffer.
+ * @param srclen  Source buffer size (bytes).
+ * @param srccnt  Position in the source buffer.
+ * @param dest    Destination data buffer.
+ * @param destlen Destination buffer size (bytes).
+ * @param destcnt Position in the destination buffer.
+ *
+ * @return EOK at the end of the compressed data.
+ * @return EAGAIN if more input or more space for the output is needed.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
+ *
+ */
+static errno_t gzip_data(gzip_stream_t *stream, const uint8_t *src,
+    size_t srclen, size_t *srccnt, uint8_t *dest, size_t destlen,
+    size_t *destcnt)
+{
+	size_t used;
+	size_t produced;
+
+	errno_t rc = inflate_stream_process(stream->inflate, src + *srccnt,
+	    srclen - *srccnt, &used, dest + *destcnt, destlen - *destcnt,
+	    &produced);
+
+	stream->crc32 = compute_crc32_seed(dest + *destcnt, produced,
+	    stream->crc32);
+	stream->size += produced;
+
+	*srccnt += used;
+	*destcnt += produced;
+
+	if (rc == EOK)
+		stream->state = GZIP_FOOTER;
+
+	return rc;
+}
+
+/** Check the footer
+ *
+ * @param stream GZIP stream.
+ *
+ * @return EOK on success.
+ * @return EINVAL on checksum or size mismatch.
+ *
+ */
+static errno_t gzip_footer_check(gzip_stream_t *stream)
+{
+	gzip_footer_t footer;
+	memcpy(&footer, stream->buf, sizeof(footer));
+
+	if ((uint32_t_le2host(footer.crc32) != stream->crc32) ||
+	    (uint32_t_le2host(footer.size) != stream->size))
+		return EINVAL;
+
+	stream->state = GZIP_DONE;
+	return EOK;
+}
+
+/** Create GZIP stream
+ *
+ * @param rstream Place to store pointer to the new stream.
+ *
+ * @return EOK on success.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t gzip_stream_create(gzip_stream_t **rstream)
+{
+	gzip_stream_t *stream = malloc(sizeof(gzip_stream_t));
+	if (stream == NULL)
+		return ENOMEM;
+
+	errno_t rc = inflate_stream_create(&stream->inflate);
+	if (rc != EOK) {
+		free(stream);
+		return rc;
+	}
+
+	gzip_stream_reset(stream);
+
+	*rstream = stream;
+	return EOK;
+}
+
+/** Destroy GZIP stream
+ *
+ * @param stream GZIP stream.
+ *
+ */
+void gzip_stream_destroy(gzip_stream_t *stream)
+{
+	inflate_stream_destroy(stream->inflate);
+	free(stream);
+}
+
+/** Reset GZIP stream
+ *
+ * Prepare the stream for decoding a new GZIP stream.
+ *
+ * @param stream GZIP stream.
+ *
+ */
+void gzip_stream_reset(gzip_stream_t *stream)
+{
+	stream->state = GZIP_HEADER;
+	stream->flags = 0;
+	stream->skip = 0;
+	stream->buffered = 0;
+	stream->crc32 = 0;
+	stream->size = 0;
+	stream->error = EOK;
+
+	inflate_stream_reset(stream->inflate);
+}
+
+/** Expand a chunk of GZIP compressed data
+ *
+ * Decode as much of the input as possible and write as much
+ * of the decompressed data to the destination buffer as possible.
+ * Input which was not consumed (as indicated by @a srcused) needs
+ * to be passed again in the next call, together with more input.
+ * The CRC and the size of the decompressed data are verified
+ * against the footer. Errors other than EAGAIN are returned by
+ * all subsequent calls until the stream is reset.
+ *
+ * @param[in]  stream   GZIP stream.
+ * @param[in]  src      Source data buffer.
+ * @param[in]  srclen   Source buffer size (bytes).
+ * @param[out] srcused  Number of source bytes consumed.
+ * @param[in]  dest     Destination data buffer.
+ * @param[in]  destlen  Destination buffer size (bytes).
+ * @param[out] destused Number of bytes written to the destination buffer.
+ *
+ * @return EOK if the end of the GZIP stream has been reached
+ *         and all the decompressed data have been written.
+ * @return EAGAIN if more input or more space for the output is needed.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code, invalid deflate data,
+ *                invalid compression method, invalid stream
+ *                or checksum mismatch.
+ *
+ */
+errno_t gzip_stream_process(gzip_stream_t *stream, const void *src,
+    size_t srclen, size_t *srcused, void *dest, size_t destlen,
+    size_t *destused)
+{
+	const uint8_t *in = (const uint8_t *) src;
+	uint8_t *out = (uint8_t *) dest;
+	size_t incnt = 0;
+	size_t outcnt = 0;
+	errno_t rc = stream->error;
+
+	while ((rc == EOK) && (stream->state != GZIP_DONE)) {
+		switch (stream->state) {
+		case GZIP_HEADER:
+			if (!gzip_gather(stream, in, srclen, &incnt,
+			    sizeof(gzip_header_t))) {
+				rc = EAGAIN;
+				break;
+			}
+
+			rc = gzip_header_check(stream);
+			break;
+		case GZIP_EXTRA_LEN:
+			if (!gzip_gather(stream, in, srclen, &incnt,
+			    sizeof(uint16_t))) {
+				rc = EAGAIN;
+				break;
+			}
+
+			stream->skip = stream->buf[0] | (stream->buf[1] << 8);
+			stream->state = GZIP_EXTRA;
+			break;
+		case GZIP_EXTRA:
+			if (stream->skip > srclen - incnt) {
+				stream->skip -= srclen - incnt;
+				incnt = srclen;
+				rc = EAGAIN;
+				break;
+			}
+
+			incnt += stream->skip;
+			stream->skip = 0;
+			stream->flags &= ~GZIP_FLAG_FEXTRA;
+			gzip_next_field(stream);
+			break;
+		case GZIP_NAME:
+			if (!gzip_skip_string(in, srclen, &incnt)) {
+				rc = EAGAIN;
+				break;
+			}
+
+			stream->flags &= ~GZIP_FLAG_FNAME;
+			gzip_next_field(stream);
+			break;
+		case GZIP_COMMENT:
+			if (!gzip_skip_string(in, srclen, &incnt)) {
+				rc = EAGAIN;
+				break;
+			}
+
+			stream->flags &= ~GZIP_FLAG_FCOMMENT;
+			gzip_next_field(stream);
+			break;
+		case GZIP_HCRC:
+			if (!gzip_gather(stream, in, srclen, &incnt,
+			    sizeof(uint16_t))) {
+				rc = EAGAIN;
+				break;
+			}
+
+			stream->flags &= ~GZIP_FLAG_FHCRC;
+			gzip_next_field(stream);
+			break;
+		case GZIP_DATA:
+			rc = gzip_data(stream, in, srclen, &incnt, out, destlen,
+			    &outcnt);
+			break;
+		case GZIP_FOOTER:
+			if (!gzip_gather(stream, in, srclen, &incnt,
+			    sizeof(gzip_footer_t))) {
+				rc = EAGAIN;
+				break;
+			}
+
+			rc = gzip_footer_check(stream);
+			break;
+		case GZIP_DONE:
+			break;
+		}
+	}
+
+	/* Once the stream is found to be corrupted it stays corrupted */
+	if ((rc != EOK) && (rc != EAGAIN))
+		stream->error = rc;
+
+	*srcused = incnt;
+	*destused = outcnt;
+
+	return rc;
+}
+
 /** Expand GZIP compressed data
  *
  * The routine allocates the output buffer based
@@ -69,7 +475,8 @@ typedef struct {
  * data to 4 GiB (expanding input streams that actually
  * encode more data will always fail).
  *
- * So far, no CRC is perfomed.
+ * Use gzip_stream_process() to expand data of
+ * arbitrary size in chunks.
  *
  * @param[in]  src     Source data buffer.
  * @param[in]  srclen  Source buffer size (bytes).
@@ -79,105 +486,255 @@ typedef struct {
  * @return EOK on success.
  * @return ENOENT on distance too large.
  * @return EINVAL on invalid Huffman code, invalid deflate data,
- *                   invalid compression method or invalid stream.
- * @return ELIMIT on input buffer overrun.
+ *                   invalid compression method, invalid or truncated
+ *                   stream or checksum mismatch.
  * @return ENOMEM on output buffer overrun.
  *
  */
 errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
 {
-	gzip_header_t header;
 	gzip_footer_t footer;
 
-	if ((srclen < sizeof(header)) || (srclen < sizeof(footer)))
+	if ((srclen < sizeof(gzip_header_t)) || (srclen < sizeof(footer)))
 		return EINVAL;
 
-	/* Decode header and footer */
-
-	memcpy(&header, src, sizeof(header));
+	/* Decode the size of the uncompressed data from the footer */
 	memcpy(&footer, src + srclen - sizeof(footer), sizeof(footer));
+	size_t size = uint32_t_le2host(footer.size);
 
-	if ((header.id1 != GZIP_ID1) ||
-	    (header.id2 != GZIP_ID2) ||
-	    (header.method != GZIP_METHOD_DEFLATE) ||
-	    ((header.flags & (~GZIP_FLAGS_MASK)) != 0))
-		return EINVAL;
-
-	*destlen = uint32_t_le2host(footer.size);
+	gzip_stream_t *stream;
+	errno_t ret = gzip_stream_create(&stream);
+	if (ret != EOK)
+		return ret;
 
-	/* Ignore extra metadata */
+	/* Allocate output buffer and inflate the data */
+	void *data = malloc(size > 0 ? size : 1);
+	if (data == NULL) {
+		gzip_stream_destroy(stream);
+		return ENOMEM;
+	}
 
-	void *stream = src + sizeof(header);
-	size_t stream_length = srclen - sizeof(header) - sizeof(footer);
+	size_t srcused;
+	size_t destused;
+	ret = gzip_stream_process(stream, src, srclen, &srcused, data, size,
+	    &destused);
+	/* Running out of the complete input means the stream is truncated */
+	if (ret == EAGAIN)
+		ret = (destused == size) ? ENOMEM : EINVAL;
 
-	if ((header.flags & GZIP_FLAG_FEXTRA) != 0) {
-		uint16_t extra_length;
+	gzip_stream_destroy(stream);
 
-		if (stream_length < sizeof(extra_length))
-			return EINVAL;
+	if (ret != EOK) {
+		free(data);
+		return ret;
+	}
 
-		memcpy(&extra_length, stream, sizeof(extra_length));
-		stream += sizeof(extra_length);
-		stream_length -= sizeof(extra_length);
+	*dest = data;
+	*destlen = size;
+	return EOK;
+}
 
-		if (stream_length < extra_length)
-			return EINVAL;
+/** Create GZIP compressor
+ *
+ * @param level       Compression level (0 to DEFLATE_LEVEL_MAX).
+ * @param rcompressor Place to store pointer to the new compressor.
+ *
+ * @return EOK on success.
+ * @return EINVAL if the compression level is not valid.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t gzip_compressor_create(unsigned int level,
+    gzip_compressor_t **rcompressor)
+{
+	gzip_compressor_t *compressor = malloc(sizeof(gzip_compressor_t));
+	if (compressor == NULL)
+		return ENOMEM;
 
-		stream += extra_length;
-		stream_length -= extra_length;
+	errno_t rc = deflate_stream_create(level, &compressor->deflate);
+	if (rc != EOK) {
+		free(compressor);
+		return rc;
 	}
 
-	if ((header.flags & GZIP_FLAG_FNAME) != 0) {
-		while (*((uint8_t *) stream) != 0) {
-			if (stream_length == 0)
-				return EINVAL;
+	compressor->level = level;
+	gzip_compressor_reset(compressor);
 
-			stream++;
-			stream_length--;
-		}
+	*rcompressor = compressor;
+	return EOK;
+}
 
-		if (stream_length == 0)
-			return EINVAL;
+/** Destroy GZIP compressor
+ *
+ * @param compressor GZIP compressor.
+ *
+ */
+void gzip_compressor_destroy(gzip_compressor_t *compressor)
+{
+	deflate_stream_destroy(compressor->deflate);
+	free(compressor);
+}
 
-		stream++;
-		stream_length--;
-	}
+/** Reset GZIP compressor
+ *
+ * Prepare the compressor for encoding a new GZIP stream.
+ *
+ * @param compressor GZIP compressor.
+ *
+ */
+void gzip_compressor_reset(gzip_compressor_t *compressor)
+{
+	gzip_header_t header;
 
-	if ((header.flags & GZIP_FLAG_FCOMMENT) != 0) {
-		while (*((uint8_t *) stream) != 0) {
-			if (stream_length == 0)
-				return EINVAL;
+	header.id1 = GZIP_ID1;
+	header.id2 = GZIP_ID2;
+	header.method = GZIP_METHOD_DEFLATE;
+	header.flags = 0;
+	header.mtime = 0;
+	header.os = GZIP_OS_UNKNOWN;
+
+	if (compressor->level == DEFLATE_LEVEL_MAX)
+		header.extra_flags = GZIP_XFL_BEST;
+	else if (compressor->level <= DEFLATE_LEVEL_FAST)
+		header.extra_flags = GZIP_XFL_FAST;
+	else
+		header.extra_flags = 0;
+
+	memcpy(compressor->buf, &header, sizeof(header));
+	compressor->buffered = sizeof(header);
+	compressor->written = 0;
+	compressor->finished = false;
+	compressor->crc32 = 0;
+	compressor->size = 0;
+
+	deflate_stream_reset(compressor->deflate);
+}
 
-			stream++;
-			stream_length--;
+/** Compress a chunk of data into a GZIP stream
+ *
+ * The semantics of the arguments and the return values follow
+ * deflate_stream_process(). The GZIP footer is written when
+ * the stream is finished using DEFLATE_FINISH.
+ *
+ * @param compressor GZIP compressor.
+ * @param src        Source data buffer.
+ * @param srclen     Source buffer size (bytes).
+ * @param srcused    Place to store the number of source bytes consumed.
+ * @param dest       Destination data buffer.
+ * @param destlen    Destination buffer size (bytes).
+ * @param destused   Place to store the number of bytes written.
+ * @param flush      Flush mode.
+ *
+ * @return EOK if all the input has been consumed and the requested
+ *         flush is complete.
+ * @return EAGAIN if more output space is needed.
+ *
+ */
+errno_t gzip_compressor_process(gzip_compressor_t *compressor,
+    const void *src, size_t srclen, size_t *srcused, void *dest,
+    size_t destlen, size_t *destused, deflate_flush_t flush)
+{
+	const uint8_t *input = (const uint8_t *) src;
+	uint8_t *output = (uint8_t *) dest;
+	size_t incnt = 0;
+	size_t outcnt = 0;
+	errno_t rc;
+
+	while (true) {
+		/* Write the header or the footer */
+		size_t cnt = compressor->buffered - compressor->written;
+		if (cnt > destlen - outcnt)
+			cnt = destlen - outcnt;
+
+		memcpy(output + outcnt, compressor->buf + compressor->written,
+		    cnt);
+		compressor->written += cnt;
+		outcnt += cnt;
+
+		if (compressor->written < compressor->buffered) {
+			rc = EAGAIN;
+			break;
 		}
 
-		if (stream_length == 0)
-			return EINVAL;
+		if (compressor->finished) {
+			rc = EOK;
+			break;
+		}
 
-		stream++;
-		stream_length--;
-	}
+		size_t used;
+		rc = deflate_stream_process(compressor->deflate, input + incnt,
+		    srclen - incnt, &used, output + outcnt, destlen - outcnt,
+		    &cnt, flush);
+
+		compressor->crc32 = compute_crc32_seed((uint8_t *) input + incnt,
+		    used, compressor->crc32);
+		compressor->size += used;
+		incnt += used;
+		outcnt += cnt;
 
-	if ((header.flags & GZIP_FLAG_FHCRC) != 0) {
-		if (stream_length < 2)
-			return EINVAL;
+		if ((rc != EOK) || (flush != DEFLATE_FINISH))
+			break;
 
-		stream += 2;
-		stream_length -= 2;
+		gzip_footer_t footer;
+		footer.crc32 = host2uint32_t_le(compressor->crc32);
+		footer.size = host2uint32_t_le(compressor->size);
+
+		memcpy(compressor->buf, &footer, sizeof(footer));
+		compressor->buffered = sizeof(footer);
+		compressor->written = 0;
+		compressor->finished = true;
 	}
 
-	/* Allocate output buffer and inflate the data */
+	*srcused = incnt;
+	*destused = outcnt;
+	return rc;
+}
+
+/** Compress data into a GZIP stream
+ *
+ * The routine allocates the output buffer.
+ *
+ * @param[in]  src     Source data buffer.
+ * @param[in]  srclen  Source buffer size (bytes).
+ * @param[in]  level   Compression level (0 to DEFLATE_LEVEL_MAX).
+ * @param[out] dest    Destination data buffer.
+ * @param[out] destlen Destination buffer size (bytes).
+ *
+ * @return EOK on success.
+ * @return EINVAL if the compression level is not valid.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t gzip_compress(const void *src, size_t srclen, unsigned int level,
+    void **dest, size_t *destlen)
+{
+	gzip_compressor_t *compressor;
+	errno_t rc = gzip_compressor_create(level, &compressor);
+	if (rc != EOK)
+		return rc;
 
-	*dest = malloc(*destlen);
-	if (*dest == NULL)
+	size_t size = sizeof(gzip_header_t) + deflate_bound(srclen) +
+	    sizeof(gzip_footer_t);
+
+	void *data = malloc(size);
+	if (data == NULL) {
+		gzip_compressor_destroy(compressor);
 		return ENOMEM;
+	}
 
-	errno_t ret = inflate(stream, stream_length, *dest, *destlen);
-	if (ret != EOK) {
-		free(dest);
-		return ret;
+	size_t srcused;
+	size_t destused;
+	rc = gzip_compressor_process(compressor, src, srclen, &srcused, data,
+	    size, &destused, DEFLATE_FINISH);
+
+	gzip_compressor_destroy(compressor);
+
+	if (rc != EOK) {
+		free(data);
+		return (rc == EAGAIN) ? ENOMEM : rc;
 	}
 
+	*dest = data;
+	*destlen = destused;
 	return EOK;
 }
@@ -29,8 +29,28 @@
 #ifndef LIBCOMPRESS_GZIP_H_
 #define LIBCOMPRESS_GZIP_H_
 
+#include <errno.h>
 #include <stddef.h>
+#include "deflate.h"
+
+typedef struct gzip_stream gzip_stream_t;
+typedef struct gzip_compressor gzip_compressor_t;
 
 extern errno_t gzip_expand(void *, size_t, void **, size_t *);
 
+extern errno_t gzip_stream_create(gzip_stream_t **);
+extern void gzip_stream_destroy(gzip_stream_t *);
+extern void gzip_stream_reset(gzip_stream_t *);
+extern errno_t gzip_stream_process(gzip_stream_t *, const void *, size_t,
+    size_t *, void *, size_t, size_t *);
+
+extern errno_t gzip_compress(const void *, size_t, unsigned int, void **,
+    size_t *);
+
+extern errno_t gzip_compressor_create(unsigned int, gzip_compressor_t **);
+extern void gzip_compressor_destroy(gzip_compressor_t *);
+extern void gzip_compressor_reset(gzip_compressor_t *);
+extern errno_t gzip_compressor_process(gzip_compressor_t *, const void *,
+    size_t, size_t *, void *, size_t, size_t *, deflate_flush_t);
+
 #endif
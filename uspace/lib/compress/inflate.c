@@ -30,12 +30,16 @@
 /** @file
  * @brief Implementation of inflate decompression
  *
- * A simple inflate implementation (decompression of `deflate' stream as
- * described by RFC 1951) based on puff.c by Mark Adler. This code is
- * currently not optimized for speed but for readability.
+ * An inflate implementation (decompression of `deflate' stream as
+ * described by RFC 1951) originally based on puff.c by Mark Adler.
  *
- * All dynamically allocated memory memory is taken from the stack. The
- * stack usage should be typically bounded by 2 KB.
+ * Huffman codes are decoded using two-level lookup tables indexed
+ * by the next bits of the input, which is consumed through a 64-bit
+ * bit buffer. The decoder is a resumable state machine: the input can
+ * be fed and the output drained in chunks of arbitrary size, the
+ * decoded data pass through a sliding window which also serves as
+ * the history for back references. The memory usage is therefore
+ * bounded independently of the size of the data.
  *
  * Original copyright notice:
  *
@@ -63,11 +67,15 @@
  *
  */
 
+
+#include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <mem.h>
+#include <byteorder.h>
 #include "inflate.h"
 
 /** Maximum bits in the Huffman code */
@@ -83,42 +91,137 @@
 #define MAX_LITLEN        286
 /** Number of fixed literal/length codes */
 #define MAX_FIXED_LITLEN  288
+/** Number of fixed distance codes */
+#define MAX_FIXED_DIST    32
 
 /** Number of all codes */
 #define MAX_CODE  (MAX_LITLEN + MAX_DIST)
 
-/** Check for input buffer overrun condition */
-#define CHECK_OVERRUN(state) \
-	do { \
-		if ((state).overrun) \
-			return ELIMIT; \
-	} while (false)
+/** Maximal length of a match */
+#define MAX_MATCH  258
 
-/** Inflate algorithm state
+/** Maximal distance of a match */
+#define MAX_DISTANCE  32768
+
+/** Bits resolved by the first level of the literal/length table */
+#define LEN_ROOT_BITS    9
+/** Bits resolved by the first level of the distance table */
+#define DIST_ROOT_BITS   6
+/** Bits resolved by the code length code table */
+#define ORDER_ROOT_BITS  7
+
+/*
+ * Upper bounds of the size of the lookup tables (first level and all
+ * second level tables) for the root sizes above and any permitted code,
+ * as computed by the enough utility of zlib.
+ */
+
+/** Size of the literal/length lookup table */
+#define LEN_TABLE_SIZE   852
+/** Size of the distance lookup table */
+#define DIST_TABLE_SIZE  592
+
+/** Size of the sliding window (must be a power of two) */
+#define WINDOW_SIZE  65536
+#define WINDOW_MASK  (WINDOW_SIZE - 1)
+
+/** Minimal number of bits needed to decode a literal/length and distance */
+#define MAX_SYMBOL_BITS  48
+
+/** Type of the lookup table entry */
+typedef enum {
+	/** Entry decodes a symbol */
+	HUFFMAN_SYMBOL,
+	/** Entry points to a second level table */
+	HUFFMAN_LINK,
+	/** Entry does not correspond to any valid code */
+	HUFFMAN_INVALID
+} huffman_op_t;
+
+/** Huffman lookup table entry
  *
  */
 typedef struct {
-	uint8_t *dest;    /**< Output buffer */
-	size_t destlen;   /**< Output buffer size */
-	size_t destcnt;   /**< Position in the output buffer */
-
-	uint8_t *src;     /**< Input buffer */
-	size_t srclen;    /**< Input buffer size */
-	size_t srccnt;    /**< Position in the input buffer */
+	/** Decoded symbol or offset of the second level table */
+	uint16_t value;
+	/** Bits of the code in this level or index bits of the second level */
+	uint8_t bits;
+	/** Entry type (huffman_op_t) */
+	uint8_t op;
+} huffman_entry_t;
+
+/** Decoder state
+ *
+ */
+typedef enum {
+	/** Block header */
+	INFLATE_HEADER,
+	/** Length of a `stored' block */
+	INFLATE_STORED_LEN,
+	/** Data of a `stored' block */
+	INFLATE_STORED,
+	/** Table sizes of a `dynamic codes' block */
+	INFLATE_TABLE_SIZES,
+	/** Code length code lengths of a `dynamic codes' block */
+	INFLATE_TABLE_ORDER,
+	/** Literal/length and distance code lengths */
+	INFLATE_TABLE_LENGTHS,
+	/** Compressed data of a `fixed' or `dynamic codes' block */
+	INFLATE_CODES,
+	/** End of the last block was reached */
+	INFLATE_DONE
+} inflate_mode_t;
+
+/** Input bit reader
+ *
+ */
+typedef struct {
+	const uint8_t *src;  /**< Input buffer */
+	size_t srclen;       /**< Input buffer size */
+	size_t srccnt;       /**< Position in the input buffer */
 
-	uint16_t bitbuf;  /**< Bit buffer */
-	size_t bitlen;    /**< Number of bits in the bit buffer */
+	uint64_t bitbuf;     /**< Bit buffer */
+	unsigned int bitlen; /**< Number of bits in the bit buffer */
 
-	bool overrun;     /**< Overrun condition */
-} inflate_state_t;
+	/** Input was exhausted before enough bits could be loaded */
+	bool starved;
+} bit_reader_t;
 
-/** Huffman code description
+/** Inflate algorithm state
  *
  */
-typedef struct {
-	uint16_t *count;   /**< Array of symbol counts */
-	uint16_t *symbol;  /**< Array of symbols */
-} huffman_t;
+struct inflate_stream {
+	inflate_mode_t mode;  /**< Decoder state */
+	errno_t error;        /**< Sticky decoding error */
+	bool last;            /**< Current block is the last one */
+
+	bit_reader_t in;      /**< Input bit reader */
+
+	size_t stored_left;   /**< Bytes left in the `stored' block */
+
+	uint16_t nlen;        /**< Number of literal/length codes */
+	uint16_t ndist;       /**< Number of distance codes */
+	uint16_t ncode;       /**< Number of code length codes */
+	uint16_t index;       /**< Number of code lengths read so far */
+	uint16_t length[MAX_CODE];  /**< Code lengths */
+
+	/** The lookup tables currently hold the fixed codes */
+	bool fixed;
+
+	/** Literal/length (or code length) code lookup table */
+	huffman_entry_t len_table[LEN_TABLE_SIZE];
+	/** Distance code lookup table */
+	huffman_entry_t dist_table[DIST_TABLE_SIZE];
+
+	/** Sliding window */
+	uint8_t window[WINDOW_SIZE];
+	/** Number of bytes written to the window (modulo size_t) */
+	size_t wpos;
+	/** Number of bytes drained from the window (modulo size_t) */
+	size_t rpos;
+	/** Number of valid bytes of history (up to MAX_DISTANCE) */
+	size_t whave;
+};
 
 /** Length codes
  *
@@ -161,514 +264,1085 @@ static const short order[MAX_ORDER] = {
 	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
 };
 
-/** Static length symbol counts
+/** Refill the bit buffer
+ *
+ * Load as many bytes from the input as fit into the bit buffer.
+ * If enough input is available, a single unaligned load is used,
+ * in which case the bits above the bit count are not necessarily
+ * zero, but they always equal the next bits of the input.
+ *
+ * @param in Bit reader.
  *
  */
-static uint16_t len_count[MAX_HUFFMAN_BIT + 1] = {
-	0, 0, 0, 0, 0, 0, 0, 24, 152, 112, 0, 0, 0, 0, 0, 0
-};
+static inline void bits_refill(bit_reader_t *in)
+{
+	if (in->srclen - in->srccnt >= sizeof(uint64_t)) {
+		uint64_t val;
+		memcpy(&val, in->src + in->srccnt, sizeof(val));
+
+		in->bitbuf |= uint64_t_le2host(val) << in->bitlen;
+		in->srccnt += (63 - in->bitlen) >> 3;
+		in->bitlen |= 56;
+		return;
+	}
 
-/** Static length symbols
- *
- */
-static uint16_t len_symbol[MAX_FIXED_LITLEN] = {
-	256, 257, 258, 259, 260, 261, 262, 263, 264, 265, 266, 267, 268,
-	269, 270, 271, 272, 273, 274, 275, 276, 277, 278, 279, 0, 1, 2,
-	3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
-	21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36,
-	37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52,
-	53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68,
-	69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84,
-	85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100,
-	101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113,
-	114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126,
-	127, 128, 129, 130, 131, 132, 133, 134, 135, 136, 137, 138, 139,
-	140, 141, 142, 143, 280, 281, 282, 283, 284, 285, 286, 287, 144,
-	145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155, 156, 157,
-	158, 159, 160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170,
-	171, 172, 173, 174, 175, 176, 177, 178, 179, 180, 181, 182, 183,
-	184, 185, 186, 187, 188, 189, 190, 191, 192, 193, 194, 195, 196,
-	197, 198, 199, 200, 201, 202, 203, 204, 205, 206, 207, 208, 209,
-	210, 211, 212, 213, 214, 215, 216, 217, 218, 219, 220, 221, 222,
-	223, 224, 225, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235,
-	236, 237, 238, 239, 240, 241, 242, 243, 244, 245, 246, 247, 248,
-	249, 250, 251, 252, 253, 254, 255
-};
+	while ((in->bitlen < 56) && (in->srccnt < in->srclen)) {
+		in->bitbuf |= ((uint64_t) in->src[in->srccnt]) << in->bitlen;
+		in->srccnt++;
+		in->bitlen += 8;
+	}
+}
 
-/** Static distance symbol counts
+/** Peek at the bits in the bit buffer
+ *
+ * @param in  Bit reader.
+ * @param cnt Number of bits to return (at most 32).
+ *
+ * @return Next bits of the input.
  *
  */
-static uint16_t dist_count[MAX_HUFFMAN_BIT + 1] = {
-	0, 0, 0, 0, 0, 30, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-};
+static inline uint32_t bits_peek(bit_reader_t *in, unsigned int cnt)
+{
+	return (uint32_t) (in->bitbuf & ((UINT64_C(1) << cnt) - 1));
+}
 
-/** Static distance symbols
+/** Drop bits from the bit buffer
+ *
+ * @param in  Bit reader.
+ * @param cnt Number of bits to drop (at most the number of bits
+ *            in the bit buffer).
  *
  */
-static uint16_t dist_symbol[MAX_DIST] = {
-	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
-	16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29
-};
+static inline void bits_drop(bit_reader_t *in, unsigned int cnt)
+{
+	in->bitbuf >>= cnt;
+	in->bitlen -= cnt;
+}
 
-/** Huffman code for lengths
+/** Make sure there are enough bits in the bit buffer
+ *
+ * @param in  Bit reader.
+ * @param cnt Number of bits needed.
+ *
+ * @return True if the bits are available.
  *
  */
-static huffman_t len_code = {
-	.count = len_count,
-	.symbol = len_symbol
-};
+static inline bool bits_need(bit_reader_t *in, unsigned int cnt)
+{
+	if (in->bitlen < cnt)
+		bits_refill(in);
+
+	return (in->bitlen >= cnt);
+}
 
-/** Huffman code for distances
+/** Report lack of input
+ *
+ * The bits in the bit buffer are all part of the element being
+ * decoded, therefore they have to be kept until more input arrives.
+ *
+ * @param in Bit reader.
+ *
+ * @return EAGAIN.
  *
  */
-static huffman_t dist_code = {
-	.count = dist_count,
-	.symbol = dist_symbol
-};
+static inline errno_t bits_starved(bit_reader_t *in)
+{
+	in->starved = true;
+	return EAGAIN;
+}
 
-/** Get bits from the bit buffer
+/** Reverse the bits of a code
  *
- * @param state Inflate state.
- * @param cnt   Number of bits to return (at most 16).
+ * @param code Code.
+ * @param len  Length of the code.
  *
- * @return Returned bits.
+ * @return Code with the order of the bits reversed.
  *
  */
-static inline uint16_t get_bits(inflate_state_t *state, size_t cnt)
+static uint32_t bits_reverse(uint32_t code, unsigned int len)
 {
-	/* Bit accumulator for at least 20 bits */
-	uint32_t val = state->bitbuf;
-
-	while (state->bitlen < cnt) {
-		if (state->srccnt == state->srclen) {
-			state->overrun = true;
-			return 0;
-		}
+	uint32_t rev = 0;
 
-		/* Load 8 more bits */
-		val |= ((uint32_t) state->src[state->srccnt]) << state->bitlen;
-		state->srccnt++;
-		state->bitlen += 8;
+	while (len > 0) {
+		rev = (rev << 1) | (code & 1);
+		code >>= 1;
+		len--;
 	}
 
-	/* Update bits in the buffer */
-	state->bitbuf = (uint16_t) (val >> cnt);
-	state->bitlen -= cnt;
-
-	return ((uint16_t) (val & ((1 << cnt) - 1)));
+	return rev;
 }
 
-/** Decode `stored' block
+/** Construct Huffman lookup table from canonical Huffman code
  *
- * @param state Inflate state.
+ * The first level of the table is indexed by the next @a root bits
+ * of the input. Codes longer than @a root bits continue in second
+ * level tables which are placed after the first level and which are
+ * just large enough to hold all the codes sharing the prefix.
+ *
+ * @param table    Lookup table.
+ * @param size     Capacity of the lookup table (entries).
+ * @param root     Number of bits resolved by the first level.
+ * @param length   Lengths of the canonical Huffman code.
+ * @param n        Number of lengths.
+ * @param complete Only accept a complete code (otherwise an incomplete
+ *                 code with a single symbol is permitted).
  *
  * @return EOK on success.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
- * @return EINVAL on invalid data.
+ * @return EINVAL on an over-subscribed or incomplete code.
  *
  */
-static errno_t inflate_stored(inflate_state_t *state)
+static errno_t huffman_construct(huffman_entry_t *table, size_t size,
+    unsigned int root, const uint16_t *length, size_t n, bool complete)
 {
-	/* Discard bits in the bit buffer */
-	state->bitbuf = 0;
-	state->bitlen = 0;
+	uint16_t count[MAX_HUFFMAN_BIT + 1];
+	uint16_t offs[MAX_HUFFMAN_BIT + 1];
+	uint16_t sorted[MAX_FIXED_LITLEN];
 
-	if (state->srccnt + 4 > state->srclen)
-		return ELIMIT;
+	/* Count number of codes for each length */
+	size_t len;
+	for (len = 0; len <= MAX_HUFFMAN_BIT; len++)
+		count[len] = 0;
 
-	uint16_t len =
-	    state->src[state->srccnt] | (state->src[state->srccnt + 1] << 8);
-	uint16_t len_compl =
-	    state->src[state->srccnt + 2] | (state->src[state->srccnt + 3] << 8);
+	/* We assume that the lengths are within bounds */
+	size_t symbol;
+	for (symbol = 0; symbol < n; symbol++)
+		count[length[symbol]]++;
 
-	/* Check block length and its complement */
-	if (((int16_t) len) != ~((int16_t) len_compl))
+	const size_t root_size = ((size_t) 1) << root;
+	const huffman_entry_t invalid = {
+		.value = 0,
+		.bits = 0,
+		.op = HUFFMAN_INVALID
+	};
+
+	size_t index;
+	for (index = 0; index < root_size; index++)
+		table[index] = invalid;
+
+	if (count[0] == n) {
+		/* The code is complete, but decoding will fail */
+		return EOK;
+	}
+
+	/* Check for an over-subscribed or incomplete set of lengths */
+	int left = 1;
+	for (len = 1; len <= MAX_HUFFMAN_BIT; len++) {
+		left <<= 1;
+		left -= count[len];
+		if (left < 0)
+			return EINVAL;
+	}
+
+	if ((left > 0) && ((complete) || (count[0] + 1 != (int) n)))
 		return EINVAL;
 
-	state->srccnt += 4;
+	/* Sort the symbols by the code lengths */
+	offs[1] = 0;
+	for (len = 1; len < MAX_HUFFMAN_BIT; len++)
+		offs[len + 1] = offs[len] + count[len];
+
+	for (symbol = 0; symbol < n; symbol++) {
+		if (length[symbol] != 0) {
+			sorted[offs[length[symbol]]] = symbol;
+			offs[length[symbol]]++;
+		}
+	}
 
-	/* Check input buffer size */
-	if (state->srccnt + len > state->srclen)
-		return ELIMIT;
+	size_t max = MAX_HUFFMAN_BIT;
+	while (count[max] == 0)
+		max--;
 
-	/* Check output buffer size */
-	if (state->destcnt + len > state->destlen)
-		return ENOMEM;
+	/* Codes of each length not yet placed into the table */
+	uint16_t remaining[MAX_HUFFMAN_BIT + 1];
+	memcpy(remaining, count, sizeof(remaining));
 
-	/* Copy data */
-	memcpy(state->dest + state->destcnt, state->src + state->srccnt, len);
-	state->srccnt += len;
-	state->destcnt += len;
+	uint32_t code = 0;
+	uint32_t prefix = UINT32_MAX;
+	size_t next = root_size;
+	size_t sub = 0;
+	unsigned int sub_bits = 0;
+
+	index = 0;
+	for (len = 1; len <= max; len++) {
+		uint16_t i;
+		for (i = 0; i < count[len]; i++) {
+			const huffman_entry_t entry = {
+				.value = sorted[index],
+				.bits = (len <= root) ? len : len - root,
+				.op = HUFFMAN_SYMBOL
+			};
+
+			/* The code is stored least significant bit first */
+			uint32_t rev = bits_reverse(code, len);
+			size_t j;
+
+			if (len <= root) {
+				for (j = rev; j < root_size; j += ((size_t) 1) << len)
+					table[j] = entry;
+			} else {
+				if ((rev & (root_size - 1)) != prefix) {
+					/* Start a new second level table */
+					prefix = rev & (root_size - 1);
+
+					sub_bits = len - root;
+					int avail = 1 << sub_bits;
+					while (sub_bits + root < max) {
+						avail -= remaining[sub_bits + root];
+						if (avail <= 0)
+							break;
+
+						sub_bits++;
+						avail <<= 1;
+					}
+
+					sub = next;
+					next += ((size_t) 1) << sub_bits;
+					if (next > size)
+						return EINVAL;
+
+					table[prefix].value = sub;
+					table[prefix].bits = sub_bits;
+					table[prefix].op = HUFFMAN_LINK;
+
+					for (j = sub; j < next; j++)
+						table[j] = invalid;
+				}
+
+				for (j = rev >> root; j < (((size_t) 1) << sub_bits);
+				    j += ((size_t) 1) << (len - root))
+					table[sub + j] = entry;
+			}
+
+			remaining[len]--;
+			index++;
+			code++;
+		}
+
+		code <<= 1;
+	}
 
 	return EOK;
 }
 
-/** Decode a symbol using the Huffman code
+/** Decode a symbol using the Huffman lookup table
+ *
+ * The bits of the input are only examined, not consumed.
  *
- * @param state   Inflate state.
- * @param huffman Huffman code.
- * @param symbol  Decoded symbol.
+ * @param table  Lookup table.
+ * @param root   Number of bits resolved by the first level.
+ * @param bits   Next bits of the input.
+ * @param symbol Decoded symbol.
  *
- * @param EOK on success.
- * @param EINVAL on invalid Huffman code.
+ * @return Length of the decoded code.
+ * @return 0 on invalid code.
  *
  */
-static errno_t huffman_decode(inflate_state_t *state, huffman_t *huffman,
-    uint16_t *symbol)
+static inline unsigned int huffman_decode(const huffman_entry_t *table,
+    unsigned int root, uint64_t bits, uint16_t *symbol)
 {
-	/* Decode bits */
-	uint16_t code = 0;
+	huffman_entry_t entry = table[bits & ((1 << root) - 1)];
 
-	/* First code of the given length */
-	size_t first = 0;
+	if (entry.op == HUFFMAN_LINK) {
+		size_t index = (bits >> root) & ((1 << entry.bits) - 1);
+		entry = table[entry.value + index];
 
-	/*
-	 * Index of the first code of the given length
-	 * in the symbol table
-	 */
-	size_t index = 0;
+		if (entry.op != HUFFMAN_SYMBOL)
+			return 0;
 
-	/* Current number of bits in the code */
-	size_t len;
+		*symbol = entry.value;
+		return root + entry.bits;
+	}
 
-	for (len = 1; len <= MAX_HUFFMAN_BIT; len++) {
-		/* Get next bit */
-		code |= get_bits(state, 1);
-		CHECK_OVERRUN(*state);
-
-		uint16_t count = huffman->count[len];
-		if (code < first + count) {
-			/* Return decoded symbol */
-			*symbol = huffman->symbol[index + code - first];
-			return EOK;
-		}
+	if (entry.op != HUFFMAN_SYMBOL)
+		return 0;
 
-		/* Update for next length */
-		index += count;
-		first += count;
-		first <<= 1;
-		code <<= 1;
+	*symbol = entry.value;
+	return entry.bits;
+}
+
+/** Classify an unsuccessful attempt to decode a code
+ *
+ * @param in   Bit reader.
+ * @param used Bits preceding the code.
+ * @param bits Length of the code (0 for an invalid code).
+ *
+ * @return EAGAIN if more input is necessary to decode the code.
+ * @return EINVAL on invalid Huffman code.
+ *
+ */
+static inline errno_t huffman_fail(bit_reader_t *in, unsigned int used,
+    unsigned int bits)
+{
+	if (bits == 0) {
+		/* More bits might still lead to a valid code */
+		if (in->bitlen < used + MAX_HUFFMAN_BIT)
+			return bits_starved(in);
+
+		return EINVAL;
 	}
 
-	return EINVAL;
+	return bits_starved(in);
 }
 
-/** Construct Huffman tables from canonical Huffman code
+/** Space available in the sliding window
  *
- * @param huffman Constructed Huffman tables.
- * @param length  Lengths of the canonical Huffman code.
- * @param n       Number of lengths.
+ * @param stream Inflate stream.
  *
- * @return 0 if the Huffman code set is complete.
- * @return Negative value for an over-subscribed code set.
- * @return Positive value for an incomplete code set.
+ * @return Number of bytes which can be written to the window.
  *
  */
-static int16_t huffman_construct(huffman_t *huffman, uint16_t *length, size_t n)
+static inline size_t window_space(inflate_stream_t *stream)
 {
-	/* Count number of codes for each length */
-	size_t len;
-	for (len = 0; len <= MAX_HUFFMAN_BIT; len++)
-		huffman->count[len] = 0;
+	return WINDOW_SIZE - (stream->wpos - stream->rpos);
+}
 
-	/* We assume that the lengths are within bounds */
-	size_t symbol;
-	for (symbol = 0; symbol < n; symbol++)
-		huffman->count[length[symbol]]++;
+/** Copy a match in the sliding window
+ *
+ * @param window Sliding window.
+ * @param wpos   Write position in the window.
+ * @param dist   Distance of the match.
+ * @param len    Length of the match.
+ *
+ */
+static inline void window_copy(uint8_t *window, size_t wpos, size_t dist,
+    size_t len)
+{
+	size_t to = wpos & WINDOW_MASK;
+	size_t from = (wpos - dist) & WINDOW_MASK;
+
+	if ((to + len > WINDOW_SIZE) || (from + len > WINDOW_SIZE)) {
+		/* Slow path: the match wraps around the end of the window */
+		while (len > 0) {
+			window[to] = window[from];
+			to = (to + 1) & WINDOW_MASK;
+			from = (from + 1) & WINDOW_MASK;
+			len--;
+		}
 
-	if (huffman->count[0] == n) {
-		/* The code is complete, but decoding will fail */
-		return 0;
+		return;
 	}
 
-	/* Check for an over-subscribed or incomplete set of lengths */
-	int16_t left = 1;
-	for (len = 1; len <= MAX_HUFFMAN_BIT; len++) {
-		left <<= 1;
-		left -= huffman->count[len];
-		if (left < 0) {
-			/* Over-subscribed */
-			return left;
-		}
+	if ((dist >= len) || (from > to)) {
+		memcpy(window + to, window + from, len);
+		return;
 	}
 
-	/* Generate offsets into symbol table */
-	uint16_t offs[MAX_HUFFMAN_BIT + 1];
+	if (dist == 1) {
+		memset(window + to, window[from], len);
+		return;
+	}
 
-	offs[1] = 0;
-	for (len = 1; len < MAX_HUFFMAN_BIT; len++)
-		offs[len + 1] = offs[len] + huffman->count[len];
+	/* Overlapping match, copy the repeating pattern in pieces */
+	while (len > 0) {
+		size_t piece = (len < dist) ? len : dist;
 
-	for (symbol = 0; symbol < n; symbol++) {
-		if (length[symbol] != 0) {
-			huffman->symbol[offs[length[symbol]]] = symbol;
-			offs[length[symbol]]++;
-		}
+		memcpy(window + to, window + from, piece);
+		to += piece;
+		from += piece;
+		len -= piece;
 	}
+}
+
+/** Drain the decoded data from the sliding window
+ *
+ * @param stream  Inflate stream.
+ * @param dest    Destination buffer.
+ * @param destlen Destination buffer size (bytes).
+ *
+ * @return Number of bytes drained.
+ *
+ */
+static size_t window_drain(inflate_stream_t *stream, uint8_t *dest,
+    size_t destlen)
+{
+	size_t cnt = stream->wpos - stream->rpos;
+	if (cnt > destlen)
+		cnt = destlen;
 
-	return left;
+	size_t from = stream->rpos & WINDOW_MASK;
+	size_t piece = WINDOW_SIZE - from;
+	if (piece > cnt)
+		piece = cnt;
+
+	memcpy(dest, stream->window + from, piece);
+	memcpy(dest + piece, stream->window, cnt - piece);
+
+	stream->rpos += cnt;
+	return cnt;
 }
 
-/** Decode literal/length and distance codes
+/** Finish the current block
  *
- * Decode until end-of-block code.
+ * @param stream Inflate stream.
  *
- * @param state     Inflate state.
- * @param len_code  Huffman code for literal/length.
- * @param dist_code Huffman code for distance.
+ */
+static void inflate_block_done(inflate_stream_t *stream)
+{
+	if (stream->last) {
+		/* Discard the padding of the last byte */
+		bits_drop(&stream->in, stream->in.bitlen & 7);
+		stream->mode = INFLATE_DONE;
+	} else
+		stream->mode = INFLATE_HEADER;
+}
+
+/** Construct the lookup tables of the fixed codes
  *
- * @return EOK on success.
- * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @param stream Inflate stream.
  *
  */
-static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
-    huffman_t *dist_code)
+static void inflate_fixed_tables(inflate_stream_t *stream)
 {
-	uint16_t symbol;
+	if (stream->fixed)
+		return;
 
-	do {
-		errno_t err = huffman_decode(state, len_code, &symbol);
-		if (err != EOK) {
-			/* Error decoding */
-			return err;
-		}
+	size_t symbol;
+	for (symbol = 0; symbol < 144; symbol++)
+		stream->length[symbol] = 8;
 
-		if (symbol < 256) {
-			/* Write out literal */
-			if (state->destcnt == state->destlen)
-				return ENOMEM;
-
-			state->dest[state->destcnt] = (uint8_t) symbol;
-			state->destcnt++;
-		} else if (symbol > 256) {
-			/* Compute length */
-			symbol -= 257;
-			if (symbol >= 29)
-				return EINVAL;
+	for (; symbol < 256; symbol++)
+		stream->length[symbol] = 9;
 
-			size_t len = lens[symbol] + get_bits(state, lens_ext[symbol]);
-			CHECK_OVERRUN(*state);
+	for (; symbol < 280; symbol++)
+		stream->length[symbol] = 7;
 
-			/* Get distance */
-			err = huffman_decode(state, dist_code, &symbol);
-			if (err != EOK)
-				return err;
+	for (; symbol < MAX_FIXED_LITLEN; symbol++)
+		stream->length[symbol] = 8;
 
-			size_t dist = dists[symbol] + get_bits(state, dists_ext[symbol]);
-			if (dist > state->destcnt)
-				return ENOENT;
+	(void) huffman_construct(stream->len_table, LEN_TABLE_SIZE,
+	    LEN_ROOT_BITS, stream->length, MAX_FIXED_LITLEN, true);
 
-			if (state->destcnt + len > state->destlen)
-				return ENOMEM;
+	for (symbol = 0; symbol < MAX_FIXED_DIST; symbol++)
+		stream->length[symbol] = 5;
 
-			while (len > 0) {
-				/* Copy len bytes from distance bytes back */
-				state->dest[state->destcnt] =
-				    state->dest[state->destcnt - dist];
-				state->destcnt++;
-				len--;
-			}
-		}
-	} while (symbol != 256);
+	(void) huffman_construct(stream->dist_table, DIST_TABLE_SIZE,
+	    DIST_ROOT_BITS, stream->length, MAX_FIXED_DIST, true);
+
+	stream->fixed = true;
+}
+
+/** Decode block header
+ *
+ * @param stream Inflate stream.
+ *
+ * @return EOK on success.
+ * @return EAGAIN if more input is needed.
+ * @return EINVAL on invalid block type.
+ *
+ */
+static errno_t inflate_header(inflate_stream_t *stream)
+{
+	if (!bits_need(&stream->in, 3))
+		return bits_starved(&stream->in);
+
+	/* Last block is indicated by a non-zero bit */
+	stream->last = (bits_peek(&stream->in, 1) != 0);
+
+	/* Block type */
+	uint32_t type = bits_peek(&stream->in, 3) >> 1;
+	bits_drop(&stream->in, 3);
+
+	switch (type) {
+	case 0:
+		/* Discard bits up to the byte boundary */
+		bits_drop(&stream->in, stream->in.bitlen & 7);
+		stream->mode = INFLATE_STORED_LEN;
+		break;
+	case 1:
+		inflate_fixed_tables(stream);
+		stream->mode = INFLATE_CODES;
+		break;
+	case 2:
+		stream->mode = INFLATE_TABLE_SIZES;
+		break;
+	default:
+		return EINVAL;
+	}
 
 	return EOK;
 }
 
-/** Decode `fixed codes' block
+/** Decode the length of a `stored' block
  *
- * @param state     Inflate state.
- * @param len_code  Huffman code for literal/length.
- * @param dist_code Huffman code for distance.
+ * @param stream Inflate stream.
  *
  * @return EOK on success.
- * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @return EAGAIN if more input is needed.
+ * @return EINVAL on invalid data.
  *
  */
-static errno_t inflate_fixed(inflate_state_t *state, huffman_t *len_code,
-    huffman_t *dist_code)
+static errno_t inflate_stored_len(inflate_stream_t *stream)
 {
-	return inflate_codes(state, len_code, dist_code);
+	if (!bits_need(&stream->in, 32))
+		return bits_starved(&stream->in);
+
+	uint32_t val = bits_peek(&stream->in, 32);
+	bits_drop(&stream->in, 32);
+
+	uint16_t len = val & 0xffff;
+	uint16_t len_compl = val >> 16;
+
+	/* Check block length and its complement */
+	if ((len ^ len_compl) != 0xffff)
+		return EINVAL;
+
+	stream->stored_left = len;
+	stream->mode = INFLATE_STORED;
+
+	return EOK;
 }
 
-/** Decode `dynamic codes' block
+/** Copy data of a `stored' block
  *
- * @param state     Inflate state.
+ * @param stream Inflate stream.
  *
  * @return EOK on success.
- * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @return EAGAIN if more input or window space is needed.
  *
  */
-static errno_t inflate_dynamic(inflate_state_t *state)
+static errno_t inflate_stored(inflate_stream_t *stream)
 {
-	uint16_t length[MAX_CODE];
-	uint16_t dyn_len_count[MAX_HUFFMAN_BIT + 1];
-	uint16_t dyn_len_symbol[MAX_LITLEN];
-	uint16_t dyn_dist_count[MAX_HUFFMAN_BIT + 1];
-	uint16_t dyn_dist_symbol[MAX_DIST];
-	huffman_t dyn_len_code;
-	huffman_t dyn_dist_code;
+	bit_reader_t *in = &stream->in;
 
-	dyn_len_code.count = dyn_len_count;
-	dyn_len_code.symbol = dyn_len_symbol;
+	while (stream->stored_left > 0) {
+		size_t space = window_space(stream);
+		if (space == 0)
+			return EAGAIN;
 
-	dyn_dist_code.count = dyn_dist_count;
-	dyn_dist_code.symbol = dyn_dist_symbol;
+		size_t to = stream->wpos & WINDOW_MASK;
+		size_t cnt;
 
-	/* Get number of bits in each table */
-	uint16_t nlen = get_bits(state, 5) + 257;
-	CHECK_OVERRUN(*state);
+		if (in->bitlen >= 8) {
+			/* Bytes already loaded into the bit buffer */
+			stream->window[to] = bits_peek(in, 8);
+			bits_drop(in, 8);
+			cnt = 1;
+		} else {
+			cnt = in->srclen - in->srccnt;
+			if (cnt == 0)
+				return bits_starved(in);
+
+			if (cnt > stream->stored_left)
+				cnt = stream->stored_left;
+
+			if (cnt > space)
+				cnt = space;
+
+			if (cnt > WINDOW_SIZE - to)
+				cnt = WINDOW_SIZE - to;
+
+			memcpy(stream->window + to, in->src + in->srccnt, cnt);
+			in->srccnt += cnt;
+
+			/* Bits above the bit count might have been preloaded */
+			in->bitbuf = 0;
+		}
+
+		stream->wpos += cnt;
+		stream->whave += cnt;
+		if (stream->whave > MAX_DISTANCE)
+			stream->whave = MAX_DISTANCE;
+
+		stream->stored_left -= cnt;
+	}
+
+	inflate_block_done(stream);
+	return EOK;
+}
+
+/** Decode table sizes of a `dynamic codes' block
+ *
+ * @param stream Inflate stream.
+ *
+ * @return EOK on success.
+ * @return EAGAIN if more input is needed.
+ * @return EINVAL on invalid data.
+ *
+ */
+static errno_t inflate_table_sizes(inflate_stream_t *stream)
+{
+	if (!bits_need(&stream->in, 14))
+		return bits_starved(&stream->in);
 
-	uint16_t ndist = get_bits(state, 5) + 1;
-	CHECK_OVERRUN(*state);
+	/* Get number of bits in each table */
+	uint32_t val = bits_peek(&stream->in, 14);
+	bits_drop(&stream->in, 14);
 
-	uint16_t ncode = get_bits(state, 4) + 4;
-	CHECK_OVERRUN(*state);
+	stream->nlen = (val & 0x1f) + 257;
+	stream->ndist = ((val >> 5) & 0x1f) + 1;
+	stream->ncode = (val >> 10) + 4;
 
-	if ((nlen > MAX_LITLEN) || (ndist > MAX_DIST) ||
-	    (ncode > MAX_ORDER))
+	if ((stream->nlen > MAX_LITLEN) || (stream->ndist > MAX_DIST) ||
+	    (stream->ncode > MAX_ORDER))
 		return EINVAL;
 
+	stream->index = 0;
+	stream->mode = INFLATE_TABLE_ORDER;
+
+	return EOK;
+}
+
+/** Decode code length code lengths of a `dynamic codes' block
+ *
+ * @param stream Inflate stream.
+ *
+ * @return EOK on success.
+ * @return EAGAIN if more input is needed.
+ * @return EINVAL on invalid code.
+ *
+ */
+static errno_t inflate_table_order(inflate_stream_t *stream)
+{
 	/* Read code length code lengths */
-	uint16_t index;
-	for (index = 0; index < ncode; index++) {
-		length[order[index]] = get_bits(state, 3);
-		CHECK_OVERRUN(*state);
+	while (stream->index < stream->ncode) {
+		if (!bits_need(&stream->in, 3))
+			return bits_starved(&stream->in);
+
+		stream->length[order[stream->index]] = bits_peek(&stream->in, 3);
+		bits_drop(&stream->in, 3);
+		stream->index++;
 	}
 
 	/* Set missing lengths to zero */
-	for (index = ncode; index < MAX_ORDER; index++)
-		length[order[index]] = 0;
+	uint16_t index;
+	for (index = stream->ncode; index < MAX_ORDER; index++)
+		stream->length[order[index]] = 0;
 
 	/* Build Huffman code */
-	int16_t rc = huffman_construct(&dyn_len_code, length, MAX_ORDER);
-	if (rc != 0)
-		return EINVAL;
+	stream->fixed = false;
+	errno_t rc = huffman_construct(stream->len_table, LEN_TABLE_SIZE,
+	    ORDER_ROOT_BITS, stream->length, MAX_ORDER, true);
+	if (rc != EOK)
+		return rc;
+
+	stream->index = 0;
+	stream->mode = INFLATE_TABLE_LENGTHS;
+
+	return EOK;
+}
+
+/** Decode literal/length and distance code lengths
+ *
+ * @param stream Inflate stream.
+ *
+ * @return EOK on success.
+ * @return EAGAIN if more input is needed.
+ * @return EINVAL on invalid code.
+ *
+ */
+static errno_t inflate_table_lengths(inflate_stream_t *stream)
+{
+	bit_reader_t *in = &stream->in;
+	uint16_t total = stream->nlen + stream->ndist;
 
 	/* Read length/literal and distance code length tables */
-	index = 0;
-	while (index < nlen + ndist) {
+	while (stream->index < total) {
+		if (in->bitlen < MAX_HUFFMAN_BIT + 7)
+			bits_refill(in);
+
 		uint16_t symbol;
-		errno_t err = huffman_decode(state, &dyn_len_code, &symbol);
-		if (err != EOK)
-			return EOK;
+		unsigned int used = huffman_decode(stream->len_table,
+		    ORDER_ROOT_BITS, in->bitbuf, &symbol);
+		if ((used == 0) || (used > in->bitlen))
+			return huffman_fail(in, 0, used);
 
 		if (symbol < 16) {
-			length[index] = symbol;
-			index++;
-		} else {
-			uint16_t len = 0;
-
-			if (symbol == 16) {
-				if (index == 0)
-					return EINVAL;
-
-				len = length[index - 1];
-				symbol = get_bits(state, 2) + 3;
-				CHECK_OVERRUN(*state);
-			} else if (symbol == 17) {
-				symbol = get_bits(state, 3) + 3;
-				CHECK_OVERRUN(*state);
-			} else {
-				symbol = get_bits(state, 7) + 11;
-				CHECK_OVERRUN(*state);
-			}
+			bits_drop(in, used);
+			stream->length[stream->index] = symbol;
+			stream->index++;
+			continue;
+		}
+
+		uint16_t len = 0;
+		unsigned int ext;
+		uint16_t base;
 
-			if (index + symbol > nlen + ndist)
+		if (symbol == 16) {
+			if (stream->index == 0)
 				return EINVAL;
 
-			while (symbol > 0) {
-				length[index] = len;
-				index++;
-				symbol--;
-			}
+			len = stream->length[stream->index - 1];
+			ext = 2;
+			base = 3;
+		} else if (symbol == 17) {
+			ext = 3;
+			base = 3;
+		} else {
+			ext = 7;
+			base = 11;
+		}
+
+		if (used + ext > in->bitlen)
+			return bits_starved(in);
+
+		uint16_t repeat = base +
+		    ((in->bitbuf >> used) & ((1 << ext) - 1));
+		bits_drop(in, used + ext);
+
+		if (stream->index + repeat > total)
+			return EINVAL;
+
+		while (repeat > 0) {
+			stream->length[stream->index] = len;
+			stream->index++;
+			repeat--;
 		}
 	}
 
 	/* Check for end-of-block code */
-	if (length[256] == 0)
+	if (stream->length[256] == 0)
 		return EINVAL;
 
 	/* Build Huffman tables for literal/length codes */
-	rc = huffman_construct(&dyn_len_code, length, nlen);
-	if ((rc < 0) || ((rc > 0) && (dyn_len_code.count[0] + 1 != nlen)))
-		return EINVAL;
+	errno_t rc = huffman_construct(stream->len_table, LEN_TABLE_SIZE,
+	    LEN_ROOT_BITS, stream->length, stream->nlen, false);
+	if (rc != EOK)
+		return rc;
 
 	/* Build Huffman tables for distance codes */
-	rc = huffman_construct(&dyn_dist_code, length + nlen, ndist);
-	if ((rc < 0) || ((rc > 0) && (dyn_dist_code.count[0] + 1 != ndist)))
-		return EINVAL;
+	rc = huffman_construct(stream->dist_table, DIST_TABLE_SIZE,
+	    DIST_ROOT_BITS, stream->length + stream->nlen, stream->ndist,
+	    false);
+	if (rc != EOK)
+		return rc;
 
-	return inflate_codes(state, &dyn_len_code, &dyn_dist_code);
+	stream->mode = INFLATE_CODES;
+	return EOK;
 }
 
-/** Inflate data
+/** Decode literal/length and distance codes
  *
- * @param src     Source data buffer.
- * @param srclen  Source buffer size (bytes).
- * @param dest    Destination data buffer.
- * @param destlen Destination buffer size (bytes).
+ * Decode until end-of-block code, lack of input or lack
+ * of space in the sliding window.
  *
- * @return EOK on success.
+ * @param stream Inflate stream.
+ *
+ * @return EOK on end-of-block.
+ * @return EAGAIN if more input or window space is needed.
  * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code or invalid deflate data.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @return EINVAL on invalid Huffman code.
  *
  */
-errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
+static errno_t inflate_codes(inflate_stream_t *stream)
 {
-	/* Initialize the state */
-	inflate_state_t state;
+	/* Keep the hot state in local variables */
+	bit_reader_t in = stream->in;
+	uint8_t *window = stream->window;
+	size_t wpos = stream->wpos;
+	size_t whave = stream->whave;
+	errno_t rc;
+
+	while (true) {
+		if (WINDOW_SIZE - (wpos - stream->rpos) < MAX_MATCH) {
+			rc = EAGAIN;
+			break;
+		}
 
-	state.dest = (uint8_t *) dest;
-	state.destlen = destlen;
-	state.destcnt = 0;
+		if (in.bitlen < MAX_SYMBOL_BITS)
+			bits_refill(&in);
 
-	state.src = (uint8_t *) src;
-	state.srclen = srclen;
-	state.srccnt = 0;
+		uint64_t bits = in.bitbuf;
+		uint16_t symbol;
+		unsigned int used = huffman_decode(stream->len_table,
+		    LEN_ROOT_BITS, bits, &symbol);
+		if ((used == 0) || (used > in.bitlen)) {
+			rc = huffman_fail(&in, 0, used);
+			break;
+		}
 
-	state.bitbuf = 0;
-	state.bitlen = 0;
+		if (symbol < 256) {
+			/* Write out literal */
+			bits_drop(&in, used);
+			window[wpos & WINDOW_MASK] = (uint8_t) symbol;
+			wpos++;
+			if (whave < MAX_DISTANCE)
+				whave++;
 
-	state.overrun = false;
+			continue;
+		}
 
-	uint16_t last;
-	errno_t ret = EOK;
+		if (symbol == 256) {
+			/* End of block */
+			bits_drop(&in, used);
+			rc = EOK;
+			break;
+		}
 
-	do {
-		/* Last block is indicated by a non-zero bit */
-		last = get_bits(&state, 1);
-		CHECK_OVERRUN(state);
+		/* Compute length */
+		symbol -= 257;
+		if (symbol >= MAX_LEN) {
+			rc = EINVAL;
+			break;
+		}
 
-		/* Block type */
-		uint16_t type = get_bits(&state, 2);
-		CHECK_OVERRUN(state);
+		unsigned int ext = lens_ext[symbol];
+		size_t len = lens[symbol] +
+		    ((bits >> used) & ((UINT32_C(1) << ext) - 1));
+		used += ext;
+
+		/* Get distance */
+		uint16_t dsymbol;
+		unsigned int dused = huffman_decode(stream->dist_table,
+		    DIST_ROOT_BITS, bits >> used, &dsymbol);
+		if ((dused == 0) || (used + dused > in.bitlen)) {
+			rc = huffman_fail(&in, used, dused);
+			break;
+		}
 
-		switch (type) {
-		case 0:
-			ret = inflate_stored(&state);
+		if (dsymbol >= MAX_DIST) {
+			rc = EINVAL;
 			break;
-		case 1:
-			ret = inflate_fixed(&state, &len_code, &dist_code);
+		}
+
+		used += dused;
+		ext = dists_ext[dsymbol];
+		if (used + ext > in.bitlen) {
+			rc = bits_starved(&in);
 			break;
-		case 2:
-			ret = inflate_dynamic(&state);
+		}
+
+		size_t dist = dists[dsymbol] +
+		    ((bits >> used) & ((UINT32_C(1) << ext) - 1));
+		if (dist > whave) {
+			rc = ENOENT;
 			break;
-		default:
-			ret = EINVAL;
 		}
-	} while ((!last) && (ret == 0));
 
+		bits_drop(&in, used + ext);
+
+		/* Copy len bytes from distance bytes back */
+		window_copy(window, wpos, dist, len);
+		wpos += len;
+		whave += len;
+		if (whave > MAX_DISTANCE)
+			whave = MAX_DISTANCE;
+	}
+
+	stream->in = in;
+	stream->wpos = wpos;
+	stream->whave = whave;
+
+	if (rc == EOK)
+		inflate_block_done(stream);
+
+	return rc;
+}
+
+/** Run the decoder in the current state
+ *
+ * @param stream Inflate stream.
+ *
+ * @return EOK on state change.
+ * @return EAGAIN if more input or window space is needed.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
+ *
+ */
+static errno_t inflate_step(inflate_stream_t *stream)
+{
+	switch (stream->mode) {
+	case INFLATE_HEADER:
+		return inflate_header(stream);
+	case INFLATE_STORED_LEN:
+		return inflate_stored_len(stream);
+	case INFLATE_STORED:
+		return inflate_stored(stream);
+	case INFLATE_TABLE_SIZES:
+		return inflate_table_sizes(stream);
+	case INFLATE_TABLE_ORDER:
+		return inflate_table_order(stream);
+	case INFLATE_TABLE_LENGTHS:
+		return inflate_table_lengths(stream);
+	case INFLATE_CODES:
+		return inflate_codes(stream);
+	case INFLATE_DONE:
+		break;
+	}
+
+	return EOK;
+}
+
+/** Create inflate stream
+ *
+ * @param rstream Place to store pointer to the new stream.
+ *
+ * @return EOK on success.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t inflate_stream_create(inflate_stream_t **rstream)
+{
+	inflate_stream_t *stream = malloc(sizeof(inflate_stream_t));
+	if (stream == NULL)
+		return ENOMEM;
+
+	inflate_stream_reset(stream);
+
+	*rstream = stream;
+	return EOK;
+}
+
+/** Destroy inflate stream
+ *
+ * @param stream Inflate stream.
+ *
+ */
+void inflate_stream_destroy(inflate_stream_t *stream)
+{
+	free(stream);
+}
+
+/** Reset inflate stream
+ *
+ * Prepare the stream for decoding a new deflate stream.
+ *
+ * @param stream Inflate stream.
+ *
+ */
+void inflate_stream_reset(inflate_stream_t *stream)
+{
+	stream->mode = INFLATE_HEADER;
+	stream->error = EOK;
+	stream->last = false;
+
+	stream->in.src = NULL;
+	stream->in.srclen = 0;
+	stream->in.srccnt = 0;
+	stream->in.bitbuf = 0;
+	stream->in.bitlen = 0;
+	stream->in.starved = false;
+
+	stream->stored_left = 0;
+	stream->fixed = false;
+
+	stream->wpos = 0;
+	stream->rpos = 0;
+	stream->whave = 0;
+}
+
+/** Inflate a chunk of data
+ *
+ * Decode as much of the input as possible and drain as much
+ * of the decoded data to the destination buffer as possible.
+ * Input which was not consumed (as indicated by @a srcused) needs
+ * to be passed again in the next call, together with more input.
+ * Input past the end of the deflate stream is never consumed.
+ *
+ * @param[in]  stream   Inflate stream.
+ * @param[in]  src      Source data buffer.
+ * @param[in]  srclen   Source buffer size (bytes).
+ * @param[out] srcused  Number of source bytes consumed.
+ * @param[in]  dest     Destination data buffer.
+ * @param[in]  destlen  Destination buffer size (bytes).
+ * @param[out] destused Number of bytes written to the destination buffer.
+ *
+ * @return EOK if the end of the deflate stream has been reached
+ *         and all the decoded data have been drained.
+ * @return EAGAIN if more input or more space for the output is needed.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
+ *
+ */
+errno_t inflate_stream_process(inflate_stream_t *stream, const void *src,
+    size_t srclen, size_t *srcused, void *dest, size_t destlen,
+    size_t *destused)
+{
+	stream->in.src = (const uint8_t *) src;
+	stream->in.srclen = srclen;
+	stream->in.srccnt = 0;
+	stream->in.starved = false;
+
+	uint8_t *out = (uint8_t *) dest;
+	size_t outcnt = 0;
+	errno_t rc = stream->error;
+
+	while (rc == EOK) {
+		outcnt += window_drain(stream, out + outcnt, destlen - outcnt);
+
+		if (stream->mode == INFLATE_DONE) {
+			if (stream->wpos != stream->rpos)
+				rc = EAGAIN;
+
+			break;
+		}
+
+		stream->in.starved = false;
+		rc = inflate_step(stream);
+		if (rc == EAGAIN) {
+			/*
+			 * Continue if the decoder only needs more window
+			 * space and we can make some.
+			 */
+			if ((stream->wpos == stream->rpos) || (outcnt == destlen))
+				break;
+
+			rc = EOK;
+		}
+	}
+
+	if ((rc != EOK) && (rc != EAGAIN))
+		stream->error = rc;
+
+	if (!stream->in.starved) {
+		/*
+		 * Return the whole bytes left in the bit buffer to the input.
+		 * On success they have all been loaded during this call, since
+		 * the bytes kept from the previous calls were part of an element
+		 * which could not be decoded without more input. Invalid data
+		 * can be detected before those kept bytes are decoded, though,
+		 * and they cannot be returned to the caller.
+		 */
+		unsigned int unused = stream->in.bitlen >> 3;
+		if (unused > stream->in.srccnt) {
+			assert((rc != EOK) && (rc != EAGAIN));
+			unused = stream->in.srccnt;
+		}
+
+		stream->in.srccnt -= unused;
+		stream->in.bitlen &= 7;
+	}
+
+	/* Bits above the bit count might have been preloaded */
+	stream->in.bitbuf &= (UINT64_C(1) << stream->in.bitlen) - 1;
+
+	*srcused = stream->in.srccnt;
+	*destused = outcnt;
+
+	stream->in.src = NULL;
+	stream->in.srclen = 0;
+	stream->in.srccnt = 0;
+
+	return rc;
+}
+
+/** Inflate data
+ *
+ * @param src     Source data buffer.
+ * @param srclen  Source buffer size (bytes).
+ * @param dest    Destination data buffer.
+ * @param destlen Destination buffer size (bytes).
+ *
+ * @return EOK on success.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
+ * @return ELIMIT on input buffer overrun.
+ * @return ENOMEM on output buffer overrun or if out of memory.
+ *
+ */
+errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
+{
+	inflate_stream_t *stream;
+	errno_t ret = inflate_stream_create(&stream);
+	if (ret != EOK)
+		return ret;
+
+	size_t srcused;
+	size_t destused;
+	ret = inflate_stream_process(stream, src, srclen, &srcused, dest,
+	    destlen, &destused);
+	if (ret == EAGAIN)
+		ret = (destused == destlen) ? ENOMEM : ELIMIT;
+
+	inflate_stream_destroy(stream);
 	return ret;
 }
@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../deflate.h"
+#include "../gzip.h"
+#include "../inflate.h"
+#include "../zlib.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(deflate);
+
+enum {
+	/** Size of the test data */
+	data_size = 200000
+};
+
+/** Fill buffer with compressible test data
+ *
+ * Words from a small vocabulary, runs of equal bytes and
+ * stretches of noise.
+ *
+ * @param buf Buffer.
+ * @param len Size of the buffer.
+ *
+ */
+static void fill_data(uint8_t *buf, size_t len)
+{
+	static const char *words[] = {
+		"HelenOS ", "microkernel ", "task ", "thread ", "IPC ",
+		"server ", "driver ", "location ", "service ", "\n"
+	};
+
+	uint32_t seed = 42;
+	size_t pos = 0;
+
+	while (pos < len) {
+		seed = seed * 1103515245 + 12345;
+		unsigned int kind = (seed >> 16) % 16;
+		size_t cnt;
+
+		if (kind < 12) {
+			const char *word = words[(seed >> 20) % 10];
+			for (cnt = 0; (word[cnt] != 0) && (pos < len); cnt++)
+				buf[pos++] = word[cnt];
+		} else if (kind < 14) {
+			for (cnt = (seed >> 24) % 300; (cnt > 0) && (pos < len); cnt--)
+				buf[pos++] = kind;
+		} else {
+			for (cnt = (seed >> 24) % 64; (cnt > 0) && (pos < len); cnt--) {
+				seed = seed * 1103515245 + 12345;
+				buf[pos++] = seed >> 24;
+			}
+		}
+	}
+}
+
+/** Round trip at all compression levels */
+PCUT_TEST(levels)
+{
+	uint8_t *data = malloc(data_size);
+	PCUT_ASSERT_NOT_NULL(data);
+	uint8_t *back = malloc(data_size);
+	PCUT_ASSERT_NOT_NULL(back);
+	size_t bound = deflate_bound(data_size);
+	uint8_t *comp = malloc(bound);
+	PCUT_ASSERT_NOT_NULL(comp);
+
+	fill_data(data, data_size);
+
+	unsigned int level;
+	for (level = 0; level <= DEFLATE_LEVEL_MAX; level++) {
+		size_t size;
+		errno_t rc = deflate_compress(data, data_size, comp, bound, &size,
+		    level);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		if (level > 0)
+			PCUT_ASSERT_TRUE(size < data_size / 2);
+
+		rc = inflate(comp, size, back, data_size);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(data, back, data_size));
+	}
+
+	free(comp);
+	free(back);
+	free(data);
+}
+
+/** Empty input */
+PCUT_TEST(empty)
+{
+	uint8_t comp[16];
+	uint8_t back[1];
+	size_t size;
+
+	errno_t rc = deflate_compress(NULL, 0, comp, sizeof(comp), &size,
+	    DEFLATE_LEVEL_DEFAULT);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	size_t used;
+	inflate_stream_t *stream;
+	rc = inflate_stream_create(&stream);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	rc = inflate_stream_process(stream, comp, size, &used, back,
+	    sizeof(back), &size);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, size);
+
+	inflate_stream_destroy(stream);
+}
+
+/** Invalid compression level */
+PCUT_TEST(invalid_level)
+{
+	deflate_stream_t *stream;
+
+	errno_t rc = deflate_stream_create(DEFLATE_LEVEL_MAX + 1, &stream);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+}
+
+/** Output buffer too small for the one-shot compression */
+PCUT_TEST(overrun)
+{
+	uint8_t *data = malloc(data_size);
+	PCUT_ASSERT_NOT_NULL(data);
+	uint8_t comp[64];
+	size_t size;
+
+	fill_data(data, data_size);
+
+	errno_t rc = deflate_compress(data, data_size, comp, sizeof(comp),
+	    &size, DEFLATE_LEVEL_DEFAULT);
+	PCUT_ASSERT_ERRNO_VAL(ENOMEM, rc);
+
+	free(data);
+}
+
+/** Streaming with small input and output chunks */
+PCUT_TEST(stream_chunks)
+{
+	uint8_t *data = malloc(data_size);
+	PCUT_ASSERT_NOT_NULL(data);
+	uint8_t *back = malloc(data_size);
+	PCUT_ASSERT_NOT_NULL(back);
+	size_t bound = deflate_bound(data_size);
+	uint8_t *comp = malloc(bound);
+	PCUT_ASSERT_NOT_NULL(comp);
+
+	fill_data(data, data_size);
+
+	deflate_stream_t *stream;
+	errno_t rc = deflate_stream_create(DEFLATE_LEVEL_DEFAULT, &stream);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	size_t incnt = 0;
+	size_t outcnt = 0;
+
+	do {
+		size_t inlen = data_size - incnt;
+		if (inlen > 1000)
+			inlen = 1000;
+
+		size_t outlen = bound - outcnt;
+		if (outlen > 333)
+			outlen = 333;
+
+		deflate_flush_t flush = (incnt + inlen == data_size) ?
+		    DEFLATE_FINISH : DEFLATE_NO_FLUSH;
+
+		size_t srcused;
+		size_t destused;
+		rc = deflate_stream_process(stream, data + incnt, inlen,
+		    &srcused, comp + outcnt, outlen, &destused, flush);
+		incnt += srcused;
+		outcnt += destused;
+
+		PCUT_ASSERT_TRUE((rc == EOK) || (rc == EAGAIN));
+		PCUT_ASSERT_TRUE(outcnt < bound);
+	} while ((rc != EOK) || (incnt < data_size));
+
+	deflate_stream_destroy(stream);
+
+	rc = inflate(comp, outcnt, back, data_size);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(data, back, data_size));
+
+	free(comp);
+	free(back);
+	free(data);
+}
+
+/** Sync flush makes all the data so far decodable */
+PCUT_TEST(sync_flush)
+{
+	uint8_t *data = malloc(data_size);
+	PCUT_ASSERT_NOT_NULL(data);
+	uint8_t *back = malloc(data_size);
+	PCUT_ASSERT_NOT_NULL(back);
+	size_t bound = deflate_bound(data_size);
+	uint8_t *comp = malloc(bound);
+	PCUT_ASSERT_NOT_NULL(comp);
+
+	fill_data(data, data_size);
+
+	deflate_stream_t *dstream;
+	errno_t rc = deflate_stream_create(DEFLATE_LEVEL_FAST, &dstream);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inflate_stream_t *istream;
+	rc = inflate_stream_create(&istream);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	size_t offset = 0;
+	size_t parts[] = { 1, 5000, 3, 70000 };
+	size_t i;
+
+	for (i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+		size_t srcused;
+		size_t size;
+		rc = deflate_stream_process(dstream, data + offset, parts[i],
+		    &srcused, comp, bound, &size, DEFLATE_SYNC_FLUSH);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(parts[i], srcused);
+
+		/* Empty `stored' block marker */
+		PCUT_ASSERT_TRUE(size >= 4);
+		PCUT_ASSERT_INT_EQUALS(0x00, comp[size - 4]);
+		PCUT_ASSERT_INT_EQUALS(0x00, comp[size - 3]);
+		PCUT_ASSERT_INT_EQUALS(0xff, comp[size - 2]);
+		PCUT_ASSERT_INT_EQUALS(0xff, comp[size - 1]);
+
+		size_t destused;
+		rc = inflate_stream_process(istream, comp, size, &srcused,
+		    back + offset, data_size - offset, &destused);
+		PCUT_ASSERT_ERRNO_VAL(EAGAIN, rc);
+		PCUT_ASSERT_INT_EQUALS(size, srcused);
+		PCUT_ASSERT_INT_EQUALS(parts[i], destused);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(data + offset, back + offset,
+		    parts[i]));
+
+		offset += parts[i];
+	}
+
+	inflate_stream_destroy(istream);
+	deflate_stream_destroy(dstream);
+
+	free(comp);
+	free(back);
+	free(data);
+}
+
+/** GZIP round trip */
+PCUT_TEST(gzip_compress)
+{
+	uint8_t *data = malloc(data_size);
+	PCUT_ASSERT_NOT_NULL(data);
+
+	fill_data(data, data_size);
+
+	void *comp;
+	size_t size;
+	errno_t rc = gzip_compress(data, data_size, DEFLATE_LEVEL_MAX, &comp,
+	    &size);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	void *back;
+	size_t back_size;
+	rc = gzip_expand(comp, size, &back, &back_size);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(data_size, back_size);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(data, back, data_size));
+
+	free(back);
+	free(comp);
+	free(data);
+}
+
+/** ZLIB framing */
+PCUT_TEST(zlib_compress)
+{
+	uint8_t *data = malloc(data_size);
+	PCUT_ASSERT_NOT_NULL(data);
+	uint8_t *back = malloc(data_size);
+	PCUT_ASSERT_NOT_NULL(back);
+	size_t bound = deflate_bound(data_size) + 6;
+	uint8_t *comp = malloc(bound);
+	PCUT_ASSERT_NOT_NULL(comp);
+
+	fill_data(data, data_size);
+
+	zlib_compressor_t *compressor;
+	errno_t rc = zlib_compressor_create(DEFLATE_LEVEL_DEFAULT, &compressor);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	size_t srcused;
+	size_t size;
+	rc = zlib_compressor_process(compressor, data, data_size, &srcused,
+	    comp, bound, &size, DEFLATE_FINISH);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(data_size, srcused);
+
+	zlib_compressor_destroy(compressor);
+
+	/* Header */
+	PCUT_ASSERT_INT_EQUALS(0x78, comp[0]);
+	PCUT_ASSERT_INT_EQUALS(0, ((comp[0] << 8) | comp[1]) % 31);
+
+	/* Trailer */
+	uint32_t adler = zlib_adler32(1, data, data_size);
+	PCUT_ASSERT_INT_EQUALS((adler >> 24) & 0xff, comp[size - 4]);
+	PCUT_ASSERT_INT_EQUALS((adler >> 16) & 0xff, comp[size - 3]);
+	PCUT_ASSERT_INT_EQUALS((adler >> 8) & 0xff, comp[size - 2]);
+	PCUT_ASSERT_INT_EQUALS(adler & 0xff, comp[size - 1]);
+
+	rc = inflate(comp + 2, size - 6, back, data_size);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(data, back, data_size));
+
+	free(comp);
+	free(back);
+	free(data);
+}
+
+/** Adler-32 checksum */
+PCUT_TEST(adler32)
+{
+	PCUT_ASSERT_INT_EQUALS(1, zlib_adler32(1, NULL, 0));
+	PCUT_ASSERT_INT_EQUALS(0x11e60398, zlib_adler32(1, "Wikipedia", 9));
+}
+
+PCUT_EXPORT(deflate);
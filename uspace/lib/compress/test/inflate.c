@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../gzip.h"
+#include "../inflate.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(inflate);
+
+/** Data encoded in the test streams */
+static const char text[] =
+    "Hello, HelenOS! Hello, HelenOS! Hello, HelenOS! "
+    "0123456789 0123456789";
+
+/** Deflate stream with a single `fixed codes' block */
+static uint8_t fixed[] = {
+	0xf3, 0x48, 0xcd, 0xc9, 0xc9, 0xd7, 0x51, 0xf0, 0x48, 0xcd, 0x49, 0xcd,
+	0xf3, 0x0f, 0x56, 0x04, 0x31, 0xf0, 0xf2, 0x0d, 0x0c, 0x8d, 0x8c, 0x4d,
+	0x4c, 0xcd, 0xcc, 0x2d, 0x2c, 0x91, 0x98, 0x00
+};
+
+/** Deflate stream with a single `stored' block */
+static uint8_t stored[] = {
+	0x01, 0x45, 0x00, 0xba, 0xff, 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x2c, 0x20,
+	0x48, 0x65, 0x6c, 0x65, 0x6e, 0x4f, 0x53, 0x21, 0x20, 0x48, 0x65, 0x6c,
+	0x6c, 0x6f, 0x2c, 0x20, 0x48, 0x65, 0x6c, 0x65, 0x6e, 0x4f, 0x53, 0x21,
+	0x20, 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x2c, 0x20, 0x48, 0x65, 0x6c, 0x65,
+	0x6e, 0x4f, 0x53, 0x21, 0x20, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36,
+	0x37, 0x38, 0x39, 0x20, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+	0x38, 0x39
+};
+
+/** GZIP stream with extra field, name, comment and `dynamic codes' block */
+static uint8_t gz[] = {
+	0x1f, 0x8b, 0x08, 0x1c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x04, 0x00,
+	0x48, 0x4f, 0x53, 0x21, 0x74, 0x65, 0x78, 0x74, 0x2e, 0x74, 0x78, 0x74,
+	0x00, 0x63, 0x6f, 0x6d, 0x6d, 0x65, 0x6e, 0x74, 0x00, 0xed, 0x8e, 0xc9,
+	0x0d, 0x80, 0x30, 0x0c, 0x04, 0x5b, 0xd9, 0x0a, 0x68, 0x80, 0x6a, 0x38,
+	0x9c, 0x60, 0x20, 0x31, 0xb9, 0x38, 0x52, 0x3d, 0x16, 0x3d, 0xf0, 0x40,
+	0xe2, 0xb9, 0x9a, 0x59, 0x69, 0xf2, 0x44, 0x08, 0x85, 0x87, 0x05, 0x7d,
+	0x94, 0xc3, 0xc3, 0xc8, 0x89, 0xb9, 0xb8, 0x2d, 0x41, 0x76, 0x8a, 0xc8,
+	0x8a, 0xd7, 0xae, 0x5e, 0x18, 0xc5, 0xb6, 0xcf, 0x7a, 0x47, 0xde, 0x3a,
+	0xf5, 0xdc, 0x85, 0x5e, 0xa5, 0x83, 0xf3, 0x04, 0xc3, 0x3b, 0x29, 0xaa,
+	0xe4, 0xb1, 0x72, 0x28, 0x12, 0xf5, 0x6b, 0x53, 0xf3, 0x62, 0xc2, 0xdf,
+	0xfb, 0xc5, 0xde, 0x1b, 0x69, 0x1a, 0x27, 0xb8, 0xc0, 0x02, 0x00, 0x00
+};
+
+enum {
+	/** Number of repetitions of the pangrams in the GZIP stream */
+	gz_repeat = 4
+};
+
+/** Construct the data encoded in the GZIP stream
+ *
+ * @param size Place to store the size of the data.
+ * @return Newly allocated data
+ */
+static char *gz_text(size_t *size)
+{
+	const char *fox = "the quick brown fox jumps over the lazy dog; ";
+	const char *box = "pack my box with five dozen liquor jugs. ";
+	size_t len = gz_repeat * (3 * str_length(fox) + str_length(box));
+	char *data = malloc(len + 1);
+	char *pos = data;
+	int i, j;
+
+	if (data == NULL)
+		return NULL;
+
+	for (i = 0; i < gz_repeat; i++) {
+		for (j = 0; j < 3; j++) {
+			memcpy(pos, fox, str_length(fox));
+			pos += str_length(fox);
+		}
+
+		memcpy(pos, box, str_length(box));
+		pos += str_length(box);
+	}
+
+	*size = len;
+	return data;
+}
+
+/** Decode a GZIP stream fed in chunks of the given size
+ *
+ * Verifies that a decoding error, once reported, is reported
+ * again by the following calls.
+ *
+ * @param data  GZIP stream.
+ * @param len   Size of the stream.
+ * @param chunk Number of bytes fed at once.
+ * @return Result of the last gzip_stream_process() call
+ */
+static errno_t gz_feed(const uint8_t *data, size_t len, size_t chunk)
+{
+	gzip_stream_t *stream;
+	char buf[16];
+	size_t srcpos = 0;
+	size_t srcused;
+	size_t destused;
+	errno_t rc;
+
+	rc = gzip_stream_create(&stream);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	do {
+		size_t srclen = len - srcpos;
+		if (srclen > chunk)
+			srclen = chunk;
+
+		rc = gzip_stream_process(stream, data + srcpos, srclen,
+		    &srcused, buf, sizeof(buf), &destused);
+		PCUT_ASSERT_TRUE(srcused <= srclen);
+		srcpos += srcused;
+
+		/* Out of input */
+		if ((rc == EAGAIN) && (srcpos == len) && (destused == 0))
+			break;
+	} while (rc == EAGAIN);
+
+	if ((rc != EOK) && (rc != EAGAIN)) {
+		errno_t rc2 = gzip_stream_process(stream, data, len,
+		    &srcused, buf, sizeof(buf), &destused);
+		PCUT_ASSERT_ERRNO_VAL(rc, rc2);
+	}
+
+	gzip_stream_destroy(stream);
+	return rc;
+}
+
+/** Decoding of a `fixed codes' block */
+PCUT_TEST(fixed)
+{
+	char buf[sizeof(text) - 1];
+	errno_t rc;
+
+	rc = inflate(fixed, sizeof(fixed), buf, sizeof(buf));
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, text, sizeof(buf)));
+}
+
+/** Decoding of a `stored' block */
+PCUT_TEST(stored)
+{
+	char buf[sizeof(text) - 1];
+	errno_t rc;
+
+	rc = inflate(stored, sizeof(stored), buf, sizeof(buf));
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, text, sizeof(buf)));
+}
+
+/** Output and input buffer overruns are reported */
+PCUT_TEST(overrun)
+{
+	char buf[sizeof(text) - 1];
+	errno_t rc;
+
+	rc = inflate(fixed, sizeof(fixed), buf, sizeof(buf) - 1);
+	PCUT_ASSERT_ERRNO_VAL(ENOMEM, rc);
+
+	rc = inflate(fixed, sizeof(fixed) - 2, buf, sizeof(buf));
+	PCUT_ASSERT_ERRNO_VAL(ELIMIT, rc);
+}
+
+/** Invalid block type is rejected */
+PCUT_TEST(invalid)
+{
+	uint8_t data[] = { 0x07, 0x00 };
+	char buf[16];
+	errno_t rc;
+
+	rc = inflate(data, sizeof(data), buf, sizeof(buf));
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+}
+
+/** Inflate stream can be fed and drained one byte at a time */
+PCUT_TEST(stream_bytewise)
+{
+	inflate_stream_t *stream;
+	char buf[sizeof(text) - 1];
+	size_t srcpos = 0;
+	size_t destpos = 0;
+	size_t srcused;
+	size_t destused;
+	errno_t rc;
+
+	rc = inflate_stream_create(&stream);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	do {
+		size_t srclen = (srcpos < sizeof(fixed)) ? 1 : 0;
+		size_t destlen = (destpos < sizeof(buf)) ? 1 : 0;
+
+		rc = inflate_stream_process(stream, fixed + srcpos, srclen,
+		    &srcused, buf + destpos, destlen, &destused);
+		srcpos += srcused;
+		destpos += destused;
+
+		PCUT_ASSERT_TRUE((rc == EOK) || (rc == EAGAIN));
+		PCUT_ASSERT_TRUE((srclen > 0) || (destused > 0) || (rc == EOK));
+	} while (rc != EOK);
+
+	PCUT_ASSERT_INT_EQUALS(sizeof(fixed), srcpos);
+	PCUT_ASSERT_INT_EQUALS(sizeof(buf), destpos);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, text, sizeof(buf)));
+
+	inflate_stream_destroy(stream);
+}
+
+/** GZIP stream can be decoded in small chunks */
+PCUT_TEST(gzip_stream)
+{
+	gzip_stream_t *stream;
+	char buf[16];
+	size_t size;
+	size_t srcpos = 0;
+	size_t destpos = 0;
+	size_t srcused;
+	size_t destused;
+	errno_t rc;
+
+	char *expected = gz_text(&size);
+	PCUT_ASSERT_NOT_NULL(expected);
+
+	rc = gzip_stream_create(&stream);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	do {
+		/* Feed the data three bytes at a time */
+		size_t srclen = sizeof(gz) - srcpos;
+		if (srclen > 3)
+			srclen = 3;
+
+		rc = gzip_stream_process(stream, gz + srcpos, srclen,
+		    &srcused, buf, sizeof(buf), &destused);
+		PCUT_ASSERT_TRUE((rc == EOK) || (rc == EAGAIN));
+		PCUT_ASSERT_TRUE(destpos + destused <= size);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, expected + destpos,
+		    destused));
+
+		srcpos += srcused;
+		destpos += destused;
+	} while (rc != EOK);
+
+	PCUT_ASSERT_INT_EQUALS(sizeof(gz), srcpos);
+	PCUT_ASSERT_INT_EQUALS(size, destpos);
+
+	gzip_stream_destroy(stream);
+	free(expected);
+}
+
+/** GZIP data can be expanded at once and the checksum is verified */
+PCUT_TEST(gzip_expand)
+{
+	void *data;
+	size_t dsize;
+	size_t size;
+	errno_t rc;
+
+	char *expected = gz_text(&size);
+	PCUT_ASSERT_NOT_NULL(expected);
+
+	rc = gzip_expand(gz, sizeof(gz), &data, &dsize);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(size, dsize);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(data, expected, size));
+	free(data);
+
+	/* Corrupt the CRC */
+	gz[sizeof(gz) - 8] ^= 0x01;
+	rc = gzip_expand(gz, sizeof(gz), &data, &dsize);
+	gz[sizeof(gz) - 8] ^= 0x01;
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	free(expected);
+}
+
+/** Truncated and corrupted GZIP streams are rejected */
+PCUT_TEST(gzip_corrupted)
+{
+	void *data;
+	size_t dsize;
+	size_t len;
+	size_t chunk;
+	size_t bit;
+	errno_t rc;
+
+	for (len = 0; len < sizeof(gz); len++) {
+		rc = gzip_expand(gz, len, &data, &dsize);
+		PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+	}
+
+	/* Decoding this byte by byte used to trip an assertion */
+	gz[34] ^= 0x08;
+	rc = gz_feed(gz, sizeof(gz), 1);
+	gz[34] ^= 0x08;
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+
+	for (chunk = 1; chunk <= 8; chunk++) {
+		for (bit = 0; bit < 8 * sizeof(gz); bit++) {
+			gz[bit / 8] ^= 1 << (bit % 8);
+			rc = gz_feed(gz, sizeof(gz), chunk);
+			gz[bit / 8] ^= 1 << (bit % 8);
+
+			/* Some bits do not affect the decoded data */
+			PCUT_ASSERT_TRUE((rc == EOK) || (rc == EAGAIN) ||
+			    (rc == EINVAL) || (rc == ENOENT));
+
+			/* The footer is always verified */
+			if (bit >= 8 * (sizeof(gz) - 8))
+				PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+		}
+	}
+}
+
+PCUT_EXPORT(inflate);
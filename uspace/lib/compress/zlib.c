@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ * @brief ZLIB stream format
+ *
+ * Wraps `deflate' streams into the ZLIB format (RFC 1950), i.e.
+ * a two-byte header and the Adler-32 checksum of the uncompressed
+ * data.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <mem.h>
+#include <byteorder.h>
+#include "zlib.h"
+#include "deflate.h"
+
+/** Compression method `deflate' with a 32 KiB window */
+#define ZLIB_CMF  UINT8_C(0x78)
+
+/** Shift of the compression level in the flags */
+#define ZLIB_FLEVEL_SHIFT  6
+
+/** Adler-32 modulus */
+#define ADLER_BASE  65521
+
+/** Bytes processed before the Adler-32 sums need to be reduced */
+#define ADLER_NMAX  5552
+
+/** ZLIB encoder state
+ *
+ */
+struct zlib_compressor {
+	deflate_stream_t *deflate;  /**< Deflate stream */
+	unsigned int level;         /**< Compression level */
+
+	uint8_t buf[sizeof(uint32_t)];  /**< Header or trailer to write */
+	size_t buffered;          /**< Number of bytes in the buffer */
+	size_t written;           /**< Number of bytes written from the buffer */
+	bool finished;            /**< The trailer has been queued */
+
+	uint32_t adler32;         /**< Checksum of the uncompressed data */
+};
+
+/** Compute Adler-32 checksum
+ *
+ * @param adler  Checksum of the preceding data (1 initially).
+ * @param data   Data buffer.
+ * @param length Size of the data.
+ *
+ * @return Updated checksum.
+ *
+ */
+uint32_t zlib_adler32(uint32_t adler, const void *data, size_t length)
+{
+	const uint8_t *bytes = (const uint8_t *) data;
+	uint32_t a = adler & 0xffff;
+	uint32_t b = adler >> 16;
+
+	while (length > 0) {
+		size_t cnt = (length < ADLER_NMAX) ? length : ADLER_NMAX;
+		length -= cnt;
+
+		while (cnt > 0) {
+			a += *bytes;
+			b += a;
+			bytes++;
+			cnt--;
+		}
+
+		a %= ADLER_BASE;
+		b %= ADLER_BASE;
+	}
+
+	return (b << 16) | a;
+}
+
+/** Create ZLIB compressor
+ *
+ * @param level       Compression level (0 to DEFLATE_LEVEL_MAX).
+ * @param rcompressor Place to store pointer to the new compressor.
+ *
+ * @return EOK on success.
+ * @return EINVAL if the compression level is not valid.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t zlib_compressor_create(unsigned int level,
+    zlib_compressor_t **rcompressor)
+{
+	zlib_compressor_t *compressor = malloc(sizeof(zlib_compressor_t));
+	if (compressor == NULL)
+		return ENOMEM;
+
+	errno_t rc = deflate_stream_create(level, &compressor->deflate);
+	if (rc != EOK) {
+		free(compressor);
+		return rc;
+	}
+
+	compressor->level = level;
+	zlib_compressor_reset(compressor);
+
+	*rcompressor = compressor;
+	return EOK;
+}
+
+/** Destroy ZLIB compressor
+ *
+ * @param compressor ZLIB compressor.
+ *
+ */
+void zlib_compressor_destroy(zlib_compressor_t *compressor)
+{
+	deflate_stream_destroy(compressor->deflate);
+	free(compressor);
+}
+
+/** Reset ZLIB compressor
+ *
+ * Prepare the compressor for encoding a new ZLIB stream.
+ *
+ * @param compressor ZLIB compressor.
+ *
+ */
+void zlib_compressor_reset(zlib_compressor_t *compressor)
+{
+	unsigned int flevel;
+
+	if (compressor->level < 2)
+		flevel = 0;
+	else if (compressor->level < DEFLATE_LEVEL_DEFAULT)
+		flevel = 1;
+	else if (compressor->level == DEFLATE_LEVEL_DEFAULT)
+		flevel = 2;
+	else
+		flevel = 3;
+
+	/* The header as a 16-bit number has to be a multiple of 31 */
+	uint16_t header = (ZLIB_CMF << 8) | (flevel << ZLIB_FLEVEL_SHIFT);
+	if (header % 31 != 0)
+		header += 31 - (header % 31);
+
+	compressor->buf[0] = header >> 8;
+	compressor->buf[1] = header & 0xff;
+	compressor->buffered = 2;
+	compressor->written = 0;
+	compressor->finished = false;
+	compressor->adler32 = 1;
+
+	deflate_stream_reset(compressor->deflate);
+}
+
+/** Compress a chunk of data into a ZLIB stream
+ *
+ * The semantics of the arguments and the return values follow
+ * deflate_stream_process(). The checksum is written when
+ * the stream is finished using DEFLATE_FINISH.
+ *
+ * @param compressor ZLIB compressor.
+ * @param src        Source data buffer.
+ * @param srclen     Source buffer size (bytes).
+ * @param srcused    Place to store the number of source bytes consumed.
+ * @param dest       Destination data buffer.
+ * @param destlen    Destination buffer size (bytes).
+ * @param destused   Place to store the number of bytes written.
+ * @param flush      Flush mode.
+ *
+ * @return EOK if all the input has been consumed and the requested
+ *         flush is complete.
+ * @return EAGAIN if more output space is needed.
+ *
+ */
+errno_t zlib_compressor_process(zlib_compressor_t *compressor,
+    const void *src, size_t srclen, size_t *srcused, void *dest,
+    size_t destlen, size_t *destused, deflate_flush_t flush)
+{
+	const uint8_t *input = (const uint8_t *) src;
+	uint8_t *output = (uint8_t *) dest;
+	size_t incnt = 0;
+	size_t outcnt = 0;
+	errno_t rc;
+
+	while (true) {
+		/* Write the header or the trailer */
+		size_t cnt = compressor->buffered - compressor->written;
+		if (cnt > destlen - outcnt)
+			cnt = destlen - outcnt;
+
+		memcpy(output + outcnt, compressor->buf + compressor->written,
+		    cnt);
+		compressor->written += cnt;
+		outcnt += cnt;
+
+		if (compressor->written < compressor->buffered) {
+			rc = EAGAIN;
+			break;
+		}
+
+		if (compressor->finished) {
+			rc = EOK;
+			break;
+		}
+
+		size_t used;
+		rc = deflate_stream_process(compressor->deflate, input + incnt,
+		    srclen - incnt, &used, output + outcnt, destlen - outcnt,
+		    &cnt, flush);
+
+		compressor->adler32 = zlib_adler32(compressor->adler32,
+		    input + incnt, used);
+		incnt += used;
+		outcnt += cnt;
+
+		if ((rc != EOK) || (flush != DEFLATE_FINISH))
+			break;
+
+		uint32_t trailer = host2uint32_t_be(compressor->adler32);
+
+		memcpy(compressor->buf, &trailer, sizeof(trailer));
+		compressor->buffered = sizeof(trailer);
+		compressor->written = 0;
+		compressor->finished = true;
+	}
+
+	*srcused = incnt;
+	*destused = outcnt;
+	return rc;
+}
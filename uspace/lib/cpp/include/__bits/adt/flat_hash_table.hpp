@@ -0,0 +1,941 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_ADT_FLAT_HASH_TABLE
+#define LIBCPP_BITS_ADT_FLAT_HASH_TABLE
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace std::aux
+{
+    /**
+     * Open addressing hash table in the style of the SwissTable.
+     * Values are stored in a single array of slots, next to it
+     * there is an array of control bytes, one per slot. A control
+     * byte is either one of the special values below, or the seven
+     * low bits of the hash of the key in the slot (called h2). The
+     * remaining bits of the hash (h1) pick the group of slots where
+     * the probing starts. A lookup compares h2 against a whole group
+     * of control bytes at once and only looks at the slots that
+     * matched, so most unsuccessful comparisons never touch the
+     * slots at all.
+     *
+     * The control array has a sentinel after the last slot, followed
+     * by copies of the first group_width - 1 control bytes, which
+     * lets a group be loaded from any position without wrapping.
+     */
+
+    struct flat_ctrl
+    {
+        static constexpr int8_t empty{-128};
+        static constexpr int8_t deleted{-2};
+        static constexpr int8_t sentinel{-1};
+
+        static bool is_full(int8_t c)
+        {
+            return c >= 0;
+        }
+    };
+
+    /**
+     * Set of positions in a group, shift is the log2 of the number
+     * of bits per position in the underlying mask.
+     */
+    template<unsigned Shift, size_t Width>
+    class flat_bitmask
+    {
+        public:
+            explicit flat_bitmask(uint64_t mask)
+                : mask_{mask}
+            { /* DUMMY BODY */ }
+
+            explicit operator bool() const
+            {
+                return mask_ != 0;
+            }
+
+            size_t lowest() const
+            {
+                return static_cast<size_t>(__builtin_ctzll(mask_)) >> Shift;
+            }
+
+            size_t trailing_zeros() const
+            {
+                return lowest();
+            }
+
+            size_t leading_zeros() const
+            {
+                auto total = static_cast<size_t>(__builtin_clzll(mask_));
+
+                return (total - (64 - (Width << Shift))) >> Shift;
+            }
+
+            void clear_lowest()
+            {
+                mask_ &= mask_ - 1;
+            }
+
+        private:
+            uint64_t mask_;
+    };
+
+#if defined(__SSE2__)
+    /**
+     * SSE2 groups of 16 control bytes. Only GCC vector extensions
+     * and builtins are used so that no intrinsic headers (which
+     * drag in the C library) need to be included.
+     */
+    class flat_group
+    {
+        public:
+            static constexpr size_t width{16};
+
+            using bitmask = flat_bitmask<0, width>;
+
+            explicit flat_group(const int8_t* ctrl)
+            {
+                __builtin_memcpy(&ctrl_, ctrl, width);
+            }
+
+            bitmask match(int8_t h2) const
+            {
+                return bitmask{movemask_(ctrl_ == splat_(h2))};
+            }
+
+            bitmask match_empty() const
+            {
+                return bitmask{movemask_(ctrl_ == splat_(flat_ctrl::empty))};
+            }
+
+            bitmask match_empty_or_deleted() const
+            {
+                return bitmask{movemask_(ctrl_ < splat_(flat_ctrl::sentinel))};
+            }
+
+            size_t count_leading_empty_or_deleted() const
+            {
+                auto mask = movemask_(ctrl_ < splat_(flat_ctrl::sentinel));
+
+                return static_cast<size_t>(__builtin_ctz(mask + 1));
+            }
+
+        private:
+            using vector_type = signed char __attribute__((vector_size(16)));
+            using byte_vector = char __attribute__((vector_size(16)));
+
+            vector_type ctrl_;
+
+            static vector_type splat_(int8_t c)
+            {
+                signed char x = c;
+
+                return vector_type{x, x, x, x, x, x, x, x,
+                                   x, x, x, x, x, x, x, x};
+            }
+
+            template<class Vector>
+            static uint32_t movemask_(Vector v)
+            {
+                return static_cast<uint32_t>(__builtin_ia32_pmovmskb128(
+                    reinterpret_cast<byte_vector>(v)
+                ));
+            }
+    };
+#else
+    /**
+     * Portable groups of 8 control bytes in a 64-bit word, the
+     * matches are computed with bit tricks. The match for h2 may
+     * report a false positive next to a real match, which is
+     * harmless since the keys are compared anyway.
+     */
+    class flat_group
+    {
+        public:
+            static constexpr size_t width{8};
+
+            using bitmask = flat_bitmask<3, width>;
+
+            explicit flat_group(const int8_t* ctrl)
+            {
+                __builtin_memcpy(&ctrl_, ctrl, width);
+#ifdef __BE__
+                ctrl_ = __builtin_bswap64(ctrl_);
+#endif
+            }
+
+            bitmask match(int8_t h2) const
+            {
+                auto x = ctrl_ ^ (lsbs_ * static_cast<uint8_t>(h2));
+
+                return bitmask{(x - lsbs_) & ~x & msbs_};
+            }
+
+            bitmask match_empty() const
+            {
+                return bitmask{(ctrl_ & ~(ctrl_ << 6)) & msbs_};
+            }
+
+            bitmask match_empty_or_deleted() const
+            {
+                return bitmask{(ctrl_ & ~(ctrl_ << 7)) & msbs_};
+            }
+
+            size_t count_leading_empty_or_deleted() const
+            {
+                constexpr uint64_t gaps = 0x00FEFEFEFEFEFEFEULL;
+                auto x = ((~ctrl_ & (ctrl_ >> 7)) | gaps) + 1;
+
+                return static_cast<size_t>(__builtin_ctzll(x) + 7) >> 3;
+            }
+
+        private:
+            static constexpr uint64_t lsbs_{0x0101010101010101ULL};
+            static constexpr uint64_t msbs_{0x8080808080808080ULL};
+
+            uint64_t ctrl_;
+    };
+#endif
+
+    /**
+     * Control bytes of a table with no slots, lookups
+     * fail right away and begin() equals end().
+     */
+    alignas(16) inline const int8_t flat_empty_group[16]{
+        flat_ctrl::sentinel, flat_ctrl::empty, flat_ctrl::empty,
+        flat_ctrl::empty, flat_ctrl::empty, flat_ctrl::empty,
+        flat_ctrl::empty, flat_ctrl::empty, flat_ctrl::empty,
+        flat_ctrl::empty, flat_ctrl::empty, flat_ctrl::empty,
+        flat_ctrl::empty, flat_ctrl::empty, flat_ctrl::empty,
+        flat_ctrl::empty
+    };
+
+    template<class Value, class Reference, class Pointer>
+    class flat_hash_table_iterator
+    {
+        public:
+            using value_type        = Value;
+            using reference         = Reference;
+            using pointer           = Pointer;
+            using difference_type   = ptrdiff_t;
+            using iterator_category = forward_iterator_tag;
+
+            flat_hash_table_iterator(const int8_t* ctrl = nullptr,
+                                     Value* slot = nullptr)
+                : ctrl_{ctrl}, slot_{slot}
+            { /* DUMMY BODY */ }
+
+            template<class Ref, class Ptr>
+            flat_hash_table_iterator(
+                const flat_hash_table_iterator<Value, Ref, Ptr>& other
+            )
+                : ctrl_{other.ctrl_}, slot_{other.slot_}
+            { /* DUMMY BODY */ }
+
+            reference operator*() const
+            {
+                return *slot_;
+            }
+
+            pointer operator->() const
+            {
+                return slot_;
+            }
+
+            flat_hash_table_iterator& operator++()
+            {
+                ++ctrl_;
+                ++slot_;
+                skip_empty_or_deleted_();
+
+                return *this;
+            }
+
+            flat_hash_table_iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++(*this);
+
+                return tmp;
+            }
+
+            template<class Ref, class Ptr>
+            bool operator==(const flat_hash_table_iterator<Value, Ref, Ptr>& other) const
+            {
+                return ctrl_ == other.ctrl_;
+            }
+
+            template<class Ref, class Ptr>
+            bool operator!=(const flat_hash_table_iterator<Value, Ref, Ptr>& other) const
+            {
+                return ctrl_ != other.ctrl_;
+            }
+
+        private:
+            const int8_t* ctrl_;
+            Value* slot_;
+
+            void skip_empty_or_deleted_()
+            {
+                while (*ctrl_ < flat_ctrl::sentinel)
+                {
+                    auto shift = flat_group{ctrl_}.count_leading_empty_or_deleted();
+
+                    ctrl_ += shift;
+                    slot_ += shift;
+                }
+            }
+
+            template<class, class, class>
+            friend class flat_hash_table_iterator;
+
+            template<class, class, class, class, class, class>
+            friend class flat_hash_table;
+    };
+
+    template<
+        class Value, class Key, class KeyExtractor,
+        class Hasher, class KeyEq, class Alloc
+    >
+    class flat_hash_table
+    {
+        public:
+            using value_type     = Value;
+            using key_type       = Key;
+            using size_type      = size_t;
+            using allocator_type = Alloc;
+            using key_equal      = KeyEq;
+            using hasher         = Hasher;
+            using key_extract    = KeyExtractor;
+
+            using iterator = flat_hash_table_iterator<
+                value_type, value_type&, value_type*
+            >;
+            using const_iterator = flat_hash_table_iterator<
+                value_type, const value_type&, const value_type*
+            >;
+
+            using group = flat_group;
+
+            flat_hash_table(size_type n, const hasher& hf, const key_equal& eql,
+                            const allocator_type& alloc)
+                : ctrl_{const_cast<int8_t*>(flat_empty_group)}, slots_{},
+                  capacity_{}, size_{}, growth_left_{}, hasher_{hf},
+                  key_eq_{eql}, key_extractor_{}, allocator_{alloc}
+            {
+                if (n > 0)
+                    resize_(normalize_capacity_(n));
+            }
+
+            flat_hash_table(const flat_hash_table& other)
+                : flat_hash_table{
+                    0, other.hasher_, other.key_eq_,
+                    allocator_traits<allocator_type>::
+                        select_on_container_copy_construction(other.allocator_)
+                  }
+            {
+                copy_from_(other);
+            }
+
+            flat_hash_table(flat_hash_table&& other)
+                : ctrl_{other.ctrl_}, slots_{other.slots_},
+                  capacity_{other.capacity_}, size_{other.size_},
+                  growth_left_{other.growth_left_}, hasher_{move(other.hasher_)},
+                  key_eq_{move(other.key_eq_)}, key_extractor_{},
+                  allocator_{move(other.allocator_)}
+            {
+                other.reset_();
+            }
+
+            flat_hash_table& operator=(const flat_hash_table& other)
+            {
+                if (this == &other)
+                    return *this;
+
+                clear();
+                hasher_ = other.hasher_;
+                key_eq_ = other.key_eq_;
+                copy_from_(other);
+
+                return *this;
+            }
+
+            flat_hash_table& operator=(flat_hash_table&& other)
+            {
+                if (this == &other)
+                    return *this;
+
+                destroy_();
+                ctrl_ = other.ctrl_;
+                slots_ = other.slots_;
+                capacity_ = other.capacity_;
+                size_ = other.size_;
+                growth_left_ = other.growth_left_;
+                hasher_ = move(other.hasher_);
+                key_eq_ = move(other.key_eq_);
+                allocator_ = move(other.allocator_);
+                other.reset_();
+
+                return *this;
+            }
+
+            ~flat_hash_table()
+            {
+                destroy_();
+            }
+
+            iterator begin() noexcept
+            {
+                auto it = iterator{ctrl_, slots_};
+                it.skip_empty_or_deleted_();
+
+                return it;
+            }
+
+            const_iterator begin() const noexcept
+            {
+                auto it = const_iterator{ctrl_, slots_};
+                it.skip_empty_or_deleted_();
+
+                return it;
+            }
+
+            iterator end() noexcept
+            {
+                return iterator{ctrl_ + capacity_, slots_ + capacity_};
+            }
+
+            const_iterator end() const noexcept
+            {
+                return const_iterator{ctrl_ + capacity_, slots_ + capacity_};
+            }
+
+            bool empty() const noexcept
+            {
+                return size_ == 0;
+            }
+
+            size_type size() const noexcept
+            {
+                return size_;
+            }
+
+            size_type max_size() const noexcept
+            {
+                return allocator_traits<allocator_type>::max_size(allocator_);
+            }
+
+            size_type capacity() const noexcept
+            {
+                return capacity_;
+            }
+
+            float load_factor() const noexcept
+            {
+                return capacity_ ? size_ / static_cast<float>(capacity_) : 0.f;
+            }
+
+            /**
+             * The table is always kept at most 7/8 full.
+             */
+            float max_load_factor() const noexcept
+            {
+                return 7.f / 8.f;
+            }
+
+            hasher hash_function() const
+            {
+                return hasher_;
+            }
+
+            key_equal key_eq() const
+            {
+                return key_eq_;
+            }
+
+            allocator_type get_allocator() const noexcept
+            {
+                return allocator_;
+            }
+
+            template<class K>
+            iterator find(const K& key)
+            {
+                auto idx = find_index_(key, hash_(key));
+                if (idx == npos_)
+                    return end();
+
+                return iterator_at_(idx);
+            }
+
+            template<class K>
+            const_iterator find(const K& key) const
+            {
+                auto idx = find_index_(key, hash_(key));
+                if (idx == npos_)
+                    return end();
+
+                return const_iterator{ctrl_ + idx, slots_ + idx};
+            }
+
+            /**
+             * Looks the key up and if it's not present, reserves
+             * a slot for it. The caller has to construct a value
+             * in the slot when the second member is true.
+             */
+            pair<iterator, bool> find_or_prepare_insert(const key_type& key)
+            {
+                auto hash = hash_(key);
+                auto idx = find_index_(key, hash);
+                if (idx != npos_)
+                    return make_pair(iterator_at_(idx), false);
+
+                idx = prepare_insert_(hash);
+
+                return make_pair(iterator_at_(idx), true);
+            }
+
+            template<class... Args>
+            void construct_at(iterator it, Args&&... args)
+            {
+                allocator_traits<allocator_type>::construct(
+                    allocator_, it.slot_, forward<Args>(args)...
+                );
+            }
+
+            template<class... Args>
+            pair<iterator, bool> emplace(Args&&... args)
+            {
+                /**
+                 * The key is only known once the value is
+                 * constructed, so it is built aside first.
+                 */
+                value_type val(forward<Args>(args)...);
+
+                auto res = find_or_prepare_insert(key_extractor_(val));
+                if (res.second)
+                    construct_at(res.first, move(val));
+
+                return res;
+            }
+
+            pair<iterator, bool> insert(const value_type& val)
+            {
+                auto res = find_or_prepare_insert(key_extractor_(val));
+                if (res.second)
+                    construct_at(res.first, val);
+
+                return res;
+            }
+
+            pair<iterator, bool> insert(value_type&& val)
+            {
+                auto res = find_or_prepare_insert(key_extractor_(val));
+                if (res.second)
+                    construct_at(res.first, move(val));
+
+                return res;
+            }
+
+            /**
+             * Nothing is moved by an erase, so the
+             * other iterators remain valid.
+             */
+            iterator erase(const_iterator it)
+            {
+                auto idx = static_cast<size_type>(it.ctrl_ - ctrl_);
+                erase_index_(idx);
+
+                auto next = iterator_at_(idx);
+
+                return ++next;
+            }
+
+            template<class K>
+            size_type erase(const K& key)
+            {
+                auto idx = find_index_(key, hash_(key));
+                if (idx == npos_)
+                    return 0;
+
+                erase_index_(idx);
+
+                return 1;
+            }
+
+            void clear() noexcept
+            {
+                if (capacity_ == 0)
+                    return;
+
+                for (size_type i = 0; i < capacity_; ++i)
+                {
+                    if (flat_ctrl::is_full(ctrl_[i]))
+                        allocator_traits<allocator_type>::destroy(allocator_, slots_ + i);
+                }
+
+                reset_ctrl_();
+                size_ = 0;
+                growth_left_ = capacity_to_growth_(capacity_);
+            }
+
+            void swap(flat_hash_table& other)
+            {
+                std::swap(ctrl_, other.ctrl_);
+                std::swap(slots_, other.slots_);
+                std::swap(capacity_, other.capacity_);
+                std::swap(size_, other.size_);
+                std::swap(growth_left_, other.growth_left_);
+                std::swap(hasher_, other.hasher_);
+                std::swap(key_eq_, other.key_eq_);
+                std::swap(allocator_, other.allocator_);
+            }
+
+            /**
+             * Makes room for at least n elements
+             * without further rehashing.
+             */
+            void reserve(size_type n)
+            {
+                if (n > size_ + growth_left_)
+                    resize_(normalize_capacity_(growth_to_capacity_(n)));
+            }
+
+            /**
+             * Also gets rid of all tombstones, rehash(0) shrinks
+             * the table to the smallest capacity that fits.
+             */
+            void rehash(size_type n)
+            {
+                if (n == 0 && size_ == 0)
+                {
+                    destroy_();
+                    reset_();
+
+                    return;
+                }
+
+                auto needed = growth_to_capacity_(size_);
+                resize_(normalize_capacity_(n > needed ? n : needed));
+            }
+
+        private:
+            int8_t* ctrl_;
+            value_type* slots_;
+            size_type capacity_;
+            size_type size_;
+            size_type growth_left_;
+
+            hasher hasher_;
+            key_equal key_eq_;
+            key_extract key_extractor_;
+            allocator_type allocator_;
+
+            static constexpr size_type npos_{static_cast<size_type>(-1)};
+
+            /**
+             * Probes groups of control bytes in a triangular
+             * sequence, with a power of two number of groups
+             * every group is visited exactly once.
+             */
+            class probe_seq
+            {
+                public:
+                    probe_seq(size_type hash, size_type mask)
+                        : mask_{mask}, offset_{hash & mask}, index_{}
+                    { /* DUMMY BODY */ }
+
+                    size_type offset() const
+                    {
+                        return offset_;
+                    }
+
+                    size_type offset(size_type i) const
+                    {
+                        return (offset_ + i) & mask_;
+                    }
+
+                    void next()
+                    {
+                        index_ += group::width;
+                        offset_ = (offset_ + index_) & mask_;
+                    }
+
+                private:
+                    size_type mask_;
+                    size_type offset_;
+                    size_type index_;
+            };
+
+            template<class K>
+            size_t hash_(const K& key) const
+            {
+                /**
+                 * Our std::hash of integers is the identity, which
+                 * would leave h2 equal to the low bits of the key
+                 * and h1 without any entropy, so the value is mixed.
+                 */
+                uint64_t h = hasher_(key);
+                h *= 0x9E3779B97F4A7C15ULL;
+
+                return static_cast<size_t>(h ^ (h >> 32));
+            }
+
+            static size_type h1_(size_t hash)
+            {
+                return hash >> 7;
+            }
+
+            static int8_t h2_(size_t hash)
+            {
+                return static_cast<int8_t>(hash & 0x7F);
+            }
+
+            iterator iterator_at_(size_type idx)
+            {
+                return iterator{ctrl_ + idx, slots_ + idx};
+            }
+
+            template<class K>
+            size_type find_index_(const K& key, size_t hash) const
+            {
+                probe_seq seq{h1_(hash), capacity_};
+                auto h2 = h2_(hash);
+
+                while (true)
+                {
+                    group g{ctrl_ + seq.offset()};
+
+                    for (auto m = g.match(h2); m; m.clear_lowest())
+                    {
+                        auto idx = seq.offset(m.lowest());
+                        if (key_eq_(key_extractor_(slots_[idx]), key))
+                            return idx;
+                    }
+
+                    if (g.match_empty())
+                        return npos_;
+
+                    seq.next();
+                }
+            }
+
+            size_type find_first_non_full_(size_t hash) const
+            {
+                probe_seq seq{h1_(hash), capacity_};
+
+                while (true)
+                {
+                    auto m = group{ctrl_ + seq.offset()}.match_empty_or_deleted();
+                    if (m)
+                        return seq.offset(m.lowest());
+
+                    seq.next();
+                }
+            }
+
+            size_type prepare_insert_(size_t hash)
+            {
+                auto idx = find_first_non_full_(hash);
+                if (growth_left_ == 0 && ctrl_[idx] != flat_ctrl::deleted)
+                {
+                    grow_();
+                    idx = find_first_non_full_(hash);
+                }
+
+                ++size_;
+                if (ctrl_[idx] == flat_ctrl::empty)
+                    --growth_left_;
+                set_ctrl_(idx, h2_(hash));
+
+                return idx;
+            }
+
+            void erase_index_(size_type idx)
+            {
+                allocator_traits<allocator_type>::destroy(allocator_, slots_ + idx);
+                --size_;
+
+                /**
+                 * If the slot was never part of a full group, no
+                 * probe sequence could have passed over it and it
+                 * can become empty again instead of a tombstone.
+                 */
+                auto before = (idx - group::width) & capacity_;
+                auto empty_after = group{ctrl_ + idx}.match_empty();
+                auto empty_before = group{ctrl_ + before}.match_empty();
+
+                bool was_never_full = empty_before && empty_after &&
+                    (empty_after.trailing_zeros() +
+                     empty_before.leading_zeros()) < group::width;
+
+                if (was_never_full)
+                {
+                    set_ctrl_(idx, flat_ctrl::empty);
+                    ++growth_left_;
+                }
+                else
+                    set_ctrl_(idx, flat_ctrl::deleted);
+            }
+
+            void set_ctrl_(size_type idx, int8_t c)
+            {
+                constexpr auto cloned = group::width - 1;
+
+                ctrl_[idx] = c;
+                ctrl_[((idx - cloned) & capacity_) + (cloned & capacity_)] = c;
+            }
+
+            static size_type normalize_capacity_(size_type n)
+            {
+                size_type cap = group::width - 1;
+                while (cap < n)
+                    cap = cap * 2 + 1;
+
+                return cap;
+            }
+
+            static size_type capacity_to_growth_(size_type cap)
+            {
+                if (group::width == 8 && cap == 7)
+                    return 6;
+
+                return cap - cap / 8;
+            }
+
+            static size_type growth_to_capacity_(size_type growth)
+            {
+                if (growth == 0)
+                    return 0;
+                if (group::width == 8 && growth == 7)
+                    return 8;
+
+                return growth + (growth - 1) / 7;
+            }
+
+            void grow_()
+            {
+                /**
+                 * When most of the used up growth is taken by
+                 * tombstones, rehashing in place is enough.
+                 */
+                if (capacity_ > group::width && size_ * 32 <= capacity_ * 25)
+                    resize_(capacity_);
+                else
+                    resize_(capacity_ ? capacity_ * 2 + 1 : group::width - 1);
+            }
+
+            void reset_ctrl_()
+            {
+                __builtin_memset(ctrl_, static_cast<uint8_t>(flat_ctrl::empty),
+                                 capacity_ + group::width);
+                ctrl_[capacity_] = flat_ctrl::sentinel;
+            }
+
+            void resize_(size_type new_capacity)
+            {
+                auto old_ctrl = ctrl_;
+                auto old_slots = slots_;
+                auto old_capacity = capacity_;
+
+                ctrl_ = new int8_t[new_capacity + group::width];
+                slots_ = allocator_traits<allocator_type>::allocate(
+                    allocator_, new_capacity
+                );
+                capacity_ = new_capacity;
+                reset_ctrl_();
+
+                for (size_type i = 0; i < old_capacity; ++i)
+                {
+                    if (!flat_ctrl::is_full(old_ctrl[i]))
+                        continue;
+
+                    auto hash = hash_(key_extractor_(old_slots[i]));
+                    auto idx = find_first_non_full_(hash);
+                    set_ctrl_(idx, h2_(hash));
+
+                    allocator_traits<allocator_type>::construct(
+                        allocator_, slots_ + idx, move(old_slots[i])
+                    );
+                    allocator_traits<allocator_type>::destroy(
+                        allocator_, old_slots + i
+                    );
+                }
+
+                growth_left_ = capacity_to_growth_(capacity_) - size_;
+
+                if (old_capacity > 0)
+                {
+                    delete[] old_ctrl;
+                    allocator_traits<allocator_type>::deallocate(
+                        allocator_, old_slots, old_capacity
+                    );
+                }
+            }
+
+            void copy_from_(const flat_hash_table& other)
+            {
+                reserve(other.size_);
+                for (const auto& val: other)
+                {
+                    auto hash = hash_(key_extractor_(val));
+                    auto idx = prepare_insert_(hash);
+
+                    allocator_traits<allocator_type>::construct(
+                        allocator_, slots_ + idx, val
+                    );
+                }
+            }
+
+            void destroy_()
+            {
+                if (capacity_ == 0)
+                    return;
+
+                clear();
+                delete[] ctrl_;
+                allocator_traits<allocator_type>::deallocate(
+                    allocator_, slots_, capacity_
+                );
+            }
+
+            void reset_()
+            {
+                ctrl_ = const_cast<int8_t*>(flat_empty_group);
+                slots_ = nullptr;
+                capacity_ = 0;
+                size_ = 0;
+                growth_left_ = 0;
+            }
+    };
+}
+
+#endif
@@ -356,7 +356,7 @@ namespace std
 
             const_reference back() const
             {
-                return at(size - 1);
+                return at(size_ - 1);
             }
 
             T* data() noexcept
@@ -734,48 +734,43 @@ namespace std
      * 25.4.1.5, is_sorted:
      */
 
-    template<class ForwardIterator>
-    bool is_sorted(ForwardIterator first, ForwardIterator last)
-    {
-        return is_sorted_until(first, last) == last;
-    }
-
     template<class ForwardIterator, class Comp>
-    bool is_sorted(ForwardIterator first, ForwardIterator last,
-                   Comp comp)
-    {
-        return is_sorted_until(first, last, comp) == last;
-    }
-
-    template<class ForwardIterator>
-    ForwardIterator is_sorted_until(ForwardIterator first, ForwardIterator last)
+    ForwardIterator is_sorted_until(ForwardIterator first, ForwardIterator last,
+                                    Comp comp)
     {
-        if (distance(first, last) < 2)
+        if (first == last)
             return last;
 
-        while (first != last)
+        auto prev = first;
+        while (++first != last)
         {
-            if (*first > *(++first))
+            if (comp(*first, *prev))
                 return first;
+            prev = first;
         }
 
         return last;
     }
 
-    template<class ForwardIterator, class Comp>
-    ForwardIterator is_sorted_until(ForwardIterator first, ForwardIterator last,
-                                    Comp comp)
+    template<class ForwardIterator>
+    ForwardIterator is_sorted_until(ForwardIterator first, ForwardIterator last)
     {
-        if (distance(first, last) < 2)
-            return last;
+        using value_type = typename iterator_traits<ForwardIterator>::value_type;
 
-        while (first != last)
-        {
-            if (!comp(*first, *(++first)))
-                return first;
-        }
+        return is_sorted_until(first, last, less<value_type>{});
+    }
 
-        return last;
+    template<class ForwardIterator>
+    bool is_sorted(ForwardIterator first, ForwardIterator last)
+    {
+        return is_sorted_until(first, last) == last;
+    }
+
+    template<class ForwardIterator, class Comp>
+    bool is_sorted(ForwardIterator first, ForwardIterator last,
+                   Comp comp)
+    {
+        return is_sorted_until(first, last, comp) == last;
     }
 
     /**
@@ -816,7 +811,39 @@ namespace std
      * 25.4.4, merge:
      */
 
-    // TODO: implement
+    template<class InputIterator1, class InputIterator2,
+             class OutputIterator, class Compare>
+    OutputIterator merge(InputIterator1 first1, InputIterator1 last1,
+                         InputIterator2 first2, InputIterator2 last2,
+                         OutputIterator result, Compare comp)
+    {
+        while (first1 != last1 && first2 != last2)
+        {
+            if (comp(*first2, *first1))
+                *result++ = *first2++;
+            else
+                *result++ = *first1++;
+        }
+
+        while (first1 != last1)
+            *result++ = *first1++;
+        while (first2 != last2)
+            *result++ = *first2++;
+
+        return result;
+    }
+
+    template<class InputIterator1, class InputIterator2,
+             class OutputIterator>
+    OutputIterator merge(InputIterator1 first1, InputIterator1 last1,
+                         InputIterator2 first2, InputIterator2 last2,
+                         OutputIterator result)
+    {
+        using value_type = typename iterator_traits<InputIterator1>::value_type;
+
+        return merge(first1, last1, first2, last2,
+                     result, less<value_type>{});
+    }
 
     /**
      * 25.4.5, set operations on sorted structures:
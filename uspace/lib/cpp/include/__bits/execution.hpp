@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_EXECUTION
+#define LIBCPP_BITS_EXECUTION
+
+#include <iterator>
+#include <type_traits>
+
+namespace std
+{
+    /**
+     * 20.19.x, execution policies (C++17):
+     */
+
+    namespace execution
+    {
+        class sequenced_policy
+        { /* DUMMY BODY */ };
+
+        class parallel_policy
+        { /* DUMMY BODY */ };
+
+        class parallel_unsequenced_policy
+        { /* DUMMY BODY */ };
+
+        inline constexpr sequenced_policy seq{};
+        inline constexpr parallel_policy par{};
+        inline constexpr parallel_unsequenced_policy par_unseq{};
+    }
+
+    template<class T>
+    struct is_execution_policy: false_type
+    { /* DUMMY BODY */ };
+
+    template<>
+    struct is_execution_policy<execution::sequenced_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    template<>
+    struct is_execution_policy<execution::parallel_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    template<>
+    struct is_execution_policy<execution::parallel_unsequenced_policy>: true_type
+    { /* DUMMY BODY */ };
+
+    template<class T>
+    inline constexpr bool is_execution_policy_v = is_execution_policy<T>::value;
+
+    namespace aux
+    {
+        /**
+         * Used to keep the parallel overloads of the algorithms
+         * from being selected instead of the sequential ones that
+         * take the same number of arguments.
+         */
+        template<class ExecutionPolicy, class T>
+        using enable_if_policy_t = enable_if_t<
+            is_execution_policy_v<decay_t<ExecutionPolicy>>, T
+        >;
+
+        /**
+         * The parallel versions of the algorithms only split random
+         * access ranges (and only when not told to run sequentially),
+         * everything else is handed over to the sequential versions.
+         */
+        template<class ExecutionPolicy, class... Iterators>
+        inline constexpr bool run_parallel_v =
+            !is_same_v<decay_t<ExecutionPolicy>, execution::sequenced_policy> &&
+            (is_base_of_v<
+                random_access_iterator_tag,
+                typename iterator_traits<Iterators>::iterator_category
+            > && ...);
+
+        /**
+         * Smallest number of elements processed by a single task,
+         * below this the cost of waking up the workers would
+         * outweigh the gain.
+         */
+        inline constexpr size_t parallel_grain{2048};
+    }
+}
+
+#endif
@@ -127,6 +127,13 @@ namespace std
                 if (!file_)
                     return nullptr;
 
+                /**
+                 * The buffering is done here, leaving stdio's buffer
+                 * in place would only add a copy of all the data and
+                 * split large transfers into small ones.
+                 */
+                std::setbuf(file_, nullptr);
+
                 if ((mode_ & ios_base::ate) != 0)
                 {
                     if (fseek(file_, 0, SEEK_END) != 0)
@@ -157,8 +164,7 @@ namespace std
                     return nullptr;
                 // TODO: deallocate buffers?
 
-                if (this->output_next_ != this->output_begin_)
-                    overflow(traits_type::eof());
+                write_out_();
                 // TODO: unshift? (p. 1084 at the top)
 
                 fclose(file_);
@@ -178,46 +184,73 @@ namespace std
                 if (!mode_is_in_(mode_))
                     return traits_type::eof();
 
+                if (this->read_avail_())
+                    return traits_type::to_int_type(*this->input_next_);
+
+                if (!write_out_())
+                    return traits_type::eof();
+
                 if (!ibuf_)
-                {
                     ibuf_ = new char_type[buf_size_];
-                    this->input_begin_ = this->input_next_ = this->input_end_ = ibuf_;
-                }
 
-                off_type i{};
-                if (this->input_next_ < this->input_end_)
+                /**
+                 * The last character stays in front of the new data,
+                 * so that there is always one character to put back.
+                 */
+                size_t keep{};
+                if (this->input_next_ && this->input_next_ != this->input_begin_)
                 {
-                    auto idx = static_cast<off_type>(this->input_next_ - this->input_begin_);
-                    auto count = static_cast<off_type>(buf_size_) - idx;
-
-                    for (; i < count; ++i, ++idx)
-                        ibuf_[i] = ibuf_[idx];
+                    ibuf_[0] = this->input_next_[-1];
+                    keep = 1;
                 }
 
-                for (; i < static_cast<off_type>(buf_size_); ++i)
-                {
-                    auto c = fgetc(file_);
-                    if (c == traits_type::eof())
-                        break;
-
-                    ibuf_[i] = static_cast<char_type>(c);
-
-                    if (ibuf_[i] == '\n')
-                    {
-                        ++i;
-                        break;
-                    }
-                }
+                auto count = fread(ibuf_ + keep, sizeof(char_type),
+                                   buf_size_ - keep, file_);
 
-                this->input_next_ = this->input_begin_;
-                this->input_end_ = this->input_begin_ + i;
+                this->setg(ibuf_, ibuf_ + keep, ibuf_ + keep + count);
 
-                if (i == 0)
+                if (count == 0)
                     return traits_type::eof();
 
                 return traits_type::to_int_type(*this->input_next_);
             }
 
+            streamsize xsgetn(char_type* s, streamsize n) override
+            {
+                if (!s || n <= 0 || !mode_is_in_(mode_))
+                    return 0;
+
+                /**
+                 * What is buffered is copied, if the rest of the
+                 * request is at least a whole buffer, it is read
+                 * directly to the destination.
+                 */
+                streamsize avail{};
+                if (this->read_avail_())
+                    avail = this->egptr() - this->gptr();
+
+                if (n - avail < static_cast<streamsize>(buf_size_))
+                    return basic_streambuf<char_type, traits_type>::xsgetn(s, n);
+
+                traits_type::copy(s, this->gptr(), avail);
+                this->gbump(avail);
+
+                if (!write_out_())
+                    return avail;
+
+                auto count = fread(s + avail, sizeof(char_type), n - avail, file_);
+                if (avail + count > 0)
+                {
+                    // Keep the last character for putback.
+                    if (!ibuf_)
+                        ibuf_ = new char_type[buf_size_];
+                    ibuf_[0] = s[avail + count - 1];
+                    this->setg(ibuf_, ibuf_ + 1, ibuf_ + 1);
+                }
+
+                return avail + count;
+            }
+
             int_type pbackfail(int_type c = traits_type::eof()) override
             {
                 auto cc = traits_type::to_char_type(c);
@@ -253,15 +286,39 @@ namespace std
                 if (!mode_is_out_(mode_))
                     return traits_type::eof();
 
-                auto count = static_cast<size_t>(this->output_next_ - this->output_begin_);
-                fwrite(obuf_, sizeof(char_type), count, file_);
-                fflush(file_);
+                if (!obuf_)
+                {
+                    obuf_ = new char_type[buf_size_];
+                    this->setp(obuf_, obuf_ + buf_size_);
+                }
+
+                if (!write_out_())
+                    return traits_type::eof();
 
-                this->output_next_ = this->output_begin_;
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                    traits_type::assign(*this->output_next_++, traits_type::to_char_type(c));
 
                 return traits_type::not_eof(c);
             }
 
+            streamsize xsputn(const char_type* s, streamsize n) override
+            {
+                if (!s || n <= 0 || !mode_is_out_(mode_))
+                    return 0;
+
+                if (this->write_avail_() && n < this->epptr() - this->pptr())
+                    return basic_streambuf<char_type, traits_type>::xsputn(s, n);
+
+                /**
+                 * The request does not fit in the buffer, so the buffer
+                 * is written out and the data follow in a single call.
+                 */
+                if (!write_out_())
+                    return 0;
+
+                return fwrite(s, sizeof(char_type), n, file_);
+            }
+
             basic_streambuf<char_type, traits_type>*
             setbuf(char_type* s, streamsize n) override
             {
@@ -285,10 +342,7 @@ namespace std
 
             int sync() override
             {
-                if (mode_is_out_(mode_))
-                    overflow();
-
-                return 0; // TODO: what is the correct return value?
+                return write_out_() ? 0 : -1;
             }
 
             void imbue(const locale& loc) override
@@ -305,7 +359,11 @@ namespace std
 
             FILE* file_;
 
-            static constexpr size_t buf_size_{128};
+            /**
+             * Every refill or write out is a single VFS
+             * request, so the buffer is kept fairly large.
+             */
+            static constexpr size_t buf_size_{16 * 1024};
 
             const char* get_mode_str_(ios_base::openmode mode)
             {
@@ -359,6 +417,38 @@ namespace std
                 return (mode & (ios_base::out | ios_base::app | ios_base::trunc)) != 0;
             }
 
+            /**
+             * Writes out the put area. If the get area has data that
+             * were read ahead, the file position is first moved back
+             * to where the reading really stopped, so that the data
+             * end up where the program expects them.
+             */
+            bool write_out_()
+            {
+                if (!file_)
+                    return false;
+
+                if (this->read_avail_() && (mode_ & ios_base::out) != 0)
+                {
+                    auto ahead = static_cast<long>(
+                        (this->egptr() - this->gptr()) * sizeof(char_type)
+                    );
+                    if (fseek(file_, -ahead, SEEK_CUR) != 0)
+                        return false;
+                    this->setg(this->eback(), this->gptr(), this->gptr());
+                }
+
+                auto count = static_cast<size_t>(this->pptr() - this->pbase());
+                if (count > 0)
+                {
+                    this->setp(this->pbase(), this->epptr());
+                    if (fwrite(this->pbase(), sizeof(char_type), count, file_) != count)
+                        return false;
+                }
+
+                return true;
+            }
+
             void init_()
             {
                 if (ibuf_)
@@ -595,17 +595,9 @@ namespace std
                     return *this;
                 }
 
-                while (gcount_ < n)
-                {
-                    auto c = this->rdbuf()->sbumpc();
-                    if (traits_type::eq_int_type(c, traits_type::eof()))
-                    {
-                        this->setstate(ios_base::failbit | ios_base::eofbit);
-                        break;
-                    }
-
-                    s[gcount_++] = traits_type::to_char_type(c);
-                }
+                gcount_ = this->rdbuf()->sgetn(s, n);
+                if (gcount_ < n)
+                    this->setstate(ios_base::failbit | ios_base::eofbit);
 
                 return *this;
             }
@@ -629,8 +621,7 @@ namespace std
                 } else if (avail > 0)
                 {
                     auto count = (avail < n ? avail : n);
-                    while (gcount_ < count)
-                        s[gcount_++] = traits_type::to_char_type(this->rdbuf()->sbumpc());
+                    gcount_ = this->rdbuf()->sgetn(s, count);
                 }
 
                 return gcount_;
@@ -419,15 +419,8 @@ namespace std
 
                 if (sen)
                 {
-                    for (streamsize i = 0; i < n; ++i)
-                    {
-                        auto ret = this->rdbuf()->sputc(s[i]);
-                        if (traits_type::eq_int_type(ret, traits_type::eof()))
-                        {
-                            this->setstate(ios_base::badbit);
-                            break;
-                        }
-                    }
+                    if (this->rdbuf()->sputn(s, n) != n)
+                        this->setstate(ios_base::badbit);
                 }
 
                 return *this;
@@ -671,31 +664,24 @@ namespace std
         basic_ostream<Char, Traits>& insert(basic_ostream<Char, Traits>& os,
                                             const Char* str, size_t len)
         {
+            size_t to_pad{};
             if (os.width() > 0 && static_cast<size_t>(os.width()) > len)
-            {
-                size_t to_pad = (static_cast<size_t>(os.width()) - len);
+                to_pad = (static_cast<size_t>(os.width()) - len);
 
-                if ((os.flags() & ios_base::adjustfield) != ios_base::left)
-                {
-                    for (size_t i = 0; i < to_pad; ++i)
-                        os.put(os.fill());
-                    for (size_t i = 0; i < len; ++i)
-                        os.put(os.widen(str[i]));
-                }
-                else
-                {
-                    for (size_t i = 0; i < len; ++i)
-                        os.put(os.widen(str[i]));
-                    for (size_t i = 0; i < to_pad; ++i)
-                        os.put(os.fill());
-                }
-            }
-            else
+            if ((os.flags() & ios_base::adjustfield) != ios_base::left)
             {
-                for (size_t i = 0; i < len; ++i)
-                    os.put(os.widen(str[i]));
+                for (size_t i = 0; i < to_pad; ++i)
+                    os.put(os.fill());
+                to_pad = 0;
             }
 
+            auto written = os.rdbuf()->sputn(str, static_cast<streamsize>(len));
+            if (written != static_cast<streamsize>(len))
+                os.setstate(ios_base::badbit);
+
+            for (size_t i = 0; i < to_pad; ++i)
+                os.put(os.fill());
+
             os.width(0);
             return os;
         }
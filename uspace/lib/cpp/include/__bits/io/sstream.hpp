@@ -72,9 +72,13 @@ namespace std
             basic_stringbuf(const basic_stringbuf&) = delete;
 
             basic_stringbuf(basic_stringbuf&& other)
-                : mode_{move(other.mode_)}, str_{move(other.str_)}
+                : mode_{move(other.mode_)}, str_{}
             {
+                auto old_base = other.str_.begin();
+                str_ = move(other.str_);
+
                 basic_streambuf<char_type, traits_type>::swap(other);
+                rebase_(old_base);
             }
 
             /**
@@ -90,10 +94,15 @@ namespace std
 
             void swap(basic_stringbuf& rhs)
             {
+                auto old_base = str_.begin();
+                auto old_rhs_base = rhs.str_.begin();
+
                 std::swap(mode_, rhs.mode_);
                 std::swap(str_, rhs.str_);
 
                 basic_streambuf<char_type, traits_type>::swap(rhs);
+                rebase_(old_rhs_base);
+                rhs.rebase_(old_base);
             }
 
             /**
@@ -250,6 +259,26 @@ namespace std
                 }
             }
 
+            /**
+             * Short strings are stored inside the string object
+             * itself, so moving it to another stringbuf changes
+             * the address of its buffer and the get/put area
+             * pointers have to follow.
+             */
+            void rebase_(char_type* old_base)
+            {
+                auto new_base = str_.begin();
+                if (old_base == new_base)
+                    return;
+
+                for (auto ptr: {&this->input_begin_, &this->input_next_, &this->input_end_,
+                                &this->output_begin_, &this->output_next_, &this->output_end_})
+                {
+                    if (*ptr)
+                        *ptr = new_base + (*ptr - old_base);
+                }
+            }
+
             bool ensure_free_space_(size_t n = 1)
             {
                 str_.ensure_free_space_(n);
@@ -29,6 +29,7 @@
 #ifndef LIBCPP_BITS_IO_STREAMBUF
 #define LIBCPP_BITS_IO_STREAMBUF
 
+#include <__bits/algorithm.hpp>
 #include <ios>
 #include <iosfwd>
 #include <locale>
@@ -214,15 +215,15 @@ namespace std
 
             void swap(basic_streambuf& rhs)
             {
-                swap(input_begin_, rhs.input_begin_);
-                swap(input_next_, rhs.input_next_);
-                swap(input_end_, rhs.input_end_);
+                std::swap(input_begin_, rhs.input_begin_);
+                std::swap(input_next_, rhs.input_next_);
+                std::swap(input_end_, rhs.input_end_);
 
-                swap(output_begin_, rhs.output_begin_);
-                swap(output_next_, rhs.output_next_);
-                swap(output_end_, rhs.output_end_);
+                std::swap(output_begin_, rhs.output_begin_);
+                std::swap(output_next_, rhs.output_next_);
+                std::swap(output_end_, rhs.output_end_);
 
-                swap(locale_, rhs.locale_);
+                std::swap(locale_, rhs.locale_);
             }
 
             /**
@@ -332,17 +333,36 @@ namespace std
 
             virtual streamsize xsgetn(char_type* s, streamsize n)
             {
-                if (!s || n == 0)
+                if (!s || n <= 0)
                     return 0;
 
+                /**
+                 * Whole runs are copied from the get area, the virtual
+                 * functions are called only when it's exhausted.
+                 */
                 streamsize i{0};
                 auto eof = traits_type::eof();
-                for (; i <= n; ++i)
+                while (i < n)
                 {
-                    if (!read_avail_() && traits_type::eq_int_type(uflow(), eof))
-                        break;
-
-                    *s++ = *input_next_++;
+                    if (read_avail_())
+                    {
+                        auto count = min(
+                            static_cast<streamsize>(input_end_ - input_next_),
+                            n - i
+                        );
+
+                        traits_type::copy(s + i, input_next_, count);
+                        input_next_ += count;
+                        i += count;
+                    }
+                    else
+                    {
+                        auto c = uflow();
+                        if (traits_type::eq_int_type(c, eof))
+                            break;
+
+                        s[i++] = traits_type::to_char_type(c);
+                    }
                 }
 
                 return i;
@@ -377,16 +397,32 @@ namespace std
 
             virtual streamsize xsputn(const char_type* s, streamsize n)
             {
-                if (!s || n == 0)
+                if (!s || n <= 0)
                     return 0;
 
                 streamsize i{0};
-                for (; i <= n; ++i)
+                auto eof = traits_type::eof();
+                while (i < n)
                 {
-                    if (!write_avail_() && traits_type::eq_int_type(overflow(), traits_type::eof()))
-                        break;
-
-                    *output_next_++ = *s++;
+                    if (write_avail_())
+                    {
+                        auto count = min(
+                            static_cast<streamsize>(output_end_ - output_next_),
+                            n - i
+                        );
+
+                        traits_type::copy(output_next_, s + i, count);
+                        output_next_ += count;
+                        i += count;
+                    }
+                    else
+                    {
+                        auto c = traits_type::to_int_type(s[i]);
+                        if (traits_type::eq_int_type(overflow(c), eof))
+                            break;
+
+                        ++i;
+                    }
                 }
 
                 return i;
@@ -35,12 +35,23 @@
 
 namespace std::aux
 {
+    /**
+     * Note: The input buffer never reads ahead more than a line from
+     *       the stdio buffer of stdin. While the standard streams are
+     *       synchronized with stdio, the output buffer hands every
+     *       character to stdio right away, so that they can be mixed
+     *       with the C functions. Once the program calls
+     *       ios_base::sync_with_stdio(false), the output buffer
+     *       collects whole chunks instead.
+     */
+
     template<class Char, class Traits = char_traits<Char>>
     class stdin_streambuf : public basic_streambuf<Char, Traits>
     {
         public:
             stdin_streambuf()
-                : basic_streambuf<Char, Traits>{}, buffer_{nullptr}
+                : basic_streambuf<Char, Traits>{}, buffer_{nullptr},
+                  synced_{true}
             { /* DUMMY BODY */ }
 
             virtual ~stdin_streambuf()
@@ -49,6 +60,11 @@ namespace std::aux
                     delete[] buffer_;
             }
 
+            void sync_with_stdio(bool sync)
+            {
+                synced_ = sync;
+            }
+
         protected:
             using traits_type = Traits;
             using char_type   = typename traits_type::char_type;
@@ -71,16 +87,23 @@ namespace std::aux
                 if (input_next_ < input_end_)
                 {
                     auto idx = static_cast<off_type>(input_next_ - input_begin_);
-                    auto count = buf_size_ - idx;
+                    auto count = static_cast<off_type>(input_end_ - input_next_);
 
                     for (; i < count; ++i, ++idx)
                         buffer_[i] = buffer_[idx];
                 }
 
+                /**
+                 * Both modes read at most a line through the stdio buffer
+                 * of in_, a bulk fread would block interactive input until
+                 * the whole buffer is filled. Only the synchronized mode
+                 * echoes the input.
+                 */
                 for (; i < buf_size_; ++i)
                 {
                     auto c = fgetc(in_);
-                    putchar(c); // TODO: Temporary source of feedback.
+                    if (synced_)
+                        putchar(c); // TODO: Temporary source of feedback.
                     if (c == traits_type::eof())
                         break;
 
@@ -120,7 +143,9 @@ namespace std::aux
 
             char_type* buffer_;
 
-            static constexpr off_type buf_size_{128};
+            bool synced_;
+
+            static constexpr off_type buf_size_{BUFSIZ};
     };
 
     template<class Char, class Traits = char_traits<Char>>
@@ -128,11 +153,27 @@ namespace std::aux
     {
         public:
             stdout_streambuf()
-                : basic_streambuf<Char, Traits>{}
+                : basic_streambuf<Char, Traits>{}, buffer_{nullptr}
             { /* DUMMY BODY */ }
 
             virtual ~stdout_streambuf()
-            { /* DUMMY BODY */ }
+            {
+                if (buffer_)
+                    delete[] buffer_;
+            }
+
+            void sync_with_stdio(bool sync)
+            {
+                flush_buffer_();
+
+                if (!sync && !buffer_)
+                    buffer_ = new char_type[buf_size_];
+
+                if (sync)
+                    this->setp(nullptr, nullptr);
+                else
+                    this->setp(buffer_, buffer_ + buf_size_);
+            }
 
         protected:
             using traits_type = Traits;
@@ -142,10 +183,17 @@ namespace std::aux
 
             int_type overflow(int_type c = traits_type::eof()) override
             {
+                if (!flush_buffer_())
+                    return traits_type::eof();
+
                 if (!traits_type::eq_int_type(c, traits_type::eof()))
                 {
                     auto cc = traits_type::to_char_type(c);
-                    fwrite(&cc, sizeof(char_type), 1, out_);
+
+                    if (this->pbase())
+                        traits_type::assign(*this->output_next_++, cc);
+                    else if (fwrite(&cc, sizeof(char_type), 1, out_) != 1)
+                        return traits_type::eof();
                 }
 
                 return traits_type::not_eof(c);
@@ -153,18 +201,45 @@ namespace std::aux
 
             streamsize xsputn(const char_type* s, streamsize n) override
             {
+                /**
+                 * Small writes are only copied to the buffer, large
+                 * ones would not fit anyway, so they go straight
+                 * to stdio after the buffer is written out.
+                 */
+                if (this->pbase() && n < this->epptr() - this->pptr())
+                    return basic_streambuf<Char, Traits>::xsputn(s, n);
+
+                if (!flush_buffer_())
+                    return 0;
+
                 return fwrite(s, sizeof(char_type), n, out_);
             }
 
             int sync() override
             {
-                if (fflush(out_))
+                if (!flush_buffer_() || fflush(out_))
                     return -1;
                 return 0;
             }
 
         private:
             FILE* out_{stdout};
+
+            char_type* buffer_;
+
+            static constexpr size_t buf_size_{BUFSIZ};
+
+            bool flush_buffer_()
+            {
+                auto count = static_cast<size_t>(this->pptr() - this->pbase());
+                if (count == 0)
+                    return true;
+
+                this->setp(this->pbase(), this->epptr());
+
+                return fwrite(this->pbase(), sizeof(char_type),
+                              count, out_) == count;
+            }
     };
 }
 
@@ -29,6 +29,7 @@
 #ifndef LIBCPP_BITS_NUMERIC
 #define LIBCPP_BITS_NUMERIC
 
+#include <iterator>
 #include <utility>
 
 namespace std
@@ -87,6 +88,68 @@ namespace std
         return res;
     }
 
+    /**
+     * 26.7.x, reduce (C++17):
+     * Note: The sequential versions are evaluated left to right,
+     *       the parallel ones (see <execution>) are free to regroup
+     *       the operands.
+     */
+
+    template<class InputIterator, class T, class BinaryOperation>
+    T reduce(InputIterator first, InputIterator last, T init,
+             BinaryOperation op)
+    {
+        return accumulate(first, last, init, op);
+    }
+
+    template<class InputIterator, class T>
+    T reduce(InputIterator first, InputIterator last, T init)
+    {
+        return accumulate(first, last, init);
+    }
+
+    template<class InputIterator>
+    typename iterator_traits<InputIterator>::value_type
+    reduce(InputIterator first, InputIterator last)
+    {
+        using value_type = typename iterator_traits<InputIterator>::value_type;
+
+        return accumulate(first, last, value_type{});
+    }
+
+    /**
+     * 26.7.x, transform reduce (C++17):
+     */
+
+    template<class InputIterator, class T, class BinaryOperation,
+             class UnaryOperation>
+    T transform_reduce(InputIterator first, InputIterator last, T init,
+                       BinaryOperation reduce_op, UnaryOperation transform_op)
+    {
+        auto acc{init};
+        while (first != last)
+            acc = reduce_op(acc, transform_op(*first++));
+
+        return acc;
+    }
+
+    template<class InputIterator1, class InputIterator2, class T,
+             class BinaryOperation1, class BinaryOperation2>
+    T transform_reduce(InputIterator1 first1, InputIterator1 last1,
+                       InputIterator2 first2, T init,
+                       BinaryOperation1 reduce_op, BinaryOperation2 transform_op)
+    {
+        return inner_product(first1, last1, first2, init,
+                             reduce_op, transform_op);
+    }
+
+    template<class InputIterator1, class InputIterator2, class T>
+    T transform_reduce(InputIterator1 first1, InputIterator1 last1,
+                       InputIterator2 first2, T init)
+    {
+        return inner_product(first1, last1, first2, init);
+    }
+
     /**
      * 26.7.4, partial sum:
      */
@@ -0,0 +1,574 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_PARALLEL_ALGORITHM
+#define LIBCPP_BITS_PARALLEL_ALGORITHM
+
+#include <__bits/algorithm.hpp>
+#include <__bits/execution.hpp>
+#include <__bits/numeric.hpp>
+#include <__bits/thread/thread_pool.hpp>
+#include <vector>
+
+/**
+ * Overloads of the algorithms that take an execution policy.
+ * The ranges are split into chunks that are processed by the
+ * threads of aux::work_stealing_pool, the caller works on the
+ * first chunk and then helps with the rest until all are done.
+ */
+
+namespace std
+{
+    /**
+     * 25.2.4, for each:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator, class Function>
+    aux::enable_if_policy_t<ExecutionPolicy, void>
+    for_each(ExecutionPolicy&&, ForwardIterator first,
+             ForwardIterator last, Function f)
+    {
+        if constexpr (aux::run_parallel_v<ExecutionPolicy, ForwardIterator>)
+        {
+            aux::parallel_for(last - first, aux::parallel_grain,
+                [&](size_t begin, size_t end){
+                    for_each(first + begin, first + end, f);
+                }
+            );
+        }
+        else
+            for_each(first, last, f);
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator,
+             class Size, class Function>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator>
+    for_each_n(ExecutionPolicy&& policy, ForwardIterator first,
+               Size n, Function f)
+    {
+        if (n <= 0)
+            return first;
+
+        auto last = next(first, n);
+        for_each(forward<ExecutionPolicy>(policy), first, last, f);
+
+        return last;
+    }
+
+    /**
+     * 25.2.9, count:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator, class Predicate>
+    aux::enable_if_policy_t<
+        ExecutionPolicy,
+        typename iterator_traits<ForwardIterator>::difference_type
+    >
+    count_if(ExecutionPolicy&&, ForwardIterator first,
+             ForwardIterator last, Predicate pred)
+    {
+        using diff_t = typename iterator_traits<ForwardIterator>::difference_type;
+
+        if constexpr (aux::run_parallel_v<ExecutionPolicy, ForwardIterator>)
+        {
+            size_t n = last - first;
+            auto chunks = aux::parallel_chunks(n, aux::parallel_grain);
+            vector<diff_t> partial(chunks);
+
+            aux::parallel_for_chunks(n, chunks,
+                [&](size_t idx, size_t begin, size_t end){
+                    partial[idx] = count_if(first + begin, first + end, pred);
+                }
+            );
+
+            return accumulate(partial.begin(), partial.end(), diff_t{});
+        }
+        else
+            return count_if(first, last, pred);
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator, class T>
+    aux::enable_if_policy_t<
+        ExecutionPolicy,
+        typename iterator_traits<ForwardIterator>::difference_type
+    >
+    count(ExecutionPolicy&& policy, ForwardIterator first,
+          ForwardIterator last, const T& value)
+    {
+        return count_if(
+            forward<ExecutionPolicy>(policy), first, last,
+            [&value](const auto& x){ return x == value; }
+        );
+    }
+
+    /**
+     * 25.2.5, find:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator, class Predicate>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator>
+    find_if(ExecutionPolicy&&, ForwardIterator first,
+            ForwardIterator last, Predicate pred)
+    {
+        if constexpr (aux::run_parallel_v<ExecutionPolicy, ForwardIterator>)
+        {
+            size_t n = last - first;
+            size_t found{n};
+
+            /**
+             * Chunks that start after an already found match
+             * can stop, only the leftmost match counts.
+             */
+            aux::parallel_for(n, aux::parallel_grain,
+                [&](size_t begin, size_t end){
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        if (__atomic_load_n(&found, __ATOMIC_RELAXED) < begin)
+                            return;
+
+                        if (pred(*(first + i)))
+                        {
+                            auto prev = __atomic_load_n(&found, __ATOMIC_RELAXED);
+                            while (i < prev && !__atomic_compare_exchange_n(
+                                &found, &prev, i, false,
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED
+                            ))
+                            { /* DUMMY BODY */ }
+
+                            return;
+                        }
+                    }
+                }
+            );
+
+            return first + found;
+        }
+        else
+            return find_if(first, last, pred);
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator, class Predicate>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator>
+    find_if_not(ExecutionPolicy&& policy, ForwardIterator first,
+                ForwardIterator last, Predicate pred)
+    {
+        return find_if(
+            forward<ExecutionPolicy>(policy), first, last,
+            [&pred](const auto& x){ return !pred(x); }
+        );
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator, class T>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator>
+    find(ExecutionPolicy&& policy, ForwardIterator first,
+         ForwardIterator last, const T& value)
+    {
+        return find_if(
+            forward<ExecutionPolicy>(policy), first, last,
+            [&value](const auto& x){ return x == value; }
+        );
+    }
+
+    /**
+     * 25.2.1, all of:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator, class Predicate>
+    aux::enable_if_policy_t<ExecutionPolicy, bool>
+    all_of(ExecutionPolicy&& policy, ForwardIterator first,
+           ForwardIterator last, Predicate pred)
+    {
+        return find_if_not(forward<ExecutionPolicy>(policy),
+                           first, last, pred) == last;
+    }
+
+    /**
+     * 25.2.2, any of:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator, class Predicate>
+    aux::enable_if_policy_t<ExecutionPolicy, bool>
+    any_of(ExecutionPolicy&& policy, ForwardIterator first,
+           ForwardIterator last, Predicate pred)
+    {
+        return find_if(forward<ExecutionPolicy>(policy),
+                       first, last, pred) != last;
+    }
+
+    /**
+     * 25.2.3, none of:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator, class Predicate>
+    aux::enable_if_policy_t<ExecutionPolicy, bool>
+    none_of(ExecutionPolicy&& policy, ForwardIterator first,
+            ForwardIterator last, Predicate pred)
+    {
+        return find_if(forward<ExecutionPolicy>(policy),
+                       first, last, pred) == last;
+    }
+
+    /**
+     * 25.3.1, copy:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator1,
+             class ForwardIterator2>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator2>
+    copy(ExecutionPolicy&&, ForwardIterator1 first,
+         ForwardIterator1 last, ForwardIterator2 result)
+    {
+        if constexpr (aux::run_parallel_v<ExecutionPolicy,
+                                          ForwardIterator1, ForwardIterator2>)
+        {
+            size_t n = last - first;
+            aux::parallel_for(n, aux::parallel_grain,
+                [&](size_t begin, size_t end){
+                    copy(first + begin, first + end, result + begin);
+                }
+            );
+
+            return result + n;
+        }
+        else
+            return copy(first, last, result);
+    }
+
+    /**
+     * 25.3.4, transform:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator1,
+             class ForwardIterator2, class UnaryOperation>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator2>
+    transform(ExecutionPolicy&&, ForwardIterator1 first,
+              ForwardIterator1 last, ForwardIterator2 result,
+              UnaryOperation op)
+    {
+        if constexpr (aux::run_parallel_v<ExecutionPolicy,
+                                          ForwardIterator1, ForwardIterator2>)
+        {
+            size_t n = last - first;
+            aux::parallel_for(n, aux::parallel_grain,
+                [&](size_t begin, size_t end){
+                    transform(first + begin, first + end,
+                              result + begin, op);
+                }
+            );
+
+            return result + n;
+        }
+        else
+            return transform(first, last, result, op);
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator1,
+             class ForwardIterator2, class ForwardIterator3,
+             class BinaryOperation>
+    aux::enable_if_policy_t<ExecutionPolicy, ForwardIterator3>
+    transform(ExecutionPolicy&&, ForwardIterator1 first1,
+              ForwardIterator1 last1, ForwardIterator2 first2,
+              ForwardIterator3 result, BinaryOperation op)
+    {
+        if constexpr (aux::run_parallel_v<ExecutionPolicy, ForwardIterator1,
+                                          ForwardIterator2, ForwardIterator3>)
+        {
+            size_t n = last1 - first1;
+            aux::parallel_for(n, aux::parallel_grain,
+                [&](size_t begin, size_t end){
+                    transform(first1 + begin, first1 + end,
+                              first2 + begin, result + begin, op);
+                }
+            );
+
+            return result + n;
+        }
+        else
+            return transform(first1, last1, first2, result, op);
+    }
+
+    /**
+     * 25.3.6, fill:
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator, class T>
+    aux::enable_if_policy_t<ExecutionPolicy, void>
+    fill(ExecutionPolicy&&, ForwardIterator first,
+         ForwardIterator last, const T& value)
+    {
+        if constexpr (aux::run_parallel_v<ExecutionPolicy, ForwardIterator>)
+        {
+            aux::parallel_for(last - first, aux::parallel_grain,
+                [&](size_t begin, size_t end){
+                    fill(first + begin, first + end, value);
+                }
+            );
+        }
+        else
+            fill(first, last, value);
+    }
+
+    /**
+     * 25.4.1.1, sort:
+     */
+
+    template<class ExecutionPolicy, class RandomAccessIterator, class Compare>
+    aux::enable_if_policy_t<ExecutionPolicy, void>
+    sort(ExecutionPolicy&&, RandomAccessIterator first,
+         RandomAccessIterator last, Compare comp)
+    {
+        if constexpr (aux::run_parallel_v<ExecutionPolicy, RandomAccessIterator>)
+        {
+            using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+            /**
+             * The chunks are sorted independently and then merged
+             * pairwise, the merges of one round run in parallel
+             * and alternate between the range and a buffer.
+             */
+            size_t n = last - first;
+            auto chunks = aux::parallel_chunks(n, aux::parallel_grain);
+            if (chunks == 1)
+            {
+                sort(first, last, comp);
+
+                return;
+            }
+
+            aux::parallel_for_chunks(n, chunks,
+                [&](size_t, size_t begin, size_t end){
+                    sort(first + begin, first + end, comp);
+                }
+            );
+
+            vector<value_type> buffer(
+                make_move_iterator(first), make_move_iterator(last)
+            );
+            auto buf = buffer.begin();
+            bool in_buffer{true};
+
+            for (size_t width = 1; width < chunks; width *= 2)
+            {
+                auto pairs = (chunks + 2 * width - 1) / (2 * width);
+
+                aux::parallel_invoke(pairs, [&](size_t idx){
+                    auto lo = aux::chunk_begin(n, chunks, 2 * idx * width);
+                    auto mid_idx = min(chunks, (2 * idx + 1) * width);
+                    auto hi_idx = min(chunks, (2 * idx + 2) * width);
+                    auto mid = aux::chunk_begin(n, chunks, mid_idx);
+                    auto hi = aux::chunk_begin(n, chunks, hi_idx);
+
+                    if (in_buffer)
+                    {
+                        merge(make_move_iterator(buf + lo),
+                              make_move_iterator(buf + mid),
+                              make_move_iterator(buf + mid),
+                              make_move_iterator(buf + hi),
+                              first + lo, comp);
+                    }
+                    else
+                    {
+                        merge(make_move_iterator(first + lo),
+                              make_move_iterator(first + mid),
+                              make_move_iterator(first + mid),
+                              make_move_iterator(first + hi),
+                              buf + lo, comp);
+                    }
+                });
+
+                in_buffer = !in_buffer;
+            }
+
+            if (in_buffer)
+            {
+                aux::parallel_for(n, aux::parallel_grain,
+                    [&](size_t begin, size_t end){
+                        move(buf + begin, buf + end, first + begin);
+                    }
+                );
+            }
+        }
+        else
+            sort(first, last, comp);
+    }
+
+    template<class ExecutionPolicy, class RandomAccessIterator>
+    aux::enable_if_policy_t<ExecutionPolicy, void>
+    sort(ExecutionPolicy&& policy, RandomAccessIterator first,
+         RandomAccessIterator last)
+    {
+        using value_type = typename iterator_traits<RandomAccessIterator>::value_type;
+
+        sort(forward<ExecutionPolicy>(policy), first, last,
+             less<value_type>{});
+    }
+
+    /**
+     * 26.7.x, reduce (C++17):
+     */
+
+    template<class ExecutionPolicy, class ForwardIterator,
+             class T, class BinaryOperation, class UnaryOperation>
+    aux::enable_if_policy_t<ExecutionPolicy, T>
+    transform_reduce(ExecutionPolicy&&, ForwardIterator first,
+                     ForwardIterator last, T init,
+                     BinaryOperation reduce_op, UnaryOperation transform_op)
+    {
+        if constexpr (aux::run_parallel_v<ExecutionPolicy, ForwardIterator>)
+        {
+            size_t n = last - first;
+            auto chunks = aux::parallel_chunks(n, aux::parallel_grain);
+            vector<T> partial(chunks, init);
+
+            /**
+             * Every chunk starts from its own first element, so init
+             * is used only once and doesn't need to be an identity.
+             */
+            aux::parallel_for_chunks(n, chunks,
+                [&](size_t idx, size_t begin, size_t end){
+                    if (begin == end)
+                        return;
+
+                    T acc = transform_op(*(first + begin));
+                    for (auto i = begin + 1; i < end; ++i)
+                        acc = reduce_op(acc, transform_op(*(first + i)));
+                    partial[idx] = acc;
+                }
+            );
+
+            auto acc{init};
+            for (size_t i = 0; i < chunks; ++i)
+            {
+                if (aux::chunk_begin(n, chunks, i) !=
+                    aux::chunk_begin(n, chunks, i + 1))
+                    acc = reduce_op(acc, partial[i]);
+            }
+
+            return acc;
+        }
+        else
+            return transform_reduce(first, last, init, reduce_op, transform_op);
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator1,
+             class ForwardIterator2, class T,
+             class BinaryOperation1, class BinaryOperation2>
+    aux::enable_if_policy_t<ExecutionPolicy, T>
+    transform_reduce(ExecutionPolicy&&, ForwardIterator1 first1,
+                     ForwardIterator1 last1, ForwardIterator2 first2,
+                     T init, BinaryOperation1 reduce_op,
+                     BinaryOperation2 transform_op)
+    {
+        if constexpr (aux::run_parallel_v<ExecutionPolicy,
+                                          ForwardIterator1, ForwardIterator2>)
+        {
+            size_t n = last1 - first1;
+            auto chunks = aux::parallel_chunks(n, aux::parallel_grain);
+            vector<T> partial(chunks, init);
+
+            aux::parallel_for_chunks(n, chunks,
+                [&](size_t idx, size_t begin, size_t end){
+                    if (begin == end)
+                        return;
+
+                    T acc = transform_op(*(first1 + begin), *(first2 + begin));
+                    for (auto i = begin + 1; i < end; ++i)
+                        acc = reduce_op(acc, transform_op(*(first1 + i), *(first2 + i)));
+                    partial[idx] = acc;
+                }
+            );
+
+            auto acc{init};
+            for (size_t i = 0; i < chunks; ++i)
+            {
+                if (aux::chunk_begin(n, chunks, i) !=
+                    aux::chunk_begin(n, chunks, i + 1))
+                    acc = reduce_op(acc, partial[i]);
+            }
+
+            return acc;
+        }
+        else
+        {
+            return transform_reduce(first1, last1, first2, init,
+                                    reduce_op, transform_op);
+        }
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator1,
+             class ForwardIterator2, class T>
+    aux::enable_if_policy_t<ExecutionPolicy, T>
+    transform_reduce(ExecutionPolicy&& policy, ForwardIterator1 first1,
+                     ForwardIterator1 last1, ForwardIterator2 first2, T init)
+    {
+        return transform_reduce(
+            forward<ExecutionPolicy>(policy), first1, last1, first2, init,
+            [](const auto& x, const auto& y){ return x + y; },
+            [](const auto& x, const auto& y){ return x * y; }
+        );
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator,
+             class T, class BinaryOperation>
+    aux::enable_if_policy_t<ExecutionPolicy, T>
+    reduce(ExecutionPolicy&& policy, ForwardIterator first,
+           ForwardIterator last, T init, BinaryOperation op)
+    {
+        return transform_reduce(
+            forward<ExecutionPolicy>(policy), first, last, init, op,
+            [](const auto& x){ return x; }
+        );
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator, class T>
+    aux::enable_if_policy_t<ExecutionPolicy, T>
+    reduce(ExecutionPolicy&& policy, ForwardIterator first,
+           ForwardIterator last, T init)
+    {
+        return reduce(
+            forward<ExecutionPolicy>(policy), first, last, init,
+            [](const auto& x, const auto& y){ return x + y; }
+        );
+    }
+
+    template<class ExecutionPolicy, class ForwardIterator>
+    aux::enable_if_policy_t<
+        ExecutionPolicy,
+        typename iterator_traits<ForwardIterator>::value_type
+    >
+    reduce(ExecutionPolicy&& policy, ForwardIterator first,
+           ForwardIterator last)
+    {
+        using value_type = typename iterator_traits<ForwardIterator>::value_type;
+
+        return reduce(forward<ExecutionPolicy>(policy),
+                      first, last, value_type{});
+    }
+}
+
+#endif
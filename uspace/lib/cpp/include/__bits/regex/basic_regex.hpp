@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_BASIC_REGEX
+#define LIBCPP_BITS_REGEX_BASIC_REGEX
+
+#include <__bits/regex/regex_compiler.hpp>
+#include <__bits/regex/regex_constants.hpp>
+#include <__bits/regex/regex_traits.hpp>
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+namespace std
+{
+    namespace aux
+    {
+        struct regex_access;
+    }
+
+    /**
+     * 28.8, class template basic_regex:
+     */
+
+    template<class Char, class Traits = regex_traits<Char>>
+    class basic_regex
+    {
+        public:
+            using value_type  = Char;
+            using traits_type = Traits;
+            using string_type = typename Traits::string_type;
+            using flag_type   = regex_constants::syntax_option_type;
+            using locale_type = typename Traits::locale_type;
+
+            /**
+             * 28.8.1, constants:
+             */
+
+            static constexpr flag_type icase = regex_constants::icase;
+            static constexpr flag_type nosubs = regex_constants::nosubs;
+            static constexpr flag_type optimize = regex_constants::optimize;
+            static constexpr flag_type collate = regex_constants::collate;
+            static constexpr flag_type ECMAScript = regex_constants::ECMAScript;
+            static constexpr flag_type basic = regex_constants::basic;
+            static constexpr flag_type extended = regex_constants::extended;
+            static constexpr flag_type awk = regex_constants::awk;
+            static constexpr flag_type grep = regex_constants::grep;
+            static constexpr flag_type egrep = regex_constants::egrep;
+            static constexpr flag_type multiline = regex_constants::multiline;
+
+            /**
+             * 28.8.2, construct/copy/destroy:
+             */
+
+            basic_regex()
+                : flags_{regex_constants::ECMAScript}, marks_{},
+                  traits_{}, program_{}
+            { /* DUMMY BODY */ }
+
+            explicit basic_regex(const value_type* p, flag_type f = regex_constants::ECMAScript)
+                : basic_regex{}
+            {
+                assign(p, f);
+            }
+
+            basic_regex(const value_type* p, size_t len, flag_type f = regex_constants::ECMAScript)
+                : basic_regex{}
+            {
+                assign(p, len, f);
+            }
+
+            basic_regex(const basic_regex&) = default;
+
+            basic_regex(basic_regex&& other) noexcept
+                : flags_{other.flags_}, marks_{other.marks_},
+                  traits_{move(other.traits_)}, program_{move(other.program_)}
+            { /* DUMMY BODY */ }
+
+            template<class ST, class SA>
+            explicit basic_regex(const basic_string<value_type, ST, SA>& str,
+                                 flag_type f = regex_constants::ECMAScript)
+                : basic_regex{}
+            {
+                assign(str, f);
+            }
+
+            template<class ForwardIterator>
+            basic_regex(ForwardIterator first, ForwardIterator last,
+                        flag_type f = regex_constants::ECMAScript)
+                : basic_regex{}
+            {
+                assign(first, last, f);
+            }
+
+            basic_regex(initializer_list<value_type> init,
+                        flag_type f = regex_constants::ECMAScript)
+                : basic_regex{}
+            {
+                assign(init, f);
+            }
+
+            ~basic_regex() = default;
+
+            basic_regex& operator=(const basic_regex&) = default;
+
+            basic_regex& operator=(basic_regex&& other) noexcept
+            {
+                return assign(move(other));
+            }
+
+            basic_regex& operator=(const value_type* p)
+            {
+                return assign(p);
+            }
+
+            basic_regex& operator=(initializer_list<value_type> init)
+            {
+                return assign(init);
+            }
+
+            template<class ST, class SA>
+            basic_regex& operator=(const basic_string<value_type, ST, SA>& str)
+            {
+                return assign(str);
+            }
+
+            /**
+             * 28.8.3, assign:
+             */
+
+            basic_regex& assign(const basic_regex& other)
+            {
+                return *this = other;
+            }
+
+            basic_regex& assign(basic_regex&& other) noexcept
+            {
+                flags_ = other.flags_;
+                marks_ = other.marks_;
+                traits_ = move(other.traits_);
+                program_ = move(other.program_);
+
+                return *this;
+            }
+
+            basic_regex& assign(const value_type* p, flag_type f = regex_constants::ECMAScript)
+            {
+                return assign(p, p + Traits::length(p), f);
+            }
+
+            basic_regex& assign(const value_type* p, size_t len,
+                                flag_type f = regex_constants::ECMAScript)
+            {
+                return compile_(p, p + len, f);
+            }
+
+            template<class ST, class SA>
+            basic_regex& assign(const basic_string<value_type, ST, SA>& str,
+                                flag_type f = regex_constants::ECMAScript)
+            {
+                return compile_(str.data(), str.data() + str.size(), f);
+            }
+
+            template<class InputIterator>
+            basic_regex& assign(InputIterator first, InputIterator last,
+                                flag_type f = regex_constants::ECMAScript)
+            {
+                string_type str{first, last};
+
+                return compile_(str.data(), str.data() + str.size(), f);
+            }
+
+            basic_regex& assign(initializer_list<value_type> init,
+                                flag_type f = regex_constants::ECMAScript)
+            {
+                return compile_(init.begin(), init.end(), f);
+            }
+
+            /**
+             * 28.8.4, const operations:
+             */
+
+            unsigned int mark_count() const
+            {
+                return marks_;
+            }
+
+            flag_type flags() const
+            {
+                return flags_;
+            }
+
+            /**
+             * 28.8.5, locale:
+             */
+
+            locale_type imbue(locale_type loc)
+            {
+                /**
+                 * Note: The standard requires the
+                 *       expression to be reset here.
+                 */
+                program_.reset();
+                marks_ = 0;
+
+                return traits_.imbue(loc);
+            }
+
+            locale_type getloc() const
+            {
+                return traits_.getloc();
+            }
+
+            /**
+             * 28.8.6, swap:
+             */
+
+            void swap(basic_regex& other)
+            {
+                std::swap(flags_, other.flags_);
+                std::swap(marks_, other.marks_);
+                std::swap(traits_, other.traits_);
+                std::swap(program_, other.program_);
+            }
+
+        private:
+            using program_type = aux::regex_program<Char, Traits>;
+
+            flag_type flags_;
+            unsigned int marks_;
+            traits_type traits_;
+
+            /**
+             * The compiled program is immutable apart from its
+             * DFA cache, which is guarded by its own mutex, so
+             * copies of the regex can safely share it.
+             */
+            shared_ptr<program_type> program_;
+
+            basic_regex& compile_(const value_type* first, const value_type* last,
+                                  flag_type f)
+            {
+                auto prog = make_shared<program_type>();
+                aux::regex_compiler<Char, Traits> compiler{first, last, f, traits_, *prog};
+
+                if (!compiler.compile())
+                {
+                    /**
+                     * Note: Since exceptions are not supported, the
+                     *       regex is left in a state in which it
+                     *       never matches anything.
+                     */
+                    program_.reset();
+                    marks_ = 0;
+                    flags_ = f;
+                    throw regex_error{compiler.error()};
+
+                    return *this;
+                }
+
+                flags_ = f;
+                marks_ = (f & regex_constants::nosubs) ? 0 : compiler.mark_count();
+                program_ = move(prog);
+
+                return *this;
+            }
+
+            friend struct aux::regex_access;
+    };
+
+    using regex  = basic_regex<char>;
+    using wregex = basic_regex<wchar_t>;
+
+    /**
+     * 28.8.7, basic_regex swap:
+     */
+
+    template<class Char, class Traits>
+    void swap(basic_regex<Char, Traits>& lhs, basic_regex<Char, Traits>& rhs)
+    {
+        lhs.swap(rhs);
+    }
+
+    namespace aux
+    {
+        /**
+         * Gives the matching algorithms access to
+         * the compiled program of a regex.
+         */
+        struct regex_access
+        {
+            template<class Char, class Traits>
+            static const regex_program<Char, Traits>* program(const basic_regex<Char, Traits>& re)
+            {
+                return re.program_.get();
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_MATCH_RESULTS
+#define LIBCPP_BITS_REGEX_MATCH_RESULTS
+
+#include <__bits/regex/regex_constants.hpp>
+#include <__bits/regex/sub_match.hpp>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace std
+{
+    namespace aux
+    {
+        template<class BidirIt, class Char, class Traits>
+        class regex_executor;
+    }
+
+    /**
+     * 28.10, class template match_results:
+     */
+
+    template<class BidirectionalIterator,
+             class Allocator = allocator<sub_match<BidirectionalIterator>>>
+    class match_results
+    {
+        public:
+            using value_type      = sub_match<BidirectionalIterator>;
+            using const_reference = const value_type&;
+            using reference       = value_type&;
+            using const_iterator  = typename vector<value_type, Allocator>::const_iterator;
+            using iterator        = const_iterator;
+            using difference_type = typename iterator_traits<BidirectionalIterator>::difference_type;
+            using size_type       = typename allocator_traits<Allocator>::size_type;
+            using allocator_type  = Allocator;
+            using char_type       = typename iterator_traits<BidirectionalIterator>::value_type;
+            using string_type     = basic_string<char_type>;
+
+            /**
+             * 28.10.1, construct/copy/destroy:
+             */
+
+            explicit match_results(const Allocator& alloc = Allocator{})
+                : subs_(alloc), prefix_{}, suffix_{}, unmatched_{},
+                  base_{}, ready_{false}
+            { /* DUMMY BODY */ }
+
+            match_results(const match_results&) = default;
+            match_results(match_results&&) = default;
+            match_results& operator=(const match_results&) = default;
+            match_results& operator=(match_results&&) = default;
+            ~match_results() = default;
+
+            /**
+             * 28.10.2, state:
+             */
+
+            bool ready() const
+            {
+                return ready_;
+            }
+
+            /**
+             * 28.10.3, size:
+             */
+
+            size_type size() const
+            {
+                return subs_.size();
+            }
+
+            size_type max_size() const
+            {
+                return subs_.max_size();
+            }
+
+            bool empty() const
+            {
+                return size() == 0;
+            }
+
+            /**
+             * 28.10.4, element access:
+             */
+
+            difference_type length(size_type sub = 0) const
+            {
+                return (*this)[sub].length();
+            }
+
+            difference_type position(size_type sub = 0) const
+            {
+                /**
+                 * Note: For matches found by regex_iterator, the
+                 * position is relative to the start of the whole
+                 * target sequence, not of the prefix.
+                 */
+                return distance(base_, (*this)[sub].first);
+            }
+
+            string_type str(size_type sub = 0) const
+            {
+                return (*this)[sub].str();
+            }
+
+            const_reference operator[](size_type n) const
+            {
+                if (n < subs_.size())
+                    return subs_[n];
+                else
+                    return unmatched_;
+            }
+
+            const_reference prefix() const
+            {
+                return prefix_;
+            }
+
+            const_reference suffix() const
+            {
+                return suffix_;
+            }
+
+            const_iterator begin() const
+            {
+                return subs_.begin();
+            }
+
+            const_iterator end() const
+            {
+                return subs_.end();
+            }
+
+            const_iterator cbegin() const
+            {
+                return subs_.cbegin();
+            }
+
+            const_iterator cend() const
+            {
+                return subs_.cend();
+            }
+
+            /**
+             * 28.10.5, format:
+             */
+
+            template<class OutputIterator>
+            OutputIterator format(OutputIterator out, const char_type* fmt_first,
+                                  const char_type* fmt_last,
+                                  regex_constants::match_flag_type flags =
+                                    regex_constants::format_default) const
+            {
+                if (flags & regex_constants::format_sed)
+                    return format_sed_(out, fmt_first, fmt_last);
+                else
+                    return format_ecma_(out, fmt_first, fmt_last);
+            }
+
+            template<class OutputIterator, class Traits, class StringAllocator>
+            OutputIterator format(OutputIterator out,
+                                  const basic_string<char_type, Traits, StringAllocator>& fmt,
+                                  regex_constants::match_flag_type flags =
+                                    regex_constants::format_default) const
+            {
+                return format(out, fmt.data(), fmt.data() + fmt.size(), flags);
+            }
+
+            template<class Traits, class StringAllocator>
+            basic_string<char_type, Traits, StringAllocator>
+            format(const basic_string<char_type, Traits, StringAllocator>& fmt,
+                   regex_constants::match_flag_type flags =
+                    regex_constants::format_default) const
+            {
+                basic_string<char_type, Traits, StringAllocator> res{};
+                format(back_inserter(res), fmt, flags);
+
+                return res;
+            }
+
+            string_type format(const char_type* fmt,
+                               regex_constants::match_flag_type flags =
+                                regex_constants::format_default) const
+            {
+                string_type res{};
+                format(back_inserter(res), fmt,
+                       fmt + char_traits<char_type>::length(fmt), flags);
+
+                return res;
+            }
+
+            /**
+             * 28.10.6, allocator:
+             */
+
+            allocator_type get_allocator() const
+            {
+                return subs_.get_allocator();
+            }
+
+            /**
+             * 28.10.7, swap:
+             */
+
+            void swap(match_results& other)
+            {
+                std::swap(subs_, other.subs_);
+                std::swap(prefix_, other.prefix_);
+                std::swap(suffix_, other.suffix_);
+                std::swap(unmatched_, other.unmatched_);
+                std::swap(base_, other.base_);
+                std::swap(ready_, other.ready_);
+            }
+
+        private:
+            vector<value_type, Allocator> subs_;
+            value_type prefix_;
+            value_type suffix_;
+            value_type unmatched_;
+            BidirectionalIterator base_;
+            bool ready_;
+
+            template<class BidirIt, class Char, class Traits>
+            friend class aux::regex_executor;
+
+            template<class OutputIterator>
+            OutputIterator copy_sub_(OutputIterator out, size_type n) const
+            {
+                const auto& sub = (*this)[n];
+                if (sub.matched)
+                    out = copy(sub.first, sub.second, out);
+
+                return out;
+            }
+
+            template<class OutputIterator>
+            OutputIterator format_ecma_(OutputIterator out, const char_type* first,
+                                        const char_type* last) const
+            {
+                auto is_digit = [](char_type c){
+                    return c >= static_cast<char_type>('0') && c <= static_cast<char_type>('9');
+                };
+
+                while (first != last)
+                {
+                    if (*first != static_cast<char_type>('$') || first + 1 == last)
+                    {
+                        *out++ = *first++;
+                        continue;
+                    }
+
+                    auto c = first[1];
+                    if (c == static_cast<char_type>('$'))
+                        *out++ = c;
+                    else if (c == static_cast<char_type>('&'))
+                        out = copy_sub_(out, 0);
+                    else if (c == static_cast<char_type>('`'))
+                        out = copy(prefix_.first, prefix_.second, out);
+                    else if (c == static_cast<char_type>('\''))
+                        out = copy(suffix_.first, suffix_.second, out);
+                    else if (is_digit(c))
+                    {
+                        size_type n = static_cast<size_type>(c - static_cast<char_type>('0'));
+                        if (first + 2 != last && is_digit(first[2]))
+                        {
+                            n = n * 10 + static_cast<size_type>(first[2] - static_cast<char_type>('0'));
+                            ++first;
+                        }
+
+                        out = copy_sub_(out, n);
+                    }
+                    else
+                    {
+                        *out++ = *first;
+                        *out++ = c;
+                    }
+
+                    first += 2;
+                }
+
+                return out;
+            }
+
+            template<class OutputIterator>
+            OutputIterator format_sed_(OutputIterator out, const char_type* first,
+                                       const char_type* last) const
+            {
+                while (first != last)
+                {
+                    if (*first == static_cast<char_type>('&'))
+                        out = copy_sub_(out, 0);
+                    else if (*first == static_cast<char_type>('\\') && first + 1 != last)
+                    {
+                        auto c = *++first;
+                        if (c >= static_cast<char_type>('0') && c <= static_cast<char_type>('9'))
+                            out = copy_sub_(out, static_cast<size_type>(c - static_cast<char_type>('0')));
+                        else
+                            *out++ = c;
+                    }
+                    else
+                        *out++ = *first;
+
+                    ++first;
+                }
+
+                return out;
+            }
+    };
+
+    using cmatch  = match_results<const char*>;
+    using wcmatch = match_results<const wchar_t*>;
+    using smatch  = match_results<string::const_iterator>;
+    using wsmatch = match_results<wstring::const_iterator>;
+
+    template<class BidirIt, class Alloc>
+    bool operator==(const match_results<BidirIt, Alloc>& lhs,
+                    const match_results<BidirIt, Alloc>& rhs)
+    {
+        if (!lhs.ready() || !rhs.ready())
+            return !lhs.ready() && !rhs.ready();
+        if (lhs.empty() || rhs.empty())
+            return lhs.empty() && rhs.empty();
+
+        return lhs.prefix() == rhs.prefix() && lhs.suffix() == rhs.suffix() &&
+               lhs.size() == rhs.size() && equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template<class BidirIt, class Alloc>
+    bool operator!=(const match_results<BidirIt, Alloc>& lhs,
+                    const match_results<BidirIt, Alloc>& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template<class BidirIt, class Alloc>
+    void swap(match_results<BidirIt, Alloc>& lhs,
+              match_results<BidirIt, Alloc>& rhs)
+    {
+        lhs.swap(rhs);
+    }
+}
+
+#endif
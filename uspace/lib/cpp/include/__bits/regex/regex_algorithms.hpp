@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_ALGORITHMS
+#define LIBCPP_BITS_REGEX_ALGORITHMS
+
+#include <__bits/regex/basic_regex.hpp>
+#include <__bits/regex/match_results.hpp>
+#include <__bits/regex/regex_executor.hpp>
+#include <iterator>
+#include <string>
+
+namespace std
+{
+    namespace aux
+    {
+        /**
+         * Common implementation of the matching algorithms, base is used
+         * to compute the positions of the submatches and prefix_first is
+         * the beginning of the prefix, regex_iterator needs both to
+         * be different from the beginning of the searched sequence.
+         */
+        template<class BidirIt, class Alloc, class Char, class Traits>
+        bool regex_run(BidirIt first, BidirIt last, match_results<BidirIt, Alloc>* m,
+                       const basic_regex<Char, Traits>& re,
+                       regex_constants::match_flag_type flags, bool full,
+                       BidirIt base, BidirIt prefix_first)
+        {
+            auto prog = regex_access::program(re);
+            if (!prog)
+            {
+                if (m)
+                {
+                    regex_program<Char, Traits> empty{};
+                    regex_executor<BidirIt, Char, Traits>{empty, first, last, flags}
+                        .set_failure(*m);
+                }
+
+                return false;
+            }
+
+            regex_executor<BidirIt, Char, Traits> exec{*prog, first, last, flags};
+            if (!m)
+                return exec.run(full, nullptr);
+
+            vector<ptrdiff_t> caps{};
+            if (exec.run(full, &caps))
+            {
+                exec.set_results(*m, caps, base, prefix_first);
+
+                return true;
+            }
+            else
+            {
+                exec.set_failure(*m);
+
+                return false;
+            }
+        }
+    }
+
+    /**
+     * 28.11.2, function template regex_match:
+     */
+
+    template<class BidirIt, class Alloc, class Char, class Traits>
+    bool regex_match(BidirIt first, BidirIt last, match_results<BidirIt, Alloc>& m,
+                     const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return aux::regex_run(first, last, &m, e, flags, true, first, first);
+    }
+
+    template<class BidirIt, class Char, class Traits>
+    bool regex_match(BidirIt first, BidirIt last, const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return aux::regex_run<BidirIt, allocator<sub_match<BidirIt>>>(
+            first, last, nullptr, e, flags, true, first, first
+        );
+    }
+
+    template<class Char, class Alloc, class Traits>
+    bool regex_match(const Char* str, match_results<const Char*, Alloc>& m,
+                     const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(str, str + char_traits<Char>::length(str), m, e, flags);
+    }
+
+    template<class ST, class SA, class Alloc, class Char, class Traits>
+    bool regex_match(const basic_string<Char, ST, SA>& s,
+                     match_results<typename basic_string<Char, ST, SA>::const_iterator, Alloc>& m,
+                     const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(s.begin(), s.end(), m, e, flags);
+    }
+
+    template<class ST, class SA, class Alloc, class Char, class Traits>
+    bool regex_match(const basic_string<Char, ST, SA>&&,
+                     match_results<typename basic_string<Char, ST, SA>::const_iterator, Alloc>&,
+                     const basic_regex<Char, Traits>&,
+                     regex_constants::match_flag_type = regex_constants::match_default) = delete;
+
+    template<class Char, class Traits>
+    bool regex_match(const Char* str, const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(str, str + char_traits<Char>::length(str), e, flags);
+    }
+
+    template<class ST, class SA, class Char, class Traits>
+    bool regex_match(const basic_string<Char, ST, SA>& s,
+                     const basic_regex<Char, Traits>& e,
+                     regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_match(s.begin(), s.end(), e, flags);
+    }
+
+    /**
+     * 28.11.3, function template regex_search:
+     */
+
+    template<class BidirIt, class Alloc, class Char, class Traits>
+    bool regex_search(BidirIt first, BidirIt last, match_results<BidirIt, Alloc>& m,
+                      const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return aux::regex_run(first, last, &m, e, flags, false, first, first);
+    }
+
+    template<class BidirIt, class Char, class Traits>
+    bool regex_search(BidirIt first, BidirIt last, const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return aux::regex_run<BidirIt, allocator<sub_match<BidirIt>>>(
+            first, last, nullptr, e, flags, false, first, first
+        );
+    }
+
+    template<class Char, class Alloc, class Traits>
+    bool regex_search(const Char* str, match_results<const Char*, Alloc>& m,
+                      const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(str, str + char_traits<Char>::length(str), m, e, flags);
+    }
+
+    template<class Char, class Traits>
+    bool regex_search(const Char* str, const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(str, str + char_traits<Char>::length(str), e, flags);
+    }
+
+    template<class ST, class SA, class Char, class Traits>
+    bool regex_search(const basic_string<Char, ST, SA>& s,
+                      const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(s.begin(), s.end(), e, flags);
+    }
+
+    template<class ST, class SA, class Alloc, class Char, class Traits>
+    bool regex_search(const basic_string<Char, ST, SA>& s,
+                      match_results<typename basic_string<Char, ST, SA>::const_iterator, Alloc>& m,
+                      const basic_regex<Char, Traits>& e,
+                      regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_search(s.begin(), s.end(), m, e, flags);
+    }
+
+    template<class ST, class SA, class Alloc, class Char, class Traits>
+    bool regex_search(const basic_string<Char, ST, SA>&&,
+                      match_results<typename basic_string<Char, ST, SA>::const_iterator, Alloc>&,
+                      const basic_regex<Char, Traits>&,
+                      regex_constants::match_flag_type = regex_constants::match_default) = delete;
+}
+
+#endif
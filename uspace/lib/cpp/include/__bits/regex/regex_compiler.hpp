@@ -0,0 +1,1349 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_COMPILER
+#define LIBCPP_BITS_REGEX_COMPILER
+
+#include <__bits/regex/regex_constants.hpp>
+#include <__bits/regex/regex_traits.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace std::aux
+{
+    /**
+     * Regular expressions are compiled into a Thompson NFA, represented
+     * as a program for a simple virtual machine (in the spirit of Ken
+     * Thompson's and Rob Pike's implementations). Consuming instructions
+     * always continue at pc + 1, control flow is expressed by jump and
+     * split, where split prefers its first target. Matching never
+     * backtracks, so its cost is O(text length * program size).
+     */
+
+    enum class regex_opcode: uint8_t
+    {
+        character,
+        any,
+        set,
+        split,
+        jump,
+        save,
+        match,
+        line_begin,
+        line_end,
+        word_boundary,
+        not_word_boundary,
+        repeat_begin,
+        repeat_check,
+        clear
+    };
+
+    template<class Char>
+    struct regex_instruction
+    {
+        regex_opcode op;
+        Char ch;
+
+        /**
+         * Meaning depends on op:
+         *  split, jump: x (and y) are the targets,
+         *  save: x is the capture slot,
+         *  repeat_begin, repeat_check: x is the repeat slot,
+         *  clear: x and y delimit the cleared capture slots,
+         *  set: x is the index of the set,
+         *  any: x is nonzero if newlines match as well.
+         */
+        size_t x;
+        size_t y;
+    };
+
+    template<class Char, class Traits>
+    struct regex_char_set
+    {
+        using class_type = typename Traits::char_class_type;
+
+        bool negated{false};
+        vector<Char> chars{};
+        vector<pair<Char, Char>> ranges{};
+        class_type classes{};
+        vector<class_type> negated_classes{};
+
+        /**
+         * Membership of all values of single byte character
+         * types is precomputed.
+         */
+        uint32_t table[8]{};
+
+        bool contains_raw(Char c, const Traits& traits) const
+        {
+            for (auto ch: chars)
+            {
+                if (ch == c)
+                    return true;
+            }
+
+            for (const auto& range: ranges)
+            {
+                if (range.first <= c && c <= range.second)
+                    return true;
+            }
+
+            if (classes && traits.isctype(c, classes))
+                return true;
+
+            for (auto cls: negated_classes)
+            {
+                if (!traits.isctype(c, cls))
+                    return true;
+            }
+
+            return false;
+        }
+
+        bool contains(Char c, const Traits& traits, bool icase) const
+        {
+            bool res = contains_raw(c, traits);
+            if (!res && icase)
+            {
+                res = contains_raw(traits.translate_nocase(c), traits) ||
+                      contains_raw(regex_toupper(c), traits);
+            }
+
+            return res != negated;
+        }
+
+        bool table_contains(unsigned char c) const
+        {
+            return (table[c >> 5] >> (c & 31)) & 1U;
+        }
+    };
+
+    /**
+     * Lazily built DFA, states are sets of NFA instructions
+     * (with epsilon transitions already followed) and transitions
+     * are added as they are needed during matching. Only used for
+     * single byte character types and expressions without word
+     * boundary assertions.
+     */
+
+    struct regex_dfa_state
+    {
+        vector<size_t> pcs;
+        bool accept;
+        bool accept_at_end;
+    };
+
+    inline constexpr uint8_t regex_dfa_accept{0b01};
+    inline constexpr uint8_t regex_dfa_dead{0b10};
+
+    struct regex_dfa_key_hash
+    {
+        size_t operator()(const vector<size_t>& key) const noexcept
+        {
+            size_t res{2166136261U};
+            for (auto pc: key)
+                res = (res ^ pc) * 16777619U;
+
+            return res;
+        }
+    };
+
+    struct regex_dfa
+    {
+        vector<regex_dfa_state> states{};
+        unordered_map<vector<size_t>, int32_t, regex_dfa_key_hash> index{};
+
+        /**
+         * The matching loop only touches these, transitions are
+         * stored in a flat table with one row per state and one
+         * column per byte class and info holds the accept and
+         * dead flags of each state.
+         */
+        vector<int32_t> next{};
+        vector<uint8_t> info{};
+        size_t classes{};
+
+        /**
+         * Start states for matching at the beginning
+         * of the sequence and elsewhere.
+         */
+        int32_t start[2]{-1, -1};
+        size_t flushes{};
+
+        void flush()
+        {
+            states.clear();
+            index.clear();
+            next.clear();
+            info.clear();
+            start[0] = start[1] = -1;
+            ++flushes;
+        }
+    };
+
+    inline constexpr int32_t regex_dfa_unknown{-1};
+    inline constexpr int32_t regex_dfa_failed{-2};
+    inline constexpr size_t regex_dfa_max_states{2048};
+    inline constexpr size_t regex_dfa_max_flushes{8};
+    inline constexpr size_t regex_max_program_size{1U << 16};
+
+    template<class Char, class Traits>
+    struct regex_program
+    {
+        vector<regex_instruction<Char>> code{};
+        vector<regex_char_set<Char, Traits>> sets{};
+        Traits traits{};
+
+        /**
+         * Number of capture groups, including
+         * the whole match.
+         */
+        size_t groups{1};
+
+        /**
+         * Number of repeat slots, which hold the position
+         * at which the current iteration of a quantified
+         * subexpression that can match empty started.
+         */
+        size_t repeats{};
+
+        /**
+         * Maximal nesting of the subexpressions
+         * that use repeat slots.
+         */
+        size_t repeat_depth{};
+
+        bool icase{false};
+        bool multiline{false};
+        bool longest{false};
+        bool anchored{false};
+        bool has_line_assertions{false};
+        bool has_word_assertions{false};
+
+        /**
+         * Single byte character types only: bytes that behave the
+         * same in every instruction share a class, DFA transitions
+         * are indexed by those.
+         */
+        uint8_t byte_class[256]{};
+        vector<unsigned char> class_repr{};
+        uint32_t first_bytes[8]{};
+        bool use_first_bytes{false};
+
+        /**
+         * The DFA caches are shared by all users of the regex,
+         * whoever fails to get the lock uses the NFA instead.
+         */
+        mutable mutex dfa_mutex{};
+        mutable regex_dfa dfa[2]{};
+
+        bool is_newline(Char c) const
+        {
+            return c == static_cast<Char>('\n') || c == static_cast<Char>('\r');
+        }
+
+        bool is_word(Char c) const
+        {
+            return traits.isctype(c, regex_class_word);
+        }
+
+        bool consumes(const regex_instruction<Char>& inst, Char c) const
+        {
+            switch (inst.op)
+            {
+                case regex_opcode::character:
+                    if (icase)
+                        return traits.translate_nocase(c) == inst.ch;
+                    else
+                        return traits.translate(c) == inst.ch;
+                case regex_opcode::any:
+                    return inst.x || !is_newline(c);
+                case regex_opcode::set:
+                    if constexpr (sizeof(Char) == 1)
+                        return sets[inst.x].table_contains(static_cast<unsigned char>(c));
+                    else
+                        return sets[inst.x].contains(c, traits, icase);
+                default:
+                    return false;
+            }
+        }
+
+        bool dfa_eligible() const
+        {
+            return sizeof(Char) == 1 && !has_word_assertions &&
+                   !(multiline && has_line_assertions);
+        }
+
+        void finish()
+        {
+            for (const auto& inst: code)
+            {
+                if (inst.op == regex_opcode::line_begin || inst.op == regex_opcode::line_end)
+                    has_line_assertions = true;
+                else if (inst.op == regex_opcode::word_boundary ||
+                         inst.op == regex_opcode::not_word_boundary)
+                    has_word_assertions = true;
+            }
+
+            // Code starts with save 0.
+            anchored = !multiline && code.size() > 1 &&
+                       code[1].op == regex_opcode::line_begin;
+
+            if constexpr (sizeof(Char) == 1)
+            {
+                compute_byte_classes_();
+                compute_first_bytes_();
+            }
+        }
+
+        private:
+            /**
+             * Bytes that can start a match anywhere but at the beginning
+             * of the sequence, lets the searches skip to a candidate
+             * position quickly. Not used if the match can be empty
+             * or start with an assertion.
+             */
+            void compute_first_bytes_()
+            {
+                vector<bool> visited(code.size(), false);
+                vector<size_t> stack{};
+                stack.push_back(0);
+
+                use_first_bytes = true;
+                while (!stack.empty() && use_first_bytes)
+                {
+                    auto pc = stack.back();
+                    stack.pop_back();
+
+                    if (visited[pc])
+                        continue;
+                    visited[pc] = true;
+
+                    const auto& inst = code[pc];
+                    switch (inst.op)
+                    {
+                        case regex_opcode::split:
+                            stack.push_back(inst.y);
+                            stack.push_back(inst.x);
+                            break;
+                        case regex_opcode::jump:
+                            stack.push_back(inst.x);
+                            break;
+                        case regex_opcode::save:
+                        case regex_opcode::repeat_begin:
+                        case regex_opcode::repeat_check:
+                        case regex_opcode::clear:
+                            stack.push_back(pc + 1);
+                            break;
+                        case regex_opcode::line_begin:
+                            break;
+                        case regex_opcode::character:
+                        case regex_opcode::any:
+                        case regex_opcode::set:
+                            for (unsigned int c = 0; c < 256; ++c)
+                            {
+                                if (consumes(inst, static_cast<Char>(c)))
+                                    first_bytes[c >> 5] |= 1U << (c & 31);
+                            }
+                            break;
+                        default:
+                            use_first_bytes = false;
+                            break;
+                    }
+                }
+            }
+
+            void compute_byte_classes_()
+            {
+                for (auto& set: sets)
+                {
+                    for (unsigned int c = 0; c < 256; ++c)
+                    {
+                        if (set.contains(static_cast<Char>(c), traits, icase))
+                            set.table[c >> 5] |= 1U << (c & 31);
+                    }
+                }
+
+                /**
+                 * Partition refinement, every consuming instruction
+                 * splits the existing classes into the bytes it accepts
+                 * and those it does not.
+                 */
+                size_t class_count{1};
+                for (const auto& inst: code)
+                {
+                    if (inst.op != regex_opcode::character && inst.op != regex_opcode::any &&
+                        inst.op != regex_opcode::set)
+                        continue;
+
+                    vector<int> split_to(class_count * 2, -1);
+                    size_t new_count{};
+                    uint8_t new_class[256];
+
+                    for (unsigned int c = 0; c < 256; ++c)
+                    {
+                        auto idx = byte_class[c] * 2 + (consumes(inst, static_cast<Char>(c)) ? 1 : 0);
+                        if (split_to[idx] < 0)
+                            split_to[idx] = static_cast<int>(new_count++);
+                        new_class[c] = static_cast<uint8_t>(split_to[idx]);
+                    }
+
+                    for (unsigned int c = 0; c < 256; ++c)
+                        byte_class[c] = new_class[c];
+                    class_count = new_count;
+                }
+
+                class_repr.resize(class_count);
+                for (unsigned int c = 256; c > 0; --c)
+                    class_repr[byte_class[c - 1]] = static_cast<unsigned char>(c - 1);
+            }
+    };
+
+    /**
+     * Recursive descent parser producing a syntax tree, which is then
+     * translated into a regex_program. Supports the ECMAScript grammar
+     * without back references and lookahead (which are not regular and
+     * cannot be matched in linear time) and the POSIX basic and extended
+     * grammars (including the grep and awk variants), which use leftmost
+     * longest semantics.
+     *
+     * Quantified subexpressions follow the ECMAScript RepeatMatcher rules:
+     * captures inside the subexpression are cleared at the start of each
+     * iteration and an optional iteration that matches the empty string
+     * fails (the executor kills the thread, which corresponds to
+     * backtracking into the iteration).
+     */
+    template<class Char, class Traits>
+    class regex_compiler
+    {
+        public:
+            using flag_type = regex_constants::syntax_option_type;
+
+            regex_compiler(const Char* first, const Char* last, flag_type flags,
+                           const Traits& traits, regex_program<Char, Traits>& prog)
+                : it_{first}, end_{last}, flags_{flags}, traits_{traits},
+                  nodes_{}, groups_{1}, prog_{prog}, error_{false}, code_{}, depth_{}
+            {
+                if (!(flags & (regex_constants::basic | regex_constants::extended |
+                               regex_constants::awk | regex_constants::grep |
+                               regex_constants::egrep)))
+                    flags_ |= regex_constants::ECMAScript;
+
+                ecma_ = (flags_ & regex_constants::ECMAScript) != 0;
+                basic_ = !ecma_ && (flags_ & (regex_constants::basic | regex_constants::grep));
+                awk_ = !ecma_ && (flags_ & regex_constants::awk);
+                newline_alt_ = !ecma_ && (flags_ & (regex_constants::grep | regex_constants::egrep));
+            }
+
+            /**
+             * Returns false and sets the error code
+             * if the expression is not valid.
+             */
+            bool compile()
+            {
+                prog_.traits = traits_;
+                prog_.icase = (flags_ & regex_constants::icase) != 0;
+                prog_.multiline = (flags_ & regex_constants::multiline) != 0;
+                prog_.longest = !ecma_;
+                prog_.repeats = 0;
+                prog_.repeat_depth = 0;
+
+                auto root = parse_disjunction_();
+                if (!error_ && it_ != end_)
+                    fail_(regex_constants::error_paren);
+                if (error_)
+                    return false;
+
+                emit_(regex_opcode::save, 0);
+                generate_(root);
+                emit_(regex_opcode::save, 1);
+                emit_(regex_opcode::match);
+                if (error_)
+                    return false;
+
+                prog_.groups = (flags_ & regex_constants::nosubs) ? 1 : groups_;
+                prog_.finish();
+
+                return true;
+            }
+
+            regex_constants::error_type error() const
+            {
+                return code_;
+            }
+
+            size_t mark_count() const
+            {
+                return groups_ - 1;
+            }
+
+        private:
+            enum class node_kind
+            {
+                empty, character, any, set, concat,
+                alternation, repeat, group, assertion
+            };
+
+            /**
+             * The value is the number of a group, the index of a set
+             * or, together with end, the range of groups in a repeat.
+             */
+            struct node
+            {
+                node_kind kind;
+                Char ch;
+                size_t value;
+                size_t end;
+                size_t min;
+                size_t max;
+                bool greedy;
+                regex_opcode assertion;
+                vector<size_t> children;
+            };
+
+            static constexpr size_t npos{static_cast<size_t>(-1)};
+            static constexpr size_t infinity{static_cast<size_t>(-1)};
+
+            const Char* it_;
+            const Char* end_;
+            flag_type flags_;
+            const Traits& traits_;
+
+            bool ecma_;
+            bool basic_;
+            bool awk_;
+            bool newline_alt_;
+
+            vector<node> nodes_;
+            size_t groups_;
+            regex_program<Char, Traits>& prog_;
+
+            bool error_;
+            regex_constants::error_type code_;
+
+            // Nesting of the repeat being generated.
+            size_t depth_;
+
+            size_t fail_(regex_constants::error_type code)
+            {
+                if (!error_)
+                {
+                    error_ = true;
+                    code_ = code;
+                }
+
+                return npos;
+            }
+
+            static constexpr Char ch_(char c)
+            {
+                return static_cast<Char>(c);
+            }
+
+            bool at_(char c) const
+            {
+                return it_ != end_ && *it_ == ch_(c);
+            }
+
+            bool at_escaped_(char c) const
+            {
+                return it_ != end_ && it_ + 1 != end_ &&
+                       *it_ == ch_('\\') && it_[1] == ch_(c);
+            }
+
+            size_t add_node_(node_kind kind, Char ch = Char{}, size_t value = 0)
+            {
+                nodes_.push_back(node{kind, ch, value, 0, 0, 0, true,
+                                      regex_opcode::match, vector<size_t>{}});
+
+                return nodes_.size() - 1;
+            }
+
+            bool at_alternative_end_() const
+            {
+                if (it_ == end_)
+                    return true;
+                if (newline_alt_ && at_('\n'))
+                    return true;
+                if (basic_)
+                    return at_escaped_('|') || at_escaped_(')');
+
+                return at_('|') || at_(')');
+            }
+
+            size_t parse_disjunction_()
+            {
+                vector<size_t> alternatives{};
+                alternatives.push_back(parse_alternative_());
+
+                while (!error_)
+                {
+                    if ((newline_alt_ && at_('\n')) || (!basic_ && at_('|')))
+                        ++it_;
+                    else if (basic_ && at_escaped_('|'))
+                        it_ += 2;
+                    else
+                        break;
+
+                    alternatives.push_back(parse_alternative_());
+                }
+
+                if (error_)
+                    return npos;
+                if (alternatives.size() == 1)
+                    return alternatives[0];
+
+                auto res = add_node_(node_kind::alternation);
+                nodes_[res].children = move(alternatives);
+
+                return res;
+            }
+
+            size_t parse_alternative_()
+            {
+                vector<size_t> terms{};
+                bool first_term{true};
+
+                while (!error_ && !at_alternative_end_())
+                {
+                    auto term = parse_term_(first_term);
+                    if (term != npos)
+                        terms.push_back(term);
+                    first_term = false;
+                }
+
+                if (error_)
+                    return npos;
+                if (terms.size() == 1)
+                    return terms[0];
+
+                auto res = add_node_(terms.empty() ? node_kind::empty : node_kind::concat);
+                nodes_[res].children = move(terms);
+
+                return res;
+            }
+
+            size_t parse_term_(bool first_term)
+            {
+                /**
+                 * In the POSIX basic grammar, ^ and $ are anchors
+                 * only at the beginning and end of a (sub)expression
+                 * and * is an ordinary character at its beginning.
+                 */
+                if (at_('^') && (!basic_ || first_term))
+                {
+                    ++it_;
+                    return assertion_(regex_opcode::line_begin);
+                }
+
+                if (at_('$'))
+                {
+                    ++it_;
+                    if (!basic_ || at_alternative_end_())
+                        return assertion_(regex_opcode::line_end);
+                    --it_;
+                }
+
+                if (at_escaped_('b') || at_escaped_('B'))
+                {
+                    auto op = it_[1] == ch_('b') ? regex_opcode::word_boundary
+                                                 : regex_opcode::not_word_boundary;
+                    it_ += 2;
+
+                    return assertion_(op);
+                }
+
+                size_t atom{};
+                auto first_group = groups_;
+                if (basic_ && first_term && at_('*'))
+                {
+                    ++it_;
+                    atom = add_node_(node_kind::character, ch_('*'));
+                }
+                else
+                    atom = parse_atom_();
+
+                if (error_)
+                    return npos;
+
+                while (true)
+                {
+                    size_t min{}, max{};
+                    if (!parse_quantifier_(min, max))
+                        break;
+
+                    if (error_)
+                        return npos;
+
+                    bool greedy{true};
+                    if (ecma_ && at_('?'))
+                    {
+                        ++it_;
+                        greedy = false;
+                    }
+
+                    auto rep = add_node_(node_kind::repeat, Char{}, first_group);
+                    nodes_[rep].end = groups_;
+                    nodes_[rep].min = min;
+                    nodes_[rep].max = max;
+                    nodes_[rep].greedy = greedy;
+                    nodes_[rep].children.push_back(atom);
+                    atom = rep;
+
+                    // ECMAScript does not allow repeated quantifiers.
+                    if (ecma_)
+                        break;
+                }
+
+                if (ecma_ && (at_('*') || at_('+') || at_('?') || at_('{')))
+                    return fail_(regex_constants::error_badrepeat);
+
+                return atom;
+            }
+
+            size_t assertion_(regex_opcode op)
+            {
+                auto res = add_node_(node_kind::assertion);
+                nodes_[res].assertion = op;
+
+                return res;
+            }
+
+            bool parse_quantifier_(size_t& min, size_t& max)
+            {
+                if (at_('*'))
+                {
+                    ++it_;
+                    min = 0;
+                    max = infinity;
+
+                    return true;
+                }
+
+                if (!basic_ && (at_('+') || at_('?')))
+                {
+                    min = at_('+') ? 1 : 0;
+                    max = at_('+') ? infinity : 1;
+                    ++it_;
+
+                    return true;
+                }
+
+                if ((basic_ && at_escaped_('{')) || (!basic_ && at_('{')))
+                {
+                    it_ += basic_ ? 2 : 1;
+
+                    if (!parse_number_(min))
+                    {
+                        fail_(regex_constants::error_badbrace);
+                        return true;
+                    }
+
+                    max = min;
+                    if (at_(','))
+                    {
+                        ++it_;
+                        if (!parse_number_(max))
+                            max = infinity;
+                    }
+
+                    if ((basic_ && !at_escaped_('}')) || (!basic_ && !at_('}')))
+                    {
+                        fail_(it_ == end_ ? regex_constants::error_brace
+                                          : regex_constants::error_badbrace);
+                        return true;
+                    }
+                    it_ += basic_ ? 2 : 1;
+
+                    if (max < min)
+                        fail_(regex_constants::error_badbrace);
+
+                    return true;
+                }
+
+                return false;
+            }
+
+            bool parse_number_(size_t& res)
+            {
+                bool any{false};
+                res = 0;
+
+                while (it_ != end_ && traits_.value(*it_, 10) >= 0)
+                {
+                    res = res * 10 + static_cast<size_t>(traits_.value(*it_++, 10));
+                    any = true;
+
+                    if (res > regex_max_program_size)
+                        return false;
+                }
+
+                return any;
+            }
+
+            size_t parse_atom_()
+            {
+                if (at_('.'))
+                {
+                    ++it_;
+                    return add_node_(node_kind::any, Char{}, ecma_ ? 0 : 1);
+                }
+
+                if (at_('['))
+                {
+                    ++it_;
+                    return parse_bracket_();
+                }
+
+                bool group{false};
+                if (basic_ && at_escaped_('('))
+                {
+                    it_ += 2;
+                    group = true;
+                }
+                else if (!basic_ && at_('('))
+                {
+                    ++it_;
+                    group = true;
+                }
+
+                if (group)
+                {
+                    bool capture{true};
+                    if (ecma_ && at_('?'))
+                    {
+                        if (it_ + 1 != end_ && it_[1] == ch_(':'))
+                        {
+                            it_ += 2;
+                            capture = false;
+                        }
+                        else
+                            return fail_(regex_constants::error_complexity);
+                    }
+
+                    size_t idx{capture ? groups_++ : npos};
+                    auto inner = parse_disjunction_();
+                    if (error_)
+                        return npos;
+
+                    if (basic_ && at_escaped_(')'))
+                        it_ += 2;
+                    else if (!basic_ && at_(')'))
+                        ++it_;
+                    else
+                        return fail_(regex_constants::error_paren);
+
+                    if (!capture || (flags_ & regex_constants::nosubs))
+                        return inner;
+
+                    auto res = add_node_(node_kind::group, Char{}, idx);
+                    nodes_[res].children.push_back(inner);
+
+                    return res;
+                }
+
+                if (!basic_ && (at_('*') || at_('+') || at_('?') || at_('{')))
+                    return fail_(regex_constants::error_badrepeat);
+
+                if (at_('\\'))
+                {
+                    ++it_;
+                    return parse_escape_();
+                }
+
+                return add_node_(node_kind::character, *it_++);
+            }
+
+            size_t parse_escape_()
+            {
+                if (it_ == end_)
+                    return fail_(regex_constants::error_escape);
+
+                auto c = *it_;
+                auto cls = class_escape_(c);
+                if (cls != 0)
+                {
+                    ++it_;
+
+                    auto res = add_node_(node_kind::set, Char{}, prog_.sets.size());
+                    regex_char_set<Char, Traits> set{};
+                    set.classes = cls;
+                    set.negated = traits_.isctype(c, regex_class_upper);
+                    prog_.sets.push_back(move(set));
+
+                    return res;
+                }
+
+                if (c != ch_('0') && traits_.value(c, 10) > 0)
+                    return fail_(regex_constants::error_backref);
+
+                Char res{};
+                if (!parse_char_escape_(res))
+                    return npos;
+
+                return add_node_(node_kind::character, res);
+            }
+
+            typename Traits::char_class_type class_escape_(Char c) const
+            {
+                if (c == ch_('d') || c == ch_('D'))
+                    return regex_class_digit;
+                else if (c == ch_('w') || c == ch_('W'))
+                    return regex_class_word;
+                else if (c == ch_('s') || c == ch_('S'))
+                    return regex_class_space;
+                else
+                    return 0;
+            }
+
+            bool parse_hex_(size_t digits, Char& res)
+            {
+                uint32_t val{};
+                for (size_t i = 0; i < digits; ++i)
+                {
+                    if (it_ == end_ || traits_.value(*it_, 16) < 0)
+                    {
+                        fail_(regex_constants::error_escape);
+                        return false;
+                    }
+
+                    val = val * 16 + static_cast<uint32_t>(traits_.value(*it_++, 16));
+                }
+
+                res = static_cast<Char>(val);
+                return true;
+            }
+
+            /**
+             * Parses the character following a backslash
+             * (which was already consumed) and advances past it.
+             */
+            bool parse_char_escape_(Char& res)
+            {
+                auto c = *it_++;
+
+                if (ecma_ || awk_)
+                {
+                    if (c == ch_('n'))
+                        res = ch_('\n');
+                    else if (c == ch_('t'))
+                        res = ch_('\t');
+                    else if (c == ch_('r'))
+                        res = ch_('\r');
+                    else if (c == ch_('f'))
+                        res = ch_('\f');
+                    else if (c == ch_('v'))
+                        res = ch_('\v');
+                    else if (c == ch_('0'))
+                        res = Char{};
+                    else if (ecma_ && c == ch_('x'))
+                        return parse_hex_(2, res);
+                    else if (ecma_ && c == ch_('u'))
+                        return parse_hex_(4, res);
+                    else if (ecma_ && c == ch_('c'))
+                    {
+                        if (it_ == end_ || !traits_.isctype(*it_, regex_class_alpha))
+                        {
+                            fail_(regex_constants::error_escape);
+                            return false;
+                        }
+
+                        res = static_cast<Char>(static_cast<uint32_t>(*it_++) % 32);
+                    }
+                    else
+                        res = c;
+                }
+                else
+                    res = c;
+
+                return true;
+            }
+
+            size_t parse_bracket_()
+            {
+                auto res = add_node_(node_kind::set, Char{}, prog_.sets.size());
+                regex_char_set<Char, Traits> set{};
+
+                if (at_('^'))
+                {
+                    ++it_;
+                    set.negated = true;
+                }
+
+                bool first{true};
+                while (true)
+                {
+                    if (it_ == end_)
+                        return fail_(regex_constants::error_brack);
+
+                    if (at_(']') && (ecma_ || !first))
+                    {
+                        ++it_;
+                        break;
+                    }
+                    first = false;
+
+                    Char lo{};
+                    bool is_char{true};
+                    if (!parse_bracket_atom_(set, lo, is_char))
+                        return npos;
+
+                    if (!is_char)
+                        continue;
+
+                    if (at_('-') && it_ + 1 != end_ && it_[1] != ch_(']'))
+                    {
+                        ++it_;
+
+                        Char hi{};
+                        if (!parse_bracket_atom_(set, hi, is_char))
+                            return npos;
+                        if (!is_char || hi < lo)
+                            return fail_(regex_constants::error_range);
+
+                        set.ranges.emplace_back(lo, hi);
+                    }
+                    else
+                        set.chars.push_back(lo);
+                }
+
+                prog_.sets.push_back(move(set));
+                return res;
+            }
+
+            /**
+             * Parses a single element of a bracket expression, character
+             * classes are added to the set directly, is_char is set when
+             * the element is a single character (stored in c).
+             */
+            bool parse_bracket_atom_(regex_char_set<Char, Traits>& set, Char& c, bool& is_char)
+            {
+                is_char = true;
+
+                if (at_('[') && it_ + 1 != end_ &&
+                    (it_[1] == ch_(':') || it_[1] == ch_('.') || it_[1] == ch_('=')))
+                {
+                    auto delim = it_[1];
+                    it_ += 2;
+
+                    auto name_first = it_;
+                    while (it_ != end_ && !(*it_ == delim && it_ + 1 != end_ && it_[1] == ch_(']')))
+                        ++it_;
+
+                    if (it_ == end_)
+                    {
+                        fail_(regex_constants::error_brack);
+                        return false;
+                    }
+
+                    auto name_last = it_;
+                    it_ += 2;
+
+                    if (delim == ch_(':'))
+                    {
+                        auto cls = traits_.lookup_classname(name_first, name_last,
+                                                            flags_ & regex_constants::icase);
+                        if (cls == 0)
+                        {
+                            fail_(regex_constants::error_ctype);
+                            return false;
+                        }
+
+                        set.classes |= cls;
+                        is_char = false;
+
+                        return true;
+                    }
+
+                    auto name = traits_.lookup_collatename(name_first, name_last);
+                    if (name.size() != 1)
+                    {
+                        fail_(regex_constants::error_collate);
+                        return false;
+                    }
+
+                    c = name[0];
+                    return true;
+                }
+
+                if (at_('\\') && (ecma_ || awk_))
+                {
+                    ++it_;
+                    if (it_ == end_)
+                    {
+                        fail_(regex_constants::error_escape);
+                        return false;
+                    }
+
+                    auto cls = class_escape_(*it_);
+                    if (cls != 0)
+                    {
+                        if (traits_.isctype(*it_, regex_class_upper))
+                            set.negated_classes.push_back(cls);
+                        else
+                            set.classes |= cls;
+
+                        ++it_;
+                        is_char = false;
+
+                        return true;
+                    }
+
+                    if (ecma_ && at_('b'))
+                    {
+                        ++it_;
+                        c = ch_('\b');
+
+                        return true;
+                    }
+
+                    return parse_char_escape_(c);
+                }
+
+                c = *it_++;
+                return true;
+            }
+
+            size_t emit_(regex_opcode op, size_t x = 0, size_t y = 0, Char ch = Char{})
+            {
+                auto& code = prog_.code;
+                if (code.size() >= regex_max_program_size)
+                {
+                    fail_(regex_constants::error_space);
+                    return 0;
+                }
+
+                code.push_back(regex_instruction<Char>{op, ch, x, y});
+
+                return code.size() - 1;
+            }
+
+            size_t pc_() const
+            {
+                return prog_.code.size();
+            }
+
+            void generate_(size_t idx)
+            {
+                if (error_)
+                    return;
+
+                const auto& n = nodes_[idx];
+                auto& code = prog_.code;
+
+                switch (n.kind)
+                {
+                    case node_kind::empty:
+                        break;
+                    case node_kind::character:
+                    {
+                        auto ch = (flags_ & regex_constants::icase)
+                            ? traits_.translate_nocase(n.ch) : traits_.translate(n.ch);
+                        emit_(regex_opcode::character, 0, 0, ch);
+                        break;
+                    }
+                    case node_kind::any:
+                        emit_(regex_opcode::any, n.value);
+                        break;
+                    case node_kind::set:
+                        emit_(regex_opcode::set, n.value);
+                        break;
+                    case node_kind::assertion:
+                        emit_(n.assertion);
+                        break;
+                    case node_kind::concat:
+                        for (auto child: n.children)
+                            generate_(child);
+                        break;
+                    case node_kind::group:
+                        emit_(regex_opcode::save, 2 * n.value);
+                        generate_(n.children[0]);
+                        emit_(regex_opcode::save, 2 * n.value + 1);
+                        break;
+                    case node_kind::alternation:
+                    {
+                        vector<size_t> jumps{};
+                        for (size_t i = 0; i + 1 < n.children.size(); ++i)
+                        {
+                            auto split = emit_(regex_opcode::split);
+                            generate_(n.children[i]);
+                            jumps.push_back(emit_(regex_opcode::jump));
+                            if (error_)
+                                return;
+
+                            code[split].x = split + 1;
+                            code[split].y = pc_();
+                        }
+
+                        generate_(n.children.back());
+                        if (error_)
+                            return;
+
+                        for (auto jump: jumps)
+                            code[jump].x = pc_();
+                        break;
+                    }
+                    case node_kind::repeat:
+                        generate_repeat_(n);
+                        break;
+                }
+            }
+
+            bool nullable_(size_t idx) const
+            {
+                const auto& n = nodes_[idx];
+
+                switch (n.kind)
+                {
+                    case node_kind::empty:
+                    case node_kind::assertion:
+                        return true;
+                    case node_kind::concat:
+                        for (auto child: n.children)
+                        {
+                            if (!nullable_(child))
+                                return false;
+                        }
+                        return true;
+                    case node_kind::alternation:
+                        for (auto child: n.children)
+                        {
+                            if (nullable_(child))
+                                return true;
+                        }
+                        return false;
+                    case node_kind::repeat:
+                        return n.min == 0 || nullable_(n.children[0]);
+                    case node_kind::group:
+                        return nullable_(n.children[0]);
+                    default:
+                        return false;
+                }
+            }
+
+            /**
+             * Emits one iteration of a repeat. In ECMAScript, the captures
+             * of the groups inside are cleared first and if slot is not
+             * npos, an iteration that matches the empty string fails.
+             */
+            void generate_iteration_(const node& n, size_t slot)
+            {
+                if (slot != npos)
+                {
+                    emit_(regex_opcode::repeat_begin, slot);
+                    prog_.repeat_depth = max(prog_.repeat_depth, ++depth_);
+                }
+
+                if (ecma_ && n.end > n.value)
+                    emit_(regex_opcode::clear, 2 * n.value, 2 * n.end);
+
+                generate_(n.children[0]);
+
+                if (slot != npos)
+                {
+                    emit_(regex_opcode::repeat_check, slot);
+                    --depth_;
+                }
+            }
+
+            void generate_repeat_(const node& n)
+            {
+                auto& code = prog_.code;
+
+                /**
+                 * Only the optional iterations of a subexpression
+                 * that can match empty need to be checked.
+                 */
+                auto slot = npos;
+                if (ecma_ && n.max > n.min && nullable_(n.children[0]))
+                    slot = prog_.repeats++;
+
+                /**
+                 * Mandatory part, the last copy is shared with x+
+                 * unless the following iterations are checked.
+                 */
+                auto copies = n.min;
+                if (n.max == infinity && copies > 0 && slot == npos)
+                    --copies;
+
+                for (size_t i = 0; i < copies && !error_; ++i)
+                    generate_iteration_(n, npos);
+
+                if (n.max == infinity)
+                {
+                    if (n.min > 0 && slot == npos)
+                    { // L: child; split L, next
+                        auto loop = pc_();
+                        generate_iteration_(n, npos);
+                        auto split = emit_(regex_opcode::split);
+                        if (error_)
+                            return;
+
+                        code[split].x = n.greedy ? loop : split + 1;
+                        code[split].y = n.greedy ? split + 1 : loop;
+                    }
+                    else
+                    { // L: split body, next; body: child; jump L
+                        auto split = emit_(regex_opcode::split);
+                        generate_iteration_(n, slot);
+                        emit_(regex_opcode::jump, split);
+                        if (error_)
+                            return;
+
+                        code[split].x = n.greedy ? split + 1 : pc_();
+                        code[split].y = n.greedy ? pc_() : split + 1;
+                    }
+
+                    return;
+                }
+
+                // Optional part: split body, end; body: child; ...
+                vector<size_t> splits{};
+                for (size_t i = n.min; i < n.max && !error_; ++i)
+                {
+                    splits.push_back(emit_(regex_opcode::split));
+                    generate_iteration_(n, slot);
+                }
+
+                if (error_)
+                    return;
+
+                for (auto split: splits)
+                {
+                    code[split].x = n.greedy ? split + 1 : pc_();
+                    code[split].y = n.greedy ? pc_() : split + 1;
+                }
+            }
+    };
+}
+
+#endif
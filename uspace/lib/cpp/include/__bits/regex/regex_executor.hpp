@@ -0,0 +1,690 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_EXECUTOR
+#define LIBCPP_BITS_REGEX_EXECUTOR
+
+#include <__bits/regex/match_results.hpp>
+#include <__bits/regex/regex_compiler.hpp>
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace std::aux
+{
+    /**
+     * Runs a compiled program over [first, last). Whenever the caller
+     * only needs to know whether there is a match (or whether there is
+     * none, which is the common case when filtering), the lazy DFA is
+     * tried first. Submatches are then extracted by a Pike VM, which
+     * simulates the NFA with all threads in lockstep, each carrying its
+     * own captures, and keeps them in priority order to get the leftmost
+     * first (ECMAScript) or leftmost longest (POSIX) match.
+     */
+    template<class BidirIt, class Char, class Traits>
+    class regex_executor
+    {
+        public:
+            using program_type = regex_program<Char, Traits>;
+            using flag_type    = regex_constants::match_flag_type;
+
+            regex_executor(const program_type& prog, BidirIt first, BidirIt last,
+                           flag_type flags)
+                : prog_{prog}, first_{first}, last_{last}, flags_{flags},
+                  slots_{2 * prog.groups}, width_{slots_ + prog.repeats}, stack_{}
+            { /* DUMMY BODY */ }
+
+            /**
+             * Returns true if there is a match, if caps is not null,
+             * stores offsets of all submatches (-1 if unmatched) in it.
+             */
+            bool run(bool full, vector<ptrdiff_t>* caps)
+            {
+                if (prog_.code.empty())
+                    return false;
+
+                bool anchored = full || (flags_ & regex_constants::match_continuous) ||
+                                prog_.anchored;
+
+                if (prog_.dfa_eligible() && !(flags_ & regex_constants::match_not_null))
+                {
+                    auto res = dfa_run_(anchored, full);
+                    if (res == 0)
+                        return false;
+                    else if (res > 0 && !caps)
+                        return true;
+                }
+
+                vector<ptrdiff_t> tmp{};
+                if (!caps)
+                    caps = &tmp;
+                caps->assign(slots_, -1);
+
+                return pike_(anchored, full, *caps);
+            }
+
+            template<class Alloc>
+            void set_results(match_results<BidirIt, Alloc>& m,
+                             const vector<ptrdiff_t>& caps, BidirIt base,
+                             BidirIt prefix_first) const
+            {
+                m.subs_.clear();
+                m.subs_.resize(prog_.groups);
+
+                for (size_t i = 0; i < prog_.groups; ++i)
+                {
+                    auto& sub = m.subs_[i];
+                    if (caps[2 * i] >= 0 && caps[2 * i + 1] >= 0)
+                    {
+                        sub.first = next(first_, caps[2 * i]);
+                        sub.second = next(sub.first, caps[2 * i + 1] - caps[2 * i]);
+                        sub.matched = true;
+                    }
+                    else
+                    {
+                        sub.first = sub.second = last_;
+                        sub.matched = false;
+                    }
+                }
+
+                m.prefix_.first = prefix_first;
+                m.prefix_.second = m.subs_[0].first;
+                m.prefix_.matched = m.prefix_.first != m.prefix_.second;
+
+                m.suffix_.first = m.subs_[0].second;
+                m.suffix_.second = last_;
+                m.suffix_.matched = m.suffix_.first != m.suffix_.second;
+
+                m.unmatched_.first = m.unmatched_.second = last_;
+                m.unmatched_.matched = false;
+
+                m.base_ = base;
+                m.ready_ = true;
+            }
+
+            template<class Alloc>
+            void set_failure(match_results<BidirIt, Alloc>& m) const
+            {
+                m.subs_.clear();
+                m.prefix_ = m.suffix_ = m.unmatched_ = sub_match<BidirIt>{};
+                m.base_ = first_;
+                m.ready_ = true;
+            }
+
+        private:
+            const program_type& prog_;
+            BidirIt first_;
+            BidirIt last_;
+            flag_type flags_;
+            size_t slots_;
+
+            /**
+             * Captures are followed by the repeat
+             * slots in the state of each thread.
+             */
+            size_t width_;
+
+            struct position_
+            {
+                BidirIt it;
+                ptrdiff_t pos;
+                bool has_prev;
+                Char prev;
+            };
+
+            struct job_
+            {
+                size_t pc;
+                size_t slot;
+                ptrdiff_t value;
+                bool restore;
+                size_t fresh;
+            };
+
+            vector<job_> stack_;
+
+            /**
+             * Sparse set of threads indexed by their pc,
+             * insertion order is the priority order.
+             *
+             * The states visited while following epsilon transitions
+             * are kept in a second sparse set. A state is a pc together
+             * with the number of (checked) iterations that started at
+             * the current position. Such an iteration cannot end before
+             * consuming input, so a loop can only be reentered with a
+             * different number and each pc is visited at most once
+             * for every level of nesting.
+             */
+            struct thread_list_
+            {
+                vector<size_t> sparse;
+                vector<size_t> dense;
+                vector<ptrdiff_t> caps;
+                size_t size;
+                size_t slots;
+
+                vector<size_t> visited_sparse;
+                vector<size_t> visited_dense;
+                size_t visited;
+
+                thread_list_(size_t n, size_t states, size_t slots)
+                    : sparse(n), dense(n), caps(n * slots), size{}, slots{slots},
+                      visited_sparse(states), visited_dense(states), visited{}
+                { /* DUMMY BODY */ }
+
+                void clear()
+                {
+                    size = 0;
+                    visited = 0;
+                }
+
+                bool visit(size_t state)
+                {
+                    auto idx = visited_sparse[state];
+                    if (idx < visited && visited_dense[idx] == state)
+                        return false;
+
+                    visited_sparse[state] = visited;
+                    visited_dense[visited++] = state;
+
+                    return true;
+                }
+
+                bool contains(size_t pc) const
+                {
+                    auto idx = sparse[pc];
+
+                    return idx < size && dense[idx] == pc;
+                }
+
+                size_t insert(size_t pc)
+                {
+                    sparse[pc] = size;
+                    dense[size] = pc;
+
+                    return size++;
+                }
+
+                ptrdiff_t* caps_of(size_t idx)
+                {
+                    return caps.data() + idx * slots;
+                }
+            };
+
+            position_ start_position_() const
+            {
+                position_ res{first_, 0, false, Char{}};
+
+                if (flags_ & regex_constants::match_prev_avail)
+                {
+                    res.has_prev = true;
+                    res.prev = *prev(first_);
+                }
+
+                return res;
+            }
+
+            bool assertion_holds_(regex_opcode op, const position_& ctx) const
+            {
+                bool at_end = ctx.it == last_;
+
+                if (op == regex_opcode::line_begin)
+                {
+                    if (!ctx.has_prev)
+                        return !(flags_ & regex_constants::match_not_bol);
+                    else
+                        return prog_.multiline && prog_.is_newline(ctx.prev);
+                }
+                else if (op == regex_opcode::line_end)
+                {
+                    if (at_end)
+                        return !(flags_ & regex_constants::match_not_eol);
+                    else
+                        return prog_.multiline && prog_.is_newline(*ctx.it);
+                }
+
+                bool before = ctx.has_prev && prog_.is_word(ctx.prev);
+                bool after = !at_end && prog_.is_word(*ctx.it);
+                bool boundary = before != after;
+
+                if (!ctx.has_prev && (flags_ & regex_constants::match_not_bow))
+                    boundary = false;
+                if (at_end && (flags_ & regex_constants::match_not_eow))
+                    boundary = false;
+
+                return op == regex_opcode::word_boundary ? boundary : !boundary;
+            }
+
+            /**
+             * Follows all epsilon transitions from pc and adds the reached
+             * threads to the list. Uses an explicit stack, because a long
+             * chain of optional subexpressions would otherwise require
+             * deep recursion.
+             */
+            void add_thread_(thread_list_& list, size_t pc0, vector<ptrdiff_t>& caps,
+                             const position_& ctx)
+            {
+                const auto& code = prog_.code;
+
+                stack_.clear();
+                stack_.push_back(job_{pc0, 0, 0, false, 0});
+
+                while (!stack_.empty())
+                {
+                    auto job = stack_.back();
+                    stack_.pop_back();
+
+                    if (job.restore)
+                    {
+                        caps[job.slot] = job.value;
+                        continue;
+                    }
+
+                    auto pc = job.pc;
+                    auto fresh = job.fresh;
+                    while (list.visit(pc * (prog_.repeat_depth + 1) + fresh))
+                    {
+                        const auto& inst = code[pc];
+
+                        if (inst.op == regex_opcode::jump)
+                            pc = inst.x;
+                        else if (inst.op == regex_opcode::split)
+                        {
+                            stack_.push_back(job_{inst.y, 0, 0, false, fresh});
+                            pc = inst.x;
+                        }
+                        else if (inst.op == regex_opcode::save)
+                        {
+                            if (inst.x < slots_)
+                            {
+                                stack_.push_back(job_{0, inst.x, caps[inst.x], true, 0});
+                                caps[inst.x] = ctx.pos;
+                            }
+                            ++pc;
+                        }
+                        else if (inst.op == regex_opcode::repeat_begin)
+                        {
+                            auto slot = slots_ + inst.x;
+                            stack_.push_back(job_{0, slot, caps[slot], true, 0});
+                            caps[slot] = ctx.pos;
+                            ++fresh;
+                            ++pc;
+                        }
+                        else if (inst.op == regex_opcode::repeat_check)
+                        {
+                            // An iteration that matched the empty string fails.
+                            if (caps[slots_ + inst.x] == ctx.pos)
+                                break;
+                            ++pc;
+                        }
+                        else if (inst.op == regex_opcode::clear)
+                        {
+                            for (auto slot = inst.x; slot < inst.y && slot < slots_; ++slot)
+                            {
+                                if (caps[slot] < 0)
+                                    continue;
+
+                                stack_.push_back(job_{0, slot, caps[slot], true, 0});
+                                caps[slot] = -1;
+                            }
+                            ++pc;
+                        }
+                        else if (inst.op == regex_opcode::line_begin ||
+                                 inst.op == regex_opcode::line_end ||
+                                 inst.op == regex_opcode::word_boundary ||
+                                 inst.op == regex_opcode::not_word_boundary)
+                        {
+                            if (!assertion_holds_(inst.op, ctx))
+                                break;
+                            ++pc;
+                        }
+                        else
+                        { // Consuming instruction or match.
+                            if (!list.contains(pc))
+                                copy(caps.begin(), caps.end(), list.caps_of(list.insert(pc)));
+                            break;
+                        }
+                    }
+                }
+            }
+
+            bool pike_(bool anchored, bool full, vector<ptrdiff_t>& best)
+            {
+                const auto& code = prog_.code;
+                auto states = code.size() * (prog_.repeat_depth + 1);
+                thread_list_ clist{code.size(), states, width_};
+                thread_list_ nlist{code.size(), states, width_};
+                vector<ptrdiff_t> caps(width_, -1);
+                bool matched{false};
+
+                auto ctx = start_position_();
+                add_thread_(clist, 0, caps, ctx);
+
+                while (true)
+                {
+                    bool at_end = ctx.it == last_;
+                    Char c = at_end ? Char{} : *ctx.it;
+
+                    auto nctx = ctx;
+                    if (!at_end)
+                    {
+                        ++nctx.it;
+                        ++nctx.pos;
+                        nctx.has_prev = true;
+                        nctx.prev = c;
+                    }
+
+                    nlist.clear();
+                    for (size_t i = 0; i < clist.size; ++i)
+                    {
+                        const auto& inst = code[clist.dense[i]];
+                        auto tcaps = clist.caps_of(i);
+
+                        if (inst.op == regex_opcode::match)
+                        {
+                            if (full && !at_end)
+                                continue;
+                            if ((flags_ & regex_constants::match_not_null) && tcaps[0] == tcaps[1])
+                                continue;
+                            if (prog_.longest && matched && !(tcaps[0] < best[0] ||
+                                (tcaps[0] == best[0] && tcaps[1] > best[1])))
+                                continue;
+
+                            copy(tcaps, tcaps + slots_, best.begin());
+                            matched = true;
+
+                            if (flags_ & regex_constants::match_any)
+                                return true;
+
+                            /**
+                             * Leftmost first: threads with lower
+                             * priority than this one cannot win.
+                             */
+                            if (!prog_.longest)
+                                break;
+                        }
+                        else if (!at_end && prog_.consumes(inst, c))
+                        {
+                            copy(tcaps, tcaps + width_, caps.begin());
+                            add_thread_(nlist, clist.dense[i] + 1, caps, nctx);
+                        }
+                    }
+
+                    if (at_end)
+                        break;
+
+                    if (!matched && !anchored)
+                    {
+                        fill(caps.begin(), caps.end(), -1);
+                        add_thread_(nlist, 0, caps, nctx);
+                    }
+                    else if (nlist.size == 0)
+                        break;
+
+                    swap(clist, nlist);
+                    ctx = nctx;
+                }
+
+                return matched;
+            }
+
+            /**
+             * Returns 1 if there is a match, 0 if there is
+             * none and -1 if the DFA could not be used.
+             */
+            int dfa_run_(bool anchored, bool full)
+            {
+                unique_lock<mutex> lock{prog_.dfa_mutex, try_to_lock};
+                if (!lock)
+                    return -1;
+
+                auto& dfa = prog_.dfa[anchored ? 0 : 1];
+                if (dfa.flushes > regex_dfa_max_flushes)
+                    return -1;
+
+                bool at_begin = !(flags_ & (regex_constants::match_not_bol |
+                                            regex_constants::match_prev_avail));
+                /**
+                 * Unanchored searches return to the start state for
+                 * positions other than the beginning after every failed
+                 * attempt, that is where we can skip to the next byte
+                 * that can start a match.
+                 */
+                bool skip = !anchored && prog_.use_first_bytes;
+                if (skip && dfa_start_(dfa, false) < 0)
+                    return -1;
+
+                auto state = dfa_start_(dfa, at_begin);
+                if (state < 0)
+                    return -1;
+
+                const int32_t* next = dfa.next.data();
+                const uint8_t* info = dfa.info.data();
+                auto classes = dfa.classes;
+                auto skip_state = skip ? dfa.start[1] : regex_dfa_unknown;
+
+                auto it = first_;
+                while (it != last_)
+                {
+                    auto flags = info[state];
+                    if ((flags & regex_dfa_accept) && !full)
+                        return 1;
+                    if (flags & regex_dfa_dead)
+                        return 0;
+
+                    if (state == skip_state)
+                    {
+                        while (it != last_ && !first_byte_(*it))
+                            ++it;
+                        if (it == last_)
+                            break;
+                    }
+
+                    auto cls = prog_.byte_class[static_cast<unsigned char>(*it)];
+                    auto target = next[state * classes + cls];
+                    if (target < 0)
+                    {
+                        target = dfa_transition_(dfa, state, cls, anchored);
+                        if (target < 0)
+                            return -1;
+
+                        // The tables might have been reallocated or flushed.
+                        next = dfa.next.data();
+                        info = dfa.info.data();
+                        skip_state = skip ? dfa.start[1] : regex_dfa_unknown;
+                    }
+
+                    state = target;
+                    ++it;
+                }
+
+                const auto& st = dfa.states[state];
+                if (st.accept || (!(flags_ & regex_constants::match_not_eol) && st.accept_at_end))
+                    return 1;
+                else
+                    return 0;
+            }
+
+            bool first_byte_(Char c) const
+            {
+                auto b = static_cast<unsigned char>(c);
+
+                return (prog_.first_bytes[b >> 5] >> (b & 31)) & 1U;
+            }
+
+            /**
+             * Adds the epsilon closure of pc to out. Instructions that
+             * consume input, match and end of line assertions (which
+             * can only be decided at the end of the input) are kept.
+             */
+            void dfa_closure_(vector<size_t>& out, vector<bool>& visited, size_t pc0,
+                              bool at_begin, bool at_end) const
+            {
+                const auto& code = prog_.code;
+                vector<size_t> stack{};
+                stack.push_back(pc0);
+
+                while (!stack.empty())
+                {
+                    auto pc = stack.back();
+                    stack.pop_back();
+
+                    if (visited[pc])
+                        continue;
+                    visited[pc] = true;
+
+                    const auto& inst = code[pc];
+                    switch (inst.op)
+                    {
+                        case regex_opcode::jump:
+                            stack.push_back(inst.x);
+                            break;
+                        case regex_opcode::split:
+                            stack.push_back(inst.y);
+                            stack.push_back(inst.x);
+                            break;
+                        case regex_opcode::save:
+                        case regex_opcode::repeat_begin:
+                        case regex_opcode::repeat_check:
+                        case regex_opcode::clear:
+                            stack.push_back(pc + 1);
+                            break;
+                        case regex_opcode::line_begin:
+                            if (at_begin)
+                                stack.push_back(pc + 1);
+                            break;
+                        case regex_opcode::line_end:
+                            if (at_end)
+                                stack.push_back(pc + 1);
+                            else
+                                out.push_back(pc);
+                            break;
+                        default:
+                            out.push_back(pc);
+                            break;
+                    }
+                }
+            }
+
+            int32_t dfa_add_state_(regex_dfa& dfa, vector<size_t>& pcs, bool at_begin)
+            {
+                sort(pcs.begin(), pcs.end());
+
+                auto key = pcs;
+                if (at_begin)
+                    key.push_back(static_cast<size_t>(-1));
+
+                auto it = dfa.index.find(key);
+                if (it != dfa.index.end())
+                    return it->second;
+
+                if (dfa.states.size() >= regex_dfa_max_states)
+                {
+                    dfa.flush();
+                    if (dfa.flushes > regex_dfa_max_flushes)
+                        return regex_dfa_failed;
+                }
+
+                const auto& code = prog_.code;
+                regex_dfa_state state{pcs, false, false};
+
+                vector<bool> visited(code.size(), false);
+                vector<size_t> at_end{};
+                for (auto pc: pcs)
+                {
+                    if (code[pc].op == regex_opcode::match)
+                        state.accept = true;
+                    else if (code[pc].op == regex_opcode::line_end)
+                        dfa_closure_(at_end, visited, pc + 1, at_begin, true);
+                }
+
+                state.accept_at_end = state.accept;
+                for (auto pc: at_end)
+                {
+                    if (code[pc].op == regex_opcode::match)
+                        state.accept_at_end = true;
+                }
+
+                auto idx = static_cast<int32_t>(dfa.states.size());
+                dfa.classes = prog_.class_repr.size();
+                dfa.next.resize(dfa.next.size() + dfa.classes, regex_dfa_unknown);
+                dfa.info.push_back(
+                    (state.accept ? regex_dfa_accept : 0) |
+                    (state.pcs.empty() ? regex_dfa_dead : 0)
+                );
+                dfa.states.push_back(move(state));
+                dfa.index.emplace(move(key), idx);
+
+                return idx;
+            }
+
+            int32_t dfa_start_(regex_dfa& dfa, bool at_begin)
+            {
+                auto& start = dfa.start[at_begin ? 0 : 1];
+                if (start >= 0)
+                    return start;
+
+                vector<bool> visited(prog_.code.size(), false);
+                vector<size_t> pcs{};
+                dfa_closure_(pcs, visited, 0, at_begin, false);
+
+                auto res = dfa_add_state_(dfa, pcs, at_begin);
+                dfa.start[at_begin ? 0 : 1] = res;
+
+                return res;
+            }
+
+            int32_t dfa_transition_(regex_dfa& dfa, int32_t from, uint8_t cls, bool anchored)
+            {
+                const auto& code = prog_.code;
+                auto c = static_cast<Char>(prog_.class_repr[cls]);
+
+                vector<bool> visited(code.size(), false);
+                vector<size_t> pcs{};
+                for (auto pc: dfa.states[from].pcs)
+                {
+                    if (prog_.consumes(code[pc], c))
+                        dfa_closure_(pcs, visited, pc + 1, false, false);
+                }
+
+                // Unanchored search: a match can start at the next position.
+                if (!anchored)
+                    dfa_closure_(pcs, visited, 0, false, false);
+
+                auto flushes = dfa.flushes;
+                auto res = dfa_add_state_(dfa, pcs, false);
+                if (res >= 0 && flushes == dfa.flushes)
+                    dfa.next[from * dfa.classes + cls] = res;
+
+                return res;
+            }
+    };
+}
+
+#endif
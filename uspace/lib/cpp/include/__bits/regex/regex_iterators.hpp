@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_ITERATORS
+#define LIBCPP_BITS_REGEX_ITERATORS
+
+#include <__bits/regex/regex_algorithms.hpp>
+#include <iterator>
+#include <vector>
+
+namespace std
+{
+    /**
+     * 28.12.1, class template regex_iterator:
+     */
+
+    template<
+        class BidirectionalIterator,
+        class Char = typename iterator_traits<BidirectionalIterator>::value_type,
+        class Traits = regex_traits<Char>
+    >
+    class regex_iterator
+    {
+        public:
+            using regex_type        = basic_regex<Char, Traits>;
+            using value_type        = match_results<BidirectionalIterator>;
+            using difference_type   = ptrdiff_t;
+            using pointer           = const value_type*;
+            using reference         = const value_type&;
+            using iterator_category = forward_iterator_tag;
+
+            regex_iterator()
+                : begin_{}, end_{}, pregex_{}, flags_{}, match_{}
+            { /* DUMMY BODY */ }
+
+            regex_iterator(BidirectionalIterator first, BidirectionalIterator last,
+                           const regex_type& re,
+                           regex_constants::match_flag_type flags = regex_constants::match_default)
+                : begin_{first}, end_{last}, pregex_{&re}, flags_{flags}, match_{}
+            {
+                if (!regex_search(begin_, end_, match_, *pregex_, flags_))
+                    pregex_ = nullptr;
+            }
+
+            regex_iterator(BidirectionalIterator, BidirectionalIterator,
+                           const regex_type&&,
+                           regex_constants::match_flag_type = regex_constants::match_default) = delete;
+
+            regex_iterator(const regex_iterator&) = default;
+            regex_iterator& operator=(const regex_iterator&) = default;
+
+            bool operator==(const regex_iterator& other) const
+            {
+                if (!pregex_ || !other.pregex_)
+                    return pregex_ == other.pregex_;
+
+                return begin_ == other.begin_ && end_ == other.end_ &&
+                       pregex_ == other.pregex_ && flags_ == other.flags_ &&
+                       match_[0] == other.match_[0];
+            }
+
+            bool operator!=(const regex_iterator& other) const
+            {
+                return !(*this == other);
+            }
+
+            reference operator*() const
+            {
+                return match_;
+            }
+
+            pointer operator->() const
+            {
+                return &match_;
+            }
+
+            regex_iterator& operator++()
+            {
+                auto start = match_[0].second;
+                auto prefix_first = start;
+
+                if (match_[0].first == match_[0].second)
+                {
+                    if (start == end_)
+                    {
+                        pregex_ = nullptr;
+
+                        return *this;
+                    }
+
+                    /**
+                     * After an empty match, try to find a non-empty one
+                     * at the same position before moving on, otherwise
+                     * the iterator would get stuck.
+                     */
+                    auto fl = flags_ | regex_constants::match_not_null |
+                              regex_constants::match_continuous;
+                    if (start != begin_)
+                        fl |= regex_constants::match_prev_avail;
+                    if (aux::regex_run(start, end_, &match_, *pregex_, fl, false,
+                                       begin_, prefix_first))
+                        return *this;
+
+                    ++start;
+                }
+
+                auto fl = flags_ | regex_constants::match_prev_avail;
+                if (!aux::regex_run(start, end_, &match_, *pregex_, fl, false,
+                                    begin_, prefix_first))
+                    pregex_ = nullptr;
+
+                return *this;
+            }
+
+            regex_iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++(*this);
+
+                return tmp;
+            }
+
+        private:
+            BidirectionalIterator begin_;
+            BidirectionalIterator end_;
+            const regex_type* pregex_;
+            regex_constants::match_flag_type flags_;
+            match_results<BidirectionalIterator> match_;
+    };
+
+    using cregex_iterator  = regex_iterator<const char*>;
+    using wcregex_iterator = regex_iterator<const wchar_t*>;
+    using sregex_iterator  = regex_iterator<string::const_iterator>;
+    using wsregex_iterator = regex_iterator<wstring::const_iterator>;
+
+    /**
+     * 28.12.2, class template regex_token_iterator:
+     */
+
+    template<
+        class BidirectionalIterator,
+        class Char = typename iterator_traits<BidirectionalIterator>::value_type,
+        class Traits = regex_traits<Char>
+    >
+    class regex_token_iterator
+    {
+        public:
+            using regex_type        = basic_regex<Char, Traits>;
+            using value_type        = sub_match<BidirectionalIterator>;
+            using difference_type   = ptrdiff_t;
+            using pointer           = const value_type*;
+            using reference         = const value_type&;
+            using iterator_category = forward_iterator_tag;
+
+            regex_token_iterator()
+                : position_{}, result_{}, suffix_{}, n_{}, subs_{}
+            { /* DUMMY BODY */ }
+
+            regex_token_iterator(BidirectionalIterator first, BidirectionalIterator last,
+                                 const regex_type& re, int submatch = 0,
+                                 regex_constants::match_flag_type flags = regex_constants::match_default)
+                : position_{first, last, re, flags}, result_{}, suffix_{}, n_{},
+                  subs_{submatch}
+            {
+                init_(first, last);
+            }
+
+            regex_token_iterator(BidirectionalIterator first, BidirectionalIterator last,
+                                 const regex_type& re, const vector<int>& submatches,
+                                 regex_constants::match_flag_type flags = regex_constants::match_default)
+                : position_{first, last, re, flags}, result_{}, suffix_{}, n_{},
+                  subs_{submatches}
+            {
+                init_(first, last);
+            }
+
+            regex_token_iterator(BidirectionalIterator first, BidirectionalIterator last,
+                                 const regex_type& re, initializer_list<int> submatches,
+                                 regex_constants::match_flag_type flags = regex_constants::match_default)
+                : position_{first, last, re, flags}, result_{}, suffix_{}, n_{},
+                  subs_(submatches)
+            {
+                init_(first, last);
+            }
+
+            template<size_t N>
+            regex_token_iterator(BidirectionalIterator first, BidirectionalIterator last,
+                                 const regex_type& re, const int (&submatches)[N],
+                                 regex_constants::match_flag_type flags = regex_constants::match_default)
+                : position_{first, last, re, flags}, result_{}, suffix_{}, n_{},
+                  subs_(submatches, submatches + N)
+            {
+                init_(first, last);
+            }
+
+            regex_token_iterator(BidirectionalIterator, BidirectionalIterator,
+                                 const regex_type&&, int = 0,
+                                 regex_constants::match_flag_type =
+                                 regex_constants::match_default) = delete;
+
+            regex_token_iterator(BidirectionalIterator, BidirectionalIterator,
+                                 const regex_type&&, const vector<int>&,
+                                 regex_constants::match_flag_type =
+                                 regex_constants::match_default) = delete;
+
+            regex_token_iterator(BidirectionalIterator, BidirectionalIterator,
+                                 const regex_type&&, initializer_list<int>,
+                                 regex_constants::match_flag_type =
+                                 regex_constants::match_default) = delete;
+
+            template<size_t N>
+            regex_token_iterator(BidirectionalIterator, BidirectionalIterator,
+                                 const regex_type&&, const int (&)[N],
+                                 regex_constants::match_flag_type =
+                                 regex_constants::match_default) = delete;
+
+            regex_token_iterator(const regex_token_iterator& other)
+                : position_{other.position_}, result_{}, suffix_{other.suffix_},
+                  n_{other.n_}, subs_{other.subs_}
+            {
+                rebind_(other);
+            }
+
+            regex_token_iterator& operator=(const regex_token_iterator& other)
+            {
+                position_ = other.position_;
+                suffix_ = other.suffix_;
+                n_ = other.n_;
+                subs_ = other.subs_;
+                rebind_(other);
+
+                return *this;
+            }
+
+            bool operator==(const regex_token_iterator& other) const
+            {
+                if (!result_ || !other.result_)
+                    return result_ == other.result_;
+
+                if (result_ == &suffix_ || other.result_ == &other.suffix_)
+                {
+                    return result_ == &suffix_ && other.result_ == &other.suffix_ &&
+                           suffix_ == other.suffix_;
+                }
+
+                return position_ == other.position_ && n_ == other.n_ &&
+                       subs_ == other.subs_;
+            }
+
+            bool operator!=(const regex_token_iterator& other) const
+            {
+                return !(*this == other);
+            }
+
+            reference operator*() const
+            {
+                return *result_;
+            }
+
+            pointer operator->() const
+            {
+                return result_;
+            }
+
+            regex_token_iterator& operator++()
+            {
+                if (!result_)
+                    return *this;
+
+                if (result_ == &suffix_)
+                {
+                    result_ = nullptr;
+
+                    return *this;
+                }
+
+                auto prev = position_;
+                if (n_ + 1 < subs_.size())
+                {
+                    ++n_;
+                    result_ = current_();
+
+                    return *this;
+                }
+
+                n_ = 0;
+                ++position_;
+
+                if (position_ != position_type{})
+                {
+                    result_ = current_();
+
+                    return *this;
+                }
+
+                /**
+                 * The remainder of the sequence after the last
+                 * match is a token as well if -1 was requested.
+                 */
+                if (find(subs_.begin(), subs_.end(), -1) != subs_.end() &&
+                    prev->suffix().length() != 0)
+                {
+                    suffix_ = prev->suffix();
+                    suffix_.matched = true;
+                    result_ = &suffix_;
+                }
+                else
+                    result_ = nullptr;
+
+                return *this;
+            }
+
+            regex_token_iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++(*this);
+
+                return tmp;
+            }
+
+        private:
+            using position_type = regex_iterator<BidirectionalIterator, Char, Traits>;
+
+            position_type position_;
+            const value_type* result_;
+            value_type suffix_;
+            size_t n_;
+            vector<int> subs_;
+
+            const value_type* current_() const
+            {
+                auto sub = subs_[n_];
+
+                return sub == -1 ? &position_->prefix() : &(*position_)[sub];
+            }
+
+            void init_(BidirectionalIterator first, BidirectionalIterator last)
+            {
+                if (position_ != position_type{})
+                    result_ = current_();
+                else if (find(subs_.begin(), subs_.end(), -1) != subs_.end() && first != last)
+                {
+                    // No match at all, the whole sequence is the suffix.
+                    suffix_.first = first;
+                    suffix_.second = last;
+                    suffix_.matched = true;
+                    result_ = &suffix_;
+                }
+            }
+
+            /**
+             * The result pointer points either into our own
+             * copy of the match or to our suffix.
+             */
+            void rebind_(const regex_token_iterator& other)
+            {
+                if (!other.result_)
+                    result_ = nullptr;
+                else if (other.result_ == &other.suffix_)
+                    result_ = &suffix_;
+                else
+                    result_ = current_();
+            }
+    };
+
+    using cregex_token_iterator  = regex_token_iterator<const char*>;
+    using wcregex_token_iterator = regex_token_iterator<const wchar_t*>;
+    using sregex_token_iterator  = regex_token_iterator<string::const_iterator>;
+    using wsregex_token_iterator = regex_token_iterator<wstring::const_iterator>;
+
+    /**
+     * 28.11.4, function template regex_replace:
+     */
+
+    template<class OutputIterator, class BidirIt, class Traits, class Char, class ST, class SA>
+    OutputIterator regex_replace(OutputIterator out, BidirIt first, BidirIt last,
+                                 const basic_regex<Char, Traits>& e,
+                                 const basic_string<Char, ST, SA>& fmt,
+                                 regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        return regex_replace(out, first, last, e, fmt.c_str(), flags);
+    }
+
+    template<class OutputIterator, class BidirIt, class Traits, class Char>
+    OutputIterator regex_replace(OutputIterator out, BidirIt first, BidirIt last,
+                                 const basic_regex<Char, Traits>& e, const Char* fmt,
+                                 regex_constants::match_flag_type flags = regex_constants::match_default)
+    {
+        regex_iterator<BidirIt, Char, Traits> it{first, last, e, flags};
+        regex_iterator<BidirIt, Char, Traits> end{};
+
+        auto fmt_last = fmt + char_traits<Char>::length(fmt);
+        bool copy_rest = !(flags & regex_constants::format_no_copy);
+
+        if (it == end)
+        {
+            if (copy_rest)
+                out = copy(first, last, out);
+
+            return out;
+        }
+
+        sub_match<BidirIt> last_suffix{};
+        while (it != end)
+        {
+            if (copy_rest)
+                out = copy(it->prefix().first, it->prefix().second, out);
+            out = it->format(out, fmt, fmt_last, flags);
+            last_suffix = it->suffix();
+
+            if (flags & regex_constants::format_first_only)
+                break;
+            ++it;
+        }
+
+        if (copy_rest)
+            out = copy(last_suffix.first, last_suffix.second, out);
+
+        return out;
+    }
+
+    template<class Traits, class Char, class ST, class SA, class FST, class FSA>
+    basic_string<Char, ST, SA> regex_replace(const basic_string<Char, ST, SA>& s,
+                                             const basic_regex<Char, Traits>& e,
+                                             const basic_string<Char, FST, FSA>& fmt,
+                                             regex_constants::match_flag_type flags =
+                                             regex_constants::match_default)
+    {
+        basic_string<Char, ST, SA> res{};
+        regex_replace(back_inserter(res), s.begin(), s.end(), e, fmt.c_str(), flags);
+
+        return res;
+    }
+
+    template<class Traits, class Char, class ST, class SA>
+    basic_string<Char, ST, SA> regex_replace(const basic_string<Char, ST, SA>& s,
+                                             const basic_regex<Char, Traits>& e,
+                                             const Char* fmt,
+                                             regex_constants::match_flag_type flags =
+                                             regex_constants::match_default)
+    {
+        basic_string<Char, ST, SA> res{};
+        regex_replace(back_inserter(res), s.begin(), s.end(), e, fmt, flags);
+
+        return res;
+    }
+
+    template<class Traits, class Char, class ST, class SA>
+    basic_string<Char> regex_replace(const Char* s, const basic_regex<Char, Traits>& e,
+                                     const basic_string<Char, ST, SA>& fmt,
+                                     regex_constants::match_flag_type flags =
+                                     regex_constants::match_default)
+    {
+        basic_string<Char> res{};
+        regex_replace(back_inserter(res), s, s + char_traits<Char>::length(s),
+                      e, fmt.c_str(), flags);
+
+        return res;
+    }
+
+    template<class Traits, class Char>
+    basic_string<Char> regex_replace(const Char* s, const basic_regex<Char, Traits>& e,
+                                     const Char* fmt,
+                                     regex_constants::match_flag_type flags =
+                                     regex_constants::match_default)
+    {
+        basic_string<Char> res{};
+        regex_replace(back_inserter(res), s, s + char_traits<Char>::length(s),
+                      e, fmt, flags);
+
+        return res;
+    }
+}
+
+#endif
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_TRAITS
+#define LIBCPP_BITS_REGEX_TRAITS
+
+#include <cctype>
+#include <cstdint>
+#include <locale>
+#include <string>
+
+namespace std
+{
+    namespace aux
+    {
+        /**
+         * Character classification used by regex_traits. Our ctype facets
+         * only know ASCII, so anything outside of it belongs to no class
+         * and has no case.
+         */
+
+        inline constexpr uint16_t regex_class_alnum  = 0b0000'0000'0000'0001;
+        inline constexpr uint16_t regex_class_alpha  = 0b0000'0000'0000'0010;
+        inline constexpr uint16_t regex_class_blank  = 0b0000'0000'0000'0100;
+        inline constexpr uint16_t regex_class_cntrl  = 0b0000'0000'0000'1000;
+        inline constexpr uint16_t regex_class_digit  = 0b0000'0000'0001'0000;
+        inline constexpr uint16_t regex_class_graph  = 0b0000'0000'0010'0000;
+        inline constexpr uint16_t regex_class_lower  = 0b0000'0000'0100'0000;
+        inline constexpr uint16_t regex_class_print  = 0b0000'0000'1000'0000;
+        inline constexpr uint16_t regex_class_punct  = 0b0000'0001'0000'0000;
+        inline constexpr uint16_t regex_class_space  = 0b0000'0010'0000'0000;
+        inline constexpr uint16_t regex_class_upper  = 0b0000'0100'0000'0000;
+        inline constexpr uint16_t regex_class_xdigit = 0b0000'1000'0000'0000;
+        inline constexpr uint16_t regex_class_under  = 0b0001'0000'0000'0000;
+        inline constexpr uint16_t regex_class_word   =
+            regex_class_alnum | regex_class_under;
+
+        template<class Char>
+        constexpr bool regex_is_ascii(Char c)
+        {
+            return static_cast<uint32_t>(c) < 128U;
+        }
+
+        template<class Char>
+        Char regex_tolower(Char c)
+        {
+            if (regex_is_ascii(c))
+                return static_cast<Char>(std::tolower(static_cast<int>(c)));
+            else
+                return c;
+        }
+
+        template<class Char>
+        Char regex_toupper(Char c)
+        {
+            if (regex_is_ascii(c))
+                return static_cast<Char>(std::toupper(static_cast<int>(c)));
+            else
+                return c;
+        }
+
+        struct regex_class_name
+        {
+            const char* name;
+            uint16_t mask;
+        };
+
+        inline constexpr regex_class_name regex_class_names[] = {
+            { "alnum",  regex_class_alnum },
+            { "alpha",  regex_class_alpha },
+            { "blank",  regex_class_blank },
+            { "cntrl",  regex_class_cntrl },
+            { "d",      regex_class_digit },
+            { "digit",  regex_class_digit },
+            { "graph",  regex_class_graph },
+            { "lower",  regex_class_lower },
+            { "print",  regex_class_print },
+            { "punct",  regex_class_punct },
+            { "s",      regex_class_space },
+            { "space",  regex_class_space },
+            { "upper",  regex_class_upper },
+            { "w",      regex_class_word },
+            { "xdigit", regex_class_xdigit }
+        };
+    }
+
+    /**
+     * 28.7, class template regex_traits:
+     */
+
+    template<class Char>
+    struct regex_traits
+    {
+        using char_type       = Char;
+        using string_type     = basic_string<char_type>;
+        using locale_type     = locale;
+        using char_class_type = uint16_t;
+
+        regex_traits()
+            : loc_{}
+        { /* DUMMY BODY */ }
+
+        static size_t length(const char_type* str)
+        {
+            return char_traits<char_type>::length(str);
+        }
+
+        char_type translate(char_type c) const
+        {
+            return c;
+        }
+
+        char_type translate_nocase(char_type c) const
+        {
+            return aux::regex_tolower(c);
+        }
+
+        template<class ForwardIterator>
+        string_type transform(ForwardIterator first, ForwardIterator last) const
+        {
+            return string_type(first, last);
+        }
+
+        template<class ForwardIterator>
+        string_type transform_primary(ForwardIterator first, ForwardIterator last) const
+        {
+            string_type res{};
+            while (first != last)
+                res.push_back(translate_nocase(*first++));
+
+            return res;
+        }
+
+        template<class ForwardIterator>
+        string_type lookup_collatename(ForwardIterator first, ForwardIterator last) const
+        {
+            /**
+             * We have no multi-character collating
+             * elements, only single characters name
+             * themselves.
+             */
+            if (first != last && next(first) == last)
+                return string_type(1, *first);
+            else
+                return string_type{};
+        }
+
+        template<class ForwardIterator>
+        char_class_type lookup_classname(ForwardIterator first, ForwardIterator last,
+                                         bool icase = false) const
+        {
+            for (const auto& cls: aux::regex_class_names)
+            {
+                auto it = first;
+                auto name = cls.name;
+
+                while (it != last && *name != '\0' &&
+                       translate_nocase(*it) == static_cast<char_type>(*name))
+                {
+                    ++it;
+                    ++name;
+                }
+
+                if (it != last || *name != '\0')
+                    continue;
+
+                auto mask = cls.mask;
+                if (icase && (mask & (aux::regex_class_lower | aux::regex_class_upper)))
+                    mask = aux::regex_class_alpha;
+
+                return mask;
+            }
+
+            return char_class_type{};
+        }
+
+        bool isctype(char_type c, char_class_type f) const
+        {
+            if ((f & aux::regex_class_under) && c == static_cast<char_type>('_'))
+                return true;
+
+            if (!aux::regex_is_ascii(c))
+                return false;
+
+            auto ic = static_cast<int>(c);
+            return ((f & aux::regex_class_alnum) && std::isalnum(ic)) ||
+                   ((f & aux::regex_class_alpha) && std::isalpha(ic)) ||
+                   ((f & aux::regex_class_blank) && std::isblank(ic)) ||
+                   ((f & aux::regex_class_cntrl) && std::iscntrl(ic)) ||
+                   ((f & aux::regex_class_digit) && std::isdigit(ic)) ||
+                   ((f & aux::regex_class_graph) && std::isgraph(ic)) ||
+                   ((f & aux::regex_class_lower) && std::islower(ic)) ||
+                   ((f & aux::regex_class_print) && std::isprint(ic)) ||
+                   ((f & aux::regex_class_punct) && std::ispunct(ic)) ||
+                   ((f & aux::regex_class_space) && std::isspace(ic)) ||
+                   ((f & aux::regex_class_upper) && std::isupper(ic)) ||
+                   ((f & aux::regex_class_xdigit) && std::isxdigit(ic));
+        }
+
+        int value(char_type c, int radix) const
+        {
+            int val{-1};
+            if (c >= static_cast<char_type>('0') && c <= static_cast<char_type>('9'))
+                val = static_cast<int>(c - static_cast<char_type>('0'));
+            else if (c >= static_cast<char_type>('a') && c <= static_cast<char_type>('f'))
+                val = static_cast<int>(c - static_cast<char_type>('a')) + 10;
+            else if (c >= static_cast<char_type>('A') && c <= static_cast<char_type>('F'))
+                val = static_cast<int>(c - static_cast<char_type>('A')) + 10;
+
+            return val < radix ? val : -1;
+        }
+
+        locale_type imbue(locale_type loc)
+        {
+            auto old = loc_;
+            loc_ = loc;
+
+            return old;
+        }
+
+        locale_type getloc() const
+        {
+            return loc_;
+        }
+
+        private:
+            locale_type loc_;
+    };
+}
+
+#endif
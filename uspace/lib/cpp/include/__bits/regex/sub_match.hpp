@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_REGEX_SUB_MATCH
+#define LIBCPP_BITS_REGEX_SUB_MATCH
+
+#include <iosfwd>
+#include <iterator>
+#include <string>
+#include <utility>
+
+namespace std
+{
+    /**
+     * 28.9, class template sub_match:
+     */
+
+    template<class BidirectionalIterator>
+    class sub_match: public pair<BidirectionalIterator, BidirectionalIterator>
+    {
+        public:
+            using value_type      = typename iterator_traits<BidirectionalIterator>::value_type;
+            using difference_type = typename iterator_traits<BidirectionalIterator>::difference_type;
+            using iterator        = BidirectionalIterator;
+            using string_type     = basic_string<value_type>;
+
+            bool matched;
+
+            constexpr sub_match()
+                : pair<BidirectionalIterator, BidirectionalIterator>{},
+                  matched{false}
+            { /* DUMMY BODY */ }
+
+            difference_type length() const
+            {
+                return matched ? distance(this->first, this->second) : difference_type{};
+            }
+
+            operator string_type() const
+            {
+                return str();
+            }
+
+            string_type str() const
+            {
+                return matched ? string_type(this->first, this->second) : string_type{};
+            }
+
+            int compare(const sub_match& other) const
+            {
+                return str().compare(other.str());
+            }
+
+            int compare(const string_type& str) const
+            {
+                return this->str().compare(str);
+            }
+
+            int compare(const value_type* str) const
+            {
+                return this->str().compare(str);
+            }
+    };
+
+    using csub_match  = sub_match<const char*>;
+    using wcsub_match = sub_match<const wchar_t*>;
+    using ssub_match  = sub_match<string::const_iterator>;
+    using wssub_match = sub_match<wstring::const_iterator>;
+
+    /**
+     * 28.9.2, sub_match non-member operators:
+     * Note: Comparisons with strings are provided for basic_string
+     *       and null terminated strings only.
+     */
+
+    template<class BidirIt>
+    bool operator==(const sub_match<BidirIt>& lhs, const sub_match<BidirIt>& rhs)
+    {
+        return lhs.compare(rhs) == 0;
+    }
+
+    template<class BidirIt>
+    bool operator!=(const sub_match<BidirIt>& lhs, const sub_match<BidirIt>& rhs)
+    {
+        return lhs.compare(rhs) != 0;
+    }
+
+    template<class BidirIt>
+    bool operator<(const sub_match<BidirIt>& lhs, const sub_match<BidirIt>& rhs)
+    {
+        return lhs.compare(rhs) < 0;
+    }
+
+    template<class BidirIt>
+    bool operator<=(const sub_match<BidirIt>& lhs, const sub_match<BidirIt>& rhs)
+    {
+        return lhs.compare(rhs) <= 0;
+    }
+
+    template<class BidirIt>
+    bool operator>=(const sub_match<BidirIt>& lhs, const sub_match<BidirIt>& rhs)
+    {
+        return lhs.compare(rhs) >= 0;
+    }
+
+    template<class BidirIt>
+    bool operator>(const sub_match<BidirIt>& lhs, const sub_match<BidirIt>& rhs)
+    {
+        return lhs.compare(rhs) > 0;
+    }
+
+    template<class BidirIt>
+    bool operator==(const sub_match<BidirIt>& lhs,
+                    const typename sub_match<BidirIt>::string_type& rhs)
+    {
+        return lhs.compare(rhs) == 0;
+    }
+
+    template<class BidirIt>
+    bool operator==(const typename sub_match<BidirIt>::string_type& lhs,
+                    const sub_match<BidirIt>& rhs)
+    {
+        return rhs.compare(lhs) == 0;
+    }
+
+    template<class BidirIt>
+    bool operator!=(const sub_match<BidirIt>& lhs,
+                    const typename sub_match<BidirIt>::string_type& rhs)
+    {
+        return lhs.compare(rhs) != 0;
+    }
+
+    template<class BidirIt>
+    bool operator!=(const typename sub_match<BidirIt>::string_type& lhs,
+                    const sub_match<BidirIt>& rhs)
+    {
+        return rhs.compare(lhs) != 0;
+    }
+
+    template<class BidirIt>
+    bool operator==(const sub_match<BidirIt>& lhs,
+                    const typename sub_match<BidirIt>::value_type* rhs)
+    {
+        return lhs.compare(rhs) == 0;
+    }
+
+    template<class BidirIt>
+    bool operator==(const typename sub_match<BidirIt>::value_type* lhs,
+                    const sub_match<BidirIt>& rhs)
+    {
+        return rhs.compare(lhs) == 0;
+    }
+
+    template<class BidirIt>
+    bool operator!=(const sub_match<BidirIt>& lhs,
+                    const typename sub_match<BidirIt>::value_type* rhs)
+    {
+        return lhs.compare(rhs) != 0;
+    }
+
+    template<class BidirIt>
+    bool operator!=(const typename sub_match<BidirIt>::value_type* lhs,
+                    const sub_match<BidirIt>& rhs)
+    {
+        return rhs.compare(lhs) != 0;
+    }
+
+    template<class Char, class Traits, class BidirIt>
+    basic_ostream<Char, Traits>& operator<<(basic_ostream<Char, Traits>& os,
+                                            const sub_match<BidirIt>& sub)
+    {
+        return os << sub.str();
+    }
+}
+
+#endif
@@ -454,7 +454,8 @@ namespace std
             { /* DUMMY BODY */ }
 
             explicit basic_string(const allocator_type& alloc)
-                : data_{}, size_{}, capacity_{}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
                 /**
                  * Postconditions:
@@ -462,29 +463,27 @@ namespace std
                  *  size() = 0
                  *  capacity() = unspecified
                  */
-                data_ = allocator_.allocate(default_capacity_);
-                capacity_ = default_capacity_;
+                ensure_null_terminator_();
             }
 
             basic_string(const basic_string& other)
-                : data_{}, size_{other.size_}, capacity_{other.capacity_},
+                : data_{local_}, size_{}, capacity_{local_capacity_},
                   allocator_{other.allocator_}
             {
-                init_(other.data(), size_);
+                init_(other.data(), other.size_);
             }
 
             basic_string(basic_string&& other)
-                : data_{other.data_}, size_{other.size_},
-                  capacity_{other.capacity_}, allocator_{move(other.allocator_)}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{move(other.allocator_)}
             {
-                other.data_ = nullptr;
-                other.size_ = 0;
-                other.capacity_ = 0;
+                steal_(other);
             }
 
             basic_string(const basic_string& other, size_type pos, size_type n = npos,
                          const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{}, capacity_{}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
                 // TODO: if pos < other.size() throw out_of_range.
                 auto len = min(n, other.size() - pos);
@@ -492,39 +491,43 @@ namespace std
             }
 
             basic_string(const value_type* str, size_type n, const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{n}, capacity_{n}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
-                init_(str, size_);
+                init_(str, n);
             }
 
             basic_string(const value_type* str, const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{}, capacity_{}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
                 init_(str, traits_type::length(str));
             }
 
             basic_string(size_type n, value_type c, const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{n}, capacity_{n}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
-                data_ = allocator_.allocate(capacity_);
-                for (size_type i = 0; i < size_; ++i)
-                    traits_type::assign(data_[i], c);
+                resize_without_copy_(n + 1);
+                traits_type::assign(data_, n, c);
+                size_ = n;
                 ensure_null_terminator_();
             }
 
             template<class InputIterator>
             basic_string(InputIterator first, InputIterator last,
                          const allocator_type& alloc = allocator_type{})
-                : data_{}, size_{}, capacity_{}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
                 if constexpr (is_integral<InputIterator>::value)
                 { // Required by the standard.
-                    size_ = static_cast<size_type>(first);
-                    capacity_ = size_;
-                    data_ = allocator_.allocate(capacity_);
+                    auto n = static_cast<size_type>(first);
+                    resize_without_copy_(n + 1);
 
-                    for (size_type i = 0; i < size_; ++i)
+                    for (size_type i = 0; i < n; ++i)
                         traits_type::assign(data_[i], static_cast<value_type>(last));
+                    size_ = n;
                     ensure_null_terminator_();
                 }
                 else
@@ -539,22 +542,23 @@ namespace std
             { /* DUMMY BODY */ }
 
             basic_string(const basic_string& other, const allocator_type& alloc)
-                : data_{}, size_{other.size_}, capacity_{other.capacity_}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
-                init_(other.data(), size_);
+                init_(other.data(), other.size_);
             }
 
             basic_string(basic_string&& other, const allocator_type& alloc)
-                : data_{other.data_}, size_{other.size_}, capacity_{other.capacity_}, allocator_{alloc}
+                : data_{local_}, size_{}, capacity_{local_capacity_},
+                  allocator_{alloc}
             {
-                other.data_ = nullptr;
-                other.size_ = 0;
-                other.capacity_ = 0;
+                steal_(other);
             }
 
             ~basic_string()
             {
-                allocator_.deallocate(data_, capacity_);
+                if (!is_local_())
+                    allocator_.deallocate(data_, capacity_);
             }
 
             basic_string& operator=(const basic_string& other)
@@ -690,7 +694,7 @@ namespace std
                 {
                     ensure_free_space_(new_size - size_ + 1);
                     for (size_type i = size_; i < new_size; ++i)
-                        traits_type::assign(data_[i], i);
+                        traits_type::assign(data_[i], c);
                 }
 
                 size_ = new_size;
@@ -704,7 +708,8 @@ namespace std
 
             size_type capacity() const noexcept
             {
-                return capacity_;
+                // One slot is always reserved for the null terminator.
+                return capacity_ - 1;
             }
 
             void reserve(size_type new_capacity = 0)
@@ -712,21 +717,39 @@ namespace std
                 // TODO: if new_capacity > max_size() throw
                 //       length_error (this function shall have no
                 //       effect in such case)
-                if (new_capacity > capacity_)
-                    resize_with_copy_(size_, new_capacity);
-                else if (new_capacity < capacity_)
+                if (new_capacity + 1 > capacity_)
+                    resize_with_copy_(size_, new_capacity + 1);
+                else if (new_capacity < capacity())
                     shrink_to_fit(); // Non-binding request, but why not.
             }
 
             void shrink_to_fit()
             {
-                if (size_ != capacity_)
-                    resize_with_copy_(size_, capacity_);
+                if (is_local_() || size_ + 1 == capacity_)
+                    return;
+
+                auto old_data = data_;
+                auto old_capacity = capacity_;
+
+                if (size_ + 1 <= local_capacity_)
+                {
+                    data_ = local_;
+                    capacity_ = local_capacity_;
+                }
+                else
+                {
+                    data_ = allocator_.allocate(size_ + 1);
+                    capacity_ = size_ + 1;
+                }
+
+                traits_type::copy(data_, old_data, size_ + 1);
+                allocator_.deallocate(old_data, old_capacity);
             }
 
             void clear() noexcept
             {
                 size_ = 0;
+                ensure_null_terminator_();
             }
 
             bool empty() const noexcept
@@ -891,8 +914,15 @@ namespace std
             basic_string& assign(const value_type* str, size_type n)
             {
                 // TODO: if (n > max_size()) throw length_error.
-                resize_without_copy_(n);
-                traits_type::copy(begin(), str, n);
+                if (n + 1 <= capacity_)
+                { // Note: str can point into our own buffer.
+                    traits_type::move(begin(), str, n);
+                }
+                else
+                {
+                    resize_without_copy_(n + 1);
+                    traits_type::copy(begin(), str, n);
+                }
                 size_ = n;
                 ensure_null_terminator_();
 
@@ -1015,7 +1045,7 @@ namespace std
             basic_string& erase(size_type pos = 0, size_type n = npos)
             {
                 auto len = min(n, size_ - pos);
-                copy_(begin() + pos + n, end(), begin() + pos);
+                copy_(begin() + pos + len, end(), begin() + pos);
                 size_ -= len;
                 ensure_null_terminator_();
 
@@ -1067,7 +1097,7 @@ namespace std
                 auto len = min(n1, size_ - pos);
 
                 basic_string tmp{};
-                tmp.resize_without_copy_(size_ - len + n2);
+                tmp.resize_without_copy_(size_ - len + n2 + 1);
 
                 // Prefix.
                 copy_(begin(), begin() + pos, tmp.begin());
@@ -1079,6 +1109,7 @@ namespace std
                 copy_(begin() + pos + len, end(), tmp.begin() + pos + n2);
 
                 tmp.size_ = size_ - len + n2;
+                tmp.ensure_null_terminator_();
                 swap(tmp);
                 return *this;
             }
@@ -1144,9 +1175,34 @@ namespace std
                 noexcept(allocator_traits<allocator_type>::propagate_on_container_swap::value ||
                          allocator_traits<allocator_type>::is_always_equal::value)
             {
-                std::swap(data_, other.data_);
+                if (is_local_() && other.is_local_())
+                {
+                    value_type tmp[local_capacity_];
+                    traits_type::copy(tmp, local_, size_ + 1);
+                    traits_type::copy(local_, other.local_, other.size_ + 1);
+                    traits_type::copy(other.local_, tmp, size_ + 1);
+                }
+                else if (is_local_())
+                {
+                    traits_type::copy(other.local_, local_, size_ + 1);
+                    data_ = other.data_;
+                    other.data_ = other.local_;
+                    std::swap(capacity_, other.capacity_);
+                }
+                else if (other.is_local_())
+                {
+                    traits_type::copy(local_, other.local_, other.size_ + 1);
+                    other.data_ = data_;
+                    data_ = local_;
+                    std::swap(capacity_, other.capacity_);
+                }
+                else
+                {
+                    std::swap(data_, other.data_);
+                    std::swap(capacity_, other.capacity_);
+                }
+
                 std::swap(size_, other.size_);
-                std::swap(capacity_, other.capacity_);
             }
 
             /**
@@ -1460,35 +1516,66 @@ namespace std
             }
 
         private:
+            /**
+             * Short strings (up to local_capacity_ - 1 characters,
+             * i.e. 15 chars for std::string) are kept in local_
+             * and data_ points to it, longer strings live
+             * in a buffer obtained from the allocator.
+             */
+            static constexpr size_type local_capacity_{
+                16 / sizeof(value_type) > 2 ? 16 / sizeof(value_type) : 2
+            };
+
             value_type* data_;
             size_type size_;
             size_type capacity_;
+            value_type local_[local_capacity_];
             allocator_type allocator_;
 
             template<class C, class T, class A>
             friend class basic_stringbuf;
 
-            /**
-             * Arbitrary value, standard just requires
-             * data() to have some capacity.
-             * (Well, we could've done data_ = &data_ and
-             * set capacity to 0, but that would be too cryptic.)
-             */
-            static constexpr size_type default_capacity_{4};
+            bool is_local_() const noexcept
+            {
+                return data_ == local_;
+            }
 
             void init_(const value_type* str, size_type size)
             {
-                if (data_)
-                    allocator_.deallocate(data_, capacity_);
+                if (size + 1 > capacity_)
+                    resize_without_copy_(size + 1);
 
                 size_ = size;
-                capacity_ = size + 1;
-
-                data_ = allocator_.allocate(capacity_);
                 traits_type::copy(data_, str, size);
                 ensure_null_terminator_();
             }
 
+            void steal_(basic_string& other)
+            {
+                /**
+                 * Only a heap buffer can change owners, short
+                 * strings are copied and their source is left
+                 * in the default (empty) state.
+                 */
+                if (other.is_local_())
+                    traits_type::copy(local_, other.local_, other.size_ + 1);
+                else
+                {
+                    if (!is_local_())
+                        allocator_.deallocate(data_, capacity_);
+
+                    data_ = other.data_;
+                    capacity_ = other.capacity_;
+
+                    other.data_ = other.local_;
+                    other.capacity_ = local_capacity_;
+                }
+
+                size_ = other.size_;
+                other.size_ = 0;
+                other.ensure_null_terminator_();
+            }
+
             size_type next_capacity_(size_type hint = 0) const noexcept
             {
                 if (hint != 0)
@@ -1510,30 +1597,35 @@ namespace std
 
             void resize_without_copy_(size_type capacity)
             {
-                if (data_)
-                    allocator_.deallocate(data_, capacity_);
+                if (capacity > capacity_)
+                {
+                    if (!is_local_())
+                        allocator_.deallocate(data_, capacity_);
+
+                    data_ = allocator_.allocate(capacity);
+                    capacity_ = capacity;
+                }
 
-                data_ = allocator_.allocate(capacity);
                 size_ = 0;
-                capacity_ = capacity;
                 ensure_null_terminator_();
             }
 
             void resize_with_copy_(size_type size, size_type capacity)
             {
-                if(capacity_ == 0 || capacity_ < capacity)
+                if (capacity_ < capacity)
                 {
                     auto new_data = allocator_.allocate(capacity);
 
                     auto to_copy = min(size, size_);
-                    traits_type::move(new_data, data_, to_copy);
+                    traits_type::copy(new_data, data_, to_copy);
 
-                    std::swap(data_, new_data);
+                    if (!is_local_())
+                        allocator_.deallocate(data_, capacity_);
 
-                    allocator_.deallocate(new_data, capacity_);
+                    data_ = new_data;
+                    capacity_ = capacity;
                 }
 
-                capacity_ = capacity;
                 size_ = size;
                 ensure_null_terminator_();
             }
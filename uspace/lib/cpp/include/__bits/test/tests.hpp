@@ -123,6 +123,52 @@ namespace std::test
             void test_find();
             void test_substr();
             void test_compare();
+            void test_small_strings();
+    };
+
+    class execution_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+
+        private:
+            void test_pool();
+            void test_for_each();
+            void test_transform();
+            void test_find();
+            void test_reduce();
+            void test_sort();
+    };
+
+    class iostream_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+
+        private:
+            void test_streambuf();
+            void test_ostream();
+            void test_fstream();
+    };
+
+    class regex_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+
+        private:
+            void test_match();
+            void test_search();
+            void test_submatches();
+            void test_repeats();
+            void test_grammars();
+            void test_flags();
+            void test_replace();
+            void test_iterators();
+            void test_pathological();
     };
 
     class bitset_test: public test_suite
@@ -207,6 +253,20 @@ namespace std::test
             void test_multi();
     };
 
+    class flat_hash_map_test: public test_suite
+    {
+        public:
+            bool run(bool) override;
+            const char* name() override;
+
+        private:
+            void test_constructors_and_assignment();
+            void test_histogram();
+            void test_emplace_insert();
+            void test_erase();
+            void test_growth();
+    };
+
     class unordered_set_test: public test_suite
     {
         public:
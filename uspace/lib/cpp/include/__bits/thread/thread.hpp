@@ -71,9 +71,19 @@ namespace std
                     return finished_;
                 }
 
-                void detach()
+                /**
+                 * Returns true if the thread has already finished,
+                 * in which case the caller is responsible for
+                 * deleting the wrapper.
+                 */
+                bool detach()
                 {
+                    aux::threading::mutex::lock(join_mtx_);
                     detached_ = true;
+                    bool res = finished_;
+                    aux::threading::mutex::unlock(join_mtx_);
+
+                    return res;
                 }
 
                 bool detached() const
@@ -96,15 +106,22 @@ namespace std
                     : joinable_wrapper{}, callable_{forward<Callable>(clbl)}
                 { /* DUMMY BODY */ }
 
-                void operator()()
+                /**
+                 * Returns true if the thread has been detached,
+                 * in which case the caller is responsible for
+                 * deleting the wrapper.
+                 */
+                bool operator()()
                 {
                     callable_();
 
                     aux::threading::mutex::lock(join_mtx_);
                     finished_ = true;
+                    bool res = detached_;
+                    aux::threading::condvar::broadcast(join_cv_);
                     aux::threading::mutex::unlock(join_mtx_);
 
-                    aux::threading::condvar::broadcast(join_cv_);
+                    return res;
                 }
 
             private:
@@ -195,11 +212,11 @@ namespace std
                 return 1;
 
             auto callable = static_cast<CallablePtr>(clbl);
-            (*callable)();
-
-            if (callable->detached())
+            if ((*callable)())
                 delete callable;
 
+            aux::threading::thread::finish();
+
             return 0;
         }
     }
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBCPP_BITS_THREAD_THREAD_POOL
+#define LIBCPP_BITS_THREAD_THREAD_POOL
+
+#include <__bits/thread/condition_variable.hpp>
+#include <__bits/thread/mutex.hpp>
+#include <__bits/thread/thread.hpp>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace std::aux
+{
+    class task_group;
+
+    /**
+     * Tasks are type erased, fn is called with ctx and idx,
+     * which lets a parallel loop submit all of its chunks
+     * without allocating anything per chunk.
+     */
+    struct pool_task
+    {
+        void (*fn)(void*, size_t);
+        void* ctx;
+        size_t idx;
+        task_group* group;
+    };
+
+    class task_group
+    {
+        public:
+            task_group()
+                : pending_{}
+            { /* DUMMY BODY */ }
+
+            void add(size_t count)
+            {
+                __atomic_add_fetch(&pending_, count, __ATOMIC_RELAXED);
+            }
+
+            void done()
+            {
+                __atomic_sub_fetch(&pending_, 1, __ATOMIC_RELEASE);
+            }
+
+            bool finished() const
+            {
+                return __atomic_load_n(&pending_, __ATOMIC_ACQUIRE) == 0;
+            }
+
+        private:
+            size_t pending_;
+    };
+
+    /**
+     * Pool of threads used by the parallel algorithms. Every worker
+     * has its own queue, it pushes and pops tasks at its back and
+     * when it runs out of work, it steals from the front of the
+     * queues of the other workers, which is where the largest
+     * (oldest) pieces of work are. Threads that are not workers submit
+     * to an extra queue and help with the work while they wait for
+     * their tasks to finish, which also makes nested parallel
+     * algorithms safe.
+     */
+    class work_stealing_pool
+    {
+        public:
+            static work_stealing_pool& get();
+
+            /**
+             * Number of threads that take part in the work,
+             * including the caller.
+             */
+            size_t concurrency() const
+            {
+                return workers_ + 1;
+            }
+
+            void submit(const pool_task& task);
+
+            void wait(task_group& group);
+
+            work_stealing_pool(const work_stealing_pool&) = delete;
+            work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+        private:
+            struct task_queue
+            {
+                mutex mtx{};
+                deque<pool_task> tasks{};
+            };
+
+            size_t workers_;
+            vector<unique_ptr<task_queue>> queues_;
+
+            /**
+             * Number of tasks in all queues, lets idle
+             * workers go to sleep instead of spinning.
+             */
+            size_t queued_;
+            size_t sleeping_;
+            mutex sleep_mtx_;
+            condition_variable sleep_cv_;
+
+            work_stealing_pool(size_t workers);
+
+            size_t current_queue_() const;
+
+            bool pop_(size_t idx, pool_task& task);
+            bool steal_(size_t idx, pool_task& task);
+            bool run_one_(size_t idx);
+
+            void worker_main_(size_t idx);
+    };
+
+    /**
+     * Calls fn(idx) for every idx in [0, count) in parallel, the
+     * caller takes idx 0 and then helps with the rest. Returns
+     * after all calls have finished.
+     */
+    template<class Function>
+    void parallel_invoke(size_t count, Function&& fn)
+    {
+        if (count == 0)
+            return;
+
+        auto& pool = work_stealing_pool::get();
+        if (count == 1 || pool.concurrency() == 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+                fn(i);
+
+            return;
+        }
+
+        struct context
+        {
+            Function& fn;
+            task_group group;
+
+            static void run(void* ptr, size_t idx)
+            {
+                auto ctx = static_cast<context*>(ptr);
+
+                ctx->fn(idx);
+                ctx->group.done();
+            }
+        };
+
+        context ctx{fn, {}};
+        ctx.group.add(count - 1);
+        for (size_t i = count - 1; i > 0; --i)
+            pool.submit(pool_task{&context::run, &ctx, i, &ctx.group});
+
+        fn(size_t{});
+        pool.wait(ctx.group);
+    }
+
+    /**
+     * Number of chunks a range of n elements is split into,
+     * every chunk has at least grain elements. Using a few
+     * more chunks than there are threads gives the stealing
+     * some room to balance uneven chunks or threads that
+     * were preempted.
+     */
+    inline size_t parallel_chunks(size_t n, size_t grain)
+    {
+        auto max_chunks = 4 * work_stealing_pool::get().concurrency();
+        if (grain == 0)
+            grain = 1;
+
+        auto chunks = n / grain;
+        if (chunks > max_chunks)
+            chunks = max_chunks;
+
+        return chunks > 0 ? chunks : 1;
+    }
+
+    inline size_t chunk_begin(size_t n, size_t chunks, size_t idx)
+    {
+        return n * idx / chunks;
+    }
+
+    /**
+     * Calls fn(idx, begin, end) for consecutive chunks of [0, n)
+     * in parallel.
+     */
+    template<class Function>
+    void parallel_for_chunks(size_t n, size_t chunks, Function&& fn)
+    {
+        parallel_invoke(chunks, [&](size_t idx){
+            fn(idx, chunk_begin(n, chunks, idx),
+               chunk_begin(n, chunks, idx + 1));
+        });
+    }
+
+    template<class Function>
+    void parallel_for(size_t n, size_t grain, Function&& fn)
+    {
+        if (n == 0)
+            return;
+
+        parallel_for_chunks(n, parallel_chunks(n, grain),
+            [&](size_t, size_t begin, size_t end){
+                fn(begin, end);
+            }
+        );
+    }
+}
+
+#endif
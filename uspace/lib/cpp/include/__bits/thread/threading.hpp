@@ -45,6 +45,9 @@ namespace std::aux
     struct fibril_tag
     { /* DUMMY BODY */ };
 
+    struct fibril_runner_tag
+    { /* DUMMY BODY */ };
+
     struct thread_tag
     { /* DUMMY BODY */ };
 
@@ -83,6 +86,9 @@ namespace std::aux
                 hel::fibril_yield();
             }
 
+            static void finish()
+            { /* DUMMY BODY */ }
+
             /**
              * Note: join & detach are performed at the C++
              *       level at the moment, but eventually should
@@ -215,13 +221,48 @@ namespace std::aux
         };
     };
 
+    /**
+     * Fibrils that can run in parallel on all available processors.
+     * They keep all the synchronization primitives, TLS and thread
+     * identity of the fibril policy, but every started thread makes
+     * sure that there is a kernel thread (runner) for each running
+     * thread. Runners are only spawned when the number of running
+     * threads exceeds the number of runners and are reused by threads
+     * started later.
+     *
+     * Note: The runners are shared with all other fibrils of the task,
+     *       so a thread that blocks in the kernel (not on a fibril
+     *       primitive) still holds its runner until it wakes up.
+     */
+    template<>
+    struct threading_policy<fibril_runner_tag>: threading_policy<fibril_tag>
+    {
+        struct thread: threading_policy<fibril_tag>::thread
+        {
+            static void start(thread_type thr)
+            {
+                auto running = __atomic_add_fetch(&running_, 1, __ATOMIC_RELAXED);
+                hel::fibril_ensure_runners(running);
+
+                threading_policy<fibril_tag>::thread::start(thr);
+            }
+
+            static void finish()
+            {
+                __atomic_sub_fetch(&running_, 1, __ATOMIC_RELAXED);
+            }
+
+            inline static int running_{};
+        };
+    };
+
     template<>
     struct threading_policy<thread_tag>
     {
-        // TODO:
+        // TODO: Needs thread_create, which is private to libc.
     };
 
-    using default_tag = fibril_tag;
+    using default_tag = fibril_runner_tag;
     using threading = threading_policy<default_tag>;
 
     using thread_t       = typename threading::thread_type;
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <execution>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace std::test
+{
+    bool execution_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_pool();
+        test_for_each();
+        test_transform();
+        test_find();
+        test_reduce();
+        test_sort();
+
+        return end();
+    }
+
+    const char* execution_test::name()
+    {
+        return "execution";
+    }
+
+    void execution_test::test_pool()
+    {
+        std::vector<int> hits(1000);
+        std::aux::parallel_invoke(hits.size(), [&](size_t idx){
+            ++hits[idx];
+        });
+        test("parallel_invoke each once", std::all_of(
+            hits.begin(), hits.end(), [](int x){ return x == 1; }
+        ));
+
+        std::vector<size_t> covered(100000);
+        std::aux::parallel_for(covered.size(), 100,
+            [&](size_t begin, size_t end){
+                for (auto i = begin; i < end; ++i)
+                    covered[i] += i;
+            }
+        );
+        bool ok{true};
+        for (size_t i = 0; i < covered.size(); ++i)
+            ok = ok && covered[i] == i;
+        test("parallel_for covers range", ok);
+
+        /**
+         * Nested parallel algorithms, waiting workers
+         * help instead of blocking.
+         */
+        std::vector<int> sums(8);
+        std::aux::parallel_invoke(sums.size(), [&](size_t idx){
+            std::vector<int> inner(10000, (int)idx);
+            sums[idx] = std::reduce(std::execution::par,
+                                    inner.begin(), inner.end());
+        });
+        ok = true;
+        for (size_t i = 0; i < sums.size(); ++i)
+            ok = ok && sums[i] == (int)(i * 10000);
+        test("nested", ok);
+
+        test("hardware_concurrency", std::thread::hardware_concurrency() > 0U);
+    }
+
+    void execution_test::test_for_each()
+    {
+        std::vector<int> data(50000, 1);
+
+        std::for_each(std::execution::par, data.begin(), data.end(),
+                      [](int& x){ x *= 3; });
+        test("for_each par", std::all_of(
+            data.begin(), data.end(), [](int x){ return x == 3; }
+        ));
+
+        auto it = std::for_each_n(std::execution::par_unseq, data.begin(),
+                                  100, [](int& x){ x = 0; });
+        test_eq("for_each_n result", it, data.begin() + 100);
+        test_eq("for_each_n count",
+                std::count(std::execution::par, data.begin(),
+                           data.end(), 0), 100);
+
+        std::fill(std::execution::par, data.begin(), data.end(), 7);
+        test_eq("fill par", std::count_if(
+            std::execution::par, data.begin(), data.end(),
+            [](int x){ return x == 7; }
+        ), 50000);
+
+        std::vector<int> small{1, 2, 3};
+        std::for_each(std::execution::seq, small.begin(), small.end(),
+                      [](int& x){ x += 1; });
+        test_eq("for_each seq", small[2], 4);
+    }
+
+    void execution_test::test_transform()
+    {
+        std::vector<int> src(40000);
+        std::iota(src.begin(), src.end(), 0);
+        std::vector<int> dst(src.size());
+
+        auto it = std::transform(std::execution::par, src.begin(), src.end(),
+                                 dst.begin(), [](int x){ return 2 * x; });
+        test_eq("transform unary result", it, dst.end());
+        bool ok{true};
+        for (size_t i = 0; i < dst.size(); ++i)
+            ok = ok && dst[i] == (int)(2 * i);
+        test("transform unary", ok);
+
+        std::transform(std::execution::par, src.begin(), src.end(),
+                       dst.begin(), dst.begin(),
+                       [](int x, int y){ return y - x; });
+        test("transform binary", std::equal(
+            src.begin(), src.end(), dst.begin()
+        ));
+
+        std::vector<int> copied(src.size());
+        std::copy(std::execution::par, src.begin(), src.end(), copied.begin());
+        test("copy par", std::equal(src.begin(), src.end(), copied.begin()));
+    }
+
+    void execution_test::test_find()
+    {
+        std::vector<int> data(60000, 0);
+        data[45000] = 1;
+        data[50000] = 1;
+
+        auto it = std::find(std::execution::par, data.begin(), data.end(), 1);
+        test_eq("find leftmost", it, data.begin() + 45000);
+
+        it = std::find(std::execution::par, data.begin(), data.end(), 2);
+        test_eq("find missing", it, data.end());
+
+        data[3] = 1;
+        it = std::find_if(std::execution::par, data.begin(), data.end(),
+                          [](int x){ return x != 0; });
+        test_eq("find_if", it, data.begin() + 3);
+
+        test("any_of", std::any_of(std::execution::par, data.begin(),
+                                   data.end(), [](int x){ return x == 1; }));
+        test("all_of", !std::all_of(std::execution::par, data.begin(),
+                                    data.end(), [](int x){ return x == 0; }));
+        test("none_of", std::none_of(std::execution::par, data.begin(),
+                                     data.end(), [](int x){ return x > 1; }));
+    }
+
+    void execution_test::test_reduce()
+    {
+        std::vector<long> data(100001);
+        std::iota(data.begin(), data.end(), 0L);
+
+        auto res1 = std::reduce(std::execution::par, data.begin(), data.end());
+        test_eq("reduce par", res1, 5000050000L);
+
+        auto res2 = std::reduce(std::execution::par, data.begin(),
+                                data.end(), 10L);
+        test_eq("reduce init", res2, 5000050010L);
+
+        auto res3 = std::reduce(data.begin(), data.end(), 0L);
+        test_eq("reduce seq", res3, res1);
+
+        auto res4 = std::reduce(
+            std::execution::par, data.begin(), data.end(), 0L,
+            [](long x, long y){ return x > y ? x : y; }
+        );
+        test_eq("reduce max", res4, 100000L);
+
+        auto res5 = std::transform_reduce(
+            std::execution::par, data.begin(), data.end(), 0L,
+            [](long x, long y){ return x + y; },
+            [](long x){ return x % 2; }
+        );
+        test_eq("transform_reduce unary", res5, 50000L);
+
+        std::vector<long> ones(data.size(), 1L);
+        auto res6 = std::transform_reduce(std::execution::par, data.begin(),
+                                          data.end(), ones.begin(), 0L);
+        test_eq("transform_reduce binary", res6, res1);
+
+        auto res7 = std::transform_reduce(data.begin(), data.end(),
+                                          ones.begin(), 0L);
+        test_eq("transform_reduce seq", res7, res1);
+
+        std::vector<long> empty{};
+        test_eq("reduce empty", std::reduce(std::execution::par, empty.begin(),
+                                            empty.end(), 3L), 3L);
+    }
+
+    void execution_test::test_sort()
+    {
+        std::vector<unsigned> data(70001);
+        unsigned seed{42};
+        for (auto& x: data)
+        {
+            seed = seed * 1103515245U + 12345U;
+            x = (seed >> 8) % 1000;
+        }
+        auto expected = data;
+        std::sort(expected.begin(), expected.end());
+
+        std::sort(std::execution::par, data.begin(), data.end());
+        test("sort par", std::equal(
+            data.begin(), data.end(), expected.begin()
+        ));
+
+        std::sort(std::execution::par, data.begin(), data.end(),
+                  [](unsigned x, unsigned y){ return x > y; });
+        test("sort par comp", std::is_sorted(
+            data.rbegin(), data.rend()
+        ));
+
+        std::vector<int> tiny{3, 1, 2};
+        std::sort(std::execution::par, tiny.begin(), tiny.end());
+        test("sort tiny", tiny[0] == 1 && tiny[1] == 2 && tiny[2] == 3);
+
+        std::vector<int> merged(6);
+        std::vector<int> lhs{1, 4, 6};
+        std::vector<int> rhs{2, 3, 5};
+        std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                   merged.begin());
+        test("merge", std::is_sorted(merged.begin(), merged.end()));
+    }
+}
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <flat_hash_map>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace std::test
+{
+    bool flat_hash_map_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_constructors_and_assignment();
+        test_histogram();
+        test_emplace_insert();
+        test_erase();
+        test_growth();
+
+        return end();
+    }
+
+    const char* flat_hash_map_test::name()
+    {
+        return "flat_hash_map";
+    }
+
+    void flat_hash_map_test::test_constructors_and_assignment()
+    {
+        auto check1 = {1, 2, 3, 4, 5, 6, 7};
+        auto src1 = {
+            std::pair<const int, int>{3, 3},
+            std::pair<const int, int>{1, 1},
+            std::pair<const int, int>{5, 5},
+            std::pair<const int, int>{2, 2},
+            std::pair<const int, int>{7, 7},
+            std::pair<const int, int>{6, 6},
+            std::pair<const int, int>{4, 4}
+        };
+
+        std::flat_hash_map<int, int> m1{src1};
+        test_contains(
+            "initializer list initialization",
+            check1.begin(), check1.end(), m1
+        );
+        test_eq("size", m1.size(), 7U);
+
+        std::flat_hash_map<int, int> m2{src1.begin(), src1.end()};
+        test_contains(
+            "iterator range initialization",
+            check1.begin(), check1.end(), m2
+        );
+
+        std::flat_hash_map<int, int> m3{m1};
+        test_contains(
+            "copy initialization",
+            check1.begin(), check1.end(), m3
+        );
+
+        std::flat_hash_map<int, int> m4{std::move(m1)};
+        test_contains(
+            "move initialization",
+            check1.begin(), check1.end(), m4
+        );
+        test_eq("move initialization - origin empty", m1.size(), 0U);
+        test_eq("empty", m1.empty(), true);
+        test("moved from begin == end", m1.begin() == m1.end());
+
+        m1 = m4;
+        test_contains(
+            "copy assignment",
+            check1.begin(), check1.end(), m1
+        );
+        test("equality", m1 == m4);
+
+        m4 = std::move(m1);
+        test_contains(
+            "move assignment",
+            check1.begin(), check1.end(), m4
+        );
+        test_eq("move assignment - origin empty", m1.size(), 0U);
+
+        m1 = src1;
+        test_contains(
+            "initializer list assignment",
+            check1.begin(), check1.end(), m1
+        );
+
+        std::flat_hash_map<int, int> m5{};
+        test("empty find", m5.find(1) == m5.end());
+        test_eq("empty count", m5.count(1), 0U);
+        test("empty iteration", m5.begin() == m5.end());
+    }
+
+    void flat_hash_map_test::test_histogram()
+    {
+        std::string str{"a b a a c d b e a b b e d c a e"};
+        std::flat_hash_map<std::string, std::size_t> map{};
+        std::istringstream iss{str};
+        std::string word{};
+
+        while (iss >> word)
+            ++map[word];
+
+        test_eq("histogram pt1", map["a"], 5U);
+        test_eq("histogram pt2", map["b"], 4U);
+        test_eq("histogram pt3", map["c"], 2U);
+        test_eq("histogram pt4", map["d"], 2U);
+        test_eq("histogram pt5", map["e"], 3U);
+        test_eq("histogram pt6", map["f"], 0U);
+        test_eq("at", map.at("a"), 5U);
+    }
+
+    void flat_hash_map_test::test_emplace_insert()
+    {
+        std::flat_hash_map<int, int> map1{};
+
+        auto res1 = map1.emplace(1, 2);
+        test_eq("first emplace succession", res1.second, true);
+        test_eq("first emplace equivalence pt1", res1.first->first, 1);
+        test_eq("first emplace equivalence pt2", res1.first->second, 2);
+
+        auto res2 = map1.emplace(1, 3);
+        test_eq("second emplace failure", res2.second, false);
+        test_eq("second emplace equivalence", res2.first->second, 2);
+
+        auto res3 = map1.insert(std::pair<const int, int>{2, 4});
+        test_eq("insert succession", res3.second, true);
+        test_eq("insert equivalence", res3.first->second, 4);
+
+        auto res4 = map1.insert(std::make_pair(2, 5));
+        test_eq("insert conversion failure", res4.second, false);
+
+        auto res5 = map1.try_emplace(3, 6);
+        test_eq("try_emplace succession", res5.second, true);
+        test_eq("try_emplace equivalence", res5.first->second, 6);
+
+        auto res6 = map1.try_emplace(3, 7);
+        test_eq("try_emplace failure", res6.second, false);
+        test_eq("try_emplace not changed", res6.first->second, 6);
+
+        auto res7 = map1.insert_or_assign(3, 8);
+        test_eq("insert_or_assign assign", res7.second, false);
+        test_eq("insert_or_assign assigned", map1[3], 8);
+
+        auto res8 = map1.insert_or_assign(4, 9);
+        test_eq("insert_or_assign insert", res8.second, true);
+        test_eq("size after inserts", map1.size(), 4U);
+        test("contains", map1.contains(4) && !map1.contains(5));
+    }
+
+    void flat_hash_map_test::test_erase()
+    {
+        std::flat_hash_map<int, int> map1{};
+        for (int i = 0; i < 100; ++i)
+            map1[i] = i * i;
+
+        test_eq("erase key", map1.erase(50), 1U);
+        test_eq("erase missing key", map1.erase(50), 0U);
+        test("erased not found", map1.find(50) == map1.end());
+        test_eq("size after erase", map1.size(), 99U);
+
+        auto it = map1.find(10);
+        auto next = it;
+        ++next;
+        auto res = map1.erase(it);
+        test("erase returns next", res == next);
+
+        size_t count{};
+        for (auto it = map1.begin(); it != map1.end();)
+        {
+            if (it->first % 2 == 0)
+                it = map1.erase(it);
+            else
+            {
+                ++count;
+                ++it;
+            }
+        }
+        test_eq("erase while iterating", count, 50U);
+        test_eq("size after erase loop", map1.size(), 50U);
+
+        bool ok{true};
+        for (int i = 1; i < 100; i += 2)
+            ok = ok && map1.at(i) == i * i;
+        test("remaining values", ok);
+
+        map1.erase(map1.begin(), map1.end());
+        test("erase range", map1.empty());
+        test("begin after erase range", map1.begin() == map1.end());
+    }
+
+    void flat_hash_map_test::test_growth()
+    {
+        /**
+         * Mixes inserts and erases so that the table grows
+         * and gets rid of tombstones, compared to the node
+         * based map.
+         */
+        std::flat_hash_map<unsigned, unsigned> map1{};
+        std::unordered_map<unsigned, unsigned> map2{};
+
+        unsigned seed{7};
+        bool ok{true};
+        for (unsigned i = 0; i < 20000; ++i)
+        {
+            seed = seed * 1103515245U + 12345U;
+            auto key = (seed >> 8) % 4096;
+
+            if (seed & 0x80000)
+            {
+                map1[key] = i;
+                map2[key] = i;
+            }
+            else
+                ok = ok && map1.erase(key) == map2.erase(key);
+        }
+        test("erase results", ok);
+        test_eq("size", map1.size(), map2.size());
+
+        ok = true;
+        for (const auto& x: map2)
+        {
+            auto it = map1.find(x.first);
+            ok = ok && it != map1.end() && it->second == x.second;
+        }
+        test("contents", ok);
+
+        size_t iterated{};
+        for (const auto& x: map1)
+        {
+            ok = ok && map2.count(x.first) == 1;
+            ++iterated;
+        }
+        test("iteration", ok && iterated == map1.size());
+        test("load factor", map1.load_factor() <= map1.max_load_factor());
+
+        std::flat_hash_map<int, int> map3{};
+        map3.reserve(1000);
+        auto buckets = map3.bucket_count();
+        for (int i = 0; i < 1000; ++i)
+            map3[i] = i;
+        test_eq("reserve", map3.bucket_count(), buckets);
+
+        map3.clear();
+        map3.rehash(0);
+        test_eq("rehash(0)", map3.bucket_count(), 0U);
+    }
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+
+namespace std::test
+{
+    namespace
+    {
+        /**
+         * Stream buffer with tiny get and put areas, counts
+         * how many times the virtual functions were called.
+         */
+        class small_streambuf: public std::streambuf
+        {
+            public:
+                small_streambuf(const std::string& input)
+                    : underflows{}, overflows{}, input_{input},
+                      pos_{}, output_{}
+                {
+                    setp(out_, out_ + sizeof(out_));
+                }
+
+                std::string output()
+                {
+                    sync();
+
+                    return output_;
+                }
+
+                size_t underflows;
+                size_t overflows;
+
+            protected:
+                int_type underflow() override
+                {
+                    ++underflows;
+                    if (pos_ >= input_.size())
+                        return traits_type::eof();
+
+                    auto count = std::min(sizeof(in_), input_.size() - pos_);
+                    input_.copy(in_, count, pos_);
+                    pos_ += count;
+                    setg(in_, in_, in_ + count);
+
+                    return traits_type::to_int_type(*in_);
+                }
+
+                int_type overflow(int_type c) override
+                {
+                    ++overflows;
+                    sync();
+                    if (!traits_type::eq_int_type(c, traits_type::eof()))
+                        sputc(traits_type::to_char_type(c));
+
+                    return traits_type::not_eof(c);
+                }
+
+                int sync() override
+                {
+                    output_.append(pbase(), pptr() - pbase());
+                    setp(out_, out_ + sizeof(out_));
+
+                    return 0;
+                }
+
+            private:
+                std::string input_;
+                size_t pos_;
+                std::string output_;
+
+                char in_[8];
+                char out_[8];
+        };
+    }
+
+    bool iostream_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_streambuf();
+        test_ostream();
+        test_fstream();
+
+        return end();
+    }
+
+    const char* iostream_test::name()
+    {
+        return "iostream";
+    }
+
+    void iostream_test::test_streambuf()
+    {
+        std::string data{"0123456789abcdefghijklmnopqrstuvwxyz"};
+
+        small_streambuf buf1{data};
+        char res1[64]{};
+        auto count1 = buf1.sgetn(res1, 20);
+        test_eq("sgetn count", count1, static_cast<std::streamsize>(20));
+        test_eq("sgetn data", std::string(res1, 20), data.substr(0, 20));
+        test_eq("sgetn underflows", buf1.underflows, 3U);
+
+        auto count2 = buf1.sgetn(res1, 64);
+        test_eq("sgetn at eof", count2, static_cast<std::streamsize>(16));
+        test_eq("sgetn rest", std::string(res1, 16), data.substr(20));
+
+        small_streambuf buf2{""};
+        auto count3 = buf2.sputn(data.c_str(), data.size());
+        test_eq("sputn count", count3, static_cast<std::streamsize>(data.size()));
+        test_eq("sputn data", buf2.output(), data);
+        test_eq("sputn overflows", buf2.overflows, 4U);
+    }
+
+    void iostream_test::test_ostream()
+    {
+        std::ostringstream oss{};
+        oss.width(6);
+        oss << "abc";
+        oss << std::string{"defgh"};
+        oss.width(2);
+        oss << std::string{"long"};
+        oss << std::left;
+        oss.width(5);
+        oss << "xy";
+        oss.write("|end", 4);
+        test_eq("padding", oss.str(), std::string{"   abcdefghlongxy   |end"});
+    }
+
+    void iostream_test::test_fstream()
+    {
+        const char* path = "/tmp/cpptest_iostream.txt";
+
+        std::string line(100, 'x');
+        std::string block(40000, 'b');
+        {
+            std::ofstream ofs{path};
+            test("ofstream open", ofs.is_open());
+
+            for (size_t i = 0; i < 1000; ++i)
+                ofs << line << '\n';
+            ofs.write(block.c_str(), block.size());
+            ofs << "tail\n";
+        }
+
+        std::ifstream ifs{path};
+        test("ifstream open", ifs.is_open());
+
+        std::string read_line{};
+        bool ok{true};
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            std::getline(ifs, read_line);
+            ok = ok && read_line == line;
+        }
+        test("getline", ok);
+
+        std::string read_block(block.size(), '\0');
+        ifs.read(&read_block[0], read_block.size());
+        test_eq("read block count", ifs.gcount(),
+                static_cast<std::streamsize>(block.size()));
+        test_eq("read block", read_block, block);
+
+        ifs.unget();
+        test_eq("unget", static_cast<char>(ifs.get()), 'b');
+
+        std::getline(ifs, read_line);
+        test_eq("tail", read_line, std::string{"tail"});
+
+        ifs.get();
+        test("eof", ifs.eof());
+
+        ifs.close();
+        std::remove(path);
+    }
+}
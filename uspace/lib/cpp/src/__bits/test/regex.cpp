@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/test/tests.hpp>
+#include <initializer_list>
+#include <iterator>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace std::test
+{
+    bool regex_test::run(bool report)
+    {
+        report_ = report;
+        start();
+
+        test_match();
+        test_search();
+        test_submatches();
+        test_repeats();
+        test_grammars();
+        test_flags();
+        test_replace();
+        test_iterators();
+        test_pathological();
+
+        return end();
+    }
+
+    const char* regex_test::name()
+    {
+        return "regex";
+    }
+
+    void regex_test::test_match()
+    {
+        std::regex r1{"abc"};
+        test("match literal", std::regex_match("abc", r1));
+        test("match literal prefix only", !std::regex_match("abcd", r1));
+
+        std::regex r2{"a(b|c)*d"};
+        test("match alternation star", std::regex_match("abcbcd", r2));
+        test("match alternation star empty", std::regex_match("ad", r2));
+        test("match alternation star fail", !std::regex_match("abxd", r2));
+
+        std::regex r3{"[a-f0-9]{2,4}"};
+        test("match bounded repeat min", std::regex_match("a0", r3));
+        test("match bounded repeat max", std::regex_match("a0f9", r3));
+        test("match bounded repeat over", !std::regex_match("a0f9b", r3));
+        test("match bounded repeat under", !std::regex_match("a", r3));
+
+        std::regex r4{"\\d+\\.\\d*"};
+        test("match class escapes", std::regex_match("12.", r4));
+        test("match class escapes fail", !std::regex_match(".12", r4));
+
+        std::regex r5{"[^[:space:]]+"};
+        test("match negated named class", std::regex_match("foo-bar", r5));
+        test("match negated named class fail", !std::regex_match("foo bar", r5));
+
+        std::regex r6{""};
+        test("match empty regex", std::regex_match("", r6));
+        test("match empty regex fail", !std::regex_match("a", r6));
+
+        std::regex r7{"a.c"};
+        test("match any", std::regex_match("a-c", r7));
+        test("match any not newline", !std::regex_match("a\nc", r7));
+    }
+
+    void regex_test::test_search()
+    {
+        std::regex r1{"fo+"};
+        test("search inside", std::regex_search("xxfoooyy", r1));
+        test("search fail", !std::regex_search("xxfyy", r1));
+
+        std::regex r2{"^ab"};
+        test("search anchored", std::regex_search("abab", r2));
+        test("search anchored fail", !std::regex_search("cab", r2));
+
+        std::regex r3{"ab$"};
+        test("search end anchor", std::regex_search("abab", r3));
+        test("search end anchor fail", !std::regex_search("aba", r3));
+
+        std::regex r4{"\\bcat\\b"};
+        test("search word boundary", std::regex_search("a cat!", r4));
+        test("search word boundary fail", !std::regex_search("concat", r4));
+
+        std::string long_str(1000, 'x');
+        long_str += "needle";
+        long_str += std::string(1000, 'y');
+        std::regex r5{"ne+dle"};
+        std::smatch m;
+        test("search long", std::regex_search(long_str, m, r5));
+        test_eq("search long position", m.position(), 1000);
+        test_eq("search long length", m.length(), 6);
+    }
+
+    void regex_test::test_submatches()
+    {
+        std::regex r1{"(\\w+)@(\\w+)\\.com"};
+        std::cmatch m1;
+        test("submatch search", std::regex_search("mail: john@example.com.", m1, r1));
+        test_eq("submatch size", m1.size(), 3U);
+        test_eq("submatch whole", m1.str(0), std::string{"john@example.com"});
+        test_eq("submatch 1", m1.str(1), std::string{"john"});
+        test_eq("submatch 2", m1.str(2), std::string{"example"});
+        test_eq("submatch position", m1.position(1), 6);
+        test_eq("submatch prefix", m1.prefix().str(), std::string{"mail: "});
+        test_eq("submatch suffix", m1.suffix().str(), std::string{"."});
+
+        std::regex r2{"(a)|(b)"};
+        std::cmatch m2;
+        std::regex_match("b", m2, r2);
+        test("unmatched submatch", !m2[1].matched);
+        test("matched submatch", m2[2].matched);
+
+        std::regex r3{"(a*)(a*)"};
+        std::cmatch m3;
+        std::regex_match("aaa", m3, r3);
+        test_eq("greedy submatch 1", m3.length(1), 3);
+        test_eq("greedy submatch 2", m3.length(2), 0);
+
+        std::regex r4{"(a*?)(a*)"};
+        std::cmatch m4;
+        std::regex_match("aaa", m4, r4);
+        test_eq("lazy submatch 1", m4.length(1), 0);
+        test_eq("lazy submatch 2", m4.length(2), 3);
+
+        std::regex r5{"(?:ab)+(c)"};
+        test_eq("non-capturing group mark count", r5.mark_count(), 1U);
+
+        std::regex r6{"a|ab"};
+        std::cmatch m6;
+        std::regex_search("xabc", m6, r6);
+        test_eq("leftmost first", m6.str(0), std::string{"a"});
+
+        std::regex r7{"a|ab", std::regex::extended};
+        std::cmatch m7;
+        std::regex_search("xabc", m7, r7);
+        test_eq("leftmost longest", m7.str(0), std::string{"ab"});
+
+        std::regex r8{"(a)(b)", std::regex::nosubs};
+        std::cmatch m8;
+        std::regex_match("ab", m8, r8);
+        test_eq("nosubs size", m8.size(), 1U);
+        test_eq("nosubs mark count", r8.mark_count(), 0U);
+    }
+
+    void regex_test::test_repeats()
+    {
+        // Optional iterations that match the empty string fail.
+        std::regex r1{"(?:(\\s?|\\d?)|x){0,3}"};
+        std::cmatch m1;
+        test("empty iteration search", std::regex_search("x", m1, r1));
+        test_eq("empty iteration match", m1.str(0), std::string{"x"});
+        test("empty iteration submatch", !m1[1].matched);
+
+        std::regex r2{"(a*?)*"};
+        std::cmatch m2;
+        test("lazy empty iteration search", std::regex_search("aa", m2, r2));
+        test_eq("lazy empty iteration match", m2.str(0), std::string{"aa"});
+        test_eq("lazy empty iteration submatch", m2.str(1), std::string{"a"});
+        test_eq("lazy empty iteration position", m2.position(1), 1);
+
+        std::regex r3{"(?:a?|b)*"};
+        std::cmatch m3;
+        test("empty alternative search", std::regex_search("b", m3, r3));
+        test_eq("empty alternative match", m3.str(0), std::string{"b"});
+
+        // Captures are cleared at the start of each iteration.
+        std::regex r4{"(?:c|(\\s+?)){0,3}"};
+        std::cmatch m4;
+        test("cleared capture search", std::regex_search(" c1", m4, r4));
+        test_eq("cleared capture match", m4.str(0), std::string{" c"});
+        test("cleared capture submatch", !m4[1].matched);
+
+        std::regex r5{"(?:(a)|b)+"};
+        std::cmatch m5;
+        test("cleared capture plus", std::regex_match("ab", m5, r5));
+        test("cleared capture plus submatch", !m5[1].matched);
+
+        // Mandatory iterations may match the empty string.
+        std::regex r6{"(a?){2}b"};
+        std::cmatch m6;
+        test("mandatory empty iteration", std::regex_match("ab", m6, r6));
+        test_eq("mandatory empty iteration submatch", m6.length(1), 0);
+        test_eq("mandatory empty iteration position", m6.position(1), 1);
+    }
+
+    void regex_test::test_grammars()
+    {
+        std::regex r1{"a\\{2\\}\\(b\\)", std::regex::basic};
+        std::cmatch m1;
+        test("basic grammar", std::regex_match("aab", m1, r1));
+        test_eq("basic grammar group", m1.str(1), std::string{"b"});
+
+        std::regex r2{"a+(b|c)?", std::regex::extended};
+        test("extended grammar", std::regex_match("aac", r2));
+
+        std::regex r3{"abc\nxyz", std::regex::grep};
+        test("grep newline alternation", std::regex_search("--xyz--", r3));
+
+        std::regex r4{"ab+\ncd", std::regex::egrep};
+        test("egrep newline alternation", std::regex_search("abbb", r4));
+
+        std::regex r5{"[[:alpha:]]+", std::regex::awk};
+        test("awk grammar", std::regex_match("abc", r5));
+    }
+
+    void regex_test::test_flags()
+    {
+        std::regex r1{"hello", std::regex::icase};
+        test("icase", std::regex_match("HeLLo", r1));
+
+        std::regex r2{"[a-c]+", std::regex::icase};
+        test("icase range", std::regex_match("AbC", r2));
+
+        std::regex r3{"^b", std::regex::multiline};
+        test("multiline begin", std::regex_search("a\nb", r3));
+
+        std::regex r4{"^b"};
+        test("no multiline begin", !std::regex_search("a\nb", r4));
+        test("match_not_bol", !std::regex_search("b", r4, std::regex_constants::match_not_bol));
+
+        std::regex r5{"a$"};
+        test("match_not_eol", !std::regex_search("a", r5, std::regex_constants::match_not_eol));
+
+        std::regex r6{"a*"};
+        std::cmatch m6;
+        test(
+            "match_not_null",
+            std::regex_search("bbaa", m6, r6, std::regex_constants::match_not_null)
+        );
+        test_eq("match_not_null position", m6.position(), 2);
+
+        std::regex r7{"b"};
+        test(
+            "match_continuous",
+            !std::regex_search("ab", r7, std::regex_constants::match_continuous)
+        );
+    }
+
+    void regex_test::test_replace()
+    {
+        std::regex r1{"(\\w+)=(\\d+)"};
+        std::string s1{"a=1, b=22"};
+        test_eq(
+            "replace swap groups",
+            std::regex_replace(s1, r1, "$2=$1"),
+            std::string{"1=a, 22=b"}
+        );
+        test_eq(
+            "replace first only",
+            std::regex_replace(s1, r1, "[$&]", std::regex_constants::format_first_only),
+            std::string{"[a=1], b=22"}
+        );
+        test_eq(
+            "replace no copy",
+            std::regex_replace(s1, r1, "$1;", std::regex_constants::format_no_copy),
+            std::string{"a;b;"}
+        );
+        test_eq(
+            "replace sed format",
+            std::regex_replace(s1, r1, "\\2\\1&", std::regex_constants::format_sed),
+            std::string{"1aa=1, 22bb=22"}
+        );
+
+        std::regex r2{"x*"};
+        test_eq(
+            "replace empty matches",
+            std::regex_replace(std::string{"abc"}, r2, "-"),
+            std::string{"-a-b-c-"}
+        );
+    }
+
+    void regex_test::test_iterators()
+    {
+        std::string s1{"one two  three"};
+        std::regex r1{"\\w+"};
+        std::vector<std::string> words{};
+        std::vector<std::string> check1{"one", "two", "three"};
+        for (std::sregex_iterator it{s1.begin(), s1.end(), r1}, end; it != end; ++it)
+            words.push_back(it->str());
+        test_eq("regex iterator", words.begin(), words.end(), check1.begin(), check1.end());
+
+        std::sregex_iterator it1{s1.begin(), s1.end(), r1};
+        ++it1;
+        test_eq("regex iterator position", it1->position(), 4);
+
+        std::regex r2{"\\s+"};
+        std::vector<std::string> tokens{};
+        std::sregex_token_iterator it2{s1.begin(), s1.end(), r2, -1};
+        for (std::sregex_token_iterator end; it2 != end; ++it2)
+            tokens.push_back(it2->str());
+        test_eq("token iterator split", tokens.begin(), tokens.end(), check1.begin(), check1.end());
+
+        std::string s3{"k1=v1;k2=v2"};
+        std::regex r3{"(\\w+)=(\\w+)"};
+        std::vector<std::string> pairs{};
+        std::vector<std::string> check3{"k1", "v1", "k2", "v2"};
+        std::sregex_token_iterator it3{s3.begin(), s3.end(), r3, {1, 2}};
+        for (std::sregex_token_iterator end; it3 != end; ++it3)
+            pairs.push_back(it3->str());
+        test_eq("token iterator submatches", pairs.begin(), pairs.end(), check3.begin(), check3.end());
+    }
+
+    void regex_test::test_pathological()
+    {
+        /**
+         * These would take exponential time in a backtracking
+         * matcher, but are linear in the length of the input
+         * for the automaton based one.
+         */
+        std::string s1(40, 'a');
+        std::string r1_str{};
+        for (int i = 0; i < 40; ++i)
+            r1_str += "a?";
+        r1_str += s1;
+        std::regex r1{r1_str};
+        test("pathological optional", std::regex_match(s1, r1));
+
+        std::regex r2{"(a*)*b"};
+        test("pathological nested star", !std::regex_match(std::string(5000, 'a'), r2));
+
+        std::cmatch m3;
+        std::regex r3{"(x+x+)+y"};
+        test("pathological submatches", !std::regex_search("xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx", m3, r3));
+    }
+}
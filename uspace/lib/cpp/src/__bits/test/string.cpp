@@ -47,6 +47,7 @@ namespace std::test
         test_find();
         test_substr();
         test_compare();
+        test_small_strings();
 
         return end();
     }
@@ -703,4 +704,108 @@ namespace std::test
             res, 0
         );
     }
+
+    void string_test::test_small_strings()
+    {
+        const char* check_short = "short string";
+        const char* check_long = "a string too long to be stored inline";
+
+        std::string str1{};
+        test(
+            "default constructor has inline capacity",
+            str1.capacity() >= 15ul
+        );
+        test_eq(
+            "default constructor null terminated",
+            str1.c_str()[0], '\0'
+        );
+
+        std::string str2{check_short};
+        auto data2 = str2.data();
+        std::string str3{std::move(str2)};
+        test_eq(
+            "move of a short string",
+            str3.begin(), str3.end(),
+            check_short, check_short + 12
+        );
+        test(
+            "move of a short string does not share buffer",
+            str3.data() != data2
+        );
+        test_eq(
+            "move of a short string leaves source empty",
+            str2.size(), 0ul
+        );
+
+        std::string str4{check_long};
+        auto data4 = str4.data();
+        std::string str5{std::move(str4)};
+        test_eq(
+            "move of a long string",
+            str5.begin(), str5.end(),
+            check_long, check_long + 37
+        );
+        test(
+            "move of a long string steals buffer",
+            str5.data() == data4
+        );
+
+        str3.swap(str5);
+        test_eq(
+            "swap short with long (short side)",
+            str5.begin(), str5.end(),
+            check_short, check_short + 12
+        );
+        test_eq(
+            "swap short with long (long side)",
+            str3.begin(), str3.end(),
+            check_long, check_long + 37
+        );
+        test(
+            "swap short with long keeps long buffer",
+            str3.data() == data4
+        );
+
+        std::string str6{"abc"};
+        std::string str7{"defgh"};
+        str6.swap(str7);
+        test_eq(
+            "swap two short strings",
+            str6.begin(), str6.end(),
+            "defgh", "defgh" + 5
+        );
+        test_eq(
+            "swap two short strings (other side)",
+            str7.begin(), str7.end(),
+            "abc", "abc" + 3
+        );
+
+        std::string str8{"0123456789"};
+        str8.append("abcdefghij");
+        test_eq(
+            "append over inline capacity",
+            str8.begin(), str8.end(),
+            "0123456789abcdefghij", "0123456789abcdefghij" + 20
+        );
+
+        str8.erase(5);
+        str8.shrink_to_fit();
+        test_eq(
+            "shrink back to inline buffer",
+            str8.begin(), str8.end(),
+            "01234", "01234" + 5
+        );
+        test_eq(
+            "shrink back to inline buffer (terminator)",
+            str8.c_str()[5], '\0'
+        );
+
+        std::string str9{};
+        str9.resize(4, 'x');
+        test_eq(
+            "resize with a character",
+            str9.begin(), str9.end(),
+            "xxxx", "xxxx" + 4
+        );
+    }
 }
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <__bits/thread/thread_pool.hpp>
+#include <thread>
+
+namespace std::aux
+{
+    namespace
+    {
+        /**
+         * Index of the queue owned by the current thread,
+         * non-worker threads use the shared one.
+         */
+        thread_local size_t worker_index{static_cast<size_t>(-1)};
+    }
+
+    work_stealing_pool& work_stealing_pool::get()
+    {
+        /**
+         * Note: The pool is never destroyed, its workers
+         *       just sleep when there is nothing to do.
+         */
+        static work_stealing_pool* pool{
+            new work_stealing_pool{thread::hardware_concurrency()}
+        };
+
+        return *pool;
+    }
+
+    work_stealing_pool::work_stealing_pool(size_t cpus)
+        : workers_{cpus > 1 ? cpus - 1 : 0}, queues_{}, queued_{},
+          sleeping_{}, sleep_mtx_{}, sleep_cv_{}
+    {
+        // The last queue is shared by all non-worker threads.
+        for (size_t i = 0; i <= workers_; ++i)
+            queues_.push_back(make_unique<task_queue>());
+
+        for (size_t i = 0; i < workers_; ++i)
+        {
+            thread worker{[this, i](){ worker_main_(i); }};
+            worker.detach();
+        }
+    }
+
+    size_t work_stealing_pool::current_queue_() const
+    {
+        auto idx = worker_index;
+
+        return idx < workers_ ? idx : workers_;
+    }
+
+    void work_stealing_pool::submit(const pool_task& task)
+    {
+        auto& queue = *queues_[current_queue_()];
+
+        queue.mtx.lock();
+        queue.tasks.push_back(task);
+        queue.mtx.unlock();
+
+        __atomic_add_fetch(&queued_, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&sleeping_, __ATOMIC_SEQ_CST) > 0)
+        {
+            /**
+             * Taking the lock makes sure that a worker that
+             * has just seen no queued tasks is already waiting.
+             */
+            sleep_mtx_.lock();
+            sleep_cv_.notify_one();
+            sleep_mtx_.unlock();
+        }
+    }
+
+    bool work_stealing_pool::pop_(size_t idx, pool_task& task)
+    {
+        auto& queue = *queues_[idx];
+        bool res{false};
+
+        queue.mtx.lock();
+        if (!queue.tasks.empty())
+        {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+            res = true;
+        }
+        queue.mtx.unlock();
+
+        return res;
+    }
+
+    bool work_stealing_pool::steal_(size_t idx, pool_task& task)
+    {
+        auto count = queues_.size();
+
+        for (size_t i = 1; i < count; ++i)
+        {
+            auto& queue = *queues_[(idx + i) % count];
+            if (!queue.mtx.try_lock())
+                continue;
+
+            bool res{false};
+            if (!queue.tasks.empty())
+            {
+                task = queue.tasks.front();
+                queue.tasks.pop_front();
+                res = true;
+            }
+            queue.mtx.unlock();
+
+            if (res)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool work_stealing_pool::run_one_(size_t idx)
+    {
+        pool_task task{};
+        if (!pop_(idx, task) && !steal_(idx, task))
+            return false;
+
+        __atomic_sub_fetch(&queued_, 1, __ATOMIC_SEQ_CST);
+        task.fn(task.ctx, task.idx);
+
+        return true;
+    }
+
+    void work_stealing_pool::wait(task_group& group)
+    {
+        auto idx = current_queue_();
+
+        while (!group.finished())
+        {
+            if (!run_one_(idx))
+                this_thread::yield();
+        }
+    }
+
+    void work_stealing_pool::worker_main_(size_t idx)
+    {
+        worker_index = idx;
+
+        while (true)
+        {
+            if (run_one_(idx))
+                continue;
+
+            /**
+             * Stealing might have failed on a contended lock,
+             * so only sleep if there really is nothing to do.
+             */
+            unique_lock<mutex> lock{sleep_mtx_};
+            __atomic_add_fetch(&sleeping_, 1, __ATOMIC_SEQ_CST);
+            while (__atomic_load_n(&queued_, __ATOMIC_SEQ_CST) == 0)
+                sleep_cv_.wait(lock);
+            __atomic_sub_fetch(&sleeping_, 1, __ATOMIC_SEQ_CST);
+        }
+    }
+}
@@ -39,6 +39,12 @@ namespace std
     namespace aux
     {
         ios_base::Init init{};
+
+        namespace
+        {
+            stdin_streambuf<char>* stdin_buf{};
+            stdout_streambuf<char>* stdout_buf{};
+        }
     }
 
     int ios_base::Init::init_cnt_{};
@@ -49,8 +55,17 @@ namespace std
         {
             // TODO: These buffers should be static too
             //       in case somebody reassigns to cout/cin.
-            ::new(&cin) istream{::new aux::stdin_streambuf<char>{}};
-            ::new(&cout) ostream{::new aux::stdout_streambuf<char>{}};
+            aux::stdin_buf = ::new aux::stdin_streambuf<char>{};
+            aux::stdout_buf = ::new aux::stdout_streambuf<char>{};
+
+            ::new(&cin) istream{aux::stdin_buf};
+            ::new(&cout) ostream{aux::stdout_buf};
+
+            if (!sync_)
+            {
+                aux::stdin_buf->sync_with_stdio(false);
+                aux::stdout_buf->sync_with_stdio(false);
+            }
 
             cin.tie(&cout);
         }
@@ -61,4 +76,18 @@ namespace std
         if (--init_cnt_ == 0)
             cout.flush();
     }
+
+    bool ios_base::sync_with_stdio(bool sync)
+    {
+        auto old = sync_;
+        sync_ = sync;
+
+        if (old != sync && aux::stdout_buf)
+        {
+            aux::stdin_buf->sync_with_stdio(sync);
+            aux::stdout_buf->sync_with_stdio(sync);
+        }
+
+        return old;
+    }
 }
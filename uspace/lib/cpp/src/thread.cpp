@@ -31,6 +31,13 @@
 #include <thread>
 #include <utility>
 
+namespace std::hel
+{
+    extern "C" {
+        #include <stats.h>
+    }
+}
+
 namespace std
 {
     thread::thread() noexcept
@@ -39,17 +46,11 @@ namespace std
 
     thread::~thread()
     {
-        // TODO: investigate joinable() in detail
-        //       + std::terminate behaves weirdly on HelenOS
-        if (joinable() && false)
+        if (joinable())
             std::terminate();
 
-        // TODO: check for finished too?
-        // TODO: WAIT! if it's not detached, then
-        //       we are joinable and std::terminate was called?
-        // TODO: review this entire thing
-        if (joinable_wrapper_ && !joinable_wrapper_->detached())
-            delete joinable_wrapper_;
+        // The thread has already been joined.
+        delete joinable_wrapper_;
     }
 
     thread::thread(thread&& other) noexcept
@@ -64,6 +65,9 @@ namespace std
         if (joinable())
             std::terminate();
 
+        // The previous thread has already been joined.
+        delete joinable_wrapper_;
+
         id_ = other.id_;
         other.id_ = aux::thread_t{};
 
@@ -87,7 +91,10 @@ namespace std
     void thread::join()
     {
         if (joinable() && joinable_wrapper_)
+        {
             joinable_wrapper_->join();
+            id_ = aux::thread_t{};
+        }
     }
 
     void thread::detach()
@@ -96,7 +103,8 @@ namespace std
 
         if (joinable_wrapper_)
         {
-            joinable_wrapper_->detach();
+            if (joinable_wrapper_->detach())
+                delete joinable_wrapper_;
             joinable_wrapper_ = nullptr;
         }
     }
@@ -118,8 +126,20 @@ namespace std
 
     unsigned thread::hardware_concurrency() noexcept
     {
-        // TODO:
-        return 0;
+        static unsigned int cpus{};
+
+        if (cpus == 0)
+        {
+            size_t count{};
+            auto stats = hel::stats_get_cpus(&count);
+            if (stats)
+                std::free(stats);
+
+            // Relaxed, any thread gets the same result.
+            __atomic_store_n(&cpus, static_cast<unsigned int>(count), __ATOMIC_RELAXED);
+        }
+
+        return cpus;
     }
 
     void swap(thread& x, thread& y) noexcept
@@ -0,0 +1,663 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file aes_modes.c
+ *
+ * AES modes of operation on whole buffers.
+ *
+ * CBC and CTR are based on NIST SP 800-38A, CCM on NIST SP 800-38C
+ * (RFC 3610) and GCM on NIST SP 800-38D.
+ */
+
+#include <stdbool.h>
+#include <errno.h>
+#include <macros.h>
+#include <mem.h>
+#include "crypto.h"
+#include "aes_private.h"
+
+/** Minimal length of the authentication tag. */
+#define MIN_TAG_LENGTH  4
+
+/** XOR a block into another block.
+ *
+ * @param dest Block to be modified.
+ * @param src  Block to be applied.
+ * @param len  Number of bytes.
+ *
+ */
+static inline void xor_block(uint8_t *dest, const uint8_t *src, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+		dest[i] ^= src[i];
+}
+
+/** Compare authentication tags in constant time.
+ *
+ * @param a   First tag.
+ * @param b   Second tag.
+ * @param len Length of the tags.
+ *
+ * @return True if the tags are equal.
+ *
+ */
+static bool tag_equal(const uint8_t *a, const uint8_t *b, size_t len)
+{
+	uint8_t diff = 0;
+
+	for (size_t i = 0; i < len; i++)
+		diff |= a[i] ^ b[i];
+
+	return (diff == 0);
+}
+
+/** AES encryption in cipher block chaining mode.
+ *
+ * @param ctx    AES context.
+ * @param iv     Initialization vector, updated to allow chaining of
+ *               subsequent calls.
+ * @param input  Input data.
+ * @param output Output data (may be the same as input).
+ * @param len    Length of the data (multiple of AES_BLOCK_LENGTH).
+ *
+ * @return EINVAL when the length is not a multiple of the block length,
+ *         otherwise EOK.
+ *
+ */
+errno_t aes_cbc_encrypt(const aes_context_t *ctx, uint8_t *iv,
+    const uint8_t *input, uint8_t *output, size_t len)
+{
+	if ((len % AES_BLOCK_LENGTH) != 0)
+		return EINVAL;
+
+	for (size_t pos = 0; pos < len; pos += AES_BLOCK_LENGTH) {
+		xor_block(iv, input + pos, AES_BLOCK_LENGTH);
+		aes_encrypt_block(ctx, iv, iv);
+		memcpy(output + pos, iv, AES_BLOCK_LENGTH);
+	}
+
+	return EOK;
+}
+
+/** AES decryption in cipher block chaining mode.
+ *
+ * @param ctx    AES context.
+ * @param iv     Initialization vector, updated to allow chaining of
+ *               subsequent calls.
+ * @param input  Input data.
+ * @param output Output data (may be the same as input).
+ * @param len    Length of the data (multiple of AES_BLOCK_LENGTH).
+ *
+ * @return EINVAL when the length is not a multiple of the block length,
+ *         otherwise EOK.
+ *
+ */
+errno_t aes_cbc_decrypt(const aes_context_t *ctx, uint8_t *iv,
+    const uint8_t *input, uint8_t *output, size_t len)
+{
+	if ((len % AES_BLOCK_LENGTH) != 0)
+		return EINVAL;
+
+#ifdef AES_NI
+	if (ctx->accel) {
+		aes_ni_cbc_decrypt(ctx, iv, input, output,
+		    len / AES_BLOCK_LENGTH);
+		return EOK;
+	}
+#endif
+
+	uint8_t block[AES_BLOCK_LENGTH];
+
+	for (size_t pos = 0; pos < len; pos += AES_BLOCK_LENGTH) {
+		memcpy(block, input + pos, AES_BLOCK_LENGTH);
+		aes_decrypt_block(ctx, block, output + pos);
+		xor_block(output + pos, iv, AES_BLOCK_LENGTH);
+		memcpy(iv, block, AES_BLOCK_LENGTH);
+	}
+
+	return EOK;
+}
+
+/** AES encryption or decryption in counter mode.
+ *
+ * The counter block is incremented (as a big-endian 128-bit number)
+ * for every block of data, including a final partial block.
+ *
+ * @param ctx     AES context.
+ * @param counter Initial counter block, updated to allow chaining of
+ *                subsequent calls.
+ * @param input   Input data.
+ * @param output  Output data (may be the same as input).
+ * @param len     Length of the data.
+ *
+ */
+void aes_ctr_crypt(const aes_context_t *ctx, uint8_t *counter,
+    const uint8_t *input, uint8_t *output, size_t len)
+{
+	uint8_t stream[AES_BLOCK_LENGTH];
+	size_t blocks = len / AES_BLOCK_LENGTH;
+	size_t pos = 0;
+
+#ifdef AES_NI
+	if (ctx->accel) {
+		aes_ni_ctr(ctx, counter, input, output, blocks);
+		pos = blocks * AES_BLOCK_LENGTH;
+	}
+#endif
+
+	for (; pos < len; pos += AES_BLOCK_LENGTH) {
+		size_t cnt = min(len - pos, (size_t) AES_BLOCK_LENGTH);
+
+		aes_encrypt_block(ctx, counter, stream);
+		aes_counter_increment(counter);
+
+		if (output != input)
+			memcpy(output + pos, input + pos, cnt);
+
+		xor_block(output + pos, stream, cnt);
+	}
+}
+
+/** Process data in the CBC-MAC of CCM.
+ *
+ * @param ctx AES context.
+ * @param mac CBC-MAC state.
+ * @param data Data.
+ * @param len  Length of the data (padded with zeros to whole blocks).
+ *
+ */
+static void ccm_mac(const aes_context_t *ctx, uint8_t *mac,
+    const uint8_t *data, size_t len)
+{
+	for (size_t pos = 0; pos < len; pos += AES_BLOCK_LENGTH) {
+		xor_block(mac, data + pos, min(len - pos,
+		    (size_t) AES_BLOCK_LENGTH));
+		aes_encrypt_block(ctx, mac, mac);
+	}
+}
+
+/** Compute CCM authentication tag and the first counter block.
+ *
+ * @param ctx       AES context.
+ * @param nonce     Nonce.
+ * @param nonce_len Length of the nonce.
+ * @param aad       Additional authenticated data.
+ * @param aad_len   Length of the additional authenticated data.
+ * @param plain     Plain text.
+ * @param len       Length of the plain text.
+ * @param tag       Place to store the tag.
+ * @param tag_len   Length of the tag.
+ * @param counter   Place to store the counter block of the first
+ *                  data block.
+ *
+ * @return EINVAL when the parameters are out of range, otherwise EOK.
+ *
+ */
+static errno_t ccm_tag(const aes_context_t *ctx, const uint8_t *nonce,
+    size_t nonce_len, const uint8_t *aad, size_t aad_len,
+    const uint8_t *plain, size_t len, uint8_t *tag, size_t tag_len,
+    uint8_t *counter)
+{
+	if ((nonce_len < 7) || (nonce_len > 13))
+		return EINVAL;
+
+	if ((tag_len < MIN_TAG_LENGTH) || (tag_len > AES_BLOCK_LENGTH) ||
+	    ((tag_len % 2) != 0))
+		return EINVAL;
+
+	/* Number of bytes of the length field. */
+	size_t q = AES_BLOCK_LENGTH - 1 - nonce_len;
+	if ((q < sizeof(size_t)) && ((len >> (8 * q)) != 0))
+		return EINVAL;
+
+	if ((uint64_t) aad_len > UINT32_MAX)
+		return EINVAL;
+
+	/* First block carries the flags, the nonce and the length. */
+	uint8_t mac[AES_BLOCK_LENGTH];
+	mac[0] = ((aad_len > 0) ? 0x40 : 0) | (((tag_len - 2) / 2) << 3) |
+	    (q - 1);
+	memcpy(mac + 1, nonce, nonce_len);
+
+	size_t val = len;
+	for (size_t i = 0; i < q; i++) {
+		mac[AES_BLOCK_LENGTH - 1 - i] = val & 0xff;
+		val = (i < sizeof(size_t) - 1) ? val >> 8 : 0;
+	}
+
+	aes_encrypt_block(ctx, mac, mac);
+
+	if (aad_len > 0) {
+		/* Encoded length of the data followed by the data. */
+		uint8_t block[AES_BLOCK_LENGTH];
+		size_t hdr;
+
+		memset(block, 0, AES_BLOCK_LENGTH);
+
+		if (aad_len < 0xff00) {
+			block[0] = aad_len >> 8;
+			block[1] = aad_len & 0xff;
+			hdr = 2;
+		} else {
+			block[0] = 0xff;
+			block[1] = 0xfe;
+			block[2] = (aad_len >> 24) & 0xff;
+			block[3] = (aad_len >> 16) & 0xff;
+			block[4] = (aad_len >> 8) & 0xff;
+			block[5] = aad_len & 0xff;
+			hdr = 6;
+		}
+
+		size_t cnt = min(aad_len, AES_BLOCK_LENGTH - hdr);
+		memcpy(block + hdr, aad, cnt);
+		ccm_mac(ctx, mac, block, AES_BLOCK_LENGTH);
+		ccm_mac(ctx, mac, aad + cnt, aad_len - cnt);
+	}
+
+	ccm_mac(ctx, mac, plain, len);
+
+	/* Counter block zero encrypts the tag. */
+	counter[0] = q - 1;
+	memcpy(counter + 1, nonce, nonce_len);
+	memset(counter + 1 + nonce_len, 0, q);
+
+	uint8_t stream[AES_BLOCK_LENGTH];
+	aes_encrypt_block(ctx, counter, stream);
+	xor_block(mac, stream, tag_len);
+	memcpy(tag, mac, tag_len);
+
+	aes_counter_increment(counter);
+	return EOK;
+}
+
+/** AES authenticated encryption in CCM mode.
+ *
+ * @param ctx       AES context.
+ * @param nonce     Nonce.
+ * @param nonce_len Length of the nonce (7 to 13 bytes).
+ * @param aad       Additional authenticated data.
+ * @param aad_len   Length of the additional authenticated data.
+ * @param input     Plain text.
+ * @param output    Cipher text (may be the same as input).
+ * @param len       Length of the data.
+ * @param tag       Place to store the authentication tag.
+ * @param tag_len   Length of the tag (even, 4 to 16 bytes).
+ *
+ * @return EINVAL when the parameters are out of range, otherwise EOK.
+ *
+ */
+errno_t aes_ccm_encrypt(const aes_context_t *ctx, const uint8_t *nonce,
+    size_t nonce_len, const uint8_t *aad, size_t aad_len,
+    const uint8_t *input, uint8_t *output, size_t len, uint8_t *tag,
+    size_t tag_len)
+{
+	uint8_t counter[AES_BLOCK_LENGTH];
+
+	errno_t rc = ccm_tag(ctx, nonce, nonce_len, aad, aad_len, input, len,
+	    tag, tag_len, counter);
+	if (rc != EOK)
+		return rc;
+
+	aes_ctr_crypt(ctx, counter, input, output, len);
+	return EOK;
+}
+
+/** AES authenticated decryption in CCM mode.
+ *
+ * @param ctx       AES context.
+ * @param nonce     Nonce.
+ * @param nonce_len Length of the nonce (7 to 13 bytes).
+ * @param aad       Additional authenticated data.
+ * @param aad_len   Length of the additional authenticated data.
+ * @param input     Cipher text.
+ * @param output    Plain text (may be the same as input).
+ * @param len       Length of the data.
+ * @param tag       Authentication tag.
+ * @param tag_len   Length of the tag (even, 4 to 16 bytes).
+ *
+ * @return EINVAL when the parameters are out of range,
+ *         EBADCHECKSUM when the authentication fails (the output
+ *         is cleared), otherwise EOK.
+ *
+ */
+errno_t aes_ccm_decrypt(const aes_context_t *ctx, const uint8_t *nonce,
+    size_t nonce_len, const uint8_t *aad, size_t aad_len,
+    const uint8_t *input, uint8_t *output, size_t len, const uint8_t *tag,
+    size_t tag_len)
+{
+	uint8_t counter[AES_BLOCK_LENGTH];
+	uint8_t computed[AES_BLOCK_LENGTH];
+
+	if ((nonce_len < 7) || (nonce_len > 13))
+		return EINVAL;
+
+	/* Decrypt first, the tag is computed from the plain text. */
+	counter[0] = AES_BLOCK_LENGTH - 2 - nonce_len;
+	memcpy(counter + 1, nonce, nonce_len);
+	memset(counter + 1 + nonce_len, 0, AES_BLOCK_LENGTH - 1 - nonce_len);
+	aes_counter_increment(counter);
+
+	aes_ctr_crypt(ctx, counter, input, output, len);
+
+	errno_t rc = ccm_tag(ctx, nonce, nonce_len, aad, aad_len, output, len,
+	    computed, tag_len, counter);
+	if ((rc == EOK) && (!tag_equal(computed, tag, tag_len)))
+		rc = EBADCHECKSUM;
+
+	if (rc != EOK)
+		memset(output, 0, len);
+
+	return rc;
+}
+
+/** GHASH multiplication tables for the hash key.
+ *
+ * Multiples of the hash key by all 4-bit values.
+ *
+ */
+typedef struct {
+	uint64_t hl[16];
+	uint64_t hh[16];
+} gcm_table_t;
+
+/** Reduction of the bits shifted out by 4 bits (upper 16 bits). */
+static const uint16_t gcm_last4[16] = {
+	0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+	0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+/** Load big-endian 64-bit value. */
+static inline uint64_t load_be64(const uint8_t *bytes)
+{
+	uint64_t val = 0;
+
+	for (size_t i = 0; i < 8; i++)
+		val = (val << 8) | bytes[i];
+
+	return val;
+}
+
+/** Store big-endian 64-bit value. */
+static inline void store_be64(uint8_t *bytes, uint64_t val)
+{
+	for (size_t i = 0; i < 8; i++)
+		bytes[i] = val >> (56 - 8 * i);
+}
+
+/** Compute GHASH multiplication tables.
+ *
+ * @param table Tables to compute.
+ * @param h     Hash key.
+ *
+ */
+static void gcm_table_init(gcm_table_t *table, const uint8_t *h)
+{
+	uint64_t vh = load_be64(h);
+	uint64_t vl = load_be64(h + 8);
+
+	/* Bit-reflected field: index 8 is the key itself, 4, 2, 1 halves */
+	table->hl[0] = 0;
+	table->hh[0] = 0;
+	table->hl[8] = vl;
+	table->hh[8] = vh;
+
+	for (size_t i = 4; i > 0; i >>= 1) {
+		uint64_t reduce = (vl & 1) ? UINT64_C(0xe100000000000000) : 0;
+
+		vl = (vh << 63) | (vl >> 1);
+		vh = (vh >> 1) ^ reduce;
+
+		table->hl[i] = vl;
+		table->hh[i] = vh;
+	}
+
+	/* The other entries are sums of the powers */
+	for (size_t i = 2; i <= 8; i *= 2) {
+		for (size_t j = 1; j < i; j++) {
+			table->hh[i + j] = table->hh[i] ^ table->hh[j];
+			table->hl[i + j] = table->hl[i] ^ table->hl[j];
+		}
+	}
+}
+
+/** Multiply a block by the hash key in GF(2^128).
+ *
+ * @param table Multiplication tables.
+ * @param x     Block to multiply (replaced by the result).
+ *
+ */
+static void gcm_mult(const gcm_table_t *table, uint8_t *x)
+{
+	uint8_t nibble = x[15] & 0x0f;
+	uint64_t zh = table->hh[nibble];
+	uint64_t zl = table->hl[nibble];
+	uint8_t rem;
+
+	for (int i = 15; i >= 0; i--) {
+		uint8_t lo = x[i] & 0x0f;
+		uint8_t hi = x[i] >> 4;
+
+		if (i != 15) {
+			rem = zl & 0x0f;
+			zl = (zh << 60) | (zl >> 4);
+			zh = (zh >> 4) ^ ((uint64_t) gcm_last4[rem] << 48);
+			zh ^= table->hh[lo];
+			zl ^= table->hl[lo];
+		}
+
+		rem = zl & 0x0f;
+		zl = (zh << 60) | (zl >> 4);
+		zh = (zh >> 4) ^ ((uint64_t) gcm_last4[rem] << 48);
+		zh ^= table->hh[hi];
+		zl ^= table->hl[hi];
+	}
+
+	store_be64(x, zh);
+	store_be64(x + 8, zl);
+}
+
+/** Process data in GHASH.
+ *
+ * @param table Multiplication tables.
+ * @param hash  GHASH state.
+ * @param data  Data.
+ * @param len   Length of the data (padded with zeros to whole blocks).
+ *
+ */
+static void gcm_hash(const gcm_table_t *table, uint8_t *hash,
+    const uint8_t *data, size_t len)
+{
+	for (size_t pos = 0; pos < len; pos += AES_BLOCK_LENGTH) {
+		xor_block(hash, data + pos, min(len - pos,
+		    (size_t) AES_BLOCK_LENGTH));
+		gcm_mult(table, hash);
+	}
+}
+
+/** Prepare GCM processing.
+ *
+ * @param ctx     AES context.
+ * @param iv      Initialization vector.
+ * @param iv_len  Length of the initialization vector.
+ * @param aad     Additional authenticated data.
+ * @param aad_len Length of the additional authenticated data.
+ * @param table   Place to store the GHASH multiplication tables.
+ * @param hash    Place to store the GHASH state.
+ * @param j0      Place to store the pre-counter block.
+ *
+ */
+static void gcm_start(const aes_context_t *ctx, const uint8_t *iv,
+    size_t iv_len, const uint8_t *aad, size_t aad_len, gcm_table_t *table,
+    uint8_t *hash, uint8_t *j0)
+{
+	uint8_t h[AES_BLOCK_LENGTH];
+
+	memset(h, 0, AES_BLOCK_LENGTH);
+	aes_encrypt_block(ctx, h, h);
+	gcm_table_init(table, h);
+
+	memset(j0, 0, AES_BLOCK_LENGTH);
+
+	if (iv_len == 12) {
+		memcpy(j0, iv, iv_len);
+		j0[AES_BLOCK_LENGTH - 1] = 1;
+	} else {
+		uint8_t lens[AES_BLOCK_LENGTH];
+
+		memset(lens, 0, AES_BLOCK_LENGTH);
+		store_be64(lens + 8, (uint64_t) iv_len * 8);
+
+		gcm_hash(table, j0, iv, iv_len);
+		gcm_hash(table, j0, lens, AES_BLOCK_LENGTH);
+	}
+
+	memset(hash, 0, AES_BLOCK_LENGTH);
+	gcm_hash(table, hash, aad, aad_len);
+}
+
+/** Finish GCM authentication tag.
+ *
+ * @param ctx     AES context.
+ * @param table   GHASH multiplication tables.
+ * @param hash    GHASH state.
+ * @param j0      Pre-counter block.
+ * @param aad_len Length of the additional authenticated data.
+ * @param len     Length of the data.
+ * @param tag     Place to store the tag.
+ * @param tag_len Length of the tag.
+ *
+ */
+static void gcm_finish(const aes_context_t *ctx, const gcm_table_t *table,
+    uint8_t *hash, const uint8_t *j0, size_t aad_len, size_t len,
+    uint8_t *tag, size_t tag_len)
+{
+	uint8_t lens[AES_BLOCK_LENGTH];
+
+	store_be64(lens, (uint64_t) aad_len * 8);
+	store_be64(lens + 8, (uint64_t) len * 8);
+	gcm_hash(table, hash, lens, AES_BLOCK_LENGTH);
+
+	uint8_t stream[AES_BLOCK_LENGTH];
+	aes_encrypt_block(ctx, j0, stream);
+	xor_block(hash, stream, tag_len);
+	memcpy(tag, hash, tag_len);
+}
+
+/** AES authenticated encryption in GCM mode.
+ *
+ * @param ctx     AES context.
+ * @param iv      Initialization vector.
+ * @param iv_len  Length of the initialization vector (12 bytes
+ *                recommended).
+ * @param aad     Additional authenticated data.
+ * @param aad_len Length of the additional authenticated data.
+ * @param input   Plain text.
+ * @param output  Cipher text (may be the same as input).
+ * @param len     Length of the data.
+ * @param tag     Place to store the authentication tag.
+ * @param tag_len Length of the tag (4 to 16 bytes).
+ *
+ * @return EINVAL when the parameters are out of range, otherwise EOK.
+ *
+ */
+errno_t aes_gcm_encrypt(const aes_context_t *ctx, const uint8_t *iv,
+    size_t iv_len, const uint8_t *aad, size_t aad_len,
+    const uint8_t *input, uint8_t *output, size_t len, uint8_t *tag,
+    size_t tag_len)
+{
+	if ((iv_len == 0) || (tag_len < MIN_TAG_LENGTH) ||
+	    (tag_len > AES_BLOCK_LENGTH))
+		return EINVAL;
+
+	gcm_table_t table;
+	uint8_t hash[AES_BLOCK_LENGTH];
+	uint8_t j0[AES_BLOCK_LENGTH];
+	uint8_t counter[AES_BLOCK_LENGTH];
+
+	gcm_start(ctx, iv, iv_len, aad, aad_len, &table, hash, j0);
+
+	memcpy(counter, j0, AES_BLOCK_LENGTH);
+	aes_counter_increment(counter);
+	aes_ctr_crypt(ctx, counter, input, output, len);
+
+	gcm_hash(&table, hash, output, len);
+	gcm_finish(ctx, &table, hash, j0, aad_len, len, tag, tag_len);
+
+	return EOK;
+}
+
+/** AES authenticated decryption in GCM mode.
+ *
+ * @param ctx     AES context.
+ * @param iv      Initialization vector.
+ * @param iv_len  Length of the initialization vector.
+ * @param aad     Additional authenticated data.
+ * @param aad_len Length of the additional authenticated data.
+ * @param input   Cipher text.
+ * @param output  Plain text (may be the same as input).
+ * @param len     Length of the data.
+ * @param tag     Authentication tag.
+ * @param tag_len Length of the tag (4 to 16 bytes).
+ *
+ * @return EINVAL when the parameters are out of range,
+ *         EBADCHECKSUM when the authentication fails (the output
+ *         is cleared), otherwise EOK.
+ *
+ */
+errno_t aes_gcm_decrypt(const aes_context_t *ctx, const uint8_t *iv,
+    size_t iv_len, const uint8_t *aad, size_t aad_len,
+    const uint8_t *input, uint8_t *output, size_t len, const uint8_t *tag,
+    size_t tag_len)
+{
+	if ((iv_len == 0) || (tag_len < MIN_TAG_LENGTH) ||
+	    (tag_len > AES_BLOCK_LENGTH))
+		return EINVAL;
+
+	gcm_table_t table;
+	uint8_t hash[AES_BLOCK_LENGTH];
+	uint8_t j0[AES_BLOCK_LENGTH];
+	uint8_t counter[AES_BLOCK_LENGTH];
+	uint8_t computed[AES_BLOCK_LENGTH];
+
+	gcm_start(ctx, iv, iv_len, aad, aad_len, &table, hash, j0);
+
+	/* The tag is computed from the cipher text. */
+	gcm_hash(&table, hash, input, len);
+	gcm_finish(ctx, &table, hash, j0, aad_len, len, computed, tag_len);
+
+	if (!tag_equal(computed, tag, tag_len)) {
+		memset(output, 0, len);
+		return EBADCHECKSUM;
+	}
+
+	memcpy(counter, j0, AES_BLOCK_LENGTH);
+	aes_counter_increment(counter);
+	aes_ctr_crypt(ctx, counter, input, output, len);
+
+	return EOK;
+}
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file aes_ni.c
+ *
+ * AES implementation using the x86 AES instruction set.
+ *
+ * The functions are compiled for the AES instruction set regardless
+ * of the target processor and they are only called if the processor
+ * supports the instructions.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <mem.h>
+#include "crypto.h"
+#include "aes_private.h"
+
+#ifdef AES_NI
+
+#include <cpuid.h>
+#include <wmmintrin.h>
+
+#define AES_NI_TARGET  __attribute__((target("sse2,aes")))
+
+/** Number of blocks processed in parallel. */
+#define PARALLEL_BLOCKS  4
+
+/** Processor support state (0 unknown, 1 supported, -1 unsupported). */
+static int aes_ni_state = 0;
+
+/** Check whether the processor supports the AES instruction set.
+ *
+ * @return True if the instructions are supported.
+ *
+ */
+bool aes_ni_supported(void)
+{
+	if (aes_ni_state == 0) {
+		unsigned int eax, ebx, ecx, edx;
+
+		if ((__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0) &&
+		    ((ecx & bit_AES) != 0) && ((edx & bit_SSE2) != 0))
+			aes_ni_state = 1;
+		else
+			aes_ni_state = -1;
+	}
+
+	return (aes_ni_state > 0);
+}
+
+/** Convert round keys to the byte order used by the instructions.
+ *
+ * @param keys  Round keys.
+ * @param words Number of words.
+ *
+ */
+static void aes_ni_convert(uint32_t *keys, size_t words)
+{
+	for (size_t i = 0; i < words; i++) {
+		uint32_t word = keys[i];
+		uint8_t *bytes = (uint8_t *) &keys[i];
+
+		bytes[0] = word >> 24;
+		bytes[1] = word >> 16;
+		bytes[2] = word >> 8;
+		bytes[3] = word;
+	}
+}
+
+/** Prepare the context for the instructions.
+ *
+ * The round keys of the equivalent inverse cipher computed by
+ * the key expansion are the round keys expected by AESDEC.
+ *
+ * @param ctx AES context with expanded key.
+ *
+ */
+void aes_ni_setup(aes_context_t *ctx)
+{
+	size_t words = 4 * (ctx->rounds + 1);
+
+	aes_ni_convert(ctx->enc_key, words);
+	aes_ni_convert(ctx->dec_key, words);
+}
+
+/** Load round keys.
+ *
+ * @param keys   Round keys.
+ * @param rounds Number of rounds.
+ * @param rk     Array of the loaded round keys.
+ *
+ */
+AES_NI_TARGET static inline void aes_ni_load_keys(const uint32_t *keys,
+    unsigned int rounds, __m128i *rk)
+{
+	for (unsigned int k = 0; k <= rounds; k++)
+		rk[k] = _mm_loadu_si128((const __m128i *) (keys + 4 * k));
+}
+
+/** Encrypt a single block.
+ *
+ * @param ctx    AES context.
+ * @param input  Input block.
+ * @param output Output block.
+ *
+ */
+AES_NI_TARGET void aes_ni_encrypt_block(const aes_context_t *ctx,
+    const uint8_t *input, uint8_t *output)
+{
+	const __m128i *rk = (const __m128i *) ctx->enc_key;
+	__m128i state = _mm_loadu_si128((const __m128i *) input);
+
+	state = _mm_xor_si128(state, _mm_loadu_si128(rk));
+	for (unsigned int k = 1; k < ctx->rounds; k++)
+		state = _mm_aesenc_si128(state, _mm_loadu_si128(rk + k));
+
+	state = _mm_aesenclast_si128(state, _mm_loadu_si128(rk + ctx->rounds));
+	_mm_storeu_si128((__m128i *) output, state);
+}
+
+/** Decrypt a single block.
+ *
+ * @param ctx    AES context.
+ * @param input  Input block.
+ * @param output Output block.
+ *
+ */
+AES_NI_TARGET void aes_ni_decrypt_block(const aes_context_t *ctx,
+    const uint8_t *input, uint8_t *output)
+{
+	const __m128i *rk = (const __m128i *) ctx->dec_key;
+	__m128i state = _mm_loadu_si128((const __m128i *) input);
+
+	state = _mm_xor_si128(state, _mm_loadu_si128(rk));
+	for (unsigned int k = 1; k < ctx->rounds; k++)
+		state = _mm_aesdec_si128(state, _mm_loadu_si128(rk + k));
+
+	state = _mm_aesdeclast_si128(state, _mm_loadu_si128(rk + ctx->rounds));
+	_mm_storeu_si128((__m128i *) output, state);
+}
+
+/** Encrypt or decrypt whole blocks in counter mode.
+ *
+ * @param ctx     AES context.
+ * @param counter Counter block, incremented for every block.
+ * @param input   Input data.
+ * @param output  Output data.
+ * @param blocks  Number of blocks.
+ *
+ */
+AES_NI_TARGET void aes_ni_ctr(const aes_context_t *ctx, uint8_t *counter,
+    const uint8_t *input, uint8_t *output, size_t blocks)
+{
+	__m128i rk[AES_MAX_ROUNDS + 1];
+	aes_ni_load_keys(ctx->enc_key, ctx->rounds, rk);
+
+	while (blocks >= PARALLEL_BLOCKS) {
+		__m128i state[PARALLEL_BLOCKS];
+
+		/* Independent blocks keep the pipelined units busy. */
+		for (size_t i = 0; i < PARALLEL_BLOCKS; i++) {
+			state[i] = _mm_xor_si128(
+			    _mm_loadu_si128((const __m128i *) counter), rk[0]);
+			aes_counter_increment(counter);
+		}
+
+		for (unsigned int k = 1; k < ctx->rounds; k++) {
+			for (size_t i = 0; i < PARALLEL_BLOCKS; i++)
+				state[i] = _mm_aesenc_si128(state[i], rk[k]);
+		}
+
+		for (size_t i = 0; i < PARALLEL_BLOCKS; i++) {
+			state[i] = _mm_aesenclast_si128(state[i], rk[ctx->rounds]);
+			state[i] = _mm_xor_si128(state[i],
+			    _mm_loadu_si128((const __m128i *) input + i));
+			_mm_storeu_si128((__m128i *) output + i, state[i]);
+		}
+
+		input += PARALLEL_BLOCKS * AES_BLOCK_LENGTH;
+		output += PARALLEL_BLOCKS * AES_BLOCK_LENGTH;
+		blocks -= PARALLEL_BLOCKS;
+	}
+
+	while (blocks > 0) {
+		__m128i state = _mm_xor_si128(
+		    _mm_loadu_si128((const __m128i *) counter), rk[0]);
+		aes_counter_increment(counter);
+
+		for (unsigned int k = 1; k < ctx->rounds; k++)
+			state = _mm_aesenc_si128(state, rk[k]);
+
+		state = _mm_aesenclast_si128(state, rk[ctx->rounds]);
+		state = _mm_xor_si128(state,
+		    _mm_loadu_si128((const __m128i *) input));
+		_mm_storeu_si128((__m128i *) output, state);
+
+		input += AES_BLOCK_LENGTH;
+		output += AES_BLOCK_LENGTH;
+		blocks--;
+	}
+}
+
+/** Decrypt whole blocks in cipher block chaining mode.
+ *
+ * @param ctx    AES context.
+ * @param iv     Initialization vector, updated to the last input block.
+ * @param input  Input data.
+ * @param output Output data (may be the same as input).
+ * @param blocks Number of blocks.
+ *
+ */
+AES_NI_TARGET void aes_ni_cbc_decrypt(const aes_context_t *ctx, uint8_t *iv,
+    const uint8_t *input, uint8_t *output, size_t blocks)
+{
+	__m128i rk[AES_MAX_ROUNDS + 1];
+	aes_ni_load_keys(ctx->dec_key, ctx->rounds, rk);
+
+	__m128i prev = _mm_loadu_si128((const __m128i *) iv);
+
+	while (blocks >= PARALLEL_BLOCKS) {
+		__m128i cipher[PARALLEL_BLOCKS];
+		__m128i state[PARALLEL_BLOCKS];
+
+		for (size_t i = 0; i < PARALLEL_BLOCKS; i++) {
+			cipher[i] = _mm_loadu_si128((const __m128i *) input + i);
+			state[i] = _mm_xor_si128(cipher[i], rk[0]);
+		}
+
+		for (unsigned int k = 1; k < ctx->rounds; k++) {
+			for (size_t i = 0; i < PARALLEL_BLOCKS; i++)
+				state[i] = _mm_aesdec_si128(state[i], rk[k]);
+		}
+
+		for (size_t i = 0; i < PARALLEL_BLOCKS; i++) {
+			state[i] = _mm_aesdeclast_si128(state[i], rk[ctx->rounds]);
+			state[i] = _mm_xor_si128(state[i], prev);
+			prev = cipher[i];
+			_mm_storeu_si128((__m128i *) output + i, state[i]);
+		}
+
+		input += PARALLEL_BLOCKS * AES_BLOCK_LENGTH;
+		output += PARALLEL_BLOCKS * AES_BLOCK_LENGTH;
+		blocks -= PARALLEL_BLOCKS;
+	}
+
+	while (blocks > 0) {
+		__m128i cipher = _mm_loadu_si128((const __m128i *) input);
+		__m128i state = _mm_xor_si128(cipher, rk[0]);
+
+		for (unsigned int k = 1; k < ctx->rounds; k++)
+			state = _mm_aesdec_si128(state, rk[k]);
+
+		state = _mm_aesdeclast_si128(state, rk[ctx->rounds]);
+		state = _mm_xor_si128(state, prev);
+		prev = cipher;
+		_mm_storeu_si128((__m128i *) output, state);
+
+		input += AES_BLOCK_LENGTH;
+		output += AES_BLOCK_LENGTH;
+		blocks--;
+	}
+
+	_mm_storeu_si128((__m128i *) iv, prev);
+}
+
+#endif
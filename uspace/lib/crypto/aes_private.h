@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file aes_private.h
+ *
+ * Internal interface between the AES implementations and the modes
+ * of operation.
+ */
+
+#ifndef LIBCRYPTO_AES_PRIVATE_H
+#define LIBCRYPTO_AES_PRIVATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "crypto.h"
+
+#if defined(__i386__) || defined(__x86_64__)
+#define AES_NI
+#endif
+
+/** Increment big-endian 128-bit counter block.
+ *
+ * @param counter Counter block.
+ *
+ */
+static inline void aes_counter_increment(uint8_t *counter)
+{
+	for (int i = AES_BLOCK_LENGTH - 1; i >= 0; i--) {
+		if (++counter[i] != 0)
+			break;
+	}
+}
+
+#ifdef AES_NI
+
+extern bool aes_ni_supported(void);
+extern void aes_ni_setup(aes_context_t *);
+extern void aes_ni_encrypt_block(const aes_context_t *, const uint8_t *,
+    uint8_t *);
+extern void aes_ni_decrypt_block(const aes_context_t *, const uint8_t *,
+    uint8_t *);
+extern void aes_ni_ctr(const aes_context_t *, uint8_t *, const uint8_t *,
+    uint8_t *, size_t);
+extern void aes_ni_cbc_decrypt(const aes_context_t *, uint8_t *,
+    const uint8_t *, uint8_t *, size_t);
+
+#endif
+
+#endif
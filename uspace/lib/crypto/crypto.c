@@ -36,149 +36,243 @@
 #include <errno.h>
 #include <byteorder.h>
 #include "crypto.h"
-
-/** Hash function procedure definition. */
-typedef void (*hash_fnc_t)(uint32_t *, uint32_t *);
-
-/** Length of HMAC block. */
-#define HMAC_BLOCK_LENGTH  64
-
-/** Ceiling for uint32_t. */
-#define ceil_uint32(val) \
-	(((val) - (uint32_t) (val)) > 0 ? \
-	(uint32_t) ((val) + 1) : (uint32_t) (val))
-
-/** Floor for uint32_t. */
-#define floor_uint32(val) \
-	(((val) - (uint32_t) (val)) < 0 ? \
-	(uint32_t) ((val) - 1) : (uint32_t) (val))
-
-/** Pick value at specified index from array or zero if out of bounds. */
-#define get_at(input, size, i) \
-	((i) < (size) ? (input[i]) : 0)
+#include "hash_private.h"
 
 /** Init values used in SHA1 and MD5 functions. */
-static const uint32_t hash_init[] = {
+static const uint32_t hash_init_md5_sha1[] = {
 	0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0
 };
 
-/** Shift amount array for MD5 algorithm. */
-static const uint32_t md5_shift[] = {
-	7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,
-	5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,
-	4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,
-	6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21
+/** Init values used in SHA-256 function. */
+static const uint32_t hash_init_sha256[] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
 };
 
-/** Substitution box for MD5 algorithm. */
-static const uint32_t md5_sbox[] = {
-	0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee,
-	0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
-	0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
-	0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
-	0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa,
-	0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
-	0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed,
-	0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
-	0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
-	0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
-	0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05,
-	0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
-	0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039,
-	0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
-	0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
-	0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+/** Init values used in SHA-512 function. */
+static const uint64_t hash_init_sha512[] = {
+	UINT64_C(0x6a09e667f3bcc908), UINT64_C(0xbb67ae8584caa73b),
+	UINT64_C(0x3c6ef372fe94f82b), UINT64_C(0xa54ff53a5f1d36f1),
+	UINT64_C(0x510e527fade682d1), UINT64_C(0x9b05688c2b3e6c1f),
+	UINT64_C(0x1f83d9abfb41bd6b), UINT64_C(0x5be0cd19137e2179),
 };
 
-/** Working procedure of MD5 cryptographic hash function.
+/** Get length of the input block of a hash function.
+ *
+ * @param hash_sel Hash function selector.
+ *
+ * @return Block length in bytes.
+ *
+ */
+static size_t hash_block_length(hash_func_t hash_sel)
+{
+	return (hash_sel == HASH_SHA512) ?
+	    HASH_BLOCK_LENGTH_512 : HASH_BLOCK_LENGTH;
+}
+
+/** Process whole blocks with the compression function of the context.
  *
- * @param h         Working array with interim hash parts values.
- * @param sched_arr Input array with scheduled values from input string.
+ * @param ctx    Hash context.
+ * @param data   Input blocks.
+ * @param blocks Number of blocks.
  *
  */
-static void md5_proc(uint32_t *h, uint32_t *sched_arr)
+static void hash_blocks(hash_ctx_t *ctx, const uint8_t *data, size_t blocks)
 {
-	uint32_t f, g, temp;
-	uint32_t w[HASH_MD5 / 4];
-
-	memcpy(w, h, (HASH_MD5 / 4) * sizeof(uint32_t));
-
-	for (size_t k = 0; k < 64; k++) {
-		if (k < 16) {
-			f = (w[1] & w[2]) | (~w[1] & w[3]);
-			g = k;
-		} else if ((k >= 16) && (k < 32)) {
-			f = (w[1] & w[3]) | (w[2] & ~w[3]);
-			g = (5 * k + 1) % 16;
-		} else if ((k >= 32) && (k < 48)) {
-			f = w[1] ^ w[2] ^ w[3];
-			g = (3 * k + 5) % 16;
-		} else {
-			f = w[2] ^ (w[1] | ~w[3]);
-			g = 7 * k % 16;
+	switch (ctx->func) {
+	case HASH_MD5:
+		md5_blocks(ctx->state.h32, data, blocks);
+		break;
+	case HASH_SHA1:
+#ifdef SHA_NI
+		if (ctx->accel) {
+			sha1_ni_blocks(ctx->state.h32, data, blocks);
+			break;
+		}
+#endif
+		sha1_blocks(ctx->state.h32, data, blocks);
+		break;
+	case HASH_SHA256:
+#ifdef SHA_NI
+		if (ctx->accel) {
+			sha256_ni_blocks(ctx->state.h32, data, blocks);
+			break;
 		}
+#endif
+		sha256_blocks(ctx->state.h32, data, blocks);
+		break;
+	case HASH_SHA512:
+		sha512_blocks(ctx->state.h64, data, blocks);
+		break;
+	}
+}
 
-		temp = w[3];
-		w[3] = w[2];
-		w[2] = w[1];
-		w[1] += rotl_uint32(w[0] + f + md5_sbox[k] +
-		    uint32_t_byteorder_swap(sched_arr[g]),
-		    md5_shift[k]);
-		w[0] = temp;
+/** Initialize hash context using only portable code.
+ *
+ * @param ctx      Hash context.
+ * @param hash_sel Hash function selector.
+ *
+ * @return EINVAL for unknown hash function, otherwise EOK.
+ *
+ */
+errno_t hash_init_generic(hash_ctx_t *ctx, hash_func_t hash_sel)
+{
+	switch (hash_sel) {
+	case HASH_MD5:
+	case HASH_SHA1:
+		memcpy(ctx->state.h32, hash_init_md5_sha1,
+		    sizeof(hash_init_md5_sha1));
+		break;
+	case HASH_SHA256:
+		memcpy(ctx->state.h32, hash_init_sha256,
+		    sizeof(hash_init_sha256));
+		break;
+	case HASH_SHA512:
+		memcpy(ctx->state.h64, hash_init_sha512,
+		    sizeof(hash_init_sha512));
+		break;
+	default:
+		return EINVAL;
 	}
 
-	for (uint8_t k = 0; k < HASH_MD5 / 4; k++)
-		h[k] += w[k];
+	ctx->func = hash_sel;
+	ctx->block_used = 0;
+	ctx->length = 0;
+	ctx->accel = false;
+
+	return EOK;
+}
+
+/** Initialize hash context.
+ *
+ * The fastest implementation supported by the processor is selected.
+ *
+ * @param ctx      Hash context.
+ * @param hash_sel Hash function selector.
+ *
+ * @return EINVAL for unknown hash function, otherwise EOK.
+ *
+ */
+errno_t hash_init(hash_ctx_t *ctx, hash_func_t hash_sel)
+{
+	errno_t rc = hash_init_generic(ctx, hash_sel);
+	if (rc != EOK)
+		return rc;
+
+#ifdef SHA_NI
+	if ((hash_sel == HASH_SHA1) || (hash_sel == HASH_SHA256))
+		ctx->accel = sha_ni_supported();
+#endif
+
+	return EOK;
 }
 
-/** Working procedure of SHA-1 cryptographic hash function.
+/** Add data to the hashed message.
  *
- * @param h         Working array with interim hash parts values.
- * @param sched_arr Input array with scheduled values from input string.
+ * Whole blocks are processed directly from the input buffer,
+ * only the trailing partial block is copied into the context.
+ *
+ * @param ctx  Hash context.
+ * @param data Input data.
+ * @param size Size of input data.
  *
  */
-static void sha1_proc(uint32_t *h, uint32_t *sched_arr)
+void hash_update(hash_ctx_t *ctx, const void *data, size_t size)
 {
-	uint32_t f, cf, temp;
-	uint32_t w[HASH_SHA1 / 4];
-
-	for (size_t k = 16; k < 80; k++) {
-		sched_arr[k] = rotl_uint32(
-		    sched_arr[k - 3] ^
-		    sched_arr[k - 8] ^
-		    sched_arr[k - 14] ^
-		    sched_arr[k - 16],
-		    1);
+	const uint8_t *input = data;
+	size_t block_len = hash_block_length(ctx->func);
+
+	ctx->length += size;
+
+	if (ctx->block_used > 0) {
+		size_t fill = min(block_len - ctx->block_used, size);
+
+		memcpy(ctx->block + ctx->block_used, input, fill);
+		ctx->block_used += fill;
+		input += fill;
+		size -= fill;
+
+		if (ctx->block_used < block_len)
+			return;
+
+		hash_blocks(ctx, ctx->block, 1);
+		ctx->block_used = 0;
 	}
 
-	memcpy(w, h, (HASH_SHA1 / 4) * sizeof(uint32_t));
-
-	for (size_t k = 0; k < 80; k++) {
-		if (k < 20) {
-			f = (w[1] & w[2]) | (~w[1] & w[3]);
-			cf = 0x5A827999;
-		} else if ((k >= 20) && (k < 40)) {
-			f = w[1] ^ w[2] ^ w[3];
-			cf = 0x6ed9eba1;
-		} else if ((k >= 40) && (k < 60)) {
-			f = (w[1] & w[2]) | (w[1] & w[3]) | (w[2] & w[3]);
-			cf = 0x8f1bbcdc;
-		} else {
-			f = w[1] ^ w[2] ^ w[3];
-			cf = 0xca62c1d6;
-		}
+	if (size >= block_len) {
+		size_t blocks = size / block_len;
+
+		hash_blocks(ctx, input, blocks);
+		input += blocks * block_len;
+		size -= blocks * block_len;
+	}
+
+	if (size > 0) {
+		memcpy(ctx->block, input, size);
+		ctx->block_used = size;
+	}
+}
+
+/** Finish hashing and store the result.
+ *
+ * The context has to be initialized again before further use.
+ *
+ * @param ctx    Hash context.
+ * @param output Output buffer for hash (length of the hash selector).
+ *
+ */
+void hash_final(hash_ctx_t *ctx, uint8_t *output)
+{
+	size_t block_len = hash_block_length(ctx->func);
+	size_t len_size = (ctx->func == HASH_SHA512) ? 16 : 8;
+	uint64_t bits = ctx->length << 3;
+
+	ctx->block[ctx->block_used++] = 0x80;
 
-		temp = rotl_uint32(w[0], 5) + f + w[4] + cf + sched_arr[k];
+	if (ctx->block_used > block_len - len_size) {
+		memset(ctx->block + ctx->block_used, 0,
+		    block_len - ctx->block_used);
+		hash_blocks(ctx, ctx->block, 1);
+		ctx->block_used = 0;
+	}
+
+	memset(ctx->block + ctx->block_used, 0, block_len - ctx->block_used);
 
-		w[4] = w[3];
-		w[3] = w[2];
-		w[2] = rotl_uint32(w[1], 30);
-		w[1] = w[0];
-		w[0] = temp;
+	uint8_t *len_field = ctx->block + block_len - len_size;
+	if (ctx->func == HASH_MD5) {
+		for (size_t i = 0; i < 8; i++)
+			len_field[i] = bits >> (8 * i);
+	} else {
+		/* Upper bits of the 128-bit SHA-512 length */
+		if (len_size == 16)
+			len_field[7] = ctx->length >> 61;
+
+		for (size_t i = 0; i < 8; i++)
+			len_field[len_size - 1 - i] = bits >> (8 * i);
 	}
 
-	for (uint8_t k = 0; k < HASH_SHA1 / 4; k++)
-		h[k] += w[k];
+	hash_blocks(ctx, ctx->block, 1);
+
+	switch (ctx->func) {
+	case HASH_MD5:
+		for (size_t i = 0; i < HASH_MD5 / 4; i++) {
+			uint32_t word = host2uint32_t_le(ctx->state.h32[i]);
+			memcpy(output + 4 * i, &word, sizeof(word));
+		}
+		break;
+	case HASH_SHA512:
+		for (size_t i = 0; i < HASH_SHA512 / 8; i++) {
+			uint64_t word = host2uint64_t_be(ctx->state.h64[i]);
+			memcpy(output + 8 * i, &word, sizeof(word));
+		}
+		break;
+	default:
+		for (size_t i = 0; i < ctx->func / 4; i++) {
+			uint32_t word = host2uint32_t_be(ctx->state.h32[i]);
+			memcpy(output + 4 * i, &word, sizeof(word));
+		}
+		break;
+	}
 }
 
 /** Create hash based on selected algorithm.
@@ -188,8 +282,8 @@ static void sha1_proc(uint32_t *h, uint32_t *sched_arr)
  * @param output     Result hash byte sequence.
  * @param hash_sel   Hash function selector.
  *
- * @return EINVAL when input not specified,
- *         ENOMEM when pointer for output hash result
+ * @return EINVAL when input not specified or hash function
+ *         is unknown, ENOMEM when pointer for output hash result
  *         is not allocated, otherwise EOK.
  *
  */
@@ -202,55 +296,102 @@ errno_t create_hash(uint8_t *input, size_t input_size, uint8_t *output,
 	if (!output)
 		return ENOMEM;
 
-	hash_fnc_t hash_func = (hash_sel == HASH_MD5) ? md5_proc : sha1_proc;
-
-	/* Prepare scheduled input. */
-	uint8_t work_input[input_size + 1];
-	memcpy(work_input, input, input_size);
-	work_input[input_size] = 0x80;
-
-	// FIXME: double?
-	size_t blocks = ceil_uint32((((double) input_size + 1) / 4 + 2) / 16);
-	uint32_t work_arr[blocks * 16];
-	for (size_t i = 0; i < blocks; i++) {
-		for (size_t j = 0; j < 16; j++) {
-			work_arr[i * 16 + j] =
-			    (get_at(work_input, input_size + 1, i * 64 + j * 4) << 24) |
-			    (get_at(work_input, input_size + 1, i * 64 + j * 4 + 1) << 16) |
-			    (get_at(work_input, input_size + 1, i * 64 + j * 4 + 2) << 8) |
-			    get_at(work_input, input_size + 1, i * 64 + j * 4 + 3);
-		}
-	}
+	hash_ctx_t ctx;
+	errno_t rc = hash_init(&ctx, hash_sel);
+	if (rc != EOK)
+		return rc;
+
+	hash_update(&ctx, input, input_size);
+	hash_final(&ctx, output);
+
+	return EOK;
+}
 
-	uint64_t bits_size = (uint64_t) (input_size * 8);
-	if (hash_sel == HASH_MD5)
-		bits_size = uint64_t_byteorder_swap(bits_size);
+/** Initialize HMAC context.
+ *
+ * The hash states after absorbing the inner and outer padded keys
+ * are precomputed, so that the key is processed only once no matter
+ * how many messages are authenticated with it.
+ *
+ * @param ctx      HMAC context.
+ * @param key      Cryptographic key sequence.
+ * @param key_size Size of key sequence.
+ * @param hash_sel Hash function selector.
+ *
+ * @return EINVAL for unknown hash function, otherwise EOK.
+ *
+ */
+errno_t hmac_init(hmac_ctx_t *ctx, const uint8_t *key, size_t key_size,
+    hash_func_t hash_sel)
+{
+	uint8_t work_key[HASH_MAX_BLOCK_LENGTH];
+	uint8_t pad[HASH_MAX_BLOCK_LENGTH];
 
-	work_arr[(blocks - 1) * 16 + 14] = bits_size >> 32;
-	work_arr[(blocks - 1) * 16 + 15] = bits_size & 0xffffffff;
+	errno_t rc = hash_init(&ctx->inner, hash_sel);
+	if (rc != EOK)
+		return rc;
 
-	/* Hash computation. */
-	uint32_t h[hash_sel / 4];
-	memcpy(h, hash_init, (hash_sel / 4) * sizeof(uint32_t));
-	uint32_t sched_arr[80];
-	for (size_t i = 0; i < blocks; i++) {
-		for (size_t k = 0; k < 16; k++)
-			sched_arr[k] = work_arr[i * 16 + k];
+	size_t block_len = hash_block_length(hash_sel);
+	memset(work_key, 0, block_len);
 
-		hash_func(h, sched_arr);
+	if (key_size > block_len) {
+		hash_update(&ctx->inner, key, key_size);
+		hash_final(&ctx->inner, work_key);
+		(void) hash_init(&ctx->inner, hash_sel);
+	} else {
+		memcpy(work_key, key, key_size);
 	}
 
-	/* Copy hash parts into final result. */
-	for (size_t i = 0; i < hash_sel / 4; i++) {
-		if (hash_sel == HASH_SHA1)
-			h[i] = uint32_t_byteorder_swap(h[i]);
+	for (size_t i = 0; i < block_len; i++)
+		pad[i] = work_key[i] ^ 0x36;
 
-		memcpy(output + i * sizeof(uint32_t), &h[i], sizeof(uint32_t));
-	}
+	hash_update(&ctx->inner, pad, block_len);
+
+	for (size_t i = 0; i < block_len; i++)
+		pad[i] = work_key[i] ^ 0x5c;
+
+	(void) hash_init(&ctx->outer, hash_sel);
+	hash_update(&ctx->outer, pad, block_len);
+
+	ctx->work = ctx->inner;
 
 	return EOK;
 }
 
+/** Add data to the authenticated message.
+ *
+ * @param ctx  HMAC context.
+ * @param data Message data.
+ * @param size Size of message data.
+ *
+ */
+void hmac_update(hmac_ctx_t *ctx, const void *data, size_t size)
+{
+	hash_update(&ctx->work, data, size);
+}
+
+/** Finish message authentication code and store the result.
+ *
+ * The context is left ready for another message with the same key.
+ *
+ * @param ctx    HMAC context.
+ * @param output Output buffer for the code (length of the hash selector).
+ *
+ */
+void hmac_final(hmac_ctx_t *ctx, uint8_t *output)
+{
+	uint8_t inner_hash[HASH_MAX_LENGTH];
+	size_t hash_len = ctx->work.func;
+
+	hash_final(&ctx->work, inner_hash);
+
+	ctx->work = ctx->outer;
+	hash_update(&ctx->work, inner_hash, hash_len);
+	hash_final(&ctx->work, output);
+
+	ctx->work = ctx->inner;
+}
+
 /** Hash-based message authentication code.
  *
  * @param key      Cryptographic key sequence.
@@ -260,9 +401,9 @@ errno_t create_hash(uint8_t *input, size_t input_size, uint8_t *output,
  * @param hash     Output parameter for result hash.
  * @param hash_sel Hash function selector.
  *
- * @return EINVAL when key or message not specified,
- *         ENOMEM when pointer for output hash result
- *         is not allocated, otherwise EOK.
+ * @return EINVAL when key or message not specified or hash
+ *         function is unknown, ENOMEM when pointer for output hash
+ *         result is not allocated, otherwise EOK.
  *
  */
 errno_t hmac(uint8_t *key, size_t key_size, uint8_t *msg, size_t msg_size,
@@ -274,33 +415,13 @@ errno_t hmac(uint8_t *key, size_t key_size, uint8_t *msg, size_t msg_size,
 	if (!hash)
 		return ENOMEM;
 
-	uint8_t work_key[HMAC_BLOCK_LENGTH];
-	uint8_t o_key_pad[HMAC_BLOCK_LENGTH];
-	uint8_t i_key_pad[HMAC_BLOCK_LENGTH];
-	uint8_t temp_hash[hash_sel];
-	memset(work_key, 0, HMAC_BLOCK_LENGTH);
-
-	if (key_size > HMAC_BLOCK_LENGTH)
-		create_hash(key, key_size, work_key, hash_sel);
-	else
-		memcpy(work_key, key, key_size);
-
-	for (size_t i = 0; i < HMAC_BLOCK_LENGTH; i++) {
-		o_key_pad[i] = work_key[i] ^ 0x5c;
-		i_key_pad[i] = work_key[i] ^ 0x36;
-	}
-
-	uint8_t temp_work[HMAC_BLOCK_LENGTH + max(msg_size, hash_sel)];
-	memcpy(temp_work, i_key_pad, HMAC_BLOCK_LENGTH);
-	memcpy(temp_work + HMAC_BLOCK_LENGTH, msg, msg_size);
+	hmac_ctx_t ctx;
+	errno_t rc = hmac_init(&ctx, key, key_size, hash_sel);
+	if (rc != EOK)
+		return rc;
 
-	create_hash(temp_work, HMAC_BLOCK_LENGTH + msg_size, temp_hash,
-	    hash_sel);
-
-	memcpy(temp_work, o_key_pad, HMAC_BLOCK_LENGTH);
-	memcpy(temp_work + HMAC_BLOCK_LENGTH, temp_hash, hash_sel);
-
-	create_hash(temp_work, HMAC_BLOCK_LENGTH + hash_sel, hash, hash_sel);
+	hmac_update(&ctx, msg, msg_size);
+	hmac_final(&ctx, hash);
 
 	return EOK;
 }
@@ -330,25 +451,26 @@ errno_t pbkdf2(uint8_t *pass, size_t pass_size, uint8_t *salt, size_t salt_size,
 	if (!hash)
 		return ENOMEM;
 
-	uint8_t work_salt[salt_size + 4];
-	memcpy(work_salt, salt, salt_size);
+	hmac_ctx_t ctx;
 	uint8_t work_hmac[HASH_SHA1];
-	uint8_t temp_hmac[HASH_SHA1];
 	uint8_t xor_hmac[HASH_SHA1];
 	uint8_t temp_hash[HASH_SHA1 * 2];
 
+	errno_t rc = hmac_init(&ctx, pass, pass_size, HASH_SHA1);
+	if (rc != EOK)
+		return rc;
+
 	for (size_t i = 0; i < 2; i++) {
 		uint32_t be_i = host2uint32_t_be(i + 1);
 
-		memcpy(work_salt + salt_size, &be_i, 4);
-		hmac(pass, pass_size, work_salt, salt_size + 4,
-		    work_hmac, HASH_SHA1);
+		hmac_update(&ctx, salt, salt_size);
+		hmac_update(&ctx, &be_i, 4);
+		hmac_final(&ctx, work_hmac);
 		memcpy(xor_hmac, work_hmac, HASH_SHA1);
 
 		for (size_t k = 1; k < 4096; k++) {
-			memcpy(temp_hmac, work_hmac, HASH_SHA1);
-			hmac(pass, pass_size, temp_hmac, HASH_SHA1,
-			    work_hmac, HASH_SHA1);
+			hmac_update(&ctx, work_hmac, HASH_SHA1);
+			hmac_final(&ctx, work_hmac);
 
 			for (size_t t = 0; t < HASH_SHA1; t++)
 				xor_hmac[t] ^= work_hmac[t];
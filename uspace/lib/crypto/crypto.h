@@ -30,12 +30,22 @@
 #define LIBCRYPTO_H
 
 #include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #define AES_CIPHER_LENGTH  16
 #define PBKDF2_KEY_LENGTH  32
 
+/* AES block length and key lengths. */
+#define AES_BLOCK_LENGTH  16
+#define AES_KEY_128       16
+#define AES_KEY_192       24
+#define AES_KEY_256       32
+
+/* Number of rounds for the longest key. */
+#define AES_MAX_ROUNDS  14
+
 /* Left rotation for uint32_t. */
 #define rotl_uint32(val, shift) \
 	(((val) << shift) | ((val) >> (32 - shift)))
@@ -46,14 +56,92 @@
 
 /** Hash function selector and also result hash length indicator. */
 typedef enum {
-	HASH_MD5 =  16,
-	HASH_SHA1 = 20
+	HASH_MD5 =    16,
+	HASH_SHA1 =   20,
+	HASH_SHA256 = 32,
+	HASH_SHA512 = 64
 } hash_func_t;
 
+/* Longest hash result and longest hash input block. */
+#define HASH_MAX_LENGTH        64
+#define HASH_MAX_BLOCK_LENGTH  128
+
+/** Incremental hash context. */
+typedef struct {
+	/** Hash function. */
+	hash_func_t func;
+	/** Interim hash value. */
+	union {
+		uint32_t h32[8];
+		uint64_t h64[8];
+	} state;
+	/** Partial input block. */
+	uint8_t block[HASH_MAX_BLOCK_LENGTH];
+	/** Number of bytes in the partial block. */
+	size_t block_used;
+	/** Total length of hashed message in bytes. */
+	uint64_t length;
+	/** Hardware implementation is used. */
+	bool accel;
+} hash_ctx_t;
+
+/** HMAC context with precomputed key states. */
+typedef struct {
+	/** State after absorbing the inner padded key. */
+	hash_ctx_t inner;
+	/** State after absorbing the outer padded key. */
+	hash_ctx_t outer;
+	/** State of the message being authenticated. */
+	hash_ctx_t work;
+} hmac_ctx_t;
+
+/** AES context with expanded key. */
+typedef struct {
+	/** Round keys for encryption. */
+	uint32_t enc_key[4 * (AES_MAX_ROUNDS + 1)];
+	/** Round keys for decryption. */
+	uint32_t dec_key[4 * (AES_MAX_ROUNDS + 1)];
+	/** Number of rounds. */
+	unsigned int rounds;
+	/** Hardware implementation is used. */
+	bool accel;
+} aes_context_t;
+
 extern errno_t rc4(uint8_t *, size_t, uint8_t *, size_t, size_t, uint8_t *);
 extern errno_t aes_encrypt(uint8_t *, uint8_t *, uint8_t *);
 extern errno_t aes_decrypt(uint8_t *, uint8_t *, uint8_t *);
+extern errno_t aes_init(aes_context_t *, const uint8_t *, size_t);
+extern errno_t aes_init_generic(aes_context_t *, const uint8_t *, size_t);
+extern void aes_encrypt_block(const aes_context_t *, const uint8_t *,
+    uint8_t *);
+extern void aes_decrypt_block(const aes_context_t *, const uint8_t *,
+    uint8_t *);
+extern errno_t aes_cbc_encrypt(const aes_context_t *, uint8_t *,
+    const uint8_t *, uint8_t *, size_t);
+extern errno_t aes_cbc_decrypt(const aes_context_t *, uint8_t *,
+    const uint8_t *, uint8_t *, size_t);
+extern void aes_ctr_crypt(const aes_context_t *, uint8_t *, const uint8_t *,
+    uint8_t *, size_t);
+extern errno_t aes_ccm_encrypt(const aes_context_t *, const uint8_t *, size_t,
+    const uint8_t *, size_t, const uint8_t *, uint8_t *, size_t, uint8_t *,
+    size_t);
+extern errno_t aes_ccm_decrypt(const aes_context_t *, const uint8_t *, size_t,
+    const uint8_t *, size_t, const uint8_t *, uint8_t *, size_t,
+    const uint8_t *, size_t);
+extern errno_t aes_gcm_encrypt(const aes_context_t *, const uint8_t *, size_t,
+    const uint8_t *, size_t, const uint8_t *, uint8_t *, size_t, uint8_t *,
+    size_t);
+extern errno_t aes_gcm_decrypt(const aes_context_t *, const uint8_t *, size_t,
+    const uint8_t *, size_t, const uint8_t *, uint8_t *, size_t,
+    const uint8_t *, size_t);
+extern errno_t hash_init(hash_ctx_t *, hash_func_t);
+extern errno_t hash_init_generic(hash_ctx_t *, hash_func_t);
+extern void hash_update(hash_ctx_t *, const void *, size_t);
+extern void hash_final(hash_ctx_t *, uint8_t *);
 extern errno_t create_hash(uint8_t *, size_t, uint8_t *, hash_func_t);
+extern errno_t hmac_init(hmac_ctx_t *, const uint8_t *, size_t, hash_func_t);
+extern void hmac_update(hmac_ctx_t *, const void *, size_t);
+extern void hmac_final(hmac_ctx_t *, uint8_t *);
 extern errno_t hmac(uint8_t *, size_t, uint8_t *, size_t, uint8_t *, hash_func_t);
 extern errno_t pbkdf2(uint8_t *, size_t, uint8_t *, size_t, uint8_t *);
 
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file hash_private.h
+ *
+ * Internal interface between the hash context and the compression
+ * functions.
+ */
+
+#ifndef LIBCRYPTO_HASH_PRIVATE_H
+#define LIBCRYPTO_HASH_PRIVATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#define SHA_NI
+#endif
+
+/** Length of MD5, SHA-1 and SHA-256 block. */
+#define HASH_BLOCK_LENGTH  64
+
+/** Length of SHA-512 block. */
+#define HASH_BLOCK_LENGTH_512  128
+
+/** Load big-endian 32-bit value. */
+static inline uint32_t hash_load_be32(const uint8_t *p)
+{
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) |
+	    ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
+/** Load little-endian 32-bit value. */
+static inline uint32_t hash_load_le32(const uint8_t *p)
+{
+	return ((uint32_t) p[3] << 24) | ((uint32_t) p[2] << 16) |
+	    ((uint32_t) p[1] << 8) | (uint32_t) p[0];
+}
+
+/** Load big-endian 64-bit value. */
+static inline uint64_t hash_load_be64(const uint8_t *p)
+{
+	return ((uint64_t) hash_load_be32(p) << 32) | hash_load_be32(p + 4);
+}
+
+extern void md5_blocks(uint32_t *, const uint8_t *, size_t);
+extern void sha1_blocks(uint32_t *, const uint8_t *, size_t);
+extern void sha256_blocks(uint32_t *, const uint8_t *, size_t);
+extern void sha512_blocks(uint64_t *, const uint8_t *, size_t);
+
+extern const uint32_t sha256_k[64];
+
+#ifdef SHA_NI
+
+extern bool sha_ni_supported(void);
+extern void sha1_ni_blocks(uint32_t *, const uint8_t *, size_t);
+extern void sha256_ni_blocks(uint32_t *, const uint8_t *, size_t);
+
+#endif
+
+#endif
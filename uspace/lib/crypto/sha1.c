@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sha1.c
+ *
+ * SHA-1 compression function (FIPS 180-4).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crypto.h"
+#include "hash_private.h"
+
+#define SHA1_CH(x, y, z)      ((z) ^ ((x) & ((y) ^ (z))))
+#define SHA1_PARITY(x, y, z)  ((x) ^ (y) ^ (z))
+#define SHA1_MAJ(x, y, z)     (((x) & (y)) | ((z) & ((x) | (y))))
+
+/** Message schedule word @a t computed in place in a 16-word window. */
+#define SHA1_W(w, t) \
+	((w)[(t) & 15] = rotl_uint32((w)[((t) - 3) & 15] ^ \
+	    (w)[((t) - 8) & 15] ^ (w)[((t) - 14) & 15] ^ (w)[(t) & 15], 1))
+
+/** One SHA-1 round with the rotation of working variables folded
+ * into the argument order.
+ */
+#define SHA1_ROUND(f, k, a, b, c, d, e, x) \
+	do { \
+		(e) += rotl_uint32((a), 5) + f((b), (c), (d)) + (k) + (x); \
+		(b) = rotl_uint32((b), 30); \
+	} while (0)
+
+/** Five rounds, after which the working variables are back in place. */
+#define SHA1_ROUNDS5(f, k, t, x) \
+	do { \
+		SHA1_ROUND(f, k, a, b, c, d, e, x(t)); \
+		SHA1_ROUND(f, k, e, a, b, c, d, x((t) + 1)); \
+		SHA1_ROUND(f, k, d, e, a, b, c, x((t) + 2)); \
+		SHA1_ROUND(f, k, c, d, e, a, b, x((t) + 3)); \
+		SHA1_ROUND(f, k, b, c, d, e, a, x((t) + 4)); \
+	} while (0)
+
+#define SHA1_X0(t)  (w[t])
+#define SHA1_X(t)   SHA1_W(w, t)
+
+/** Process whole SHA-1 blocks.
+ *
+ * @param h      Interim hash value.
+ * @param data   Input blocks.
+ * @param blocks Number of 64-byte blocks.
+ *
+ */
+void sha1_blocks(uint32_t *h, const uint8_t *data, size_t blocks)
+{
+	uint32_t w[16];
+
+	while (blocks-- > 0) {
+		for (size_t i = 0; i < 16; i++)
+			w[i] = hash_load_be32(data + 4 * i);
+
+		uint32_t a = h[0];
+		uint32_t b = h[1];
+		uint32_t c = h[2];
+		uint32_t d = h[3];
+		uint32_t e = h[4];
+
+		SHA1_ROUNDS5(SHA1_CH, 0x5a827999, 0, SHA1_X0);
+		SHA1_ROUNDS5(SHA1_CH, 0x5a827999, 5, SHA1_X0);
+		SHA1_ROUNDS5(SHA1_CH, 0x5a827999, 10, SHA1_X0);
+		SHA1_ROUND(SHA1_CH, 0x5a827999, a, b, c, d, e, w[15]);
+		SHA1_ROUND(SHA1_CH, 0x5a827999, e, a, b, c, d, SHA1_X(16));
+		SHA1_ROUND(SHA1_CH, 0x5a827999, d, e, a, b, c, SHA1_X(17));
+		SHA1_ROUND(SHA1_CH, 0x5a827999, c, d, e, a, b, SHA1_X(18));
+		SHA1_ROUND(SHA1_CH, 0x5a827999, b, c, d, e, a, SHA1_X(19));
+
+		for (unsigned int t = 20; t < 40; t += 5)
+			SHA1_ROUNDS5(SHA1_PARITY, 0x6ed9eba1, t, SHA1_X);
+
+		for (unsigned int t = 40; t < 60; t += 5)
+			SHA1_ROUNDS5(SHA1_MAJ, 0x8f1bbcdc, t, SHA1_X);
+
+		for (unsigned int t = 60; t < 80; t += 5)
+			SHA1_ROUNDS5(SHA1_PARITY, 0xca62c1d6, t, SHA1_X);
+
+		h[0] += a;
+		h[1] += b;
+		h[2] += c;
+		h[3] += d;
+		h[4] += e;
+
+		data += HASH_BLOCK_LENGTH;
+	}
+}
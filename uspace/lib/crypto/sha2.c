@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sha2.c
+ *
+ * SHA-256 and SHA-512 compression functions (FIPS 180-4).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crypto.h"
+#include "hash_private.h"
+
+/** SHA-256 round constants. */
+const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+/** SHA-512 round constants. */
+static const uint64_t sha512_k[80] = {
+	UINT64_C(0x428a2f98d728ae22), UINT64_C(0x7137449123ef65cd),
+	UINT64_C(0xb5c0fbcfec4d3b2f), UINT64_C(0xe9b5dba58189dbbc),
+	UINT64_C(0x3956c25bf348b538), UINT64_C(0x59f111f1b605d019),
+	UINT64_C(0x923f82a4af194f9b), UINT64_C(0xab1c5ed5da6d8118),
+	UINT64_C(0xd807aa98a3030242), UINT64_C(0x12835b0145706fbe),
+	UINT64_C(0x243185be4ee4b28c), UINT64_C(0x550c7dc3d5ffb4e2),
+	UINT64_C(0x72be5d74f27b896f), UINT64_C(0x80deb1fe3b1696b1),
+	UINT64_C(0x9bdc06a725c71235), UINT64_C(0xc19bf174cf692694),
+	UINT64_C(0xe49b69c19ef14ad2), UINT64_C(0xefbe4786384f25e3),
+	UINT64_C(0x0fc19dc68b8cd5b5), UINT64_C(0x240ca1cc77ac9c65),
+	UINT64_C(0x2de92c6f592b0275), UINT64_C(0x4a7484aa6ea6e483),
+	UINT64_C(0x5cb0a9dcbd41fbd4), UINT64_C(0x76f988da831153b5),
+	UINT64_C(0x983e5152ee66dfab), UINT64_C(0xa831c66d2db43210),
+	UINT64_C(0xb00327c898fb213f), UINT64_C(0xbf597fc7beef0ee4),
+	UINT64_C(0xc6e00bf33da88fc2), UINT64_C(0xd5a79147930aa725),
+	UINT64_C(0x06ca6351e003826f), UINT64_C(0x142929670a0e6e70),
+	UINT64_C(0x27b70a8546d22ffc), UINT64_C(0x2e1b21385c26c926),
+	UINT64_C(0x4d2c6dfc5ac42aed), UINT64_C(0x53380d139d95b3df),
+	UINT64_C(0x650a73548baf63de), UINT64_C(0x766a0abb3c77b2a8),
+	UINT64_C(0x81c2c92e47edaee6), UINT64_C(0x92722c851482353b),
+	UINT64_C(0xa2bfe8a14cf10364), UINT64_C(0xa81a664bbc423001),
+	UINT64_C(0xc24b8b70d0f89791), UINT64_C(0xc76c51a30654be30),
+	UINT64_C(0xd192e819d6ef5218), UINT64_C(0xd69906245565a910),
+	UINT64_C(0xf40e35855771202a), UINT64_C(0x106aa07032bbd1b8),
+	UINT64_C(0x19a4c116b8d2d0c8), UINT64_C(0x1e376c085141ab53),
+	UINT64_C(0x2748774cdf8eeb99), UINT64_C(0x34b0bcb5e19b48a8),
+	UINT64_C(0x391c0cb3c5c95a63), UINT64_C(0x4ed8aa4ae3418acb),
+	UINT64_C(0x5b9cca4f7763e373), UINT64_C(0x682e6ff3d6b2b8a3),
+	UINT64_C(0x748f82ee5defb2fc), UINT64_C(0x78a5636f43172f60),
+	UINT64_C(0x84c87814a1f0ab72), UINT64_C(0x8cc702081a6439ec),
+	UINT64_C(0x90befffa23631e28), UINT64_C(0xa4506cebde82bde9),
+	UINT64_C(0xbef9a3f7b2c67915), UINT64_C(0xc67178f2e372532b),
+	UINT64_C(0xca273eceea26619c), UINT64_C(0xd186b8c721c0c207),
+	UINT64_C(0xeada7dd6cde0eb1e), UINT64_C(0xf57d4f7fee6ed178),
+	UINT64_C(0x06f067aa72176fba), UINT64_C(0x0a637dc5a2c898a6),
+	UINT64_C(0x113f9804bef90dae), UINT64_C(0x1b710b35131c471b),
+	UINT64_C(0x28db77f523047d84), UINT64_C(0x32caab7b40c72493),
+	UINT64_C(0x3c9ebe0a15c9bebc), UINT64_C(0x431d67c49c100d4c),
+	UINT64_C(0x4cc5d4becb3e42b6), UINT64_C(0x597f299cfc657e2a),
+	UINT64_C(0x5fcb6fab3ad6faec), UINT64_C(0x6c44198c4a475817),
+};
+
+/* Right rotation for uint64_t. */
+#define rotr_uint64(val, shift) \
+	(((val) >> (shift)) | ((val) << (64 - (shift))))
+
+#define SHA2_CH(x, y, z)   ((z) ^ ((x) & ((y) ^ (z))))
+#define SHA2_MAJ(x, y, z)  (((x) & (y)) | ((z) & ((x) | (y))))
+
+#define SHA256_S0(x)  (rotr_uint32((x), 2) ^ rotr_uint32((x), 13) ^ \
+	rotr_uint32((x), 22))
+#define SHA256_S1(x)  (rotr_uint32((x), 6) ^ rotr_uint32((x), 11) ^ \
+	rotr_uint32((x), 25))
+#define SHA256_s0(x)  (rotr_uint32((x), 7) ^ rotr_uint32((x), 18) ^ \
+	((x) >> 3))
+#define SHA256_s1(x)  (rotr_uint32((x), 17) ^ rotr_uint32((x), 19) ^ \
+	((x) >> 10))
+
+#define SHA512_S0(x)  (rotr_uint64((x), 28) ^ rotr_uint64((x), 34) ^ \
+	rotr_uint64((x), 39))
+#define SHA512_S1(x)  (rotr_uint64((x), 14) ^ rotr_uint64((x), 18) ^ \
+	rotr_uint64((x), 41))
+#define SHA512_s0(x)  (rotr_uint64((x), 1) ^ rotr_uint64((x), 8) ^ \
+	((x) >> 7))
+#define SHA512_s1(x)  (rotr_uint64((x), 19) ^ rotr_uint64((x), 61) ^ \
+	((x) >> 6))
+
+/** Message schedule word @a t computed in place in a 16-word window. */
+#define SHA2_W(bits, w, t) \
+	((w)[(t) & 15] += SHA##bits##_s1((w)[((t) - 2) & 15]) + \
+	    (w)[((t) - 7) & 15] + SHA##bits##_s0((w)[((t) - 15) & 15]))
+
+/** One SHA-2 round with the rotation of working variables folded
+ * into the argument order.
+ */
+#define SHA2_ROUND(bits, a, b, c, d, e, f, g, h, k, x) \
+	do { \
+		(h) += SHA##bits##_S1(e) + SHA2_CH((e), (f), (g)) + (k) + (x); \
+		(d) += (h); \
+		(h) += SHA##bits##_S0(a) + SHA2_MAJ((a), (b), (c)); \
+	} while (0)
+
+/** Eight rounds, after which the working variables are back in place. */
+#define SHA2_ROUNDS8(bits, kt, t, x) \
+	do { \
+		SHA2_ROUND(bits, a, b, c, d, e, f, g, h, kt[(t)], x(t)); \
+		SHA2_ROUND(bits, h, a, b, c, d, e, f, g, kt[(t) + 1], x((t) + 1)); \
+		SHA2_ROUND(bits, g, h, a, b, c, d, e, f, kt[(t) + 2], x((t) + 2)); \
+		SHA2_ROUND(bits, f, g, h, a, b, c, d, e, kt[(t) + 3], x((t) + 3)); \
+		SHA2_ROUND(bits, e, f, g, h, a, b, c, d, kt[(t) + 4], x((t) + 4)); \
+		SHA2_ROUND(bits, d, e, f, g, h, a, b, c, kt[(t) + 5], x((t) + 5)); \
+		SHA2_ROUND(bits, c, d, e, f, g, h, a, b, kt[(t) + 6], x((t) + 6)); \
+		SHA2_ROUND(bits, b, c, d, e, f, g, h, a, kt[(t) + 7], x((t) + 7)); \
+	} while (0)
+
+#define SHA2_X0(t)     (w[(t)])
+#define SHA256_X(t)    SHA2_W(256, w, (t))
+#define SHA512_X(t)    SHA2_W(512, w, (t))
+
+/** Process whole SHA-256 blocks.
+ *
+ * @param state  Interim hash value.
+ * @param data   Input blocks.
+ * @param blocks Number of 64-byte blocks.
+ *
+ */
+void sha256_blocks(uint32_t *state, const uint8_t *data, size_t blocks)
+{
+	uint32_t w[16];
+
+	while (blocks-- > 0) {
+		for (size_t i = 0; i < 16; i++)
+			w[i] = hash_load_be32(data + 4 * i);
+
+		uint32_t a = state[0];
+		uint32_t b = state[1];
+		uint32_t c = state[2];
+		uint32_t d = state[3];
+		uint32_t e = state[4];
+		uint32_t f = state[5];
+		uint32_t g = state[6];
+		uint32_t h = state[7];
+
+		SHA2_ROUNDS8(256, sha256_k, 0, SHA2_X0);
+		SHA2_ROUNDS8(256, sha256_k, 8, SHA2_X0);
+
+		for (unsigned int t = 16; t < 64; t += 8)
+			SHA2_ROUNDS8(256, sha256_k, t, SHA256_X);
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+
+		data += HASH_BLOCK_LENGTH;
+	}
+}
+
+/** Process whole SHA-512 blocks.
+ *
+ * @param state  Interim hash value.
+ * @param data   Input blocks.
+ * @param blocks Number of 128-byte blocks.
+ *
+ */
+void sha512_blocks(uint64_t *state, const uint8_t *data, size_t blocks)
+{
+	uint64_t w[16];
+
+	while (blocks-- > 0) {
+		for (size_t i = 0; i < 16; i++)
+			w[i] = hash_load_be64(data + 8 * i);
+
+		uint64_t a = state[0];
+		uint64_t b = state[1];
+		uint64_t c = state[2];
+		uint64_t d = state[3];
+		uint64_t e = state[4];
+		uint64_t f = state[5];
+		uint64_t g = state[6];
+		uint64_t h = state[7];
+
+		SHA2_ROUNDS8(512, sha512_k, 0, SHA2_X0);
+		SHA2_ROUNDS8(512, sha512_k, 8, SHA2_X0);
+
+		for (unsigned int t = 16; t < 80; t += 8)
+			SHA2_ROUNDS8(512, sha512_k, t, SHA512_X);
+
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+
+		data += HASH_BLOCK_LENGTH_512;
+	}
+}
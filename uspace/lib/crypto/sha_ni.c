@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sha_ni.c
+ *
+ * SHA-1 and SHA-256 compression functions using the x86 SHA
+ * instruction set.
+ *
+ * The functions are compiled for the SHA instruction set regardless
+ * of the target processor and they are only called if the processor
+ * supports the instructions.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "crypto.h"
+#include "hash_private.h"
+
+#ifdef SHA_NI
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+#define SHA_NI_TARGET  __attribute__((target("sse4.1,sha")))
+
+/** Processor support state (0 unknown, 1 supported, -1 unsupported). */
+static int sha_ni_state = 0;
+
+/** Check whether the processor supports the SHA instruction set.
+ *
+ * @return True if the instructions are supported.
+ *
+ */
+bool sha_ni_supported(void)
+{
+	if (sha_ni_state == 0) {
+		unsigned int eax, ebx, ecx, edx;
+		bool sse41 = false;
+		bool sha = false;
+
+		if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0)
+			sse41 = ((ecx & bit_SSE4_1) != 0);
+
+		if ((__get_cpuid_max(0, NULL) >= 7) &&
+		    (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0))
+			sha = ((ebx & bit_SHA) != 0);
+
+		sha_ni_state = (sse41 && sha) ? 1 : -1;
+	}
+
+	return (sha_ni_state > 0);
+}
+
+/** Four SHA-1 rounds with message schedule.
+ *
+ * Group @a g covers rounds 4g to 4g + 3. The schedule of the
+ * message words needed by later groups is interleaved with the
+ * rounds.
+ */
+#define SHA1_NI_GROUP(g) \
+	do { \
+		if ((g) == 0) \
+			e[0] = _mm_add_epi32(e[0], msg[0]); \
+		else \
+			e[(g) & 1] = _mm_sha1nexte_epu32(e[(g) & 1], \
+			    msg[(g) & 3]); \
+		e[((g) + 1) & 1] = abcd; \
+		abcd = _mm_sha1rnds4_epu32(abcd, e[(g) & 1], (g) / 5); \
+		if (((g) >= 3) && ((g) <= 18)) \
+			msg[((g) + 1) & 3] = _mm_sha1msg2_epu32( \
+			    msg[((g) + 1) & 3], msg[(g) & 3]); \
+		if (((g) >= 1) && ((g) <= 16)) \
+			msg[((g) + 3) & 3] = _mm_sha1msg1_epu32( \
+			    msg[((g) + 3) & 3], msg[(g) & 3]); \
+		if (((g) >= 2) && ((g) <= 17)) \
+			msg[((g) + 2) & 3] = _mm_xor_si128( \
+			    msg[((g) + 2) & 3], msg[(g) & 3]); \
+	} while (0)
+
+/** Process whole SHA-1 blocks.
+ *
+ * @param h      Interim hash value.
+ * @param data   Input blocks.
+ * @param blocks Number of 64-byte blocks.
+ *
+ */
+SHA_NI_TARGET void sha1_ni_blocks(uint32_t *h, const uint8_t *data,
+    size_t blocks)
+{
+	const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL,
+	    0x08090a0b0c0d0e0fULL);
+
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) h),
+	    0x1b);
+	__m128i e0 = _mm_set_epi32(h[4], 0, 0, 0);
+
+	while (blocks-- > 0) {
+		__m128i abcd_save = abcd;
+		__m128i e0_save = e0;
+		__m128i e[2];
+		__m128i msg[4];
+
+		for (int i = 0; i < 4; i++) {
+			msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(
+			    (const __m128i *) (data + 16 * i)), mask);
+		}
+
+		e[0] = e0;
+
+		SHA1_NI_GROUP(0);
+		SHA1_NI_GROUP(1);
+		SHA1_NI_GROUP(2);
+		SHA1_NI_GROUP(3);
+		SHA1_NI_GROUP(4);
+		SHA1_NI_GROUP(5);
+		SHA1_NI_GROUP(6);
+		SHA1_NI_GROUP(7);
+		SHA1_NI_GROUP(8);
+		SHA1_NI_GROUP(9);
+		SHA1_NI_GROUP(10);
+		SHA1_NI_GROUP(11);
+		SHA1_NI_GROUP(12);
+		SHA1_NI_GROUP(13);
+		SHA1_NI_GROUP(14);
+		SHA1_NI_GROUP(15);
+		SHA1_NI_GROUP(16);
+		SHA1_NI_GROUP(17);
+		SHA1_NI_GROUP(18);
+		SHA1_NI_GROUP(19);
+
+		e0 = _mm_sha1nexte_epu32(e[0], e0_save);
+		abcd = _mm_add_epi32(abcd, abcd_save);
+
+		data += HASH_BLOCK_LENGTH;
+	}
+
+	abcd = _mm_shuffle_epi32(abcd, 0x1b);
+	_mm_storeu_si128((__m128i *) h, abcd);
+	h[4] = _mm_extract_epi32(e0, 3);
+}
+
+/** Four SHA-256 rounds with message schedule.
+ *
+ * Group @a g covers rounds 4g to 4g + 3.
+ */
+#define SHA256_NI_GROUP(g) \
+	do { \
+		__m128i wk = _mm_add_epi32(msg[(g) & 3], _mm_loadu_si128( \
+		    (const __m128i *) &sha256_k[4 * (g)])); \
+		state1 = _mm_sha256rnds2_epu32(state1, state0, wk); \
+		if (((g) >= 3) && ((g) <= 14)) { \
+			__m128i tmp = _mm_alignr_epi8(msg[(g) & 3], \
+			    msg[((g) + 3) & 3], 4); \
+			msg[((g) + 1) & 3] = _mm_sha256msg2_epu32( \
+			    _mm_add_epi32(msg[((g) + 1) & 3], tmp), \
+			    msg[(g) & 3]); \
+		} \
+		wk = _mm_shuffle_epi32(wk, 0x0e); \
+		state0 = _mm_sha256rnds2_epu32(state0, state1, wk); \
+		if (((g) >= 1) && ((g) <= 12)) \
+			msg[((g) + 3) & 3] = _mm_sha256msg1_epu32( \
+			    msg[((g) + 3) & 3], msg[(g) & 3]); \
+	} while (0)
+
+/** Process whole SHA-256 blocks.
+ *
+ * @param h      Interim hash value.
+ * @param data   Input blocks.
+ * @param blocks Number of 64-byte blocks.
+ *
+ */
+SHA_NI_TARGET void sha256_ni_blocks(uint32_t *h, const uint8_t *data,
+    size_t blocks)
+{
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+	    0x0405060700010203ULL);
+
+	/* Rearrange the state to ABEF and CDGH as the instructions expect */
+	__m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) h),
+	    0xb1);
+	__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(
+	    (const __m128i *) (h + 4)), 0x1b);
+	__m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+	while (blocks-- > 0) {
+		__m128i state0_save = state0;
+		__m128i state1_save = state1;
+		__m128i msg[4];
+
+		for (int i = 0; i < 4; i++) {
+			msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(
+			    (const __m128i *) (data + 16 * i)), mask);
+		}
+
+		SHA256_NI_GROUP(0);
+		SHA256_NI_GROUP(1);
+		SHA256_NI_GROUP(2);
+		SHA256_NI_GROUP(3);
+		SHA256_NI_GROUP(4);
+		SHA256_NI_GROUP(5);
+		SHA256_NI_GROUP(6);
+		SHA256_NI_GROUP(7);
+		SHA256_NI_GROUP(8);
+		SHA256_NI_GROUP(9);
+		SHA256_NI_GROUP(10);
+		SHA256_NI_GROUP(11);
+		SHA256_NI_GROUP(12);
+		SHA256_NI_GROUP(13);
+		SHA256_NI_GROUP(14);
+		SHA256_NI_GROUP(15);
+
+		state0 = _mm_add_epi32(state0, state0_save);
+		state1 = _mm_add_epi32(state1, state1_save);
+
+		data += HASH_BLOCK_LENGTH;
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1b);
+	state1 = _mm_shuffle_epi32(state1, 0xb1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+	_mm_storeu_si128((__m128i *) h, state0);
+	_mm_storeu_si128((__m128i *) (h + 4), state1);
+}
+
+#endif
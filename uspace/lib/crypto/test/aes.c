@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include "../crypto.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(aes);
+
+typedef errno_t (*aes_init_fn_t)(aes_context_t *, const uint8_t *, size_t);
+
+/** Both the default and the portable implementation are tested. */
+static aes_init_fn_t inits[] = {
+	aes_init,
+	aes_init_generic
+};
+
+#define INIT_COUNT  (sizeof(inits) / sizeof(inits[0]))
+
+/** Key 000102...1f (FIPS 197 appendix C) */
+static const uint8_t fips_key[32] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+	0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+
+static const uint8_t fips_plain[16] = {
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+
+static const uint8_t fips_cipher[3][16] = {
+	{
+		0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+		0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+	},
+	{
+		0xdd, 0xa9, 0x7c, 0xa4, 0x86, 0x4c, 0xdf, 0xe0,
+		0x6e, 0xaf, 0x70, 0xa0, 0xec, 0x0d, 0x71, 0x91
+	},
+	{
+		0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf,
+		0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89
+	}
+};
+
+/** Key and plain text of NIST SP 800-38A appendix F */
+static const uint8_t sp_key[16] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+static const uint8_t sp_plain[64] = {
+	0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+	0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+	0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+	0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+	0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
+	0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+	0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17,
+	0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+
+static const uint8_t sp_cbc_cipher[64] = {
+	0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46,
+	0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+	0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee,
+	0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+	0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b,
+	0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+	0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09,
+	0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7
+};
+
+static const uint8_t sp_ctr_counter[16] = {
+	0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+	0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+
+static const uint8_t sp_ctr_cipher[64] = {
+	0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26,
+	0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+	0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff,
+	0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+	0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e,
+	0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+	0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1,
+	0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+/** RFC 3610 packet vector #1 */
+static const uint8_t ccm_key[16] = {
+	0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+	0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf
+};
+
+static const uint8_t ccm_nonce[13] = {
+	0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xa0,
+	0xa1, 0xa2, 0xa3, 0xa4, 0xa5
+};
+
+static const uint8_t ccm_aad[8] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07
+};
+
+static const uint8_t ccm_plain[23] = {
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+	0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e
+};
+
+static const uint8_t ccm_cipher[23] = {
+	0x58, 0x8c, 0x97, 0x9a, 0x61, 0xc6, 0x63, 0xd2,
+	0xf0, 0x66, 0xd0, 0xc2, 0xc0, 0xf9, 0x89, 0x80,
+	0x6d, 0x5f, 0x6b, 0x61, 0xda, 0xc3, 0x84
+};
+
+static const uint8_t ccm_tag[8] = {
+	0x17, 0xe8, 0xd1, 0x2c, 0xfd, 0xf9, 0x26, 0xe0
+};
+
+/** GCM specification test case 4 */
+static const uint8_t gcm_key[16] = {
+	0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c,
+	0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08
+};
+
+static const uint8_t gcm_iv[12] = {
+	0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad,
+	0xde, 0xca, 0xf8, 0x88
+};
+
+static const uint8_t gcm_aad[20] = {
+	0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+	0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+	0xab, 0xad, 0xda, 0xd2
+};
+
+static const uint8_t gcm_plain[60] = {
+	0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5,
+	0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,
+	0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda,
+	0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,
+	0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,
+	0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+	0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57,
+	0xba, 0x63, 0x7b, 0x39
+};
+
+static const uint8_t gcm_cipher[60] = {
+	0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24,
+	0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+	0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0,
+	0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+	0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c,
+	0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+	0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97,
+	0x3d, 0x58, 0xe0, 0x91
+};
+
+static const uint8_t gcm_tag[16] = {
+	0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb,
+	0x94, 0xfa, 0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47
+};
+
+/** GCM specification test case 6 (60-byte IV) */
+static const uint8_t gcm_long_iv[60] = {
+	0x93, 0x13, 0x22, 0x5d, 0xf8, 0x84, 0x06, 0xe5,
+	0x55, 0x90, 0x9c, 0x5a, 0xff, 0x52, 0x69, 0xaa,
+	0x6a, 0x7a, 0x95, 0x38, 0x53, 0x4f, 0x7d, 0xa1,
+	0xe4, 0xc3, 0x03, 0xd2, 0xa3, 0x18, 0xa7, 0x28,
+	0xc3, 0xc0, 0xc9, 0x51, 0x56, 0x80, 0x95, 0x39,
+	0xfc, 0xf0, 0xe2, 0x42, 0x9a, 0x6b, 0x52, 0x54,
+	0x16, 0xae, 0xdb, 0xf5, 0xa0, 0xde, 0x6a, 0x57,
+	0xa6, 0x37, 0xb3, 0x9b
+};
+
+static const uint8_t gcm_long_iv_tag[16] = {
+	0x61, 0x9c, 0xc5, 0xae, 0xff, 0xfe, 0x0b, 0xfa,
+	0x46, 0x2a, 0xf4, 0x3c, 0x16, 0x99, 0xd0, 0x50
+};
+
+/** FIPS 197 single block known answers for all key lengths */
+PCUT_TEST(block)
+{
+	static const size_t key_lens[] = {
+		AES_KEY_128, AES_KEY_192, AES_KEY_256
+	};
+
+	for (size_t i = 0; i < INIT_COUNT; i++) {
+		for (size_t k = 0; k < 3; k++) {
+			aes_context_t ctx;
+			uint8_t out[AES_BLOCK_LENGTH];
+
+			errno_t rc = inits[i](&ctx, fips_key, key_lens[k]);
+			PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+			aes_encrypt_block(&ctx, fips_plain, out);
+			PCUT_ASSERT_INT_EQUALS(0,
+			    memcmp(out, fips_cipher[k], AES_BLOCK_LENGTH));
+
+			aes_decrypt_block(&ctx, out, out);
+			PCUT_ASSERT_INT_EQUALS(0,
+			    memcmp(out, fips_plain, AES_BLOCK_LENGTH));
+		}
+	}
+}
+
+/** Legacy single block interface */
+PCUT_TEST(legacy)
+{
+	uint8_t key[AES_KEY_128];
+	uint8_t in[AES_BLOCK_LENGTH];
+	uint8_t out[AES_BLOCK_LENGTH];
+
+	memcpy(key, fips_key, AES_KEY_128);
+	memcpy(in, fips_plain, AES_BLOCK_LENGTH);
+
+	errno_t rc = aes_encrypt(key, in, out);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(out, fips_cipher[0], AES_BLOCK_LENGTH));
+
+	rc = aes_decrypt(key, out, in);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(in, fips_plain, AES_BLOCK_LENGTH));
+}
+
+/** Invalid key length */
+PCUT_TEST(key_length)
+{
+	aes_context_t ctx;
+
+	errno_t rc = aes_init(&ctx, fips_key, 20);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+}
+
+/** SP 800-38A CBC known answer, chained calls */
+PCUT_TEST(cbc)
+{
+	for (size_t i = 0; i < INIT_COUNT; i++) {
+		aes_context_t ctx;
+		uint8_t iv[AES_BLOCK_LENGTH];
+		uint8_t buf[64];
+
+		errno_t rc = inits[i](&ctx, sp_key, AES_KEY_128);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		memcpy(iv, fips_key, AES_BLOCK_LENGTH);
+		rc = aes_cbc_encrypt(&ctx, iv, sp_plain, buf, 16);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		rc = aes_cbc_encrypt(&ctx, iv, sp_plain + 16, buf + 16, 48);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, sp_cbc_cipher, 64));
+
+		/* Decrypt in place */
+		memcpy(iv, fips_key, AES_BLOCK_LENGTH);
+		rc = aes_cbc_decrypt(&ctx, iv, buf, buf, 64);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, sp_plain, 64));
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(iv, sp_cbc_cipher + 48,
+		    AES_BLOCK_LENGTH));
+
+		rc = aes_cbc_decrypt(&ctx, iv, buf, buf, 15);
+		PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+	}
+}
+
+/** SP 800-38A CTR known answer, partial blocks */
+PCUT_TEST(ctr)
+{
+	for (size_t i = 0; i < INIT_COUNT; i++) {
+		aes_context_t ctx;
+		uint8_t counter[AES_BLOCK_LENGTH];
+		uint8_t buf[64];
+
+		errno_t rc = inits[i](&ctx, sp_key, AES_KEY_128);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		memcpy(counter, sp_ctr_counter, AES_BLOCK_LENGTH);
+		aes_ctr_crypt(&ctx, counter, sp_plain, buf, 64);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, sp_ctr_cipher, 64));
+
+		/* The carry propagates into the upper bytes */
+		PCUT_ASSERT_INT_EQUALS(0xfd, counter[13]);
+		PCUT_ASSERT_INT_EQUALS(0xff, counter[14]);
+		PCUT_ASSERT_INT_EQUALS(0x03, counter[15]);
+
+		memcpy(counter, sp_ctr_counter, AES_BLOCK_LENGTH);
+		aes_ctr_crypt(&ctx, counter, sp_ctr_cipher, buf, 21);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, sp_plain, 21));
+	}
+}
+
+/** RFC 3610 CCM known answer and authentication failure */
+PCUT_TEST(ccm)
+{
+	for (size_t i = 0; i < INIT_COUNT; i++) {
+		aes_context_t ctx;
+		uint8_t buf[sizeof(ccm_plain)];
+		uint8_t tag[sizeof(ccm_tag)];
+
+		errno_t rc = inits[i](&ctx, ccm_key, AES_KEY_128);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		rc = aes_ccm_encrypt(&ctx, ccm_nonce, sizeof(ccm_nonce),
+		    ccm_aad, sizeof(ccm_aad), ccm_plain, buf, sizeof(ccm_plain),
+		    tag, sizeof(tag));
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, ccm_cipher, sizeof(buf)));
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(tag, ccm_tag, sizeof(tag)));
+
+		rc = aes_ccm_decrypt(&ctx, ccm_nonce, sizeof(ccm_nonce),
+		    ccm_aad, sizeof(ccm_aad), buf, buf, sizeof(buf), tag,
+		    sizeof(tag));
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, ccm_plain, sizeof(buf)));
+
+		tag[0] ^= 1;
+		rc = aes_ccm_decrypt(&ctx, ccm_nonce, sizeof(ccm_nonce),
+		    ccm_aad, sizeof(ccm_aad), ccm_cipher, buf, sizeof(buf), tag,
+		    sizeof(tag));
+		PCUT_ASSERT_ERRNO_VAL(EBADCHECKSUM, rc);
+
+		rc = aes_ccm_encrypt(&ctx, ccm_nonce, 6, ccm_aad,
+		    sizeof(ccm_aad), ccm_plain, buf, sizeof(ccm_plain), tag,
+		    sizeof(tag));
+		PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+	}
+}
+
+/** GCM specification known answers and authentication failure */
+PCUT_TEST(gcm)
+{
+	for (size_t i = 0; i < INIT_COUNT; i++) {
+		aes_context_t ctx;
+		uint8_t buf[sizeof(gcm_plain)];
+		uint8_t tag[sizeof(gcm_tag)];
+
+		errno_t rc = inits[i](&ctx, gcm_key, AES_KEY_128);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		rc = aes_gcm_encrypt(&ctx, gcm_iv, sizeof(gcm_iv), gcm_aad,
+		    sizeof(gcm_aad), gcm_plain, buf, sizeof(gcm_plain), tag,
+		    sizeof(tag));
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, gcm_cipher, sizeof(buf)));
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(tag, gcm_tag, sizeof(tag)));
+
+		rc = aes_gcm_decrypt(&ctx, gcm_iv, sizeof(gcm_iv), gcm_aad,
+		    sizeof(gcm_aad), buf, buf, sizeof(buf), tag, sizeof(tag));
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, gcm_plain, sizeof(buf)));
+
+		rc = aes_gcm_encrypt(&ctx, gcm_long_iv, sizeof(gcm_long_iv),
+		    gcm_aad, sizeof(gcm_aad), gcm_plain, buf, sizeof(gcm_plain),
+		    tag, sizeof(tag));
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(tag, gcm_long_iv_tag,
+		    sizeof(tag)));
+
+		memcpy(buf, gcm_cipher, sizeof(buf));
+		buf[10] ^= 0x80;
+		rc = aes_gcm_decrypt(&ctx, gcm_iv, sizeof(gcm_iv), gcm_aad,
+		    sizeof(gcm_aad), buf, buf, sizeof(buf), gcm_tag,
+		    sizeof(gcm_tag));
+		PCUT_ASSERT_ERRNO_VAL(EBADCHECKSUM, rc);
+	}
+}
+
+PCUT_EXPORT(aes);
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <str.h>
+#include "../crypto.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(hash);
+
+typedef errno_t (*hash_init_fn_t)(hash_ctx_t *, hash_func_t);
+
+/** Both the default and the portable implementation are tested. */
+static hash_init_fn_t inits[] = {
+	hash_init,
+	hash_init_generic
+};
+
+#define INIT_COUNT  (sizeof(inits) / sizeof(inits[0]))
+
+static const hash_func_t funcs[] = {
+	HASH_MD5,
+	HASH_SHA1,
+	HASH_SHA256,
+	HASH_SHA512
+};
+
+#define FUNC_COUNT  (sizeof(funcs) / sizeof(funcs[0]))
+
+/** Known answers for "abc", indexed as funcs. */
+static const char *abc_digests[] = {
+	"900150983cd24fb0d6963f7d28e17f72",
+	"a9993e364706816aba3e25717850c26c9cd0d89d",
+	"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+	"ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+	"2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"
+};
+
+/** Known answers for one million times "a", indexed as funcs. */
+static const char *million_a_digests[] = {
+	"7707d6ae4e027c70eea2a935c2296f21",
+	"34aa973cd4c4daa4f61eeb2bdbad27316534016f",
+	"cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+	"e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+	"de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b"
+};
+
+/** RFC 2202 and RFC 4231 test case 2, indexed as funcs. */
+static const char *hmac_digests[] = {
+	"750c783e6ab0b503eaa86e310a5db738",
+	"effcdf6ae5eb2fa2d27416d5f184df9c259a7c79",
+	"5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+	"164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+	"9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737"
+};
+
+/** Compare binary value with hexadecimal string.
+ *
+ * @param data Binary value.
+ * @param hex  Expected value as hexadecimal digits.
+ *
+ * @return True if equal.
+ *
+ */
+static bool hex_equal(const uint8_t *data, const char *hex)
+{
+	static const char digits[] = "0123456789abcdef";
+	size_t len = str_size(hex) / 2;
+
+	for (size_t i = 0; i < len; i++) {
+		if ((hex[2 * i] != digits[data[i] >> 4]) ||
+		    (hex[2 * i + 1] != digits[data[i] & 0xf]))
+			return false;
+	}
+
+	return true;
+}
+
+/** Known answers of all hash functions */
+PCUT_TEST(digest)
+{
+	for (size_t i = 0; i < INIT_COUNT; i++) {
+		for (size_t f = 0; f < FUNC_COUNT; f++) {
+			hash_ctx_t ctx;
+			uint8_t out[HASH_MAX_LENGTH];
+
+			errno_t rc = inits[i](&ctx, funcs[f]);
+			PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+			hash_update(&ctx, "abc", 3);
+			hash_final(&ctx, out);
+			PCUT_ASSERT_TRUE(hex_equal(out, abc_digests[f]));
+		}
+	}
+}
+
+/** Long message fed in pieces crossing block boundaries */
+PCUT_TEST(million)
+{
+	uint8_t *buf = malloc(1000);
+	PCUT_ASSERT_NOT_NULL(buf);
+	memset(buf, 'a', 1000);
+
+	for (size_t i = 0; i < INIT_COUNT; i++) {
+		for (size_t f = 0; f < FUNC_COUNT; f++) {
+			hash_ctx_t ctx;
+			uint8_t out[HASH_MAX_LENGTH];
+			size_t done = 0;
+			size_t chunk = 1;
+
+			errno_t rc = inits[i](&ctx, funcs[f]);
+			PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+			while (done < 1000000) {
+				size_t n = chunk;
+				if (n > 1000000 - done)
+					n = 1000000 - done;
+
+				hash_update(&ctx, buf, n);
+				done += n;
+				chunk = chunk % 977 + 13;
+			}
+
+			hash_final(&ctx, out);
+			PCUT_ASSERT_TRUE(hex_equal(out, million_a_digests[f]));
+		}
+	}
+
+	free(buf);
+}
+
+/** One-shot interface and invalid selector */
+PCUT_TEST(create_hash)
+{
+	uint8_t out[HASH_MAX_LENGTH];
+	hash_ctx_t ctx;
+
+	errno_t rc = create_hash((uint8_t *) "abc", 3, out, HASH_SHA256);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(hex_equal(out, abc_digests[2]));
+
+	rc = hash_init(&ctx, 24);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+}
+
+/** HMAC known answers, context reuse and long keys */
+PCUT_TEST(hmac)
+{
+	static const char *msg = "what do ya want for nothing?";
+	uint8_t out[HASH_MAX_LENGTH];
+
+	for (size_t f = 0; f < FUNC_COUNT; f++) {
+		hmac_ctx_t ctx;
+
+		errno_t rc = hmac_init(&ctx, (const uint8_t *) "Jefe", 4,
+		    funcs[f]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		/* The context is reusable after hmac_final() */
+		for (int round = 0; round < 2; round++) {
+			hmac_update(&ctx, msg, 10);
+			hmac_update(&ctx, msg + 10, str_size(msg) - 10);
+			hmac_final(&ctx, out);
+			PCUT_ASSERT_TRUE(hex_equal(out, hmac_digests[f]));
+		}
+
+		rc = hmac((uint8_t *) "Jefe", 4, (uint8_t *) msg,
+		    str_size(msg), out, funcs[f]);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		PCUT_ASSERT_TRUE(hex_equal(out, hmac_digests[f]));
+	}
+
+	/* RFC 4231 test case 6 */
+	uint8_t key[131];
+	memset(key, 0xaa, sizeof(key));
+	static const char *long_msg =
+	    "Test Using Larger Than Block-Size Key - Hash Key First";
+
+	errno_t rc = hmac(key, sizeof(key), (uint8_t *) long_msg,
+	    str_size(long_msg), out, HASH_SHA256);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(hex_equal(out, "60e431591ee0b67f0d8a26aacbf5b77f"
+	    "8e0bc6213728c5140546040f0ee37f54"));
+}
+
+/** IEEE 802.11i passphrase to PSK mapping */
+PCUT_TEST(pbkdf2)
+{
+	uint8_t out[PBKDF2_KEY_LENGTH];
+
+	errno_t rc = pbkdf2((uint8_t *) "password", 8, (uint8_t *) "IEEE", 4,
+	    out);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(hex_equal(out, "f42c6fc52df0ebef9ebb4b90b38a5f90"
+	    "2e83fe1b135a70e23aed762e9710a12e"));
+
+	rc = pbkdf2((uint8_t *) "ThisIsAPassword", 15,
+	    (uint8_t *) "ThisIsASSID", 11, out);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(hex_equal(out, "0dc0d6eb90555ed6419756b9a15ec3e3"
+	    "209b63df707dd508d14581f8982721af"));
+}
+
+PCUT_EXPORT(hash);
@@ -35,10 +35,14 @@
 
 #include <assert.h>
 #include <adt/list.h>
+#include <macros.h>
 #include <stdlib.h>
 
 #include "drawctx.h"
 
+/** Maximum number of pixels determined by the source at once */
+#define SPAN_LENGTH  256
+
 void drawctx_init(drawctx_t *context, surface_t *surface)
 {
 	assert(surface);
@@ -121,57 +125,82 @@ void drawctx_set_font(drawctx_t *context, font_t *font)
 	context->font = font;
 }
 
-void drawctx_transfer(drawctx_t *context,
+/** Transfer spans of source pixels to the surface.
+ *
+ * Each scanline is processed in chunks of up to SPAN_LENGTH pixels, which
+ * are determined by the source at once and then composed onto the surface
+ * by a span compositing function.
+ */
+static void drawctx_transfer_spans(drawctx_t *context,
     sysarg_t x, sysarg_t y, sysarg_t width, sysarg_t height)
 {
-	if (!context->source) {
+	pixelmap_t *pixmap = surface_pixmap_access(context->surface);
+	compose_span_t compose_span = compose_get_span(context->compose);
+	pixel_t span[SPAN_LENGTH];
+
+	/* Clip the area to the surface */
+	if (x >= pixmap->width || y >= pixmap->height)
 		return;
-	}
 
-	bool transfer_fast = source_is_fast(context->source) &&
-	    (context->shall_clip == false) &&
-	    (context->mask == NULL) &&
-	    (context->compose == compose_src || context->compose == compose_over);
+	width = min(width, pixmap->width - x);
+	height = min(height, pixmap->height - y);
 
-	if (transfer_fast) {
+	for (sysarg_t _y = y; _y < y + height; ++_y) {
+		pixel_t *dst = pixelmap_pixel_at(pixmap, x, _y);
 
-		for (sysarg_t _y = y; _y < y + height; ++_y) {
-			pixel_t *src = source_direct_access(context->source, x, _y);
-			pixel_t *dst = pixelmap_pixel_at(surface_pixmap_access(context->surface), x, _y);
-			if (src && dst) {
-				sysarg_t count = width;
-				while (count-- != 0) {
-					*dst++ = *src++;
+		for (sysarg_t off = 0; off < width; off += SPAN_LENGTH) {
+			size_t count = min(width - off, SPAN_LENGTH);
+			const pixel_t *src = source_span(context->source,
+			    x + off, _y, count, span);
+
+			if (compose_span != NULL) {
+				compose_span(dst + off, src, count);
+			} else {
+				for (size_t i = 0; i < count; i++) {
+					dst[off + i] = context->compose(src[i],
+					    dst[off + i]);
 				}
 			}
 		}
-		surface_add_damaged_region(context->surface, x, y, width, height);
+	}
 
-	} else {
+	surface_add_damaged_region(context->surface, x, y, width, height);
+}
 
-		bool clipped = false;
-		bool masked = false;
-		for (sysarg_t _y = y; _y < y + height; ++_y) {
-			for (sysarg_t _x = x; _x < x + width; ++_x) {
-				if (context->shall_clip) {
-					clipped = _x < context->clip_x && _x >= context->clip_width &&
-					    _y < context->clip_y && _y >= context->clip_height;
-				}
+void drawctx_transfer(drawctx_t *context,
+    sysarg_t x, sysarg_t y, sysarg_t width, sysarg_t height)
+{
+	if (!context->source) {
+		return;
+	}
 
-				if (context->mask) {
-					pixel_t p = surface_get_pixel(context->mask, _x, _y);
-					masked = p > 0 ? false : true;
-				}
+	if (context->shall_clip == false && context->mask == NULL) {
+		if (width > 0 && height > 0)
+			drawctx_transfer_spans(context, x, y, width, height);
+		return;
+	}
 
-				if (!clipped && !masked) {
-					pixel_t p_src = source_determine_pixel(context->source, _x, _y);
-					pixel_t p_dst = surface_get_pixel(context->surface, _x, _y);
-					pixel_t p_res = context->compose(p_src, p_dst);
-					surface_put_pixel(context->surface, _x, _y, p_res);
-				}
+	bool clipped = false;
+	bool masked = false;
+	for (sysarg_t _y = y; _y < y + height; ++_y) {
+		for (sysarg_t _x = x; _x < x + width; ++_x) {
+			if (context->shall_clip) {
+				clipped = _x < context->clip_x && _x >= context->clip_width &&
+				    _y < context->clip_y && _y >= context->clip_height;
+			}
+
+			if (context->mask) {
+				pixel_t p = surface_get_pixel(context->mask, _x, _y);
+				masked = p > 0 ? false : true;
 			}
-		}
 
+			if (!clipped && !masked) {
+				pixel_t p_src = source_determine_pixel(context->source, _x, _y);
+				pixel_t p_dst = surface_get_pixel(context->surface, _x, _y);
+				pixel_t p_res = context->compose(p_src, p_dst);
+				surface_put_pixel(context->surface, _x, _y, p_res);
+			}
+		}
 	}
 }
 
@@ -34,9 +34,156 @@
  */
 
 #include <assert.h>
+#include <mem.h>
 
 #include "source.h"
 
+/** Number of fractional bits of fixed-point texture coordinates */
+#define FIXED_SHIFT  16
+#define FIXED_ONE  (1 << FIXED_SHIFT)
+#define FIXED_HALF  (1 << (FIXED_SHIFT - 1))
+
+typedef int64_t fixed_t;
+
+static fixed_t double_to_fixed(double val)
+{
+	val *= FIXED_ONE;
+	return val > 0 ? (fixed_t) (val + 0.5) : (fixed_t) (val - 0.5);
+}
+
+/** Floor of fixed-point value as integer coordinate */
+static native_t fixed_floor(fixed_t val)
+{
+	return (native_t) (val >> FIXED_SHIFT);
+}
+
+/** Nearest integer coordinate to fixed-point value (halves away from zero) */
+static native_t fixed_round(fixed_t val)
+{
+	if (val < 0)
+		return -(native_t) ((-val + FIXED_HALF) >> FIXED_SHIFT);
+
+	return (native_t) ((val + FIXED_HALF) >> FIXED_SHIFT);
+}
+
+/** Get texture pixel, extending the texture if outside. */
+static inline pixel_t texel(pixelmap_t *pixmap, native_t x, native_t y,
+    pixelmap_extend_t extend)
+{
+	if (x >= 0 && (sysarg_t) x < pixmap->width &&
+	    y >= 0 && (sysarg_t) y < pixmap->height)
+		return pixmap->data[y * pixmap->width + x];
+
+	return pixelmap_get_extended_pixel(pixmap, x, y, extend);
+}
+
+/** Sample span of texture using nearest neighbour filter.
+ *
+ * Scanlines that stay on a single texture row (no rotation) are
+ * sampled from a fixed row.
+ */
+static void span_nearest(pixelmap_t *pixmap, pixelmap_extend_t extend,
+    fixed_t u, fixed_t v, fixed_t du, fixed_t dv, pixel_t *buf, size_t count)
+{
+	if (dv == 0) {
+		native_t y = fixed_round(v);
+		pixel_t *row = NULL;
+
+		if (y >= 0 && (sysarg_t) y < pixmap->height)
+			row = pixmap->data + y * pixmap->width;
+
+		for (size_t i = 0; i < count; i++) {
+			native_t x = fixed_round(u);
+
+			if (row != NULL && x >= 0 && (sysarg_t) x < pixmap->width)
+				buf[i] = row[x];
+			else
+				buf[i] = pixelmap_get_extended_pixel(pixmap, x, y,
+				    extend);
+			u += du;
+		}
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		buf[i] = texel(pixmap, fixed_round(u), fixed_round(v), extend);
+		u += du;
+		v += dv;
+	}
+}
+
+/** Interpolate between two pixels.
+ *
+ * Two channels are processed at once in each half of a 32-bit word.
+ *
+ * @param weight Weight of @a p2 in 1/256 units
+ */
+static inline pixel_t lerp(pixel_t p1, pixel_t p2, uint32_t weight)
+{
+	uint32_t rb1 = p1 & 0x00ff00ff;
+	uint32_t ag1 = (p1 >> 8) & 0x00ff00ff;
+	uint32_t rb2 = p2 & 0x00ff00ff;
+	uint32_t ag2 = (p2 >> 8) & 0x00ff00ff;
+
+	uint32_t rb = (rb1 * (256 - weight) + rb2 * weight) >> 8;
+	uint32_t ag = (ag1 * (256 - weight) + ag2 * weight) >> 8;
+
+	return (rb & 0x00ff00ff) | ((ag & 0x00ff00ff) << 8);
+}
+
+/** Sample span of texture using bilinear filter. */
+static void span_bilinear(pixelmap_t *pixmap, pixelmap_extend_t extend,
+    fixed_t u, fixed_t v, fixed_t du, fixed_t dv, pixel_t *buf, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		native_t x = fixed_floor(u);
+		native_t y = fixed_floor(v);
+		uint32_t fx = (u >> (FIXED_SHIFT - 8)) & 0xff;
+		uint32_t fy = (v >> (FIXED_SHIFT - 8)) & 0xff;
+
+		pixel_t p00, p10, p01, p11;
+
+		if (x >= 0 && (sysarg_t) x + 1 < pixmap->width &&
+		    y >= 0 && (sysarg_t) y + 1 < pixmap->height) {
+			pixel_t *p = pixmap->data + y * pixmap->width + x;
+
+			p00 = p[0];
+			p10 = p[1];
+			p01 = p[pixmap->width];
+			p11 = p[pixmap->width + 1];
+		} else {
+			p00 = texel(pixmap, x, y, extend);
+			p10 = texel(pixmap, x + 1, y, extend);
+			p01 = texel(pixmap, x, y + 1, extend);
+			p11 = texel(pixmap, x + 1, y + 1, extend);
+		}
+
+		if (fx == 0 && fy == 0)
+			buf[i] = p00;
+		else
+			buf[i] = lerp(lerp(p00, p10, fx), lerp(p01, p11, fx), fy);
+
+		u += du;
+		v += dv;
+	}
+}
+
+/** Sample span of texture by calling the filter for each pixel. */
+static void span_filter(source_t *source, pixelmap_t *pixmap, double x,
+    double y, pixel_t *buf, size_t count)
+{
+	double dx = source->transform.matrix[0][0];
+	double dy = source->transform.matrix[1][0];
+
+	transform_apply_affine(&source->transform, &x, &y);
+
+	for (size_t i = 0; i < count; i++) {
+		buf[i] = source->filter(pixmap, x, y, source->texture_extend);
+		x += dx;
+		y += dy;
+	}
+}
+
 void source_init(source_t *source)
 {
 	transform_identity(&source->transform);
@@ -148,5 +295,96 @@ pixel_t source_determine_pixel(source_t *source, double x, double y)
 	}
 }
 
+/** Determine span of pixels.
+ *
+ * The result is the same as of source_determine_pixel() called for each
+ * pixel of the span. The texture coordinates are stepped incrementally in
+ * fixed point and the nearest and bilinear filters are evaluated with
+ * integer arithmetic.
+ *
+ * @param source Source
+ * @param x      X coordinate of the first pixel
+ * @param y      Y coordinate of the span
+ * @param count  Number of pixels
+ * @param buf    Buffer for @a count pixels
+ *
+ * @return Pointer to the pixels, which is either @a buf or a pointer
+ *         directly into the texture
+ */
+const pixel_t *source_span(source_t *source, sysarg_t x, sysarg_t y,
+    size_t count, pixel_t *buf)
+{
+	if (source->mask != NULL) {
+		for (size_t i = 0; i < count; i++)
+			buf[i] = source_determine_pixel(source, x + i, y);
+		return buf;
+	}
+
+	uint32_t alpha = ALPHA(source->alpha);
+
+	if (source->texture == NULL || alpha == 0) {
+		pixel_t pixel = source_determine_pixel(source, x, y);
+		for (size_t i = 0; i < count; i++)
+			buf[i] = pixel;
+		return buf;
+	}
+
+	pixelmap_t *pixmap = surface_pixmap_access(source->texture);
+	transform_t *trans = &source->transform;
+
+	if (transform_is_fast(trans)) {
+		/* Integer translation */
+		native_t tx = (native_t) x + (native_t) trans->matrix[0][2];
+		native_t ty = (native_t) y + (native_t) trans->matrix[1][2];
+
+		if (tx >= 0 && (sysarg_t) tx + count <= pixmap->width &&
+		    ty >= 0 && (sysarg_t) ty < pixmap->height) {
+			pixel_t *row = pixmap->data + ty * pixmap->width + tx;
+			if (alpha == 255)
+				return row;
+
+			memcpy(buf, row, count * sizeof(pixel_t));
+		} else {
+			for (size_t i = 0; i < count; i++) {
+				buf[i] = pixelmap_get_extended_pixel(pixmap,
+				    tx + i, ty, source->texture_extend);
+			}
+		}
+	} else if (source->filter == filter_nearest ||
+	    source->filter == filter_bilinear) {
+		double u = x;
+		double v = y;
+
+		transform_apply_affine(trans, &u, &v);
+
+		fixed_t fu = double_to_fixed(u);
+		fixed_t fv = double_to_fixed(v);
+		fixed_t du = double_to_fixed(trans->matrix[0][0]);
+		fixed_t dv = double_to_fixed(trans->matrix[1][0]);
+
+		if (source->filter == filter_nearest) {
+			span_nearest(pixmap, source->texture_extend, fu, fv,
+			    du, dv, buf, count);
+		} else {
+			span_bilinear(pixmap, source->texture_extend, fu, fv,
+			    du, dv, buf, count);
+		}
+	} else {
+		span_filter(source, pixmap, x, y, buf, count);
+	}
+
+	if (alpha < 255) {
+		for (size_t i = 0; i < count; i++) {
+			uint32_t a = ALPHA(buf[i]) * alpha;
+
+			/* Exact a / 255 for a <= 255 * 255 */
+			a = (a + 1 + (a >> 8)) >> 8;
+			buf[i] = (buf[i] & 0x00ffffff) | (a << 24);
+		}
+	}
+
+	return buf;
+}
+
 /** @}
  */
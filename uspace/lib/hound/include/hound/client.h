@@ -70,6 +70,8 @@ void hound_stream_destroy(hound_stream_t *stream);
 errno_t hound_stream_write(hound_stream_t *stream, const void *data, size_t size);
 errno_t hound_stream_read(hound_stream_t *stream, void *data, size_t size);
 errno_t hound_stream_drain(hound_stream_t *stream);
+errno_t hound_stream_get_stats(hound_stream_t *stream,
+    hound_stream_stats_t *stats);
 
 errno_t hound_write_main_stream(hound_context_t *hound,
     const void *data, size_t size);
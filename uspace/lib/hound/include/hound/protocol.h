@@ -39,6 +39,8 @@
 #include <async.h>
 #include <errno.h>
 #include <pcm/format.h>
+#include <stdatomic.h>
+#include <stdint.h>
 
 extern const char *HOUND_SERVICE;
 
@@ -52,8 +54,39 @@ typedef enum {
 	HOUND_STREAM_DRAIN_ON_EXIT = 0x1,
 	HOUND_STREAM_IGNORE_UNDERFLOW = 0x2,
 	HOUND_STREAM_IGNORE_OVERFLOW = 0x4,
+	HOUND_STREAM_SHARED = 0x8,
 } hound_flags_t;
 
+/** Shared memory ring of a playback stream.
+ *
+ * Single producer (client), single consumer (server). Both indices are
+ * running byte counts, the position in @c data is the count modulo
+ * @c size. The client advances @c write after storing data, the server
+ * advances @c read after mixing it.
+ */
+typedef struct {
+	/** Bytes written by the client */
+	atomic_size_t write;
+	/** Bytes consumed by the server */
+	atomic_size_t read;
+	/** Size of the data area, multiple of the stream frame size */
+	size_t size;
+	/** Audio data */
+	uint8_t data[];
+} hound_ring_t;
+
+/** Stream latency statistics */
+typedef struct {
+	/** Bytes buffered on the server side, including the shared ring */
+	size_t buffered;
+	/** Server side buffer capacity */
+	size_t capacity;
+	/** Playback time of the buffered data */
+	usec_t latency;
+	/** Number of mixing periods the stream could not fill */
+	size_t xruns;
+} hound_stream_stats_t;
+
 typedef async_sess_t hound_sess_t;
 
 typedef struct {
@@ -96,6 +129,11 @@ errno_t hound_service_stream_exit(async_exch_t *exch);
 errno_t hound_service_stream_write(async_exch_t *exch, const void *data, size_t size);
 errno_t hound_service_stream_read(async_exch_t *exch, void *data, size_t size);
 
+errno_t hound_service_stream_share(async_exch_t *exch, hound_ring_t *ring);
+errno_t hound_service_stream_wait(async_exch_t *exch, size_t fill);
+errno_t hound_service_stream_stats(async_exch_t *exch,
+    hound_stream_stats_t *stats);
+
 /* Server */
 
 /** Hound server interace structure */
@@ -123,6 +161,12 @@ typedef struct hound_server_iface {
 	errno_t (*stream_data_write)(void *, void *, size_t);
 	/** Read data from the stream */
 	errno_t (*stream_data_read)(void *, void *, size_t);
+	/** Use shared ring of the given area size for stream data */
+	errno_t (*stream_share)(void *, hound_ring_t *, size_t);
+	/** Block until the shared ring holds at most given number of bytes */
+	errno_t (*stream_wait)(void *, size_t);
+	/** Get stream latency statistics */
+	errno_t (*stream_stats)(void *, hound_stream_stats_t *);
 	void *server;
 } hound_server_iface_t;
 
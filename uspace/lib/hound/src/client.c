@@ -34,9 +34,12 @@
  * Common USB functions.
  */
 #include <adt/list.h>
+#include <as.h>
 #include <errno.h>
 #include <inttypes.h>
 #include <loc.h>
+#include <macros.h>
+#include <mem.h>
 #include <str.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -58,6 +61,8 @@ struct hound_stream {
 	hound_context_t *context;
 	/** Stream flags */
 	int flags;
+	/** Ring shared with the server, NULL if data are sent by IPC */
+	hound_ring_t *ring;
 };
 
 /**
@@ -282,6 +287,35 @@ errno_t hound_context_disconnect_target(hound_context_t *hound, const char *targ
 	}
 }
 
+/**
+ * Set up shared ring for stream data.
+ * @param stream Playback stream.
+ * @param bsize Requested ring size in bytes.
+ *
+ * The stream keeps using IPC data writes if the ring cannot be created.
+ */
+static void hound_stream_share(hound_stream_t *stream, size_t bsize)
+{
+	const size_t size = bsize - bsize % pcm_format_frame_size(&stream->format);
+	if (size == 0)
+		return;
+
+	hound_ring_t *ring = as_area_create(AS_AREA_ANY,
+	    sizeof(hound_ring_t) + size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (ring == AS_MAP_FAILED)
+		return;
+
+	atomic_init(&ring->write, 0);
+	atomic_init(&ring->read, 0);
+	ring->size = size;
+	if (hound_service_stream_share(stream->exch, ring) != EOK) {
+		as_area_destroy(ring);
+		return;
+	}
+	stream->ring = ring;
+}
+
 /**
  * Create a new stream associated with the context.
  * @param hound Hound context.
@@ -289,6 +323,10 @@ errno_t hound_context_disconnect_target(hound_context_t *hound, const char *targ
  * @param format new stream PCM format.
  * @param bzise new stream server side buffer size (in bytes)
  * @return Valid pointer to a stream instance, NULL on failure.
+ *
+ * Playback streams created with HOUND_STREAM_SHARED pass data through
+ * a ring of @p bsize bytes shared with the server, which avoids IPC and
+ * allocations for every write.
  */
 hound_stream_t *hound_stream_create(hound_context_t *hound, unsigned flags,
     pcm_format_t format, size_t bsize)
@@ -304,6 +342,7 @@ hound_stream_t *hound_stream_create(hound_context_t *hound, unsigned flags,
 		new_stream->format = format;
 		new_stream->context = hound;
 		new_stream->flags = flags;
+		new_stream->ring = NULL;
 		const errno_t ret = hound_service_stream_enter(new_stream->exch,
 		    hound->id, flags, format, bsize);
 		if (ret != EOK) {
@@ -311,6 +350,8 @@ hound_stream_t *hound_stream_create(hound_context_t *hound, unsigned flags,
 			free(new_stream);
 			return NULL;
 		}
+		if ((flags & HOUND_STREAM_SHARED) && !hound->record)
+			hound_stream_share(new_stream, bsize);
 		list_append(&new_stream->link, &hound->stream_list);
 	}
 	return new_stream;
@@ -330,11 +371,57 @@ void hound_stream_destroy(hound_stream_t *stream)
 			hound_service_stream_drain(stream->exch);
 		hound_service_stream_exit(stream->exch);
 		async_exchange_end(stream->exch);
+		if (stream->ring)
+			as_area_destroy(stream->ring);
 		list_remove(&stream->link);
 		free(stream);
 	}
 }
 
+/**
+ * Copy data to the shared ring of a stream.
+ * @param stream The target stream
+ * @param data data buffer
+ * @param size size of the @p data buffer.
+ * @return error code.
+ *
+ * Blocks in the server only when the ring is full, until half of the ring
+ * is free or the stream underruns.
+ */
+static errno_t hound_stream_write_ring(hound_stream_t *stream,
+    const void *data, size_t size)
+{
+	hound_ring_t *ring = stream->ring;
+	const uint8_t *src = data;
+
+	while (size > 0) {
+		const size_t write =
+		    atomic_load_explicit(&ring->write, memory_order_relaxed);
+		const size_t read =
+		    atomic_load_explicit(&ring->read, memory_order_acquire);
+		const size_t space = ring->size - (write - read);
+
+		if (space == 0) {
+			const errno_t ret = hound_service_stream_wait(
+			    stream->exch, ring->size - min(size, ring->size / 2));
+			if (ret != EOK)
+				return ret;
+			continue;
+		}
+
+		const size_t count = min(size, space);
+		const size_t pos = write % ring->size;
+		const size_t first = min(count, ring->size - pos);
+		memcpy(ring->data + pos, src, first);
+		memcpy(ring->data, src + first, count - first);
+		atomic_store_explicit(&ring->write, write + count,
+		    memory_order_release);
+		src += count;
+		size -= count;
+	}
+	return EOK;
+}
+
 /**
  * Send new data to a stream.
  * @param stream The target stream
@@ -347,6 +434,8 @@ errno_t hound_stream_write(hound_stream_t *stream, const void *data, size_t size
 	assert(stream);
 	if (!data || size == 0)
 		return EBADMEM;
+	if (stream->ring)
+		return hound_stream_write_ring(stream, data, size);
 	return hound_service_stream_write(stream->exch, data, size);
 }
 
@@ -376,6 +465,20 @@ errno_t hound_stream_drain(hound_stream_t *stream)
 	return hound_service_stream_drain(stream->exch);
 }
 
+/**
+ * Query buffer fill, latency and underruns of a stream.
+ * @param stream The stream.
+ * @param stats Place to store the statistics.
+ * @return Error code.
+ */
+errno_t hound_stream_get_stats(hound_stream_t *stream,
+    hound_stream_stats_t *stats)
+{
+	assert(stream);
+	assert(stats);
+	return hound_service_stream_stats(stream->exch, stats);
+}
+
 /**
  * Main stream getter function.
  * @param hound Houndcontext.
@@ -389,8 +492,8 @@ static hound_stream_t *hound_get_main_stream(hound_context_t *hound)
 	assert(hound);
 	if (!hound->main.stream)
 		hound->main.stream = hound_stream_create(hound,
-		    HOUND_STREAM_DRAIN_ON_EXIT, hound->main.format,
-		    hound->main.bsize);
+		    HOUND_STREAM_DRAIN_ON_EXIT | HOUND_STREAM_SHARED,
+		    hound->main.format, hound->main.bsize);
 	return hound->main.stream;
 }
 
@@ -33,7 +33,9 @@
 /** @file
  * Common USB functions.
  */
+#include <abi/ipc/methods.h>
 #include <adt/list.h>
+#include <as.h>
 #include <errno.h>
 #include <loc.h>
 #include <macros.h>
@@ -64,6 +66,12 @@ enum ipc_methods {
 	IPC_M_HOUND_STREAM_EXIT,
 	/** Wait until there is no data in the stream */
 	IPC_M_HOUND_STREAM_DRAIN,
+	/** Share ring buffer for stream data */
+	IPC_M_HOUND_STREAM_SHARE,
+	/** Wait until the shared ring drops below a threshold */
+	IPC_M_HOUND_STREAM_WAIT,
+	/** Query stream latency statistics */
+	IPC_M_HOUND_STREAM_STATS,
 };
 
 /** PCM format conversion helper structure */
@@ -362,12 +370,65 @@ errno_t hound_service_stream_read(async_exch_t *exch, void *data, size_t size)
 	return async_data_read_start(exch, data, size);
 }
 
+/**
+ * Pass stream data through a shared ring instead of data writes.
+ * @param exch IPC exchange in STREAM MODE.
+ * @param ring Initialized ring in a shareable address space area.
+ * @return Error code.
+ */
+errno_t hound_service_stream_share(async_exch_t *exch, hound_ring_t *ring)
+{
+	ipc_call_t answer;
+	aid_t req = async_send_0(exch, IPC_M_HOUND_STREAM_SHARE, &answer);
+	const errno_t rc = async_share_out_start(exch, ring,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE);
+
+	errno_t ret;
+	async_wait_for(req, &ret);
+	return rc != EOK ? rc : ret;
+}
+
+/**
+ * Wait until the shared ring holds at most @p fill bytes.
+ * @param exch IPC exchange in STREAM MODE.
+ * @param fill Threshold in bytes.
+ * @return Error code.
+ *
+ * Returns early if the stream underruns.
+ */
+errno_t hound_service_stream_wait(async_exch_t *exch, size_t fill)
+{
+	return async_req_1_0(exch, IPC_M_HOUND_STREAM_WAIT, fill);
+}
+
+/**
+ * Query stream latency statistics.
+ * @param exch IPC exchange in STREAM MODE.
+ * @param stats Place to store the statistics.
+ * @return Error code.
+ */
+errno_t hound_service_stream_stats(async_exch_t *exch,
+    hound_stream_stats_t *stats)
+{
+	sysarg_t buffered, capacity, latency, xruns;
+	const errno_t ret = async_req_0_4(exch, IPC_M_HOUND_STREAM_STATS,
+	    &buffered, &capacity, &latency, &xruns);
+	if (ret == EOK) {
+		stats->buffered = buffered;
+		stats->capacity = capacity;
+		stats->latency = latency;
+		stats->xruns = xruns;
+	}
+	return ret;
+}
+
 /*
  * SERVER
  */
 
 static void hound_server_read_data(void *stream);
 static void hound_server_write_data(void *stream);
+static bool hound_server_stream_ctl(void *stream, ipc_call_t *call);
 static const hound_server_iface_t *server_iface;
 
 /**
@@ -610,7 +671,10 @@ void hound_connection_handler(ipc_call_t *icall, void *arg)
 			break;
 		case IPC_M_HOUND_STREAM_EXIT:
 		case IPC_M_HOUND_STREAM_DRAIN:
-			/* Stream exit/drain is only allowed in stream context*/
+		case IPC_M_HOUND_STREAM_SHARE:
+		case IPC_M_HOUND_STREAM_WAIT:
+		case IPC_M_HOUND_STREAM_STATS:
+			/* Stream calls are only allowed in stream context */
 			async_answer_0(&call, EINVAL);
 			break;
 		default:
@@ -627,6 +691,80 @@ void hound_connection_handler(ipc_call_t *icall, void *arg)
 	}
 }
 
+/**
+ * Receive shared ring of a stream.
+ * @param stream Target stream.
+ * @param call The share request.
+ */
+static void hound_server_share_ring(void *stream, ipc_call_t *call)
+{
+	ipc_call_t share;
+	size_t size;
+	unsigned int flags;
+	void *area;
+
+	if (!async_share_out_receive(&share, &size, &flags)) {
+		async_answer_0(call, EINVAL);
+		return;
+	}
+	if (!server_iface->stream_share) {
+		async_answer_0(&share, ENOTSUP);
+		async_answer_0(call, ENOTSUP);
+		return;
+	}
+
+	errno_t ret = async_share_out_finalize(&share, &area);
+	if (ret == EOK && area == AS_MAP_FAILED)
+		ret = ENOMEM;
+	if (ret == EOK) {
+		ret = server_iface->stream_share(stream, area, size);
+		if (ret != EOK)
+			as_area_destroy(area);
+	}
+	async_answer_0(call, ret);
+}
+
+/**
+ * Handle stream mode calls other than data transfers.
+ * @param stream Target stream.
+ * @param call The call.
+ * @return True if the call was answered, false if it ends the stream mode.
+ */
+static bool hound_server_stream_ctl(void *stream, ipc_call_t *call)
+{
+	hound_stream_stats_t stats;
+	errno_t ret = ENOTSUP;
+
+	switch (IPC_GET_IMETHOD(*call)) {
+	case IPC_M_HOUND_STREAM_DRAIN:
+		if (server_iface->drain_stream)
+			ret = server_iface->drain_stream(stream);
+		async_answer_0(call, ret);
+		return true;
+	case IPC_M_HOUND_STREAM_SHARE:
+		hound_server_share_ring(stream, call);
+		return true;
+	case IPC_M_HOUND_STREAM_WAIT:
+		if (server_iface->stream_wait)
+			ret = server_iface->stream_wait(stream,
+			    IPC_GET_ARG1(*call));
+		async_answer_0(call, ret);
+		return true;
+	case IPC_M_HOUND_STREAM_STATS:
+		if (server_iface->stream_stats)
+			ret = server_iface->stream_stats(stream, &stats);
+		if (ret == EOK) {
+			async_answer_4(call, EOK, stats.buffered,
+			    stats.capacity, stats.latency, stats.xruns);
+		} else {
+			async_answer_0(call, ret);
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
 /**
  * Read data and push it to the stream.
  * @param stream target stream, will push data there.
@@ -637,17 +775,11 @@ static void hound_server_read_data(void *stream)
 	size_t size = 0;
 	errno_t ret_answer = EOK;
 
-	/* accept data write or drain */
+	/* accept data write or stream control */
 	while (async_data_write_receive(&call, &size) ||
-	    (IPC_GET_IMETHOD(call) == IPC_M_HOUND_STREAM_DRAIN)) {
-		/* check drain first */
-		if (IPC_GET_IMETHOD(call) == IPC_M_HOUND_STREAM_DRAIN) {
-			errno_t ret = ENOTSUP;
-			if (server_iface->drain_stream)
-				ret = server_iface->drain_stream(stream);
-			async_answer_0(&call, ret);
+	    hound_server_stream_ctl(stream, &call)) {
+		if (IPC_GET_IMETHOD(call) != IPC_M_DATA_WRITE)
 			continue;
-		}
 
 		/* there was an error last time */
 		if (ret_answer != EOK) {
@@ -684,17 +816,12 @@ static void hound_server_write_data(void *stream)
 	size_t size = 0;
 	errno_t ret_answer = EOK;
 
-	/* accept data read and drain */
+	/* accept data read and stream control */
 	while (async_data_read_receive(&call, &size) ||
-	    (IPC_GET_IMETHOD(call) == IPC_M_HOUND_STREAM_DRAIN)) {
-		/* drain does not make much sense but it is allowed */
-		if (IPC_GET_IMETHOD(call) == IPC_M_HOUND_STREAM_DRAIN) {
-			errno_t ret = ENOTSUP;
-			if (server_iface->drain_stream)
-				ret = server_iface->drain_stream(stream);
-			async_answer_0(&call, ret);
+	    hound_server_stream_ctl(stream, &call)) {
+		if (IPC_GET_IMETHOD(call) != IPC_M_DATA_READ)
 			continue;
-		}
+
 		/* there was an error last time */
 		if (ret_answer != EOK) {
 			async_answer_0(&call, ret_answer);
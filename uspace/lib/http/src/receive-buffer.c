@@ -144,35 +144,55 @@ errno_t recv_cut_str(receive_buffer_t *rb, receive_buffer_mark_t *a, receive_buf
 	return EOK;
 }
 
-/** Receive one character (with buffering) */
-errno_t recv_char(receive_buffer_t *rb, char *c, bool consume)
+/** Receive more data into the buffer.
+ *
+ * Space is reclaimed by discarding data that was already consumed
+ * and that is not protected by a mark.
+ *
+ * @param rb Receive buffer.
+ * @return EOK on success, ELIMIT if the buffer is full of unconsumed
+ *         or marked data, EIO if the peer closed the connection or
+ *         an error code of the receive function.
+ */
+static errno_t recv_fill(receive_buffer_t *rb)
 {
-	if (rb->out == rb->in) {
-		size_t free = rb->size - rb->in;
-		if (free == 0) {
-			size_t min_mark = rb->size;
-			list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
-				min_mark = min(min_mark, mark->offset);
-			}
-
-			if (min_mark == 0)
-				return ELIMIT;
+	size_t min_mark = rb->out;
+	list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
+		min_mark = min(min_mark, mark->offset);
+	}
 
-			size_t new_in = rb->in - min_mark;
-			memmove(rb->buffer, rb->buffer + min_mark, new_in);
-			rb->out = rb->in = new_in;
-			free = rb->size - rb->in;
-			list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
-				mark->offset -= min_mark;
-			}
+	if ((min_mark > 0) && ((rb->in == rb->size) || (min_mark == rb->in))) {
+		memmove(rb->buffer, rb->buffer + min_mark, rb->in - min_mark);
+		rb->in -= min_mark;
+		rb->out -= min_mark;
+		list_foreach(rb->marks, link, receive_buffer_mark_t, mark) {
+			mark->offset -= min_mark;
 		}
+	}
+
+	if (rb->in == rb->size)
+		return ELIMIT;
+
+	size_t nrecv;
+	errno_t rc = rb->receive(rb->client_data, rb->buffer + rb->in,
+	    rb->size - rb->in, &nrecv);
+	if (rc != EOK)
+		return rc;
 
-		size_t nrecv;
-		errno_t rc = rb->receive(rb->client_data, rb->buffer + rb->in, free, &nrecv);
+	if (nrecv == 0)
+		return EIO;
+
+	rb->in += nrecv;
+	return EOK;
+}
+
+/** Receive one character (with buffering) */
+errno_t recv_char(receive_buffer_t *rb, char *c, bool consume)
+{
+	if (rb->out == rb->in) {
+		errno_t rc = recv_fill(rb);
 		if (rc != EOK)
 			return rc;
-
-		rb->in = nrecv;
 	}
 
 	*c = rb->buffer[rb->out];
@@ -289,37 +309,65 @@ errno_t recv_eol(receive_buffer_t *rb, size_t *nrecv)
 	return EOK;
 }
 
-/* Receive a single line */
+/** Receive a single line
+ *
+ * The buffered data is scanned for the end of line in bulk rather
+ * than character by character.
+ *
+ * @param line  Buffer for the line without the end of line
+ * @param size  Size of @a line including the terminating null character
+ * @param nrecv Place to store the length of the line including
+ *              the terminating null character
+ * @return EOK on success, ELIMIT if the line does not fit into @a line
+ *         or an error code
+ */
 errno_t recv_line(receive_buffer_t *rb, char *line, size_t size, size_t *nrecv)
 {
 	size_t written = 0;
 	size_t nr;
 
-	while (written < size) {
-		char c = 0;
-		errno_t rc = recv_char(rb, &c, true);
-		if (rc != EOK)
-			return rc;
-		if (c == '\n') {
-			rc = recv_discard(rb, '\r', &nr);
+	while (true) {
+		if (rb->out == rb->in) {
+			errno_t rc = recv_fill(rb);
 			if (rc != EOK)
 				return rc;
+		}
+
+		const char *start = rb->buffer + rb->out;
+		size_t avail = rb->in - rb->out;
+		size_t n = 0;
+
+		while ((n < avail) && (start[n] != '\n') && (start[n] != '\r'))
+			n++;
+
+		if (written + n >= size)
+			return ELIMIT;
+
+		memcpy(line + written, start, n);
+		written += n;
+		rb->out += n;
+
+		if (n < avail) {
+			char c = rb->buffer[rb->out++];
+
+			if (c == '\r') {
+				errno_t rc = recv_discard(rb, '\n', &nr);
+				if (rc != EOK)
+					return rc;
+			} else if ((rb->out < rb->in) &&
+			    (rb->buffer[rb->out] == '\r')) {
+				/*
+				 * Do not wait for more data after LF, the peer
+				 * may be waiting for our response.
+				 */
+				rb->out++;
+			}
 
-			line[written++] = 0;
-			*nrecv = written;
-			return EOK;
-		} else if (c == '\r') {
-			rc = recv_discard(rb, '\n', &nr);
-			if (rc != EOK)
-				return rc;
 			line[written++] = 0;
 			*nrecv = written;
 			return EOK;
 		}
-		line[written++] = c;
 	}
-
-	return ELIMIT;
 }
 
 /** @}
@@ -199,10 +199,15 @@ errno_t ieee80211_prf(uint8_t *key, uint8_t *data, uint8_t *hash,
 	memcpy(work_arr, a, str_size(a));
 	memcpy(work_arr + str_size(a) + 1, data, PRF_CRYPT_DATA_LENGTH);
 
+	hmac_ctx_t ctx;
+	errno_t rc = hmac_init(&ctx, key, PBKDF2_KEY_LENGTH, HASH_SHA1);
+	if (rc != EOK)
+		return rc;
+
 	for (uint8_t i = 0; i < iters; i++) {
 		memcpy(work_arr + data_size - 1, &i, 1);
-		hmac(key, PBKDF2_KEY_LENGTH, work_arr, data_size, temp,
-		    HASH_SHA1);
+		hmac_update(&ctx, work_arr, data_size);
+		hmac_final(&ctx, temp);
 		memcpy(result + i * HASH_SHA1, temp, HASH_SHA1);
 	}
 
@@ -232,6 +237,11 @@ errno_t ieee80211_aes_key_unwrap(uint8_t *kek, uint8_t *data, size_t data_size,
 	uint8_t work_output[AES_CIPHER_LENGTH];
 	uint8_t *work_block;
 	uint8_t a[8];
+	aes_context_t ctx;
+
+	errno_t rc = aes_init(&ctx, kek, AES_KEY_128);
+	if (rc != EOK)
+		return rc;
 
 	memcpy(a, data, 8);
 
@@ -250,7 +260,7 @@ errno_t ieee80211_aes_key_unwrap(uint8_t *kek, uint8_t *data, size_t data_size,
 			work_block = work_data + (i - 1) * 8;
 			memcpy(work_input, a, 8);
 			memcpy(work_input + 8, work_block, 8);
-			aes_decrypt(kek, work_input, work_output);
+			aes_decrypt_block(&ctx, work_input, work_output);
 			memcpy(a, work_output, 8);
 			memcpy(work_data + (i - 1) * 8, work_output + 8, 8);
 		}
@@ -102,6 +102,10 @@ errno_t pcm_format_convert_and_mix(void *dst, size_t dst_size, const void *src,
 errno_t pcm_format_mix(void *dst, const void *src, size_t size, const pcm_format_t *f);
 errno_t pcm_format_convert(pcm_format_t a, void *srca, size_t sizea,
     pcm_format_t b, void *srcb, size_t *sizeb);
+errno_t pcm_format_to_float(const void *src, size_t frames,
+    const pcm_format_t *f, float *dst, unsigned channels);
+errno_t pcm_format_mix_float(void *dst, const float *src, size_t frames,
+    const pcm_format_t *f);
 
 #endif
 
@@ -37,20 +37,38 @@
 #include <byteorder.h>
 #include <errno.h>
 #include <macros.h>
-#include <stdio.h>
-#include <inttypes.h>
+#include <mem.h>
+#include <stdint.h>
 
 #include "format.h"
 
-// TODO float endian?
-#define float_le2host(x) (x)
-#define float_be2host(x) (x)
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define PCM_SSE2
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__LE__)
+#include <arm_neon.h>
+#define PCM_NEON
+#endif
 
-#define host2float_le(x) (x)
-#define host2float_be(x) (x)
+/** Number of samples converted at once when formats differ */
+#define PCM_CHUNK_SAMPLES  256
 
-#define from(x, type, endian) (float)(type ## _ ## endian ## 2host(x))
-#define to(x, type, endian) (float)(host2 ## type ## _ ## endian(x))
+/** Magnitude of the full scale of a @a bits wide integer sample */
+#define PCM_FULL(bits)  ((float) (UINT32_C(1) << ((bits) - 1)))
+
+/** Convert samples of a format to normalized float <-1,1> */
+typedef void (*pcm_load_t)(const void *src, float *dst, size_t count);
+/** Mix normalized float samples into samples of a format */
+typedef void (*pcm_mix_t)(void *dst, const float *src, size_t count);
+/** Mix samples of a format into samples of the same format */
+typedef void (*pcm_add_t)(void *dst, const void *src, size_t count);
+
+/** Conversion and mixing kernels of a sample format */
+typedef struct {
+	pcm_load_t load;
+	pcm_mix_t mix;
+	pcm_add_t add;
+} pcm_kernels_t;
 
 /** Default linear PCM format */
 const pcm_format_t AUDIO_FORMAT_DEFAULT = {
@@ -68,8 +86,434 @@ const pcm_format_t AUDIO_FORMAT_ANY = {
 	.sample_format = 0,
 };
 
-static float get_normalized_sample(const void *buffer, size_t size,
-    unsigned frame, unsigned channel, const pcm_format_t *f);
+/**
+ * Scale normalized sample to integer sample range.
+ * @param f Normalized sample, values outside <-2,2> are clipped.
+ * @param full Magnitude of the integer full scale.
+ * @return Rounded integer sample.
+ */
+static inline int64_t pcm_float_to_int(float f, float full)
+{
+	if (f >= 2.0f)
+		f = 2.0f;
+	else if (f <= -2.0f)
+		f = -2.0f;
+	else if (f != f)
+		f = 0.0f;
+	f *= full;
+	return (int64_t) (f < 0.0f ? f - 0.5f : f + 0.5f);
+}
+
+/**
+ * Saturate integer sample.
+ * @param v Sample value.
+ * @param bits Sample width.
+ * @return @p v clamped to the range of a signed @p bits wide integer.
+ */
+static inline int32_t pcm_clamp(int64_t v, unsigned bits)
+{
+	const int64_t max = (INT64_C(1) << (bits - 1)) - 1;
+	if (v > max)
+		return max;
+	if (v < -max - 1)
+		return -max - 1;
+	return v;
+}
+
+/*
+ * Sample codecs. Decoders produce signed values centered at zero,
+ * encoders take values in the range of the respective width.
+ */
+#define DEC_U8(x)  ((int32_t) (x) - 0x80)
+#define ENC_U8(v)  ((uint8_t) ((v) + 0x80))
+#define DEC_S8(x)  ((int32_t) (int8_t) (x))
+#define ENC_S8(v)  ((uint8_t) (v))
+#define DEC_U16LE(x)  ((int32_t) uint16_t_le2host(x) - 0x8000)
+#define ENC_U16LE(v)  host2uint16_t_le((uint16_t) ((v) + 0x8000))
+#define DEC_S16LE(x)  ((int32_t) (int16_t) uint16_t_le2host(x))
+#define ENC_S16LE(v)  host2uint16_t_le((uint16_t) (v))
+#define DEC_U16BE(x)  ((int32_t) uint16_t_be2host(x) - 0x8000)
+#define ENC_U16BE(v)  host2uint16_t_be((uint16_t) ((v) + 0x8000))
+#define DEC_S16BE(x)  ((int32_t) (int16_t) uint16_t_be2host(x))
+#define ENC_S16BE(v)  host2uint16_t_be((uint16_t) (v))
+#define DEC_U24_32LE(x)  ((int32_t) (uint32_t_le2host(x) & 0xffffff) - 0x800000)
+#define ENC_U24_32LE(v)  host2uint32_t_le((uint32_t) ((v) + 0x800000))
+#define DEC_S24_32LE(x)  ((int32_t) (uint32_t_le2host(x) << 8) >> 8)
+#define ENC_S24_32LE(v)  host2uint32_t_le((uint32_t) (v))
+#define DEC_U24_32BE(x)  ((int32_t) (uint32_t_be2host(x) & 0xffffff) - 0x800000)
+#define ENC_U24_32BE(v)  host2uint32_t_be((uint32_t) ((v) + 0x800000))
+#define DEC_S24_32BE(x)  ((int32_t) (uint32_t_be2host(x) << 8) >> 8)
+#define ENC_S24_32BE(v)  host2uint32_t_be((uint32_t) (v))
+#define DEC_U32LE(x)  ((int32_t) (uint32_t_le2host(x) ^ 0x80000000))
+#define ENC_U32LE(v)  host2uint32_t_le((uint32_t) (v) ^ 0x80000000)
+#define DEC_S32LE(x)  ((int32_t) uint32_t_le2host(x))
+#define ENC_S32LE(v)  host2uint32_t_le((uint32_t) (v))
+#define DEC_U32BE(x)  ((int32_t) (uint32_t_be2host(x) ^ 0x80000000))
+#define ENC_U32BE(v)  host2uint32_t_be((uint32_t) (v) ^ 0x80000000)
+#define DEC_S32BE(x)  ((int32_t) uint32_t_be2host(x))
+#define ENC_S32BE(v)  host2uint32_t_be((uint32_t) (v))
+
+/** Instantiate kernels of an integer format stored in a native type */
+#define PCM_INT_KERNELS(name, type, bits, decode, encode) \
+static void pcm_load_##name(const void *src, float *dst, size_t count) \
+{ \
+	const type *s = src; \
+	for (size_t i = 0; i < count; ++i) \
+		dst[i] = (float) decode(s[i]) * (1.0f / PCM_FULL(bits)); \
+} \
+\
+static void pcm_mix_##name(void *dst, const float *src, size_t count) \
+{ \
+	type *d = dst; \
+	for (size_t i = 0; i < count; ++i) { \
+		const int64_t v = (int64_t) decode(d[i]) + \
+		    pcm_float_to_int(src[i], PCM_FULL(bits)); \
+		d[i] = encode(pcm_clamp(v, bits)); \
+	} \
+} \
+\
+static void pcm_add_##name(void *dst, const void *src, size_t count) \
+{ \
+	type *d = dst; \
+	const type *s = src; \
+	for (size_t i = 0; i < count; ++i) { \
+		const int64_t v = (int64_t) decode(d[i]) + decode(s[i]); \
+		d[i] = encode(pcm_clamp(v, bits)); \
+	} \
+}
+
+PCM_INT_KERNELS(u8, uint8_t, 8, DEC_U8, ENC_U8)
+PCM_INT_KERNELS(s8, uint8_t, 8, DEC_S8, ENC_S8)
+PCM_INT_KERNELS(u16le, uint16_t, 16, DEC_U16LE, ENC_U16LE)
+PCM_INT_KERNELS(s16le, uint16_t, 16, DEC_S16LE, ENC_S16LE)
+PCM_INT_KERNELS(u16be, uint16_t, 16, DEC_U16BE, ENC_U16BE)
+PCM_INT_KERNELS(s16be, uint16_t, 16, DEC_S16BE, ENC_S16BE)
+PCM_INT_KERNELS(u24_32le, uint32_t, 24, DEC_U24_32LE, ENC_U24_32LE)
+PCM_INT_KERNELS(s24_32le, uint32_t, 24, DEC_S24_32LE, ENC_S24_32LE)
+PCM_INT_KERNELS(u24_32be, uint32_t, 24, DEC_U24_32BE, ENC_U24_32BE)
+PCM_INT_KERNELS(s24_32be, uint32_t, 24, DEC_S24_32BE, ENC_S24_32BE)
+PCM_INT_KERNELS(u32le, uint32_t, 32, DEC_U32LE, ENC_U32LE)
+PCM_INT_KERNELS(s32le, uint32_t, 32, DEC_S32LE, ENC_S32LE)
+PCM_INT_KERNELS(u32be, uint32_t, 32, DEC_U32BE, ENC_U32BE)
+PCM_INT_KERNELS(s32be, uint32_t, 32, DEC_S32BE, ENC_S32BE)
+
+/**
+ * Read packed 24-bit sample.
+ * @param p Pointer to the three bytes of the sample.
+ * @param be Sample is stored big endian.
+ * @param sign Sample is signed.
+ * @return Sample centered at zero.
+ */
+static inline int32_t pcm_read24(const uint8_t *p, bool be, bool sign)
+{
+	const uint32_t v = be ?
+	    ((uint32_t) p[0] << 16) | ((uint32_t) p[1] << 8) | p[2] :
+	    ((uint32_t) p[2] << 16) | ((uint32_t) p[1] << 8) | p[0];
+	if (sign)
+		return (int32_t) (v << 8) >> 8;
+	return (int32_t) v - 0x800000;
+}
+
+/**
+ * Write packed 24-bit sample.
+ * @param p Pointer to the three bytes of the sample.
+ * @param s Sample centered at zero.
+ * @param be Sample is stored big endian.
+ * @param sign Sample is signed.
+ */
+static inline void pcm_write24(uint8_t *p, int32_t s, bool be, bool sign)
+{
+	const uint32_t v = sign ? (uint32_t) s : (uint32_t) (s + 0x800000);
+	p[be ? 0 : 2] = v >> 16;
+	p[1] = v >> 8;
+	p[be ? 2 : 0] = v;
+}
+
+/** Instantiate kernels of a packed 24-bit format */
+#define PCM_24_KERNELS(name, be, sign) \
+static void pcm_load_##name(const void *src, float *dst, size_t count) \
+{ \
+	const uint8_t *s = src; \
+	for (size_t i = 0; i < count; ++i, s += 3) \
+		dst[i] = (float) pcm_read24(s, be, sign) * \
+		    (1.0f / PCM_FULL(24)); \
+} \
+\
+static void pcm_mix_##name(void *dst, const float *src, size_t count) \
+{ \
+	uint8_t *d = dst; \
+	for (size_t i = 0; i < count; ++i, d += 3) { \
+		const int64_t v = pcm_read24(d, be, sign) + \
+		    pcm_float_to_int(src[i], PCM_FULL(24)); \
+		pcm_write24(d, pcm_clamp(v, 24), be, sign); \
+	} \
+} \
+\
+static void pcm_add_##name(void *dst, const void *src, size_t count) \
+{ \
+	uint8_t *d = dst; \
+	const uint8_t *s = src; \
+	for (size_t i = 0; i < count; ++i, d += 3, s += 3) { \
+		const int64_t v = (int64_t) pcm_read24(d, be, sign) + \
+		    pcm_read24(s, be, sign); \
+		pcm_write24(d, pcm_clamp(v, 24), be, sign); \
+	} \
+}
+
+PCM_24_KERNELS(u24le, false, false)
+PCM_24_KERNELS(s24le, false, true)
+PCM_24_KERNELS(u24be, true, false)
+PCM_24_KERNELS(s24be, true, true)
+
+/*
+ * Float samples are stored in host byte order, the mix result is clipped
+ * to the <-1,1> range.
+ */
+static void pcm_load_f32(const void *src, float *dst, size_t count)
+{
+	memcpy(dst, src, count * sizeof(float));
+}
+
+static void pcm_mix_f32(void *dst, const float *src, size_t count)
+{
+	float *d = dst;
+	for (size_t i = 0; i < count; ++i) {
+		const float v = d[i] + src[i];
+		d[i] = v > 1.0f ? 1.0f : (v < -1.0f ? -1.0f : v);
+	}
+}
+
+static void pcm_add_f32(void *dst, const void *src, size_t count)
+{
+	pcm_mix_f32(dst, src, count);
+}
+
+#if defined(PCM_SSE2)
+
+static void pcm_load_s16le_simd(const void *src, float *dst, size_t count)
+{
+	const int16_t *s = src;
+	const __m128 scale = _mm_set1_ps(1.0f / PCM_FULL(16));
+	size_t i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const __m128i x = _mm_loadu_si128((const __m128i *) (s + i));
+		const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+		const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(dst + i + 4,
+		    _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+	pcm_load_s16le(s + i, dst + i, count - i);
+}
+
+static void pcm_mix_s16le_simd(void *dst, const float *src, size_t count)
+{
+	int16_t *d = dst;
+	const __m128 full = _mm_set1_ps(PCM_FULL(16));
+	const __m128 lim = _mm_set1_ps(2.0f);
+	const __m128 nlim = _mm_set1_ps(-2.0f);
+	size_t i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const __m128i x = _mm_loadu_si128((const __m128i *) (d + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+		/* Clip first, max selects the limit for NaN inputs */
+		const __m128 f0 = _mm_min_ps(_mm_max_ps(
+		    _mm_loadu_ps(src + i), nlim), lim);
+		const __m128 f1 = _mm_min_ps(_mm_max_ps(
+		    _mm_loadu_ps(src + i + 4), nlim), lim);
+		lo = _mm_add_epi32(lo, _mm_cvtps_epi32(_mm_mul_ps(f0, full)));
+		hi = _mm_add_epi32(hi, _mm_cvtps_epi32(_mm_mul_ps(f1, full)));
+		_mm_storeu_si128((__m128i *) (d + i), _mm_packs_epi32(lo, hi));
+	}
+	pcm_mix_s16le(d + i, src + i, count - i);
+}
+
+static void pcm_add_s16le_simd(void *dst, const void *src, size_t count)
+{
+	int16_t *d = dst;
+	const int16_t *s = src;
+	size_t i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const __m128i a = _mm_loadu_si128((const __m128i *) (d + i));
+		const __m128i b = _mm_loadu_si128((const __m128i *) (s + i));
+		_mm_storeu_si128((__m128i *) (d + i), _mm_adds_epi16(a, b));
+	}
+	pcm_add_s16le(d + i, s + i, count - i);
+}
+
+static void pcm_mix_f32_simd(void *dst, const float *src, size_t count)
+{
+	float *d = dst;
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 none = _mm_set1_ps(-1.0f);
+	size_t i = 0;
+
+	for (; i + 4 <= count; i += 4) {
+		const __m128 v = _mm_add_ps(_mm_loadu_ps(d + i),
+		    _mm_loadu_ps(src + i));
+		_mm_storeu_ps(d + i, _mm_min_ps(_mm_max_ps(v, none), one));
+	}
+	pcm_mix_f32(d + i, src + i, count - i);
+}
+
+#elif defined(PCM_NEON)
+
+static void pcm_load_s16le_simd(const void *src, float *dst, size_t count)
+{
+	const int16_t *s = src;
+	size_t i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const int16x8_t x = vld1q_s16(s + i);
+		vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(
+		    vmovl_s16(vget_low_s16(x))), 1.0f / PCM_FULL(16)));
+		vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(
+		    vmovl_s16(vget_high_s16(x))), 1.0f / PCM_FULL(16)));
+	}
+	pcm_load_s16le(s + i, dst + i, count - i);
+}
+
+/** Scale clipped float samples and round half away from zero */
+static inline int32x4_t pcm_neon_to_int(float32x4_t f, float full)
+{
+	f = vminq_f32(vmaxq_f32(f, vdupq_n_f32(-2.0f)), vdupq_n_f32(2.0f));
+	f = vmulq_n_f32(f, full);
+	const float32x4_t half = vbslq_f32(vcltq_f32(f, vdupq_n_f32(0.0f)),
+	    vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f));
+	return vcvtq_s32_f32(vaddq_f32(f, half));
+}
+
+static void pcm_mix_s16le_simd(void *dst, const float *src, size_t count)
+{
+	int16_t *d = dst;
+	size_t i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const int16x8_t x = vld1q_s16(d + i);
+		const int32x4_t lo = vaddq_s32(vmovl_s16(vget_low_s16(x)),
+		    pcm_neon_to_int(vld1q_f32(src + i), PCM_FULL(16)));
+		const int32x4_t hi = vaddq_s32(vmovl_s16(vget_high_s16(x)),
+		    pcm_neon_to_int(vld1q_f32(src + i + 4), PCM_FULL(16)));
+		vst1q_s16(d + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+	}
+	pcm_mix_s16le(d + i, src + i, count - i);
+}
+
+static void pcm_add_s16le_simd(void *dst, const void *src, size_t count)
+{
+	int16_t *d = dst;
+	const int16_t *s = src;
+	size_t i = 0;
+
+	for (; i + 8 <= count; i += 8)
+		vst1q_s16(d + i, vqaddq_s16(vld1q_s16(d + i), vld1q_s16(s + i)));
+	pcm_add_s16le(d + i, s + i, count - i);
+}
+
+static void pcm_mix_f32_simd(void *dst, const float *src, size_t count)
+{
+	float *d = dst;
+	size_t i = 0;
+
+	for (; i + 4 <= count; i += 4) {
+		const float32x4_t v = vaddq_f32(vld1q_f32(d + i),
+		    vld1q_f32(src + i));
+		vst1q_f32(d + i, vminq_f32(vmaxq_f32(v, vdupq_n_f32(-1.0f)),
+		    vdupq_n_f32(1.0f)));
+	}
+	pcm_mix_f32(d + i, src + i, count - i);
+}
+
+#endif
+
+#if defined(PCM_SSE2) || defined(PCM_NEON)
+#define PCM_S16LE_KERNELS \
+	{ pcm_load_s16le_simd, pcm_mix_s16le_simd, pcm_add_s16le_simd }
+#define PCM_F32_KERNELS \
+	{ pcm_load_f32, pcm_mix_f32_simd, pcm_add_f32 }
+#else
+#define PCM_S16LE_KERNELS \
+	{ pcm_load_s16le, pcm_mix_s16le, pcm_add_s16le }
+#define PCM_F32_KERNELS \
+	{ pcm_load_f32, pcm_mix_f32, pcm_add_f32 }
+#endif
+
+/** Kernels of all supported sample formats */
+static const pcm_kernels_t pcm_kernels[PCM_SAMPLE_FORMAT_LAST + 1] = {
+	[PCM_SAMPLE_UINT8] = { pcm_load_u8, pcm_mix_u8, pcm_add_u8 },
+	[PCM_SAMPLE_SINT8] = { pcm_load_s8, pcm_mix_s8, pcm_add_s8 },
+	[PCM_SAMPLE_UINT16_LE] = { pcm_load_u16le, pcm_mix_u16le, pcm_add_u16le },
+	[PCM_SAMPLE_SINT16_LE] = PCM_S16LE_KERNELS,
+	[PCM_SAMPLE_UINT16_BE] = { pcm_load_u16be, pcm_mix_u16be, pcm_add_u16be },
+	[PCM_SAMPLE_SINT16_BE] = { pcm_load_s16be, pcm_mix_s16be, pcm_add_s16be },
+	[PCM_SAMPLE_UINT24_LE] = { pcm_load_u24le, pcm_mix_u24le, pcm_add_u24le },
+	[PCM_SAMPLE_SINT24_LE] = { pcm_load_s24le, pcm_mix_s24le, pcm_add_s24le },
+	[PCM_SAMPLE_UINT24_BE] = { pcm_load_u24be, pcm_mix_u24be, pcm_add_u24be },
+	[PCM_SAMPLE_SINT24_BE] = { pcm_load_s24be, pcm_mix_s24be, pcm_add_s24be },
+	[PCM_SAMPLE_UINT24_32_LE] =
+	    { pcm_load_u24_32le, pcm_mix_u24_32le, pcm_add_u24_32le },
+	[PCM_SAMPLE_SINT24_32_LE] =
+	    { pcm_load_s24_32le, pcm_mix_s24_32le, pcm_add_s24_32le },
+	[PCM_SAMPLE_UINT24_32_BE] =
+	    { pcm_load_u24_32be, pcm_mix_u24_32be, pcm_add_u24_32be },
+	[PCM_SAMPLE_SINT24_32_BE] =
+	    { pcm_load_s24_32be, pcm_mix_s24_32be, pcm_add_s24_32be },
+	[PCM_SAMPLE_UINT32_LE] = { pcm_load_u32le, pcm_mix_u32le, pcm_add_u32le },
+	[PCM_SAMPLE_SINT32_LE] = { pcm_load_s32le, pcm_mix_s32le, pcm_add_s32le },
+	[PCM_SAMPLE_UINT32_BE] = { pcm_load_u32be, pcm_mix_u32be, pcm_add_u32be },
+	[PCM_SAMPLE_SINT32_BE] = { pcm_load_s32be, pcm_mix_s32be, pcm_add_s32be },
+	[PCM_SAMPLE_FLOAT32] = PCM_F32_KERNELS,
+};
+
+/**
+ * Look up kernels of a sample format.
+ * @param format Sample format.
+ * @return Kernels, NULL if the format is not supported.
+ */
+static const pcm_kernels_t *pcm_kernels_get(pcm_sample_format_t format)
+{
+	if ((unsigned) format > PCM_SAMPLE_FORMAT_LAST ||
+	    pcm_kernels[format].load == NULL)
+		return NULL;
+	return &pcm_kernels[format];
+}
+
+/**
+ * Remap interleaved float frames to a different channel count.
+ * @param src Source frames.
+ * @param src_channels Channels in every source frame.
+ * @param dst Destination frames.
+ * @param dst_channels Channels in every destination frame.
+ * @param frames Number of frames.
+ *
+ * Mono is copied to all channels and downmixed from all channels, other
+ * layouts are matched by position with missing channels left silent.
+ */
+static void pcm_map_channels(const float *src, unsigned src_channels,
+    float *dst, unsigned dst_channels, size_t frames)
+{
+	for (size_t i = 0; i < frames; ++i) {
+		if (dst_channels == 1) {
+			float sum = 0.0f;
+			for (unsigned j = 0; j < src_channels; ++j)
+				sum += src[j];
+			dst[0] = sum / src_channels;
+		} else {
+			for (unsigned j = 0; j < dst_channels; ++j) {
+				if (src_channels == 1)
+					dst[j] = src[0];
+				else
+					dst[j] = j < src_channels ? src[j] : 0.0f;
+			}
+		}
+		src += src_channels;
+		dst += dst_channels;
+	}
+}
 
 /**
  * Compare PCM format attribtues.
@@ -95,59 +539,46 @@ bool pcm_format_same(const pcm_format_t *a, const pcm_format_t *b)
  */
 void pcm_format_silence(void *dst, size_t size, const pcm_format_t *f)
 {
-#define SET_NULL(type, endian, nullv) \
-do { \
-	type *buffer = dst; \
-	const size_t sample_count = size / sizeof(type); \
-	for (unsigned i = 0; i < sample_count; ++i) { \
-		buffer[i] = to((type)nullv, type, endian); \
-	} \
-} while (0)
+	const size_t sample_size = pcm_sample_format_size(f->sample_format);
+	uint8_t null[4] = { 0 };
 
 	switch (f->sample_format) {
 	case PCM_SAMPLE_UINT8:
-		SET_NULL(uint8_t, le, INT8_MIN);
-		break;
-	case PCM_SAMPLE_SINT8:
-		SET_NULL(int8_t, le, 0);
+	case PCM_SAMPLE_UINT16_BE:
+	case PCM_SAMPLE_UINT24_BE:
+	case PCM_SAMPLE_UINT32_BE:
+		null[0] = 0x80;
 		break;
 	case PCM_SAMPLE_UINT16_LE:
-		SET_NULL(uint16_t, le, INT16_MIN);
-		break;
-	case PCM_SAMPLE_SINT16_LE:
-		SET_NULL(int16_t, le, 0);
-		break;
-	case PCM_SAMPLE_UINT16_BE:
-		SET_NULL(uint16_t, be, INT16_MIN);
+	case PCM_SAMPLE_UINT24_32_BE:
+		null[1] = 0x80;
 		break;
-	case PCM_SAMPLE_SINT16_BE:
-		SET_NULL(int16_t, be, 0);
+	case PCM_SAMPLE_UINT24_LE:
+	case PCM_SAMPLE_UINT24_32_LE:
+		null[2] = 0x80;
 		break;
 	case PCM_SAMPLE_UINT32_LE:
-		SET_NULL(uint32_t, le, INT32_MIN);
-		break;
-	case PCM_SAMPLE_SINT32_LE:
-		SET_NULL(int32_t, le, 0);
-		break;
-	case PCM_SAMPLE_UINT32_BE:
-		SET_NULL(uint32_t, be, INT32_MIN);
+		null[3] = 0x80;
 		break;
-	case PCM_SAMPLE_SINT32_BE:
-		SET_NULL(int32_t, le, 0);
-		break;
-	case PCM_SAMPLE_UINT24_32_LE:
-	case PCM_SAMPLE_SINT24_32_LE:
-	case PCM_SAMPLE_UINT24_32_BE:
-	case PCM_SAMPLE_SINT24_32_BE:
-	case PCM_SAMPLE_UINT24_LE:
+	case PCM_SAMPLE_SINT8:
+	case PCM_SAMPLE_SINT16_LE:
+	case PCM_SAMPLE_SINT16_BE:
 	case PCM_SAMPLE_SINT24_LE:
-	case PCM_SAMPLE_UINT24_BE:
 	case PCM_SAMPLE_SINT24_BE:
+	case PCM_SAMPLE_SINT24_32_LE:
+	case PCM_SAMPLE_SINT24_32_BE:
+	case PCM_SAMPLE_SINT32_LE:
+	case PCM_SAMPLE_SINT32_BE:
 	case PCM_SAMPLE_FLOAT32:
+		memset(dst, 0, size - size % sample_size);
+		return;
 	default:
-		break;
+		return;
 	}
-#undef SET_NULL
+
+	uint8_t *buffer = dst;
+	for (size_t i = 0; i + sample_size <= size; i += sample_size)
+		memcpy(buffer + i, null, sample_size);
 }
 
 /**
@@ -175,6 +606,11 @@ errno_t pcm_format_mix(void *dst, const void *src, size_t size, const pcm_format
  *
  * Buffers must contain entire frames. Destination buffer is always filled.
  * If there are not enough data in the source buffer silent data is assumed.
+ * Sampling rates are not converted, see pcm_resampler_process().
+ *
+ * Buffers of the same sample format and channel count are mixed directly
+ * with saturating additions, others are staged through float samples in
+ * chunks of PCM_CHUNK_SAMPLES.
  */
 errno_t pcm_format_convert_and_mix(void *dst, size_t dst_size, const void *src,
     size_t src_size, const pcm_format_t *sf, const pcm_format_t *df)
@@ -182,155 +618,112 @@ errno_t pcm_format_convert_and_mix(void *dst, size_t dst_size, const void *src,
 	if (!dst || !src || !sf || !df)
 		return EINVAL;
 	const size_t src_frame_size = pcm_format_frame_size(sf);
-	if ((src_size % src_frame_size) != 0)
+	if (src_frame_size == 0 || (src_size % src_frame_size) != 0)
 		return EINVAL;
 
 	const size_t dst_frame_size = pcm_format_frame_size(df);
-	if ((dst_size % dst_frame_size) != 0)
+	if (dst_frame_size == 0 || (dst_size % dst_frame_size) != 0)
 		return EINVAL;
 
-	/*
-	 * This is so ugly it eats kittens, and puppies, and ducklings,
-	 * and all little fluffy things...
-	 */
-#define LOOP_ADD(type, endian, low, high) \
-do { \
-	const unsigned frame_count = dst_size / dst_frame_size; \
-	for (size_t i = 0; i < frame_count; ++i) { \
-		for (unsigned j = 0; j < df->channels; ++j) { \
-			const float a = \
-			    get_normalized_sample(dst, dst_size, i, j, df);\
-			const float b = \
-			    get_normalized_sample(src, src_size, i, j, sf);\
-			float c = (a + b); \
-			if (c < -1.0) c = -1.0; \
-			if (c > 1.0) c = 1.0; \
-			c += 1.0; \
-			c *= ((float)(type)high - (float)(type)low) / 2; \
-			c += (float)(type)low; \
-			type *dst_buf = dst; \
-			const unsigned pos = i * df->channels  + j; \
-			if (pos < (dst_size / sizeof(type))) \
-				dst_buf[pos] = to((type)c, type, endian); \
-		} \
-	} \
-} while (0)
+	const pcm_kernels_t *sk = pcm_kernels_get(sf->sample_format);
+	const pcm_kernels_t *dk = pcm_kernels_get(df->sample_format);
+	if (!sk || !dk)
+		return ENOTSUP;
 
-	switch (df->sample_format) {
-	case PCM_SAMPLE_UINT8:
-		LOOP_ADD(uint8_t, le, UINT8_MIN, UINT8_MAX);
-		break;
-	case PCM_SAMPLE_SINT8:
-		LOOP_ADD(uint8_t, le, INT8_MIN, INT8_MAX);
-		break;
-	case PCM_SAMPLE_UINT16_LE:
-		LOOP_ADD(uint16_t, le, UINT16_MIN, UINT16_MAX);
-		break;
-	case PCM_SAMPLE_SINT16_LE:
-		LOOP_ADD(int16_t, le, INT16_MIN, INT16_MAX);
-		break;
-	case PCM_SAMPLE_UINT16_BE:
-		LOOP_ADD(uint16_t, be, UINT16_MIN, UINT16_MAX);
-		break;
-	case PCM_SAMPLE_SINT16_BE:
-		LOOP_ADD(int16_t, be, INT16_MIN, INT16_MAX);
-		break;
-	case PCM_SAMPLE_UINT24_32_LE:
-	case PCM_SAMPLE_UINT32_LE: // TODO this are not right for 24bit
-		LOOP_ADD(uint32_t, le, UINT32_MIN, UINT32_MAX);
-		break;
-	case PCM_SAMPLE_SINT24_32_LE:
-	case PCM_SAMPLE_SINT32_LE:
-		LOOP_ADD(int32_t, le, INT32_MIN, INT32_MAX);
-		break;
-	case PCM_SAMPLE_UINT24_32_BE:
-	case PCM_SAMPLE_UINT32_BE:
-		LOOP_ADD(uint32_t, be, UINT32_MIN, UINT32_MAX);
-		break;
-	case PCM_SAMPLE_SINT24_32_BE:
-	case PCM_SAMPLE_SINT32_BE:
-		LOOP_ADD(int32_t, be, INT32_MIN, INT32_MAX);
-		break;
-	case PCM_SAMPLE_UINT24_LE:
-	case PCM_SAMPLE_SINT24_LE:
-	case PCM_SAMPLE_UINT24_BE:
-	case PCM_SAMPLE_SINT24_BE:
-	case PCM_SAMPLE_FLOAT32:
-	default:
+	size_t frames = min(dst_size / dst_frame_size,
+	    src_size / src_frame_size);
+
+	if (sf->sample_format == df->sample_format &&
+	    sf->channels == df->channels) {
+		dk->add(dst, src, frames * df->channels);
+		return EOK;
+	}
+
+	if (sf->channels > PCM_CHUNK_SAMPLES || df->channels > PCM_CHUNK_SAMPLES)
 		return ENOTSUP;
+
+	float in[PCM_CHUNK_SAMPLES];
+	float out[PCM_CHUNK_SAMPLES];
+	const size_t chunk = PCM_CHUNK_SAMPLES / max(sf->channels, df->channels);
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+
+	while (frames > 0) {
+		const size_t n = min(frames, chunk);
+		sk->load(s, in, n * sf->channels);
+		if (sf->channels == df->channels) {
+			dk->mix(d, in, n * df->channels);
+		} else {
+			pcm_map_channels(in, sf->channels, out, df->channels, n);
+			dk->mix(d, out, n * df->channels);
+		}
+		s += n * src_frame_size;
+		d += n * dst_frame_size;
+		frames -= n;
 	}
 	return EOK;
-#undef LOOP_ADD
 }
 
 /**
- * Converts all sample formats to float <-1,1>
- * @param buffer Audio data
- * @param size Size of the buffer
- * @param frame Index of the frame to read
- * @param channel Channel within the frame
- * @param f Pointer to a format descriptor
- * @return Normalized sample <-1,1>, 0.0 if the data could not be read
+ * Convert audio data to normalized float samples.
+ * @param src Source audio buffer.
+ * @param frames Number of frames to convert.
+ * @param f Pointer to the source format descriptor.
+ * @param dst Destination buffer, @p frames * @p channels samples.
+ * @param channels Number of channels of the destination frames.
+ * @return Error code.
  */
-static float get_normalized_sample(const void *buffer, size_t size,
-    unsigned frame, unsigned channel, const pcm_format_t *f)
+errno_t pcm_format_to_float(const void *src, size_t frames,
+    const pcm_format_t *f, float *dst, unsigned channels)
 {
-	assert(f);
-	assert(buffer);
-	if (channel >= f->channels)
-		return 0.0f;
-#define GET(type, endian, low, high) \
-do { \
-	const type *src = buffer; \
-	const size_t sample_count = size / sizeof(type); \
-	const size_t sample_pos = frame * f->channels + channel; \
-	if (sample_pos >= sample_count) {\
-		return 0.0f; \
-	} \
-	float sample = from(src[sample_pos], type, endian); \
-	/* This makes it positive */ \
-	sample -= (float)(type)low; \
-	/* This makes it <0,2> */ \
-	sample /= (((float)(type)high - (float)(type)low) / 2.0f); \
-	return sample - 1.0f; \
-} while (0)
+	const pcm_kernels_t *k = pcm_kernels_get(f->sample_format);
+	if (!k)
+		return ENOTSUP;
+	if (f->channels == 0 || channels == 0)
+		return EINVAL;
 
-	switch (f->sample_format) {
-	case PCM_SAMPLE_UINT8:
-		GET(uint8_t, le, UINT8_MIN, UINT8_MAX);
-	case PCM_SAMPLE_SINT8:
-		GET(int8_t, le, INT8_MIN, INT8_MAX);
-	case PCM_SAMPLE_UINT16_LE:
-		GET(uint16_t, le, UINT16_MIN, UINT16_MAX);
-	case PCM_SAMPLE_SINT16_LE:
-		GET(int16_t, le, INT16_MIN, INT16_MAX);
-	case PCM_SAMPLE_UINT16_BE:
-		GET(uint16_t, be, UINT16_MIN, UINT16_MAX);
-	case PCM_SAMPLE_SINT16_BE:
-		GET(int16_t, be, INT16_MIN, INT16_MAX);
-	case PCM_SAMPLE_UINT24_32_LE:
-	case PCM_SAMPLE_UINT32_LE:
-		GET(uint32_t, le, UINT32_MIN, UINT32_MAX);
-	case PCM_SAMPLE_SINT24_32_LE:
-	case PCM_SAMPLE_SINT32_LE:
-		GET(int32_t, le, INT32_MIN, INT32_MAX);
-	case PCM_SAMPLE_UINT24_32_BE:
-	case PCM_SAMPLE_UINT32_BE:
-		GET(uint32_t, be, UINT32_MIN, UINT32_MAX);
-	case PCM_SAMPLE_SINT24_32_BE:
-	case PCM_SAMPLE_SINT32_BE:
-		GET(int32_t, le, INT32_MIN, INT32_MAX);
-	case PCM_SAMPLE_UINT24_LE:
-	case PCM_SAMPLE_SINT24_LE:
-	case PCM_SAMPLE_UINT24_BE:
-	case PCM_SAMPLE_SINT24_BE:
-	case PCM_SAMPLE_FLOAT32:
-	default:
-		break;
+	if (f->channels == channels) {
+		k->load(src, dst, frames * channels);
+		return EOK;
 	}
-	return 0;
-#undef GET
+
+	if (f->channels > PCM_CHUNK_SAMPLES)
+		return ENOTSUP;
+
+	float in[PCM_CHUNK_SAMPLES];
+	const size_t chunk = PCM_CHUNK_SAMPLES / f->channels;
+	const size_t frame_size = pcm_format_frame_size(f);
+	const uint8_t *s = src;
+
+	while (frames > 0) {
+		const size_t n = min(frames, chunk);
+		k->load(s, in, n * f->channels);
+		pcm_map_channels(in, f->channels, dst, channels, n);
+		s += n * frame_size;
+		dst += n * channels;
+		frames -= n;
+	}
+	return EOK;
 }
+
+/**
+ * Mix normalized float samples into audio data.
+ * @param dst Destination audio buffer.
+ * @param src Source samples, @p frames frames of @p f channels.
+ * @param frames Number of frames to mix.
+ * @param f Pointer to the destination format descriptor.
+ * @return Error code.
+ */
+errno_t pcm_format_mix_float(void *dst, const float *src, size_t frames,
+    const pcm_format_t *f)
+{
+	const pcm_kernels_t *k = pcm_kernels_get(f->sample_format);
+	if (!k)
+		return ENOTSUP;
+	k->mix(dst, src, frames * f->channels);
+	return EOK;
+}
+
 /**
  * @}
  */
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup audio
+ * @brief HelenOS sound server
+ * @{
+ */
+/** @file
+ * Polyphase sample rate converter.
+ *
+ * The rate ratio is reduced to up / down, output frame n is interpolated
+ * at input position n * down / up by one of the windowed-sinc sub-filters
+ * (phases). There is a sub-filter for every fractional position unless
+ * up exceeds PCM_RESAMPLER_MAX_PHASES, in which case the position is
+ * rounded down to the nearest sub-filter. Input frames are accumulated in a history buffer that is
+ * prefilled with silence so that the first output frame is aligned with
+ * the first input frame.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <macros.h>
+#include <math.h>
+#include <mem.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "resample.h"
+
+/** Filter taps per phase when not decimating */
+#define PCM_RESAMPLER_TAPS  16
+/** Maximum number of filter taps per phase */
+#define PCM_RESAMPLER_MAX_TAPS  256
+/** Maximum number of filter phases */
+#define PCM_RESAMPLER_MAX_PHASES  1024
+/** Input frames accepted at once on top of the filter length */
+#define PCM_RESAMPLER_CHUNK  512
+/** Passband edge relative to the lower of the two Nyquist frequencies */
+#define PCM_RESAMPLER_CUTOFF  0.95
+
+struct pcm_resampler {
+	/** Number of interleaved channels */
+	unsigned channels;
+	/** Interpolation factor */
+	unsigned up;
+	/** Decimation factor */
+	unsigned down;
+	/** Number of filter phases */
+	unsigned phases;
+	/** Filter taps per phase */
+	unsigned taps;
+	/** Filter coefficients, @c taps per phase */
+	float *coefs;
+	/** Input history */
+	float *hist;
+	/** History capacity in frames */
+	size_t capacity;
+	/** Frames stored in history */
+	size_t avail;
+	/** First history frame used by the next output frame */
+	size_t offset;
+	/** Input frames to drop before the history is filled again */
+	size_t skip;
+	/** Fractional input position of the next output frame, in 1 / up */
+	unsigned phase;
+};
+
+static unsigned gcd(unsigned a, unsigned b)
+{
+	while (b != 0) {
+		const unsigned t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/**
+ * Compute filter coefficients.
+ * @param r Resampler with up, down, phases and taps set.
+ *
+ * Blackman windowed sinc, every phase is normalized to unity gain.
+ */
+static void pcm_resampler_design(pcm_resampler_t *r)
+{
+	const double fc = PCM_RESAMPLER_CUTOFF *
+	    min(1.0, (double) r->up / r->down);
+	const double half = r->taps / 2;
+
+	for (unsigned p = 0; p < r->phases; ++p) {
+		float *c = r->coefs + p * r->taps;
+		double sum = 0.0;
+
+		for (unsigned j = 0; j < r->taps; ++j) {
+			/* Distance of the tap from the interpolated position */
+			const double d = (double) p / r->phases + half - 1 - j;
+			const double x = M_PI * fc * d;
+			const double w = d / half;
+			const double sinc = (x == 0.0) ? 1.0 : sin(x) / x;
+			const double window = 0.42 + 0.5 * cos(M_PI * w) +
+			    0.08 * cos(2 * M_PI * w);
+			c[j] = fc * sinc * window;
+			sum += c[j];
+		}
+
+		for (unsigned j = 0; j < r->taps; ++j)
+			c[j] /= sum;
+	}
+}
+
+/**
+ * Create sample rate converter.
+ * @param channels Number of interleaved channels.
+ * @param in_rate Input sampling rate.
+ * @param out_rate Output sampling rate.
+ * @param rresampler Place to store the new converter.
+ * @return Error code.
+ */
+errno_t pcm_resampler_create(unsigned channels, unsigned in_rate,
+    unsigned out_rate, pcm_resampler_t **rresampler)
+{
+	if (channels == 0 || in_rate == 0 || out_rate == 0)
+		return EINVAL;
+
+	pcm_resampler_t *r = calloc(1, sizeof(pcm_resampler_t));
+	if (!r)
+		return ENOMEM;
+
+	const unsigned g = gcd(in_rate, out_rate);
+	r->channels = channels;
+	r->up = out_rate / g;
+	r->down = in_rate / g;
+	r->phases = min(r->up, PCM_RESAMPLER_MAX_PHASES);
+
+	/* Widen the filter with the decimation ratio to keep its quality */
+	const unsigned half = (PCM_RESAMPLER_TAPS / 2 * r->down + r->up - 1) /
+	    r->up;
+	r->taps = min(PCM_RESAMPLER_MAX_TAPS,
+	    2 * max(PCM_RESAMPLER_TAPS / 2, half));
+	r->capacity = r->taps + PCM_RESAMPLER_CHUNK;
+
+	r->coefs = malloc(r->phases * r->taps * sizeof(float));
+	r->hist = malloc(r->capacity * channels * sizeof(float));
+	if (!r->coefs || !r->hist) {
+		pcm_resampler_destroy(r);
+		return ENOMEM;
+	}
+
+	pcm_resampler_design(r);
+	pcm_resampler_reset(r);
+	*rresampler = r;
+	return EOK;
+}
+
+/**
+ * Destroy sample rate converter.
+ * @param r The converter, can be NULL.
+ */
+void pcm_resampler_destroy(pcm_resampler_t *r)
+{
+	if (!r)
+		return;
+	free(r->coefs);
+	free(r->hist);
+	free(r);
+}
+
+/**
+ * Forget all buffered input.
+ * @param r The converter.
+ */
+void pcm_resampler_reset(pcm_resampler_t *r)
+{
+	assert(r);
+	r->avail = r->taps / 2 - 1;
+	memset(r->hist, 0, r->avail * r->channels * sizeof(float));
+	r->offset = 0;
+	r->skip = 0;
+	r->phase = 0;
+}
+
+/**
+ * Query input needed to produce output.
+ * @param r The converter.
+ * @param out_frames Number of requested output frames.
+ * @return Number of input frames that yield exactly @p out_frames frames.
+ */
+size_t pcm_resampler_input_frames(pcm_resampler_t *r, size_t out_frames)
+{
+	assert(r);
+	if (out_frames == 0)
+		return 0;
+
+	const uint64_t advance = ((uint64_t) r->phase +
+	    (uint64_t) (out_frames - 1) * r->down) / r->up;
+	const uint64_t end = r->offset + advance + r->taps;
+	return r->skip + (end > r->avail ? end - r->avail : 0);
+}
+
+/**
+ * Compute one output frame.
+ * @param r The converter.
+ * @param out Destination frame.
+ */
+static void pcm_resampler_frame(pcm_resampler_t *r, float *out)
+{
+	const unsigned ch = r->channels;
+	const unsigned p = (uint64_t) r->phase * r->phases / r->up;
+	const float *c = r->coefs + p * r->taps;
+	const float *h = r->hist + r->offset * ch;
+
+	if (ch == 2) {
+		float left = 0.0f;
+		float right = 0.0f;
+		for (unsigned j = 0; j < r->taps; ++j) {
+			left += c[j] * h[2 * j];
+			right += c[j] * h[2 * j + 1];
+		}
+		out[0] = left;
+		out[1] = right;
+		return;
+	}
+
+	for (unsigned k = 0; k < ch; ++k) {
+		float acc = 0.0f;
+		for (unsigned j = 0; j < r->taps; ++j)
+			acc += c[j] * h[j * ch + k];
+		out[k] = acc;
+	}
+}
+
+/**
+ * Convert sampling rate of interleaved float frames.
+ * @param r The converter.
+ * @param in Input frames.
+ * @param in_frames Number of input frames.
+ * @param in_used Place to store the number of consumed input frames.
+ * @param out Output buffer.
+ * @param out_frames Capacity of the output buffer in frames.
+ * @return Number of output frames produced.
+ *
+ * Input is consumed only as far as it is needed for the produced output,
+ * unused frames have to be passed again in the next call.
+ */
+size_t pcm_resampler_process(pcm_resampler_t *r, const float *in,
+    size_t in_frames, size_t *in_used, float *out, size_t out_frames)
+{
+	assert(r);
+	assert(in_used);
+	const unsigned ch = r->channels;
+	size_t used = 0;
+	size_t produced = 0;
+
+	while (produced < out_frames) {
+		if (r->skip > 0) {
+			const size_t n = min(r->skip, in_frames - used);
+			used += n;
+			r->skip -= n;
+			if (r->skip > 0)
+				break;
+		}
+
+		if (r->offset + r->taps <= r->avail) {
+			pcm_resampler_frame(r, out + produced * ch);
+			++produced;
+			r->phase += r->down;
+			r->offset += r->phase / r->up;
+			r->phase %= r->up;
+			continue;
+		}
+
+		if (used == in_frames)
+			break;
+
+		/* Discard history that is no longer needed */
+		if (r->offset >= r->avail) {
+			r->skip = r->offset - r->avail;
+			r->avail = 0;
+			r->offset = 0;
+			continue;
+		}
+		if (r->offset > 0) {
+			r->avail -= r->offset;
+			memmove(r->hist, r->hist + r->offset * ch,
+			    r->avail * ch * sizeof(float));
+			r->offset = 0;
+		}
+
+		const size_t n = min(r->capacity - r->avail, in_frames - used);
+		memcpy(r->hist + r->avail * ch, in + used * ch,
+		    n * ch * sizeof(float));
+		r->avail += n;
+		used += n;
+	}
+
+	*in_used = used;
+	return produced;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <errno.h>
+#include <pcm/format.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(format);
+
+/** Same format mixing saturates, including the tail after vector blocks */
+PCUT_TEST(mix_s16le_saturate)
+{
+	const pcm_format_t f = { 1, 44100, PCM_SAMPLE_SINT16_LE };
+	int16_t dst[19];
+	int16_t src[19];
+
+	for (unsigned i = 0; i < 19; ++i) {
+		dst[i] = 30000 - i * 3000;
+		src[i] = 10000;
+	}
+
+	errno_t rc = pcm_format_mix(dst, src, sizeof(dst), &f);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (int i = 0; i < 19; ++i) {
+		int expected = 40000 - i * 3000;
+		if (expected > INT16_MAX)
+			expected = INT16_MAX;
+		PCUT_ASSERT_INT_EQUALS(expected, dst[i]);
+	}
+}
+
+/** Mono is duplicated to all channels of a packed 24-bit destination */
+PCUT_TEST(convert_mono_s16le_to_stereo_s24le)
+{
+	const pcm_format_t sf = { 1, 44100, PCM_SAMPLE_SINT16_LE };
+	const pcm_format_t df = { 2, 44100, PCM_SAMPLE_SINT24_LE };
+	int16_t src[300];
+	uint8_t dst[600 * 3];
+
+	for (int i = 0; i < 300; ++i)
+		src[i] = i * 97 - 14000;
+	pcm_format_silence(dst, sizeof(dst), &df);
+
+	errno_t rc = pcm_format_convert_and_mix(dst, sizeof(dst), src,
+	    sizeof(src), &sf, &df);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (int i = 0; i < 600; ++i) {
+		const uint32_t v = dst[3 * i] | dst[3 * i + 1] << 8 |
+		    (uint32_t) dst[3 * i + 2] << 16;
+		PCUT_ASSERT_INT_EQUALS(src[i / 2] * 256,
+		    (int32_t) (v << 8) >> 8);
+	}
+}
+
+/** Float samples are rounded and clipped to the destination range */
+PCUT_TEST(convert_float32_to_s16le)
+{
+	const pcm_format_t sf = { 1, 8000, PCM_SAMPLE_FLOAT32 };
+	const pcm_format_t df = { 1, 8000, PCM_SAMPLE_SINT16_LE };
+	const float src[10] = {
+		0.5f, -0.5f, 1.0f, -1.0f, 2.5f, 0.25f, 0.0f, 0.5f, -1.5f, 0.75f
+	};
+	const int16_t expected[10] = {
+		16384, -16384, 32767, -32768, 32767, 8192, 0, 16384, -32768, 24576
+	};
+	int16_t dst[10] = { 0 };
+
+	errno_t rc = pcm_format_convert_and_mix(dst, sizeof(dst), src,
+	    sizeof(src), &sf, &df);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	for (int i = 0; i < 10; ++i)
+		PCUT_ASSERT_INT_EQUALS(expected[i], dst[i]);
+}
+
+/** Float mixing clips to <-1,1> */
+PCUT_TEST(mix_float32)
+{
+	const pcm_format_t f = { 1, 8000, PCM_SAMPLE_FLOAT32 };
+	float dst[5] = { 0.5f, 0.9f, -0.9f, 0.0f, 0.7f };
+	const float src[5] = { 0.25f, 0.5f, -0.5f, 0.0f, 0.7f };
+
+	errno_t rc = pcm_format_mix(dst, src, sizeof(dst), &f);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	PCUT_ASSERT_TRUE(dst[0] == 0.75f);
+	PCUT_ASSERT_TRUE(dst[1] == 1.0f);
+	PCUT_ASSERT_TRUE(dst[2] == -1.0f);
+	PCUT_ASSERT_TRUE(dst[3] == 0.0f);
+	PCUT_ASSERT_TRUE(dst[4] == 1.0f);
+}
+
+/** Silence of unsigned formats is the middle of the range */
+PCUT_TEST(silence_unsigned)
+{
+	const pcm_format_t u8 = { 1, 8000, PCM_SAMPLE_UINT8 };
+	const pcm_format_t u24be = { 1, 8000, PCM_SAMPLE_UINT24_BE };
+	const pcm_format_t u32le = { 1, 8000, PCM_SAMPLE_UINT32_LE };
+	uint8_t buf[12];
+
+	pcm_format_silence(buf, 5, &u8);
+	PCUT_ASSERT_INT_EQUALS(0x80, buf[4]);
+
+	pcm_format_silence(buf, 6, &u24be);
+	PCUT_ASSERT_INT_EQUALS(0x80, buf[3]);
+	PCUT_ASSERT_INT_EQUALS(0, buf[4]);
+	PCUT_ASSERT_INT_EQUALS(0, buf[5]);
+
+	pcm_format_silence(buf, 8, &u32le);
+	PCUT_ASSERT_INT_EQUALS(0, buf[4]);
+	PCUT_ASSERT_INT_EQUALS(0x80, buf[7]);
+}
+
+PCUT_EXPORT(format);
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <errno.h>
+#include <macros.h>
+#include <math.h>
+#include <pcm/resample.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(resample);
+
+/** Convert one second of a stereo tone and compare with the ideal signal */
+static void resample_tone(unsigned in_rate, unsigned out_rate)
+{
+	pcm_resampler_t *r;
+	float out[200 * 2];
+	size_t pos = 0;
+	size_t total = 0;
+	float maxerr = 0.0f;
+
+	errno_t rc = pcm_resampler_create(2, in_rate, out_rate, &r);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	float *in = malloc(in_rate * 2 * sizeof(float));
+	PCUT_ASSERT_NOT_NULL(in);
+	for (unsigned i = 0; i < in_rate; ++i) {
+		in[2 * i] = 0.5 * sin(2 * M_PI * 440 * i / in_rate);
+		in[2 * i + 1] = 0.25f;
+	}
+
+	while (true) {
+		const size_t need = pcm_resampler_input_frames(r, 200);
+		const size_t give = min(need, in_rate - pos);
+		size_t used;
+		const size_t got = pcm_resampler_process(r, in + 2 * pos, give,
+		    &used, out, 200);
+		if (give == need) {
+			PCUT_ASSERT_INT_EQUALS(200, got);
+			PCUT_ASSERT_INT_EQUALS(need, used);
+		}
+		if (got == 0)
+			break;
+
+		/* Skip the edges where the filter sees silence */
+		for (size_t i = 0; i < got; ++i) {
+			const size_t n = total + i;
+			if (n < 100 || n > out_rate - 100)
+				continue;
+			const float ideal = 0.5 *
+			    sin(2 * M_PI * 440 * (double) n / out_rate);
+			maxerr = max(maxerr, fabsf(out[2 * i] - ideal));
+			maxerr = max(maxerr, fabsf(out[2 * i + 1] - 0.25f));
+		}
+		pos += used;
+		total += got;
+	}
+
+	PCUT_ASSERT_TRUE(total + 16 >= out_rate && total <= out_rate);
+	PCUT_ASSERT_TRUE(maxerr < 1e-3);
+
+	free(in);
+	pcm_resampler_destroy(r);
+}
+
+PCUT_TEST(upsample)
+{
+	resample_tone(44100, 48000);
+}
+
+PCUT_TEST(downsample)
+{
+	resample_tone(48000, 8000);
+}
+
+/** Ratio that needs more phases than there are filters */
+PCUT_TEST(fine_ratio)
+{
+	resample_tone(44101, 48000);
+}
+
+PCUT_TEST(create_invalid)
+{
+	pcm_resampler_t *r;
+
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, pcm_resampler_create(0, 8000, 8000, &r));
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, pcm_resampler_create(1, 0, 8000, &r));
+}
+
+PCUT_EXPORT(resample);
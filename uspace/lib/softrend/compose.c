@@ -33,8 +33,30 @@
  * @file
  */
 
+#include <mem.h>
+#include <stdint.h>
 #include "compose.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define COMPOSE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define COMPOSE_NEON
+#endif
+
+/** Multiply two 8-bit fractions.
+ *
+ * Computes a * b / 255 rounded to nearest without a division. The same
+ * arithmetic is used by the vector kernels so that they produce the same
+ * results as the scalar code.
+ */
+static inline uint32_t mul255(uint32_t a, uint32_t b)
+{
+	uint32_t t = a * b + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
 pixel_t compose_clr(pixel_t fg, pixel_t bg)
 {
 	return 0;
@@ -50,22 +72,19 @@ pixel_t compose_dst(pixel_t fg, pixel_t bg)
 	return bg;
 }
 
+/** Compose pixel over destination pixel.
+ *
+ * The color of the result is premultiplied by its alpha.
+ */
 pixel_t compose_over(pixel_t fg, pixel_t bg)
 {
-	uint8_t res_a;
-	uint8_t res_r;
-	uint8_t res_g;
-	uint8_t res_b;
-	uint32_t res_a_inv;
+	uint32_t fg_a = ALPHA(fg);
+	uint32_t res_a_inv = mul255(ALPHA(bg), 255 - fg_a);
 
-	res_a_inv = ALPHA(bg) * (255 - ALPHA(fg));
-	res_a = ALPHA(fg) + (res_a_inv / 255);
-
-	res_r = (RED(fg) * ALPHA(fg) / 255) + (RED(bg) * res_a_inv) / (255 * 255);
-	res_g = (GREEN(fg) * ALPHA(fg) / 255) + (GREEN(bg) * res_a_inv) / (255 * 255);
-	res_b = (BLUE(fg) * ALPHA(fg) / 255) + (BLUE(bg) * res_a_inv) / (255 * 255);
-
-	return PIXEL(res_a, res_r, res_g, res_b);
+	return PIXEL(fg_a + res_a_inv,
+	    mul255(RED(fg), fg_a) + mul255(RED(bg), res_a_inv),
+	    mul255(GREEN(fg), fg_a) + mul255(GREEN(bg), res_a_inv),
+	    mul255(BLUE(fg), fg_a) + mul255(BLUE(bg), res_a_inv));
 }
 
 pixel_t compose_in(pixel_t fg, pixel_t bg)
@@ -98,5 +117,171 @@ pixel_t compose_add(pixel_t fg, pixel_t bg)
 	return 0;
 }
 
+void compose_span_src(pixel_t *dst, const pixel_t *src, size_t count)
+{
+	memcpy(dst, src, count * sizeof(pixel_t));
+}
+
+#if defined(COMPOSE_SSE2)
+
+static inline __m128i mul255_sse2(__m128i a, __m128i b)
+{
+	__m128i t = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+/** Compose two pixels unpacked to 16-bit channels. */
+static inline __m128i over_sse2(__m128i fg, __m128i bg, __m128i fg1,
+    __m128i bg1)
+{
+	/* Broadcast alpha of each pixel to all its channels */
+	__m128i fg_a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(fg,
+	    _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	__m128i bg_a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(bg,
+	    _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+	__m128i res_a_inv = mul255_sse2(bg_a,
+	    _mm_sub_epi16(_mm_set1_epi16(255), fg_a));
+
+	return _mm_add_epi16(mul255_sse2(fg1, fg_a),
+	    mul255_sse2(bg1, res_a_inv));
+}
+
+/** Compose span using SSE2, four pixels at a time.
+ *
+ * @return Number of pixels processed
+ */
+static size_t compose_span_over_sse2(pixel_t *dst, const pixel_t *src,
+    size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+	size_t i;
+
+	for (i = 0; i + 4 <= count; i += 4) {
+		__m128i fg = _mm_loadu_si128((const __m128i *) (src + i));
+
+		/* Opaque pixels simply replace the destination */
+		__m128i opaque = _mm_cmpeq_epi32(_mm_and_si128(fg, alpha_mask),
+		    alpha_mask);
+		if (_mm_movemask_epi8(opaque) == 0xffff) {
+			_mm_storeu_si128((__m128i *) (dst + i), fg);
+			continue;
+		}
+
+		__m128i bg = _mm_loadu_si128((const __m128i *) (dst + i));
+
+		/*
+		 * Alpha of the result is computed in the alpha channel by
+		 * treating alpha of both operands as full intensity.
+		 */
+		__m128i fg1 = _mm_or_si128(fg, alpha_mask);
+		__m128i bg1 = _mm_or_si128(bg, alpha_mask);
+
+		__m128i lo = over_sse2(_mm_unpacklo_epi8(fg, zero),
+		    _mm_unpacklo_epi8(bg, zero), _mm_unpacklo_epi8(fg1, zero),
+		    _mm_unpacklo_epi8(bg1, zero));
+		__m128i hi = over_sse2(_mm_unpackhi_epi8(fg, zero),
+		    _mm_unpackhi_epi8(bg, zero), _mm_unpackhi_epi8(fg1, zero),
+		    _mm_unpackhi_epi8(bg1, zero));
+
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(lo, hi));
+	}
+
+	return i;
+}
+
+#elif defined(COMPOSE_NEON)
+
+static inline uint8x16_t mul255_neon(uint8x16_t a, uint8x16_t b)
+{
+	uint16x8_t lo = vmull_u8(vget_low_u8(a), vget_low_u8(b));
+	uint16x8_t hi = vmull_u8(vget_high_u8(a), vget_high_u8(b));
+
+	return vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)),
+	    vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+}
+
+/** Compose span using NEON, four pixels at a time.
+ *
+ * @return Number of pixels processed
+ */
+static size_t compose_span_over_neon(pixel_t *dst, const pixel_t *src,
+    size_t count)
+{
+	const uint32x4_t alpha_mask = vdupq_n_u32(0xff000000);
+	size_t i;
+
+	for (i = 0; i + 4 <= count; i += 4) {
+		uint32x4_t fg = vld1q_u32(src + i);
+
+		/* Opaque pixels simply replace the destination */
+		uint32x2_t all = vand_u32(vget_low_u32(fg), vget_high_u32(fg));
+		all = vand_u32(all, vrev64_u32(all));
+		if (vget_lane_u32(all, 0) >= 0xff000000) {
+			vst1q_u32(dst + i, fg);
+			continue;
+		}
+
+		uint32x4_t bg = vld1q_u32(dst + i);
+
+		/* Broadcast alpha of each pixel to all its channels */
+		uint8x16_t fg_a = vreinterpretq_u8_u32(
+		    vmulq_n_u32(vshrq_n_u32(fg, 24), 0x01010101));
+		uint8x16_t bg_a = vreinterpretq_u8_u32(
+		    vmulq_n_u32(vshrq_n_u32(bg, 24), 0x01010101));
+
+		uint8x16_t res_a_inv = mul255_neon(bg_a, vmvnq_u8(fg_a));
+
+		/*
+		 * Alpha of the result is computed in the alpha channel by
+		 * treating alpha of both operands as full intensity.
+		 */
+		uint8x16_t fg1 = vreinterpretq_u8_u32(vorrq_u32(fg, alpha_mask));
+		uint8x16_t bg1 = vreinterpretq_u8_u32(vorrq_u32(bg, alpha_mask));
+
+		uint8x16_t res = vaddq_u8(mul255_neon(fg1, fg_a),
+		    mul255_neon(bg1, res_a_inv));
+		vst1q_u32(dst + i, vreinterpretq_u32_u8(res));
+	}
+
+	return i;
+}
+
+#endif
+
+void compose_span_over(pixel_t *dst, const pixel_t *src, size_t count)
+{
+	size_t i = 0;
+
+#if defined(COMPOSE_SSE2)
+	i = compose_span_over_sse2(dst, src, count);
+#elif defined(COMPOSE_NEON)
+	i = compose_span_over_neon(dst, src, count);
+#endif
+
+	for (; i < count; i++) {
+		if (ALPHA(src[i]) == 255)
+			dst[i] = src[i];
+		else
+			dst[i] = compose_over(src[i], dst[i]);
+	}
+}
+
+/** Get span variant of a compositing function.
+ *
+ * @param compose Compositing function
+ * @return Span compositing function or @c NULL if there is none
+ */
+compose_span_t compose_get_span(compose_t compose)
+{
+	if (compose == compose_src)
+		return compose_span_src;
+	if (compose == compose_over)
+		return compose_span_over;
+
+	return NULL;
+}
+
 /** @}
  */
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup softrend
+ * @{
+ */
+/**
+ * @file Region algebra.
+ *
+ * Regions are kept as small arrays of disjoint rectangles, which is
+ * sufficient for damage tracking and visibility computations where a few
+ * rectangles are involved at a time.
+ */
+
+#include <macros.h>
+#include <mem.h>
+#include "rectangle.h"
+#include "region.h"
+
+/** Clip rectangle so that its far edges do not overflow. */
+static void rect_clamp(sysarg_t x, sysarg_t y, sysarg_t *w, sysarg_t *h)
+{
+	if (*w > (sysarg_t) -1 - x)
+		*w = (sysarg_t) -1 - x;
+	if (*h > (sysarg_t) -1 - y)
+		*h = (sysarg_t) -1 - y;
+}
+
+static bool rect_contains(const region_rect_t *outer,
+    const region_rect_t *inner)
+{
+	return (inner->x >= outer->x) && (inner->y >= outer->y) &&
+	    (inner->x + inner->w <= outer->x + outer->w) &&
+	    (inner->y + inner->h <= outer->y + outer->h);
+}
+
+/** Subtract rectangle from rectangle.
+ *
+ * @param a      Rectangle to subtract from
+ * @param b      Rectangle to subtract
+ * @param pieces Array for at least four rectangles of the difference
+ * @return Number of rectangles of the difference
+ */
+static size_t rect_subtract(const region_rect_t *a, const region_rect_t *b,
+    region_rect_t *pieces)
+{
+	region_rect_t isec;
+	size_t n = 0;
+
+	if (!rectangle_intersect(a->x, a->y, a->w, a->h, b->x, b->y, b->w, b->h,
+	    &isec.x, &isec.y, &isec.w, &isec.h)) {
+		pieces[0] = *a;
+		return 1;
+	}
+
+	/* Full-width bands above and below the intersection */
+	if (isec.y > a->y) {
+		pieces[n++] = (region_rect_t) {
+			a->x, a->y, a->w, isec.y - a->y
+		};
+	}
+
+	if (isec.y + isec.h < a->y + a->h) {
+		pieces[n++] = (region_rect_t) {
+			a->x, isec.y + isec.h, a->w,
+			a->y + a->h - (isec.y + isec.h)
+		};
+	}
+
+	/* Parts left and right of the intersection */
+	if (isec.x > a->x) {
+		pieces[n++] = (region_rect_t) {
+			a->x, isec.y, isec.x - a->x, isec.h
+		};
+	}
+
+	if (isec.x + isec.w < a->x + a->w) {
+		pieces[n++] = (region_rect_t) {
+			isec.x + isec.w, isec.y,
+			a->x + a->w - (isec.x + isec.w), isec.h
+		};
+	}
+
+	return n;
+}
+
+/** Merge rectangles which together form a rectangle. */
+static void region_coalesce(region_t *region)
+{
+	bool merged = true;
+
+	while (merged) {
+		merged = false;
+
+		for (size_t i = 0; i < region->count; i++) {
+			region_rect_t *a = &region->rects[i];
+
+			for (size_t j = i + 1; j < region->count; j++) {
+				region_rect_t *b = &region->rects[j];
+
+				if (a->x == b->x && a->w == b->w &&
+				    (a->y + a->h == b->y || b->y + b->h == a->y)) {
+					a->y = min(a->y, b->y);
+					a->h += b->h;
+				} else if (a->y == b->y && a->h == b->h &&
+				    (a->x + a->w == b->x || b->x + b->w == a->x)) {
+					a->x = min(a->x, b->x);
+					a->w += b->w;
+				} else {
+					continue;
+				}
+
+				region->rects[j] = region->rects[--region->count];
+				merged = true;
+				break;
+			}
+		}
+	}
+}
+
+void region_init(region_t *region)
+{
+	region->count = 0;
+}
+
+bool region_is_empty(const region_t *region)
+{
+	return region->count == 0;
+}
+
+/** Get bounding rectangle of region.
+ *
+ * The bounding rectangle of an empty region has zero size.
+ */
+void region_bounds(const region_t *region,
+    sysarg_t *x_out, sysarg_t *y_out, sysarg_t *w_out, sysarg_t *h_out)
+{
+	if (region->count == 0) {
+		*x_out = 0;
+		*y_out = 0;
+		*w_out = 0;
+		*h_out = 0;
+		return;
+	}
+
+	*x_out = region->rects[0].x;
+	*y_out = region->rects[0].y;
+	*w_out = region->rects[0].w;
+	*h_out = region->rects[0].h;
+
+	for (size_t i = 1; i < region->count; i++) {
+		const region_rect_t *r = &region->rects[i];
+		rectangle_union(*x_out, *y_out, *w_out, *h_out,
+		    r->x, r->y, r->w, r->h, x_out, y_out, w_out, h_out);
+	}
+}
+
+/** Add rectangle to region. */
+void region_union(region_t *region,
+    sysarg_t x, sysarg_t y, sysarg_t w, sysarg_t h)
+{
+	region_rect_t pieces[REGION_MAX_RECTS];
+	region_rect_t next[REGION_MAX_RECTS];
+	size_t npieces = 1;
+
+	if (w == 0 || h == 0)
+		return;
+
+	rect_clamp(x, y, &w, &h);
+	pieces[0] = (region_rect_t) { x, y, w, h };
+
+	/* Drop rectangles covered by the new one */
+	for (size_t i = 0; i < region->count; ) {
+		if (rect_contains(&pieces[0], &region->rects[i]))
+			region->rects[i] = region->rects[--region->count];
+		else
+			i++;
+	}
+
+	/* Cut away parts of the new rectangle that are already covered */
+	for (size_t i = 0; i < region->count; i++) {
+		size_t nnext = 0;
+
+		for (size_t j = 0; j < npieces; j++) {
+			if (nnext + 4 > REGION_MAX_RECTS)
+				goto overflow;
+
+			nnext += rect_subtract(&pieces[j], &region->rects[i],
+			    next + nnext);
+		}
+
+		if (nnext == 0)
+			return;
+
+		memcpy(pieces, next, nnext * sizeof(region_rect_t));
+		npieces = nnext;
+	}
+
+	if (region->count + npieces > REGION_MAX_RECTS)
+		goto overflow;
+
+	for (size_t j = 0; j < npieces; j++)
+		region->rects[region->count++] = pieces[j];
+
+	region_coalesce(region);
+	return;
+
+overflow:
+	/* Too complex, approximate by the bounding rectangle */
+	region_bounds(region, &pieces[0].x, &pieces[0].y, &pieces[0].w,
+	    &pieces[0].h);
+	rectangle_union(pieces[0].x, pieces[0].y, pieces[0].w, pieces[0].h,
+	    x, y, w, h, &pieces[0].x, &pieces[0].y, &pieces[0].w, &pieces[0].h);
+
+	region->rects[0] = pieces[0];
+	region->count = 1;
+}
+
+/** Remove rectangle from region.
+ *
+ * If the region would become too complex, some of its rectangles are
+ * left intact.
+ */
+void region_subtract(region_t *region,
+    sysarg_t x, sysarg_t y, sysarg_t w, sysarg_t h)
+{
+	region_rect_t split[4];
+
+	if (w == 0 || h == 0)
+		return;
+
+	rect_clamp(x, y, &w, &h);
+	region_rect_t b = { x, y, w, h };
+
+	/* Rectangles appended at the end are already disjoint with b */
+	size_t count = region->count;
+
+	for (size_t i = 0; i < count; ) {
+		region_rect_t *a = &region->rects[i];
+		region_rect_t isec;
+
+		if (!rectangle_intersect(a->x, a->y, a->w, a->h, x, y, w, h,
+		    &isec.x, &isec.y, &isec.w, &isec.h)) {
+			i++;
+			continue;
+		}
+
+		size_t n = rect_subtract(a, &b, split);
+
+		if (region->count - 1 + n > REGION_MAX_RECTS) {
+			/* Keep the rectangle, covering more than needed */
+			i++;
+			continue;
+		}
+
+		/* Replace the rectangle with the last unprocessed one */
+		region->rects[i] = region->rects[count - 1];
+		region->rects[count - 1] = region->rects[region->count - 1];
+		region->count--;
+		count--;
+
+		for (size_t k = 0; k < n; k++)
+			region->rects[region->count++] = split[k];
+	}
+
+	region_coalesce(region);
+}
+
+/** Intersect region with rectangle.
+ *
+ * @param dst Region to store the intersection to
+ * @param src Source region
+ */
+void region_intersect(region_t *dst, const region_t *src,
+    sysarg_t x, sysarg_t y, sysarg_t w, sysarg_t h)
+{
+	rect_clamp(x, y, &w, &h);
+	dst->count = 0;
+
+	for (size_t i = 0; i < src->count; i++) {
+		const region_rect_t *r = &src->rects[i];
+		region_rect_t *isec = &dst->rects[dst->count];
+
+		if (rectangle_intersect(r->x, r->y, r->w, r->h, x, y, w, h,
+		    &isec->x, &isec->y, &isec->w, &isec->h))
+			dst->count++;
+	}
+}
+
+/** @}
+ */
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup softrend
+ * @{
+ */
+/**
+ * @file
+ */
+
+#ifndef SOFTREND_REGION_H_
+#define SOFTREND_REGION_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <types/common.h>
+
+/** Maximum number of rectangles in a region */
+#define REGION_MAX_RECTS  32
+
+typedef struct {
+	sysarg_t x;
+	sysarg_t y;
+	sysarg_t w;
+	sysarg_t h;
+} region_rect_t;
+
+/** Region of the plane.
+ *
+ * A region is a set of disjoint rectangles. Regions which would need more
+ * than REGION_MAX_RECTS rectangles are approximated by a larger region,
+ * so the result of any operation always covers the exact result.
+ */
+typedef struct {
+	size_t count;
+	region_rect_t rects[REGION_MAX_RECTS];
+} region_t;
+
+extern void region_init(region_t *);
+extern bool region_is_empty(const region_t *);
+extern void region_bounds(const region_t *,
+    sysarg_t *, sysarg_t *, sysarg_t *, sysarg_t *);
+extern void region_union(region_t *, sysarg_t, sysarg_t, sysarg_t, sysarg_t);
+extern void region_subtract(region_t *,
+    sysarg_t, sysarg_t, sysarg_t, sysarg_t);
+extern void region_intersect(region_t *, const region_t *,
+    sysarg_t, sysarg_t, sysarg_t, sysarg_t);
+
+#endif
+
+/** @}
+ */
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include "../compose.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(compose);
+
+/** Number of pixels in test spans (not a multiple of vector width) */
+#define SPAN_SIZE  67
+
+/** Simple pseudo-random generator for test pixels */
+static uint32_t rand_state = 1;
+
+static pixel_t rand_pixel(void)
+{
+	rand_state = rand_state * 1103515245 + 12345;
+	uint32_t val = rand_state;
+	rand_state = rand_state * 1103515245 + 12345;
+	return (val >> 16) | (rand_state & 0xffff0000);
+}
+
+/** Opaque source replaces destination */
+PCUT_TEST(over_opaque)
+{
+	PCUT_ASSERT_INT_EQUALS(PIXEL(255, 10, 20, 30),
+	    compose_over(PIXEL(255, 10, 20, 30), PIXEL(255, 200, 100, 50)));
+}
+
+/** Transparent source leaves opaque destination intact */
+PCUT_TEST(over_transparent)
+{
+	PCUT_ASSERT_INT_EQUALS(PIXEL(255, 200, 100, 50),
+	    compose_over(PIXEL(0, 10, 20, 30), PIXEL(255, 200, 100, 50)));
+}
+
+/** Half-transparent source over opaque destination */
+PCUT_TEST(over_blend)
+{
+	PCUT_ASSERT_INT_EQUALS(PIXEL(255, 128, 64, 0),
+	    compose_over(PIXEL(128, 255, 128, 0), PIXEL(255, 0, 0, 0)));
+}
+
+/** Span kernel gives the same result as composing each pixel */
+PCUT_TEST(span_over)
+{
+	pixel_t src[SPAN_SIZE];
+	pixel_t dst[SPAN_SIZE];
+	pixel_t ref[SPAN_SIZE];
+
+	for (int round = 0; round < 100; round++) {
+		for (size_t i = 0; i < SPAN_SIZE; i++) {
+			src[i] = rand_pixel();
+			if (round % 4 == 0)
+				src[i] |= 0xff000000;
+			dst[i] = rand_pixel();
+			ref[i] = compose_over(src[i], dst[i]);
+		}
+
+		/* Start at different alignment */
+		size_t off = round % 4;
+		for (size_t i = 0; i < off; i++)
+			ref[i] = dst[i];
+
+		compose_span_over(dst + off, src + off, SPAN_SIZE - off);
+
+		for (size_t i = 0; i < SPAN_SIZE; i++)
+			PCUT_ASSERT_INT_EQUALS(ref[i], dst[i]);
+	}
+}
+
+PCUT_TEST(span_src)
+{
+	pixel_t src[SPAN_SIZE];
+	pixel_t dst[SPAN_SIZE];
+
+	for (size_t i = 0; i < SPAN_SIZE; i++) {
+		src[i] = rand_pixel();
+		dst[i] = rand_pixel();
+	}
+
+	compose_span_src(dst, src, SPAN_SIZE);
+
+	for (size_t i = 0; i < SPAN_SIZE; i++)
+		PCUT_ASSERT_INT_EQUALS(src[i], dst[i]);
+}
+
+PCUT_TEST(get_span)
+{
+	PCUT_ASSERT_TRUE(compose_get_span(compose_src) == compose_span_src);
+	PCUT_ASSERT_TRUE(compose_get_span(compose_over) == compose_span_over);
+	PCUT_ASSERT_NULL(compose_get_span(compose_xor));
+}
+
+PCUT_EXPORT(compose);
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include "../region.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(region);
+
+/** Size of the plane used to verify regions */
+#define GRID_SIZE  48
+
+typedef bool grid_t[GRID_SIZE][GRID_SIZE];
+
+static uint32_t rand_state = 7;
+
+static sysarg_t rand_coord(sysarg_t max)
+{
+	rand_state = rand_state * 1103515245 + 12345;
+	return (rand_state >> 16) % max;
+}
+
+static void grid_rect(grid_t grid, sysarg_t x, sysarg_t y, sysarg_t w,
+    sysarg_t h, bool val)
+{
+	for (sysarg_t j = y; j < y + h; j++) {
+		for (sysarg_t i = x; i < x + w; i++)
+			grid[j][i] = val;
+	}
+}
+
+/** Check that rectangles of region are disjoint and compare with grid.
+ *
+ * @param exact Region must match the grid exactly, otherwise it only
+ *              has to cover it
+ */
+static void region_check(region_t *region, grid_t grid, bool exact)
+{
+	grid_t cover = { { false } };
+
+	for (size_t k = 0; k < region->count; k++) {
+		region_rect_t *r = &region->rects[k];
+
+		PCUT_ASSERT_TRUE(r->w > 0 && r->h > 0);
+
+		for (sysarg_t j = r->y; j < r->y + r->h; j++) {
+			for (sysarg_t i = r->x; i < r->x + r->w; i++) {
+				PCUT_ASSERT_FALSE(cover[j][i]);
+				cover[j][i] = true;
+			}
+		}
+	}
+
+	for (sysarg_t j = 0; j < GRID_SIZE; j++) {
+		for (sysarg_t i = 0; i < GRID_SIZE; i++) {
+			if (exact)
+				PCUT_ASSERT_INT_EQUALS(grid[j][i], cover[j][i]);
+			else if (grid[j][i])
+				PCUT_ASSERT_TRUE(cover[j][i]);
+		}
+	}
+}
+
+PCUT_TEST(empty)
+{
+	region_t region;
+	sysarg_t x, y, w, h;
+
+	region_init(&region);
+	PCUT_ASSERT_TRUE(region_is_empty(&region));
+
+	region_union(&region, 5, 5, 0, 10);
+	PCUT_ASSERT_TRUE(region_is_empty(&region));
+
+	region_bounds(&region, &x, &y, &w, &h);
+	PCUT_ASSERT_INT_EQUALS(0, w);
+	PCUT_ASSERT_INT_EQUALS(0, h);
+}
+
+/** Union of adjacent rectangles coalesces into one rectangle */
+PCUT_TEST(union_coalesce)
+{
+	region_t region;
+
+	region_init(&region);
+	region_union(&region, 0, 0, 10, 10);
+	region_union(&region, 10, 0, 10, 10);
+	region_union(&region, 0, 10, 20, 5);
+
+	PCUT_ASSERT_INT_EQUALS(1, region.count);
+	PCUT_ASSERT_INT_EQUALS(0, region.rects[0].x);
+	PCUT_ASSERT_INT_EQUALS(0, region.rects[0].y);
+	PCUT_ASSERT_INT_EQUALS(20, region.rects[0].w);
+	PCUT_ASSERT_INT_EQUALS(15, region.rects[0].h);
+}
+
+/** Subtracting a rectangle from the middle leaves a frame */
+PCUT_TEST(subtract_hole)
+{
+	region_t region;
+	grid_t grid = { { false } };
+
+	region_init(&region);
+	region_union(&region, 0, 0, 30, 30);
+	region_subtract(&region, 10, 10, 10, 10);
+
+	grid_rect(grid, 0, 0, 30, 30, true);
+	grid_rect(grid, 10, 10, 10, 10, false);
+
+	PCUT_ASSERT_INT_EQUALS(4, region.count);
+	region_check(&region, grid, true);
+
+	region_subtract(&region, 0, 0, 30, 30);
+	PCUT_ASSERT_TRUE(region_is_empty(&region));
+}
+
+PCUT_TEST(intersect)
+{
+	region_t region;
+	region_t isec;
+	grid_t grid = { { false } };
+
+	region_init(&region);
+	region_union(&region, 0, 0, 20, 20);
+	region_union(&region, 25, 25, 10, 10);
+	region_intersect(&isec, &region, 15, 15, 15, 15);
+
+	grid_rect(grid, 15, 15, 5, 5, true);
+	grid_rect(grid, 25, 25, 5, 5, true);
+	region_check(&isec, grid, true);
+}
+
+/** Huge rectangles are clipped so that their edges do not overflow */
+PCUT_TEST(overflow)
+{
+	region_t region;
+
+	region_init(&region);
+	region_union(&region, 10, 10, (sysarg_t) -1, (sysarg_t) -1);
+	PCUT_ASSERT_INT_EQUALS(1, region.count);
+	PCUT_ASSERT_INT_EQUALS((sysarg_t) -1, region.rects[0].x +
+	    region.rects[0].w);
+
+	region_subtract(&region, 0, 0, 20, 20);
+	PCUT_ASSERT_INT_EQUALS(2, region.count);
+}
+
+/** Random operations give the same result as a pixel grid */
+PCUT_TEST(random)
+{
+	for (int round = 0; round < 200; round++) {
+		region_t region;
+		grid_t grid = { { false } };
+		bool exact = true;
+
+		region_init(&region);
+
+		for (int op = 0; op < 12; op++) {
+			sysarg_t x = rand_coord(GRID_SIZE - 1);
+			sysarg_t y = rand_coord(GRID_SIZE - 1);
+			sysarg_t w = 1 + rand_coord(GRID_SIZE - x);
+			sysarg_t h = 1 + rand_coord(GRID_SIZE - y);
+			bool add = rand_coord(3) != 0;
+
+			if (w > GRID_SIZE - x)
+				w = GRID_SIZE - x;
+			if (h > GRID_SIZE - y)
+				h = GRID_SIZE - y;
+
+			/*
+			 * Regions close to the limit may be approximated,
+			 * after that only coverage can be checked.
+			 */
+			if (region.count + 4 >= REGION_MAX_RECTS / 2)
+				exact = false;
+
+			if (add)
+				region_union(&region, x, y, w, h);
+			else
+				region_subtract(&region, x, y, w, h);
+
+			grid_rect(grid, x, y, w, h, add);
+			region_check(&region, grid, exact);
+		}
+	}
+}
+
+PCUT_EXPORT(region);
@@ -60,6 +60,9 @@
 
 #define VIRTIO_FEATURES_0_31	0
 
+/** Driver can use descriptors with the VIRTQ_DESC_F_INDIRECT flag set */
+#define VIRTIO_F_INDIRECT_DESC	(1U << 28)
+
 /** Common configuration structure layout according to VIRTIO version 1.0 */
 typedef struct virtio_pci_common_cfg {
 	ioport32_t device_feature_select;
@@ -194,13 +197,18 @@ extern void virtio_create_desc_free_list(virtio_dev_t *, uint16_t, uint16_t,
 extern uint16_t virtio_alloc_desc(virtio_dev_t *, uint16_t, uint16_t *);
 extern void virtio_free_desc(virtio_dev_t *, uint16_t, uint16_t *, uint16_t);
 
+extern void virtio_virtq_enqueue_available(virtio_dev_t *, uint16_t, uint16_t);
+extern void virtio_virtq_notify(virtio_dev_t *, uint16_t);
 extern void virtio_virtq_produce_available(virtio_dev_t *, uint16_t, uint16_t);
 extern bool virtio_virtq_consume_used(virtio_dev_t *, uint16_t, uint16_t *,
     uint32_t *);
 
+extern uint16_t virtio_virtq_max_size(virtio_dev_t *, uint16_t);
 extern errno_t virtio_virtq_setup(virtio_dev_t *, uint16_t, uint16_t);
 extern void virtio_virtq_teardown(virtio_dev_t *, uint16_t);
 
+extern errno_t virtio_device_setup_negotiate(virtio_dev_t *, uint32_t,
+    uint32_t, uint32_t *);
 extern errno_t virtio_device_setup_start(virtio_dev_t *, uint32_t);
 extern void virtio_device_setup_fail(virtio_dev_t *);
 extern void virtio_device_setup_finalize(virtio_dev_t *);
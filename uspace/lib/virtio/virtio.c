@@ -168,7 +168,16 @@ void virtio_free_desc(virtio_dev_t *vdev, uint16_t num, uint16_t *head,
 	fibril_mutex_unlock(&q->lock);
 }
 
-void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
+/** Put a descriptor chain into the available ring without notifying
+ *
+ * Several descriptor chains can be made available this way and then the
+ * device notified only once by virtio_virtq_notify().
+ *
+ * @param vdev[in]    VIRTIO device.
+ * @param num[in]     Index of the virtqueue.
+ * @param descno[in]  Head of the descriptor chain.
+ */
+void virtio_virtq_enqueue_available(virtio_dev_t *vdev, uint16_t num,
     uint16_t descno)
 {
 	virtq_t *q = &vdev->queues[num];
@@ -178,11 +187,33 @@ void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
 	pio_write_le16(&q->avail->ring[idx % q->queue_size], descno);
 	write_barrier();
 	pio_write_le16(&q->avail->idx, idx + 1);
-	write_barrier();
-	pio_write_le16(q->notify, num);
 	fibril_mutex_unlock(&q->lock);
 }
 
+/** Notify the device about new available descriptor chains
+ *
+ * The notification is skipped if the device asked not to be notified.
+ *
+ * @param vdev[in]  VIRTIO device.
+ * @param num[in]   Index of the virtqueue.
+ */
+void virtio_virtq_notify(virtio_dev_t *vdev, uint16_t num)
+{
+	virtq_t *q = &vdev->queues[num];
+
+	memory_barrier();
+	if (pio_read_le16(&q->used->flags) & VIRTQ_USED_F_NO_NOTIFY)
+		return;
+	pio_write_le16(q->notify, num);
+}
+
+void virtio_virtq_produce_available(virtio_dev_t *vdev, uint16_t num,
+    uint16_t descno)
+{
+	virtio_virtq_enqueue_available(vdev, num, descno);
+	virtio_virtq_notify(vdev, num);
+}
+
 bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
     uint16_t *descno, uint32_t *len)
 {
@@ -204,6 +235,21 @@ bool virtio_virtq_consume_used(virtio_dev_t *vdev, uint16_t num,
 	return true;
 }
 
+/** Get the maximum size of a virtqueue supported by the device
+ *
+ * @param vdev[in]  VIRTIO device.
+ * @param num[in]   Index of the virtqueue.
+ *
+ * @return  Maximum number of descriptors, zero if the queue is not available.
+ */
+uint16_t virtio_virtq_max_size(virtio_dev_t *vdev, uint16_t num)
+{
+	virtio_pci_common_cfg_t *cfg = vdev->common_cfg;
+
+	pio_write_le16(&cfg->queue_select, num);
+	return pio_read_le16(&cfg->queue_size);
+}
+
 errno_t virtio_virtq_setup(virtio_dev_t *vdev, uint16_t num, uint16_t size)
 {
 	virtq_t *q = &vdev->queues[num];
@@ -297,8 +343,17 @@ void virtio_virtq_teardown(virtio_dev_t *vdev, uint16_t num)
 /**
  * Perform device initialization as described in section 3.1.1 of the
  * specification, steps 1 - 6.
+ *
+ * @param vdev[in]       VIRTIO device.
+ * @param required[in]   Features the driver cannot work without.
+ * @param optional[in]   Features the driver uses if offered by the device.
+ * @param accepted[out]  If not NULL, receives the accepted features.
+ *
+ * @return  EOK on success, ENOTSUP if a required feature is not offered or
+ *          the device rejects the accepted subset.
  */
-errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
+errno_t virtio_device_setup_negotiate(virtio_dev_t *vdev, uint32_t required,
+    uint32_t optional, uint32_t *accepted)
 {
 	virtio_pci_common_cfg_t *cfg = vdev->common_cfg;
 
@@ -320,9 +375,9 @@ errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
 
 	ddf_msg(LVL_NOTE, "offered features %x", device_features);
 
-	if (features != (features & device_features))
+	if (required != (required & device_features))
 		return ENOTSUP;
-	features &= device_features;
+	uint32_t features = (required | optional) & device_features;
 
 	/* 4. Write the accepted feature flags */
 	pio_write_le32(&cfg->driver_feature_select, VIRTIO_FEATURES_0_31);
@@ -339,9 +394,16 @@ errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
 	if (!(status & VIRTIO_DEV_STATUS_FEATURES_OK))
 		return ENOTSUP;
 
+	if (accepted)
+		*accepted = features;
 	return EOK;
 }
 
+errno_t virtio_device_setup_start(virtio_dev_t *vdev, uint32_t features)
+{
+	return virtio_device_setup_negotiate(vdev, features, 0, NULL);
+}
+
 /**
  * Perform device initialization as described in section 3.1.1 of the
  * specification, step 8 (go live).
@@ -34,11 +34,17 @@
  */
 
 #include <macros.h>
+#include <str_error.h>
 #include <stdlib.h>
 
 #include "audio_data.h"
 #include "log.h"
 
+/** Output frames converted at once when resampling */
+#define AUDIO_PIPE_RESAMPLE_FRAMES  256
+/** Input frames converted at once when resampling */
+#define AUDIO_PIPE_RESAMPLE_INPUT  (AUDIO_PIPE_RESAMPLE_FRAMES * 8)
+
 /**
  * Create reference counted buffer out of ordinary data buffer.
  * @param data audio buffer. The memory passed will be freed eventually.
@@ -186,6 +192,23 @@ void audio_pipe_init(audio_pipe_t *pipe)
 	fibril_mutex_initialize(&pipe->guard);
 	pipe->frames = 0;
 	pipe->bytes = 0;
+	pipe->resampler = NULL;
+	pipe->resampler_in = NULL;
+	pipe->resampler_out = NULL;
+}
+
+/**
+ * Release sample rate converter of a pipe.
+ * @param pipe The audio pipe.
+ */
+static void audio_pipe_resampler_fini(audio_pipe_t *pipe)
+{
+	pcm_resampler_destroy(pipe->resampler);
+	free(pipe->resampler_in);
+	free(pipe->resampler_out);
+	pipe->resampler = NULL;
+	pipe->resampler_in = NULL;
+	pipe->resampler_out = NULL;
 }
 
 /**
@@ -199,6 +222,7 @@ void audio_pipe_fini(audio_pipe_t *pipe)
 		audio_data_t *adata = audio_pipe_pop(pipe);
 		audio_data_unref(adata);
 	}
+	audio_pipe_resampler_fini(pipe);
 }
 
 /**
@@ -247,6 +271,115 @@ audio_data_t *audio_pipe_pop(audio_pipe_t *pipe)
 	return adata;
 }
 
+/**
+ * Resample frames and mix them into the target buffer.
+ * @param pipe The pipe that holds the converter.
+ * @param data Target buffer.
+ * @param frames Target buffer size in frames.
+ * @param f Target data format.
+ * @param src Source frames.
+ * @param src_frames Number of source frames.
+ * @param sf Source data format.
+ * @param src_used Place to store the number of consumed source frames.
+ * @return Number of frames mixed into the target buffer.
+ *
+ * The converter keeps its history across calls, it is recreated only if
+ * the rates or the channel count change.
+ */
+static size_t audio_pipe_resample(audio_pipe_t *pipe, void *data,
+    size_t frames, const pcm_format_t *f, const void *src, size_t src_frames,
+    const pcm_format_t *sf, size_t *src_used)
+{
+	*src_used = 0;
+
+	if (!pipe->resampler || pipe->resampler_in_rate != sf->sampling_rate ||
+	    !pcm_format_same(&pipe->resampler_format, f)) {
+		audio_pipe_resampler_fini(pipe);
+		errno_t rc = pcm_resampler_create(f->channels,
+		    sf->sampling_rate, f->sampling_rate, &pipe->resampler);
+		if (rc != EOK) {
+			log_error("Failed to create resampler %u -> %u: %s",
+			    sf->sampling_rate, f->sampling_rate, str_error(rc));
+			return 0;
+		}
+		pipe->resampler_in = malloc(AUDIO_PIPE_RESAMPLE_INPUT *
+		    f->channels * sizeof(float));
+		pipe->resampler_out = malloc(AUDIO_PIPE_RESAMPLE_FRAMES *
+		    f->channels * sizeof(float));
+		if (!pipe->resampler_in || !pipe->resampler_out) {
+			log_error("Failed to allocate resampler buffers");
+			audio_pipe_resampler_fini(pipe);
+			return 0;
+		}
+		pipe->resampler_in_rate = sf->sampling_rate;
+		pipe->resampler_format = *f;
+	}
+
+	const size_t out_frames = min(frames, AUDIO_PIPE_RESAMPLE_FRAMES);
+	const size_t in_frames = min(src_frames,
+	    min(pcm_resampler_input_frames(pipe->resampler, out_frames),
+	    AUDIO_PIPE_RESAMPLE_INPUT));
+
+	errno_t rc = pcm_format_to_float(src, in_frames, sf,
+	    pipe->resampler_in, f->channels);
+	if (rc != EOK) {
+		log_error("Failed to convert audio data: %s", str_error(rc));
+		return 0;
+	}
+
+	const size_t produced = pcm_resampler_process(pipe->resampler,
+	    pipe->resampler_in, in_frames, src_used, pipe->resampler_out,
+	    out_frames);
+	pcm_format_mix_float(data, pipe->resampler_out, produced, f);
+	return produced;
+}
+
+/**
+ * Mix frames into the provided buffer.
+ * @param pipe The pipe that holds the sample rate converter.
+ * @param data Target buffer.
+ * @param frames Target buffer size in frames.
+ * @param f Target data format.
+ * @param src Source frames.
+ * @param src_frames Number of source frames.
+ * @param sf Source data format.
+ * @param src_used Place to store the number of consumed source frames.
+ * @return Number of frames mixed into the target buffer.
+ *
+ * Frames with a different sampling rate than @p f are resampled. The caller
+ * has to serialize use of the pipe's converter.
+ */
+size_t audio_pipe_mix_frames(audio_pipe_t *pipe, void *data, size_t frames,
+    const pcm_format_t *f, const void *src, size_t src_frames,
+    const pcm_format_t *sf, size_t *src_used)
+{
+	const size_t dst_frame_size = pcm_format_frame_size(f);
+	const size_t src_frame_size = pcm_format_frame_size(sf);
+
+	if (sf->sampling_rate == f->sampling_rate) {
+		const size_t count = min(frames, src_frames);
+		pcm_format_convert_and_mix(data, count * dst_frame_size, src,
+		    count * src_frame_size, sf, f);
+		*src_used = count;
+		return count;
+	}
+
+	size_t mixed = 0;
+	size_t used = 0;
+	while (mixed < frames && used < src_frames) {
+		size_t in;
+		const size_t out = audio_pipe_resample(pipe,
+		    data + mixed * dst_frame_size, frames - mixed, f,
+		    src + used * src_frame_size, src_frames - used, sf, &in);
+		if (out == 0 && in == 0)
+			break;
+		mixed += out;
+		used += in;
+	}
+	*src_used = used;
+	return mixed;
+}
+
 /**
  * Use data store in a pipe and mix it into the provided buffer.
  * @param pipe The piep that should provide data.
@@ -254,6 +387,8 @@ audio_data_t *audio_pipe_pop(audio_pipe_t *pipe)
  * @param size Target buffer size.
  * @param format Target data format.
  * @return Size of the target buffer used.
+ *
+ * Data with a different sampling rate than @p f are resampled.
  */
 size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *data,
     size_t size, const pcm_format_t *f)
@@ -275,29 +410,27 @@ size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *data,
 		    pcm_format_frame_size(&alink->adata->format);
 		const size_t available_frames =
 		    audio_data_link_available_frames(alink);
-		const size_t copy_frames = min(available_frames, needed_frames);
-		const size_t dst_copy_size = copy_frames * dst_frame_size;
-		const size_t src_copy_size = copy_frames * src_frame_size;
+		size_t src_frames;
+		const size_t dst_frames = audio_pipe_mix_frames(pipe, data,
+		    needed_frames, f, audio_data_link_start(alink),
+		    available_frames, &alink->adata->format, &src_frames);
+		if (dst_frames == 0 && src_frames == 0)
+			break;
 
+		const size_t src_copy_size = src_frames * src_frame_size;
+		const size_t dst_copy_size = dst_frames * dst_frame_size;
 		assert(src_copy_size <= audio_data_link_remain_size(alink));
 
-		/* Copy audio data */
-		pcm_format_convert_and_mix(data, dst_copy_size,
-		    audio_data_link_start(alink), src_copy_size,
-		    &alink->adata->format, f);
-
 		/* Update values */
-		needed_frames -= copy_frames;
+		needed_frames -= dst_frames;
 		copied_size += dst_copy_size;
 		data += dst_copy_size;
 		alink->position += src_copy_size;
 		pipe->bytes -= src_copy_size;
-		pipe->frames -= copy_frames;
+		pipe->frames -= src_frames;
 		if (audio_data_link_remain_size(alink) == 0) {
 			list_remove(&alink->link);
 			audio_data_link_destroy(alink);
-		} else {
-			assert(needed_frames == 0);
 		}
 	}
 	fibril_mutex_unlock(&pipe->guard);
@@ -41,6 +41,7 @@
 #include <errno.h>
 #include <fibril_synch.h>
 #include <pcm/format.h>
+#include <pcm/resample.h>
 
 /** Reference counted audio buffer */
 typedef struct {
@@ -64,6 +65,16 @@ typedef struct {
 	size_t frames;
 	/** List access synchronization */
 	fibril_mutex_t guard;
+	/** Converter of data whose sampling rate differs from the target */
+	pcm_resampler_t *resampler;
+	/** Input rate the converter was created for */
+	unsigned resampler_in_rate;
+	/** Output format the converter was created for */
+	pcm_format_t resampler_format;
+	/** Converter input in float samples */
+	float *resampler_in;
+	/** Converter output in float samples */
+	float *resampler_out;
 } audio_pipe_t;
 
 audio_data_t *audio_data_create(void *data, size_t size,
@@ -79,6 +90,9 @@ audio_data_t *audio_pipe_pop(audio_pipe_t *pipe);
 
 size_t audio_pipe_mix_data(audio_pipe_t *pipe, void *buffer, size_t size,
     const pcm_format_t *f);
+size_t audio_pipe_mix_frames(audio_pipe_t *pipe, void *data, size_t frames,
+    const pcm_format_t *f, const void *src, size_t src_frames,
+    const pcm_format_t *sf, size_t *src_used);
 
 /**
  * Total bytes getter.
@@ -34,6 +34,7 @@
 /** @file
  */
 
+#include <as.h>
 #include <macros.h>
 #include <errno.h>
 #include <stdlib.h>
@@ -171,8 +172,47 @@ typedef struct hound_ctx_stream {
 	fibril_mutex_t guard;
 	/** buffer status change condition */
 	fibril_condvar_t change;
+	/** Ring shared with the client, NULL if data are sent by IPC */
+	hound_ring_t *ring;
+	/** Data size of the shared ring, fixed when the ring is received */
+	size_t ring_size;
+	/** Bytes consumed from the shared ring */
+	size_t ring_read;
+	/** Stream received data */
+	bool started;
+	/** Stream is being drained */
+	bool draining;
+	/** Number of mixing periods the stream could not fill */
+	size_t xruns;
 } hound_ctx_stream_t;
 
+/**
+ * Shared ring fill helper.
+ * @param stream The stream, must have a shared ring.
+ * @return Number of bytes ready in the ring.
+ *
+ * The write index is not trusted, fill is capped at the ring size.
+ */
+static size_t stream_ring_fill(hound_ctx_stream_t *stream)
+{
+	const size_t write = atomic_load_explicit(&stream->ring->write,
+	    memory_order_acquire);
+	return min(write - stream->ring_read, stream->ring_size);
+}
+
+/**
+ * Buffered data helper.
+ * @param stream The stream.
+ * @return Number of bytes buffered in the pipe and the shared ring.
+ */
+static size_t stream_buffered(hound_ctx_stream_t *stream)
+{
+	size_t bytes = audio_pipe_bytes(&stream->fifo);
+	if (stream->ring)
+		bytes += stream_ring_fill(stream);
+	return bytes;
+}
+
 /**
  * New stream append helper.
  * @param ctx hound context.
@@ -257,6 +297,12 @@ hound_ctx_stream_t *hound_ctx_create_stream(hound_ctx_t *ctx, int flags,
 		stream->flags = flags;
 		stream->format = format;
 		stream->allowed_size = buffer_size;
+		stream->ring = NULL;
+		stream->ring_size = 0;
+		stream->ring_read = 0;
+		stream->started = false;
+		stream->draining = false;
+		stream->xruns = 0;
 		stream_append(ctx, stream);
 		log_verbose("CTX: %p added stream; flags:%#x ch: %u r:%u f:%s",
 		    ctx, flags, format.channels, format.sampling_rate,
@@ -275,15 +321,18 @@ void hound_ctx_destroy_stream(hound_ctx_stream_t *stream)
 {
 	if (stream) {
 		stream_remove(stream->ctx, stream);
-		if (audio_pipe_bytes(&stream->fifo))
+		if (stream_buffered(stream))
 			log_warning("Destroying stream with non empty buffer");
 		log_verbose("CTX: %p remove stream (%zu/%zu); "
-		    "flags:%#x ch: %u r:%u f:%s",
-		    stream->ctx, audio_pipe_bytes(&stream->fifo),
+		    "flags:%#x ch: %u r:%u f:%s xruns: %zu",
+		    stream->ctx, stream_buffered(stream),
 		    stream->allowed_size, stream->flags,
 		    stream->format.channels, stream->format.sampling_rate,
-		    pcm_sample_format_str(stream->format.sample_format));
+		    pcm_sample_format_str(stream->format.sample_format),
+		    stream->xruns);
 		audio_pipe_fini(&stream->fifo);
+		if (stream->ring)
+			as_area_destroy(stream->ring);
 		free(stream);
 	}
 }
@@ -312,6 +361,8 @@ errno_t hound_ctx_stream_write(hound_ctx_stream_t *stream, void *data,
 
 	const errno_t ret =
 	    audio_pipe_push_data(&stream->fifo, data, size, stream->format);
+	if (ret == EOK)
+		stream->started = true;
 	fibril_mutex_unlock(&stream->guard);
 	if (ret == EOK)
 		fibril_condvar_signal(&stream->change);
@@ -348,6 +399,50 @@ errno_t hound_ctx_stream_read(hound_ctx_stream_t *stream, void *data, size_t siz
 	return EEMPTY;
 }
 
+/**
+ * Mix data from the shared ring to the destination buffer.
+ * @param stream The source stream, must have a shared ring.
+ * @param data Destination audio buffer.
+ * @param size Size of the @p data buffer.
+ * @param f Destination data format.
+ * @return Size of the destination buffer touched with stream's data.
+ */
+static size_t stream_ring_mix(hound_ctx_stream_t *stream, void *data,
+    size_t size, const pcm_format_t *f)
+{
+	const size_t frame_size = pcm_format_frame_size(&stream->format);
+	const size_t dst_frame_size = pcm_format_frame_size(f);
+	size_t frames = stream_ring_fill(stream) / frame_size;
+	size_t needed = size / dst_frame_size;
+	size_t mixed_size = 0;
+
+	if (frames > 0)
+		stream->started = true;
+
+	while (needed > 0 && frames > 0) {
+		/* Frames never wrap, the ring size is a multiple of frames */
+		const size_t pos = stream->ring_read % stream->ring_size;
+		const size_t contiguous =
+		    min(frames, (stream->ring_size - pos) / frame_size);
+		size_t used;
+		const size_t mixed = audio_pipe_mix_frames(&stream->fifo, data,
+		    needed, f, stream->ring->data + pos, contiguous,
+		    &stream->format, &used);
+		if (mixed == 0 && used == 0)
+			break;
+
+		stream->ring_read += used * frame_size;
+		frames -= used;
+		needed -= mixed;
+		data += mixed * dst_frame_size;
+		mixed_size += mixed * dst_frame_size;
+	}
+
+	atomic_store_explicit(&stream->ring->read, stream->ring_read,
+	    memory_order_release);
+	return mixed_size;
+}
+
 /**
  * Add (mix) stream data to the destination buffer.
  * @param stream The source stream.
@@ -355,14 +450,20 @@ errno_t hound_ctx_stream_read(hound_ctx_stream_t *stream, void *data, size_t siz
  * @param size Size of the @p data buffer.
  * @param format Destination data format.
  * @return Size of the destination buffer touch with stream's data.
+ *
+ * Data written by IPC are mixed first, the shared ring follows.
  */
 size_t hound_ctx_stream_add_self(hound_ctx_stream_t *stream, void *data,
     size_t size, const pcm_format_t *f)
 {
 	assert(stream);
 	fibril_mutex_lock(&stream->guard);
-	const size_t ret = audio_pipe_mix_data(&stream->fifo, data, size, f);
-	fibril_condvar_signal(&stream->change);
+	size_t ret = audio_pipe_mix_data(&stream->fifo, data, size, f);
+	if (stream->ring && ret < size)
+		ret += stream_ring_mix(stream, data + ret, size - ret, f);
+	if (ret < size && stream->started && !stream->draining)
+		++stream->xruns;
+	fibril_condvar_broadcast(&stream->change);
 	fibril_mutex_unlock(&stream->guard);
 	return ret;
 }
@@ -375,9 +476,94 @@ void hound_ctx_stream_drain(hound_ctx_stream_t *stream)
 {
 	assert(stream);
 	log_debug("Draining stream");
+	const size_t frame_size = pcm_format_frame_size(&stream->format);
 	fibril_mutex_lock(&stream->guard);
-	while (audio_pipe_bytes(&stream->fifo))
+	stream->draining = true;
+	while (stream_buffered(stream) >= frame_size)
 		fibril_condvar_wait(&stream->change, &stream->guard);
+	stream->draining = false;
+	fibril_mutex_unlock(&stream->guard);
+}
+
+/**
+ * Use a shared ring for stream data.
+ * @param stream Playback stream.
+ * @param ring Ring in an address space area shared by the client.
+ * @param area_size Size of the area.
+ * @return Error code.
+ */
+errno_t hound_ctx_stream_share(hound_ctx_stream_t *stream, hound_ring_t *ring,
+    size_t area_size)
+{
+	assert(stream);
+	assert(ring);
+
+	if (hound_ctx_is_record(stream->ctx))
+		return ENOTSUP;
+	if (area_size < sizeof(hound_ring_t))
+		return EINVAL;
+
+	const size_t size = ring->size;
+	const size_t frame_size = pcm_format_frame_size(&stream->format);
+	if (size == 0 || size > area_size - sizeof(hound_ring_t) ||
+	    frame_size == 0 || size % frame_size != 0)
+		return EINVAL;
+
+	fibril_mutex_lock(&stream->guard);
+	if (stream->ring) {
+		fibril_mutex_unlock(&stream->guard);
+		return EEXIST;
+	}
+	stream->ring = ring;
+	stream->ring_size = size;
+	stream->ring_read = 0;
+	atomic_store_explicit(&ring->read, 0, memory_order_release);
+	fibril_mutex_unlock(&stream->guard);
+	log_verbose("CTX: %p stream uses shared ring of %zu bytes",
+	    stream->ctx, size);
+	return EOK;
+}
+
+/**
+ * Block until the shared ring drains below a threshold.
+ * @param stream Stream with a shared ring.
+ * @param fill Threshold in bytes.
+ * @return Error code.
+ *
+ * Returns early if the stream underruns in the meantime.
+ */
+errno_t hound_ctx_stream_wait(hound_ctx_stream_t *stream, size_t fill)
+{
+	assert(stream);
+	fibril_mutex_lock(&stream->guard);
+	if (!stream->ring) {
+		fibril_mutex_unlock(&stream->guard);
+		return EINVAL;
+	}
+	const size_t xruns = stream->xruns;
+	while (stream_ring_fill(stream) > fill && stream->xruns == xruns)
+		fibril_condvar_wait(&stream->change, &stream->guard);
+	fibril_mutex_unlock(&stream->guard);
+	return EOK;
+}
+
+/**
+ * Get stream latency statistics.
+ * @param stream The stream.
+ * @param stats Place to store the statistics.
+ */
+void hound_ctx_stream_stats(hound_ctx_stream_t *stream,
+    hound_stream_stats_t *stats)
+{
+	assert(stream);
+	assert(stats);
+	fibril_mutex_lock(&stream->guard);
+	stats->buffered = stream_buffered(stream);
+	stats->capacity = stream->ring ? stream->ring_size :
+	    stream->allowed_size;
+	stats->latency = pcm_format_size_to_usec(stats->buffered,
+	    &stream->format);
+	stats->xruns = stream->xruns;
 	fibril_mutex_unlock(&stream->guard);
 }
 
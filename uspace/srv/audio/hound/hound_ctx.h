@@ -76,6 +76,11 @@ errno_t hound_ctx_stream_read(hound_ctx_stream_t *stream, void *buffer, size_t s
 size_t hound_ctx_stream_add_self(hound_ctx_stream_t *stream, void *data,
     size_t size, const pcm_format_t *f);
 void hound_ctx_stream_drain(hound_ctx_stream_t *stream);
+errno_t hound_ctx_stream_share(hound_ctx_stream_t *stream, hound_ring_t *ring,
+    size_t area_size);
+errno_t hound_ctx_stream_wait(hound_ctx_stream_t *stream, size_t fill);
+void hound_ctx_stream_stats(hound_ctx_stream_t *stream,
+    hound_stream_stats_t *stats);
 
 #endif
 
@@ -151,6 +151,23 @@ static errno_t iface_stream_data_write(void *stream, void *buffer, size_t size)
 	return hound_ctx_stream_write(stream, buffer, size);
 }
 
+static errno_t iface_stream_share(void *stream, hound_ring_t *ring,
+    size_t size)
+{
+	return hound_ctx_stream_share(stream, ring, size);
+}
+
+static errno_t iface_stream_wait(void *stream, size_t fill)
+{
+	return hound_ctx_stream_wait(stream, fill);
+}
+
+static errno_t iface_stream_stats(void *stream, hound_stream_stats_t *stats)
+{
+	hound_ctx_stream_stats(stream, stats);
+	return EOK;
+}
+
 hound_server_iface_t hound_iface = {
 	.add_context = iface_add_context,
 	.rem_context = iface_rem_context,
@@ -163,5 +180,8 @@ hound_server_iface_t hound_iface = {
 	.drain_stream = iface_drain_stream,
 	.stream_data_write = iface_stream_data_write,
 	.stream_data_read = iface_stream_data_read,
+	.stream_share = iface_stream_share,
+	.stream_wait = iface_stream_wait,
+	.stream_stats = iface_stream_stats,
 	.server = NULL,
 };
@@ -173,6 +173,7 @@ static errno_t file_bd_init(const char *fname)
 {
 	bd_srvs_init(&bd_srvs);
 	bd_srvs.ops = &file_bd_ops;
+	bd_srvs.queue_workers = BD_QUEUE_WORKERS_MAX;
 
 	async_set_fallback_port_handler(file_bd_connection, NULL);
 	errno_t rc = loc_server_register(NAME);
@@ -175,6 +175,7 @@ static bool rd_init(void)
 
 	bd_srvs_init(&bd_srvs);
 	bd_srvs.ops = &rd_bd_ops;
+	bd_srvs.queue_workers = BD_QUEUE_WORKERS_MAX;
 
 	async_set_fallback_port_handler(rd_client_conn, NULL);
 	ret = loc_server_register(NAME);
@@ -64,6 +64,7 @@ static errno_t vbds_bd_open(bd_srvs_t *, bd_srv_t *);
 static errno_t vbds_bd_close(bd_srv_t *);
 static errno_t vbds_bd_read_blocks(bd_srv_t *, aoff64_t, size_t, void *, size_t);
 static errno_t vbds_bd_sync_cache(bd_srv_t *, aoff64_t, size_t);
+static errno_t vbds_bd_discard_blocks(bd_srv_t *, aoff64_t, size_t);
 static errno_t vbds_bd_write_blocks(bd_srv_t *, aoff64_t, size_t, const void *,
     size_t);
 static errno_t vbds_bd_get_block_size(bd_srv_t *, size_t *);
@@ -88,6 +89,7 @@ static bd_ops_t vbds_bd_ops = {
 	.close = vbds_bd_close,
 	.read_blocks = vbds_bd_read_blocks,
 	.sync_cache = vbds_bd_sync_cache,
+	.discard_blocks = vbds_bd_discard_blocks,
 	.write_blocks = vbds_bd_write_blocks,
 	.get_block_size = vbds_bd_get_block_size,
 	.get_num_blocks = vbds_bd_get_num_blocks
@@ -330,6 +332,7 @@ static errno_t vbds_part_add(vbds_disk_t *disk, label_part_t *lpart,
 
 	bd_srvs_init(&part->bds);
 	part->bds.ops = &vbds_bd_ops;
+	part->bds.queue_workers = BD_QUEUE_WORKERS_MAX;
 	part->bds.sarg = part;
 
 	if (lpinfo.pkind != lpk_extended) {
@@ -1017,6 +1020,25 @@ static errno_t vbds_bd_sync_cache(bd_srv_t *bd, aoff64_t ba, size_t cnt)
 	return rc;
 }
 
+static errno_t vbds_bd_discard_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt)
+{
+	vbds_part_t *part = bd_srv_part(bd);
+	aoff64_t gba;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG2, "vbds_bd_discard_blocks()");
+	fibril_rwlock_read_lock(&part->lock);
+
+	if (vbds_bsa_translate(part, ba, cnt, &gba) != EOK) {
+		fibril_rwlock_read_unlock(&part->lock);
+		return ELIMIT;
+	}
+
+	rc = block_discard(part->disk->svc_id, gba, cnt);
+	fibril_rwlock_read_unlock(&part->lock);
+	return rc;
+}
+
 static errno_t vbds_bd_write_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
     const void *buf, size_t size)
 {
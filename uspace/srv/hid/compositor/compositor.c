@@ -66,6 +66,7 @@
 
 #include <transform.h>
 #include <rectangle.h>
+#include <region.h>
 #include <surface.h>
 #include <cursor.h>
 #include <source.h>
@@ -106,6 +107,8 @@ typedef struct {
 	double angle;
 	uint8_t opacity;
 	surface_t *surface;
+	/** Visible part of the window in the frame being painted */
+	region_t visible;
 } window_t;
 
 static service_id_t winreg_id;
@@ -149,6 +152,14 @@ static LIST_INITIALIZE(viewport_list);
 
 static FIBRIL_MUTEX_INITIALIZE(discovery_mtx);
 
+/** Interval between repaints of the damaged area in microseconds */
+#define FRAME_INTERVAL  16667
+
+static FIBRIL_MUTEX_INITIALIZE(damage_mtx);
+static region_t damage_region;
+static struct timespec last_frame;
+static fibril_timer_t *frame_timer;
+
 /** Input server proxy */
 static input_t *input;
 static bool active = false;
@@ -385,211 +396,278 @@ static void comp_restrict_pointers(void)
 	fibril_mutex_unlock(&pointer_list_mtx);
 }
 
-static void comp_damage(sysarg_t x_dmg_glob, sysarg_t y_dmg_glob,
-    sysarg_t w_dmg_glob, sysarg_t h_dmg_glob)
+/** Paint ghosts and pointers into damaged rectangle of a viewport.
+ *
+ * The rectangles passed for a single frame must be disjoint, since ghosts
+ * are painted by inverting pixels.
+ */
+static void comp_paint_pointers(viewport_t *vp, sysarg_t x_dmg_vp,
+    sysarg_t y_dmg_vp, sysarg_t w_dmg_vp, sysarg_t h_dmg_vp)
 {
-	fibril_mutex_lock(&viewport_list_mtx);
-	fibril_mutex_lock(&window_list_mtx);
-	fibril_mutex_lock(&pointer_list_mtx);
-
-	list_foreach(viewport_list, link, viewport_t, vp) {
-		/* Determine what part of the viewport must be updated. */
-		sysarg_t x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp;
-		surface_get_resolution(vp->surface, &w_dmg_vp, &h_dmg_vp);
-		bool isec_vp = rectangle_intersect(
-		    x_dmg_glob, y_dmg_glob, w_dmg_glob, h_dmg_glob,
-		    vp->pos.x, vp->pos.y, w_dmg_vp, h_dmg_vp,
-		    &x_dmg_vp, &y_dmg_vp, &w_dmg_vp, &h_dmg_vp);
-
-		if (isec_vp) {
-
-			/* Paint background color. */
-			for (sysarg_t y = y_dmg_vp - vp->pos.y; y <  y_dmg_vp - vp->pos.y + h_dmg_vp; ++y) {
-				pixel_t *dst = pixelmap_pixel_at(
-				    surface_pixmap_access(vp->surface), x_dmg_vp - vp->pos.x, y);
-				sysarg_t count = w_dmg_vp;
-				while (count-- != 0) {
-					*dst++ = bg_color;
-				}
-			}
-			surface_add_damaged_region(vp->surface,
-			    x_dmg_vp - vp->pos.x, y_dmg_vp - vp->pos.y, w_dmg_vp, h_dmg_vp);
-
-			transform_t transform;
-			source_t source;
-			drawctx_t context;
-
-			source_init(&source);
-			source_set_filter(&source, filter);
-			drawctx_init(&context, vp->surface);
-			drawctx_set_compose(&context, compose_over);
-			drawctx_set_source(&context, &source);
-
-			/* For each window. */
-			for (link_t *link = window_list.head.prev;
-			    link != &window_list.head; link = link->prev) {
+	/* pointer_list_mtx locked by caller */
 
+	list_foreach(pointer_list, link, pointer_t, ptr) {
+		if (ptr->ghost.surface) {
+
+			sysarg_t x_bnd_ghost, y_bnd_ghost, w_bnd_ghost, h_bnd_ghost;
+			sysarg_t x_dmg_ghost, y_dmg_ghost, w_dmg_ghost, h_dmg_ghost;
+			surface_get_resolution(ptr->ghost.surface, &w_bnd_ghost, &h_bnd_ghost);
+			comp_coord_bounding_rect(0, 0, w_bnd_ghost, h_bnd_ghost, ptr->ghost.transform,
+			    &x_bnd_ghost, &y_bnd_ghost, &w_bnd_ghost, &h_bnd_ghost);
+			bool isec_ghost = rectangle_intersect(
+			    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp,
+			    x_bnd_ghost, y_bnd_ghost, w_bnd_ghost, h_bnd_ghost,
+			    &x_dmg_ghost, &y_dmg_ghost, &w_dmg_ghost, &h_dmg_ghost);
+
+			if (isec_ghost) {
 				/*
-				 * Determine what part of the window intersects with the
-				 * updated area of the current viewport.
+				 * FIXME: Ghost is currently drawn based on the bounding
+				 * rectangle of the window, which is sufficient as long
+				 * as the windows can be rotated only by 90 degrees.
+				 * For ghost to be compatible with arbitrary-angle
+				 * rotation, it should be drawn as four lines adjusted
+				 * by the transformation matrix. That would however
+				 * require to equip libdraw with line drawing functionality.
 				 */
-				window_t *win = list_get_instance(link, window_t, link);
-				if (!win->surface) {
-					continue;
+
+				transform_t transform = ptr->ghost.transform;
+				double_point_t pos;
+				pos.x = vp->pos.x;
+				pos.y = vp->pos.y;
+				transform_translate(&transform, -pos.x, -pos.y);
+
+				pixel_t ghost_color;
+
+				if (y_bnd_ghost == y_dmg_ghost) {
+					for (sysarg_t x = x_dmg_ghost - vp->pos.x;
+					    x < x_dmg_ghost - vp->pos.x + w_dmg_ghost; ++x) {
+						ghost_color = surface_get_pixel(vp->surface,
+						    x, y_dmg_ghost - vp->pos.y);
+						surface_put_pixel(vp->surface,
+						    x, y_dmg_ghost - vp->pos.y, INVERT(ghost_color));
+					}
 				}
-				sysarg_t x_dmg_win, y_dmg_win, w_dmg_win, h_dmg_win;
-				surface_get_resolution(win->surface, &w_dmg_win, &h_dmg_win);
-				comp_coord_bounding_rect(0, 0, w_dmg_win, h_dmg_win, win->transform,
-				    &x_dmg_win, &y_dmg_win, &w_dmg_win, &h_dmg_win);
-				bool isec_win = rectangle_intersect(
-				    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp,
-				    x_dmg_win, y_dmg_win, w_dmg_win, h_dmg_win,
-				    &x_dmg_win, &y_dmg_win, &w_dmg_win, &h_dmg_win);
-
-				if (isec_win) {
-					/*
-					 * Prepare conversion from global coordinates to viewport
-					 * coordinates.
-					 */
-					transform = win->transform;
-					double_point_t pos;
-					pos.x = vp->pos.x;
-					pos.y = vp->pos.y;
-					transform_translate(&transform, -pos.x, -pos.y);
-
-					source_set_transform(&source, transform);
-					source_set_texture(&source, win->surface,
-					    PIXELMAP_EXTEND_TRANSPARENT_SIDES);
-					source_set_alpha(&source, PIXEL(win->opacity, 0, 0, 0));
-
-					drawctx_transfer(&context,
-					    x_dmg_win - vp->pos.x, y_dmg_win - vp->pos.y, w_dmg_win, h_dmg_win);
+
+				if (y_bnd_ghost + h_bnd_ghost == y_dmg_ghost + h_dmg_ghost) {
+					for (sysarg_t x = x_dmg_ghost - vp->pos.x;
+					    x < x_dmg_ghost - vp->pos.x + w_dmg_ghost; ++x) {
+						ghost_color = surface_get_pixel(vp->surface,
+						    x, y_dmg_ghost - vp->pos.y + h_dmg_ghost - 1);
+						surface_put_pixel(vp->surface,
+						    x, y_dmg_ghost - vp->pos.y + h_dmg_ghost - 1, INVERT(ghost_color));
+					}
 				}
-			}
 
-			list_foreach(pointer_list, link, pointer_t, ptr) {
-				if (ptr->ghost.surface) {
-
-					sysarg_t x_bnd_ghost, y_bnd_ghost, w_bnd_ghost, h_bnd_ghost;
-					sysarg_t x_dmg_ghost, y_dmg_ghost, w_dmg_ghost, h_dmg_ghost;
-					surface_get_resolution(ptr->ghost.surface, &w_bnd_ghost, &h_bnd_ghost);
-					comp_coord_bounding_rect(0, 0, w_bnd_ghost, h_bnd_ghost, ptr->ghost.transform,
-					    &x_bnd_ghost, &y_bnd_ghost, &w_bnd_ghost, &h_bnd_ghost);
-					bool isec_ghost = rectangle_intersect(
-					    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp,
-					    x_bnd_ghost, y_bnd_ghost, w_bnd_ghost, h_bnd_ghost,
-					    &x_dmg_ghost, &y_dmg_ghost, &w_dmg_ghost, &h_dmg_ghost);
-
-					if (isec_ghost) {
-						/*
-						 * FIXME: Ghost is currently drawn based on the bounding
-						 * rectangle of the window, which is sufficient as long
-						 * as the windows can be rotated only by 90 degrees.
-						 * For ghost to be compatible with arbitrary-angle
-						 * rotation, it should be drawn as four lines adjusted
-						 * by the transformation matrix. That would however
-						 * require to equip libdraw with line drawing functionality.
-						 */
-
-						transform_t transform = ptr->ghost.transform;
-						double_point_t pos;
-						pos.x = vp->pos.x;
-						pos.y = vp->pos.y;
-						transform_translate(&transform, -pos.x, -pos.y);
-
-						pixel_t ghost_color;
-
-						if (y_bnd_ghost == y_dmg_ghost) {
-							for (sysarg_t x = x_dmg_ghost - vp->pos.x;
-							    x < x_dmg_ghost - vp->pos.x + w_dmg_ghost; ++x) {
-								ghost_color = surface_get_pixel(vp->surface,
-								    x, y_dmg_ghost - vp->pos.y);
-								surface_put_pixel(vp->surface,
-								    x, y_dmg_ghost - vp->pos.y, INVERT(ghost_color));
-							}
-						}
-
-						if (y_bnd_ghost + h_bnd_ghost == y_dmg_ghost + h_dmg_ghost) {
-							for (sysarg_t x = x_dmg_ghost - vp->pos.x;
-							    x < x_dmg_ghost - vp->pos.x + w_dmg_ghost; ++x) {
-								ghost_color = surface_get_pixel(vp->surface,
-								    x, y_dmg_ghost - vp->pos.y + h_dmg_ghost - 1);
-								surface_put_pixel(vp->surface,
-								    x, y_dmg_ghost - vp->pos.y + h_dmg_ghost - 1, INVERT(ghost_color));
-							}
-						}
-
-						if (x_bnd_ghost == x_dmg_ghost) {
-							for (sysarg_t y = y_dmg_ghost - vp->pos.y;
-							    y < y_dmg_ghost - vp->pos.y + h_dmg_ghost; ++y) {
-								ghost_color = surface_get_pixel(vp->surface,
-								    x_dmg_ghost - vp->pos.x, y);
-								surface_put_pixel(vp->surface,
-								    x_dmg_ghost - vp->pos.x, y, INVERT(ghost_color));
-							}
-						}
-
-						if (x_bnd_ghost + w_bnd_ghost == x_dmg_ghost + w_dmg_ghost) {
-							for (sysarg_t y = y_dmg_ghost - vp->pos.y;
-							    y < y_dmg_ghost - vp->pos.y + h_dmg_ghost; ++y) {
-								ghost_color = surface_get_pixel(vp->surface,
-								    x_dmg_ghost - vp->pos.x + w_dmg_ghost - 1, y);
-								surface_put_pixel(vp->surface,
-								    x_dmg_ghost - vp->pos.x + w_dmg_ghost - 1, y, INVERT(ghost_color));
-							}
-						}
+				if (x_bnd_ghost == x_dmg_ghost) {
+					for (sysarg_t y = y_dmg_ghost - vp->pos.y;
+					    y < y_dmg_ghost - vp->pos.y + h_dmg_ghost; ++y) {
+						ghost_color = surface_get_pixel(vp->surface,
+						    x_dmg_ghost - vp->pos.x, y);
+						surface_put_pixel(vp->surface,
+						    x_dmg_ghost - vp->pos.x, y, INVERT(ghost_color));
 					}
+				}
 
+				if (x_bnd_ghost + w_bnd_ghost == x_dmg_ghost + w_dmg_ghost) {
+					for (sysarg_t y = y_dmg_ghost - vp->pos.y;
+					    y < y_dmg_ghost - vp->pos.y + h_dmg_ghost; ++y) {
+						ghost_color = surface_get_pixel(vp->surface,
+						    x_dmg_ghost - vp->pos.x + w_dmg_ghost - 1, y);
+						surface_put_pixel(vp->surface,
+						    x_dmg_ghost - vp->pos.x + w_dmg_ghost - 1, y, INVERT(ghost_color));
+					}
 				}
 			}
 
-			list_foreach(pointer_list, link, pointer_t, ptr) {
+		}
+	}
 
-				/*
-				 * Determine what part of the pointer intersects with the
-				 * updated area of the current viewport.
-				 */
-				sysarg_t x_dmg_ptr, y_dmg_ptr, w_dmg_ptr, h_dmg_ptr;
-				surface_t *sf_ptr = ptr->cursor.states[ptr->state];
-				surface_get_resolution(sf_ptr, &w_dmg_ptr, &h_dmg_ptr);
-				bool isec_ptr = rectangle_intersect(
-				    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp,
-				    ptr->pos.x, ptr->pos.y, w_dmg_ptr, h_dmg_ptr,
-				    &x_dmg_ptr, &y_dmg_ptr, &w_dmg_ptr, &h_dmg_ptr);
-
-				if (isec_ptr) {
-					/*
-					 * Pointer is currently painted directly by copying pixels.
-					 * However, it is possible to draw the pointer similarly
-					 * as window by using drawctx_transfer. It would allow
-					 * more sophisticated control over drawing, but would also
-					 * cost more regarding the performance.
-					 */
-
-					sysarg_t x_vp = x_dmg_ptr - vp->pos.x;
-					sysarg_t y_vp = y_dmg_ptr - vp->pos.y;
-					sysarg_t x_ptr = x_dmg_ptr - ptr->pos.x;
-					sysarg_t y_ptr = y_dmg_ptr - ptr->pos.y;
-
-					for (sysarg_t y = 0; y < h_dmg_ptr; ++y) {
-						pixel_t *src = pixelmap_pixel_at(
-						    surface_pixmap_access(sf_ptr), x_ptr, y_ptr + y);
-						pixel_t *dst = pixelmap_pixel_at(
-						    surface_pixmap_access(vp->surface), x_vp, y_vp + y);
-						sysarg_t count = w_dmg_ptr;
-						while (count-- != 0) {
-							*dst = (*src & 0xff000000) ? *src : *dst;
-							++dst;
-							++src;
-						}
-					}
-					surface_add_damaged_region(vp->surface, x_vp, y_vp, w_dmg_ptr, h_dmg_ptr);
+	list_foreach(pointer_list, link, pointer_t, ptr) {
+
+		/*
+		 * Determine what part of the pointer intersects with the
+		 * updated area of the current viewport.
+		 */
+		sysarg_t x_dmg_ptr, y_dmg_ptr, w_dmg_ptr, h_dmg_ptr;
+		surface_t *sf_ptr = ptr->cursor.states[ptr->state];
+		surface_get_resolution(sf_ptr, &w_dmg_ptr, &h_dmg_ptr);
+		bool isec_ptr = rectangle_intersect(
+		    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp,
+		    ptr->pos.x, ptr->pos.y, w_dmg_ptr, h_dmg_ptr,
+		    &x_dmg_ptr, &y_dmg_ptr, &w_dmg_ptr, &h_dmg_ptr);
+
+		if (isec_ptr) {
+			/*
+			 * Pointer is currently painted directly by copying pixels.
+			 * However, it is possible to draw the pointer similarly
+			 * as window by using drawctx_transfer. It would allow
+			 * more sophisticated control over drawing, but would also
+			 * cost more regarding the performance.
+			 */
+
+			sysarg_t x_vp = x_dmg_ptr - vp->pos.x;
+			sysarg_t y_vp = y_dmg_ptr - vp->pos.y;
+			sysarg_t x_ptr = x_dmg_ptr - ptr->pos.x;
+			sysarg_t y_ptr = y_dmg_ptr - ptr->pos.y;
+
+			for (sysarg_t y = 0; y < h_dmg_ptr; ++y) {
+				pixel_t *src = pixelmap_pixel_at(
+				    surface_pixmap_access(sf_ptr), x_ptr, y_ptr + y);
+				pixel_t *dst = pixelmap_pixel_at(
+				    surface_pixmap_access(vp->surface), x_vp, y_vp + y);
+				sysarg_t count = w_dmg_ptr;
+				while (count-- != 0) {
+					*dst = (*src & 0xff000000) ? *src : *dst;
+					++dst;
+					++src;
 				}
+			}
+			surface_add_damaged_region(vp->surface, x_vp, y_vp, w_dmg_ptr, h_dmg_ptr);
+		}
+
+	}
+}
+
+/** Determine whether window hides everything below its bounding rectangle. */
+static bool comp_window_is_opaque(window_t *win)
+{
+	/*
+	 * Only windows which are merely translated are known to cover
+	 * their whole bounding rectangle.
+	 */
+	return (win->opacity == 255) && transform_is_fast(&win->transform);
+}
+
+/** Repaint damaged area of a viewport.
+ *
+ * Windows are first visited from the top down to determine which of their
+ * parts are visible. The area covered by opaque windows is not painted by
+ * any window below them. The background is painted only where no opaque
+ * window covers it. Then the visible fragments are painted from the bottom
+ * up.
+ *
+ * @param vp     Viewport
+ * @param damage Damaged region in global coordinates
+ */
+static void comp_repaint_viewport(viewport_t *vp, region_t *damage)
+{
+	/* window_list_mtx and pointer_list_mtx locked by caller */
+
+	region_t dmg_vp;
+	region_t remaining;
+	sysarg_t w_vp, h_vp;
 
+	surface_get_resolution(vp->surface, &w_vp, &h_vp);
+	region_intersect(&dmg_vp, damage, vp->pos.x, vp->pos.y, w_vp, h_vp);
+	if (region_is_empty(&dmg_vp))
+		return;
+
+	remaining = dmg_vp;
+
+	/* Determine visible parts of windows. */
+	list_foreach(window_list, link, window_t, win) {
+		region_init(&win->visible);
+
+		if (!win->surface || region_is_empty(&remaining))
+			continue;
+
+		sysarg_t x_win, y_win, w_win, h_win;
+		surface_get_resolution(win->surface, &w_win, &h_win);
+		comp_coord_bounding_rect(0, 0, w_win, h_win, win->transform,
+		    &x_win, &y_win, &w_win, &h_win);
+
+		region_intersect(&win->visible, &remaining, x_win, y_win,
+		    w_win, h_win);
+
+		if (!region_is_empty(&win->visible) &&
+		    comp_window_is_opaque(win))
+			region_subtract(&remaining, x_win, y_win, w_win, h_win);
+	}
+
+	/* Paint background color where no opaque window covers it. */
+	for (size_t i = 0; i < remaining.count; i++) {
+		region_rect_t *r = &remaining.rects[i];
+
+		for (sysarg_t y = r->y - vp->pos.y; y < r->y - vp->pos.y + r->h; ++y) {
+			pixel_t *dst = pixelmap_pixel_at(
+			    surface_pixmap_access(vp->surface), r->x - vp->pos.x, y);
+			sysarg_t count = r->w;
+			while (count-- != 0) {
+				*dst++ = bg_color;
 			}
 		}
 	}
 
+	source_t source;
+	drawctx_t context;
+
+	source_init(&source);
+	source_set_filter(&source, filter);
+	drawctx_init(&context, vp->surface);
+	drawctx_set_source(&context, &source);
+
+	/* Paint visible parts of windows from the bottom up. */
+	for (link_t *link = window_list.head.prev;
+	    link != &window_list.head; link = link->prev) {
+		window_t *win = list_get_instance(link, window_t, link);
+		if (region_is_empty(&win->visible))
+			continue;
+
+		/*
+		 * Prepare conversion from global coordinates to viewport
+		 * coordinates.
+		 */
+		transform_t transform = win->transform;
+		transform_translate(&transform, -(double) vp->pos.x,
+		    -(double) vp->pos.y);
+
+		source_set_transform(&source, transform);
+		source_set_texture(&source, win->surface,
+		    PIXELMAP_EXTEND_TRANSPARENT_SIDES);
+		source_set_alpha(&source, PIXEL(win->opacity, 0, 0, 0));
+
+		/* Nothing below an opaque window shows through it. */
+		drawctx_set_compose(&context, comp_window_is_opaque(win) ?
+		    compose_src : compose_over);
+
+		for (size_t i = 0; i < win->visible.count; i++) {
+			region_rect_t *r = &win->visible.rects[i];
+			drawctx_transfer(&context, r->x - vp->pos.x,
+			    r->y - vp->pos.y, r->w, r->h);
+		}
+	}
+
+	for (size_t i = 0; i < dmg_vp.count; i++) {
+		region_rect_t *r = &dmg_vp.rects[i];
+
+		comp_paint_pointers(vp, r->x, r->y, r->w, r->h);
+		surface_add_damaged_region(vp->surface, r->x - vp->pos.x,
+		    r->y - vp->pos.y, r->w, r->h);
+	}
+}
+
+/** Repaint area damaged since the last frame. */
+static void comp_repaint(void *arg)
+{
+	region_t damage;
+
+	fibril_mutex_lock(&damage_mtx);
+	damage = damage_region;
+	region_init(&damage_region);
+	getuptime(&last_frame);
+	fibril_mutex_unlock(&damage_mtx);
+
+	if (region_is_empty(&damage))
+		return;
+
+	fibril_mutex_lock(&viewport_list_mtx);
+	fibril_mutex_lock(&window_list_mtx);
+	fibril_mutex_lock(&pointer_list_mtx);
+
+	list_foreach(viewport_list, link, viewport_t, vp) {
+		comp_repaint_viewport(vp, &damage);
+	}
+
 	fibril_mutex_unlock(&pointer_list_mtx);
 	fibril_mutex_unlock(&window_list_mtx);
 
@@ -607,6 +685,38 @@ static void comp_damage(sysarg_t x_dmg_glob, sysarg_t y_dmg_glob,
 	fibril_mutex_unlock(&viewport_list_mtx);
 }
 
+/** Mark area as damaged.
+ *
+ * The damage is accumulated and repainted at most once per frame
+ * interval.
+ */
+static void comp_damage(sysarg_t x_dmg_glob, sysarg_t y_dmg_glob,
+    sysarg_t w_dmg_glob, sysarg_t h_dmg_glob)
+{
+	fibril_mutex_lock(&damage_mtx);
+
+	bool pending = !region_is_empty(&damage_region);
+	region_union(&damage_region, x_dmg_glob, y_dmg_glob, w_dmg_glob,
+	    h_dmg_glob);
+
+	if (!pending && !region_is_empty(&damage_region)) {
+		struct timespec now;
+		getuptime(&now);
+
+		/* Wait for the next frame, but not longer than a frame. */
+		usec_t delay = FRAME_INTERVAL -
+		    NSEC2USEC(ts_sub_diff(&now, &last_frame));
+		if (delay > FRAME_INTERVAL)
+			delay = FRAME_INTERVAL;
+		if (delay < 1)
+			delay = 1;
+
+		fibril_timer_set_locked(frame_timer, delay, comp_repaint, NULL);
+	}
+
+	fibril_mutex_unlock(&damage_mtx);
+}
+
 static void comp_window_get_event(window_t *win, ipc_call_t *icall)
 {
 	window_event_t *event = (window_event_t *) prodcons_consume(&win->queue);
@@ -2283,6 +2393,13 @@ static errno_t compositor_srv_init(char *input_svc, char *name)
 	/* Color of the viewport background. Must be opaque. */
 	bg_color = PIXEL(255, 69, 51, 103);
 
+	/* Timer for painting damaged area once per frame. */
+	frame_timer = fibril_timer_create(&damage_mtx);
+	if (frame_timer == NULL) {
+		printf("%s: Unable to create frame timer\n", NAME);
+		return ENOMEM;
+	}
+
 	/* Register compositor server. */
 	async_set_fallback_port_handler(client_connection, NULL);
 
@@ -35,6 +35,7 @@
 #include <inttypes.h>
 #include <io/log.h>
 #include <str.h>
+#include <str_error.h>
 #include <task.h>
 
 #include <abi/fb/visuals.h>
@@ -45,6 +46,7 @@
 #include <graph.h>
 
 #include "rfb.h"
+#include "trace.h"
 
 #define NAME "rfb"
 
@@ -83,34 +85,6 @@ static errno_t rfb_handle_damage_pixels(visualizer_t *vs,
 		return EINVAL;
 	}
 
-	/* TODO update surface_t and use it */
-	if (!rfb.damage_valid) {
-		rfb.damage_rect.x = x0;
-		rfb.damage_rect.y = y0;
-		rfb.damage_rect.width = width;
-		rfb.damage_rect.height = height;
-		rfb.damage_valid = true;
-	} else {
-		if (x0 < rfb.damage_rect.x) {
-			rfb.damage_rect.width += rfb.damage_rect.x - x0;
-			rfb.damage_rect.x = x0;
-		}
-		if (y0 < rfb.damage_rect.y) {
-			rfb.damage_rect.height += rfb.damage_rect.y - y0;
-			rfb.damage_rect.y = y0;
-		}
-		sysarg_t x1 = x0 + width;
-		sysarg_t dx1 = rfb.damage_rect.x + rfb.damage_rect.width;
-		if (x1 > dx1) {
-			rfb.damage_rect.width += x1 - dx1;
-		}
-		sysarg_t y1 = y0 + height;
-		sysarg_t dy1 = rfb.damage_rect.y + rfb.damage_rect.height;
-		if (y1 > dy1) {
-			rfb.damage_rect.height += y1 - dy1;
-		}
-	}
-
 	pixelmap_t *map = &vs->cells;
 
 	for (sysarg_t y = y0; y < height + y0; ++y) {
@@ -121,6 +95,10 @@ static errno_t rfb_handle_damage_pixels(visualizer_t *vs,
 		}
 	}
 
+	/* TODO update surface_t and use it */
+	rfb_damage(&rfb, x0, y0, width, height);
+	rfb_trace_damage(&rfb, x0, y0, width, height);
+
 	fibril_mutex_unlock(&rfb.lock);
 	return EOK;
 }
@@ -141,7 +119,9 @@ static visualizer_ops_t rfb_ops = {
 
 static void syntax_print(void)
 {
-	fprintf(stderr, "Usage: %s <name> <width> <height> [port]\n", NAME);
+	fprintf(stderr, "Usage: %s [--record <trace>] <name> <width> <height> "
+	    "[port]\n", NAME);
+	fprintf(stderr, "       %s --bench <trace>\n", NAME);
 }
 
 static void client_connection(ipc_call_t *call, void *data)
@@ -153,6 +133,24 @@ int main(int argc, char **argv)
 {
 	log_init(NAME);
 
+	if (argc == 3 && str_cmp(argv[1], "--bench") == 0) {
+		errno_t rc = rfb_trace_replay(argv[2]);
+		if (rc != EOK) {
+			fprintf(stderr, "%s: Failed replaying trace: %s\n", NAME,
+			    str_error(rc));
+			return 1;
+		}
+
+		return 0;
+	}
+
+	const char *trace_path = NULL;
+	if (argc > 2 && str_cmp(argv[1], "--record") == 0) {
+		trace_path = argv[2];
+		argc -= 2;
+		argv += 2;
+	}
+
 	if (argc <= 3) {
 		syntax_print();
 		return 1;
@@ -185,7 +183,20 @@ int main(int argc, char **argv)
 		}
 	}
 
-	rfb_init(&rfb, width, height, rfb_name);
+	errno_t rc = rfb_init(&rfb, width, height, rfb_name);
+	if (rc != EOK) {
+		fprintf(stderr, "Failed initializing RFB server\n");
+		return 3;
+	}
+
+	if (trace_path != NULL) {
+		rc = rfb_trace_start(&rfb, trace_path);
+		if (rc != EOK) {
+			fprintf(stderr, "%s: Failed creating trace %s: %s\n", NAME,
+			    trace_path, str_error(rc));
+			return 1;
+		}
+	}
 
 	vis = malloc(sizeof(visualizer_t));
 	if (vis == NULL) {
@@ -216,7 +227,7 @@ int main(int argc, char **argv)
 
 	async_set_fallback_port_handler(client_connection, NULL);
 
-	errno_t rc = loc_server_register(NAME);
+	rc = loc_server_register(NAME);
 	if (rc != EOK) {
 		printf("%s: Unable to register server.\n", NAME);
 		return rc;
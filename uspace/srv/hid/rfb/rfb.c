@@ -26,6 +26,7 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <assert.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -39,6 +40,7 @@
 #include <byteorder.h>
 #include <macros.h>
 #include <io/log.h>
+#include <zlib.h>
 
 #include "rfb.h"
 
@@ -52,58 +54,145 @@ static tcp_cb_t conn_cb = {
 	.connected = NULL
 };
 
-/** Buffer for receiving the request. */
-#define BUFFER_SIZE  1024
+/** Compression level of the zlib streams */
+#define RFB_ZLIB_LEVEL  DEFLATE_LEVEL_DEFAULT
 
-static char rbuf[BUFFER_SIZE];
-static size_t rbuf_out;
-static size_t rbuf_in;
+/** Maximum number of rectangles in an update before they are merged */
+#define RFB_MAX_RECTS  64
 
-/** Receive one character (with buffering) */
-static errno_t recv_char(tcp_conn_t *conn, char *c)
+/** How long to hold back an incremental update with no damage (usec) */
+#define RFB_UPDATE_TIMEOUT  1000000
+
+/** Maximum number of colors in a ZRLE palette */
+#define ZRLE_MAX_PALETTE  127
+
+/** Maximum number of colors for the Tight palette filter */
+#define TIGHT_MAX_PALETTE  64
+
+/** Tight data shorter than this are sent uncompressed */
+#define TIGHT_MIN_TO_COMPRESS  12
+
+/** Minimum number of changed rows a CopyRect has to save */
+#define COPYRECT_MIN_ROWS  8
+
+/** Number of sample rows scrolling candidates are derived from */
+#define COPYRECT_SAMPLES  8
+
+/** Maximum number of candidate offsets tried per sample row */
+#define COPYRECT_CANDIDATES  4
+
+/** Multiplier of the tile hash */
+#define HASH_MULT  UINT64_C(0x9e3779b97f4a7c15)
+
+/** Make sure there is at least one byte in the receive buffer */
+static errno_t recv_fill(rfb_t *rfb, tcp_conn_t *conn)
 {
 	size_t nrecv;
 	errno_t rc;
 
-	if (rbuf_out == rbuf_in) {
-		rbuf_out = 0;
-		rbuf_in = 0;
+	if (rfb->rbuf_out < rfb->rbuf_in)
+		return EOK;
 
-		rc = tcp_conn_recv_wait(conn, rbuf, BUFFER_SIZE, &nrecv);
-		if (rc != EOK)
-			return rc;
+	rfb->rbuf_out = 0;
+	rfb->rbuf_in = 0;
 
-		rbuf_in = nrecv;
-	}
+	rc = tcp_conn_recv_wait(conn, rfb->rbuf, RFB_RBUF_SIZE, &nrecv);
+	if (rc != EOK)
+		return rc;
 
-	*c = rbuf[rbuf_out++];
+	if (nrecv == 0)
+		return EIO;
+
+	rfb->rbuf_in = nrecv;
 	return EOK;
 }
 
-/** Receive count characters (with buffering) */
+/** Check whether more received data are buffered */
+static bool recv_pending(rfb_t *rfb)
+{
+	return rfb->rbuf_out < rfb->rbuf_in;
+}
+
+/** Receive count characters (with buffering)
+ *
+ * Everything which is already buffered is copied at once, so that
+ * a single TCP read usually serves several client messages.
+ */
 static errno_t __attribute__((warn_unused_result))
-recv_chars(tcp_conn_t *conn, char *c, size_t count)
+recv_chars(rfb_t *rfb, tcp_conn_t *conn, char *c, size_t count)
 {
-	for (size_t i = 0; i < count; i++) {
-		errno_t rc = recv_char(conn, c);
+	while (count > 0) {
+		errno_t rc = recv_fill(rfb, conn);
 		if (rc != EOK)
 			return rc;
-		c++;
+
+		size_t n = min(count, rfb->rbuf_in - rfb->rbuf_out);
+		memcpy(c, rfb->rbuf + rfb->rbuf_out, n);
+		rfb->rbuf_out += n;
+		c += n;
+		count -= n;
 	}
+
 	return EOK;
 }
 
-static errno_t recv_skip_chars(tcp_conn_t *conn, size_t count)
+/** Receive one character (with buffering) */
+static errno_t recv_char(rfb_t *rfb, tcp_conn_t *conn, char *c)
 {
-	for (size_t i = 0; i < count; i++) {
-		char c;
-		errno_t rc = recv_char(conn, &c);
+	return recv_chars(rfb, conn, c, 1);
+}
+
+static errno_t recv_skip_chars(rfb_t *rfb, tcp_conn_t *conn, size_t count)
+{
+	while (count > 0) {
+		errno_t rc = recv_fill(rfb, conn);
 		if (rc != EOK)
 			return rc;
+
+		size_t n = min(count, rfb->rbuf_in - rfb->rbuf_out);
+		rfb->rbuf_out += n;
+		count -= n;
 	}
+
+	return EOK;
+}
+
+/** Make room for at least size more bytes in a buffer */
+static errno_t rfb_buf_reserve(rfb_buf_t *buf, size_t size)
+{
+	if (buf->alloc - buf->size >= size)
+		return EOK;
+
+	size_t alloc = max(max(buf->alloc * 2, buf->size + size),
+	    (size_t) RFB_RBUF_SIZE);
+	uint8_t *data = realloc(buf->data, alloc);
+	if (data == NULL)
+		return ENOMEM;
+
+	buf->data = data;
+	buf->alloc = alloc;
+	return EOK;
+}
+
+static errno_t rfb_buf_append(rfb_buf_t *buf, const void *data, size_t size)
+{
+	errno_t rc = rfb_buf_reserve(buf, size);
+	if (rc != EOK)
+		return rc;
+
+	memcpy(buf->data + buf->size, data, size);
+	buf->size += size;
 	return EOK;
 }
 
+static void rfb_buf_fini(rfb_buf_t *buf)
+{
+	free(buf->data);
+	buf->data = NULL;
+	buf->size = 0;
+	buf->alloc = 0;
+}
+
 static void rfb_pixel_format_to_be(rfb_pixel_format_t *src, rfb_pixel_format_t *dst)
 {
 	dst->r_max = host2uint16_t_be(src->r_max);
@@ -135,7 +224,7 @@ static void rfb_framebuffer_update_request_to_host(rfb_framebuffer_update_reques
     rfb_framebuffer_update_request_t *dst)
 {
 	dst->x = uint16_t_be2host(src->x);
-	dst->y = uint16_t_be2host(src->x);
+	dst->y = uint16_t_be2host(src->y);
 	dst->width = uint16_t_be2host(src->width);
 	dst->height = uint16_t_be2host(src->height);
 }
@@ -176,6 +265,7 @@ errno_t rfb_init(rfb_t *rfb, uint16_t width, uint16_t height, const char *name)
 {
 	memset(rfb, 0, sizeof(rfb_t));
 	fibril_mutex_initialize(&rfb->lock);
+	fibril_condvar_initialize(&rfb->damage_cv);
 
 	rfb_pixel_format_t *pf = &rfb->pixel_format;
 	pf->bpp = 32;
@@ -190,17 +280,91 @@ errno_t rfb_init(rfb_t *rfb, uint16_t width, uint16_t height, const char *name)
 	pf->b_shift = 16;
 
 	rfb->name = str_dup(name);
-	rfb->supports_trle = false;
+	rfb->tile_hashing = true;
+
+	errno_t rc = zlib_compressor_create(RFB_ZLIB_LEVEL, &rfb->zrle_zlib);
+	if (rc != EOK)
+		goto error;
+
+	for (size_t i = 0; i < RFB_TIGHT_STREAMS; i++) {
+		rc = zlib_compressor_create(RFB_ZLIB_LEVEL, &rfb->tight_zlib[i]);
+		if (rc != EOK)
+			goto error;
+	}
+
+	rc = rfb_set_size(rfb, width, height);
+	if (rc != EOK)
+		goto error;
+
+	return EOK;
+error:
+	rfb_fini(rfb);
+	return rc;
+}
+
+void rfb_fini(rfb_t *rfb)
+{
+	if (rfb->zrle_zlib != NULL)
+		zlib_compressor_destroy(rfb->zrle_zlib);
+
+	for (size_t i = 0; i < RFB_TIGHT_STREAMS; i++) {
+		if (rfb->tight_zlib[i] != NULL)
+			zlib_compressor_destroy(rfb->tight_zlib[i]);
+	}
 
-	return rfb_set_size(rfb, width, height);
+	rfb_buf_fini(&rfb->obuf);
+	rfb_buf_fini(&rfb->tbuf);
+	rfb_buf_fini(&rfb->zbuf);
+	free(rfb->hashes);
+	free(rfb->fresh);
+	free(rfb->dirty);
+	free(rfb->framebuffer.data);
+	free(rfb->palette);
+	free((char *) rfb->name);
+	memset(rfb, 0, sizeof(rfb_t));
+}
+
+/** Forget what the client has seen, starting a new session */
+void rfb_reset_client(rfb_t *rfb)
+{
+	rfb->rbuf_out = 0;
+	rfb->rbuf_in = 0;
+	rfb->encodings_count = 0;
+	rfb->supports_copyrect = false;
+	rfb->hashes_valid = false;
+
+	zlib_compressor_reset(rfb->zrle_zlib);
+	for (size_t i = 0; i < RFB_TIGHT_STREAMS; i++)
+		zlib_compressor_reset(rfb->tight_zlib[i]);
 }
 
 errno_t rfb_set_size(rfb_t *rfb, uint16_t width, uint16_t height)
 {
 	size_t new_size = width * height * sizeof(pixel_t);
+	size_t hash_cols = (width + RFB_HASH_TILE - 1) / RFB_HASH_TILE;
+	size_t hash_size = hash_cols * height * sizeof(uint64_t);
+
 	void *pixbuf = malloc(new_size);
-	if (pixbuf == NULL)
+	uint64_t *hashes = malloc(hash_size);
+	uint64_t *fresh = malloc(hash_size);
+	uint8_t *dirty = malloc(hash_cols);
+	if (pixbuf == NULL || hashes == NULL || fresh == NULL ||
+	    dirty == NULL) {
+		free(pixbuf);
+		free(hashes);
+		free(fresh);
+		free(dirty);
 		return ENOMEM;
+	}
+
+	free(rfb->hashes);
+	free(rfb->fresh);
+	free(rfb->dirty);
+	rfb->hashes = hashes;
+	rfb->fresh = fresh;
+	rfb->dirty = dirty;
+	rfb->hash_cols = hash_cols;
+	rfb->hashes_valid = false;
 
 	free(rfb->framebuffer.data);
 	rfb->framebuffer.data = pixbuf;
@@ -215,11 +379,48 @@ errno_t rfb_set_size(rfb_t *rfb, uint16_t width, uint16_t height)
 	return EOK;
 }
 
+/** Add a rectangle to the damaged area
+ *
+ * Must be called with rfb->lock held.
+ */
+void rfb_damage(rfb_t *rfb, sysarg_t x0, sysarg_t y0, sysarg_t width,
+    sysarg_t height)
+{
+	if (!rfb->damage_valid) {
+		rfb->damage_rect.x = x0;
+		rfb->damage_rect.y = y0;
+		rfb->damage_rect.width = width;
+		rfb->damage_rect.height = height;
+		rfb->damage_valid = true;
+	} else {
+		if (x0 < rfb->damage_rect.x) {
+			rfb->damage_rect.width += rfb->damage_rect.x - x0;
+			rfb->damage_rect.x = x0;
+		}
+		if (y0 < rfb->damage_rect.y) {
+			rfb->damage_rect.height += rfb->damage_rect.y - y0;
+			rfb->damage_rect.y = y0;
+		}
+		sysarg_t x1 = x0 + width;
+		sysarg_t dx1 = rfb->damage_rect.x + rfb->damage_rect.width;
+		if (x1 > dx1) {
+			rfb->damage_rect.width += x1 - dx1;
+		}
+		sysarg_t y1 = y0 + height;
+		sysarg_t dy1 = rfb->damage_rect.y + rfb->damage_rect.height;
+		if (y1 > dy1) {
+			rfb->damage_rect.height += y1 - dy1;
+		}
+	}
+
+	fibril_condvar_broadcast(&rfb->damage_cv);
+}
+
 static errno_t __attribute__((warn_unused_result))
-recv_message(tcp_conn_t *conn, char type, void *buf, size_t size)
+recv_message(rfb_t *rfb, tcp_conn_t *conn, char type, void *buf, size_t size)
 {
 	memcpy(buf, &type, 1);
-	return recv_chars(conn, ((char *) buf) + 1, size - 1);
+	return recv_chars(rfb, conn, ((char *) buf) + 1, size - 1);
 }
 
 static uint32_t rfb_scale_channel(uint8_t val, uint32_t max)
@@ -423,6 +624,7 @@ static size_t rfb_tile_encode_raw(rfb_t *rfb, cpixel_ctx_t *cpixel,
 		for (uint16_t x = tile->x; x < tile->x + tile->width; x++) {
 			pixel_t pixel = pixelmap_get_pixel(&rfb->framebuffer, x, y);
 			cpixel_encode(rfb, cpixel, buf, pixel);
+			buf += cpixel->size;
 		}
 	}
 
@@ -457,8 +659,8 @@ static size_t rfb_rect_encode_trle(rfb_t *rfb, rfb_rectangle_t *rect, void *buf)
 	for (uint16_t y = 0; y < rect->height; y += 16) {
 		for (uint16_t x = 0; x < rect->width; x += 16) {
 			rfb_rectangle_t tile = {
-				.x = x,
-				.y = y,
+				.x = rect->x + x,
+				.y = rect->y + y,
 				.width = (x + 16 <= rect->width ? 16 : rect->width - x),
 				.height = (y + 16 <= rect->height ? 16 : rect->height - y)
 			};
@@ -477,6 +679,7 @@ static size_t rfb_rect_encode_trle(rfb_t *rfb, rfb_rectangle_t *rect, void *buf)
 				tile_enctype = RFB_TILE_ENCODING_RAW;
 			}
 
+			size += tile_size;
 			if (buf) {
 				*tile_enctype_ptr = tile_enctype;
 				buf += tile_size;
@@ -486,51 +689,993 @@ static size_t rfb_rect_encode_trle(rfb_t *rfb, rfb_rectangle_t *rect, void *buf)
 	return size;
 }
 
-static errno_t rfb_send_framebuffer_update(rfb_t *rfb, tcp_conn_t *conn,
-    bool incremental)
+/** Address of a framebuffer pixel */
+static pixel_t *rfb_pixels(rfb_t *rfb, sysarg_t x, sysarg_t y)
 {
-	fibril_mutex_lock(&rfb->lock);
-	if (!incremental || !rfb->damage_valid) {
+	return rfb->framebuffer.data + y * rfb->framebuffer.width + x;
+}
+
+/** Copy a rectangle of the framebuffer into rfb->tile */
+static void rfb_load_tile(rfb_t *rfb, sysarg_t x, sysarg_t y, sysarg_t width,
+    sysarg_t height)
+{
+	pixel_t *dst = rfb->tile;
+
+	for (sysarg_t row = 0; row < height; row++) {
+		memcpy(dst, rfb_pixels(rfb, x, y + row), width * sizeof(pixel_t));
+		dst += width;
+	}
+}
+
+/** Tile palette with a small open-addressing lookup table */
+typedef struct {
+	size_t count;
+	size_t max;
+	pixel_t colors[ZRLE_MAX_PALETTE];
+	int16_t slots[256];
+} tile_palette_t;
+
+/** Statistics of a tile used to choose the best subencoding */
+typedef struct {
+	tile_palette_t palette;
+	/** More colors than palette.max */
+	bool overflow;
+	/** Number of runs of identical pixels */
+	size_t runs;
+	/** Number of runs of length one */
+	size_t single_runs;
+	/** Total number of bytes needed to encode the run lengths */
+	size_t run_bytes;
+} tile_stats_t;
+
+static void palette_init(tile_palette_t *palette, size_t max)
+{
+	assert(max <= ZRLE_MAX_PALETTE);
+
+	palette->count = 0;
+	palette->max = max;
+	memset(palette->slots, 0xff, sizeof(palette->slots));
+}
+
+/** Find or insert a palette color
+ *
+ * @return Index of the color or -1 if the palette is full.
+ */
+static int palette_lookup(tile_palette_t *palette, pixel_t color)
+{
+	size_t slot = (uint32_t) (color * UINT32_C(0x9e3779b1)) >> 24;
+
+	while (palette->slots[slot] >= 0) {
+		if (palette->colors[palette->slots[slot]] == color)
+			return palette->slots[slot];
+
+		slot = (slot + 1) % 256;
+	}
+
+	if (palette->count == palette->max)
+		return -1;
+
+	palette->colors[palette->count] = color;
+	palette->slots[slot] = palette->count;
+	return palette->count++;
+}
+
+/** Collect the colors and runs of rfb->tile */
+static void tile_analyze(rfb_t *rfb, size_t count, size_t max_colors,
+    tile_stats_t *stats)
+{
+	palette_init(&stats->palette, max_colors);
+	stats->overflow = false;
+	stats->runs = 0;
+	stats->single_runs = 0;
+	stats->run_bytes = 0;
+
+	size_t i = 0;
+	while (i < count) {
+		pixel_t color = rfb->tile[i];
+		size_t j = i + 1;
+		while (j < count && rfb->tile[j] == color)
+			j++;
+
+		size_t len = j - i;
+		stats->runs++;
+		stats->run_bytes += (len - 1) / 255 + 1;
+		if (len == 1)
+			stats->single_runs++;
+
+		if (!stats->overflow &&
+		    palette_lookup(&stats->palette, color) < 0)
+			stats->overflow = true;
+
+		i = j;
+	}
+}
+
+/** Hash a row of pixels
+ *
+ * Every step is a bijection of the state, so rows differing in a single
+ * pixel never collide.
+ */
+static uint64_t rfb_hash_pixels(const pixel_t *pixels, size_t count)
+{
+	uint64_t hash = UINT64_C(0xcbf29ce484222325);
+	size_t i;
+
+	for (i = 0; i + 1 < count; i += 2) {
+		uint64_t val = pixels[i] | ((uint64_t) pixels[i + 1] << 32);
+		hash = (hash ^ val) * HASH_MULT;
+	}
+
+	if (i < count)
+		hash = (hash ^ pixels[i]) * HASH_MULT;
+
+	return hash;
+}
+
+/** Signature of a row made of hashed blocks bx0 to bx1 */
+static uint64_t rfb_row_signature(rfb_t *rfb, uint64_t *hashes, sysarg_t y,
+    sysarg_t bx0, sysarg_t bx1)
+{
+	uint64_t *row = hashes + y * rfb->hash_cols;
+	uint64_t sig = 0;
+
+	for (sysarg_t bx = bx0; bx < bx1; bx++)
+		sig = (sig ^ row[bx]) * HASH_MULT;
+
+	return sig;
+}
+
+/** Detect vertically scrolled content
+ *
+ * Compare the rows of the current framebuffer in block columns bx0 to bx1
+ * with the rows the client has. Rows which the client already has at
+ * a different position can be moved there with a CopyRect.
+ *
+ * @param rfb   RFB server.
+ * @param bx0   First block column.
+ * @param bx1   Block column after the last one.
+ * @param y0    First row.
+ * @param y1    Row after the last one.
+ * @param copy  Place to store the destination of the copy.
+ * @param src_y Place to store the source row of the copy.
+ *
+ * @return True if a CopyRect is worth sending.
+ */
+static bool rfb_detect_copy(rfb_t *rfb, sysarg_t bx0, sysarg_t bx1,
+    sysarg_t y0, sysarg_t y1, rfb_rectangle_t *copy, sysarg_t *src_y)
+{
+	if (bx1 <= bx0 || y1 < y0 + COPYRECT_MIN_ROWS)
+		return false;
+
+	size_t rows = y1 - y0;
+	uint64_t *cur = malloc(2 * rows * sizeof(uint64_t));
+	if (cur == NULL)
+		return false;
+
+	uint64_t *old = cur + rows;
+	for (size_t i = 0; i < rows; i++) {
+		cur[i] = rfb_row_signature(rfb, rfb->fresh, y0 + i, bx0, bx1);
+		old[i] = rfb_row_signature(rfb, rfb->hashes, y0 + i, bx0, bx1);
+	}
+
+	size_t best_gain = 0;
+	size_t best_start = 0;
+	size_t best_len = 0;
+	ssize_t best_dy = 0;
+
+	size_t step = max(rows / COPYRECT_SAMPLES, (size_t) 1);
+	size_t samples = 0;
+
+	for (size_t i = 0; i < rows && samples < COPYRECT_SAMPLES; i++) {
+		/*
+		 * Only changed rows which differ from their neighbours
+		 * (i.e. are not part of a uniform area) make good samples.
+		 */
+		if (cur[i] == old[i])
+			continue;
+		if (i > 0 && cur[i] == cur[i - 1])
+			continue;
+		if (i + 1 < rows && cur[i] == cur[i + 1])
+			continue;
+
+		samples++;
+		size_t candidates = 0;
+
+		for (size_t j = 0; j < rows && candidates < COPYRECT_CANDIDATES;
+		    j++) {
+			if (j == i || old[j] != cur[i])
+				continue;
+
+			candidates++;
+			ssize_t dy = (ssize_t) j - (ssize_t) i;
+
+			/* Find the longest run of rows fixed by this offset */
+			size_t start = 0;
+			size_t len = 0;
+			size_t gain = 0;
+			for (size_t r = 0; r <= rows; r++) {
+				ssize_t s = (ssize_t) r + dy;
+				if (r < rows && s >= 0 && (size_t) s < rows &&
+				    cur[r] == old[s]) {
+					if (len == 0) {
+						start = r;
+						gain = 0;
+					}
+					len++;
+					if (cur[r] != old[r])
+						gain++;
+					continue;
+				}
+
+				if (gain > best_gain) {
+					best_gain = gain;
+					best_start = start;
+					best_len = len;
+					best_dy = dy;
+				}
+				len = 0;
+			}
+		}
+
+		/* Skip ahead to spread the samples */
+		i += step - 1;
+	}
+
+	free(cur);
+
+	if (best_gain < COPYRECT_MIN_ROWS)
+		return false;
+
+	copy->x = bx0 * RFB_HASH_TILE;
+	copy->y = y0 + best_start;
+	copy->width = min(bx1 * RFB_HASH_TILE, (sysarg_t) rfb->width) - copy->x;
+	copy->height = best_len;
+	*src_y = copy->y + best_dy;
+
+	/* The client will have the moved rows after the copy */
+	for (size_t r = 0; r < best_len; r++) {
+		size_t off = (copy->y + r) * rfb->hash_cols;
+		memcpy(rfb->hashes + off + bx0, rfb->fresh + off + bx0,
+		    (bx1 - bx0) * sizeof(uint64_t));
+	}
+
+	return true;
+}
+
+/** Add a run of dirty tiles to the list of rectangles
+ *
+ * The run is merged with a rectangle of the same horizontal extent
+ * ending right above it, if any.
+ *
+ * @return False if there is no room for another rectangle.
+ */
+static bool rfb_add_dirty_run(rfb_rectangle_t *rects, size_t *count,
+    sysarg_t x, sysarg_t y, sysarg_t width, sysarg_t height)
+{
+	for (size_t i = 0; i < *count; i++) {
+		if (rects[i].x == x && rects[i].width == width &&
+		    rects[i].y + rects[i].height == y) {
+			rects[i].height += height;
+			return true;
+		}
+	}
+
+	if (*count == RFB_MAX_RECTS)
+		return false;
+
+	rects[*count].x = x;
+	rects[*count].y = y;
+	rects[*count].width = width;
+	rects[*count].height = height;
+	(*count)++;
+	return true;
+}
+
+/** Determine which parts of the damaged area need to be sent
+ *
+ * The damaged area is split into tiles which are hashed and compared
+ * with the hashes of what the client has. Unchanged tiles are skipped,
+ * scrolled rows are turned into a CopyRect.
+ *
+ * @param rfb       RFB server.
+ * @param rects     Array of RFB_MAX_RECTS rectangles to fill in.
+ * @param copy      Place to store the destination of a CopyRect.
+ * @param src_y     Place to store the source row of a CopyRect.
+ * @param have_copy Place to store whether there is a CopyRect.
+ *
+ * @return Number of rectangles.
+ */
+static size_t rfb_dirty_rects(rfb_t *rfb, rfb_rectangle_t *rects,
+    rfb_rectangle_t *copy, sysarg_t *src_y, bool *have_copy)
+{
+	rfb_rectangle_t *damage = &rfb->damage_rect;
+	size_t cols = rfb->hash_cols;
+
+	sysarg_t tx0 = damage->x / RFB_HASH_TILE;
+	sysarg_t tx1 = (damage->x + damage->width + RFB_HASH_TILE - 1) /
+	    RFB_HASH_TILE;
+	sysarg_t ty0 = damage->y / RFB_HASH_TILE;
+	sysarg_t ty1 = (damage->y + damage->height + RFB_HASH_TILE - 1) /
+	    RFB_HASH_TILE;
+	sysarg_t y0 = ty0 * RFB_HASH_TILE;
+	sysarg_t y1 = min(ty1 * RFB_HASH_TILE, (sysarg_t) rfb->height);
+
+	/* Hash the current contents of the damaged tiles */
+	for (sysarg_t y = y0; y < y1; y++) {
+		pixel_t *row = rfb_pixels(rfb, 0, y);
+		uint64_t *fresh = rfb->fresh + y * cols;
+
+		for (sysarg_t tx = tx0; tx < tx1; tx++) {
+			sysarg_t x = tx * RFB_HASH_TILE;
+			fresh[tx] = rfb_hash_pixels(row + x,
+			    min((sysarg_t) RFB_HASH_TILE, rfb->width - x));
+		}
+	}
+
+	*have_copy = false;
+	if (rfb->hashes_valid && rfb->supports_copyrect) {
+		/* Only blocks entirely within the damage can have scrolled */
+		sysarg_t bx0 = (damage->x + RFB_HASH_TILE - 1) / RFB_HASH_TILE;
+		sysarg_t bx1 = (damage->x + damage->width) / RFB_HASH_TILE;
+		if (damage->x + damage->width == rfb->width)
+			bx1 = tx1;
+
+		*have_copy = rfb_detect_copy(rfb, bx0, bx1, damage->y,
+		    damage->y + damage->height, copy, src_y);
+	}
+
+	size_t count = 0;
+	bool overflow = false;
+	sysarg_t dirty_tx0 = tx1;
+	sysarg_t dirty_tx1 = tx0;
+	sysarg_t dirty_ty0 = ty1;
+	sysarg_t dirty_ty1 = ty0;
+
+	for (sysarg_t ty = ty0; ty < ty1; ty++) {
+		sysarg_t ty_y0 = ty * RFB_HASH_TILE;
+		sysarg_t ty_y1 = min(ty_y0 + RFB_HASH_TILE, (sysarg_t) rfb->height);
+
+		for (sysarg_t tx = tx0; tx < tx1; tx++) {
+			bool dirty = !rfb->hashes_valid;
+			for (sysarg_t y = ty_y0; y < ty_y1 && !dirty; y++) {
+				if (rfb->fresh[y * cols + tx] !=
+				    rfb->hashes[y * cols + tx])
+					dirty = true;
+			}
+
+			rfb->dirty[tx] = dirty;
+		}
+
+		for (sysarg_t y = ty_y0; y < ty_y1; y++) {
+			memcpy(rfb->hashes + y * cols + tx0,
+			    rfb->fresh + y * cols + tx0,
+			    (tx1 - tx0) * sizeof(uint64_t));
+		}
+
+		sysarg_t tx = tx0;
+		while (tx < tx1) {
+			if (!rfb->dirty[tx]) {
+				tx++;
+				continue;
+			}
+
+			sysarg_t run = tx;
+			while (tx < tx1 && rfb->dirty[tx])
+				tx++;
+
+			dirty_tx0 = min(dirty_tx0, run);
+			dirty_tx1 = max(dirty_tx1, tx);
+			dirty_ty0 = min(dirty_ty0, ty);
+			dirty_ty1 = ty + 1;
+
+			sysarg_t x = run * RFB_HASH_TILE;
+			sysarg_t width = min(tx * RFB_HASH_TILE,
+			    (sysarg_t) rfb->width) - x;
+
+			if (!overflow && !rfb_add_dirty_run(rects, &count, x,
+			    ty_y0, width, ty_y1 - ty_y0))
+				overflow = true;
+		}
+	}
+
+	if (overflow) {
+		/* Too fragmented, send the bounding box instead */
+		rects[0].x = dirty_tx0 * RFB_HASH_TILE;
+		rects[0].y = dirty_ty0 * RFB_HASH_TILE;
+		rects[0].width = min(dirty_tx1 * RFB_HASH_TILE,
+		    (sysarg_t) rfb->width) - rects[0].x;
+		rects[0].height = min(dirty_ty1 * RFB_HASH_TILE,
+		    (sysarg_t) rfb->height) - rects[0].y;
+		count = 1;
+	}
+
+	rfb->hashes_valid = true;
+	return count;
+}
+
+/** Compress data using a persistent zlib stream
+ *
+ * The stream is flushed so that the client can decode everything sent
+ * so far, but it is never finished.
+ */
+static errno_t rfb_zlib_compress(zlib_compressor_t *zlib, const void *src,
+    size_t size, rfb_buf_t *dst)
+{
+	const uint8_t *data = src;
+
+	while (true) {
+		errno_t rc = rfb_buf_reserve(dst, deflate_bound(size) + 16);
+		if (rc != EOK)
+			return rc;
+
+		size_t used;
+		size_t produced;
+		rc = zlib_compressor_process(zlib, data, size, &used,
+		    dst->data + dst->size, dst->alloc - dst->size, &produced,
+		    DEFLATE_SYNC_FLUSH);
+		data += used;
+		size -= used;
+		dst->size += produced;
+
+		if (rc != EAGAIN)
+			return rc;
+	}
+}
+
+static errno_t rfb_put_rect_header(rfb_t *rfb, sysarg_t x, sysarg_t y,
+    sysarg_t width, sysarg_t height, int32_t enctype)
+{
+	rfb_rectangle_t rect = {
+		.x = x,
+		.y = y,
+		.width = width,
+		.height = height,
+		.enctype = enctype
+	};
+
+	rfb_rectangle_to_be(&rect, &rect);
+	return rfb_buf_append(&rfb->obuf, &rect, sizeof(rfb_rectangle_t));
+}
+
+/** Encode run length as used by ZRLE */
+static uint8_t *zrle_put_run(uint8_t *pos, size_t len)
+{
+	len--;
+	while (len >= 255) {
+		*pos++ = 255;
+		len -= 255;
+	}
+
+	*pos++ = len;
+	return pos;
+}
+
+/** Encode rfb->tile as a ZRLE tile into rfb->tbuf */
+static errno_t rfb_zrle_encode_tile(rfb_t *rfb, cpixel_ctx_t *cpixel,
+    sysarg_t width, sysarg_t height)
+{
+	size_t count = width * height;
+	size_t cpsize = cpixel->size;
+	tile_stats_t stats;
+
+	tile_analyze(rfb, count, ZRLE_MAX_PALETTE, &stats);
+
+	tile_palette_t *palette = &stats.palette;
+	size_t colors = palette->count;
+	unsigned int bits = (colors <= 2) ? 1 : (colors <= 4) ? 2 : 4;
+
+	/* Pick the smallest subencoding */
+	uint8_t subenc = RFB_TILE_ENCODING_RAW;
+	size_t size = count * cpsize;
+
+	if (!stats.overflow && colors == 1) {
+		subenc = RFB_TILE_ENCODING_SOLID;
+		size = cpsize;
+	} else {
+		size_t plain_rle = stats.runs * cpsize + stats.run_bytes;
+		if (plain_rle < size) {
+			subenc = RFB_TILE_ENCODING_PLAIN_RLE;
+			size = plain_rle;
+		}
+
+		if (!stats.overflow) {
+			size_t palette_rle = colors * cpsize + stats.runs +
+			    stats.run_bytes - stats.single_runs;
+			if (palette_rle < size) {
+				subenc = RFB_TILE_ENCODING_PLAIN_RLE + colors;
+				size = palette_rle;
+			}
+		}
+
+		if (!stats.overflow && colors <= 16) {
+			size_t packed = colors * cpsize +
+			    height * ((width * bits + 7) / 8);
+			if (packed < size) {
+				subenc = colors;
+				size = packed;
+			}
+		}
+	}
+
+	errno_t rc = rfb_buf_reserve(&rfb->tbuf, size + 1);
+	if (rc != EOK)
+		return rc;
+
+	uint8_t *pos = rfb->tbuf.data + rfb->tbuf.size;
+	*pos++ = subenc;
+
+	if (subenc == RFB_TILE_ENCODING_RAW) {
+		uint8_t data[4];
+		for (size_t i = 0; i < count; i++) {
+			/* Neighbouring pixels tend to be equal */
+			if (i == 0 || rfb->tile[i] != rfb->tile[i - 1])
+				cpixel_encode(rfb, cpixel, data, rfb->tile[i]);
+			memcpy(pos, data, cpsize);
+			pos += cpsize;
+		}
+	} else if (subenc == RFB_TILE_ENCODING_SOLID) {
+		cpixel_encode(rfb, cpixel, pos, palette->colors[0]);
+		pos += cpsize;
+	} else if (subenc == RFB_TILE_ENCODING_PLAIN_RLE) {
+		size_t i = 0;
+		while (i < count) {
+			size_t j = i + 1;
+			while (j < count && rfb->tile[j] == rfb->tile[i])
+				j++;
+
+			cpixel_encode(rfb, cpixel, pos, rfb->tile[i]);
+			pos = zrle_put_run(pos + cpsize, j - i);
+			i = j;
+		}
+	} else {
+		for (size_t i = 0; i < colors; i++) {
+			cpixel_encode(rfb, cpixel, pos, palette->colors[i]);
+			pos += cpsize;
+		}
+
+		if (subenc > RFB_TILE_ENCODING_PLAIN_RLE) {
+			/* Palette RLE */
+			size_t i = 0;
+			while (i < count) {
+				size_t j = i + 1;
+				while (j < count && rfb->tile[j] == rfb->tile[i])
+					j++;
+
+				uint8_t index = palette_lookup(palette, rfb->tile[i]);
+				if (j - i == 1) {
+					*pos++ = index;
+				} else {
+					*pos++ = index | 0x80;
+					pos = zrle_put_run(pos, j - i);
+				}
+				i = j;
+			}
+		} else {
+			/* Packed palette, rows are padded to whole bytes */
+			pixel_t *pixel = rfb->tile;
+			for (sysarg_t y = 0; y < height; y++) {
+				uint8_t byte = 0;
+				unsigned int nbits = 0;
+
+				for (sysarg_t x = 0; x < width; x++) {
+					byte = (byte << bits) |
+					    palette_lookup(palette, *pixel++);
+					nbits += bits;
+					if (nbits == 8) {
+						*pos++ = byte;
+						byte = 0;
+						nbits = 0;
+					}
+				}
+
+				if (nbits > 0)
+					*pos++ = byte << (8 - nbits);
+			}
+		}
+	}
+
+	rfb->tbuf.size = pos - rfb->tbuf.data;
+	return EOK;
+}
+
+/** Encode a rectangle using ZRLE
+ *
+ * All tiles are compressed by the zlib stream of the connection and
+ * flushed at the end of the rectangle.
+ */
+static errno_t rfb_rect_encode_zrle(rfb_t *rfb, rfb_rectangle_t *rect)
+{
+	cpixel_ctx_t cpixel;
+	cpixel_context_init(&cpixel, &rfb->pixel_format);
+
+	rfb->tbuf.size = 0;
+	for (sysarg_t y = 0; y < rect->height; y += RFB_TILE_SIZE) {
+		for (sysarg_t x = 0; x < rect->width; x += RFB_TILE_SIZE) {
+			sysarg_t width = min((sysarg_t) RFB_TILE_SIZE,
+			    rect->width - x);
+			sysarg_t height = min((sysarg_t) RFB_TILE_SIZE,
+			    rect->height - y);
+
+			rfb_load_tile(rfb, rect->x + x, rect->y + y, width,
+			    height);
+			errno_t rc = rfb_zrle_encode_tile(rfb, &cpixel, width,
+			    height);
+			if (rc != EOK)
+				return rc;
+		}
+	}
+
+	errno_t rc = rfb_put_rect_header(rfb, rect->x, rect->y, rect->width,
+	    rect->height, RFB_ENCODING_ZRLE);
+	if (rc != EOK)
+		return rc;
+
+	/* Length of the compressed data is filled in afterwards */
+	uint32_t length = 0;
+	size_t length_pos = rfb->obuf.size;
+	rc = rfb_buf_append(&rfb->obuf, &length, sizeof(length));
+	if (rc != EOK)
+		return rc;
+
+	rc = rfb_zlib_compress(rfb->zrle_zlib, rfb->tbuf.data, rfb->tbuf.size,
+	    &rfb->obuf);
+	if (rc != EOK)
+		return rc;
+
+	length = host2uint32_t_be(rfb->obuf.size - length_pos - sizeof(length));
+	memcpy(rfb->obuf.data + length_pos, &length, sizeof(length));
+	return EOK;
+}
+
+/** Check whether the pixel format allows three-byte Tight pixels */
+static bool tpixel_is_packed(rfb_pixel_format_t *pf)
+{
+	return pf->true_color && pf->bpp == 32 && pf->depth == 24 &&
+	    pf->r_max == 255 && pf->g_max == 255 && pf->b_max == 255;
+}
+
+static uint8_t *tpixel_encode(rfb_t *rfb, uint8_t *pos, pixel_t pixel)
+{
+	if (tpixel_is_packed(&rfb->pixel_format)) {
+		*pos++ = RED(pixel);
+		*pos++ = GREEN(pixel);
+		*pos++ = BLUE(pixel);
+		return pos;
+	}
+
+	rfb_encode_pixel(rfb, pos, pixel);
+	return pos + rfb->pixel_format.bpp / 8;
+}
+
+/** Append Tight data from rfb->tbuf, compressing it if worthwhile */
+static errno_t rfb_tight_put_data(rfb_t *rfb, unsigned int stream)
+{
+	if (rfb->tbuf.size < TIGHT_MIN_TO_COMPRESS)
+		return rfb_buf_append(&rfb->obuf, rfb->tbuf.data, rfb->tbuf.size);
+
+	rfb->zbuf.size = 0;
+	errno_t rc = rfb_zlib_compress(rfb->tight_zlib[stream], rfb->tbuf.data,
+	    rfb->tbuf.size, &rfb->zbuf);
+	if (rc != EOK)
+		return rc;
+
+	/* Compact length: 7 bits per byte, at most three bytes */
+	size_t len = rfb->zbuf.size;
+	uint8_t clen[3];
+	size_t clen_size = 1;
+
+	clen[0] = len & 0x7f;
+	if (len > 0x7f) {
+		clen[0] |= 0x80;
+		clen[1] = (len >> 7) & 0x7f;
+		clen_size++;
+		if (len > 0x3fff) {
+			clen[1] |= 0x80;
+			clen[2] = (len >> 14) & 0xff;
+			clen_size++;
+		}
+	}
+
+	rc = rfb_buf_append(&rfb->obuf, clen, clen_size);
+	if (rc != EOK)
+		return rc;
+
+	return rfb_buf_append(&rfb->obuf, rfb->zbuf.data, rfb->zbuf.size);
+}
+
+/** Encode rfb->tile as a Tight rectangle */
+static errno_t rfb_tight_encode_tile(rfb_t *rfb, sysarg_t x, sysarg_t y,
+    sysarg_t width, sysarg_t height)
+{
+	size_t count = width * height;
+	size_t tpsize = tpixel_is_packed(&rfb->pixel_format) ? 3 :
+	    rfb->pixel_format.bpp / 8;
+	tile_stats_t stats;
+
+	tile_analyze(rfb, count, TIGHT_MAX_PALETTE, &stats);
+	tile_palette_t *palette = &stats.palette;
+
+	errno_t rc = rfb_put_rect_header(rfb, x, y, width, height,
+	    RFB_ENCODING_TIGHT);
+	if (rc != EOK)
+		return rc;
+
+	/* Control byte, filter, palette size and palette */
+	rc = rfb_buf_reserve(&rfb->obuf, 3 + TIGHT_MAX_PALETTE * tpsize);
+	if (rc != EOK)
+		return rc;
+
+	uint8_t *pos = rfb->obuf.data + rfb->obuf.size;
+
+	if (!stats.overflow && palette->count == 1) {
+		/* Fill compression */
+		*pos++ = 0x80;
+		pos = tpixel_encode(rfb, pos, palette->colors[0]);
+		rfb->obuf.size = pos - rfb->obuf.data;
+		return EOK;
+	}
+
+	unsigned int stream;
+	rfb->tbuf.size = 0;
+
+	if (!stats.overflow) {
+		/*
+		 * Palette filter, two-color tiles use a separate stream
+		 * as their data is a bitmap.
+		 */
+		stream = (palette->count == 2) ? 1 : 2;
+		*pos++ = 0x40 | (stream << 4);
+		*pos++ = 1;
+		*pos++ = palette->count - 1;
+		for (size_t i = 0; i < palette->count; i++)
+			pos = tpixel_encode(rfb, pos, palette->colors[i]);
+		rfb->obuf.size = pos - rfb->obuf.data;
+
+		size_t size = (palette->count == 2) ?
+		    height * ((width + 7) / 8) : count;
+		rc = rfb_buf_reserve(&rfb->tbuf, size);
+		if (rc != EOK)
+			return rc;
+
+		uint8_t *data = rfb->tbuf.data;
+		pixel_t *pixel = rfb->tile;
+		if (palette->count == 2) {
+			pixel_t bg = palette->colors[0];
+			for (sysarg_t row = 0; row < height; row++) {
+				uint8_t byte = 0;
+				unsigned int nbits = 0;
+
+				for (sysarg_t col = 0; col < width; col++) {
+					byte = (byte << 1) | (*pixel++ != bg);
+					if (++nbits == 8) {
+						*data++ = byte;
+						byte = 0;
+						nbits = 0;
+					}
+				}
+
+				if (nbits > 0)
+					*data++ = byte << (8 - nbits);
+			}
+		} else {
+			for (size_t i = 0; i < count; i++) {
+				/* Reuse the index of the previous pixel in runs */
+				if (i > 0 && pixel[i] == pixel[i - 1])
+					data[i] = data[i - 1];
+				else
+					data[i] = palette_lookup(palette, pixel[i]);
+			}
+		}
+
+		rfb->tbuf.size = size;
+	} else {
+		/* Full color, copy filter */
+		stream = 0;
+		*pos++ = stream << 4;
+		rfb->obuf.size = pos - rfb->obuf.data;
+
+		rc = rfb_buf_reserve(&rfb->tbuf, count * tpsize);
+		if (rc != EOK)
+			return rc;
+
+		uint8_t *data = rfb->tbuf.data;
+		for (size_t i = 0; i < count; i++)
+			data = tpixel_encode(rfb, data, rfb->tile[i]);
+
+		rfb->tbuf.size = count * tpsize;
+	}
+
+	return rfb_tight_put_data(rfb, stream);
+}
+
+/** Encode a rectangle using Tight
+ *
+ * The rectangle is split into subrectangles of RFB_TILE_SIZE, each of
+ * which is sent as a separate Tight rectangle.
+ *
+ * @param rfb   RFB server.
+ * @param rect  Rectangle to encode.
+ * @param count Number of rectangles in the update, updated.
+ */
+static errno_t rfb_rect_encode_tight(rfb_t *rfb, rfb_rectangle_t *rect,
+    size_t *count)
+{
+	for (sysarg_t y = 0; y < rect->height; y += RFB_TILE_SIZE) {
+		for (sysarg_t x = 0; x < rect->width; x += RFB_TILE_SIZE) {
+			sysarg_t width = min((sysarg_t) RFB_TILE_SIZE,
+			    rect->width - x);
+			sysarg_t height = min((sysarg_t) RFB_TILE_SIZE,
+			    rect->height - y);
+
+			rfb_load_tile(rfb, rect->x + x, rect->y + y, width,
+			    height);
+			errno_t rc = rfb_tight_encode_tile(rfb, rect->x + x,
+			    rect->y + y, width, height);
+			if (rc != EOK)
+				return rc;
+
+			(*count)++;
+		}
+	}
+
+	return EOK;
+}
+
+/** Encode a rectangle using raw or TRLE encoding */
+static errno_t rfb_rect_encode_simple(rfb_t *rfb, rfb_rectangle_t *rect,
+    int32_t enctype)
+{
+	errno_t rc = rfb_put_rect_header(rfb, rect->x, rect->y, rect->width,
+	    rect->height, enctype);
+	if (rc != EOK)
+		return rc;
+
+	size_t size = (enctype == RFB_ENCODING_TRLE) ?
+	    rfb_rect_encode_trle(rfb, rect, NULL) :
+	    rfb_rect_encode_raw(rfb, rect, NULL);
+
+	rc = rfb_buf_reserve(&rfb->obuf, size);
+	if (rc != EOK)
+		return rc;
+
+	void *pos = rfb->obuf.data + rfb->obuf.size;
+	if (enctype == RFB_ENCODING_TRLE)
+		rfb_rect_encode_trle(rfb, rect, pos);
+	else
+		rfb_rect_encode_raw(rfb, rect, pos);
+
+	rfb->obuf.size += size;
+	return EOK;
+}
+
+/** Choose the encoding the client prefers most */
+static int32_t rfb_select_encoding(rfb_t *rfb)
+{
+	for (size_t i = 0; i < rfb->encodings_count; i++) {
+		/* Tight pixels are defined for true color only */
+		if (rfb->encodings[i] == RFB_ENCODING_TIGHT &&
+		    !rfb->pixel_format.true_color)
+			continue;
+
+		return rfb->encodings[i];
+	}
+
+	return RFB_ENCODING_RAW;
+}
+
+/** Encode a framebuffer update message into rfb->obuf
+ *
+ * Must be called with rfb->lock held. If this fails, the compression
+ * streams are out of sync with the client and the connection needs
+ * to be closed.
+ *
+ * @param rfb         RFB server.
+ * @param incremental Client already has the previous contents.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t rfb_encode_update(rfb_t *rfb, bool incremental)
+{
+	rfb_rectangle_t rects[RFB_MAX_RECTS];
+	rfb_rectangle_t copy;
+	sysarg_t copy_src_y = 0;
+	bool have_copy = false;
+	size_t count = 0;
+
+	if (!incremental || (rfb->tile_hashing && !rfb->hashes_valid)) {
+		rfb->hashes_valid = false;
 		rfb->damage_rect.x = 0;
 		rfb->damage_rect.y = 0;
 		rfb->damage_rect.width = rfb->width;
 		rfb->damage_rect.height = rfb->height;
+		rfb->damage_valid = true;
+	}
+
+	if (rfb->damage_valid) {
+		if (rfb->tile_hashing) {
+			count = rfb_dirty_rects(rfb, rects, &copy, &copy_src_y,
+			    &have_copy);
+		} else {
+			rects[0] = rfb->damage_rect;
+			count = 1;
+		}
 	}
 
-	/* We send only single raw rectangle right now */
-	size_t buf_size = sizeof(rfb_framebuffer_update_t) +
-	    sizeof(rfb_rectangle_t) * 1 +
-	    rfb_rect_encode_raw(rfb, &rfb->damage_rect, NULL);
+	rfb->damage_valid = false;
 
-	void *buf = malloc(buf_size);
-	if (buf == NULL) {
-		fibril_mutex_unlock(&rfb->lock);
-		return ENOMEM;
+	int32_t enctype = rfb_select_encoding(rfb);
+	size_t rect_count = 0;
+	errno_t rc;
+
+	rfb->obuf.size = 0;
+	rfb_framebuffer_update_t fbu;
+	memset(&fbu, 0, sizeof(fbu));
+	rc = rfb_buf_append(&rfb->obuf, &fbu, sizeof(fbu));
+	if (rc != EOK)
+		goto error;
+
+	if (have_copy) {
+		rc = rfb_put_rect_header(rfb, copy.x, copy.y, copy.width,
+		    copy.height, RFB_ENCODING_COPYRECT);
+		if (rc != EOK)
+			goto error;
+
+		rfb_copy_rect_t cr;
+		cr.src_x = host2uint16_t_be(copy.x);
+		cr.src_y = host2uint16_t_be(copy_src_y);
+		rc = rfb_buf_append(&rfb->obuf, &cr, sizeof(cr));
+		if (rc != EOK)
+			goto error;
+
+		rect_count++;
 	}
-	memset(buf, 0, buf_size);
 
-	void *pos = buf;
-	rfb_framebuffer_update_t *fbu = buf;
-	fbu->message_type = RFB_SMSG_FRAMEBUFFER_UPDATE;
-	fbu->rect_count = 1;
-	rfb_framebuffer_update_to_be(fbu, fbu);
-	pos += sizeof(rfb_framebuffer_update_t);
+	for (size_t i = 0; i < count; i++) {
+		switch (enctype) {
+		case RFB_ENCODING_ZRLE:
+			rc = rfb_rect_encode_zrle(rfb, &rects[i]);
+			rect_count++;
+			break;
+		case RFB_ENCODING_TIGHT:
+			rc = rfb_rect_encode_tight(rfb, &rects[i], &rect_count);
+			break;
+		default:
+			rc = rfb_rect_encode_simple(rfb, &rects[i], enctype);
+			rect_count++;
+			break;
+		}
 
-	rfb_rectangle_t *rect = pos;
-	pos += sizeof(rfb_rectangle_t);
+		if (rc != EOK)
+			goto error;
+	}
 
-	*rect = rfb->damage_rect;
+	fbu.message_type = RFB_SMSG_FRAMEBUFFER_UPDATE;
+	fbu.rect_count = rect_count;
+	rfb_framebuffer_update_to_be(&fbu, &fbu);
+	memcpy(rfb->obuf.data, &fbu, sizeof(fbu));
+	return EOK;
+error:
+	rfb->hashes_valid = false;
+	return rc;
+}
 
-	if (rfb->supports_trle) {
-		rect->enctype = RFB_ENCODING_TRLE;
-		pos += rfb_rect_encode_trle(rfb, rect, pos);
-	} else {
-		rect->enctype = RFB_ENCODING_RAW;
-		pos += rfb_rect_encode_raw(rfb, rect, pos);
+static errno_t rfb_send_framebuffer_update(rfb_t *rfb, tcp_conn_t *conn,
+    bool incremental)
+{
+	fibril_mutex_lock(&rfb->lock);
+
+	/* Hold back an incremental update until there is something new */
+	bool full = rfb->tile_hashing && !rfb->hashes_valid;
+	if (incremental && !rfb->damage_valid && !full) {
+		(void) fibril_condvar_wait_timeout(&rfb->damage_cv, &rfb->lock,
+		    RFB_UPDATE_TIMEOUT);
 	}
-	rfb_rectangle_to_be(rect, rect);
 
-	rfb->damage_valid = false;
+	errno_t rc = rfb_encode_update(rfb, incremental);
+	if (rc != EOK) {
+		fibril_mutex_unlock(&rfb->lock);
+		return rc;
+	}
 
 	size_t send_palette_size = 0;
 	void *send_palette = NULL;
@@ -538,7 +1683,6 @@ static errno_t rfb_send_framebuffer_update(rfb_t *rfb, tcp_conn_t *conn,
 	if (!rfb->pixel_format.true_color) {
 		send_palette = rfb_send_palette_message(rfb, &send_palette_size);
 		if (send_palette == NULL) {
-			free(buf);
 			fibril_mutex_unlock(&rfb->lock);
 			return ENOMEM;
 		}
@@ -546,18 +1690,15 @@ static errno_t rfb_send_framebuffer_update(rfb_t *rfb, tcp_conn_t *conn,
 
 	fibril_mutex_unlock(&rfb->lock);
 
-	if (!rfb->pixel_format.true_color) {
-		errno_t rc = tcp_conn_send(conn, send_palette, send_palette_size);
-		if (rc != EOK) {
-			free(buf);
+	if (send_palette != NULL) {
+		rc = tcp_conn_send(conn, send_palette, send_palette_size);
+		free(send_palette);
+		if (rc != EOK)
 			return rc;
-		}
 	}
 
-	errno_t rc = tcp_conn_send(conn, buf, buf_size);
-	free(buf);
-
-	return rc;
+	/* Only this connection fibril touches the output buffer */
+	return tcp_conn_send(conn, rfb->obuf.data, rfb->obuf.size);
 }
 
 static errno_t rfb_set_pixel_format(rfb_t *rfb, rfb_pixel_format_t *pixel_format)
@@ -597,7 +1738,7 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 	}
 
 	char client_version[12];
-	rc = recv_chars(conn, client_version, 12);
+	rc = recv_chars(rfb, conn, client_version, 12);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_WARN, "Failed receiving client version: %s",
 		    str_error(rc));
@@ -624,7 +1765,7 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 	}
 
 	char selected_sec_type = 0;
-	rc = recv_char(conn, &selected_sec_type);
+	rc = recv_char(rfb, conn, &selected_sec_type);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_WARN, "Failed receiving security type: %s",
 		    str_error(rc));
@@ -645,7 +1786,7 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 
 	/* Client init */
 	char shared_flag;
-	rc = recv_char(conn, &shared_flag);
+	rc = recv_char(rfb, conn, &shared_flag);
 	if (rc != EOK) {
 		log_msg(LOG_DEFAULT, LVL_WARN, "Failed receiving client init: %s",
 		    str_error(rc));
@@ -676,9 +1817,31 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 		return;
 	}
 
+	/*
+	 * Update requests are answered only once all buffered client
+	 * messages have been processed, so that a burst of requests
+	 * results in a single update.
+	 */
+	bool update_pending = false;
+	bool update_incremental = true;
+
 	while (true) {
+		if (update_pending && !recv_pending(rfb)) {
+			rc = rfb_send_framebuffer_update(rfb, conn,
+			    update_incremental);
+			if (rc != EOK) {
+				log_msg(LOG_DEFAULT, LVL_WARN,
+				    "Failed sending framebuffer update: %s",
+				    str_error(rc));
+				return;
+			}
+
+			update_pending = false;
+			update_incremental = true;
+		}
+
 		char message_type = 0;
-		rc = recv_char(conn, &message_type);
+		rc = recv_char(rfb, conn, &message_type);
 		if (rc != EOK) {
 			log_msg(LOG_DEFAULT, LVL_WARN,
 			    "Failed receiving client message type: %s",
@@ -694,7 +1857,7 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 		rfb_client_cut_text_t cct;
 		switch (message_type) {
 		case RFB_CMSG_SET_PIXEL_FORMAT:
-			rc = recv_message(conn, message_type, &spf, sizeof(spf));
+			rc = recv_message(rfb, conn, message_type, &spf, sizeof(spf));
 			if (rc != EOK) {
 				log_msg(LOG_DEFAULT, LVL_WARN,
 				    "Failed receiving client message: %s",
@@ -710,7 +1873,7 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 				return;
 			break;
 		case RFB_CMSG_SET_ENCODINGS:
-			rc = recv_message(conn, message_type, &se, sizeof(se));
+			rc = recv_message(rfb, conn, message_type, &se, sizeof(se));
 			if (rc != EOK) {
 				log_msg(LOG_DEFAULT, LVL_WARN,
 				    "Failed receiving client message: %s",
@@ -719,21 +1882,48 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 			}
 			rfb_set_encodings_to_host(&se, &se);
 			log_msg(LOG_DEFAULT, LVL_DEBUG2, "Received SetEncodings message");
+
+			int32_t encodings[RFB_MAX_ENCODINGS];
+			size_t encodings_count = 0;
+			bool supports_copyrect = false;
+
 			for (uint16_t i = 0; i < se.count; i++) {
 				int32_t encoding = 0;
-				rc = recv_chars(conn, (char *) &encoding, sizeof(int32_t));
+				rc = recv_chars(rfb, conn, (char *) &encoding,
+				    sizeof(int32_t));
 				if (rc != EOK)
 					return;
 				encoding = uint32_t_be2host(encoding);
-				if (encoding == RFB_ENCODING_TRLE) {
-					log_msg(LOG_DEFAULT, LVL_DEBUG,
-					    "Client supports TRLE encoding");
-					rfb->supports_trle = true;
+
+				switch (encoding) {
+				case RFB_ENCODING_COPYRECT:
+					supports_copyrect = true;
+					break;
+				case RFB_ENCODING_RAW:
+				case RFB_ENCODING_TIGHT:
+				case RFB_ENCODING_TRLE:
+				case RFB_ENCODING_ZRLE:
+					if (encodings_count == RFB_MAX_ENCODINGS)
+						break;
+					encodings[encodings_count++] = encoding;
+					break;
+				default:
+					continue;
 				}
+
+				log_msg(LOG_DEFAULT, LVL_DEBUG,
+				    "Client supports encoding %" PRId32, encoding);
 			}
+
+			fibril_mutex_lock(&rfb->lock);
+			memcpy(rfb->encodings, encodings,
+			    encodings_count * sizeof(int32_t));
+			rfb->encodings_count = encodings_count;
+			rfb->supports_copyrect = supports_copyrect;
+			fibril_mutex_unlock(&rfb->lock);
 			break;
 		case RFB_CMSG_FRAMEBUFFER_UPDATE_REQUEST:
-			rc = recv_message(conn, message_type, &fbur, sizeof(fbur));
+			rc = recv_message(rfb, conn, message_type, &fbur, sizeof(fbur));
 			if (rc != EOK) {
 				log_msg(LOG_DEFAULT, LVL_WARN,
 				    "Failed receiving client message: %s",
@@ -743,10 +1933,12 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 			rfb_framebuffer_update_request_to_host(&fbur, &fbur);
 			log_msg(LOG_DEFAULT, LVL_DEBUG2,
 			    "Received FramebufferUpdateRequest message");
-			rfb_send_framebuffer_update(rfb, conn, fbur.incremental);
+			update_pending = true;
+			if (!fbur.incremental)
+				update_incremental = false;
 			break;
 		case RFB_CMSG_KEY_EVENT:
-			rc = recv_message(conn, message_type, &ke, sizeof(ke));
+			rc = recv_message(rfb, conn, message_type, &ke, sizeof(ke));
 			if (rc != EOK) {
 				log_msg(LOG_DEFAULT, LVL_WARN,
 				    "Failed receiving client message: %s",
@@ -757,7 +1949,7 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 			log_msg(LOG_DEFAULT, LVL_DEBUG2, "Received KeyEvent message");
 			break;
 		case RFB_CMSG_POINTER_EVENT:
-			rc = recv_message(conn, message_type, &pe, sizeof(pe));
+			rc = recv_message(rfb, conn, message_type, &pe, sizeof(pe));
 			if (rc != EOK) {
 				log_msg(LOG_DEFAULT, LVL_WARN,
 				    "Failed receiving client message: %s",
@@ -768,7 +1960,7 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 			log_msg(LOG_DEFAULT, LVL_DEBUG2, "Received PointerEvent message");
 			break;
 		case RFB_CMSG_CLIENT_CUT_TEXT:
-			rc = recv_message(conn, message_type, &cct, sizeof(cct));
+			rc = recv_message(rfb, conn, message_type, &cct, sizeof(cct));
 			if (rc != EOK) {
 				log_msg(LOG_DEFAULT, LVL_WARN,
 				    "Failed receiving client message: %s",
@@ -777,7 +1969,9 @@ static void rfb_socket_connection(rfb_t *rfb, tcp_conn_t *conn)
 			}
 			rfb_client_cut_text_to_host(&cct, &cct);
 			log_msg(LOG_DEFAULT, LVL_DEBUG2, "Received ClientCutText message");
-			recv_skip_chars(conn, cct.length);
+			rc = recv_skip_chars(rfb, conn, cct.length);
+			if (rc != EOK)
+				return;
 			break;
 		default:
 			log_msg(LOG_DEFAULT, LVL_WARN,
@@ -825,8 +2019,9 @@ static void rfb_new_conn(tcp_listener_t *lst, tcp_conn_t *conn)
 	rfb_t *rfb = (rfb_t *)tcp_listener_userptr(lst);
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "Connection accepted");
 
-	rbuf_out = 0;
-	rbuf_in = 0;
+	fibril_mutex_lock(&rfb->lock);
+	rfb_reset_client(rfb);
+	fibril_mutex_unlock(&rfb->lock);
 
 	rfb_socket_connection(rfb, conn);
 }
@@ -32,6 +32,7 @@
 #include <inet/tcp.h>
 #include <io/pixelmap.h>
 #include <fibril_synch.h>
+#include <zlib.h>
 
 #define RFB_SECURITY_NONE 1
 #define RFB_SECURITY_HANDSHAKE_OK 0
@@ -49,10 +50,29 @@
 #define RFB_SMSG_SERVER_CUT_TEXT 3
 
 #define RFB_ENCODING_RAW 0
+#define RFB_ENCODING_COPYRECT 1
+#define RFB_ENCODING_TIGHT 7
 #define RFB_ENCODING_TRLE 15
+#define RFB_ENCODING_ZRLE 16
 
 #define RFB_TILE_ENCODING_RAW 0
 #define RFB_TILE_ENCODING_SOLID 1
+#define RFB_TILE_ENCODING_PLAIN_RLE 128
+
+/** Number of zlib streams used by the Tight encoding */
+#define RFB_TIGHT_STREAMS 3
+
+/** Maximum number of (non-pseudo) encodings remembered from the client */
+#define RFB_MAX_ENCODINGS 4
+
+/** Size of the receive buffer */
+#define RFB_RBUF_SIZE 4096
+
+/** Width and height of a hashed tile (in pixels) */
+#define RFB_HASH_TILE 16
+
+/** Width and height of a ZRLE tile or a Tight subrectangle (in pixels) */
+#define RFB_TILE_SIZE 64
 
 typedef struct {
 	uint8_t bpp;
@@ -146,6 +166,18 @@ typedef struct {
 	uint16_t blue;
 } __attribute__((packed)) rfb_color_map_entry_t;
 
+typedef struct {
+	uint16_t src_x;
+	uint16_t src_y;
+} __attribute__((packed)) rfb_copy_rect_t;
+
+/** Growable byte buffer */
+typedef struct {
+	uint8_t *data;
+	size_t size;
+	size_t alloc;
+} rfb_buf_t;
+
 typedef struct {
 	uint16_t width;
 	uint16_t height;
@@ -156,14 +188,52 @@ typedef struct {
 	pixelmap_t framebuffer;
 	rfb_rectangle_t damage_rect;
 	bool damage_valid;
+	fibril_condvar_t damage_cv;
 	fibril_mutex_t lock;
 	pixel_t *palette;
 	size_t palette_used;
-	bool supports_trle;
+
+	/** Encodings supported by the client, in order of preference */
+	int32_t encodings[RFB_MAX_ENCODINGS];
+	size_t encodings_count;
+	bool supports_copyrect;
+
+	/** Skip tiles which the client already has */
+	bool tile_hashing;
+	/** Per-row hashes of RFB_HASH_TILE wide blocks, as seen by the client */
+	uint64_t *hashes;
+	/** Hashes of the current framebuffer contents (scratch) */
+	uint64_t *fresh;
+	/** Dirty flags of RFB_HASH_TILE square tiles (scratch) */
+	uint8_t *dirty;
+	size_t hash_cols;
+	bool hashes_valid;
+
+	/** Persistent compression streams */
+	zlib_compressor_t *zrle_zlib;
+	zlib_compressor_t *tight_zlib[RFB_TIGHT_STREAMS];
+
+	/** Receive buffer */
+	char rbuf[RFB_RBUF_SIZE];
+	size_t rbuf_out;
+	size_t rbuf_in;
+
+	/** Encoded update message */
+	rfb_buf_t obuf;
+	/** Uncompressed encoder output (scratch) */
+	rfb_buf_t tbuf;
+	/** Compressed encoder output (scratch) */
+	rfb_buf_t zbuf;
+	/** Pixels of the tile being encoded (scratch) */
+	pixel_t tile[RFB_TILE_SIZE * RFB_TILE_SIZE];
 } rfb_t;
 
 extern errno_t rfb_init(rfb_t *, uint16_t, uint16_t, const char *);
+extern void rfb_fini(rfb_t *);
 extern errno_t rfb_set_size(rfb_t *, uint16_t, uint16_t);
 extern errno_t rfb_listen(rfb_t *, uint16_t);
+extern void rfb_damage(rfb_t *, sysarg_t, sysarg_t, sysarg_t, sysarg_t);
+extern void rfb_reset_client(rfb_t *);
+extern errno_t rfb_encode_update(rfb_t *, bool);
 
 #endif
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * Damage traces
+ *
+ * A trace records what the RFB server has been asked to display, so that
+ * the encoders can later be compared on a realistic workload. The trace
+ * starts with a header followed by one record per damage event. Each
+ * record holds the damaged rectangle and its new contents. All values
+ * are little-endian.
+ */
+
+#include <byteorder.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <io/log.h>
+#include <macros.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <time.h>
+
+#include "rfb.h"
+#include "trace.h"
+
+#define TRACE_MAGIC  "RFBTRACE"
+
+typedef struct {
+	char magic[8];
+	uint16_t width;
+	uint16_t height;
+} __attribute__((packed)) trace_header_t;
+
+typedef struct {
+	uint16_t x;
+	uint16_t y;
+	uint16_t width;
+	uint16_t height;
+} __attribute__((packed)) trace_record_t;
+
+/** Server configuration to replay a trace with */
+typedef struct {
+	const char *name;
+	int32_t encoding;
+	bool tile_hashing;
+	bool copyrect;
+} trace_config_t;
+
+static trace_config_t trace_configs[] = {
+	{ "raw", RFB_ENCODING_RAW, false, false },
+	{ "raw+hash", RFB_ENCODING_RAW, true, false },
+	{ "trle+hash", RFB_ENCODING_TRLE, true, false },
+	{ "zrle+hash", RFB_ENCODING_ZRLE, true, false },
+	{ "zrle+copyrect", RFB_ENCODING_ZRLE, true, true },
+	{ "tight+hash", RFB_ENCODING_TIGHT, true, false },
+	{ "tight+copyrect", RFB_ENCODING_TIGHT, true, true }
+};
+
+/** Trace being recorded */
+static FILE *trace_file;
+
+/** Start recording a damage trace
+ *
+ * @param rfb  RFB server.
+ * @param path Path of the trace file.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t rfb_trace_start(rfb_t *rfb, const char *path)
+{
+	trace_header_t header;
+
+	trace_file = fopen(path, "wb");
+	if (trace_file == NULL)
+		return EIO;
+
+	memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+	header.width = host2uint16_t_le(rfb->width);
+	header.height = host2uint16_t_le(rfb->height);
+
+	if (fwrite(&header, sizeof(header), 1, trace_file) != 1) {
+		fclose(trace_file);
+		trace_file = NULL;
+		return EIO;
+	}
+
+	return EOK;
+}
+
+static bool trace_write_pixels(const pixel_t *pixels, size_t count)
+{
+	uint32_t buf[256];
+
+	while (count > 0) {
+		size_t n = min(count, sizeof(buf) / sizeof(uint32_t));
+		for (size_t i = 0; i < n; i++)
+			buf[i] = host2uint32_t_le(pixels[i]);
+
+		if (fwrite(buf, sizeof(uint32_t), n, trace_file) != n)
+			return false;
+
+		pixels += n;
+		count -= n;
+	}
+
+	return true;
+}
+
+/** Record a damaged rectangle
+ *
+ * Must be called with rfb->lock held, after the framebuffer has been
+ * updated. Does nothing unless a trace is being recorded.
+ */
+void rfb_trace_damage(rfb_t *rfb, sysarg_t x, sysarg_t y, sysarg_t width,
+    sysarg_t height)
+{
+	if (trace_file == NULL)
+		return;
+
+	trace_record_t record = {
+		.x = host2uint16_t_le(x),
+		.y = host2uint16_t_le(y),
+		.width = host2uint16_t_le(width),
+		.height = host2uint16_t_le(height)
+	};
+
+	bool ok = fwrite(&record, sizeof(record), 1, trace_file) == 1;
+	for (sysarg_t row = 0; ok && row < height; row++) {
+		ok = trace_write_pixels(rfb->framebuffer.data +
+		    (y + row) * rfb->framebuffer.width + x, width);
+	}
+
+	if (ok && fflush(trace_file) == 0)
+		return;
+
+	log_msg(LOG_DEFAULT, LVL_WARN, "Failed writing damage trace, "
+	    "recording stopped.");
+	fclose(trace_file);
+	trace_file = NULL;
+}
+
+/** Replay a trace with one server configuration and print the results
+ *
+ * Every record of the trace is one frame, i.e. one framebuffer update
+ * sent to the client.
+ */
+static errno_t trace_replay_config(FILE *file, uint16_t width,
+    uint16_t height, trace_config_t *config)
+{
+	uint64_t frames = 0;
+	uint64_t bytes = 0;
+	uint64_t usecs = 0;
+	uint64_t max_usecs = 0;
+	struct timespec start;
+	struct timespec now;
+
+	rfb_t *rfb = malloc(sizeof(rfb_t));
+	if (rfb == NULL)
+		return ENOMEM;
+
+	errno_t rc = rfb_init(rfb, width, height, config->name);
+	if (rc != EOK) {
+		free(rfb);
+		return rc;
+	}
+
+	rfb->encodings[0] = config->encoding;
+	rfb->encodings_count = 1;
+	rfb->tile_hashing = config->tile_hashing;
+	rfb->supports_copyrect = config->copyrect;
+
+	/* A newly connected client asks for the whole screen first */
+	rc = rfb_encode_update(rfb, false);
+	if (rc != EOK)
+		goto out;
+
+	if (fseek(file, sizeof(trace_header_t), SEEK_SET) != 0) {
+		rc = EIO;
+		goto out;
+	}
+
+	while (true) {
+		trace_record_t record;
+		if (fread(&record, sizeof(record), 1, file) != 1)
+			break;
+
+		sysarg_t x = uint16_t_le2host(record.x);
+		sysarg_t y = uint16_t_le2host(record.y);
+		sysarg_t rwidth = uint16_t_le2host(record.width);
+		sysarg_t rheight = uint16_t_le2host(record.height);
+
+		if (x + rwidth > width || y + rheight > height) {
+			rc = EINVAL;
+			goto out;
+		}
+
+		for (sysarg_t row = 0; row < rheight; row++) {
+			pixel_t *pixels = rfb->framebuffer.data +
+			    (y + row) * rfb->framebuffer.width + x;
+
+			if (fread(pixels, sizeof(pixel_t), rwidth, file) != rwidth) {
+				rc = EIO;
+				goto out;
+			}
+
+			for (sysarg_t i = 0; i < rwidth; i++)
+				pixels[i] = uint32_t_le2host(pixels[i]);
+		}
+
+		rfb_damage(rfb, x, y, rwidth, rheight);
+
+		getuptime(&start);
+		rc = rfb_encode_update(rfb, true);
+		getuptime(&now);
+		if (rc != EOK)
+			goto out;
+
+		uint64_t duration = ts_sub_diff(&now, &start) / 1000;
+		usecs += duration;
+		max_usecs = max(max_usecs, duration);
+		bytes += rfb->obuf.size;
+		frames++;
+	}
+
+	if (frames == 0) {
+		printf("%-16s no frames\n", config->name);
+	} else {
+		printf("%-16s %8" PRIu64 " %12" PRIu64 " %10" PRIu64
+		    " %10" PRIu64 "\n", config->name, frames, bytes / frames,
+		    usecs / frames, max_usecs);
+	}
+
+out:
+	rfb_fini(rfb);
+	free(rfb);
+	return rc;
+}
+
+/** Replay a damage trace with all encodings
+ *
+ * For each encoding, print the average number of bytes sent and the
+ * average and maximum time spent encoding per frame.
+ *
+ * @param path Path of the trace file.
+ *
+ * @return EOK on success or an error code.
+ */
+errno_t rfb_trace_replay(const char *path)
+{
+	trace_header_t header;
+	errno_t rc = EOK;
+
+	FILE *file = fopen(path, "rb");
+	if (file == NULL)
+		return ENOENT;
+
+	if (fread(&header, sizeof(header), 1, file) != 1 ||
+	    memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0) {
+		fclose(file);
+		return EINVAL;
+	}
+
+	uint16_t width = uint16_t_le2host(header.width);
+	uint16_t height = uint16_t_le2host(header.height);
+
+	printf("Trace %s, %" PRIu16 "x%" PRIu16 "\n", path, width, height);
+	printf("%-16s %8s %12s %10s %10s\n", "encoding", "frames",
+	    "bytes/frame", "us/frame", "max us");
+
+	for (size_t i = 0; i < ARRAY_SIZE(trace_configs); i++) {
+		rc = trace_replay_config(file, width, height, &trace_configs[i]);
+		if (rc != EOK)
+			break;
+	}
+
+	fclose(file);
+	return rc;
+}
@@ -62,9 +62,35 @@ static errno_t handle_log_level_change(sysarg_t new_level)
 	return EOK;
 }
 
+static errno_t handle_get_recent(size_t *nread)
+{
+	ipc_call_t call;
+	size_t size;
+	if (!async_data_read_receive(&call, &size)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	if (size > LOG_RECENT_SIZE)
+		size = LOG_RECENT_SIZE;
+
+	char *buf = malloc(size);
+	if (buf == NULL) {
+		async_answer_0(&call, ENOMEM);
+		return ENOMEM;
+	}
+
+	*nread = dest_recent_read(buf, size);
+	errno_t rc = async_data_read_finalize(&call, buf, *nread);
+	free(buf);
+
+	return rc;
+}
+
 void logger_connection_handler_control(ipc_call_t *icall)
 {
 	errno_t rc;
+	size_t nread;
 	int fd;
 
 	async_accept_0(icall);
@@ -82,10 +108,14 @@ void logger_connection_handler_control(ipc_call_t *icall)
 		switch (IPC_GET_IMETHOD(call)) {
 		case LOGGER_CONTROL_SET_DEFAULT_LEVEL:
 			rc = set_default_logging_level(IPC_GET_ARG1(call));
+			if (rc == EOK)
+				writers_update_levels();
 			async_answer_0(&call, rc);
 			break;
 		case LOGGER_CONTROL_SET_LOG_LEVEL:
 			rc = handle_log_level_change(IPC_GET_ARG1(call));
+			if (rc == EOK)
+				writers_update_levels();
 			async_answer_0(&call, rc);
 			break;
 		case LOGGER_CONTROL_SET_ROOT:
@@ -96,6 +126,11 @@ void logger_connection_handler_control(ipc_call_t *icall)
 			}
 			async_answer_0(&call, rc);
 			break;
+		case LOGGER_CONTROL_GET_RECENT:
+			nread = 0;
+			rc = handle_get_recent(&nread);
+			async_answer_1(&call, rc, nread);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 			break;
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2026 HelenOS project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/** @addtogroup logger
+ * @{
+ */
+
+/** @file Log destinations.
+ *
+ * Messages are formatted into a per-destination buffer which is written
+ * out when it fills up, when it gets older than LOG_FLUSH_AGE or when
+ * a message of level LVL_ERROR or more severe arrives. Files larger than
+ * LOG_ROTATE_SIZE are renamed to "<name>.1" and started afresh.
+ *
+ * All messages are also kept in a ring of recent messages which can be
+ * read through the control interface even before the logger has access
+ * to the file system.
+ */
+
+#include <adt/list.h>
+#include <assert.h>
+#include <errno.h>
+#include <fibril.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <time.h>
+#include <vfs/vfs.h>
+#include "logger.h"
+
+/** Size of the write-behind buffer of each destination. */
+#define LOG_BUFFER_SIZE 8192
+
+/** Maximum age of buffered messages (in microseconds). */
+#define LOG_FLUSH_AGE 500000
+
+/** Size at which a log file is rotated. */
+#define LOG_ROTATE_SIZE (256 * 1024)
+
+static FIBRIL_MUTEX_INITIALIZE(dest_list_guard);
+static LIST_INITIALIZE(dest_list);
+
+static FIBRIL_MUTEX_INITIALIZE(recent_guard);
+static char recent[LOG_RECENT_SIZE];
+/** Number of bytes ever written to the ring. */
+static size_t recent_head;
+
+static void recent_append(const char *line, size_t len)
+{
+	fibril_mutex_lock(&recent_guard);
+
+	/* Only the tail of an overlong line fits. */
+	if (len > LOG_RECENT_SIZE) {
+		line += len - LOG_RECENT_SIZE;
+		len = LOG_RECENT_SIZE;
+	}
+
+	size_t pos = recent_head % LOG_RECENT_SIZE;
+	size_t part = min(len, LOG_RECENT_SIZE - pos);
+	memcpy(&recent[pos], line, part);
+	memcpy(recent, line + part, len - part);
+	recent_head += len;
+
+	fibril_mutex_unlock(&recent_guard);
+}
+
+/** Copy out recent messages.
+ *
+ * Only whole lines are returned, the newest ones that fit.
+ *
+ * @param buf Destination buffer.
+ * @param size Size of the buffer.
+ * @return Number of bytes stored.
+ */
+size_t dest_recent_read(char *buf, size_t size)
+{
+	fibril_mutex_lock(&recent_guard);
+
+	size_t avail = min(recent_head, (size_t) LOG_RECENT_SIZE);
+	size_t len = min(avail, size);
+	size_t start = recent_head - len;
+
+	size_t pos = start % LOG_RECENT_SIZE;
+	size_t part = min(len, LOG_RECENT_SIZE - pos);
+	memcpy(buf, &recent[pos], part);
+	memcpy(buf + part, recent, len - part);
+
+	/* Drop the partially overwritten (or truncated) oldest line. */
+	bool partial = (start > 0) && (recent[(start - 1) % LOG_RECENT_SIZE] !=
+	    '\n');
+
+	fibril_mutex_unlock(&recent_guard);
+
+	if (partial) {
+		size_t skip = 0;
+		while ((skip < len) && (buf[skip] != '\n'))
+			skip++;
+		if (skip < len)
+			skip++;
+		memmove(buf, buf + skip, len - skip);
+		len -= skip;
+	}
+
+	return len;
+}
+
+errno_t dest_create(const char *name, logger_dest_t **dest)
+{
+	logger_dest_t *result = calloc(1, sizeof(logger_dest_t));
+	if (result == NULL)
+		return ENOMEM;
+
+	result->buffer = malloc(LOG_BUFFER_SIZE);
+	if (result->buffer == NULL)
+		goto error;
+
+	if (asprintf(&result->filename, "/log/%s", name) < 0)
+		goto error;
+
+	if (asprintf(&result->rotated, "/log/%s.1", name) < 0)
+		goto error;
+
+	result->fd = -1;
+	fibril_mutex_initialize(&result->guard);
+	link_initialize(&result->link);
+
+	fibril_mutex_lock(&dest_list_guard);
+	list_append(&result->link, &dest_list);
+	fibril_mutex_unlock(&dest_list_guard);
+
+	*dest = result;
+	return EOK;
+
+error:
+	free(result->filename);
+	free(result->buffer);
+	free(result);
+	return ENOMEM;
+}
+
+/** Open the log file.
+ *
+ * Due to lazy opening, nothing is done until the logger has a VFS root
+ * with /log in it.
+ */
+static errno_t dest_open(logger_dest_t *dest)
+{
+	errno_t rc = vfs_lookup_open(dest->filename,
+	    WALK_REGULAR | WALK_MAY_CREATE, MODE_WRITE | MODE_APPEND,
+	    &dest->fd);
+	if (rc != EOK) {
+		dest->fd = -1;
+		return rc;
+	}
+
+	vfs_stat_t stat;
+	rc = vfs_stat(dest->fd, &stat);
+	dest->pos = (rc == EOK) ? stat.size : 0;
+
+	return EOK;
+}
+
+/** Rename the log file away and start a new one. */
+static void dest_rotate(logger_dest_t *dest)
+{
+	vfs_put(dest->fd);
+	dest->fd = -1;
+
+	(void) vfs_unlink_path(dest->rotated);
+	(void) vfs_rename_path(dest->filename, dest->rotated);
+
+	(void) dest_open(dest);
+}
+
+/** Write out buffered messages.
+ *
+ * Precondition: dest is locked.
+ *
+ * @param dest Destination to flush.
+ * @param sync Also sync the file to the underlying device.
+ */
+static void dest_flush_locked(logger_dest_t *dest, bool sync)
+{
+	assert(fibril_mutex_is_locked(&dest->guard));
+
+	if (dest->used == 0)
+		return;
+
+	if (dest->fd < 0)
+		(void) dest_open(dest);
+
+	if ((dest->fd >= 0) && (dest->pos > 0) &&
+	    (dest->pos + dest->used > LOG_ROTATE_SIZE))
+		dest_rotate(dest);
+
+	/* Without the file the messages live on only in the recent ring. */
+	if (dest->fd >= 0) {
+		size_t nwritten;
+		errno_t rc = vfs_write(dest->fd, &dest->pos, dest->buffer,
+		    dest->used, &nwritten);
+		if (rc != EOK) {
+			vfs_put(dest->fd);
+			dest->fd = -1;
+		} else if (sync) {
+			(void) vfs_sync(dest->fd);
+		}
+	}
+
+	dest->used = 0;
+}
+
+void dest_destroy(logger_dest_t *dest)
+{
+	fibril_mutex_lock(&dest_list_guard);
+	list_remove(&dest->link);
+	fibril_mutex_unlock(&dest_list_guard);
+
+	fibril_mutex_lock(&dest->guard);
+	dest_flush_locked(dest, false);
+	fibril_mutex_unlock(&dest->guard);
+
+	if (dest->fd >= 0)
+		vfs_put(dest->fd);
+
+	free(dest->buffer);
+	free(dest->filename);
+	free(dest->rotated);
+	free(dest);
+}
+
+/** Write message to destination.
+ *
+ * @param dest Destination.
+ * @param full_name Full name of the log.
+ * @param level Message level.
+ * @param message Message text.
+ */
+void dest_write(logger_dest_t *dest, const char *full_name,
+    log_level_t level, const char *message)
+{
+	fibril_mutex_lock(&dest->guard);
+
+	size_t space = LOG_BUFFER_SIZE - dest->used;
+	int n = snprintf(&dest->buffer[dest->used], space, "[%s] %s: %s\n",
+	    full_name, log_level_str(level), message);
+	if (n < 0) {
+		fibril_mutex_unlock(&dest->guard);
+		return;
+	}
+
+	if ((size_t) n >= space && dest->used > 0) {
+		/* Make room and try again. */
+		dest_flush_locked(dest, false);
+		space = LOG_BUFFER_SIZE;
+		n = snprintf(dest->buffer, space, "[%s] %s: %s\n",
+		    full_name, log_level_str(level), message);
+		if (n < 0) {
+			fibril_mutex_unlock(&dest->guard);
+			return;
+		}
+	}
+
+	size_t len = n;
+	if (len >= space) {
+		/* Truncated, still terminate the line. */
+		len = space - 1;
+		dest->buffer[dest->used + len - 1] = '\n';
+	}
+
+	if (dest->used == 0)
+		getuptime(&dest->oldest);
+
+	recent_append(&dest->buffer[dest->used], len);
+	dest->used += len;
+
+	/* Make sure the reason of a failure makes it to the disk. */
+	if (level <= LVL_ERROR)
+		dest_flush_locked(dest, true);
+	else if (dest->used > LOG_BUFFER_SIZE / 4 * 3)
+		dest_flush_locked(dest, false);
+
+	fibril_mutex_unlock(&dest->guard);
+}
+
+/** Periodically flush destinations with old messages. */
+static errno_t dest_flush_fibril(void *arg)
+{
+	while (true) {
+		fibril_usleep(LOG_FLUSH_AGE / 2);
+
+		struct timespec limit;
+		getuptime(&limit);
+		ts_add_diff(&limit, -USEC2NSEC(LOG_FLUSH_AGE));
+
+		fibril_mutex_lock(&dest_list_guard);
+		list_foreach(dest_list, link, logger_dest_t, dest) {
+			fibril_mutex_lock(&dest->guard);
+			if ((dest->used > 0) && ts_gteq(&limit, &dest->oldest))
+				dest_flush_locked(dest, false);
+			fibril_mutex_unlock(&dest->guard);
+		}
+		fibril_mutex_unlock(&dest_list_guard);
+	}
+
+	return EOK;
+}
+
+errno_t dest_init(void)
+{
+	fid_t fid = fibril_create(dest_flush_fibril, NULL);
+	if (fid == 0)
+		return ENOMEM;
+
+	fibril_add_ready(fid);
+	return EOK;
+}
+
+/**
+ * @}
+ */
@@ -38,14 +38,19 @@
 #include <adt/list.h>
 #include <adt/prodcons.h>
 #include <io/log.h>
+#include <ipc/logger.h>
 #include <async.h>
 #include <stdbool.h>
 #include <fibril_synch.h>
 #include <stdio.h>
+#include <time.h>
 
 #define NAME "logger"
 #define LOG_LEVEL_USE_DEFAULT (LVL_LIMIT + 1)
 
+/** Size of the ring of recent messages. */
+#define LOG_RECENT_SIZE 16384
+
 #ifdef LOGGER_LOG
 #define logger_log(fmt, ...) printf(NAME ": " fmt, ##__VA_ARGS__)
 #else
@@ -55,9 +60,21 @@
 typedef struct logger_log logger_log_t;
 
 typedef struct {
+	link_t link;
 	fibril_mutex_t guard;
 	char *filename;
-	FILE *logfile;
+	/** Name the file gets when rotated */
+	char *rotated;
+	/** Open log file or -1 */
+	int fd;
+	/** Current size of the file */
+	aoff64_t pos;
+	/** Write-behind buffer */
+	char *buffer;
+	/** Number of bytes used in buffer */
+	size_t used;
+	/** When the oldest buffered message was written */
+	struct timespec oldest;
 } logger_dest_t;
 
 struct logger_log {
@@ -74,21 +91,26 @@ struct logger_log {
 	logger_dest_t *dest;
 };
 
-#define MAX_REFERENCED_LOGS_PER_CLIENT 100
-
+/** Logs referenced by a writer client, log ID is index plus one. */
 typedef struct {
 	size_t logs_count;
-	logger_log_t *logs[MAX_REFERENCED_LOGS_PER_CLIENT];
+	logger_log_t *logs[LOGGER_CLIENT_LOGS_MAX];
 } logger_registered_logs_t;
 
 logger_log_t *find_log_by_name_and_lock(const char *name);
 logger_log_t *find_or_create_log_and_lock(const char *, sysarg_t);
-logger_log_t *find_log_by_id_and_lock(sysarg_t);
+log_level_t get_actual_log_level(logger_log_t *);
 bool shall_log_message(logger_log_t *, log_level_t);
 void log_unlock(logger_log_t *);
 void write_to_log(logger_log_t *, log_level_t, const char *);
 void log_release(logger_log_t *);
 
+errno_t dest_init(void);
+errno_t dest_create(const char *, logger_dest_t **);
+void dest_destroy(logger_dest_t *);
+void dest_write(logger_dest_t *, const char *, log_level_t, const char *);
+size_t dest_recent_read(char *, size_t);
+
 void registered_logs_init(logger_registered_logs_t *);
 bool register_log(logger_registered_logs_t *, logger_log_t *);
 void unregister_logs(logger_registered_logs_t *);
@@ -98,6 +120,7 @@ errno_t set_default_logging_level(log_level_t);
 
 void logger_connection_handler_control(ipc_call_t *);
 void logger_connection_handler_writer(ipc_call_t *);
+void writers_update_levels(void);
 
 void parse_initial_settings(void);
 void parse_level_settings(char *);
@@ -49,21 +49,6 @@ static logger_log_t *find_log_by_name_and_parent_no_list_lock(const char *name,
 	return NULL;
 }
 
-static errno_t create_dest(const char *name, logger_dest_t **dest)
-{
-	logger_dest_t *result = malloc(sizeof(logger_dest_t));
-	if (result == NULL)
-		return ENOMEM;
-	if (asprintf(&result->filename, "/log/%s", name) < 0) {
-		free(result);
-		return ENOMEM;
-	}
-	result->logfile = NULL;
-	fibril_mutex_initialize(&result->guard);
-	*dest = result;
-	return EOK;
-}
-
 static logger_log_t *create_log_no_locking(const char *name, logger_log_t *parent)
 {
 	logger_log_t *result = calloc(1, sizeof(logger_log_t));
@@ -83,7 +68,7 @@ static logger_log_t *create_log_no_locking(const char *name, logger_log_t *paren
 		result->full_name = str_dup(name);
 		if (result->full_name == NULL)
 			goto error;
-		errno_t rc = create_dest(name, &result->dest);
+		errno_t rc = dest_create(name, &result->dest);
 		if (rc != EOK)
 			goto error;
 	} else {
@@ -154,24 +139,15 @@ logger_log_t *find_log_by_name_and_lock(const char *name)
 	return result;
 }
 
-logger_log_t *find_log_by_id_and_lock(sysarg_t id)
-{
-	logger_log_t *result = NULL;
-
-	fibril_mutex_lock(&log_list_guard);
-	list_foreach(log_list, link, logger_log_t, log) {
-		if ((sysarg_t) log == id) {
-			fibril_mutex_lock(&log->guard);
-			result = log;
-			break;
-		}
-	}
-	fibril_mutex_unlock(&log_list_guard);
-
-	return result;
-}
-
-static log_level_t get_actual_log_level(logger_log_t *log)
+/** Get effective logging level of a log.
+ *
+ * The caller must hold a reference to the log. Parents are kept alive
+ * by their children so no locking is needed to walk the hierarchy.
+ *
+ * @param log Log to query.
+ * @return Most verbose level that is logged.
+ */
+log_level_t get_actual_log_level(logger_log_t *log)
 {
 	/* Find recursively proper log level. */
 	if (log->logged_level == LOG_LEVEL_USE_DEFAULT) {
@@ -260,15 +236,7 @@ void log_release(logger_log_t *log)
 	fibril_mutex_unlock(&log->guard);
 
 	if (log->parent == NULL) {
-		/*
-		 * Due to lazy file opening in write_to_log(),
-		 * it is possible that no file was actually opened.
-		 */
-		if (log->dest->logfile != NULL) {
-			fclose(log->dest->logfile);
-		}
-		free(log->dest->filename);
-		free(log->dest);
+		dest_destroy(log->dest);
 	} else {
 		fibril_mutex_lock(&log->parent->guard);
 		log_release(log->parent);
@@ -286,18 +254,7 @@ void write_to_log(logger_log_t *log, log_level_t level, const char *message)
 {
 	assert(fibril_mutex_is_locked(&log->guard));
 	assert(log->dest != NULL);
-	fibril_mutex_lock(&log->dest->guard);
-	if (log->dest->logfile == NULL)
-		log->dest->logfile = fopen(log->dest->filename, "a");
-
-	if (log->dest->logfile != NULL) {
-		fprintf(log->dest->logfile, "[%s] %s: %s\n",
-		    log->full_name, log_level_str(level),
-		    (const char *) message);
-		fflush(log->dest->logfile);
-	}
-
-	fibril_mutex_unlock(&log->dest->guard);
+	dest_write(log->dest, log->full_name, level, message);
 }
 
 void registered_logs_init(logger_registered_logs_t *logs)
@@ -307,7 +264,7 @@ void registered_logs_init(logger_registered_logs_t *logs)
 
 bool register_log(logger_registered_logs_t *logs, logger_log_t *new_log)
 {
-	if (logs->logs_count >= MAX_REFERENCED_LOGS_PER_CLIENT) {
+	if (logs->logs_count >= LOGGER_CLIENT_LOGS_MAX) {
 		return false;
 	}
 
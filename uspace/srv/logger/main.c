@@ -60,12 +60,19 @@ int main(int argc, char *argv[])
 {
 	printf(NAME ": HelenOS Logging Service\n");
 
+	errno_t rc = dest_init();
+	if (rc != EOK) {
+		printf("%s: Failed to start flushing fibril: %s.\n", NAME,
+		    str_error(rc));
+		return -1;
+	}
+
 	parse_initial_settings();
 	for (int i = 1; i < argc; i++) {
 		parse_level_settings(argv[i]);
 	}
 
-	errno_t rc = service_register(SERVICE_LOGGER, INTERFACE_LOGGER_CONTROL,
+	rc = service_register(SERVICE_LOGGER, INTERFACE_LOGGER_CONTROL,
 	    connection_handler_control, NULL);
 	if (rc != EOK) {
 		printf("%s: Failed to register control port: %s.\n", NAME,
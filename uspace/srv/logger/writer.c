@@ -34,61 +34,288 @@
 /** @file
  */
 
+#include <abi/ipc/methods.h>
+#include <adt/list.h>
+#include <align.h>
+#include <as.h>
+#include <assert.h>
 #include <ipc/services.h>
 #include <ipc/logger.h>
 #include <io/log.h>
 #include <io/logctl.h>
 #include <io/klog.h>
+#include <mem.h>
 #include <ns.h>
 #include <async.h>
 #include <errno.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str_error.h>
 #include "logger.h"
 
-static logger_log_t *handle_create_log(sysarg_t parent)
+/** Writer client connection. */
+typedef struct {
+	/** Link in writers */
+	link_t link;
+	/** Logs created by the client */
+	logger_registered_logs_t logs;
+	/** Memory area shared with the client (NULL if none) */
+	logger_shm_t *shm;
+	/** Size of the ring in the shared area */
+	size_t ring_size;
+	/** Private copy of the message being logged */
+	char *message;
+} logger_writer_t;
+
+/** Guards writers and the logs of each writer. */
+static FIBRIL_MUTEX_INITIALIZE(writers_guard);
+static LIST_INITIALIZE(writers);
+
+/** Publish effective level of a client log in the shared area.
+ *
+ * Precondition: writers_guard is locked.
+ */
+static void writer_update_level(logger_writer_t *writer, size_t idx)
+{
+	assert(fibril_mutex_is_locked(&writers_guard));
+
+	if (writer->shm == NULL)
+		return;
+
+	log_level_t level = get_actual_log_level(writer->logs.logs[idx]);
+	if (level >= LVL_LIMIT)
+		level = LVL_LIMIT - 1;
+
+	atomic_store_explicit(&writer->shm->levels[idx], level,
+	    memory_order_relaxed);
+}
+
+/** Propagate logging level change to all writer clients.
+ *
+ * Called whenever the default level or the level of any log changes
+ * so that clients can filter messages without asking us.
+ */
+void writers_update_levels(void)
+{
+	fibril_mutex_lock(&writers_guard);
+
+	list_foreach(writers, link, logger_writer_t, writer) {
+		for (size_t i = 0; i < writer->logs.logs_count; i++)
+			writer_update_level(writer, i);
+	}
+
+	fibril_mutex_unlock(&writers_guard);
+}
+
+/** Translate client log ID to the log.
+ *
+ * @return Log or NULL if the ID is not valid.
+ */
+static logger_log_t *writer_get_log(logger_writer_t *writer, sysarg_t log_id)
+{
+	if ((log_id == 0) || (log_id > writer->logs.logs_count))
+		return NULL;
+
+	return writer->logs.logs[log_id - 1];
+}
+
+static logger_log_t *handle_create_log(logger_writer_t *writer,
+    sysarg_t parent_id)
 {
+	logger_log_t *parent = NULL;
+	if (parent_id != LOG_NO_PARENT) {
+		parent = writer_get_log(writer, parent_id);
+		if (parent == NULL)
+			return NULL;
+	}
+
 	void *name;
 	errno_t rc = async_data_write_accept(&name, true, 1, 0, 0, NULL);
 	if (rc != EOK)
 		return NULL;
 
-	logger_log_t *log = find_or_create_log_and_lock(name, parent);
+	logger_log_t *log = find_or_create_log_and_lock(name,
+	    (sysarg_t) parent);
 
 	free(name);
 
 	return log;
 }
 
-static errno_t handle_receive_message(sysarg_t log_id, sysarg_t level)
+/** Log a message.
+ *
+ * Precondition: log is locked.
+ */
+static void log_message(logger_log_t *log, log_level_t level,
+    const char *message)
+{
+	if (!shall_log_message(log, level))
+		return;
+
+	KLOG_PRINTF(level, "[%s] %s: %s",
+	    log->full_name, log_level_str(level), message);
+	write_to_log(log, level, message);
+}
+
+static errno_t handle_receive_message(logger_writer_t *writer,
+    sysarg_t log_id, sysarg_t level)
 {
-	logger_log_t *log = find_log_by_id_and_lock(log_id);
-	if (log == NULL)
+	logger_log_t *log = writer_get_log(writer, log_id);
+	if ((log == NULL) || (level >= LVL_LIMIT))
 		return ENOENT;
 
 	void *message = NULL;
 	errno_t rc = async_data_write_accept(&message, true, 1, 0, 0, NULL);
 	if (rc != EOK)
-		goto leave;
+		return rc;
+
+	fibril_mutex_lock(&log->guard);
+	log_message(log, level, message);
+	log_unlock(log);
 
-	if (!shall_log_message(log, level)) {
-		rc = EOK;
-		goto leave;
+	free(message);
+
+	return EOK;
+}
+
+static errno_t handle_share(logger_writer_t *writer)
+{
+	ipc_call_t call;
+	size_t size;
+	unsigned int flags;
+
+	if (!async_share_out_receive(&call, &size, &flags)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
 	}
 
-	KLOG_PRINTF(level, "[%s] %s: %s",
-	    log->full_name, log_level_str(level),
-	    (const char *) message);
-	write_to_log(log, level, message);
+	if ((writer->shm != NULL) || (size != LOGGER_SHM_SIZE) ||
+	    ((flags & (AS_AREA_READ | AS_AREA_WRITE)) !=
+	    (AS_AREA_READ | AS_AREA_WRITE))) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
 
-	rc = EOK;
+	size_t ring_size = ALIGN_DOWN(size - sizeof(logger_shm_t),
+	    LOGGER_SHM_ALIGN);
+	char *message = malloc(ring_size);
+	if (message == NULL) {
+		async_answer_0(&call, ENOMEM);
+		return ENOMEM;
+	}
+
+	logger_shm_t *shm;
+	errno_t rc = async_share_out_finalize(&call, (void **) &shm);
+	if (rc != EOK) {
+		free(message);
+		return rc;
+	}
 
-leave:
+	if (shm->size != ring_size) {
+		as_area_destroy(shm);
+		free(message);
+		return EINVAL;
+	}
+
+	fibril_mutex_lock(&writers_guard);
+
+	writer->shm = shm;
+	writer->ring_size = ring_size;
+	writer->message = message;
+
+	for (size_t i = 0; i < writer->logs.logs_count; i++)
+		writer_update_level(writer, i);
+
+	fibril_mutex_unlock(&writers_guard);
+
+	return EOK;
+}
+
+/** Log one record from the shared ring.
+ *
+ * The client can scribble over the ring at any time, so everything is
+ * validated and the message is copied before use.
+ *
+ * @return Size of the record or 0 if the ring is corrupted.
+ */
+static size_t handle_record(logger_writer_t *writer, size_t pos,
+    size_t avail)
+{
+	logger_shm_record_t rec;
+	memcpy(&rec, &writer->shm->data[pos], sizeof(rec));
+
+	if ((rec.size < sizeof(rec)) || (rec.size % LOGGER_SHM_ALIGN != 0) ||
+	    (rec.size > avail) || (pos + rec.size > writer->ring_size))
+		return 0;
+
+	/* Padding at the end of the ring. */
+	if (rec.log == 0)
+		return rec.size;
+
+	logger_log_t *log = writer_get_log(writer, rec.log);
+	if ((log == NULL) || (rec.level >= LVL_LIMIT))
+		return rec.size;
+
+	size_t len = rec.size - sizeof(rec);
+	memcpy(writer->message, &writer->shm->data[pos + sizeof(rec)], len);
+	writer->message[len - 1] = '\0';
+
+	fibril_mutex_lock(&log->guard);
+	log_message(log, rec.level, writer->message);
 	log_unlock(log);
-	free(message);
 
-	return rc;
+	return rec.size;
+}
+
+/** Drain the shared ring.
+ *
+ * When the ring is empty, the idle flag is raised so that the client
+ * sends LOGGER_WRITER_FLUSH along with its next record.
+ */
+static errno_t handle_flush(logger_writer_t *writer)
+{
+	logger_shm_t *shm = writer->shm;
+	if (shm == NULL)
+		return ENOENT;
+
+	size_t rd = atomic_load_explicit(&shm->read, memory_order_relaxed);
+
+	while (true) {
+		size_t wr = atomic_load(&shm->write);
+
+		if (wr == rd) {
+			atomic_store(&shm->idle, true);
+
+			/* Client might have missed the idle flag. */
+			if (atomic_load(&shm->write) == rd)
+				break;
+
+			/* Client saw it and is going to kick us. */
+			if (!atomic_exchange(&shm->idle, false))
+				break;
+
+			continue;
+		}
+
+		size_t avail = wr - rd;
+		size_t rsize = 0;
+		if ((avail <= writer->ring_size) &&
+		    (rd % LOGGER_SHM_ALIGN == 0))
+			rsize = handle_record(writer, rd % writer->ring_size,
+			    avail);
+
+		if (rsize == 0) {
+			/* Corrupted ring, drop everything. */
+			logger_log("writer: corrupted message ring.\n");
+			rsize = avail;
+		}
+
+		rd += rsize;
+		atomic_store_explicit(&shm->read, rd, memory_order_release);
+	}
+
+	return EOK;
 }
 
 void logger_connection_handler_writer(ipc_call_t *icall)
@@ -101,8 +328,16 @@ void logger_connection_handler_writer(ipc_call_t *icall)
 
 	logger_log("writer: new client.\n");
 
-	logger_registered_logs_t registered_logs;
-	registered_logs_init(&registered_logs);
+	logger_writer_t writer;
+	link_initialize(&writer.link);
+	registered_logs_init(&writer.logs);
+	writer.shm = NULL;
+	writer.ring_size = 0;
+	writer.message = NULL;
+
+	fibril_mutex_lock(&writers_guard);
+	list_append(&writer.link, &writers);
+	fibril_mutex_unlock(&writers_guard);
 
 	while (true) {
 		ipc_call_t call;
@@ -115,31 +350,55 @@ void logger_connection_handler_writer(ipc_call_t *icall)
 
 		switch (IPC_GET_IMETHOD(call)) {
 		case LOGGER_WRITER_CREATE_LOG:
-			log = handle_create_log(IPC_GET_ARG1(call));
+			log = handle_create_log(&writer, IPC_GET_ARG1(call));
 			if (log == NULL) {
 				async_answer_0(&call, ENOMEM);
 				break;
 			}
-			if (!register_log(&registered_logs, log)) {
+			fibril_mutex_lock(&writers_guard);
+			if (!register_log(&writer.logs, log)) {
+				fibril_mutex_unlock(&writers_guard);
 				log_unlock(log);
 				async_answer_0(&call, ELIMIT);
 				break;
 			}
+			writer_update_level(&writer, writer.logs.logs_count - 1);
+			fibril_mutex_unlock(&writers_guard);
 			log_unlock(log);
-			async_answer_1(&call, EOK, (sysarg_t) log);
+			async_answer_1(&call, EOK, writer.logs.logs_count);
 			break;
 		case LOGGER_WRITER_MESSAGE:
-			rc = handle_receive_message(IPC_GET_ARG1(call),
+			rc = handle_receive_message(&writer, IPC_GET_ARG1(call),
 			    IPC_GET_ARG2(call));
 			async_answer_0(&call, rc);
 			break;
+		case LOGGER_WRITER_SHARE:
+			rc = handle_share(&writer);
+			async_answer_0(&call, rc);
+			break;
+		case LOGGER_WRITER_FLUSH:
+			rc = handle_flush(&writer);
+			async_answer_0(&call, rc);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 			break;
 		}
 	}
 
-	unregister_logs(&registered_logs);
+	/* Log whatever the client managed to queue before leaving. */
+	if (writer.shm != NULL)
+		(void) handle_flush(&writer);
+
+	fibril_mutex_lock(&writers_guard);
+	list_remove(&writer.link);
+	fibril_mutex_unlock(&writers_guard);
+
+	if (writer.shm != NULL)
+		as_area_destroy(writer.shm);
+	free(writer.message);
+
+	unregister_logs(&writer.logs);
 	logger_log("writer: client terminated.\n");
 }
 
@@ -46,6 +46,7 @@
 #include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
+#include <vfs/vfs.h>
 
 #include "conn.h"
 #include "service.h"
@@ -57,6 +58,9 @@
 /** Maximum amount of data transferred in one send call */
 #define MAX_MSG_SIZE DATA_XFER_LIMIT
 
+/** Size of buffer for sending data from a file */
+#define SEND_FILE_BUF_SIZE (64 * 1024)
+
 static void tcp_ev_data(tcp_cconn_t *);
 static void tcp_ev_connected(tcp_cconn_t *);
 static void tcp_ev_conn_failed(tcp_cconn_t *);
@@ -936,6 +940,74 @@ static void tcp_conn_reset_srv(tcp_client_t *client, ipc_call_t *icall)
 	async_answer_0(icall, rc);
 }
 
+/** Send file contents via connection.
+ *
+ * Handle client request to send data from a file via connection.
+ * The client passes the file handle, the data is read from the file
+ * system and queued for sending without passing through the client.
+ *
+ * @param client TCP client
+ * @param icall  Async request data
+ *
+ */
+static void tcp_conn_send_file_srv(tcp_client_t *client, ipc_call_t *icall)
+{
+	tcp_cconn_t *cconn;
+	sysarg_t conn_id;
+	aoff64_t pos;
+	size_t size;
+	size_t sent = 0;
+	void *buf = NULL;
+	int fd = -1;
+	errno_t rc;
+
+	log_msg(LOG_DEFAULT, LVL_DEBUG, "tcp_conn_send_file_srv()");
+
+	conn_id = IPC_GET_ARG1(*icall);
+	pos = MERGE_LOUP32(IPC_GET_ARG2(*icall), IPC_GET_ARG3(*icall));
+	size = IPC_GET_ARG4(*icall);
+
+	rc = vfs_receive_handle(false, &fd);
+	if (rc != EOK)
+		goto out;
+
+	rc = tcp_cconn_get(client, conn_id, &cconn);
+	if (rc != EOK)
+		goto out;
+
+	buf = malloc(min(size, SEND_FILE_BUF_SIZE));
+	if (buf == NULL && size > 0) {
+		rc = ENOMEM;
+		goto out;
+	}
+
+	while (sent < size) {
+		size_t nr;
+
+		rc = vfs_read(fd, &pos, buf, min(size - sent,
+		    SEND_FILE_BUF_SIZE), &nr);
+		if (rc != EOK)
+			goto out;
+
+		if (nr == 0)
+			break;
+
+		if (tcp_uc_send(cconn->conn, buf, nr, 0) != TCP_EOK) {
+			rc = EIO;
+			goto out;
+		}
+
+		sent += nr;
+	}
+
+	rc = EOK;
+out:
+	if (fd >= 0)
+		vfs_put(fd);
+	free(buf);
+	async_answer_1(icall, rc, sent);
+}
+
 /** Send data via connection..
  *
  * Handle client request to send data via connection.
@@ -1223,6 +1295,9 @@ static void tcp_client_conn(ipc_call_t *icall, void *arg)
 		case TCP_CONN_RECV_WAIT:
 			tcp_conn_recv_wait_srv(&client, &call);
 			break;
+		case TCP_CONN_SEND_FILE:
+			tcp_conn_send_file_srv(&client, &call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
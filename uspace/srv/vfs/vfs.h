@@ -119,6 +119,11 @@ typedef struct _vfs_node {
 	 */
 	fibril_rwlock_t contents_rwlock;
 
+	/** Pages of the node in the page cache. */
+	list_t pages;
+	/** Incremented whenever the cached pages are purged. */
+	unsigned pages_gen;
+
 	struct _vfs_node *mount;
 } vfs_node_t;
 
@@ -199,6 +204,9 @@ extern errno_t vfs_fd_assign(vfs_file_t *, int);
 extern errno_t vfs_fd_alloc(vfs_file_t **file, bool desc, int *);
 extern errno_t vfs_fd_free(int);
 
+extern errno_t vfs_pager_node_alloc(vfs_node_t *, sysarg_t *);
+extern vfs_node_t *vfs_pager_node_get(sysarg_t);
+
 extern void vfs_node_addref(vfs_node_t *);
 extern void vfs_node_delref(vfs_node_t *);
 extern errno_t vfs_open_node_remote(vfs_node_t *);
@@ -208,6 +216,7 @@ extern errno_t vfs_op_fsprobe(const char *, service_id_t, vfs_fs_probe_info_t *)
 extern errno_t vfs_op_mount(int mpfd, unsigned servid, unsigned flags, unsigned instance, const char *opts, const char *fsname, int *outfd);
 extern errno_t vfs_op_mtab_get(void);
 extern errno_t vfs_op_open(int fd, int flags);
+extern errno_t vfs_op_pager_handle(int fd, sysarg_t *out_handle);
 extern errno_t vfs_op_put(int fd);
 extern errno_t vfs_op_read(int fd, aoff64_t, size_t *out_bytes);
 extern errno_t vfs_op_rename(int basefd, char *old, char *new);
@@ -223,6 +232,9 @@ extern errno_t vfs_op_write(int fd, aoff64_t, size_t *out_bytes);
 
 extern void vfs_register(ipc_call_t *);
 
+extern bool vfs_page_cache_init(void);
+extern void vfs_page_cache_purge_node(vfs_node_t *);
+extern void vfs_page_cache_purge_fs(fs_handle_t, service_id_t);
 extern void vfs_page_in(ipc_call_t *);
 
 typedef struct {
@@ -230,7 +242,7 @@ typedef struct {
 	size_t size;
 } rdwr_io_chunk_t;
 
-extern errno_t vfs_rdwr_internal(int, aoff64_t, bool, rdwr_io_chunk_t *);
+extern errno_t vfs_read_node_internal(vfs_node_t *, aoff64_t, rdwr_io_chunk_t *);
 
 extern void vfs_connection(ipc_call_t *, void *);
 
@@ -55,6 +55,8 @@ typedef struct {
 	fibril_condvar_t cv;
 	list_t passed_handles;
 	vfs_file_t **files;
+	list_t pager_nodes;
+	sysarg_t pager_next;
 } vfs_client_data_t;
 
 typedef struct {
@@ -63,6 +65,13 @@ typedef struct {
 	int permissions;
 } vfs_boxed_handle_t;
 
+/** Node referenced by the client's pager mappings. */
+typedef struct {
+	link_t link;
+	sysarg_t handle;
+	vfs_node_t *node;
+} vfs_pager_node_t;
+
 static errno_t _vfs_fd_free(vfs_client_data_t *, int);
 
 /** Initialize the table of open files. */
@@ -108,6 +117,22 @@ static void vfs_files_done(vfs_client_data_t *vfs_data)
 	}
 }
 
+/** Drop the nodes referenced by the pager mappings of the client. */
+static void vfs_pager_nodes_done(vfs_client_data_t *vfs_data)
+{
+	while (!list_empty(&vfs_data->pager_nodes)) {
+		link_t *lnk;
+		vfs_pager_node_t *pn;
+
+		lnk = list_first(&vfs_data->pager_nodes);
+		list_remove(lnk);
+
+		pn = list_get_instance(lnk, vfs_pager_node_t, link);
+		vfs_node_delref(pn->node);
+		free(pn);
+	}
+}
+
 void *vfs_client_data_create(void)
 {
 	vfs_client_data_t *vfs_data;
@@ -118,6 +143,8 @@ void *vfs_client_data_create(void)
 		fibril_condvar_initialize(&vfs_data->cv);
 		list_initialize(&vfs_data->passed_handles);
 		vfs_data->files = NULL;
+		list_initialize(&vfs_data->pager_nodes);
+		vfs_data->pager_next = 1;
 	}
 
 	return vfs_data;
@@ -128,6 +155,7 @@ void vfs_client_data_destroy(void *data)
 	vfs_client_data_t *vfs_data = (vfs_client_data_t *) data;
 
 	vfs_files_done(vfs_data);
+	vfs_pager_nodes_done(vfs_data);
 	free(vfs_data);
 }
 
@@ -381,6 +409,64 @@ void vfs_file_put(vfs_file_t *file)
 	_vfs_file_put(VFS_DATA, file);
 }
 
+/** Allocate a pager handle for a node.
+ *
+ * Unlike a file descriptor, the pager handle is not visible in the file
+ * table of the client, so it cannot be closed or reused by the client.
+ * The node stays referenced until the client disconnects.
+ *
+ * @param node		VFS node. The function adds its own reference.
+ * @param[out] handle	Place to store the pager handle.
+ *
+ * @return		EOK on success, ENOMEM if out of memory.
+ */
+errno_t vfs_pager_node_alloc(vfs_node_t *node, sysarg_t *handle)
+{
+	vfs_client_data_t *vfs_data = VFS_DATA;
+
+	vfs_pager_node_t *pn = malloc(sizeof(vfs_pager_node_t));
+	if (!pn)
+		return ENOMEM;
+
+	link_initialize(&pn->link);
+	pn->node = node;
+	vfs_node_addref(node);
+
+	fibril_mutex_lock(&vfs_data->lock);
+	pn->handle = vfs_data->pager_next++;
+	list_append(&pn->link, &vfs_data->pager_nodes);
+	fibril_mutex_unlock(&vfs_data->lock);
+
+	*handle = pn->handle;
+	return EOK;
+}
+
+/** Get the node of a pager handle.
+ *
+ * @param handle	Pager handle.
+ *
+ * @return		Referenced VFS node or NULL if there is no such handle.
+ *			The caller must drop the reference using
+ *			vfs_node_delref().
+ */
+vfs_node_t *vfs_pager_node_get(sysarg_t handle)
+{
+	vfs_client_data_t *vfs_data = VFS_DATA;
+	vfs_node_t *node = NULL;
+
+	fibril_mutex_lock(&vfs_data->lock);
+	list_foreach(vfs_data->pager_nodes, link, vfs_pager_node_t, pn) {
+		if (pn->handle == handle) {
+			node = pn->node;
+			vfs_node_addref(node);
+			break;
+		}
+	}
+	fibril_mutex_unlock(&vfs_data->lock);
+
+	return node;
+}
+
 void vfs_op_pass_handle(task_id_t donor_id, task_id_t acceptor_id, int donor_fd)
 {
 	vfs_client_data_t *donor_data = NULL;
@@ -165,6 +165,15 @@ static void vfs_in_open(ipc_call_t *req)
 	async_answer_0(req, rc);
 }
 
+static void vfs_in_pager_handle(ipc_call_t *req)
+{
+	int fd = IPC_GET_ARG1(*req);
+
+	sysarg_t handle = 0;
+	errno_t rc = vfs_op_pager_handle(fd, &handle);
+	async_answer_1(req, rc, handle);
+}
+
 static void vfs_in_put(ipc_call_t *req)
 {
 	int fd = IPC_GET_ARG1(*req);
@@ -350,6 +359,9 @@ void vfs_connection(ipc_call_t *icall, void *arg)
 		case VFS_IN_OPEN:
 			vfs_in_open(&call);
 			break;
+		case VFS_IN_PAGER_HANDLE:
+			vfs_in_pager_handle(&call);
+			break;
 		case VFS_IN_PUT:
 			vfs_in_put(&call);
 			break;
@@ -346,6 +346,22 @@ errno_t vfs_op_open(int fd, int mode)
 	return EOK;
 }
 
+errno_t vfs_op_pager_handle(int fd, sysarg_t *out_handle)
+{
+	vfs_file_t *file = vfs_file_get(fd);
+	if (!file)
+		return EBADF;
+
+	if (!file->open_read || file->node->type == VFS_NODE_DIRECTORY) {
+		vfs_file_put(file);
+		return EINVAL;
+	}
+
+	errno_t rc = vfs_pager_node_alloc(file->node, out_handle);
+	vfs_file_put(file);
+	return rc;
+}
+
 typedef errno_t (*rdwr_ipc_cb_t)(async_exch_t *, vfs_file_t *, aoff64_t,
     ipc_call_t *, bool, void *);
 
@@ -377,34 +393,6 @@ static errno_t rdwr_ipc_client(async_exch_t *exch, vfs_file_t *file, aoff64_t po
 	return rc;
 }
 
-static errno_t rdwr_ipc_internal(async_exch_t *exch, vfs_file_t *file, aoff64_t pos,
-    ipc_call_t *answer, bool read, void *data)
-{
-	rdwr_io_chunk_t *chunk = (rdwr_io_chunk_t *) data;
-
-	if (exch == NULL)
-		return ENOENT;
-
-	aid_t msg = async_send_4(exch, read ? VFS_OUT_READ : VFS_OUT_WRITE,
-	    file->node->service_id, file->node->index, LOWER32(pos),
-	    UPPER32(pos), answer);
-	if (msg == 0)
-		return EINVAL;
-
-	errno_t retval = async_data_read_start(exch, chunk->buffer, chunk->size);
-	if (retval != EOK) {
-		async_forget(msg);
-		return retval;
-	}
-
-	errno_t rc;
-	async_wait_for(msg, &rc);
-
-	chunk->size = IPC_GET_ARG1(*answer);
-
-	return (errno_t) rc;
-}
-
 static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
     void *ipc_cb_data)
 {
@@ -489,6 +477,7 @@ static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
 		if (rc == EOK) {
 			file->node->size = MERGE_LOUP32(IPC_GET_ARG2(answer),
 			    IPC_GET_ARG3(answer));
+			vfs_page_cache_purge_node(file->node);
 		}
 		fibril_rwlock_write_unlock(&file->node->contents_rwlock);
 	}
@@ -498,9 +487,41 @@ static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
 	return rc;
 }
 
-errno_t vfs_rdwr_internal(int fd, aoff64_t pos, bool read, rdwr_io_chunk_t *chunk)
+/** Read from a node on behalf of VFS itself.
+ *
+ * @param node		VFS node of a regular file.
+ * @param pos		Position within the file.
+ * @param chunk		Buffer to read into. On success, its size is updated
+ *			to the number of bytes actually read.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t vfs_read_node_internal(vfs_node_t *node, aoff64_t pos,
+    rdwr_io_chunk_t *chunk)
 {
-	return vfs_rdwr(fd, pos, read, rdwr_ipc_internal, chunk);
+	if (node->type == VFS_NODE_DIRECTORY)
+		return EINVAL;
+
+	fibril_rwlock_read_lock(&node->contents_rwlock);
+
+	async_exch_t *exch = vfs_exchange_grab(node->fs_handle);
+
+	ipc_call_t answer;
+	aid_t msg = async_send_4(exch, VFS_OUT_READ, node->service_id,
+	    node->index, LOWER32(pos), UPPER32(pos), &answer);
+
+	errno_t rc = async_data_read_start(exch, chunk->buffer, chunk->size);
+	if (rc != EOK) {
+		async_forget(msg);
+	} else {
+		async_wait_for(msg, &rc);
+		chunk->size = IPC_GET_ARG1(answer);
+	}
+
+	vfs_exchange_release(exch);
+	fibril_rwlock_read_unlock(&node->contents_rwlock);
+
+	return rc;
 }
 
 errno_t vfs_op_read(int fd, aoff64_t pos, size_t *out_bytes)
@@ -619,8 +640,10 @@ errno_t vfs_op_resize(int fd, int64_t size)
 
 	errno_t rc = vfs_truncate_internal(file->node->fs_handle,
 	    file->node->service_id, file->node->index, size);
-	if (rc == EOK)
+	if (rc == EOK) {
 		file->node->size = size;
+		vfs_page_cache_purge_node(file->node);
+	}
 
 	fibril_rwlock_write_unlock(&file->node->contents_rwlock);
 	vfs_file_put(file);
@@ -761,10 +784,13 @@ errno_t vfs_op_unlink(int parentfd, int expectfd, char *path)
 
 	/* If the node is not held by anyone, try to destroy it. */
 	vfs_node_t *node = vfs_node_peek(&lr);
-	if (!node)
+	if (!node) {
 		out_destroy(&lr.triplet);
-	else
+	} else {
+		/* Do not keep the node alive just for the page cache. */
+		vfs_page_cache_purge_node(node);
 		vfs_node_put(node);
+	}
 
 exit:
 	if (path)
@@ -797,6 +823,8 @@ errno_t vfs_op_unmount(int mpfd)
 	 * the file system cannot be gracefully unmounted at the moment because
 	 * someone is working with it.
 	 */
+	vfs_page_cache_purge_fs(mp->node->mount->fs_handle,
+	    mp->node->mount->service_id);
 	if (vfs_nodes_refcount_sum_get(mp->node->mount->fs_handle,
 	    mp->node->mount->service_id) != 1) {
 		vfs_file_put(mp);
@@ -36,37 +36,210 @@
  */
 
 #include "vfs.h"
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
 #include <async.h>
 #include <fibril_synch.h>
 #include <errno.h>
 #include <as.h>
+#include <smc.h>
+#include <stdlib.h>
 
-void vfs_page_in(ipc_call_t *req)
+/** Maximum number of file pages kept in the page cache. */
+#define PAGE_CACHE_MAX	4096
+
+/** Cached page of a file.
+ *
+ * The page is an address space area of VFS. Frames handed out to the tasks
+ * through IPC_M_PAGE_IN are reference counted by the kernel, so evicting the
+ * page from the cache does not affect the tasks which have it mapped.
+ */
+typedef struct {
+	ht_link_t link;		/**< Page cache hash table link. */
+	link_t lru_link;	/**< Page cache LRU list link. */
+	link_t node_link;	/**< Link to vfs_node_t.pages. */
+	vfs_node_t *node;	/**< Node the page belongs to (referenced). */
+	aoff64_t offset;	/**< Offset of the page within the file. */
+	void *page;		/**< Page contents. */
+} vfs_page_t;
+
+typedef struct {
+	vfs_node_t *node;
+	aoff64_t offset;
+} vfs_page_key_t;
+
+/** Mutex protecting the page cache. */
+static FIBRIL_MUTEX_INITIALIZE(page_cache_mutex);
+
+/** Page cache hash table. */
+static hash_table_t page_cache;
+
+/** Pages in the cache, least recently used first. */
+static LIST_INITIALIZE(page_cache_lru);
+
+static size_t page_key_hash(void *key)
 {
-	aoff64_t offset = IPC_GET_ARG1(*req);
-	size_t page_size = IPC_GET_ARG2(*req);
-	int fd = IPC_GET_ARG3(*req);
-	void *page;
+	vfs_page_key_t *pkey = key;
+	return hash_combine((size_t) pkey->node,
+	    hash_mix((size_t) pkey->offset));
+}
+
+static size_t page_hash(const ht_link_t *item)
+{
+	vfs_page_t *vpage = hash_table_get_inst(item, vfs_page_t, link);
+	vfs_page_key_t pkey = {
+		.node = vpage->node,
+		.offset = vpage->offset
+	};
+
+	return page_key_hash(&pkey);
+}
+
+static bool page_key_equal(void *key, const ht_link_t *item)
+{
+	vfs_page_key_t *pkey = key;
+	vfs_page_t *vpage = hash_table_get_inst(item, vfs_page_t, link);
+	return vpage->node == pkey->node && vpage->offset == pkey->offset;
+}
+
+static hash_table_ops_t page_cache_ops = {
+	.hash = page_hash,
+	.key_hash = page_key_hash,
+	.key_equal = page_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+/** Initialize the VFS page cache.
+ *
+ * @return		Return true on success, false on failure.
+ */
+bool vfs_page_cache_init(void)
+{
+	return hash_table_create(&page_cache, 0, 0, &page_cache_ops);
+}
+
+/** Unlink page from the page cache.
+ *
+ * The page cache mutex must be held. The caller is responsible for
+ * freeing the page by page_cache_free() after dropping the mutex.
+ */
+static void page_cache_unlink(vfs_page_t *vpage)
+{
+	assert(fibril_mutex_is_locked(&page_cache_mutex));
+
+	hash_table_remove_item(&page_cache, &vpage->link);
+	list_remove(&vpage->lru_link);
+	list_remove(&vpage->node_link);
+}
+
+static void page_cache_free(vfs_page_t *vpage)
+{
+	as_area_destroy(vpage->page);
+	vfs_node_delref(vpage->node);
+	free(vpage);
+}
+
+/** Drop all cached pages of a list.
+ *
+ * @param pages		List of pages linked via lru_link.
+ */
+static void page_cache_free_list(list_t *pages)
+{
+	link_t *link;
+
+	while ((link = list_first(pages)) != NULL) {
+		vfs_page_t *vpage = list_get_instance(link, vfs_page_t,
+		    lru_link);
+		list_remove(link);
+		page_cache_free(vpage);
+	}
+}
+
+/** Drop all cached pages of a node.
+ *
+ * This must be called whenever the contents of the node change.
+ *
+ * @param node		VFS node.
+ */
+void vfs_page_cache_purge_node(vfs_node_t *node)
+{
+	list_t victims;
+
+	list_initialize(&victims);
+
+	fibril_mutex_lock(&page_cache_mutex);
+	node->pages_gen++;
+	link_t *link;
+	while ((link = list_first(&node->pages)) != NULL) {
+		vfs_page_t *vpage = list_get_instance(link, vfs_page_t,
+		    node_link);
+		page_cache_unlink(vpage);
+		list_append(&vpage->lru_link, &victims);
+	}
+	fibril_mutex_unlock(&page_cache_mutex);
+
+	page_cache_free_list(&victims);
+}
+
+/** Drop all cached pages of a file system instance.
+ *
+ * @param fs_handle	File system handle.
+ * @param service_id	Service ID of the file system instance.
+ */
+void vfs_page_cache_purge_fs(fs_handle_t fs_handle, service_id_t service_id)
+{
+	list_t victims;
+
+	list_initialize(&victims);
+
+	fibril_mutex_lock(&page_cache_mutex);
+	list_foreach_safe(page_cache_lru, cur, next) {
+		vfs_page_t *vpage = list_get_instance(cur, vfs_page_t,
+		    lru_link);
+		if (vpage->node->fs_handle != fs_handle ||
+		    vpage->node->service_id != service_id)
+			continue;
+
+		page_cache_unlink(vpage);
+		list_append(&vpage->lru_link, &victims);
+	}
+	fibril_mutex_unlock(&page_cache_mutex);
+
+	page_cache_free_list(&victims);
+}
+
+/** Read one page of a file.
+ *
+ * @param node		VFS node of the file.
+ * @param offset	Offset of the page within the file.
+ * @param page_size	Page size.
+ * @param page		Place to store the newly created page.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t page_read(vfs_node_t *node, aoff64_t offset, size_t page_size,
+    void **page)
+{
+	void *area;
 	errno_t rc;
 
-	page = as_area_create(AS_AREA_ANY, page_size,
+	area = as_area_create(AS_AREA_ANY, page_size,
 	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
 	    AS_AREA_UNPAGED);
-
-	if (page == AS_MAP_FAILED) {
-		async_answer_0(req, ENOMEM);
-		return;
-	}
+	if (area == AS_MAP_FAILED)
+		return ENOMEM;
 
 	rdwr_io_chunk_t chunk = {
-		.buffer = page,
+		.buffer = area,
 		.size = page_size
 	};
 
 	size_t total = 0;
 	aoff64_t pos = offset;
 	do {
-		rc = vfs_rdwr_internal(fd, pos, true, &chunk);
+		rc = vfs_read_node_internal(node, pos, &chunk);
 		if (rc != EOK)
 			break;
 		if (chunk.size == 0)
@@ -77,15 +250,122 @@ void vfs_page_in(ipc_call_t *req)
 		chunk.size = page_size - total;
 	} while (total < page_size);
 
-	async_answer_1(req, rc, (sysarg_t) page);
+	if (rc != EOK) {
+		as_area_destroy(area);
+		return rc;
+	}
+
+	/* The page may end up mapped as executable. */
+	smc_coherence(area, page_size);
+
+	*page = area;
+	return EOK;
+}
+
+/** Handle a page-in request.
+ *
+ * The pages are served from the page cache, so all tasks mapping the same
+ * file share the same physical frames. The kernel makes a private copy of
+ * the page when a task writes to it.
+ *
+ * The file is identified by a pager handle obtained via VFS_IN_PAGER_HANDLE
+ * rather than by a file descriptor, which the task could close or reuse
+ * while the mapping still exists.
+ *
+ * The page cache mutex is not held during the read as the file system
+ * server itself may need to page in its own text in the meantime.
+ */
+void vfs_page_in(ipc_call_t *req)
+{
+	aoff64_t offset = IPC_GET_ARG1(*req) + IPC_GET_ARG4(*req);
+	size_t page_size = IPC_GET_ARG2(*req);
+	sysarg_t handle = IPC_GET_ARG3(*req);
+	errno_t rc;
+
+	vfs_node_t *node = vfs_pager_node_get(handle);
+	if (!node) {
+		async_answer_0(req, EBADF);
+		return;
+	}
+
+	vfs_page_key_t pkey = {
+		.node = node,
+		.offset = offset
+	};
+
+	fibril_mutex_lock(&page_cache_mutex);
+	ht_link_t *link = hash_table_find(&page_cache, &pkey);
+	if (link != NULL) {
+		vfs_page_t *vpage = hash_table_get_inst(link, vfs_page_t,
+		    link);
+		list_remove(&vpage->lru_link);
+		list_append(&vpage->lru_link, &page_cache_lru);
+		async_answer_1(req, EOK, (sysarg_t) vpage->page);
+		fibril_mutex_unlock(&page_cache_mutex);
+		vfs_node_delref(node);
+		return;
+	}
+	unsigned gen = node->pages_gen;
+	fibril_mutex_unlock(&page_cache_mutex);
+
+	void *page;
+	rc = page_read(node, offset, page_size, &page);
+	if (rc != EOK) {
+		async_answer_0(req, rc);
+		vfs_node_delref(node);
+		return;
+	}
+
+	vfs_page_t *vpage = malloc(sizeof(vfs_page_t));
+	if (vpage == NULL) {
+		/* Serve the page without caching it. */
+		async_answer_1(req, EOK, (sysarg_t) page);
+		as_area_destroy(page);
+		vfs_node_delref(node);
+		return;
+	}
+
+	vpage->node = node;
+	vpage->offset = offset;
+	vpage->page = page;
+
+	list_t victims;
+	list_initialize(&victims);
+
+	fibril_mutex_lock(&page_cache_mutex);
+
+	link = hash_table_find(&page_cache, &pkey);
+	if (link != NULL) {
+		/* Someone else was faster. */
+		list_append(&vpage->lru_link, &victims);
+		vpage = hash_table_get_inst(link, vfs_page_t, link);
+	} else if (node->pages_gen != gen) {
+		/*
+		 * The file has been modified while we were reading it. Serve
+		 * the page, but do not cache it.
+		 */
+		list_append(&vpage->lru_link, &victims);
+	} else {
+		hash_table_insert(&page_cache, &vpage->link);
+		list_append(&vpage->node_link, &node->pages);
+		list_append(&vpage->lru_link, &page_cache_lru);
+
+		if (hash_table_size(&page_cache) > PAGE_CACHE_MAX) {
+			vfs_page_t *lru = list_get_instance(
+			    list_first(&page_cache_lru), vfs_page_t, lru_link);
+			page_cache_unlink(lru);
+			list_append(&lru->lru_link, &victims);
+		}
+	}
 
 	/*
-	 * FIXME:
-	 * This is just for now until we implement proper page cache
-	 * management.  Not keeping the pages around in a cache results in
-	 * inherently non-coherent private mappings.
+	 * Answer while holding the mutex so that the page cannot be evicted
+	 * before the kernel takes its reference to the frame.
 	 */
-	as_area_destroy(page);
+	async_answer_1(req, EOK, (sysarg_t) vpage->page);
+	fibril_mutex_unlock(&page_cache_mutex);
+
+	page_cache_free_list(&victims);
 }
 
 /**